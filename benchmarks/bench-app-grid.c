@@ -0,0 +1,317 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Microbenchmarks for the app grid's building blocks. Doesn't need
+ * a compositor, only a display for the first paint.
+ */
+
+#include "benchlib.h"
+#include "testlib.h"
+
+#include "app-grid.h"
+#include "app-list-model.h"
+#include "folder-info.h"
+#include "util.h"
+
+#include <gio/gdesktopappinfo.h>
+#include <glib/gstdio.h>
+
+#define N_ITERATIONS 10
+/* Must match the app list model's debounce timeout */
+#define APP_LIST_DEBOUNCE_MS 500
+
+static const char *queries[] = { "app 042", "bench", "web", "ed", "nomatch" };
+
+static PhoshBenchCorpusCfg corpus_cfg = {
+  .n_apps = 500,
+  .n_keywords = 5,
+  .n_icons = 50,
+  .n_folders = 10,
+  .apps_per_folder = 10,
+};
+
+
+static double
+ms_since (gint64 start)
+{
+  return (g_get_monotonic_time () - start) / 1000.0;
+}
+
+
+typedef struct {
+  GMainLoop *loop;
+  gint64     done;
+} WaitForItemsContext;
+
+
+static gboolean
+on_items_idle (gpointer data)
+{
+  WaitForItemsContext *ctx = data;
+
+  ctx->done = g_get_monotonic_time ();
+  g_main_loop_quit (ctx->loop);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static void
+on_items_changed (WaitForItemsContext *ctx)
+{
+  /* A rebuild emits several changes so stop the clock once it's done */
+  if (ctx->done == 0) {
+    ctx->done = -1;
+    g_idle_add_full (G_PRIORITY_HIGH, on_items_idle, ctx, NULL);
+  }
+}
+
+/* Returns when the model got rebuilt, in ms since start minus the debounce timeout */
+static double
+wait_for_rebuild (PhoshAppListModel *model, gint64 start)
+{
+  g_autoptr (GMainLoop) loop = g_main_loop_new (NULL, FALSE);
+  WaitForItemsContext ctx = { .loop = loop };
+  gulong id;
+
+  id = g_signal_connect_swapped (model, "items-changed", G_CALLBACK (on_items_changed), &ctx);
+  g_main_loop_run (loop);
+  g_signal_handler_disconnect (model, id);
+
+  return (ctx.done - start) / 1000.0 - APP_LIST_DEBOUNCE_MS;
+}
+
+
+static void
+bench_app_list_model (PhoshBenchResults *results)
+{
+  g_autofree char *snapshot = g_build_filename (g_get_user_cache_dir (), "phosh",
+                                                "app-list.gvariant", NULL);
+  g_autoptr (GSettings) settings = g_settings_new (PHOSH_FOLDERS_SCHEMA_ID);
+  g_auto (GStrv) folders = g_settings_get_strv (settings, "folder-children");
+  PhoshAppListModel *model;
+  double samples[N_ITERATIONS];
+  gint64 start;
+
+  /* No snapshot, the desktop files need to be parsed */
+  g_unlink (snapshot);
+  start = g_get_monotonic_time ();
+  model = phosh_app_list_model_get_default ();
+  phosh_bench_results_add_one (results, "app-list-model-cold", "ms",
+                               wait_for_rebuild (model, start));
+  g_assert_cmpint (g_list_model_get_n_items (G_LIST_MODEL (model)), >, corpus_cfg.n_folders);
+  g_assert_true (g_file_test (snapshot, G_FILE_TEST_IS_REGULAR));
+  g_assert_finalize_object (model);
+
+  /* With snapshot the model is populated on construction */
+  for (int i = 0; i < N_ITERATIONS; i++) {
+    start = g_get_monotonic_time ();
+    model = phosh_app_list_model_get_default ();
+    samples[i] = ms_since (start);
+    g_assert_cmpint (g_list_model_get_n_items (G_LIST_MODEL (model)), >, corpus_cfg.n_folders);
+    /* Drops the pending reconciliation too */
+    g_assert_finalize_object (model);
+  }
+  phosh_bench_results_add (results, "app-list-model-snapshot", "ms", samples, N_ITERATIONS);
+
+  /* Rebuilds triggered by folder changes, toggle between folders and no folders */
+  model = phosh_app_list_model_get_default ();
+  for (int i = 0; i < N_ITERATIONS; i++) {
+    const char *none[] = { NULL };
+
+    start = g_get_monotonic_time ();
+    g_settings_set_strv (settings, "folder-children",
+                         i % 2 ? (const char * const *) folders : none);
+    samples[i] = wait_for_rebuild (model, start);
+  }
+  g_settings_set_strv (settings, "folder-children", (const char * const *) folders);
+  wait_for_rebuild (model, g_get_monotonic_time ());
+  phosh_bench_results_add (results, "app-list-model-rebuild", "ms", samples, N_ITERATIONS);
+  g_assert_finalize_object (model);
+}
+
+
+static void
+bench_index (PhoshBenchResults *results)
+{
+  double samples[N_ITERATIONS];
+
+  for (int i = 0; i < N_ITERATIONS; i++) {
+    g_autoptr (GPtrArray) infos = g_ptr_array_new_with_free_func (g_object_unref);
+    gint64 start;
+
+    /* Fresh app infos don't have an index yet */
+    for (guint n = 0; n < corpus_cfg.n_apps; n++) {
+      g_autofree char *id = phosh_bench_corpus_get_app_id (n);
+      GDesktopAppInfo *info = g_desktop_app_info_new (id);
+
+      g_assert_nonnull (info);
+      g_ptr_array_add (infos, info);
+    }
+
+    start = g_get_monotonic_time ();
+    for (guint n = 0; n < infos->len; n++)
+      phosh_util_index_app_info (g_ptr_array_index (infos, n));
+    samples[i] = ms_since (start);
+  }
+  phosh_bench_results_add (results, "index-app-infos", "ms", samples, N_ITERATIONS);
+}
+
+
+static void
+bench_matches (PhoshBenchResults *results, PhoshAppListModel *model)
+{
+  guint n_items = g_list_model_get_n_items (G_LIST_MODEL (model));
+  g_autoptr (GPtrArray) infos = g_ptr_array_new_with_free_func (g_object_unref);
+  double samples[G_N_ELEMENTS (queries)];
+
+  for (guint i = 0; i < n_items; i++) {
+    g_autoptr (GAppInfo) info = g_list_model_get_item (G_LIST_MODEL (model), i);
+
+    if (!PHOSH_IS_FOLDER_INFO (info))
+      g_ptr_array_add (infos, g_steal_pointer (&info));
+  }
+
+  for (guint q = 0; q < G_N_ELEMENTS (queries); q++) {
+    g_autofree char *search = phosh_util_fold_search_string (queries[q]);
+    gint64 start = g_get_monotonic_time ();
+
+    for (int i = 0; i < N_ITERATIONS; i++) {
+      for (guint n = 0; n < infos->len; n++)
+        phosh_util_matches_app_info (g_ptr_array_index (infos, n), search);
+    }
+    /* Per search over all apps */
+    samples[q] = ms_since (start) / N_ITERATIONS;
+  }
+  phosh_bench_results_add (results, "matches-app-info", "ms", samples, G_N_ELEMENTS (queries));
+}
+
+
+static void
+bench_folder_refilter (PhoshBenchResults *results, PhoshAppListModel *model)
+{
+  guint n_items = g_list_model_get_n_items (G_LIST_MODEL (model));
+  g_autoptr (GPtrArray) folders = g_ptr_array_new_with_free_func (g_object_unref);
+  double samples[G_N_ELEMENTS (queries)];
+
+  for (guint i = 0; i < n_items; i++) {
+    g_autoptr (GAppInfo) info = g_list_model_get_item (G_LIST_MODEL (model), i);
+
+    if (PHOSH_IS_FOLDER_INFO (info))
+      g_ptr_array_add (folders, g_steal_pointer (&info));
+  }
+  g_assert_cmpint (folders->len, ==, corpus_cfg.n_folders);
+
+  for (guint q = 0; q < G_N_ELEMENTS (queries); q++) {
+    g_autofree char *search = phosh_util_fold_search_string (queries[q]);
+    gint64 start = g_get_monotonic_time ();
+
+    for (int i = 0; i < N_ITERATIONS; i++) {
+      for (guint n = 0; n < folders->len; n++)
+        phosh_folder_info_refilter (g_ptr_array_index (folders, n), search);
+    }
+    /* Per search over all folders */
+    samples[q] = ms_since (start) / N_ITERATIONS;
+  }
+  phosh_bench_results_add (results, "folder-info-refilter", "ms", samples,
+                           G_N_ELEMENTS (queries));
+}
+
+
+static void
+on_after_paint (GMainLoop *loop)
+{
+  g_main_loop_quit (loop);
+}
+
+
+static void
+bench_first_paint (PhoshBenchResults *results)
+{
+  double samples[N_ITERATIONS];
+
+  for (int i = 0; i < N_ITERATIONS; i++) {
+    g_autoptr (GMainLoop) loop = g_main_loop_new (NULL, FALSE);
+    GtkWidget *window, *grid;
+    GdkFrameClock *clock;
+    gint64 start;
+
+    start = g_get_monotonic_time ();
+    window = gtk_window_new (GTK_WINDOW_TOPLEVEL);
+    gtk_window_set_default_size (GTK_WINDOW (window), 360, 720);
+    grid = phosh_app_grid_new ();
+    gtk_container_add (GTK_CONTAINER (window), grid);
+    gtk_widget_realize (window);
+    clock = gtk_widget_get_frame_clock (window);
+    g_signal_connect_swapped (clock, "after-paint", G_CALLBACK (on_after_paint), loop);
+    gtk_widget_show_all (window);
+    g_main_loop_run (loop);
+    samples[i] = ms_since (start);
+
+    g_signal_handlers_disconnect_by_func (clock, on_after_paint, loop);
+    gtk_widget_destroy (window);
+  }
+  phosh_bench_results_add (results, "app-grid-first-paint", "ms", samples, N_ITERATIONS);
+}
+
+
+static void
+bench_app_grid (void)
+{
+  g_autoptr (PhoshBenchResults) results = phosh_bench_results_new ("app-grid");
+  PhoshAppListModel *model;
+
+  bench_app_list_model (results);
+  bench_index (results);
+
+  model = phosh_app_list_model_get_default ();
+  if (g_list_model_get_n_items (G_LIST_MODEL (model)) == 0)
+    wait_for_rebuild (model, g_get_monotonic_time ());
+
+  bench_matches (results, model);
+  bench_folder_refilter (results, model);
+  bench_first_paint (results);
+
+  g_assert_finalize_object (model);
+
+  phosh_bench_results_write (results);
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  g_autoptr (GError) err = NULL;
+  g_autoptr (GFile) cache_dir = NULL;
+  g_autofree char *corpus = NULL;
+  g_autofree char *data_dirs = NULL;
+  g_autofree char *tmpdir = NULL;
+  int ret;
+
+  /* Don't pick up app list snapshots from previous runs */
+  tmpdir = g_dir_make_tmp ("phosh-bench-app-grid.XXXXXX", &err);
+  g_assert_no_error (err);
+  g_setenv ("XDG_CACHE_HOME", tmpdir, TRUE);
+
+  corpus = phosh_bench_corpus_create_full (&corpus_cfg, NULL, &err);
+  g_assert_no_error (err);
+  /* Prepend as the schemas are looked up in XDG_DATA_DIRS too */
+  data_dirs = g_strjoin (":", corpus, g_getenv ("XDG_DATA_DIRS") ?: "/usr/share", NULL);
+  g_setenv ("XDG_DATA_DIRS", data_dirs, TRUE);
+
+  gtk_test_init (&argc, &argv, NULL);
+
+  phosh_bench_corpus_setup_folders (&corpus_cfg);
+
+  g_test_add_func ("/phosh/benchmarks/app-grid", bench_app_grid);
+
+  ret = g_test_run ();
+
+  phosh_bench_corpus_remove (corpus);
+  cache_dir = g_file_new_for_path (tmpdir);
+  phosh_test_remove_tree (cache_dir);
+
+  return ret;
+}
@@ -0,0 +1,693 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "phosh-config.h"
+#include "phosh-screen-saver-dbus.h"
+#include "phosh-test-resources.h"
+
+#include "app-grid.h"
+#include "home.h"
+#include "lockscreen.h"
+#include "overview.h"
+#include "shell-priv.h"
+#include "top-panel.h"
+#include "toplevel-manager.h"
+
+#include "benchlib.h"
+#include "testlib-full-shell.h"
+#include "testlib-wait-for-shell-state.h"
+
+#include <gio/gio.h>
+#include <gdesktop-enums.h>
+
+#include <signal.h>
+
+/*
+ * Measures user visible KPIs of a full shell running on a headless
+ * compositor:
+ *
+ * - boot: Compositor and shell start until the shell is up
+ * - search: Typing a search term until the app grid shows the result
+ * - overview: Opening the overview with a number of toplevels
+ * - notifications: Throughput when flooding the notification server
+ * - lock/unlock: Locking and unlocking the screen
+ * - restyle: Theme, accent color and high contrast changes until the
+ *   top panel, the overview or the lock screen got repainted
+ *
+ * Set `PHOSH_BENCH_TOPLEVELS`, `PHOSH_BENCH_APPS` and
+ * `PHOSH_BENCH_NOTIFICATIONS` to change the number of toplevels, apps
+ * and notifications. If `PHOSH_BENCH_BUDGETS` points to a budget file
+ * the benchmark fails when a KPI regressed, see
+ * phosh_bench_results_load_budgets().
+ */
+
+#define POP_TIMEOUT 50000000
+#define WAIT_TIMEOUT 30000
+
+#define DEFAULT_APPS 500
+#define N_ITERATIONS 5
+#define DEFAULT_NOTIFICATIONS 200
+#define DEFAULT_TOPLEVELS 5
+/* Even so the theme is back to the initial one after each run */
+#define N_RESTYLES 6
+
+typedef struct _PhoshBenchFixture {
+  /* Must be first so we can use the full shell fixture's functions */
+  PhoshTestFullShellFixture full_shell;
+  gint64                    start;
+  char                     *corpus;
+} PhoshBenchFixture;
+
+
+typedef struct _PhoshBenchContext {
+  GTimer                         *timer;
+  GMainLoop                      *loop;
+  struct zwp_virtual_keyboard_v1 *keyboard;
+  PhoshTestWaitForShellState     *waiter;
+  PhoshBenchResults              *results;
+} PhoshBenchContext;
+
+
+/* Written in the shell thread */
+static guint num_toplevels;
+
+
+static double
+ms_since (gint64 start)
+{
+  return (g_get_monotonic_time () - start) / 1000.0;
+}
+
+
+static gboolean
+on_waited (gpointer data)
+{
+  GMainLoop *loop = data;
+
+  g_main_loop_quit (loop);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static void
+wait_a_bit (GMainLoop *loop, int msecs)
+{
+  g_autoptr (GSource) source = g_timeout_source_new (msecs);
+
+  g_source_set_name (source, "[BenchShell] wait");
+  g_source_set_callback (source, on_waited, loop, NULL);
+
+  g_source_attach (source, g_main_loop_get_context (loop));
+  g_main_loop_run (loop);
+}
+
+
+static void
+on_num_toplevels_changed (PhoshToplevelManager *toplevel_manager)
+{
+  num_toplevels = phosh_toplevel_manager_get_num_toplevels (toplevel_manager);
+}
+
+
+static gboolean
+wait_for_num_toplevels (PhoshBenchContext *ctx, guint n, guint timeout)
+{
+  guint sleep = 100;
+
+  while (timeout > 0) {
+    if (num_toplevels == n)
+      return TRUE;
+
+    wait_a_bit (ctx->loop, sleep);
+    timeout -= MIN (sleep, timeout);
+  }
+
+  return FALSE;
+}
+
+
+static void
+toggle_overview (PhoshBenchContext *ctx, gboolean open)
+{
+  phosh_test_keyboard_press_modifiers (ctx->keyboard, KEY_LEFTMETA);
+  phosh_test_keyboard_press_keys (ctx->keyboard, ctx->timer, KEY_A, NULL);
+  phosh_test_keyboard_release_modifiers (ctx->keyboard);
+  phosh_test_wait_for_shell_state_wait (ctx->waiter, PHOSH_STATE_OVERVIEW, open, WAIT_TIMEOUT);
+}
+
+/* Search */
+
+typedef struct {
+  GAsyncQueue   *queue;
+  const char    *query;
+  GtkWidget     *apps;
+  GdkFrameClock *frame_clock;
+  gboolean       changed;
+  gint64         start;
+  double         elapsed;
+} PhoshBenchSearch;
+
+
+static void
+on_search_apps_removed (PhoshBenchSearch *search)
+{
+  search->changed = TRUE;
+}
+
+
+static void
+on_search_after_paint (PhoshBenchSearch *search)
+{
+  if (!search->changed)
+    return;
+
+  search->elapsed = ms_since (search->start);
+  g_signal_handlers_disconnect_by_data (search->apps, search);
+  g_signal_handlers_disconnect_by_data (search->frame_clock, search);
+  g_async_queue_push (search->queue, GINT_TO_POINTER (TRUE));
+}
+
+
+static GtkWidget *
+find_toplevel (GType type)
+{
+  g_autoptr (GList) toplevels = gtk_window_list_toplevels ();
+
+  for (GList *l = toplevels; l; l = l->next) {
+    if (G_TYPE_CHECK_INSTANCE_TYPE (l->data, type))
+      return GTK_WIDGET (l->data);
+  }
+
+  return NULL;
+}
+
+/* Runs in the shell's thread */
+static void
+on_search_idle (gpointer data)
+{
+  PhoshBenchSearch *search = data;
+  PhoshHome *home = PHOSH_HOME (find_toplevel (PHOSH_TYPE_HOME));
+  PhoshAppGrid *app_grid;
+  GtkWidget *entry;
+
+  g_assert_true (PHOSH_IS_HOME (home));
+  app_grid = phosh_overview_get_app_grid (phosh_home_get_overview (home));
+  entry = GTK_WIDGET (gtk_widget_get_template_child (GTK_WIDGET (app_grid),
+                                                     PHOSH_TYPE_APP_GRID,
+                                                     "search"));
+  search->apps = GTK_WIDGET (gtk_widget_get_template_child (GTK_WIDGET (app_grid),
+                                                            PHOSH_TYPE_APP_GRID,
+                                                            "apps"));
+  search->frame_clock = gtk_widget_get_frame_clock (GTK_WIDGET (home));
+  search->changed = FALSE;
+
+  if (*search->query == '\0') {
+    gtk_entry_set_text (GTK_ENTRY (entry), "");
+    g_async_queue_push (search->queue, GINT_TO_POINTER (TRUE));
+    return;
+  }
+
+  /* Going from all apps to a single one drops the other apps' buttons */
+  g_signal_connect_swapped (search->apps, "remove", G_CALLBACK (on_search_apps_removed), search);
+  g_signal_connect_swapped (search->frame_clock, "after-paint",
+                            G_CALLBACK (on_search_after_paint), search);
+  search->start = g_get_monotonic_time ();
+  gtk_entry_set_text (GTK_ENTRY (entry), search->query);
+}
+
+
+static double
+run_search (PhoshBenchContext *ctx, const char *query)
+{
+  g_autoptr (GAsyncQueue) queue = g_async_queue_new ();
+  PhoshBenchSearch search = { .queue = queue, .query = query };
+
+  g_idle_add_once (on_search_idle, &search);
+  g_assert_nonnull (g_async_queue_timeout_pop (queue, WAIT_TIMEOUT * 1000));
+
+  return search.elapsed;
+}
+
+
+static void
+bench_search (PhoshBenchContext *ctx)
+{
+  g_autofree char *kpi = NULL;
+  double samples[N_ITERATIONS];
+  guint n_apps = phosh_bench_get_env_uint ("PHOSH_BENCH_APPS", DEFAULT_APPS);
+
+  /* The overview is up when there are no toplevels */
+  phosh_test_wait_for_shell_state_wait (ctx->waiter, PHOSH_STATE_OVERVIEW, TRUE, WAIT_TIMEOUT);
+  wait_a_bit (ctx->loop, 500);
+
+  for (int i = 0; i < N_ITERATIONS; i++) {
+    g_autofree char *query = g_strdup_printf ("app %03d", (i * 97) % n_apps);
+
+    samples[i] = run_search (ctx, query);
+    run_search (ctx, "");
+    wait_a_bit (ctx->loop, 500);
+  }
+
+  kpi = g_strdup_printf ("app-grid-search-%u-apps", n_apps);
+  phosh_bench_results_add (ctx->results, kpi, "ms", samples, N_ITERATIONS);
+}
+
+/* Overview */
+
+static GPid *
+spawn_apps (PhoshBenchContext *ctx, guint n_toplevels)
+{
+  const char *argv[] = { TEST_TOOLS "/app-buttons", NULL };
+  GPid *pids = g_new0 (GPid, n_toplevels);
+
+  for (guint i = 0; i < n_toplevels; i++) {
+    g_autoptr (GError) err = NULL;
+
+    g_spawn_async (NULL, (char **)argv, NULL, G_SPAWN_DEFAULT, NULL, NULL, &pids[i], &err);
+    g_assert_no_error (err);
+  }
+  g_assert_true (wait_for_num_toplevels (ctx, n_toplevels, WAIT_TIMEOUT));
+  phosh_test_wait_for_shell_state_wait (ctx->waiter, PHOSH_STATE_OVERVIEW, FALSE, WAIT_TIMEOUT);
+  /* Let the apps settle */
+  wait_a_bit (ctx->loop, 1000);
+
+  return pids;
+}
+
+
+static void
+kill_apps (PhoshBenchContext *ctx, GPid *pids, guint n_toplevels)
+{
+  for (guint i = 0; i < n_toplevels; i++) {
+    kill (pids[i], SIGTERM);
+    g_spawn_close_pid (pids[i]);
+  }
+  g_free (pids);
+  g_assert_true (wait_for_num_toplevels (ctx, 0, WAIT_TIMEOUT));
+}
+
+
+static void
+bench_overview (PhoshBenchContext *ctx)
+{
+  g_autofree char *kpi = NULL;
+  double samples[N_ITERATIONS];
+  guint n_toplevels = phosh_bench_get_env_uint ("PHOSH_BENCH_TOPLEVELS", DEFAULT_TOPLEVELS);
+  GPid *pids = spawn_apps (ctx, n_toplevels);
+
+  for (int i = 0; i < N_ITERATIONS; i++) {
+    gint64 start = g_get_monotonic_time ();
+
+    toggle_overview (ctx, TRUE);
+    samples[i] = ms_since (start);
+    wait_a_bit (ctx->loop, 500);
+
+    toggle_overview (ctx, FALSE);
+    wait_a_bit (ctx->loop, 500);
+  }
+
+  kpi = g_strdup_printf ("overview-open-%u-toplevels", n_toplevels);
+  phosh_bench_results_add (ctx->results, kpi, "ms", samples, N_ITERATIONS);
+
+  kill_apps (ctx, pids, n_toplevels);
+}
+
+/* Notifications */
+
+static void
+bench_notifications (PhoshBenchContext *ctx)
+{
+  g_autoptr (GDBusConnection) bus = NULL;
+  g_autoptr (GError) err = NULL;
+  g_autofree double *latencies = NULL;
+  guint n_notifications;
+  gint64 start;
+
+  n_notifications = phosh_bench_get_env_uint ("PHOSH_BENCH_NOTIFICATIONS", DEFAULT_NOTIFICATIONS);
+  latencies = g_new0 (double, n_notifications);
+
+  bus = g_bus_get_sync (G_BUS_TYPE_SESSION, NULL, &err);
+  g_assert_no_error (err);
+
+  start = g_get_monotonic_time ();
+  for (guint i = 0; i < n_notifications; i++) {
+    g_autoptr (GVariant) ret = NULL;
+    g_autofree char *summary = g_strdup_printf ("Notification %u", i);
+    gint64 sent = g_get_monotonic_time ();
+
+    ret = g_dbus_connection_call_sync (bus,
+                                       "org.freedesktop.Notifications",
+                                       "/org/freedesktop/Notifications",
+                                       "org.freedesktop.Notifications",
+                                       "Notify",
+                                       g_variant_new ("(susssasa{sv}i)",
+                                                      "phosh-bench",
+                                                      0,
+                                                      "dialog-information",
+                                                      summary,
+                                                      "A notification sent by the benchmark",
+                                                      NULL,
+                                                      NULL,
+                                                      -1),
+                                       G_VARIANT_TYPE ("(u)"),
+                                       G_DBUS_CALL_FLAGS_NONE,
+                                       -1,
+                                       NULL,
+                                       &err);
+    g_assert_no_error (err);
+    latencies[i] = ms_since (sent);
+  }
+
+  phosh_bench_results_add_one (ctx->results, "notification-flood", "notifications/s",
+                               n_notifications / (ms_since (start) / 1000.0));
+  phosh_bench_results_add (ctx->results, "notification-latency", "ms",
+                           latencies, n_notifications);
+}
+
+/* Lock and unlock */
+
+static void
+on_unlock_idle (gpointer data)
+{
+  phosh_shell_set_locked (phosh_shell_get_default (), FALSE);
+}
+
+
+static void
+bench_lock_unlock (PhoshBenchContext *ctx)
+{
+  g_autoptr (PhoshDBusScreenSaver) ss_proxy = NULL;
+  g_autoptr (GError) err = NULL;
+  double lock[N_ITERATIONS], unlock[N_ITERATIONS];
+
+  ss_proxy = phosh_dbus_screen_saver_proxy_new_for_bus_sync (G_BUS_TYPE_SESSION,
+                                                             G_DBUS_PROXY_FLAGS_NONE,
+                                                             "org.gnome.ScreenSaver",
+                                                             "/org/gnome/ScreenSaver",
+                                                             NULL,
+                                                             &err);
+  g_assert_no_error (err);
+
+  for (int i = 0; i < N_ITERATIONS; i++) {
+    gint64 start = g_get_monotonic_time ();
+
+    phosh_dbus_screen_saver_call_lock_sync (ss_proxy, NULL, &err);
+    g_assert_no_error (err);
+    phosh_test_wait_for_shell_state_wait (ctx->waiter, PHOSH_STATE_LOCKED, TRUE, WAIT_TIMEOUT);
+    lock[i] = ms_since (start);
+    wait_a_bit (ctx->loop, 500);
+
+    start = g_get_monotonic_time ();
+    g_idle_add_once (on_unlock_idle, NULL);
+    phosh_test_wait_for_shell_state_wait (ctx->waiter, PHOSH_STATE_LOCKED, FALSE, WAIT_TIMEOUT);
+    unlock[i] = ms_since (start);
+    /* Give the lockscreen manager time to prepare the next lock */
+    wait_a_bit (ctx->loop, 3000);
+  }
+
+  phosh_bench_results_add (ctx->results, "lock", "ms", lock, N_ITERATIONS);
+  phosh_bench_results_add (ctx->results, "unlock", "ms", unlock, N_ITERATIONS);
+}
+
+
+/* Restyling */
+
+typedef enum {
+  PHOSH_BENCH_RESTYLE_ACCENT,
+  PHOSH_BENCH_RESTYLE_HIGH_CONTRAST,
+  PHOSH_BENCH_RESTYLE_THEME,
+} PhoshBenchRestyleKind;
+
+/* Setting the theme name directly overrides the GSettings based one so keep it last */
+static const char *restyle_kinds[] = { "accent", "high-contrast", "theme" };
+
+
+typedef struct {
+  GAsyncQueue           *queue;
+  GType                  scene;
+  PhoshBenchRestyleKind  kind;
+  gboolean               on;
+  GtkWidget             *widget;
+  GdkFrameClock         *frame_clock;
+  gboolean               changed;
+  gint64                 start;
+  double                 elapsed;
+} PhoshBenchRestyle;
+
+
+static void
+on_restyle_style_updated (PhoshBenchRestyle *restyle)
+{
+  restyle->changed = TRUE;
+}
+
+
+static void
+on_restyle_after_paint (PhoshBenchRestyle *restyle)
+{
+  if (!restyle->changed)
+    return;
+
+  restyle->elapsed = ms_since (restyle->start);
+  g_signal_handlers_disconnect_by_data (restyle->widget, restyle);
+  g_signal_handlers_disconnect_by_data (restyle->frame_clock, restyle);
+  g_async_queue_push (restyle->queue, GINT_TO_POINTER (TRUE));
+}
+
+/* Runs in the shell's thread */
+static void
+on_restyle_idle (gpointer data)
+{
+  PhoshBenchRestyle *restyle = data;
+  g_autoptr (GSettings) settings = g_settings_new ("org.gnome.desktop.interface");
+  GtkSettings *gtk_settings = gtk_settings_get_default ();
+
+  restyle->widget = find_toplevel (restyle->scene);
+  g_assert_nonnull (restyle->widget);
+  restyle->frame_clock = gtk_widget_get_frame_clock (restyle->widget);
+  restyle->changed = FALSE;
+
+  g_signal_connect_swapped (restyle->widget, "style-updated",
+                            G_CALLBACK (on_restyle_style_updated), restyle);
+  g_signal_connect_swapped (restyle->frame_clock, "after-paint",
+                            G_CALLBACK (on_restyle_after_paint), restyle);
+  restyle->start = g_get_monotonic_time ();
+
+  switch (restyle->kind) {
+  case PHOSH_BENCH_RESTYLE_ACCENT:
+    g_settings_set_enum (settings, "accent-color",
+                         restyle->on ? G_DESKTOP_ACCENT_COLOR_PURPLE : G_DESKTOP_ACCENT_COLOR_BLUE);
+    break;
+  case PHOSH_BENCH_RESTYLE_HIGH_CONTRAST:
+    /* Like automatic high contrast does */
+    if (restyle->on)
+      g_settings_set_string (settings, "gtk-theme", "HighContrast");
+    else
+      g_settings_reset (settings, "gtk-theme");
+    break;
+  case PHOSH_BENCH_RESTYLE_THEME:
+    if (restyle->on)
+      g_object_set (gtk_settings, "gtk-theme-name", "HighContrast", NULL);
+    else
+      gtk_settings_reset_property (gtk_settings, "gtk-theme-name");
+    break;
+  default:
+    g_assert_not_reached ();
+  }
+}
+
+
+static void
+bench_restyle_scene (PhoshBenchContext *ctx, GType scene, const char *scene_name)
+{
+  for (guint k = 0; k < G_N_ELEMENTS (restyle_kinds); k++) {
+    g_autofree char *kpi = g_strdup_printf ("restyle-%s-%s", restyle_kinds[k], scene_name);
+    double samples[N_RESTYLES];
+
+    for (int i = 0; i < N_RESTYLES; i++) {
+      g_autoptr (GAsyncQueue) queue = g_async_queue_new ();
+      PhoshBenchRestyle restyle = {
+        .queue = queue,
+        .scene = scene,
+        .kind = k,
+        .on = !(i % 2),
+      };
+
+      g_idle_add_once (on_restyle_idle, &restyle);
+      g_assert_nonnull (g_async_queue_timeout_pop (queue, WAIT_TIMEOUT * 1000));
+      samples[i] = restyle.elapsed;
+      wait_a_bit (ctx->loop, 300);
+    }
+
+    phosh_bench_results_add (ctx->results, kpi, "ms", samples, N_RESTYLES);
+  }
+}
+
+
+static void
+on_top_panel_fold_idle (gpointer data)
+{
+  PhoshTopPanel *top_panel = PHOSH_TOP_PANEL (find_toplevel (PHOSH_TYPE_TOP_PANEL));
+
+  g_assert_true (PHOSH_IS_TOP_PANEL (top_panel));
+  if (GPOINTER_TO_INT (data))
+    phosh_top_panel_fold (top_panel);
+  else
+    phosh_top_panel_unfold (top_panel);
+}
+
+
+static void
+bench_restyle (PhoshBenchContext *ctx)
+{
+  g_autoptr (PhoshDBusScreenSaver) ss_proxy = NULL;
+  g_autoptr (GError) err = NULL;
+  guint n_toplevels = phosh_bench_get_env_uint ("PHOSH_BENCH_TOPLEVELS", DEFAULT_TOPLEVELS);
+  GPid *pids;
+
+  /* Top panel with the quick settings unfolded */
+  g_idle_add_once (on_top_panel_fold_idle, GINT_TO_POINTER (FALSE));
+  phosh_test_wait_for_shell_state_wait (ctx->waiter, PHOSH_STATE_SETTINGS, TRUE, WAIT_TIMEOUT);
+  wait_a_bit (ctx->loop, 500);
+  bench_restyle_scene (ctx, PHOSH_TYPE_TOP_PANEL, "quick-settings");
+  g_idle_add_once (on_top_panel_fold_idle, GINT_TO_POINTER (TRUE));
+  phosh_test_wait_for_shell_state_wait (ctx->waiter, PHOSH_STATE_SETTINGS, FALSE, WAIT_TIMEOUT);
+
+  /* Overview with running activities */
+  pids = spawn_apps (ctx, n_toplevels);
+  toggle_overview (ctx, TRUE);
+  wait_a_bit (ctx->loop, 500);
+  bench_restyle_scene (ctx, PHOSH_TYPE_HOME, "overview");
+  toggle_overview (ctx, FALSE);
+  kill_apps (ctx, pids, n_toplevels);
+
+  /* Lock screen */
+  ss_proxy = phosh_dbus_screen_saver_proxy_new_for_bus_sync (G_BUS_TYPE_SESSION,
+                                                             G_DBUS_PROXY_FLAGS_NONE,
+                                                             "org.gnome.ScreenSaver",
+                                                             "/org/gnome/ScreenSaver",
+                                                             NULL,
+                                                             &err);
+  g_assert_no_error (err);
+  phosh_dbus_screen_saver_call_lock_sync (ss_proxy, NULL, &err);
+  g_assert_no_error (err);
+  phosh_test_wait_for_shell_state_wait (ctx->waiter, PHOSH_STATE_LOCKED, TRUE, WAIT_TIMEOUT);
+  wait_a_bit (ctx->loop, 500);
+  bench_restyle_scene (ctx, PHOSH_TYPE_LOCKSCREEN, "lockscreen");
+  g_idle_add_once (on_unlock_idle, NULL);
+  phosh_test_wait_for_shell_state_wait (ctx->waiter, PHOSH_STATE_LOCKED, FALSE, WAIT_TIMEOUT);
+  /* Give the lockscreen manager time to prepare the next lock */
+  wait_a_bit (ctx->loop, 3000);
+}
+
+
+static void
+bench_setup (PhoshBenchFixture *fixture, gconstpointer data)
+{
+  g_autoptr (GError) err = NULL;
+  g_autofree char *data_dirs = NULL;
+
+  fixture->corpus = phosh_bench_corpus_create (phosh_bench_get_env_uint ("PHOSH_BENCH_APPS",
+                                                                         DEFAULT_APPS),
+                                               &err);
+  g_assert_no_error (err);
+
+  /* Needs to be in place before the shell looks up apps */
+  data_dirs = g_strjoin (":",
+                         fixture->corpus,
+                         g_getenv ("XDG_DATA_DIRS") ?: "/usr/local/share:/usr/share",
+                         NULL);
+  g_setenv ("XDG_DATA_DIRS", data_dirs, TRUE);
+
+  fixture->start = g_get_monotonic_time ();
+  phosh_test_full_shell_setup (&fixture->full_shell, data);
+}
+
+
+static void
+bench_teardown (PhoshBenchFixture *fixture, gconstpointer data)
+{
+  phosh_test_full_shell_teardown (&fixture->full_shell, data);
+
+  phosh_bench_corpus_remove (fixture->corpus);
+  g_free (fixture->corpus);
+}
+
+
+static void
+bench_shell (PhoshBenchFixture *fixture, gconstpointer unused)
+{
+  g_autoptr (GTimer) timer = g_timer_new ();
+  g_autoptr (GMainContext) context = g_main_context_new ();
+  g_autoptr (GMainLoop) loop = g_main_loop_new (context, FALSE);
+  g_autoptr (PhoshTestWaitForShellState) waiter = NULL;
+  g_autoptr (PhoshBenchResults) results = phosh_bench_results_new ("shell");
+  PhoshBenchContext ctx = { .timer = timer, .loop = loop, .results = results };
+  const char *budgets = g_getenv ("PHOSH_BENCH_BUDGETS");
+  PhoshShell *shell;
+
+  if (budgets) {
+    g_autoptr (GError) err = NULL;
+
+    phosh_bench_results_load_budgets (results, budgets, &err);
+    g_assert_no_error (err);
+  }
+
+  /* Wait until compositor and shell are up */
+  g_assert_nonnull (g_async_queue_timeout_pop (fixture->full_shell.queue, POP_TIMEOUT));
+  phosh_bench_results_add_one (results, "boot", "ms", ms_since (fixture->start));
+
+  shell = phosh_shell_get_default ();
+  waiter = phosh_test_wait_for_shell_state_new (shell);
+  ctx.waiter = waiter;
+  ctx.keyboard = phosh_test_keyboard_new (phosh_wayland_get_default ());
+
+  g_signal_connect (phosh_shell_get_toplevel_manager (shell),
+                    "notify::num-toplevels",
+                    G_CALLBACK (on_num_toplevels_changed),
+                    NULL);
+
+  bench_search (&ctx);
+  bench_overview (&ctx);
+  bench_notifications (&ctx);
+  bench_lock_unlock (&ctx);
+  bench_restyle (&ctx);
+
+  zwp_virtual_keyboard_v1_destroy (ctx.keyboard);
+
+  phosh_bench_results_write (results);
+  g_assert_true (phosh_bench_results_check (results));
+}
+
+
+static void
+do_settings (void)
+{
+  g_autoptr (GSettings) settings = g_settings_new ("sm.puri.phosh.notifications");
+
+  /* Measure the notification server, not the rate limiting */
+  g_settings_set_uint (settings, "rate-limit-burst", 0);
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  g_autoptr (PhoshTestFullShellFixtureCfg) cfg = NULL;
+
+  g_test_init (&argc, &argv, NULL);
+
+  phosh_test_register_resource ();
+  do_settings ();
+
+  cfg = phosh_test_full_shell_fixture_cfg_new (NULL);
+
+  g_test_add ("/phosh/benchmarks/shell", PhoshBenchFixture, cfg,
+              bench_setup, bench_shell, bench_teardown);
+
+  return g_test_run ();
+}
@@ -0,0 +1,571 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "phosh-config.h"
+
+#include "benchlib.h"
+
+#include <gio/gio.h>
+#include <glib/gstdio.h>
+
+#include <errno.h>
+#include <stdlib.h>
+
+/**
+ * PhoshBenchResults:
+ *
+ * Collects the KPIs measured by a benchmark and emits them as JSON
+ * so they can be compared between releases. The output goes to
+ * stdout and, if `PHOSH_BENCH_OUTPUT_DIR` is set, to `<name>.json`
+ * in that directory.
+ */
+struct _PhoshBenchResults {
+  char       *name;
+  GString    *kpis;
+  /* KPI name → median */
+  GHashTable *medians;
+  GKeyFile   *budgets;
+};
+
+#define BUDGET_DEFAULTS_GROUP "defaults"
+#define DEFAULT_TOLERANCE 20.0
+
+
+PhoshBenchResults *
+phosh_bench_results_new (const char *name)
+{
+  PhoshBenchResults *self = g_new0 (PhoshBenchResults, 1);
+
+  self->name = g_strdup (name);
+  self->kpis = g_string_new (NULL);
+  self->medians = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+
+  return self;
+}
+
+
+void
+phosh_bench_results_free (PhoshBenchResults *self)
+{
+  g_free (self->name);
+  g_string_free (self->kpis, TRUE);
+  g_hash_table_destroy (self->medians);
+  g_clear_pointer (&self->budgets, g_key_file_free);
+  g_free (self);
+}
+
+
+static int
+cmp_double (gconstpointer a, gconstpointer b)
+{
+  double da = *(const double *)a;
+  double db = *(const double *)b;
+
+  return (da > db) - (da < db);
+}
+
+
+static void
+append_double (GString *str, double value)
+{
+  char buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+  /* JSON wants a '.' no matter the locale */
+  g_string_append (str, g_ascii_formatd (buf, sizeof (buf), "%.3f", value));
+}
+
+/**
+ * phosh_bench_results_add:
+ * @self: The results
+ * @kpi: The KPI's name
+ * @unit: The unit of the values
+ * @values: The measured values
+ * @n_values: The number of values
+ *
+ * Adds a KPI with all its samples. Minimum, median and maximum are
+ * added as well.
+ */
+void
+phosh_bench_results_add (PhoshBenchResults *self,
+                         const char        *kpi,
+                         const char        *unit,
+                         const double      *values,
+                         guint              n_values)
+{
+  g_autofree double *sorted = NULL;
+
+  g_return_if_fail (n_values > 0);
+
+  sorted = g_memdup2 (values, n_values * sizeof (double));
+  qsort (sorted, n_values, sizeof (double), cmp_double);
+
+  if (self->kpis->len)
+    g_string_append (self->kpis, ",\n");
+
+  g_string_append_printf (self->kpis, "    \"%s\": { \"unit\": \"%s\", \"min\": ", kpi, unit);
+  append_double (self->kpis, sorted[0]);
+  g_string_append (self->kpis, ", \"median\": ");
+  append_double (self->kpis, sorted[n_values / 2]);
+  g_string_append (self->kpis, ", \"max\": ");
+  append_double (self->kpis, sorted[n_values - 1]);
+  g_string_append (self->kpis, ", \"values\": [");
+  for (guint i = 0; i < n_values; i++) {
+    if (i)
+      g_string_append (self->kpis, ", ");
+    append_double (self->kpis, values[i]);
+  }
+  g_string_append (self->kpis, "] }");
+
+  g_hash_table_insert (self->medians, g_strdup (kpi), g_memdup2 (&sorted[n_values / 2], sizeof (double)));
+}
+
+
+void
+phosh_bench_results_add_one (PhoshBenchResults *self,
+                             const char        *kpi,
+                             const char        *unit,
+                             double             value)
+{
+  phosh_bench_results_add (self, kpi, unit, &value, 1);
+}
+
+/**
+ * phosh_bench_results_load_budgets:
+ * @self: The results
+ * @path: The budget file
+ * @error: Return location for an error
+ *
+ * Loads the budgets the KPIs are checked against. The file is a key
+ * file with a group per KPI. `max` is the upper bound of the KPI's
+ * median (e.g. for latencies), `min` the lower bound (e.g. for
+ * throughput). A median may exceed the bound by `tolerance` percent
+ * before it counts as a regression. The `defaults` group can set the
+ * tolerance for all KPIs:
+ *
+ * ```
+ * [defaults]
+ * tolerance=25
+ *
+ * [boot]
+ * max=4000
+ *
+ * [notification-flood]
+ * min=100
+ * tolerance=50
+ * ```
+ *
+ * Returns: %TRUE if the budgets could be loaded
+ */
+gboolean
+phosh_bench_results_load_budgets (PhoshBenchResults *self, const char *path, GError **error)
+{
+  g_autoptr (GKeyFile) budgets = g_key_file_new ();
+
+  if (!g_key_file_load_from_file (budgets, path, G_KEY_FILE_NONE, error))
+    return FALSE;
+
+  g_clear_pointer (&self->budgets, g_key_file_free);
+  self->budgets = g_steal_pointer (&budgets);
+
+  return TRUE;
+}
+
+
+static double
+get_budget_double (GKeyFile *budgets, const char *group, const char *key, double fallback)
+{
+  g_autoptr (GError) err = NULL;
+  double value;
+
+  value = g_key_file_get_double (budgets, group, key, &err);
+  if (err)
+    return fallback;
+
+  return value;
+}
+
+/*
+ * Checks the collected KPIs against the budgets. The outcome is
+ * appended as JSON to `checks` or logged if `checks` is %NULL.
+ * Returns the number of regressions.
+ */
+static guint
+check_budgets (PhoshBenchResults *self, GString *checks)
+{
+  g_auto (GStrv) groups = NULL;
+  double default_tolerance;
+  guint n_regressions = 0;
+
+  if (self->budgets == NULL)
+    return 0;
+
+  default_tolerance = get_budget_double (self->budgets, BUDGET_DEFAULTS_GROUP, "tolerance",
+                                         DEFAULT_TOLERANCE);
+
+  groups = g_key_file_get_groups (self->budgets, NULL);
+  for (int i = 0; groups[i]; i++) {
+    const char *kpi = groups[i];
+    double *median, tolerance, limit;
+    gboolean is_max, regressed;
+
+    if (g_str_equal (kpi, BUDGET_DEFAULTS_GROUP))
+      continue;
+
+    is_max = g_key_file_has_key (self->budgets, kpi, "max", NULL);
+    if (!is_max && !g_key_file_has_key (self->budgets, kpi, "min", NULL)) {
+      g_warning ("Budget for '%s' has neither 'min' nor 'max'", kpi);
+      continue;
+    }
+
+    tolerance = get_budget_double (self->budgets, kpi, "tolerance", default_tolerance) / 100.0;
+    if (is_max)
+      limit = get_budget_double (self->budgets, kpi, "max", 0.0) * (1.0 + tolerance);
+    else
+      limit = get_budget_double (self->budgets, kpi, "min", 0.0) * (1.0 - tolerance);
+
+    median = g_hash_table_lookup (self->medians, kpi);
+    /* A KPI that went missing is as bad as a regressed one */
+    regressed = median == NULL || (is_max ? *median > limit : *median < limit);
+    n_regressions += regressed;
+
+    if (checks == NULL) {
+      if (median == NULL)
+        g_message ("KPI '%s' has a budget but wasn't measured", kpi);
+      else if (regressed)
+        g_message ("KPI '%s' regressed: median %.3f, %s %.3f", kpi, *median,
+                   is_max ? "max" : "min", limit);
+      continue;
+    }
+
+    if (checks->len)
+      g_string_append (checks, ",\n");
+    g_string_append_printf (checks, "    \"%s\": { \"%s\": ", kpi, is_max ? "max" : "min");
+    append_double (checks, limit);
+    g_string_append (checks, ", \"median\": ");
+    if (median)
+      append_double (checks, *median);
+    else
+      g_string_append (checks, "null");
+    g_string_append_printf (checks, ", \"regressed\": %s }", regressed ? "true" : "false");
+  }
+
+  return n_regressions;
+}
+
+/**
+ * phosh_bench_results_check:
+ * @self: The results
+ *
+ * Checks the KPIs' medians against the budgets loaded via
+ * phosh_bench_results_load_budgets(). Regressions are logged.
+ *
+ * Returns: %TRUE if no KPI regressed. Always %TRUE without budgets.
+ */
+gboolean
+phosh_bench_results_check (PhoshBenchResults *self)
+{
+  return check_budgets (self, NULL) == 0;
+}
+
+/**
+ * phosh_bench_results_write:
+ * @self: The results
+ *
+ * Emits the collected KPIs as JSON. If budgets were loaded the
+ * outcome of checking the KPIs against them is included too.
+ */
+void
+phosh_bench_results_write (PhoshBenchResults *self)
+{
+  g_autofree char *json = NULL;
+  g_autoptr (GString) checks = NULL;
+  const char *outdir = g_getenv ("PHOSH_BENCH_OUTPUT_DIR");
+
+  if (self->budgets) {
+    checks = g_string_new (NULL);
+    check_budgets (self, checks);
+  }
+
+  json = g_strdup_printf ("{\n"
+                          "  \"benchmark\": \"%s\",\n"
+                          "  \"version\": \"%s\",\n"
+                          "  \"kpis\": {\n%s\n  }%s%s%s\n"
+                          "}\n",
+                          self->name,
+                          PHOSH_VERSION,
+                          self->kpis->str,
+                          checks ? ",\n  \"checks\": {\n" : "",
+                          checks ? checks->str : "",
+                          checks ? "\n  }" : "");
+  g_print ("%s", json);
+
+  if (outdir) {
+    g_autofree char *basename = g_strdup_printf ("%s.json", self->name);
+    g_autofree char *path = g_build_filename (outdir, basename, NULL);
+    g_autoptr (GError) err = NULL;
+
+    if (!g_file_set_contents (path, json, -1, &err))
+      g_warning ("Failed to write %s: %s", path, err->message);
+  }
+}
+
+/**
+ * phosh_bench_get_env_uint:
+ * @name: The environment variable
+ * @fallback: The value to use if unset
+ *
+ * Returns: The environment variable's value as unsigned integer
+ */
+guint
+phosh_bench_get_env_uint (const char *name, guint fallback)
+{
+  const char *env = g_getenv (name);
+
+  if (env)
+    return g_ascii_strtoull (env, NULL, 10);
+
+  return fallback;
+}
+
+static const char *generic_names[] = { "Viewer", "Editor", "Player", "Browser", "Calculator" };
+
+static const char *keywords[] = {
+  "audio", "camera", "chat", "clock", "contacts", "document", "draw", "email", "files",
+  "game", "map", "music", "news", "notes", "office", "phone", "photo", "podcast",
+  "reader", "settings", "shop", "sports", "terminal", "translate", "travel", "video",
+  "weather", "web",
+};
+
+#define ICON_SVG \
+  "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"64\" height=\"64\">" \
+  "<rect width=\"64\" height=\"64\" rx=\"12\" fill=\"#%06x\"/></svg>\n"
+
+
+static gboolean
+make_dir (const char *path, GError **error)
+{
+  if (g_mkdir (path, 0755) != 0) {
+    g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errno), "Failed to create %s", path);
+    return FALSE;
+  }
+  return TRUE;
+}
+
+/**
+ * phosh_bench_corpus_get_app_id:
+ * @n: The number of the app
+ *
+ * Returns: The app id of the `n`th app of a corpus
+ */
+char *
+phosh_bench_corpus_get_app_id (guint n)
+{
+  return g_strdup_printf ("mobi.phosh.BenchApp%03u.desktop", n);
+}
+
+
+static char *
+get_app_desktop_file (const PhoshBenchCorpusCfg *cfg, guint n)
+{
+  g_autoptr (GString) kw = g_string_new ("bench;synthetic;");
+  g_autofree char *icon = NULL;
+
+  for (guint k = 0; k < cfg->n_keywords; k++) {
+    /* Spread the keywords so apps share some but not all of them */
+    g_string_append_printf (kw, "%s;", keywords[(n * 7 + k) % G_N_ELEMENTS (keywords)]);
+  }
+
+  if (cfg->n_icons)
+    icon = g_strdup_printf ("phosh-bench-icon-%u", n % cfg->n_icons);
+  else
+    icon = g_strdup ("application-x-executable");
+
+  return g_strdup_printf ("[Desktop Entry]\n"
+                          "Type=Application\n"
+                          "Name=Benchmark App %03u\n"
+                          "GenericName=%s\n"
+                          "Comment=Synthetic application for benchmarks\n"
+                          "Exec=true\n"
+                          "Icon=%s\n"
+                          "Keywords=%s\n"
+                          "Categories=Utility;\n"
+                          "X-Purism-FormFactor=Workstation;Mobile;\n",
+                          n,
+                          generic_names[n % G_N_ELEMENTS (generic_names)],
+                          icon,
+                          kw->str);
+}
+
+/**
+ * phosh_bench_corpus_create_full:
+ * @cfg: The corpus description
+ * @datadir:(nullable): The data dir to use
+ * @error: Return location for an error
+ *
+ * Creates a data dir with `cfg->n_apps` synthetic desktop files in
+ * its `applications` folder. Prepend it to `XDG_DATA_DIRS` before the
+ * first use of `GAppInfo`. App names are `Benchmark App <n>` with `n`
+ * zero padded to three digits so searching e.g. for "app 042" matches
+ * exactly one app. Each app gets `cfg->n_keywords` keywords from a
+ * fixed word list. If `cfg->n_icons` is non-zero that many distinct
+ * unthemed icons are created in the data dir's `icons` folder and
+ * shared between the apps.
+ *
+ * If `datadir` is %NULL a temporary directory is created, otherwise
+ * `datadir` must exist and be empty.
+ *
+ * Folders aren't part of the data dir, see
+ * phosh_bench_corpus_setup_folders().
+ *
+ * Returns: The data dir or %NULL on error
+ */
+char *
+phosh_bench_corpus_create_full (const PhoshBenchCorpusCfg *cfg,
+                                const char                *datadir,
+                                GError                   **error)
+{
+  g_autofree char *dir = NULL;
+  g_autofree char *appdir = NULL;
+
+  g_return_val_if_fail (cfg, NULL);
+
+  if (datadir) {
+    dir = g_strdup (datadir);
+  } else {
+    dir = g_dir_make_tmp ("phosh-bench-corpus.XXXXXX", error);
+    if (dir == NULL)
+      return NULL;
+  }
+
+  appdir = g_build_filename (dir, "applications", NULL);
+  if (!make_dir (appdir, error))
+    goto err;
+
+  for (guint i = 0; i < cfg->n_apps; i++) {
+    g_autofree char *basename = phosh_bench_corpus_get_app_id (i);
+    g_autofree char *path = g_build_filename (appdir, basename, NULL);
+    g_autofree char *contents = get_app_desktop_file (cfg, i);
+
+    if (!g_file_set_contents (path, contents, -1, error))
+      goto err;
+  }
+
+  if (cfg->n_icons) {
+    g_autofree char *icondir = g_build_filename (dir, "icons", NULL);
+
+    if (!make_dir (icondir, error))
+      goto err;
+
+    for (guint i = 0; i < cfg->n_icons; i++) {
+      g_autofree char *basename = g_strdup_printf ("phosh-bench-icon-%u.svg", i);
+      g_autofree char *path = g_build_filename (icondir, basename, NULL);
+      g_autofree char *contents = g_strdup_printf (ICON_SVG, g_str_hash (basename) & 0xffffff);
+
+      if (!g_file_set_contents (path, contents, -1, error))
+        goto err;
+    }
+  }
+
+  return g_steal_pointer (&dir);
+
+ err:
+  phosh_bench_corpus_remove (dir);
+  return NULL;
+}
+
+/**
+ * phosh_bench_corpus_create:
+ * @n_apps: The number of apps to create
+ * @error: Return location for an error
+ *
+ * Creates a temporary data dir with `n_apps` synthetic desktop files,
+ * see phosh_bench_corpus_create_full().
+ *
+ * Returns: The data dir or %NULL on error
+ */
+char *
+phosh_bench_corpus_create (guint n_apps, GError **error)
+{
+  PhoshBenchCorpusCfg cfg = { .n_apps = n_apps };
+
+  return phosh_bench_corpus_create_full (&cfg, NULL, error);
+}
+
+/**
+ * phosh_bench_corpus_setup_folders:
+ * @cfg: The corpus description
+ *
+ * Creates `cfg->n_folders` app folders via GSettings. Folder `n`
+ * contains `cfg->apps_per_folder` consecutive apps starting at app
+ * `n * cfg->apps_per_folder`. Meant to be used with the memory
+ * GSettings backend so the user's folders stay untouched.
+ */
+void
+phosh_bench_corpus_setup_folders (const PhoshBenchCorpusCfg *cfg)
+{
+  g_autoptr (GSettings) settings = g_settings_new (PHOSH_BENCH_FOLDERS_SCHEMA_ID);
+  g_autoptr (GStrvBuilder) children = g_strv_builder_new ();
+  g_auto (GStrv) folders = NULL;
+
+  for (guint f = 0; f < cfg->n_folders; f++) {
+    g_autofree char *id = g_strdup_printf ("bench-folder-%02u", f);
+    g_autofree char *name = g_strdup_printf ("Benchmark Folder %02u", f);
+    g_autofree char *path = g_strdup_printf ("/org/gnome/desktop/app-folders/folders/%s/", id);
+    g_autoptr (GSettings) folder = NULL;
+    g_autoptr (GStrvBuilder) apps = g_strv_builder_new ();
+    g_auto (GStrv) app_ids = NULL;
+
+    for (guint i = 0; i < cfg->apps_per_folder; i++) {
+      guint n = f * cfg->apps_per_folder + i;
+
+      if (n >= cfg->n_apps)
+        break;
+      g_strv_builder_take (apps, phosh_bench_corpus_get_app_id (n));
+    }
+    app_ids = g_strv_builder_end (apps);
+
+    folder = g_settings_new_with_path (PHOSH_BENCH_FOLDER_SCHEMA_ID, path);
+    g_settings_set_string (folder, "name", name);
+    g_settings_set_strv (folder, "apps", (const char * const *) app_ids);
+
+    g_strv_builder_add (children, id);
+  }
+
+  folders = g_strv_builder_end (children);
+  g_settings_set_strv (settings, "folder-children", (const char * const *) folders);
+}
+
+
+static void
+remove_files (const char *path)
+{
+  g_autoptr (GDir) dir = g_dir_open (path, 0, NULL);
+  const char *name;
+
+  while (dir && (name = g_dir_read_name (dir))) {
+    g_autofree char *filename = g_build_filename (path, name, NULL);
+
+    g_unlink (filename);
+  }
+  g_rmdir (path);
+}
+
+/**
+ * phosh_bench_corpus_remove:
+ * @datadir: The data dir created by phosh_bench_corpus_create()
+ *
+ * Removes the corpus again.
+ */
+void
+phosh_bench_corpus_remove (const char *datadir)
+{
+  g_autofree char *appdir = g_build_filename (datadir, "applications", NULL);
+  g_autofree char *icondir = g_build_filename (datadir, "icons", NULL);
+
+  remove_files (appdir);
+  remove_files (icondir);
+  g_rmdir (datadir);
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <glib.h>
+
+#pragma once
+
+G_BEGIN_DECLS
+
+/* Not using folder-info.h's define so the lib doesn't need phosh's headers */
+#define PHOSH_BENCH_FOLDERS_SCHEMA_ID "org.gnome.desktop.app-folders"
+#define PHOSH_BENCH_FOLDER_SCHEMA_ID  "org.gnome.desktop.app-folders.folder"
+
+typedef struct _PhoshBenchResults PhoshBenchResults;
+
+/**
+ * PhoshBenchCorpusCfg:
+ * @n_apps: The number of apps
+ * @n_keywords: The number of keywords per app
+ * @n_icons: The number of distinct icons, 0 to use a themed icon
+ * @n_folders: The number of app folders
+ * @apps_per_folder: The number of apps in each folder
+ *
+ * Describes a synthetic app corpus.
+ */
+typedef struct _PhoshBenchCorpusCfg {
+  guint n_apps;
+  guint n_keywords;
+  guint n_icons;
+  guint n_folders;
+  guint apps_per_folder;
+} PhoshBenchCorpusCfg;
+
+PhoshBenchResults *phosh_bench_results_new    (const char        *name);
+void               phosh_bench_results_free   (PhoshBenchResults *self);
+void               phosh_bench_results_add    (PhoshBenchResults *self,
+                                               const char        *kpi,
+                                               const char        *unit,
+                                               const double      *values,
+                                               guint              n_values);
+void               phosh_bench_results_add_one (PhoshBenchResults *self,
+                                                const char        *kpi,
+                                                const char        *unit,
+                                                double             value);
+void               phosh_bench_results_write  (PhoshBenchResults *self);
+gboolean           phosh_bench_results_load_budgets (PhoshBenchResults *self,
+                                                     const char        *path,
+                                                     GError           **error);
+gboolean           phosh_bench_results_check  (PhoshBenchResults *self);
+
+guint              phosh_bench_get_env_uint   (const char        *name,
+                                               guint              fallback);
+
+char              *phosh_bench_corpus_create  (guint              n_apps,
+                                               GError           **error);
+char              *phosh_bench_corpus_create_full (const PhoshBenchCorpusCfg *cfg,
+                                                   const char                *datadir,
+                                                   GError                   **error);
+void               phosh_bench_corpus_setup_folders (const PhoshBenchCorpusCfg *cfg);
+char              *phosh_bench_corpus_get_app_id (guint              n);
+void               phosh_bench_corpus_remove  (const char        *datadir);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (PhoshBenchResults, phosh_bench_results_free)
+
+G_END_DECLS
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Create a synthetic app corpus to run e.g. tools/app-grid-standalone
+ * against:
+ *
+ *   XDG_DATA_DIRS=$(gen-app-corpus --apps 1000):/usr/share app-grid-standalone
+ */
+
+#include "benchlib.h"
+
+#include <gio/gio.h>
+
+
+int
+main (int argc, char **argv)
+{
+  g_autoptr (GOptionContext) opt_context = NULL;
+  g_autoptr (GError) err = NULL;
+  g_autofree char *datadir = NULL;
+  g_autofree char *output = NULL;
+  int n_apps = 500, n_keywords = 5, n_icons = 50;
+  PhoshBenchCorpusCfg cfg;
+  const GOptionEntry options [] = {
+    { "apps", 'a', 0, G_OPTION_ARG_INT, &n_apps, "Number of apps", "N" },
+    { "keywords", 'k', 0, G_OPTION_ARG_INT, &n_keywords, "Number of keywords per app", "N" },
+    { "icons", 'i', 0, G_OPTION_ARG_INT, &n_icons, "Number of distinct icons", "N" },
+    { "output", 'o', 0, G_OPTION_ARG_FILENAME, &output,
+      "Existing empty directory to use instead of a temporary one", "DIR" },
+    { NULL, 0, 0, G_OPTION_ARG_NONE, NULL, NULL, NULL }
+  };
+
+  opt_context = g_option_context_new ("- create a synthetic app corpus");
+  g_option_context_set_description (opt_context,
+                                    "Prints the data dir to prepend to XDG_DATA_DIRS. "
+                                    "App folders live in GSettings and are only created "
+                                    "by the benchmarks.");
+  g_option_context_add_main_entries (opt_context, options, NULL);
+  if (!g_option_context_parse (opt_context, &argc, &argv, &err)) {
+    g_printerr ("%s\n", err->message);
+    return 1;
+  }
+
+  if (n_apps < 0 || n_keywords < 0 || n_icons < 0) {
+    g_printerr ("Counts must not be negative\n");
+    return 1;
+  }
+
+  cfg = (PhoshBenchCorpusCfg) {
+    .n_apps = n_apps,
+    .n_keywords = n_keywords,
+    .n_icons = n_icons,
+  };
+
+  datadir = phosh_bench_corpus_create_full (&cfg, output, &err);
+  if (datadir == NULL) {
+    g_printerr ("Failed to create corpus: %s\n", err->message);
+    return 1;
+  }
+
+  g_print ("%s\n", datadir);
+
+  return 0;
+}
@@ -16,7 +16,9 @@
 
 #include "phosh-config.h"
 
+#include <errno.h>
 #include <string.h>
+#include <time.h>
 #include <sys/types.h>
 #include <unistd.h>
 
@@ -32,6 +34,13 @@ G_GNUC_END_IGNORE_DEPRECATIONS
 
 #define BUS_NAME PHOSH_APP_ID ".CalendarServer"
 
+/* Expand recurrences a bit beyond the requested range so that the
+ * window sliding forward hits the cache */
+#define EXPANSION_LOOKAHEAD (31 * 24 * 60 * 60)
+#define EXPANSION_CACHE_VERSION 1
+#define EXPANSION_CACHE_SAVE_DELAY 10 /* seconds */
+#define EXPANSION_CACHE_FORMAT "a{s(sxxa(ssxx))}"
+
 static const gchar introspection_xml[] =
   "<node>"
   "  <interface name='" PHOSH_APP_ID ".CalendarServer'>"
@@ -251,6 +260,30 @@ calendar_appointment_new (ECalClient    *cal,
   return appt;
 }
 
+static CalendarAppointment *
+calendar_appointment_copy (const CalendarAppointment *appt)
+{
+  CalendarAppointment *copy = g_new0 (CalendarAppointment, 1);
+
+  copy->id         = g_strdup (appt->id);
+  copy->summary    = g_strdup (appt->summary);
+  copy->start_time = appt->start_time;
+  copy->end_time   = appt->end_time;
+  copy->color      = g_strdup (appt->color);
+
+  return copy;
+}
+
+static gboolean
+calendar_appointment_equal (const CalendarAppointment *a,
+                            const CalendarAppointment *b)
+{
+  return a->start_time == b->start_time &&
+         a->end_time == b->end_time &&
+         g_strcmp0 (a->summary, b->summary) == 0 &&
+         g_strcmp0 (a->color, b->color) == 0;
+}
+
 static void
 calendar_appointment_free (gpointer ptr)
 {
@@ -323,10 +356,343 @@ struct _App
 
   GSList *notify_appointments; /* CalendarAppointment *, for EventsAdded */
   GSList *notify_ids; /* gchar *, for EventsRemoved */
+  GHashTable *sent_appointments; /* id → CalendarAppointment *, as last emitted */
+  GHashTable *expansions; /* source + UID → CachedExpansion * */
+  guint save_expansions_id;
 
   GSList *live_views;
 };
 
+/* The time range a view was started for. When the window slides
+ * forward the existing views are kept and only the newly exposed
+ * range gets a view of its own. */
+typedef struct
+{
+  time_t since;
+  time_t until;
+} ViewRange;
+
+#define VIEW_RANGE_KEY "phosh-calendar-server-range"
+
+static inline ViewRange *
+view_get_range (ECalClientView *view)
+{
+  return g_object_get_data (G_OBJECT (view), VIEW_RANGE_KEY);
+}
+
+static inline gboolean
+app_in_window (App *app, time_t start_time, time_t end_time)
+{
+  return (start_time >= app->since &&
+          start_time < app->until) ||
+         (start_time <= app->since &&
+          (end_time - 1) > app->since);
+}
+
+/* ---------------------------------------------------------------------------------------------------- */
+
+/* The expanded instances of a recurring event. Expanding recurrences
+ * is expensive so we keep the result across view restarts and process
+ * restarts and only redo it when the event changed or the requested
+ * range isn't covered. */
+typedef struct
+{
+  char      *revision;
+  time_t     since;
+  time_t     until;
+  GPtrArray *instances; /* CalendarAppointment *, without color */
+} CachedExpansion;
+
+static void
+cached_expansion_free (gpointer ptr)
+{
+  CachedExpansion *expansion = ptr;
+
+  g_free (expansion->revision);
+  g_ptr_array_unref (expansion->instances);
+  g_free (expansion);
+}
+
+static char *
+get_expansion_cache_path (void)
+{
+  g_autofree char *name = g_strdup_printf ("recurrences-v%d.gvariant", EXPANSION_CACHE_VERSION);
+
+  return g_build_filename (g_get_user_cache_dir (), "phosh", "calendar-server", name, NULL);
+}
+
+/* Identifies a revision of a recurring event. Events without a
+ * timezone depend on the default one so include that too. */
+static char *
+get_component_revision (App *app, ICalComponent *icomp)
+{
+  ICalTime *stamp = NULL;
+  ICalTime *dtstart;
+  ICalProperty *prop;
+  const char *zone = "";
+  char *revision = NULL;
+
+  prop = i_cal_component_get_first_property (icomp, I_CAL_LASTMODIFIED_PROPERTY);
+  if (prop)
+    {
+      stamp = i_cal_property_get_lastmodified (prop);
+      g_object_unref (prop);
+    }
+  else
+    {
+      stamp = i_cal_component_get_dtstamp (icomp);
+    }
+
+  dtstart = i_cal_component_get_dtstart (icomp);
+  if (dtstart && !i_cal_time_is_utc (dtstart) && !i_cal_time_get_timezone (dtstart))
+    zone = app->timezone_location ? app->timezone_location : "UTC";
+
+  if (stamp && !i_cal_time_is_null_time (stamp))
+    {
+      g_autofree char *stamp_str = i_cal_time_as_ical_string (stamp);
+
+      revision = g_strdup_printf ("%s\n%d\n%s",
+                                  stamp_str,
+                                  i_cal_component_get_sequence (icomp),
+                                  zone);
+    }
+
+  g_clear_object (&dtstart);
+  g_clear_object (&stamp);
+
+  return revision;
+}
+
+static gboolean
+save_expansions_cb (gpointer user_data)
+{
+  App *app = user_data;
+  g_autofree char *path = get_expansion_cache_path ();
+  g_autofree char *dir = g_path_get_dirname (path);
+  g_autoptr (GVariant) variant = NULL;
+  g_autoptr (GError) error = NULL;
+  GVariantBuilder builder;
+  GHashTableIter iter;
+  const char *key;
+  CachedExpansion *expansion;
+  time_t now = time (NULL);
+
+  app->save_expansions_id = 0;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE (EXPANSION_CACHE_FORMAT));
+  g_hash_table_iter_init (&iter, app->expansions);
+  while (g_hash_table_iter_next (&iter, (gpointer *) &key, (gpointer *) &expansion))
+    {
+      GVariantBuilder instances;
+
+      /* Nothing of interest left */
+      if (expansion->until < now)
+        {
+          g_hash_table_iter_remove (&iter);
+          continue;
+        }
+
+      g_variant_builder_init (&instances, G_VARIANT_TYPE ("a(ssxx)"));
+      for (guint i = 0; i < expansion->instances->len; i++)
+        {
+          CalendarAppointment *appt = g_ptr_array_index (expansion->instances, i);
+
+          g_variant_builder_add (&instances, "(ssxx)",
+                                 appt->id,
+                                 appt->summary != NULL ? appt->summary : "",
+                                 (gint64) appt->start_time,
+                                 (gint64) appt->end_time);
+        }
+      g_variant_builder_add (&builder, "{s(sxxa(ssxx))}",
+                             key,
+                             expansion->revision,
+                             (gint64) expansion->since,
+                             (gint64) expansion->until,
+                             &instances);
+    }
+  variant = g_variant_ref_sink (g_variant_builder_end (&builder));
+
+  if (g_mkdir_with_parents (dir, 0700) < 0)
+    {
+      g_warning ("Failed to create %s: %s", dir, g_strerror (errno));
+      return G_SOURCE_REMOVE;
+    }
+
+  if (!g_file_set_contents (path,
+                            g_variant_get_data (variant),
+                            g_variant_get_size (variant),
+                            &error))
+    g_warning ("Failed to save recurrence cache: %s", error->message);
+
+  print_debug ("Saved %u expanded recurrences", g_hash_table_size (app->expansions));
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+app_queue_save_expansions (App *app)
+{
+  if (app->save_expansions_id)
+    return;
+
+  app->save_expansions_id = g_timeout_add_seconds (EXPANSION_CACHE_SAVE_DELAY,
+                                                   save_expansions_cb,
+                                                   app);
+}
+
+static void
+app_load_expansions (App *app)
+{
+  g_autofree char *path = get_expansion_cache_path ();
+  g_autofree char *contents = NULL;
+  g_autoptr (GVariant) variant = NULL;
+  g_autoptr (GVariantIter) instances = NULL;
+  g_autoptr (GError) error = NULL;
+  GVariantIter iter;
+  const char *key, *revision;
+  gint64 since, until;
+  gsize len;
+
+  if (!g_file_get_contents (path, &contents, &len, &error))
+    {
+      if (!g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+        g_warning ("Failed to load recurrence cache: %s", error->message);
+      return;
+    }
+
+  variant = g_variant_new_from_data (G_VARIANT_TYPE (EXPANSION_CACHE_FORMAT),
+                                     contents, len, FALSE,
+                                     g_free, g_steal_pointer (&contents));
+  g_variant_ref_sink (variant);
+
+  g_variant_iter_init (&iter, variant);
+  while (g_variant_iter_next (&iter, "{&s(&sxxa(ssxx))}", &key, &revision, &since, &until, &instances))
+    {
+      CachedExpansion *expansion = g_new0 (CachedExpansion, 1);
+      const char *id, *summary;
+      gint64 start, end;
+
+      expansion->revision = g_strdup (revision);
+      expansion->since = since;
+      expansion->until = until;
+      expansion->instances = g_ptr_array_new_with_free_func (calendar_appointment_free);
+
+      while (g_variant_iter_next (instances, "(&s&sxx)", &id, &summary, &start, &end))
+        {
+          CalendarAppointment *appt = g_new0 (CalendarAppointment, 1);
+
+          appt->id = g_strdup (id);
+          appt->summary = g_strdup (summary);
+          appt->start_time = start;
+          appt->end_time = end;
+          g_ptr_array_add (expansion->instances, appt);
+        }
+      g_clear_pointer (&instances, g_variant_iter_free);
+
+      g_hash_table_insert (app->expansions, g_strdup (key), expansion);
+    }
+
+  print_debug ("Loaded %u expanded recurrences", g_hash_table_size (app->expansions));
+}
+
+static void
+app_invalidate_expansion (App *app,
+                          const char *source_uid,
+                          const char *comp_uid)
+{
+  g_autofree char *key = create_event_id (source_uid, comp_uid, NULL);
+
+  if (g_hash_table_remove (app->expansions, key))
+    app_queue_save_expansions (app);
+}
+
+static void
+app_expand_recurrences (App *app,
+                        ECalClient *cal_client,
+                        ICalComponent *icomp,
+                        time_t since,
+                        time_t until)
+{
+  ESource *source = e_client_get_source (E_CLIENT (cal_client));
+  g_autofree char *key = NULL;
+  g_autofree char *revision = NULL;
+  CachedExpansion *expansion;
+  const char *color = NULL;
+
+  key = create_event_id (e_source_get_uid (source), i_cal_component_get_uid (icomp), NULL);
+  revision = get_component_revision (app, icomp);
+  expansion = g_hash_table_lookup (app->expansions, key);
+
+  if (!revision ||
+      !expansion ||
+      g_strcmp0 (expansion->revision, revision) != 0 ||
+      expansion->since > since ||
+      expansion->until < until)
+    {
+      GSList *appointments = NULL;
+      CollectAppointmentsData data;
+
+      data.client = cal_client;
+      data.pappointments = &appointments;
+
+      e_cal_client_generate_instances_for_object_sync (cal_client, icomp,
+                                                       since,
+                                                       until + EXPANSION_LOOKAHEAD,
+                                                       NULL,
+                                                       generate_instances_cb, &data);
+
+      expansion = g_new0 (CachedExpansion, 1);
+      expansion->revision = g_strdup (revision);
+      expansion->since = since;
+      expansion->until = until + EXPANSION_LOOKAHEAD;
+      expansion->instances = g_ptr_array_new_with_free_func (calendar_appointment_free);
+      for (GSList *l = appointments; l; l = g_slist_next (l))
+        {
+          CalendarAppointment *appt = l->data;
+
+          /* The color is per source, no need to store it */
+          g_clear_pointer (&appt->color, g_free);
+          g_ptr_array_add (expansion->instances, appt);
+        }
+      g_slist_free (appointments);
+
+      if (revision)
+        {
+          g_hash_table_replace (app->expansions, g_steal_pointer (&key), expansion);
+          app_queue_save_expansions (app);
+        }
+      else
+        {
+          /* Can't tell when it changes so don't cache it */
+          g_hash_table_remove (app->expansions, key);
+        }
+    }
+
+  if (e_source_has_extension (source, E_SOURCE_EXTENSION_CALENDAR))
+    {
+      ESourceSelectable *ext = e_source_get_extension (source, E_SOURCE_EXTENSION_CALENDAR);
+
+      color = e_source_selectable_get_color (ext);
+    }
+
+  for (guint i = 0; i < expansion->instances->len; i++)
+    {
+      CalendarAppointment *appt = g_ptr_array_index (expansion->instances, i);
+      CalendarAppointment *copy;
+
+      if (appt->start_time >= until ||
+          (appt->end_time <= since && appt->start_time < since))
+        continue;
+
+      copy = calendar_appointment_copy (appt);
+      copy->color = g_strdup (color);
+      app->notify_appointments = g_slist_prepend (app->notify_appointments, copy);
+    }
+
+  if (!revision)
+    cached_expansion_free (expansion);
+}
+
 static void
 app_update_timezone (App *app)
 {
@@ -350,12 +716,11 @@ app_notify_events_added (App *app)
 {
   GVariantBuilder builder;
   GSList *events, *link;
+  guint n_events = 0;
 
   events = g_slist_reverse (app->notify_appointments);
   app->notify_appointments = NULL;
 
-  print_debug ("Emitting EventsAddedOrUpdated with %d events", g_slist_length (events));
-
   if (!events)
     return;
 
@@ -366,31 +731,47 @@ app_notify_events_added (App *app)
   for (link = events; link; link = g_slist_next (link))
     {
       CalendarAppointment *appt = link->data;
-      time_t start_time = appt->start_time;
-      time_t end_time   = appt->end_time;
+      CalendarAppointment *sent;
       GVariantBuilder extras_builder;
 
-      if ((start_time >= app->since &&
-           start_time < app->until) ||
-          (start_time <= app->since &&
-          (end_time - 1) > app->since))
+      if (!app_in_window (app, appt->start_time, appt->end_time))
+        continue;
+
+      /* Only send what the client doesn't know about yet */
+      sent = g_hash_table_lookup (app->sent_appointments, appt->id);
+      if (sent && calendar_appointment_equal (sent, appt))
+        continue;
+
+      g_variant_builder_init (&extras_builder, G_VARIANT_TYPE ("a{sv}"));
+      if (appt->color)
         {
-          g_variant_builder_init (&extras_builder, G_VARIANT_TYPE ("a{sv}"));
-          if (appt->color)
-            {
-              g_variant_builder_add (&extras_builder,
-                                     "{sv}",
-                                     "color",
-                                     g_variant_new_string (appt->color));
-            }
-          g_variant_builder_add (&builder,
-                                 "(ssxxa{sv})",
-                                 appt->id,
-                                 appt->summary != NULL ? appt->summary : "",
-                                 (gint64) start_time,
-                                 (gint64) end_time,
-                                 &extras_builder);
+          g_variant_builder_add (&extras_builder,
+                                 "{sv}",
+                                 "color",
+                                 g_variant_new_string (appt->color));
         }
+      g_variant_builder_add (&builder,
+                             "(ssxxa{sv})",
+                             appt->id,
+                             appt->summary != NULL ? appt->summary : "",
+                             (gint64) appt->start_time,
+                             (gint64) appt->end_time,
+                             &extras_builder);
+      n_events++;
+
+      /* The table takes ownership */
+      g_hash_table_replace (app->sent_appointments, appt->id, appt);
+      link->data = NULL;
+    }
+
+  print_debug ("Emitting EventsAddedOrUpdated with %u of %d events",
+               n_events, g_slist_length (events));
+
+  if (n_events == 0)
+    {
+      g_variant_builder_clear (&builder);
+      g_slist_free_full (events, calendar_appointment_free);
+      return;
     }
 
   g_dbus_connection_emit_signal (app->connection,
@@ -425,6 +806,7 @@ app_notify_events_removed (App *app)
     {
       const gchar *id = link->data;
 
+      g_hash_table_remove (app->sent_appointments, id);
       g_variant_builder_add (&builder, "s", id);
     }
 
@@ -450,6 +832,7 @@ app_process_added_modified_objects (App *app,
   ECalClient *cal_client;
   GSList *link;
   gboolean expand_recurrences;
+  ViewRange *range = view_get_range (view);
 
   cal_client = e_cal_client_view_ref_client (view);
   expand_recurrences = e_cal_client_get_source_type (cal_client) == E_CAL_CLIENT_SOURCE_TYPE_EVENTS;
@@ -466,16 +849,19 @@ app_process_added_modified_objects (App *app,
           !e_cal_util_component_is_instance (icomp) &&
           e_cal_util_component_has_recurrences (icomp))
         {
-          CollectAppointmentsData data;
-
-          data.client = cal_client;
-          data.pappointments = &app->notify_appointments;
-
-          e_cal_client_generate_instances_for_object_sync (cal_client, icomp, app->since, app->until, NULL,
-                                                           generate_instances_cb, &data);
+          /* Only expand the instances in the range of this view */
+          app_expand_recurrences (app, cal_client, icomp,
+                                  MAX (range->since, app->since),
+                                  range->until);
         }
       else
         {
+          /* A detached instance changes its recurrence's expansion */
+          if (e_cal_util_component_is_instance (icomp))
+            app_invalidate_expansion (app,
+                                      e_source_get_uid (e_client_get_source (E_CLIENT (cal_client))),
+                                      i_cal_component_get_uid (icomp));
+
           comp = e_cal_component_new_from_icalcomponent (i_cal_component_clone (icomp));
           if (!comp)
             continue;
@@ -544,6 +930,7 @@ on_objects_removed (ECalClientView *view,
       if (!id)
         continue;
 
+      app_invalidate_expansion (app, source_uid, e_cal_component_id_get_uid (id));
       app->notify_ids = g_slist_prepend (app->notify_ids,
                                          create_event_id (source_uid,
                                          e_cal_component_id_get_uid (id),
@@ -563,8 +950,10 @@ app_has_calendars (App *app)
 }
 
 static ECalClientView *
-app_start_view (App *app,
-                ECalClient *cal_client)
+app_start_view_for_range (App *app,
+                          ECalClient *cal_client,
+                          time_t since,
+                          time_t until)
 {
   g_autofree char *since_iso8601 = NULL;
   g_autofree char *until_iso8601 = NULL;
@@ -572,11 +961,12 @@ app_start_view (App *app,
   const gchar *tz_location;
   ECalClientView *view = NULL;
   g_autoptr (GError) error = NULL;
+  ViewRange *range;
 
-  if (app->since <= 0 || app->since >= app->until)
+  if (since <= 0 || since >= until)
     return NULL;
 
-  if (!app->since || !app->until)
+  if (!since || !until)
     {
       print_debug ("Skipping load of events, no time interval set yet");
       return NULL;
@@ -585,8 +975,8 @@ app_start_view (App *app,
   /* timezone could have changed */
   app_update_timezone (app);
 
-  since_iso8601 = isodate_from_time_t (app->since);
-  until_iso8601 = isodate_from_time_t (app->until);
+  since_iso8601 = isodate_from_time_t (since);
+  until_iso8601 = isodate_from_time_t (until);
   tz_location = i_cal_timezone_get_location (app->zone);
 
   print_debug ("Loading events since %s until %s for calendar '%s'",
@@ -610,6 +1000,11 @@ app_start_view (App *app,
     }
   else
     {
+      range = g_new0 (ViewRange, 1);
+      range->since = since;
+      range->until = until;
+      g_object_set_data_full (G_OBJECT (view), VIEW_RANGE_KEY, range, g_free);
+
       g_signal_connect (view,
                         "objects-added",
                         G_CALLBACK (on_objects_added),
@@ -627,6 +1022,13 @@ app_start_view (App *app,
   return view;
 }
 
+static ECalClientView *
+app_start_view (App *app,
+                ECalClient *cal_client)
+{
+  return app_start_view_for_range (app, cal_client, app->since, app->until);
+}
+
 static void
 app_stop_view (App *app,
                ECalClientView *view)
@@ -676,6 +1078,9 @@ app_update_views (App *app)
   g_slist_free_full (app->live_views, g_object_unref);
   app->live_views = NULL;
 
+  /* Restarting the views resends everything */
+  g_hash_table_remove_all (app->sent_appointments);
+
   clients = calendar_sources_ref_clients (app->sources);
 
   for (link = clients; link; link = g_slist_next (link))
@@ -699,6 +1104,76 @@ app_update_views (App *app)
   g_slist_free_full (clients, g_object_unref);
 }
 
+/* Whether moving from the current window to [since, until) only exposes
+ * new time at the end so that existing views can be kept */
+static gboolean
+app_can_slide_window (App *app,
+                      time_t since,
+                      time_t until)
+{
+  return app->live_views != NULL &&
+         app->since > 0 &&
+         since > app->since &&
+         since < app->until &&
+         until > app->until;
+}
+
+static void
+app_slide_window (App *app,
+                  time_t old_until)
+{
+  GSList *link, *next, *clients;
+  GHashTableIter iter;
+  CalendarAppointment *appt;
+  gboolean had_views = app->live_views != NULL;
+
+  /* Drop views that only cover time before the window */
+  for (link = app->live_views; link; link = next)
+    {
+      ECalClientView *view = link->data;
+      ViewRange *range = view_get_range (view);
+
+      next = g_slist_next (link);
+      if (range->until > app->since)
+        continue;
+
+      app_stop_view (app, view);
+      app->live_views = g_slist_delete_link (app->live_views, link);
+      g_object_unref (view);
+    }
+
+  /* Tell the client about events that left the window */
+  g_hash_table_iter_init (&iter, app->sent_appointments);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &appt))
+    {
+      if (app_in_window (app, appt->start_time, appt->end_time))
+        continue;
+
+      app->notify_ids = g_slist_prepend (app->notify_ids, g_strdup (appt->id));
+    }
+  if (app->notify_ids)
+    app_notify_events_removed (app);
+
+  /* Only query the newly exposed time */
+  clients = calendar_sources_ref_clients (app->sources);
+  for (link = clients; link; link = g_slist_next (link))
+    {
+      ECalClient *cal_client = link->data;
+      ECalClientView *view;
+
+      if (!cal_client)
+        continue;
+
+      view = app_start_view_for_range (app, cal_client, old_until, app->until);
+      if (view)
+        app->live_views = g_slist_prepend (app->live_views, view);
+    }
+  g_slist_free_full (clients, g_object_unref);
+
+  if (had_views != (app->live_views != NULL))
+    app_notify_has_calendars (app);
+}
+
 static void
 on_client_appeared_cb (CalendarSources *sources,
                        ECalClient *client,
@@ -749,45 +1224,52 @@ on_client_disappeared_cb (CalendarSources *sources,
                           gpointer user_data)
 {
   App *app = user_data;
-  GSList *link;
+  GSList *link, *next;
+  gboolean found = FALSE;
 
   print_debug ("Client disappeared '%s'", source_uid);
 
-  for (link = app->live_views; link; link = g_slist_next (link))
+  /* With a sliding window a client can have several views */
+  for (link = app->live_views; link; link = next)
     {
       ECalClientView *view = link->data;
       ECalClient *cal_client;
       ESource *source;
 
+      next = g_slist_next (link);
       cal_client = e_cal_client_view_ref_client (view);
       source = e_client_get_source (E_CLIENT (cal_client));
 
       if (g_strcmp0 (source_uid, e_source_get_uid (source)) == 0)
         {
-          g_clear_object (&cal_client);
           app_stop_view (app, view);
-          app->live_views = g_slist_remove (app->live_views, view);
+          app->live_views = g_slist_delete_link (app->live_views, link);
           g_object_unref (view);
+          found = TRUE;
+        }
 
-          print_debug ("Emitting ClientDisappeared for '%s'", source_uid);
+      g_clear_object (&cal_client);
+    }
 
-          g_dbus_connection_emit_signal (app->connection,
-                                         NULL, /* destination_bus_name */
-                                         PHOSH_DBUS_PATH_PREFIX "/CalendarServer",
-                                         PHOSH_APP_ID ".CalendarServer",
-                                         "ClientDisappeared",
-                                         g_variant_new ("(s)", source_uid),
-                                         NULL);
+  if (!found)
+    return;
 
-          /* It was the last view, notify that it doesn't have calendars now */
-          if (!app->live_views)
-            app_notify_has_calendars (app);
+  /* The client drops all events and reloads */
+  g_hash_table_remove_all (app->sent_appointments);
 
-          break;
-        }
+  print_debug ("Emitting ClientDisappeared for '%s'", source_uid);
 
-      g_clear_object (&cal_client);
-    }
+  g_dbus_connection_emit_signal (app->connection,
+                                 NULL, /* destination_bus_name */
+                                 PHOSH_DBUS_PATH_PREFIX "/CalendarServer",
+                                 PHOSH_APP_ID ".CalendarServer",
+                                 "ClientDisappeared",
+                                 g_variant_new ("(s)", source_uid),
+                                 NULL);
+
+  /* It was the last view, notify that it doesn't have calendars now */
+  if (!app->live_views)
+    app_notify_has_calendars (app);
 }
 
 static App *
@@ -807,6 +1289,12 @@ app_new (GDBusConnection *connection)
                                                         G_CALLBACK (on_client_disappeared_cb),
                                                         app);
 
+  app->sent_appointments = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                  NULL, calendar_appointment_free);
+  app->expansions = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                           g_free, cached_expansion_free);
+  app_load_expansions (app);
+
   app_update_timezone (app);
 
   return app;
@@ -834,6 +1322,14 @@ app_free (App *app)
   g_slist_free_full (app->live_views, g_object_unref);
   g_slist_free_full (app->notify_appointments, calendar_appointment_free);
   g_slist_free_full (app->notify_ids, g_free);
+  g_hash_table_unref (app->sent_appointments);
+
+  if (app->save_expansions_id)
+    {
+      g_clear_handle_id (&app->save_expansions_id, g_source_remove);
+      save_expansions_cb (app);
+    }
+  g_hash_table_unref (app->expansions);
 
   g_object_unref (app->connection);
   g_object_unref (app->sources);
@@ -861,6 +1357,8 @@ handle_method_call (GDBusConnection       *connection,
       gint64 until;
       gboolean force_reload = FALSE;
       gboolean window_changed = FALSE;
+      gboolean slide = FALSE;
+      time_t old_until = app->until;
 
       g_variant_get (parameters,
                      "(xxb)",
@@ -886,6 +1384,7 @@ handle_method_call (GDBusConnection       *connection,
           GVariantBuilder *builder;
           GVariantBuilder *invalidated_builder;
 
+          slide = !force_reload && app_can_slide_window (app, since, until);
           app->until = until;
           app->since = since;
           window_changed = TRUE;
@@ -913,7 +1412,9 @@ handle_method_call (GDBusConnection       *connection,
 
       g_dbus_method_invocation_return_value (invocation, NULL);
 
-      if (window_changed || force_reload)
+      if (slide)
+        app_slide_window (app, old_until);
+      else if (window_changed || force_reload)
         app_update_views (app);
     }
   else
@@ -10,6 +10,7 @@
 #include "interval-row.h"
 #include "plugin-shell.h"
 #include "status-page.h"
+#include "timer-service.h"
 
 #include <cui-call.h>
 
@@ -19,7 +20,8 @@
 #define CAFFEINE_INTERVALS_KEY        "intervals"
 #define CAFFEINE_SELECTED_KEY         "selected-index"
 
-#define UPDATE_INTERVAL    1 /* seconds */
+#define UPDATE_INTERVAL    1000 /* ms */
+#define UPDATE_TOLERANCE   100 /* ms */
 #define CAFFEINE_ON_ICON   "cafe-hot-symbolic"
 #define CAFFEINE_OFF_ICON  "cafe-cold-symbolic"
 
@@ -48,8 +50,10 @@ struct _PhoshCaffeineQuickSetting {
   GtkListBoxRow           *cur_row;
   GSettings               *settings;
 
-  uint                     remaining;
-  uint                     update_id;
+  /* Monotonic time the inhibit ends */
+  gint64                   end_time;
+  guint                    expire_id;
+  guint                    update_id;
 };
 
 G_DEFINE_TYPE (PhoshCaffeineQuickSetting, phosh_caffeine_quick_setting, PHOSH_TYPE_QUICK_SETTING);
@@ -115,31 +119,48 @@ phosh_caffeine_quick_setting_get_property (GObject *object,
 }
 
 
+static uint
+get_remaining (PhoshCaffeineQuickSetting *self)
+{
+  gint64 remaining = self->end_time - g_get_monotonic_time ();
+
+  return MAX (0, (remaining + G_USEC_PER_SEC - 1) / G_USEC_PER_SEC);
+}
+
+
 static void
 phosh_caffeine_quick_setting_clear_timer (PhoshCaffeineQuickSetting *self)
 {
-  self->remaining = 0;
+  self->end_time = 0;
 
-  g_clear_handle_id (&self->update_id, g_source_remove);
+  g_clear_handle_id (&self->expire_id, g_source_remove);
+  if (self->update_id) {
+    phosh_timer_service_remove_timeout (phosh_timer_service_get_default (), self->update_id);
+    self->update_id = 0;
+  }
 
   phosh_caffeine_quick_setting_inhibit (self, FALSE);
 }
 
 
 static gboolean
-on_update_expired (gpointer user_data)
+on_update (gpointer user_data)
 {
   PhoshCaffeineQuickSetting *self = PHOSH_CAFFEINE_QUICK_SETTING (user_data);
+  g_autofree char *label = cui_call_format_duration ((double) get_remaining (self));
 
-  g_return_val_if_fail (self->remaining >= UPDATE_INTERVAL, FALSE);
-  self->remaining -= UPDATE_INTERVAL;
-  if (self->remaining > 0) {
-    g_autofree char *label = cui_call_format_duration ((double) self->remaining);
-    phosh_status_icon_set_info (self->info, label);
+  phosh_status_icon_set_info (self->info, label);
 
-    return G_SOURCE_CONTINUE;
-  }
+  return G_SOURCE_CONTINUE;
+}
+
+
+static gboolean
+on_expired (gpointer user_data)
+{
+  PhoshCaffeineQuickSetting *self = PHOSH_CAFFEINE_QUICK_SETTING (user_data);
 
+  self->expire_id = 0;
   phosh_caffeine_quick_setting_clear_timer (self);
 
   return G_SOURCE_REMOVE;
@@ -163,14 +184,21 @@ on_clicked (PhoshCaffeineQuickSetting *self)
   }
 
   /* Clear timer if on */
-  if (self->update_id) {
+  if (self->expire_id) {
     phosh_caffeine_quick_setting_clear_timer (self);
 
     return;
   }
 
-  self->remaining = value;
-  self->update_id = g_timeout_add_seconds (UPDATE_INTERVAL, on_update_expired, self);
+  self->end_time = g_get_monotonic_time () + (gint64) value * G_USEC_PER_SEC;
+  self->expire_id = g_timeout_add_seconds (value, on_expired, self);
+  g_source_set_name_by_id (self->expire_id, "[phosh-caffeine] expire");
+  /* The countdown is only cosmetic, so it pauses while nobody looks */
+  self->update_id = phosh_timer_service_add_aligned_timeout (phosh_timer_service_get_default (),
+                                                             UPDATE_INTERVAL,
+                                                             UPDATE_TOLERANCE,
+                                                             on_update,
+                                                             self);
   phosh_caffeine_quick_setting_inhibit (self, TRUE);
 }
 
@@ -243,8 +271,8 @@ transform_to_label (GBinding     *binding,
 
   if (!inhibited) {
     g_value_set_string (to_value, C_("caffeine-disabled", "Off"));
-  } else if (self->update_id) {
-    g_autofree char *label = cui_call_format_duration ((uint) self->remaining);
+  } else if (self->expire_id) {
+    g_autofree char *label = cui_call_format_duration ((double) get_remaining (self));
     g_value_set_string (to_value, label);
   } else {
     g_value_set_string (to_value, C_("caffeine-enabled", "On"));
@@ -259,8 +287,8 @@ phosh_caffeine_quick_setting_finalize (GObject *gobject)
 {
   PhoshCaffeineQuickSetting *self = PHOSH_CAFFEINE_QUICK_SETTING (gobject);
 
-  if (self->cookie)
-    phosh_caffeine_quick_setting_inhibit (self, FALSE);
+  /* Also drops the inhibit */
+  phosh_caffeine_quick_setting_clear_timer (self);
 
   g_clear_object (&self->settings);
 
@@ -0,0 +1,339 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "emergency-info-common.h"
+#include "emergency-info-data.h"
+
+/**
+ * PhoshEmergencyInfoData:
+ *
+ * The parsed emergency information keyfile
+ *
+ * The keyfile is parsed once and kept around for the lifetime of the
+ * shell so showing the lock screen doesn't need to hit the disk. The
+ * file is monitored and [signal@EmergencyInfoData::changed] is
+ * emitted when its contents change.
+ */
+
+enum {
+  CHANGED,
+  N_SIGNALS
+};
+static guint signals[N_SIGNALS];
+
+struct _PhoshEmergencyInfoData {
+  GObject       parent;
+
+  GFile        *file;
+  GFileMonitor *monitor;
+
+  char         *fields[PHOSH_EMERGENCY_INFO_N_FIELDS];
+  GPtrArray    *contacts;
+  guint         contacts_serial;
+};
+G_DEFINE_TYPE (PhoshEmergencyInfoData, phosh_emergency_info_data, G_TYPE_OBJECT)
+
+static const char *field_keys[PHOSH_EMERGENCY_INFO_N_FIELDS] = {
+  [PHOSH_EMERGENCY_INFO_FIELD_OWNER_NAME] = "OwnerName",
+  [PHOSH_EMERGENCY_INFO_FIELD_DOB] = "DateOfBirth",
+  [PHOSH_EMERGENCY_INFO_FIELD_LANGUAGE] = "PreferredLanguage",
+  [PHOSH_EMERGENCY_INFO_FIELD_HOME_ADDRESS] = "HomeAddress",
+  [PHOSH_EMERGENCY_INFO_FIELD_AGE] = "Age",
+  [PHOSH_EMERGENCY_INFO_FIELD_BLOOD_TYPE] = "BloodType",
+  [PHOSH_EMERGENCY_INFO_FIELD_HEIGHT] = "Height",
+  [PHOSH_EMERGENCY_INFO_FIELD_WEIGHT] = "Weight",
+  [PHOSH_EMERGENCY_INFO_FIELD_ALLERGIES] = "Allergies",
+  [PHOSH_EMERGENCY_INFO_FIELD_MEDICATIONS_CONDITIONS] = "MedicationsAndConditions",
+  [PHOSH_EMERGENCY_INFO_FIELD_OTHER_INFO] = "OtherInfo",
+};
+
+
+static void
+contact_free (PhoshEmergencyInfoContact *contact)
+{
+  g_free (contact->name);
+  g_free (contact->number);
+  g_free (contact->relationship);
+  g_free (contact);
+}
+
+
+static gboolean
+contacts_equal (GPtrArray *a, GPtrArray *b)
+{
+  if (a->len != b->len)
+    return FALSE;
+
+  for (guint i = 0; i < a->len; i++) {
+    PhoshEmergencyInfoContact *ca = g_ptr_array_index (a, i);
+    PhoshEmergencyInfoContact *cb = g_ptr_array_index (b, i);
+
+    if (g_strcmp0 (ca->name, cb->name) ||
+        g_strcmp0 (ca->number, cb->number) ||
+        g_strcmp0 (ca->relationship, cb->relationship))
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+
+static char *
+get_field (GKeyFile *key_file, PhoshEmergencyInfoField field)
+{
+  const char *key = field_keys[field];
+  g_auto (GStrv) list = NULL;
+
+  switch (field) {
+  case PHOSH_EMERGENCY_INFO_FIELD_ALLERGIES:
+  case PHOSH_EMERGENCY_INFO_FIELD_MEDICATIONS_CONDITIONS:
+    list = g_key_file_get_string_list (key_file, INFO_GROUP, key, NULL, NULL);
+    return list ? g_strjoinv ("\n", list) : NULL;
+  default:
+    return g_key_file_get_string (key_file, INFO_GROUP, key, NULL);
+  }
+}
+
+
+static GPtrArray *
+get_contacts (GKeyFile *key_file)
+{
+  GPtrArray *contacts = g_ptr_array_new_with_free_func ((GDestroyNotify)contact_free);
+  g_auto (GStrv) names = NULL;
+
+  names = g_key_file_get_keys (key_file, CONTACTS_GROUP, NULL, NULL);
+  for (guint i = 0; names && names[i]; i++) {
+    g_autofree char *number = NULL;
+    g_auto (GStrv) number_split = NULL;
+    PhoshEmergencyInfoContact *contact;
+
+    number = g_key_file_get_string (key_file, CONTACTS_GROUP, names[i], NULL);
+    if (!number || !*number)
+      continue;
+
+    number_split = g_strsplit (number, ";", 2);
+    contact = g_new0 (PhoshEmergencyInfoContact, 1);
+    contact->name = g_strdup (names[i]);
+    contact->number = g_strdup (number_split[0]);
+    contact->relationship = g_strdup (number_split[1]);
+    g_ptr_array_add (contacts, contact);
+  }
+
+  return contacts;
+}
+
+
+static void
+load (PhoshEmergencyInfoData *self)
+{
+  g_autoptr (GKeyFile) key_file = g_key_file_new ();
+  g_autoptr (GPtrArray) contacts = NULL;
+  g_autofree char *path = g_file_get_path (self->file);
+  g_autoptr (GError) err = NULL;
+  gboolean changed = FALSE;
+
+  /* A missing or broken file means there's nothing to show */
+  if (!g_key_file_load_from_file (key_file, path, G_KEY_FILE_NONE, &err)) {
+    if (g_error_matches (err, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+      g_debug ("No keyfile at '%s'", path);
+    else
+      g_warning ("Failed to load keyfile at '%s': %s", path, err->message);
+  }
+
+  for (int i = 0; i < PHOSH_EMERGENCY_INFO_N_FIELDS; i++) {
+    g_autofree char *value = get_field (key_file, i);
+
+    if (g_strcmp0 (value, self->fields[i]) == 0)
+      continue;
+
+    g_free (self->fields[i]);
+    self->fields[i] = g_steal_pointer (&value);
+    changed = TRUE;
+  }
+
+  contacts = get_contacts (key_file);
+  if (!contacts_equal (contacts, self->contacts)) {
+    g_ptr_array_unref (self->contacts);
+    self->contacts = g_steal_pointer (&contacts);
+    self->contacts_serial++;
+    changed = TRUE;
+  }
+
+  if (changed)
+    g_signal_emit (self, signals[CHANGED], 0);
+}
+
+
+static void
+on_file_changed (PhoshEmergencyInfoData *self,
+                 GFile                  *file,
+                 GFile                  *other_file,
+                 GFileMonitorEvent       event)
+{
+  switch (event) {
+  case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
+  case G_FILE_MONITOR_EVENT_CREATED:
+  case G_FILE_MONITOR_EVENT_DELETED:
+  case G_FILE_MONITOR_EVENT_MOVED_IN:
+  case G_FILE_MONITOR_EVENT_MOVED_OUT:
+  case G_FILE_MONITOR_EVENT_RENAMED:
+    g_debug ("Emergency info changed, reloading");
+    load (self);
+    break;
+  default:
+    break;
+  }
+}
+
+
+static void
+phosh_emergency_info_data_dispose (GObject *object)
+{
+  PhoshEmergencyInfoData *self = PHOSH_EMERGENCY_INFO_DATA (object);
+
+  if (self->monitor)
+    g_file_monitor_cancel (self->monitor);
+  g_clear_object (&self->monitor);
+  g_clear_object (&self->file);
+
+  G_OBJECT_CLASS (phosh_emergency_info_data_parent_class)->dispose (object);
+}
+
+
+static void
+phosh_emergency_info_data_finalize (GObject *object)
+{
+  PhoshEmergencyInfoData *self = PHOSH_EMERGENCY_INFO_DATA (object);
+
+  for (int i = 0; i < PHOSH_EMERGENCY_INFO_N_FIELDS; i++)
+    g_free (self->fields[i]);
+  g_clear_pointer (&self->contacts, g_ptr_array_unref);
+
+  G_OBJECT_CLASS (phosh_emergency_info_data_parent_class)->finalize (object);
+}
+
+
+static void
+phosh_emergency_info_data_class_init (PhoshEmergencyInfoDataClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->dispose = phosh_emergency_info_data_dispose;
+  object_class->finalize = phosh_emergency_info_data_finalize;
+
+  /**
+   * PhoshEmergencyInfoData::changed:
+   * @self: The emergency info data
+   *
+   * Emitted when the keyfile's contents changed
+   */
+  signals[CHANGED] = g_signal_new ("changed",
+                                   G_TYPE_FROM_CLASS (klass),
+                                   G_SIGNAL_RUN_LAST,
+                                   0, NULL, NULL, NULL,
+                                   G_TYPE_NONE,
+                                   0);
+}
+
+
+static void
+phosh_emergency_info_data_init (PhoshEmergencyInfoData *self)
+{
+  g_autoptr (GError) err = NULL;
+  g_autofree char *path = NULL;
+
+  self->contacts = g_ptr_array_new_with_free_func ((GDestroyNotify)contact_free);
+
+  path = g_build_filename (g_get_user_config_dir (),
+                           EMERGENCY_INFO_GKEYFILE_LOCATION,
+                           EMERGENCY_INFO_GKEYFILE_NAME,
+                           NULL);
+  self->file = g_file_new_for_path (path);
+
+  self->monitor = g_file_monitor_file (self->file, G_FILE_MONITOR_WATCH_MOVES, NULL, &err);
+  if (self->monitor) {
+    g_signal_connect_object (self->monitor, "changed",
+                             G_CALLBACK (on_file_changed),
+                             self,
+                             G_CONNECT_SWAPPED);
+  } else {
+    g_warning ("Failed to monitor '%s': %s", path, err->message);
+  }
+
+  load (self);
+}
+
+/**
+ * phosh_emergency_info_data_get_default:
+ *
+ * Get the emergency info data singleton
+ *
+ * Returns:(transfer none): The emergency info data singleton
+ */
+PhoshEmergencyInfoData *
+phosh_emergency_info_data_get_default (void)
+{
+  static PhoshEmergencyInfoData *instance;
+
+  if (instance == NULL) {
+    instance = g_object_new (PHOSH_TYPE_EMERGENCY_INFO_DATA, NULL);
+    g_object_add_weak_pointer (G_OBJECT (instance), (gpointer *)&instance);
+  }
+
+  return instance;
+}
+
+/**
+ * phosh_emergency_info_data_get_field:
+ * @self: The emergency info data
+ * @field: The field to get
+ *
+ * Get the value of a field. Fields with multiple entries have them
+ * separated by newlines.
+ *
+ * Returns:(nullable): The field's value
+ */
+const char *
+phosh_emergency_info_data_get_field (PhoshEmergencyInfoData *self, PhoshEmergencyInfoField field)
+{
+  g_return_val_if_fail (PHOSH_IS_EMERGENCY_INFO_DATA (self), NULL);
+  g_return_val_if_fail (field < PHOSH_EMERGENCY_INFO_N_FIELDS, NULL);
+
+  return self->fields[field];
+}
+
+/**
+ * phosh_emergency_info_data_get_contacts:
+ * @self: The emergency info data
+ *
+ * Get the emergency contacts
+ *
+ * Returns:(transfer none)(element-type PhoshEmergencyInfoContact): The contacts
+ */
+GPtrArray *
+phosh_emergency_info_data_get_contacts (PhoshEmergencyInfoData *self)
+{
+  g_return_val_if_fail (PHOSH_IS_EMERGENCY_INFO_DATA (self), NULL);
+
+  return self->contacts;
+}
+
+/**
+ * phosh_emergency_info_data_get_contacts_serial:
+ * @self: The emergency info data
+ *
+ * Get a number that changes whenever the contacts change. This
+ * allows to only rebuild contact rows when needed.
+ *
+ * Returns: The serial
+ */
+guint
+phosh_emergency_info_data_get_contacts_serial (PhoshEmergencyInfoData *self)
+{
+  g_return_val_if_fail (PHOSH_IS_EMERGENCY_INFO_DATA (self), 0);
+
+  return self->contacts_serial;
+}
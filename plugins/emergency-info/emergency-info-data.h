@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+/**
+ * PhoshEmergencyInfoField:
+ *
+ * The fields of the emergency information
+ */
+typedef enum {
+  PHOSH_EMERGENCY_INFO_FIELD_OWNER_NAME,
+  PHOSH_EMERGENCY_INFO_FIELD_DOB,
+  PHOSH_EMERGENCY_INFO_FIELD_LANGUAGE,
+  PHOSH_EMERGENCY_INFO_FIELD_HOME_ADDRESS,
+  PHOSH_EMERGENCY_INFO_FIELD_AGE,
+  PHOSH_EMERGENCY_INFO_FIELD_BLOOD_TYPE,
+  PHOSH_EMERGENCY_INFO_FIELD_HEIGHT,
+  PHOSH_EMERGENCY_INFO_FIELD_WEIGHT,
+  PHOSH_EMERGENCY_INFO_FIELD_ALLERGIES,
+  PHOSH_EMERGENCY_INFO_FIELD_MEDICATIONS_CONDITIONS,
+  PHOSH_EMERGENCY_INFO_FIELD_OTHER_INFO,
+  PHOSH_EMERGENCY_INFO_N_FIELDS,
+} PhoshEmergencyInfoField;
+
+/**
+ * PhoshEmergencyInfoContact:
+ * @name: The contact's name
+ * @number: The phone number
+ * @relationship:(nullable): The relationship to the owner
+ *
+ * An emergency contact
+ */
+typedef struct {
+  char *name;
+  char *number;
+  char *relationship;
+} PhoshEmergencyInfoContact;
+
+#define PHOSH_TYPE_EMERGENCY_INFO_DATA (phosh_emergency_info_data_get_type ())
+G_DECLARE_FINAL_TYPE (PhoshEmergencyInfoData, phosh_emergency_info_data,
+                      PHOSH, EMERGENCY_INFO_DATA, GObject)
+
+PhoshEmergencyInfoData *phosh_emergency_info_data_get_default      (void);
+const char             *phosh_emergency_info_data_get_field        (PhoshEmergencyInfoData  *self,
+                                                                    PhoshEmergencyInfoField  field);
+GPtrArray              *phosh_emergency_info_data_get_contacts     (PhoshEmergencyInfoData  *self);
+guint                   phosh_emergency_info_data_get_contacts_serial (PhoshEmergencyInfoData *self);
+
+G_END_DECLS
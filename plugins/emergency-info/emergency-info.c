@@ -7,6 +7,7 @@
  */
 
 #include "emergency-info.h"
+#include "emergency-info-data.h"
 #include "emergency-info-row.h"
 #include "emergency-info-common.h"
 
@@ -43,22 +44,14 @@
  * Contact 1=(123) 555-12;Brother
  * Contact 2=(204) 555-00
  * ```
+ *
+ * The file is monitored and the info is updated when it changes.
  */
 struct _PhoshEmergencyInfo {
   GtkBox               parent;
 
-  char                *owner_name;
-  char                *dob;
-  char                *language;
-  char                *home_address;
-  char                *age;
-  char                *blood_type;
-  char                *height;
-  char                *weight;
-  char                *allergies;
-  char                *medications_conditions;
-  char                *other_info;
-  GStrv                contacts;
+  PhoshEmergencyInfoData *data;
+  guint                contacts_serial;
 
   GtkLabel            *label_owner_name;
   GtkLabel            *label_dob;
@@ -83,6 +76,7 @@ struct _PhoshEmergencyInfo {
   HdyPreferencesGroup *pers_info;
   HdyPreferencesGroup *emer_info;
   HdyPreferencesGroup *emer_contacts;
+  GPtrArray           *contact_rows;
 };
 
 G_DEFINE_TYPE (PhoshEmergencyInfo, phosh_emergency_info, GTK_TYPE_BOX);
@@ -113,143 +107,73 @@ set_label_or_hide_widget (const char *label,
 }
 
 static void
-load_info (PhoshEmergencyInfo *self)
+update_contacts (PhoshEmergencyInfo *self)
 {
-  g_autofree char *path = NULL;
-  g_autoptr(GError) err = NULL;
-  g_auto (GStrv) temp_med_cond = NULL;
-  g_auto (GStrv) temp_allergies = NULL;
-  g_autoptr (GKeyFile) key_file = NULL;
-  gboolean display_med_info = FALSE;
-  gboolean display_pers_info = FALSE;
-  gsize i;
-
-  path = g_build_filename (g_get_user_config_dir (),
-                           EMERGENCY_INFO_GKEYFILE_LOCATION,
-                           EMERGENCY_INFO_GKEYFILE_NAME,
-                           NULL);
+  GPtrArray *contacts = phosh_emergency_info_data_get_contacts (self->data);
+  guint serial = phosh_emergency_info_data_get_contacts_serial (self->data);
 
-  key_file = g_key_file_new ();
-
-  if (!g_key_file_load_from_file (key_file, path, G_KEY_FILE_NONE, &err)) {
-    g_warning ("Failed to load keyfile at '%s': %s", path, err->message);
+  /* Only rebuild the rows when the contacts changed */
+  if (self->contact_rows && serial == self->contacts_serial)
     return;
+
+  if (self->contact_rows) {
+    for (guint i = 0; i < self->contact_rows->len; i++)
+      gtk_widget_destroy (g_ptr_array_index (self->contact_rows, i));
+    g_ptr_array_set_size (self->contact_rows, 0);
+  } else {
+    self->contact_rows = g_ptr_array_new ();
   }
+  self->contacts_serial = serial;
 
-  self->owner_name = g_key_file_get_string (key_file,
-                                            INFO_GROUP,
-                                            "OwnerName",
-                                            NULL);
-
-  self->dob = g_key_file_get_string (key_file,
-                                     INFO_GROUP,
-                                     "DateOfBirth",
-                                     NULL);
-
-  self->language = g_key_file_get_string (key_file,
-                                          INFO_GROUP,
-                                          "PreferredLanguage",
-                                          NULL);
-
-  self->home_address = g_key_file_get_string (key_file,
-                                              INFO_GROUP,
-                                              "HomeAddress",
-                                              NULL);
-
-  self->age = g_key_file_get_string (key_file,
-                                     INFO_GROUP,
-                                     "Age",
-                                     NULL);
-
-  self->blood_type = g_key_file_get_string (key_file,
-                                            INFO_GROUP,
-                                            "BloodType",
-                                            NULL);
-
-  self->height = g_key_file_get_string (key_file,
-                                        INFO_GROUP,
-                                        "Height",
-                                        NULL);
-
-  self->weight = g_key_file_get_string (key_file,
-                                        INFO_GROUP,
-                                        "Weight",
-                                        NULL);
-
-  temp_allergies = g_key_file_get_string_list (key_file,
-                                               INFO_GROUP,
-                                               "Allergies",
-                                               NULL,
-                                               NULL);
-
-  if (temp_allergies)
-    self->allergies = g_strjoinv ("\n", temp_allergies);
-
-  temp_med_cond = g_key_file_get_string_list (key_file,
-                                              INFO_GROUP,
-                                              "MedicationsAndConditions",
-                                              NULL,
-                                              NULL);
-
-  if (temp_med_cond)
-    self->medications_conditions = g_strjoinv ("\n", temp_med_cond);
-
-  self->other_info = g_key_file_get_string (key_file,
-                                            INFO_GROUP,
-                                            "OtherInfo",
-                                            NULL);
-
-  self->contacts = g_key_file_get_keys (key_file,
-                                        CONTACTS_GROUP,
-                                        NULL,
-                                        NULL);
-
-  for (i = 0; self->contacts && self->contacts[i]; i++) {
-    g_autofree char *number = NULL;
+  for (guint i = 0; i < contacts->len; i++) {
+    PhoshEmergencyInfoContact *contact = g_ptr_array_index (contacts, i);
     GtkWidget *new_row;
 
-    number = g_key_file_get_string (key_file,
-                                    CONTACTS_GROUP,
-                                    self->contacts[i], NULL);
-    if (number && *number) {
-      g_auto (GStrv) number_split = NULL;
-
-      number_split = g_strsplit (number, ";", 2);
-      new_row = phosh_emergency_info_row_new (self->contacts[i],
-                                              number_split[0],
-                                              number_split[1]);
-      gtk_container_add (GTK_CONTAINER (self->emer_contacts),
-                         GTK_WIDGET (new_row));
-    }
+    new_row = phosh_emergency_info_row_new (contact->name,
+                                            contact->number,
+                                            contact->relationship);
+    gtk_container_add (GTK_CONTAINER (self->emer_contacts), GTK_WIDGET (new_row));
+    g_ptr_array_add (self->contact_rows, new_row);
   }
 
-  if (!self->contacts || !self->contacts[0])
-    gtk_widget_set_visible (GTK_WIDGET (self->emer_contacts), FALSE);
+  gtk_widget_set_visible (GTK_WIDGET (self->emer_contacts), contacts->len > 0);
+}
 
-  set_label_or_hide_widget (self->owner_name, self->label_owner_name,
+static void
+update_info (PhoshEmergencyInfo *self)
+{
+  PhoshEmergencyInfoData *data = self->data;
+  gboolean display_med_info = FALSE;
+  gboolean display_pers_info = FALSE;
+
+#define FIELD(f) phosh_emergency_info_data_get_field (data, PHOSH_EMERGENCY_INFO_FIELD_ ## f)
+  set_label_or_hide_widget (FIELD (OWNER_NAME), self->label_owner_name,
                             GTK_WIDGET (self->row_owner_name));
-  display_pers_info |= set_label_or_hide_widget (self->dob, self->label_dob,
+  display_pers_info |= set_label_or_hide_widget (FIELD (DOB), self->label_dob,
                                                  GTK_WIDGET (self->row_dob));
-  display_pers_info |= set_label_or_hide_widget (self->language, self->label_language,
+  display_pers_info |= set_label_or_hide_widget (FIELD (LANGUAGE), self->label_language,
                                                  GTK_WIDGET (self->row_language));
-  display_pers_info |= set_subtitle_or_hide_widget (self->home_address,
+  display_pers_info |= set_subtitle_or_hide_widget (FIELD (HOME_ADDRESS),
                                                     self->row_home_address);
-  display_med_info |= set_label_or_hide_widget (self->age, self->label_age,
+  display_med_info |= set_label_or_hide_widget (FIELD (AGE), self->label_age,
                                                 GTK_WIDGET (self->row_age));
-  display_med_info |= set_label_or_hide_widget (self->blood_type, self->label_blood_type,
+  display_med_info |= set_label_or_hide_widget (FIELD (BLOOD_TYPE), self->label_blood_type,
                                                 GTK_WIDGET (self->row_blood_type));
-  display_med_info |= set_label_or_hide_widget (self->height, self->label_height,
+  display_med_info |= set_label_or_hide_widget (FIELD (HEIGHT), self->label_height,
                                                 GTK_WIDGET (self->row_height));
-  display_med_info |= set_label_or_hide_widget (self->weight, self->label_weight,
+  display_med_info |= set_label_or_hide_widget (FIELD (WEIGHT), self->label_weight,
                                                 GTK_WIDGET (self->row_weight));
-  display_med_info |= set_subtitle_or_hide_widget (self->allergies,
+  display_med_info |= set_subtitle_or_hide_widget (FIELD (ALLERGIES),
                                                    self->row_allergies);
-  display_med_info |= set_subtitle_or_hide_widget (self->medications_conditions,
+  display_med_info |= set_subtitle_or_hide_widget (FIELD (MEDICATIONS_CONDITIONS),
                                                    self->row_medications);
-  display_med_info |= set_subtitle_or_hide_widget (self->other_info,
+  display_med_info |= set_subtitle_or_hide_widget (FIELD (OTHER_INFO),
                                                    self->row_other_info);
+#undef FIELD
   gtk_widget_set_visible (GTK_WIDGET (self->emer_info), display_med_info);
   gtk_widget_set_visible (GTK_WIDGET (self->pers_info), display_pers_info);
+
+  update_contacts (self);
 }
 
 static void
@@ -257,18 +181,8 @@ phosh_emergency_info_finalize (GObject *object)
 {
   PhoshEmergencyInfo *self = PHOSH_EMERGENCY_INFO (object);
 
-  g_free (self->owner_name);
-  g_free (self->dob);
-  g_free (self->language);
-  g_free (self->home_address);
-  g_free (self->age);
-  g_free (self->blood_type);
-  g_free (self->height);
-  g_free (self->weight);
-  g_free (self->allergies);
-  g_free (self->other_info);
-  g_free (self->medications_conditions);
-  g_strfreev (self->contacts);
+  g_clear_pointer (&self->contact_rows, g_ptr_array_unref);
+  g_clear_object (&self->data);
 
   G_OBJECT_CLASS (phosh_emergency_info_parent_class)->finalize (object);
 }
@@ -324,5 +238,11 @@ phosh_emergency_info_init (PhoshEmergencyInfo *self)
                                   GTK_STYLE_PROVIDER (css_provider),
                                   GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
 
-  load_info (self);
+  /* The data is parsed once and shared by all lock screens */
+  self->data = g_object_ref (phosh_emergency_info_data_get_default ());
+  g_signal_connect_object (self->data, "changed",
+                           G_CALLBACK (update_info),
+                           self,
+                           G_CONNECT_SWAPPED);
+  update_info (self);
 }
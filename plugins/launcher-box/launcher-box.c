@@ -36,6 +36,8 @@ struct _PhoshLauncherBox {
   GListStore   *model;
   GtkListBox   *lb_launchers;
   GtkStack     *stack_launchers;
+
+  PhoshLauncherEntryManager *launcher_entry_manager;
 };
 
 G_DEFINE_TYPE (PhoshLauncherBox, phosh_launcher_box, GTK_TYPE_BOX);
@@ -72,6 +74,40 @@ on_view_close_clicked (PhoshLauncherBox *self)
 }
 
 
+static char *
+get_app_id (PhoshLauncherItem *item)
+{
+  GDesktopAppInfo *info = phosh_launcher_item_get_app_info (item);
+  const char *app_id = g_app_info_get_id (G_APP_INFO (info));
+
+  /* Launchers outside of the applications dirs don't have an id */
+  if (app_id)
+    return g_strdup (app_id);
+
+  return g_path_get_basename (g_desktop_app_info_get_filename (info));
+}
+
+
+static void
+phosh_launcher_box_dispose (GObject *object)
+{
+  PhoshLauncherBox *self = PHOSH_LAUNCHER_BOX (object);
+
+  if (self->launcher_entry_manager && self->model) {
+    for (guint i = 0; i < g_list_model_get_n_items (G_LIST_MODEL (self->model)); i++) {
+      g_autoptr (PhoshLauncherItem) item = g_list_model_get_item (G_LIST_MODEL (self->model), i);
+      g_autofree char *app_id = get_app_id (item);
+
+      phosh_launcher_entry_manager_unwatch_app (self->launcher_entry_manager, app_id);
+    }
+    g_list_store_remove_all (self->model);
+  }
+  g_clear_object (&self->launcher_entry_manager);
+
+  G_OBJECT_CLASS (phosh_launcher_box_parent_class)->dispose (object);
+}
+
+
 static void
 phosh_launcher_box_finalize (GObject *object)
 {
@@ -95,6 +131,7 @@ phosh_launcher_box_class_init (PhoshLauncherBoxClass *klass)
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
   GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
 
+  object_class->dispose = phosh_launcher_box_dispose;
   object_class->finalize = phosh_launcher_box_finalize;
 
   g_type_ensure (PHOSH_TYPE_LAUNCHER_ROW);
@@ -128,6 +165,27 @@ launcher_item_compare (gconstpointer a, gconstpointer b, gpointer user_data)
 }
 
 
+static void
+update_item (PhoshLauncherItem *item, GVariant *properties)
+{
+  double progress;
+  gint64 count;
+  gboolean visible;
+
+  if (g_variant_lookup (properties, "progress", "d", &progress))
+    phosh_launcher_item_set_progress (item, progress);
+
+  if (g_variant_lookup (properties, "progress-visible", "b", &visible))
+    phosh_launcher_item_set_progress_visible (item, visible);
+
+  if (g_variant_lookup (properties, "count", "x", &count))
+    phosh_launcher_item_set_count (item, count);
+
+  if (g_variant_lookup (properties, "count-visible", "b", &visible))
+    phosh_launcher_item_set_count_visible (item, visible);
+}
+
+
 static void
 on_file_child_enumerated (GObject *source_object, GAsyncResult *res, gpointer user_data)
 {
@@ -151,6 +209,8 @@ on_file_child_enumerated (GObject *source_object, GAsyncResult *res, gpointer us
     g_autoptr (PhoshLauncherItem) item = NULL;
     GFile *file;
     GFileInfo *info;
+    GVariant *properties;
+    g_autofree char *app_id = NULL;
 
     if (!g_file_enumerator_iterate (enumerator, &info, &file, self->cancel, &err)) {
       g_warning ("Failed to list contents of launcher dir %s: $%s", self->launcher_box_path, err->message);
@@ -173,6 +233,13 @@ on_file_child_enumerated (GObject *source_object, GAsyncResult *res, gpointer us
 
     item = phosh_launcher_item_new (app_info);
 
+    /* Get updates for the apps we show */
+    app_id = get_app_id (item);
+    phosh_launcher_entry_manager_watch_app (self->launcher_entry_manager, app_id);
+    properties = phosh_launcher_entry_manager_get_info (self->launcher_entry_manager, app_id);
+    if (properties)
+      update_item (item, properties);
+
     g_list_store_insert_sorted (self->model, item, launcher_item_compare, NULL);
   }
 
@@ -216,27 +283,6 @@ load_launchers (PhoshLauncherBox *self)
 }
 
 
-static void
-update_item (PhoshLauncherItem *item, GVariant *properties)
-{
-  double progress;
-  gint64 count;
-  gboolean visible;
-
-  if (g_variant_lookup (properties, "progress", "d", &progress))
-    phosh_launcher_item_set_progress (item, progress);
-
-  if (g_variant_lookup (properties, "progress-visible", "b", &visible))
-    phosh_launcher_item_set_progress_visible (item, visible);
-
-  if (g_variant_lookup (properties, "count", "x", &count))
-    phosh_launcher_item_set_count (item, count);
-
-  if (g_variant_lookup (properties, "count-visible", "b", &visible))
-    phosh_launcher_item_set_count_visible (item, visible);
-}
-
-
 static void
 on_launcher_info_updated (PhoshLauncherBox *self, char *desktop_file, GVariant *properties)
 {
@@ -246,13 +292,10 @@ on_launcher_info_updated (PhoshLauncherBox *self, char *desktop_file, GVariant *
 
   for (int i = 0; i < g_list_model_get_n_items (G_LIST_MODEL (self->model)); i++) {
     g_autoptr (PhoshLauncherItem) item = NULL;
-    GDesktopAppInfo *info;
-    const char *app_id;
+    g_autofree char *app_id = NULL;
 
     item = g_list_model_get_item (G_LIST_MODEL (self->model), i);
-    info = phosh_launcher_item_get_app_info (item);
-
-    app_id = g_app_info_get_id (G_APP_INFO (info));
+    app_id = get_app_id (item);
     if (g_strcmp0 (app_id, desktop_file) == 0) {
       g_debug ("Update info for '%s'", desktop_file);
       update_item (item, properties);
@@ -267,7 +310,6 @@ phosh_launcher_box_init (PhoshLauncherBox *self)
 {
   g_autoptr (GtkCssProvider) css_provider = NULL;
   PhoshShell *shell = phosh_shell_get_default ();
-  PhoshLauncherEntryManager *launcher_entry_manager;
 
   gtk_widget_init_template (GTK_WIDGET (self));
 
@@ -291,12 +333,12 @@ phosh_launcher_box_init (PhoshLauncherBox *self)
                             G_CALLBACK (on_row_selected),
                             self);
 
-  load_launchers (self);
-
-  launcher_entry_manager = phosh_shell_get_launcher_entry_manager (shell);
-  g_signal_connect_object (launcher_entry_manager,
+  self->launcher_entry_manager = g_object_ref (phosh_shell_get_launcher_entry_manager (shell));
+  g_signal_connect_object (self->launcher_entry_manager,
                            "info-updated",
                            G_CALLBACK (on_launcher_info_updated),
                            self,
                            G_CONNECT_SWAPPED);
+
+  load_launchers (self);
 }
@@ -7,10 +7,16 @@
  */
 
 #include "load-meter-status-icon.h"
+#include "plugin-shell.h"
+#include "timer-service.h"
 
 #include <fcntl.h>
 #include <ctype.h>
 #include <glib/gstdio.h>
+#include <unistd.h>
+
+#define LOAD_METER_SCHEMA "mobi.phosh.plugins.load-meter-status-icon"
+#define CPU_PRESSURE_KEY  "cpu-pressure"
 
 #define WIDTH 18
 #define HEIGHT 18
@@ -26,19 +32,40 @@
 #define MAX_BAR_HEIGHT (YAXIS_Y1 - YAXIS_Y0 - 1)
 
 #define INTERVAL 3
+#define TOLERANCE 1000 /* ms */
 
 /**
  * PhoshLoadMeterStatusIcon:
  *
  * A CPU load meter status icon
+ *
+ * Samples are only taken while the icon is mapped and the shell isn't
+ * saving power. Depending on the
+ * `cpu-pressure` setting the graph shows either the CPU usage from
+ * `/proc/stat` or the share of time tasks stalled waiting for a CPU
+ * from `/proc/pressure/cpu`.
  */
 
+/* [cpu] user nice system idle iowait irq softirq steal guest guest_nice */
+#define NCPUSTATES 10 /* Number of fields in /proc/stat the we are interested in */
+#define IDLE 3
+
 struct _PhoshLoadMeterStatusIcon {
   PhoshStatusIcon parent;
   int load_data[NUM_SAMPLES];
   int start_idx;
+  /* Number of consecutive identical samples */
+  int n_same;
   GtkDrawingArea *graph;
   guint timeout_id;
+
+  PhoshPowerSaverManager *power_saver_manager;
+  GSettings *settings;
+  gboolean cpu_pressure;
+  int fd;
+  long last[NCPUSTATES];
+  guint64 last_stall;
+  gint64 last_time;
 };
 
 
@@ -46,10 +73,6 @@ G_DEFINE_TYPE (PhoshLoadMeterStatusIcon, phosh_load_meter_status_icon,
                PHOSH_TYPE_STATUS_ICON);
 
 
-/* [cpu] user nice system idle iowait irq softirq steal guest guest_nice */
-#define NCPUSTATES 10 /* Number of fields in /proc/stat the we are interested in */
-#define IDLE 3
-
 static char*
 skip_token (const char* p)
 {
@@ -59,70 +82,225 @@ skip_token (const char* p)
 }
 
 
-static float
-get_load (void)
+static gboolean
+read_sample (PhoshLoadMeterStatusIcon *self, char *buffer, gsize size)
 {
-  char buffer[256];
-  g_autofd int fd = -1;
-  int len;
-  int total = 0;
-  char* p;
-  int idle;
-  long cp_time[NCPUSTATES];
-  static long last[NCPUSTATES];
-
-  fd = open ("/proc/stat", O_RDONLY);
-  if (fd == -1) {
-    g_warning ("Cannot open /proc/stat: %s", strerror (errno));
-    return 0.0;
+  const char *path = self->cpu_pressure ? "/proc/pressure/cpu" : "/proc/stat";
+  ssize_t len;
+
+  if (self->fd == -1) {
+    self->fd = open (path, O_RDONLY | O_CLOEXEC);
+    if (self->fd == -1) {
+      g_warning ("Cannot open %s: %s", path, strerror (errno));
+      return FALSE;
+    }
   }
 
-  len = read (fd, buffer, sizeof (buffer) - 1);
+  /* procfs regenerates the contents when reading from the start */
+  len = pread (self->fd, buffer, size - 1, 0);
   if (len == -1) {
     g_warning ("read: %s", strerror (errno));
-    return 0.0;
+    g_clear_fd (&self->fd, NULL);
+    return FALSE;
   }
 
   buffer[len] = '\0';
+  return TRUE;
+}
+
+
+static float
+get_load (PhoshLoadMeterStatusIcon *self)
+{
+  char buffer[256];
+  long total = 0;
+  char* p;
+  long idle;
+  long cp_time[NCPUSTATES];
+
+  if (!read_sample (self, buffer, sizeof (buffer)))
+    return 0.0;
 
   p = skip_token (buffer);    /* "cpu" */
 
   for (int i = 0; i < NCPUSTATES; ++i) {
     /* missing fields at the end will read as 0, which is fine for us */
     cp_time[i] = strtoul (p, &p, 0);
-    total += cp_time[i] - last[i];
+    total += cp_time[i] - self->last[i];
   }
 
-  idle = cp_time[IDLE] - last[IDLE];
+  idle = cp_time[IDLE] - self->last[IDLE];
 
   for (int i = 0; i < NCPUSTATES; ++i)
-    last[i] = cp_time[i];
+    self->last[i] = cp_time[i];
+
+  if (total <= 0)
+    return 0.0;
 
   return 1.0f - 1.0f * idle / total;
 }
 
 
+static float
+get_pressure (PhoshLoadMeterStatusIcon *self)
+{
+  char buffer[256];
+  const char *p;
+  guint64 stall;
+  gint64 now, elapsed;
+  float pressure = 0.0;
+
+  if (!read_sample (self, buffer, sizeof (buffer)))
+    return 0.0;
+
+  /* some avg10=0.00 avg60=0.00 avg300=0.00 total=12345 */
+  p = strstr (buffer, "total=");
+  if (p == NULL)
+    return 0.0;
+
+  stall = g_ascii_strtoull (p + strlen ("total="), NULL, 10);
+  now = g_get_monotonic_time ();
+  elapsed = now - self->last_time;
+
+  if (self->last_time && elapsed > 0 && stall >= self->last_stall)
+    pressure = MIN (1.0f, 1.0f * (stall - self->last_stall) / elapsed);
+
+  self->last_stall = stall;
+  self->last_time = now;
+
+  return pressure;
+}
+
+
 static gboolean
 on_timeout (gpointer data)
 {
   PhoshLoadMeterStatusIcon *self = PHOSH_LOAD_METER_STATUS_ICON (data);
+  int prev_idx = (self->start_idx + NUM_SAMPLES - 1) % NUM_SAMPLES;
+  float value;
+  int sample;
 
-  self->load_data[self->start_idx] = get_load () * MAX_BAR_HEIGHT;
+  value = self->cpu_pressure ? get_pressure (self) : get_load (self);
+  sample = value * MAX_BAR_HEIGHT;
+
+  if (sample == self->load_data[prev_idx])
+    self->n_same = MIN (self->n_same + 1, NUM_SAMPLES);
+  else
+    self->n_same = 1;
+
+  self->load_data[self->start_idx] = sample;
   self->start_idx++;
   self->start_idx %= NUM_SAMPLES;
 
-  gtk_widget_queue_draw (GTK_WIDGET (self));
+  /* The graph only changes if not all samples are the same */
+  if (self->n_same < NUM_SAMPLES)
+    gtk_widget_queue_draw (GTK_WIDGET (self->graph));
 
   return G_SOURCE_CONTINUE;
 }
 
 
+static void
+stop_sampling (PhoshLoadMeterStatusIcon *self)
+{
+  if (self->timeout_id) {
+    phosh_timer_service_remove_timeout (phosh_timer_service_get_default (), self->timeout_id);
+    self->timeout_id = 0;
+  }
+}
+
+
+static void
+start_sampling (PhoshLoadMeterStatusIcon *self)
+{
+  if (self->timeout_id)
+    return;
+
+  if (self->power_saver_manager &&
+      phosh_power_saver_manager_get_active (self->power_saver_manager))
+    return;
+
+  self->timeout_id = phosh_timer_service_add_timeout (phosh_timer_service_get_default (),
+                                                      INTERVAL * 1000,
+                                                      TOLERANCE,
+                                                      on_timeout,
+                                                      self);
+  on_timeout (self);
+}
+
+
+static void
+reset_samples (PhoshLoadMeterStatusIcon *self)
+{
+  memset (self->load_data, 0, NUM_SAMPLES * sizeof (int));
+  memset (self->last, 0, NCPUSTATES * sizeof (long));
+  self->start_idx = 0;
+  self->n_same = 0;
+  self->last_stall = 0;
+  self->last_time = 0;
+}
+
+
+static void
+on_cpu_pressure_changed (PhoshLoadMeterStatusIcon *self)
+{
+  gboolean cpu_pressure = g_settings_get_boolean (self->settings, CPU_PRESSURE_KEY);
+
+  if (self->cpu_pressure == cpu_pressure)
+    return;
+
+  self->cpu_pressure = cpu_pressure;
+  g_clear_fd (&self->fd, NULL);
+  reset_samples (self);
+
+  if (self->timeout_id)
+    on_timeout (self);
+}
+
+
+static void
+on_power_saving_changed (PhoshLoadMeterStatusIcon *self)
+{
+  if (phosh_power_saver_manager_get_active (self->power_saver_manager)) {
+    g_debug ("Pausing load sampling to save power");
+    stop_sampling (self);
+  } else if (gtk_widget_get_mapped (GTK_WIDGET (self))) {
+    start_sampling (self);
+  }
+}
+
+
+static void
+phosh_load_meter_status_icon_map (GtkWidget *widget)
+{
+  PhoshLoadMeterStatusIcon *self = PHOSH_LOAD_METER_STATUS_ICON (widget);
+
+  GTK_WIDGET_CLASS (phosh_load_meter_status_icon_parent_class)->map (widget);
+
+  start_sampling (self);
+}
+
+
+static void
+phosh_load_meter_status_icon_unmap (GtkWidget *widget)
+{
+  PhoshLoadMeterStatusIcon *self = PHOSH_LOAD_METER_STATUS_ICON (widget);
+
+  stop_sampling (self);
+
+  GTK_WIDGET_CLASS (phosh_load_meter_status_icon_parent_class)->unmap (widget);
+}
+
+
 static void
 phosh_load_meter_status_icon_dispose (GObject *object)
 {
   PhoshLoadMeterStatusIcon *self = PHOSH_LOAD_METER_STATUS_ICON (object);
 
-  g_clear_handle_id (&self->timeout_id, g_source_remove);
+  stop_sampling (self);
+  g_clear_object (&self->power_saver_manager);
+  g_clear_object (&self->settings);
+  g_clear_fd (&self->fd, NULL);
 
   G_OBJECT_CLASS (phosh_load_meter_status_icon_parent_class)->dispose (object);
 }
@@ -165,6 +343,9 @@ phosh_load_meter_status_icon_class_init (PhoshLoadMeterStatusIconClass *klass)
 
   object_class->dispose = phosh_load_meter_status_icon_dispose;
 
+  widget_class->map = phosh_load_meter_status_icon_map;
+  widget_class->unmap = phosh_load_meter_status_icon_unmap;
+
   gtk_widget_class_set_template_from_resource (widget_class,
                                                "/mobi/phosh/plugins/load-meter-status-icon/si.ui");
 
@@ -178,12 +359,20 @@ phosh_load_meter_status_icon_init (PhoshLoadMeterStatusIcon *self)
 {
   gtk_widget_init_template (GTK_WIDGET (self));
 
-  self->graph = GTK_DRAWING_AREA (gtk_drawing_area_new ());
-
-  memset (self->load_data, 0, NUM_SAMPLES * sizeof (int));
-
-  self->start_idx = 0;
-
-  self->timeout_id = g_timeout_add_seconds (INTERVAL, on_timeout, self);
-  on_timeout (self);
+  self->fd = -1;
+  reset_samples (self);
+
+  self->settings = g_settings_new (LOAD_METER_SCHEMA);
+  self->cpu_pressure = g_settings_get_boolean (self->settings, CPU_PRESSURE_KEY);
+  g_signal_connect_object (self->settings, "changed::" CPU_PRESSURE_KEY,
+                           G_CALLBACK (on_cpu_pressure_changed), self,
+                           G_CONNECT_SWAPPED);
+
+  self->power_saver_manager = phosh_shell_get_power_saver_manager (phosh_shell_get_default ());
+  if (self->power_saver_manager) {
+    g_object_ref (self->power_saver_manager);
+    g_signal_connect_object (self->power_saver_manager, "notify::active",
+                             G_CALLBACK (on_power_saving_changed), self,
+                             G_CONNECT_SWAPPED);
+  }
 }
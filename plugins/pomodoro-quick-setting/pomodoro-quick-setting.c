@@ -11,12 +11,14 @@
 #include "pomodoro-enums.h"
 #include "plugin-shell.h"
 #include "notify-manager.h"
+#include "timer-service.h"
 
 #include <cui-call.h>
 
 #include <glib/gi18n.h>
 
-#define UPDATE_INTERVAL 1 /* seconds */
+#define UPDATE_INTERVAL  1000 /* ms */
+#define UPDATE_TOLERANCE 100 /* ms */
 #define ACTIVE_ICON    "pomodoro-active-symbolic"
 #define BREAK_ICON     "pomodoro-break-symbolic"
 
@@ -40,7 +42,9 @@ struct _PhoshPomodoroQuickSetting {
 
   PhoshStatusIcon         *info;
   PhoshPomodoroState       state;
-  int                      remaining;
+  /* Monotonic time the current phase ends */
+  gint64                   end_time;
+  guint                    expire_id;
   guint                    update_id;
   GSettings               *settings;
 };
@@ -52,8 +56,21 @@ static gboolean _started_on_login;
 static void
 phosh_pomodoro_quick_setting_clear_timers (PhoshPomodoroQuickSetting *self)
 {
-  self->remaining = 0;
-  g_clear_handle_id (&self->update_id, g_source_remove);
+  self->end_time = 0;
+  g_clear_handle_id (&self->expire_id, g_source_remove);
+  if (self->update_id) {
+    phosh_timer_service_remove_timeout (phosh_timer_service_get_default (), self->update_id);
+    self->update_id = 0;
+  }
+}
+
+
+static int
+get_remaining (PhoshPomodoroQuickSetting *self)
+{
+  gint64 remaining = self->end_time - g_get_monotonic_time ();
+
+  return MAX (0, (remaining + G_USEC_PER_SEC - 1) / G_USEC_PER_SEC);
 }
 
 
@@ -115,7 +132,7 @@ update_label (PhoshPomodoroQuickSetting *self)
   switch (self->state) {
   case PHOSH_POMODORO_STATE_ACTIVE:
   case PHOSH_POMODORO_STATE_BREAK:
-    label = cui_call_format_duration ((double) self->remaining);
+    label = cui_call_format_duration ((double) get_remaining (self));
     break;
   case PHOSH_POMODORO_STATE_OFF:
   default:
@@ -130,15 +147,22 @@ static void phosh_pomodoro_quick_setting_set_state (PhoshPomodoroQuickSetting *s
                                                     PhoshPomodoroState         state);
 
 static gboolean
-on_update_expired (gpointer user_data)
+on_update (gpointer user_data)
 {
   PhoshPomodoroQuickSetting *self = PHOSH_POMODORO_QUICK_SETTING (user_data);
 
-  self->remaining -= UPDATE_INTERVAL;
-  if (self->remaining > 0) {
-    update_label (self);
-    return G_SOURCE_CONTINUE;
-  }
+  update_label (self);
+
+  return G_SOURCE_CONTINUE;
+}
+
+
+static gboolean
+on_expired (gpointer user_data)
+{
+  PhoshPomodoroQuickSetting *self = PHOSH_POMODORO_QUICK_SETTING (user_data);
+
+  self->expire_id = 0;
 
   switch (self->state) {
   case PHOSH_POMODORO_STATE_ACTIVE:
@@ -152,7 +176,6 @@ on_update_expired (gpointer user_data)
     g_return_val_if_reached (G_SOURCE_REMOVE);
   }
 
-  update_label (self);
   return G_SOURCE_REMOVE;
 }
 
@@ -181,8 +204,16 @@ phosh_pomodoro_quick_setting_set_state (PhoshPomodoroQuickSetting *self, PhoshPo
   }
 
   if (timeout) {
-    self->remaining = timeout;
-    self->update_id = g_timeout_add_seconds (UPDATE_INTERVAL, on_update_expired, self);
+    self->end_time = g_get_monotonic_time () + (gint64) timeout * G_USEC_PER_SEC;
+    /* Phase changes need to happen on time as they notify the user */
+    self->expire_id = g_timeout_add_seconds (timeout, on_expired, self);
+    g_source_set_name_by_id (self->expire_id, "[phosh-pomodoro] phase end");
+    /* The countdown is only cosmetic, so it pauses while nobody looks */
+    self->update_id = phosh_timer_service_add_aligned_timeout (phosh_timer_service_get_default (),
+                                                               UPDATE_INTERVAL,
+                                                               UPDATE_TOLERANCE,
+                                                               on_update,
+                                                               self);
   }
 
   update_label (self);
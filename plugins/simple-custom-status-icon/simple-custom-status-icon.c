@@ -7,13 +7,23 @@
  */
 
 #include "simple-custom-status-icon.h"
+#include "timer-service.h"
 
 #define INTERVAL 10
+#define TOLERANCE 1000 /* ms */
+
+#define STATUS_FILE "phosh-simple-custom-status-icon"
 
 /**
  * PhoshSimpleCustomStatusIcon:
  *
  * A simple custom status-icon for demonstration purposes.
+ *
+ * By default it cycles through some icons. Other programs can push
+ * the icon to show instead by writing its name to
+ * `$XDG_RUNTIME_DIR/phosh-simple-custom-status-icon`. The icon gets
+ * updated whenever the file changes, removing the file resumes
+ * cycling.
  */
 
 static char *ICON_NAMES[] = {"face-angel-symbolic", "face-angry-symbolic", "face-cool-symbolic",
@@ -23,7 +33,11 @@ static char *ICON_NAMES[] = {"face-angel-symbolic", "face-angry-symbolic", "face
 struct _PhoshSimpleCustomStatusIcon {
   PhoshStatusIcon parent;
 
-  guint timeout_id;
+  guint         timeout_id;
+
+  GFile        *status_file;
+  GFileMonitor *monitor;
+  GCancellable *cancel;
 };
 
 G_DEFINE_TYPE (PhoshSimpleCustomStatusIcon, phosh_simple_custom_status_icon,
@@ -43,15 +57,105 @@ on_timeout (gpointer data)
 }
 
 
+static void
+start_cycling (PhoshSimpleCustomStatusIcon *self)
+{
+  if (self->timeout_id)
+    return;
+
+  /* Aligned to the wall clock so it runs together with other periodic updates */
+  self->timeout_id = phosh_timer_service_add_aligned_timeout (phosh_timer_service_get_default (),
+                                                              INTERVAL * 1000,
+                                                              TOLERANCE,
+                                                              on_timeout,
+                                                              self);
+  on_timeout (self);
+}
+
+
+static void
+stop_cycling (PhoshSimpleCustomStatusIcon *self)
+{
+  if (self->timeout_id == 0)
+    return;
+
+  phosh_timer_service_remove_timeout (phosh_timer_service_get_default (), self->timeout_id);
+  self->timeout_id = 0;
+}
+
+
+static void
+on_status_file_loaded (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+  PhoshSimpleCustomStatusIcon *self;
+  g_autoptr (GError) err = NULL;
+  g_autofree char *contents = NULL;
+  g_auto (GStrv) lines = NULL;
+
+  if (!g_file_load_contents_finish (G_FILE (source_object), res, &contents, NULL, NULL, &err)) {
+    if (g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+      return;
+
+    self = PHOSH_SIMPLE_CUSTOM_STATUS_ICON (user_data);
+    if (!g_error_matches (err, G_IO_ERROR, G_IO_ERROR_NOT_FOUND))
+      g_warning ("Failed to load status file: %s", err->message);
+    start_cycling (self);
+    return;
+  }
+
+  self = PHOSH_SIMPLE_CUSTOM_STATUS_ICON (user_data);
+  lines = g_strsplit (contents, "\n", 2);
+  if (lines[0] == NULL || *g_strstrip (lines[0]) == '\0') {
+    start_cycling (self);
+    return;
+  }
+
+  stop_cycling (self);
+  g_debug ("Pushed icon name %s", lines[0]);
+  phosh_status_icon_set_icon_name (PHOSH_STATUS_ICON (self), lines[0]);
+}
+
+
+static void
+load_status_file (PhoshSimpleCustomStatusIcon *self)
+{
+  g_cancellable_cancel (self->cancel);
+  g_set_object (&self->cancel, g_cancellable_new ());
+
+  g_file_load_contents_async (self->status_file,
+                              self->cancel,
+                              on_status_file_loaded,
+                              self);
+}
+
+
+static void
+on_status_file_changed (PhoshSimpleCustomStatusIcon *self,
+                        GFile                       *file,
+                        GFile                       *other_file,
+                        GFileMonitorEvent            event_type)
+{
+  switch (event_type) {
+  case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
+  case G_FILE_MONITOR_EVENT_DELETED:
+    load_status_file (self);
+    break;
+  default:
+    break;
+  }
+}
+
+
 static void
 phosh_simple_custom_status_icon_destroy (GtkWidget *widget)
 {
   PhoshSimpleCustomStatusIcon *self = PHOSH_SIMPLE_CUSTOM_STATUS_ICON (widget);
 
-  if (self->timeout_id != 0) {
-    g_source_remove (self->timeout_id);
-    self->timeout_id = 0;
-  }
+  stop_cycling (self);
+  g_cancellable_cancel (self->cancel);
+  g_clear_object (&self->cancel);
+  g_clear_object (&self->monitor);
+  g_clear_object (&self->status_file);
 
   GTK_WIDGET_CLASS (phosh_simple_custom_status_icon_parent_class)->destroy (widget);
 }
@@ -72,7 +176,21 @@ phosh_simple_custom_status_icon_class_init (PhoshSimpleCustomStatusIconClass *kl
 static void
 phosh_simple_custom_status_icon_init (PhoshSimpleCustomStatusIcon *self)
 {
+  g_autofree char *path = g_build_filename (g_get_user_runtime_dir (), STATUS_FILE, NULL);
+  g_autoptr (GError) err = NULL;
+
   gtk_widget_init_template (GTK_WIDGET (self));
-  self->timeout_id = g_timeout_add_seconds (INTERVAL, on_timeout, self);
-  on_timeout (self);
+
+  self->status_file = g_file_new_for_path (path);
+  self->monitor = g_file_monitor_file (self->status_file, G_FILE_MONITOR_NONE, NULL, &err);
+  if (self->monitor) {
+    g_signal_connect_object (self->monitor, "changed",
+                             G_CALLBACK (on_status_file_changed),
+                             self,
+                             G_CONNECT_SWAPPED);
+  } else {
+    g_warning ("Failed to monitor %s: %s", path, err->message);
+  }
+
+  load_status_file (self);
 }
@@ -14,6 +14,10 @@
  * PhoshSyncthingFolderRow:
  *
  * A widget to display a single Syncthing folder.
+ *
+ * The row updates once per batch of changed folder properties and
+ * only while it's mapped. Changes while hidden are applied when it
+ * gets mapped again.
  */
 
 enum {
@@ -29,6 +33,8 @@ struct _PhoshSyncthingFolderRow {
   GtkImage          *icon;
 
   SyncbusImplFolder *folder;
+  /* Folder changed while unmapped */
+  gboolean           dirty;
 };
 
 G_DEFINE_TYPE (PhoshSyncthingFolderRow, phosh_syncthing_folder_row, HDY_TYPE_ACTION_ROW);
@@ -62,7 +68,7 @@ on_activated (PhoshSyncthingFolderRow *self)
 
 
 static void
-on_props_changed (PhoshSyncthingFolderRow *self)
+update_row (PhoshSyncthingFolderRow *self)
 {
   const char *label = syncbus_impl_folder_get_label (self->folder);
   const char *path = syncbus_impl_folder_get_path (self->folder);
@@ -72,6 +78,8 @@ on_props_changed (PhoshSyncthingFolderRow *self)
   g_autofree char *title = NULL;
   g_autofree char *subtitle = NULL;
 
+  self->dirty = FALSE;
+
   /* Translators: This is completion status with a percent symbol */
   title = g_strdup_printf ("%s (%d%%)", label, completion);
   if (g_strcmp0 (state, "") == 0)
@@ -88,6 +96,34 @@ on_props_changed (PhoshSyncthingFolderRow *self)
 }
 
 
+static void
+on_properties_changed (PhoshSyncthingFolderRow *self,
+                       GVariant                *changed_properties,
+                       GStrv                    invalidated_properties,
+                       GDBusProxy              *proxy)
+{
+  /* Nobody sees the row, catch up when it gets mapped */
+  if (!gtk_widget_get_mapped (GTK_WIDGET (self))) {
+    self->dirty = TRUE;
+    return;
+  }
+
+  update_row (self);
+}
+
+
+static void
+phosh_syncthing_folder_row_map (GtkWidget *widget)
+{
+  PhoshSyncthingFolderRow *self = PHOSH_SYNCTHING_FOLDER_ROW (widget);
+
+  if (self->dirty)
+    update_row (self);
+
+  GTK_WIDGET_CLASS (phosh_syncthing_folder_row_parent_class)->map (widget);
+}
+
+
 static void
 phosh_syncthing_folder_row_dispose (GObject *object)
 {
@@ -108,6 +144,8 @@ phosh_syncthing_folder_row_class_init (PhoshSyncthingFolderRowClass *klass)
   object_class->set_property = phosh_syncthing_folder_row_set_property;
   object_class->dispose = phosh_syncthing_folder_row_dispose;
 
+  widget_class->map = phosh_syncthing_folder_row_map;
+
   /**
    * PhoshSyncthingFolderRow:folder:
    *
@@ -153,16 +191,17 @@ phosh_syncthing_folder_row_set_folder (PhoshSyncthingFolderRow *self, SyncbusImp
     return;
 
   if (self->folder) {
-    g_signal_handlers_disconnect_by_func (self->folder, on_props_changed, self);
+    g_signal_handlers_disconnect_by_func (self->folder, on_properties_changed, self);
     g_clear_object (&self->folder);
   }
 
   g_set_object (&self->folder, folder);
+  /* One update per PropertiesChanged rather than one per property */
   g_signal_connect_object (self->folder,
-                           "notify",
-                           G_CALLBACK (on_props_changed),
+                           "g-properties-changed",
+                           G_CALLBACK (on_properties_changed),
                            self,
                            G_CONNECT_SWAPPED);
 
-  on_props_changed (self);
+  update_row (self);
 }
@@ -9,12 +9,24 @@
 #include "ticket.h"
 #include "ticket-box.h"
 #include "ticket-row.h"
+#include "ticket-thumbnail.h"
 
 #include <evince-document.h>
 #include <evince-view.h>
 
+#include <errno.h>
+
 #define TICKET_BOX_SCHEMA_ID "sm.puri.phosh.plugins.ticket-box"
 #define TICKET_BOX_FOLDER_KEY "folder"
+#define TICKET_BOX_CACHE "ticket-box.gvariant"
+#define TICKET_BOX_CACHE_FORMAT "(sxa(ssx))"
+#define TICKET_ATTRIBUTES G_FILE_ATTRIBUTE_STANDARD_NAME "," \
+                          G_FILE_ATTRIBUTE_STANDARD_SYMBOLIC_ICON "," \
+                          G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME "," \
+                          G_FILE_ATTRIBUTE_TIME_MODIFIED "," \
+                          G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE
+/* Matches the document view's max-content-width */
+#define PREVIEW_WIDTH 300
 
 /**
  * PhoshTicketBox
@@ -28,11 +40,14 @@ struct _PhoshTicketBox {
   GFile        *dir;
   char         *ticket_box_path;
   GCancellable *cancel;
+  GFileMonitor *monitor;
 
   GListStore   *model;
   GtkListBox   *lb_tickets;
   GtkStack     *stack_tickets;
 
+  GtkStack     *stack_view;
+  GtkImage     *preview;
   EvView       *view;
 };
 
@@ -40,15 +55,92 @@ G_DEFINE_TYPE (PhoshTicketBox, phosh_ticket_box, GTK_TYPE_BOX);
 
 G_DEFINE_AUTOPTR_CLEANUP_FUNC (EvDocument, g_object_unref)
 
+static void
+load_document_in_thread (GTask        *task,
+                         gpointer      source_object,
+                         gpointer      task_data,
+                         GCancellable *cancel)
+{
+  PhoshTicket *ticket = PHOSH_TICKET (task_data);
+  GError *err = NULL;
+  EvDocument *doc;
+
+  doc = ev_document_factory_get_document_for_gfile (phosh_ticket_get_file (ticket),
+                                                    EV_DOCUMENT_LOAD_FLAG_NONE,
+                                                    cancel,
+                                                    &err);
+  if (doc == NULL) {
+    g_task_return_error (task, err);
+    return;
+  }
+
+  g_task_return_pointer (task, doc, g_object_unref);
+}
+
+
+static void
+on_document_loaded (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+  PhoshTicketBox *self = PHOSH_TICKET_BOX (source_object);
+  PhoshTicket *ticket = g_task_get_task_data (G_TASK (res));
+  g_autoptr (GError) err = NULL;
+  g_autoptr (EvDocument) doc = NULL;
+  g_autoptr (EvDocumentModel) model = NULL;
+
+  doc = g_task_propagate_pointer (G_TASK (res), &err);
+  if (doc == NULL) {
+    if (!g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+      g_warning ("Failed to load %s: %s", phosh_ticket_get_display_name (ticket), err->message);
+    return;
+  }
+
+  model = ev_document_model_new_with_document (doc);
+  ev_view_set_model (self->view, model);
+
+  gtk_stack_set_visible_child_name (self->stack_view, "document");
+  gtk_stack_set_visible_child_name (self->stack_tickets, "ticket-view");
+}
+
+
+static void
+show_preview (PhoshTicketBox *self, PhoshTicket *ticket)
+{
+  GdkPixbuf *pixbuf = phosh_ticket_get_thumbnail (ticket);
+  g_autoptr (GdkPixbuf) scaled = NULL;
+  cairo_surface_t *surface;
+  int scale, width, height;
+
+  if (pixbuf == NULL)
+    return;
+
+  /* Fit the view's width, in device pixels */
+  scale = gtk_widget_get_scale_factor (GTK_WIDGET (self));
+  width = gdk_pixbuf_get_width (pixbuf);
+  height = gdk_pixbuf_get_height (pixbuf);
+  if (width > PREVIEW_WIDTH * scale) {
+    height = MAX (1, height * PREVIEW_WIDTH * scale / width);
+    width = PREVIEW_WIDTH * scale;
+    scaled = gdk_pixbuf_scale_simple (pixbuf, width, height, GDK_INTERP_BILINEAR);
+  } else {
+    scaled = g_object_ref (pixbuf);
+  }
+
+  surface = gdk_cairo_surface_create_from_pixbuf (scaled, scale, NULL);
+  gtk_image_set_from_surface (self->preview, surface);
+  cairo_surface_destroy (surface);
+
+  gtk_stack_set_visible_child_name (self->stack_view, "preview");
+  gtk_stack_set_visible_child_name (self->stack_tickets, "ticket-view");
+}
+
+
 static void
 on_row_selected (PhoshTicketBox *self,
                  GtkListBoxRow  *row,
                  GtkListBox     *box)
 {
-  g_autoptr (GError) err = NULL;
   g_autoptr (PhoshTicket) ticket = NULL;
-  g_autoptr (EvDocument) doc = NULL;
-  g_autoptr (EvDocumentModel) model = NULL;
+  g_autoptr (GTask) task = NULL;
 
   if (row == NULL)
     return;
@@ -56,18 +148,14 @@ on_row_selected (PhoshTicketBox *self,
   g_object_get (row, "ticket", &ticket, NULL);
   g_debug ("row selected: %s", phosh_ticket_get_display_name (ticket));
 
-  doc = ev_document_factory_get_document_for_gfile (phosh_ticket_get_file (ticket),
-                                                    EV_DOCUMENT_LOAD_FLAG_NONE,
-                                                    self->cancel,
-                                                    &err);
-  if (doc == NULL) {
-    g_warning ("Failed to load %s: %s", phosh_ticket_get_display_name (ticket), err->message);
-    return;
-  }
-  model = ev_document_model_new_with_document (doc);
-  ev_view_set_model (self->view, model);
+  /* Show the cached render right away while the document loads */
+  show_preview (self, ticket);
 
-  gtk_stack_set_visible_child_name (self->stack_tickets, "ticket-view");
+  /* Parsing the PDF can take a while so keep it off the shell's main loop */
+  task = g_task_new (self, self->cancel, on_document_loaded, NULL);
+  g_task_set_source_tag (task, on_row_selected);
+  g_task_set_task_data (task, g_object_ref (ticket), g_object_unref);
+  g_task_run_in_thread (task, load_document_in_thread);
 
   gtk_list_box_select_row (box, NULL);
 }
@@ -87,6 +175,7 @@ phosh_ticket_box_finalize (GObject *object)
 
   g_cancellable_cancel (self->cancel);
   g_clear_object (&self->cancel);
+  g_clear_object (&self->monitor);
   g_clear_object (&self->model);
 
   g_clear_object (&self->dir);
@@ -111,6 +200,8 @@ phosh_ticket_box_class_init (PhoshTicketBoxClass *klass)
                                                "/mobi/phosh/plugins/ticket-box/ticket-box.ui");
   gtk_widget_class_bind_template_child (widget_class, PhoshTicketBox, lb_tickets);
   gtk_widget_class_bind_template_child (widget_class, PhoshTicketBox, stack_tickets);
+  gtk_widget_class_bind_template_child (widget_class, PhoshTicketBox, stack_view);
+  gtk_widget_class_bind_template_child (widget_class, PhoshTicketBox, preview);
   gtk_widget_class_bind_template_child (widget_class, PhoshTicketBox, view);
   gtk_widget_class_bind_template_callback (widget_class, on_view_close_clicked);
 
@@ -138,6 +229,253 @@ ticket_compare (gconstpointer a, gconstpointer b, gpointer user_data)
 }
 
 
+static void
+on_thumbnail_loaded (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+  PhoshTicket *ticket = PHOSH_TICKET (source_object);
+  g_autoptr (GError) err = NULL;
+  g_autoptr (GdkPixbuf) pixbuf = NULL;
+
+  pixbuf = phosh_ticket_thumbnail_load_finish (res, &err);
+  if (pixbuf == NULL) {
+    if (!g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+      g_warning ("Failed to render %s: %s", phosh_ticket_get_display_name (ticket), err->message);
+    return;
+  }
+
+  phosh_ticket_set_thumbnail (ticket, pixbuf);
+}
+
+
+static void
+update_stack (PhoshTicketBox *self)
+{
+  const char *stack_child = "tickets";
+  const char *current = gtk_stack_get_visible_child_name (self->stack_tickets);
+
+  /* Don't hide a ticket that is being shown */
+  if (g_strcmp0 (current, "ticket-view") == 0)
+    return;
+
+  if (g_list_model_get_n_items (G_LIST_MODEL (self->model)) == 0)
+    stack_child = "no-tickets";
+
+  gtk_stack_set_visible_child_name (self->stack_tickets, stack_child);
+}
+
+
+static gboolean
+find_ticket (PhoshTicketBox *self, GFile *file, guint *pos)
+{
+  for (guint i = 0; i < g_list_model_get_n_items (G_LIST_MODEL (self->model)); i++) {
+    g_autoptr (PhoshTicket) ticket = g_list_model_get_item (G_LIST_MODEL (self->model), i);
+
+    if (g_file_equal (phosh_ticket_get_file (ticket), file)) {
+      *pos = i;
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+
+static void
+remove_ticket (PhoshTicketBox *self, GFile *file)
+{
+  guint pos;
+
+  if (find_ticket (self, file, &pos))
+    g_list_store_remove (self->model, pos);
+}
+
+
+static void
+add_ticket (PhoshTicketBox *self, GFile *file, GFileInfo *info)
+{
+  g_autoptr (PhoshTicket) ticket = NULL;
+
+  remove_ticket (self, file);
+
+  if (g_strcmp0 (g_file_info_get_content_type (info), "application/pdf") != 0)
+    return;
+
+  ticket = phosh_ticket_new (file, info);
+  g_list_store_insert_sorted (self->model, ticket, ticket_compare, NULL);
+  /* Render in the background so showing the ticket is instant */
+  phosh_ticket_thumbnail_load_async (ticket, self->cancel, on_thumbnail_loaded, NULL);
+}
+
+
+static char *
+get_cache_path (void)
+{
+  return g_build_filename (g_get_user_cache_dir (), "phosh", TICKET_BOX_CACHE, NULL);
+}
+
+
+static gint64
+get_dir_mtime (PhoshTicketBox *self)
+{
+  g_autoptr (GFileInfo) info = NULL;
+  g_autoptr (GDateTime) mtime = NULL;
+
+  info = g_file_query_info (self->dir, G_FILE_ATTRIBUTE_TIME_MODIFIED ","
+                            G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC,
+                            G_FILE_QUERY_INFO_NONE, NULL, NULL);
+  if (info == NULL)
+    return 0;
+
+  mtime = g_file_info_get_modification_date_time (info);
+  return mtime ? g_date_time_to_unix_usec (mtime) : 0;
+}
+
+
+static void
+save_tickets (PhoshTicketBox *self)
+{
+  g_autofree char *path = get_cache_path ();
+  g_autofree char *dir = g_path_get_dirname (path);
+  g_autoptr (GVariant) variant = NULL;
+  g_autoptr (GError) err = NULL;
+  GVariantBuilder builder;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(ssx)"));
+  for (guint i = 0; i < g_list_model_get_n_items (G_LIST_MODEL (self->model)); i++) {
+    g_autoptr (PhoshTicket) ticket = g_list_model_get_item (G_LIST_MODEL (self->model), i);
+    g_autoptr (GDateTime) mtime = phosh_ticket_get_mod_time (ticket);
+    g_autofree char *name = g_file_get_basename (phosh_ticket_get_file (ticket));
+
+    g_variant_builder_add (&builder, "(ssx)",
+                           name,
+                           phosh_ticket_get_display_name (ticket),
+                           mtime ? g_date_time_to_unix_usec (mtime) : 0);
+  }
+  variant = g_variant_ref_sink (g_variant_new (TICKET_BOX_CACHE_FORMAT,
+                                               self->ticket_box_path,
+                                               get_dir_mtime (self),
+                                               &builder));
+
+  if (g_mkdir_with_parents (dir, 0700) < 0) {
+    g_warning ("Failed to create %s: %s", dir, g_strerror (errno));
+    return;
+  }
+
+  if (!g_file_set_contents (path, g_variant_get_data (variant), g_variant_get_size (variant), &err))
+    g_warning ("Failed to save ticket list: %s", err->message);
+}
+
+
+/* Use the last known list of tickets if the directory didn't change */
+static gboolean
+load_saved_tickets (PhoshTicketBox *self)
+{
+  g_autofree char *path = get_cache_path ();
+  g_autofree char *contents = NULL;
+  g_autoptr (GVariant) variant = NULL;
+  g_autoptr (GVariantIter) iter = NULL;
+  g_autoptr (GIcon) icon = NULL;
+  const char *dir_path, *name, *display_name;
+  gint64 dir_mtime, mtime;
+  gsize len;
+
+  if (!g_file_get_contents (path, &contents, &len, NULL))
+    return FALSE;
+
+  variant = g_variant_new_from_data (G_VARIANT_TYPE (TICKET_BOX_CACHE_FORMAT),
+                                     contents, len, FALSE,
+                                     g_free, g_steal_pointer (&contents));
+  g_variant_ref_sink (variant);
+  g_variant_get (variant, "(&sxa(ssx))", &dir_path, &dir_mtime, &iter);
+
+  if (g_strcmp0 (dir_path, self->ticket_box_path) != 0 ||
+      dir_mtime == 0 ||
+      dir_mtime != get_dir_mtime (self))
+    return FALSE;
+
+  icon = g_content_type_get_symbolic_icon ("application/pdf");
+  while (g_variant_iter_next (iter, "(&s&sx)", &name, &display_name, &mtime)) {
+    g_autoptr (GFile) file = g_file_get_child (self->dir, name);
+    g_autoptr (GFileInfo) info = g_file_info_new ();
+    g_autoptr (GDateTime) dt = g_date_time_new_from_unix_utc_usec (mtime);
+
+    g_file_info_set_name (info, name);
+    g_file_info_set_display_name (info, display_name);
+    g_file_info_set_content_type (info, "application/pdf");
+    g_file_info_set_symbolic_icon (info, icon);
+    if (dt)
+      g_file_info_set_modification_date_time (info, dt);
+
+    add_ticket (self, file, info);
+  }
+
+  g_debug ("Using %u saved tickets", g_list_model_get_n_items (G_LIST_MODEL (self->model)));
+  return TRUE;
+}
+
+
+static void
+on_file_info_queried (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+  GFile *file = G_FILE (source_object);
+  g_autoptr (GError) err = NULL;
+  g_autoptr (GFileInfo) info = NULL;
+  PhoshTicketBox *self;
+
+  info = g_file_query_info_finish (file, res, &err);
+  if (info == NULL) {
+    if (!g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED) &&
+        !g_error_matches (err, G_IO_ERROR, G_IO_ERROR_NOT_FOUND)) {
+      g_warning ("Failed to query %s: %s", g_file_peek_path (file), err->message);
+    }
+    return;
+  }
+
+  self = PHOSH_TICKET_BOX (user_data);
+  add_ticket (self, file, info);
+  update_stack (self);
+  save_tickets (self);
+}
+
+
+static void
+on_dir_changed (PhoshTicketBox    *self,
+                GFile             *file,
+                GFile             *other_file,
+                GFileMonitorEvent  event,
+                GFileMonitor      *monitor)
+{
+  GFile *added = NULL;
+
+  switch (event) {
+  case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
+  case G_FILE_MONITOR_EVENT_MOVED_IN:
+    added = file;
+    break;
+  case G_FILE_MONITOR_EVENT_RENAMED:
+    remove_ticket (self, file);
+    added = other_file;
+    break;
+  case G_FILE_MONITOR_EVENT_DELETED:
+  case G_FILE_MONITOR_EVENT_MOVED_OUT:
+    remove_ticket (self, file);
+    update_stack (self);
+    save_tickets (self);
+    return;
+  default:
+    return;
+  }
+
+  g_debug ("Ticket %s changed", g_file_peek_path (added));
+  g_file_query_info_async (added, TICKET_ATTRIBUTES,
+                           G_FILE_QUERY_INFO_NONE,
+                           G_PRIORITY_LOW,
+                           self->cancel,
+                           on_file_info_queried,
+                           self);
+}
+
+
 static void
 on_file_child_enumerated (GObject *source_object, GAsyncResult *res, gpointer user_data)
 {
@@ -145,7 +483,6 @@ on_file_child_enumerated (GObject *source_object, GAsyncResult *res, gpointer us
   GFile *dir = G_FILE (source_object);
   g_autoptr (GFileEnumerator) enumerator = NULL;
   PhoshTicketBox *self;
-  const char *stack_child = "tickets";
 
   enumerator = g_file_enumerate_children_finish (dir, res, &err);
   if (enumerator == NULL) {
@@ -158,7 +495,6 @@ on_file_child_enumerated (GObject *source_object, GAsyncResult *res, gpointer us
   while (TRUE) {
     GFile *file;
     GFileInfo *info;
-    g_autoptr (PhoshTicket) ticket = NULL;
 
     if (!g_file_enumerator_iterate (enumerator, &info, &file, self->cancel, &err)) {
       g_warning ("Failed to list contents of ticket dir %s: $%s",
@@ -170,17 +506,11 @@ on_file_child_enumerated (GObject *source_object, GAsyncResult *res, gpointer us
     if (!file)
       break;
 
-    if (g_strcmp0 (g_file_info_get_content_type (info), "application/pdf") != 0)
-      continue;
-
-    ticket = phosh_ticket_new (file, info);
-    g_list_store_insert_sorted (self->model, ticket, ticket_compare, NULL);
+    add_ticket (self, file, info);
   }
 
-  if (g_list_model_get_n_items (G_LIST_MODEL (self->model)) == 0)
-    stack_child = "no-tickets";
-
-  gtk_stack_set_visible_child_name (self->stack_tickets, stack_child);
+  update_stack (self);
+  save_tickets (self);
 }
 
 
@@ -189,6 +519,7 @@ load_tickets (PhoshTicketBox *self)
 {
   g_autoptr (GSettings) settings = g_settings_new (TICKET_BOX_SCHEMA_ID);
   g_autofree char *folder = NULL;
+  g_autoptr (GError) err = NULL;
 
   folder = g_settings_get_string (settings, TICKET_BOX_FOLDER_KEY);
   if (folder[0] != '/')
@@ -198,16 +529,24 @@ load_tickets (PhoshTicketBox *self)
 
   self->dir = g_file_new_for_path (self->ticket_box_path);
 
-  /*
-   * Since the lockscreen is rebuilt on lock we don't worry about changes in directory contesnt,
-   *  should we do, we can add a GFileMonitor later on
-   */
+  /* Track changes while we're around so the list stays current */
+  self->monitor = g_file_monitor_directory (self->dir, G_FILE_MONITOR_WATCH_MOVES,
+                                            self->cancel, &err);
+  if (self->monitor) {
+    g_signal_connect_object (self->monitor, "changed",
+                             G_CALLBACK (on_dir_changed), self,
+                             G_CONNECT_SWAPPED);
+  } else {
+    g_warning ("Failed to monitor %s: %s", self->ticket_box_path, err->message);
+  }
+
+  if (load_saved_tickets (self)) {
+    update_stack (self);
+    return;
+  }
+
   g_file_enumerate_children_async (self->dir,
-                                   G_FILE_ATTRIBUTE_STANDARD_NAME ","
-                                   G_FILE_ATTRIBUTE_STANDARD_SYMBOLIC_ICON ","
-                                   G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME ","
-                                   G_FILE_ATTRIBUTE_TIME_MODIFIED ","
-                                   G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE,
+                                   TICKET_ATTRIBUTES,
                                    G_FILE_QUERY_INFO_NONE,
                                    G_PRIORITY_LOW,
                                    self->cancel,
@@ -226,6 +565,7 @@ phosh_ticket_box_init (PhoshTicketBox *self)
   gtk_widget_init_template (GTK_WIDGET (self));
 
   self->model = g_list_store_new (PHOSH_TYPE_TICKET);
+  self->cancel = g_cancellable_new ();
 
   css_provider = gtk_css_provider_new ();
   gtk_css_provider_load_from_resource (css_provider,
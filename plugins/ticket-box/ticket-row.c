@@ -13,6 +13,8 @@
 #include <glib/gi18n.h>
 #include <handy.h>
 
+#define THUMBNAIL_SIZE 32
+
 enum {
   PROP_0,
   PROP_TICKET,
@@ -25,10 +27,48 @@ struct _PhoshTicketRow {
   HdyActionRow parent;
 
   PhoshTicket *ticket;
+  GtkImage    *thumbnail;
 };
 G_DEFINE_TYPE (PhoshTicketRow, phosh_ticket_row, HDY_TYPE_ACTION_ROW)
 
 
+static void
+on_thumbnail_changed (PhoshTicketRow *self)
+{
+  GdkPixbuf *pixbuf = phosh_ticket_get_thumbnail (self->ticket);
+  g_autoptr (GdkPixbuf) scaled = NULL;
+  cairo_surface_t *surface;
+  int scale, size, width, height;
+
+  if (pixbuf == NULL) {
+    /* TODO: by document type */
+    hdy_action_row_set_icon_name (HDY_ACTION_ROW (self), "x-office-document-symbolic");
+    gtk_widget_set_visible (GTK_WIDGET (self->thumbnail), FALSE);
+    return;
+  }
+
+  scale = gtk_widget_get_scale_factor (GTK_WIDGET (self));
+  size = THUMBNAIL_SIZE * scale;
+  width = gdk_pixbuf_get_width (pixbuf);
+  height = gdk_pixbuf_get_height (pixbuf);
+  if (width > height) {
+    height = MAX (1, height * size / width);
+    width = size;
+  } else {
+    width = MAX (1, width * size / height);
+    height = size;
+  }
+
+  scaled = gdk_pixbuf_scale_simple (pixbuf, width, height, GDK_INTERP_BILINEAR);
+  surface = gdk_cairo_surface_create_from_pixbuf (scaled, scale, NULL);
+  gtk_image_set_from_surface (self->thumbnail, surface);
+  cairo_surface_destroy (surface);
+
+  hdy_action_row_set_icon_name (HDY_ACTION_ROW (self), NULL);
+  gtk_widget_set_visible (GTK_WIDGET (self->thumbnail), TRUE);
+}
+
+
 static void
 phosh_ticket_row_set_property (GObject      *object,
                                guint         property_id,
@@ -42,8 +82,10 @@ phosh_ticket_row_set_property (GObject      *object,
     self->ticket = g_value_dup_object (value);
     hdy_preferences_row_set_title (HDY_PREFERENCES_ROW (self),
                                    phosh_ticket_get_display_name (self->ticket));
-/* TODO: by document type */
-    hdy_action_row_set_icon_name (HDY_ACTION_ROW (self), "x-office-document-symbolic");
+    g_signal_connect_object (self->ticket, "notify::thumbnail",
+                             G_CALLBACK (on_thumbnail_changed), self,
+                             G_CONNECT_SWAPPED);
+    on_thumbnail_changed (self);
     break;
   default:
     G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
@@ -106,6 +148,8 @@ phosh_ticket_row_class_init (PhoshTicketRowClass *klass)
 static void
 phosh_ticket_row_init (PhoshTicketRow *self)
 {
+  self->thumbnail = GTK_IMAGE (gtk_image_new ());
+  hdy_action_row_add_prefix (HDY_ACTION_ROW (self), GTK_WIDGET (self->thumbnail));
 }
 
 
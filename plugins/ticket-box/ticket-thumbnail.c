@@ -0,0 +1,226 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "phosh-config.h"
+
+#include "ticket-thumbnail.h"
+
+#include <evince-document.h>
+
+#include <errno.h>
+
+/* The freedesktop.org thumbnail spec's x-large size, big enough for QR codes */
+#define THUMBNAIL_SIZE 512
+#define THUMBNAIL_DIR "x-large"
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (EvDocument, g_object_unref)
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (EvPage, g_object_unref)
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (EvRenderContext, g_object_unref)
+
+typedef struct {
+  GFile *file;
+  char  *uri;
+  char  *mtime;
+} ThumbnailData;
+
+
+static void
+thumbnail_data_free (ThumbnailData *data)
+{
+  g_clear_object (&data->file);
+  g_free (data->uri);
+  g_free (data->mtime);
+  g_free (data);
+}
+
+
+static char *
+get_thumbnail_path (const char *uri)
+{
+  g_autofree char *md5 = g_compute_checksum_for_string (G_CHECKSUM_MD5, uri, -1);
+  g_autofree char *name = g_strconcat (md5, ".png", NULL);
+
+  return g_build_filename (g_get_user_cache_dir (), "thumbnails", THUMBNAIL_DIR, name, NULL);
+}
+
+
+static GdkPixbuf *
+load_cached (ThumbnailData *data, const char *path)
+{
+  g_autoptr (GdkPixbuf) pixbuf = NULL;
+
+  pixbuf = gdk_pixbuf_new_from_file (path, NULL);
+  if (pixbuf == NULL)
+    return NULL;
+
+  if (g_strcmp0 (gdk_pixbuf_get_option (pixbuf, "tEXt::Thumb::URI"), data->uri) != 0 ||
+      g_strcmp0 (gdk_pixbuf_get_option (pixbuf, "tEXt::Thumb::MTime"), data->mtime) != 0) {
+    g_debug ("Thumbnail for %s outdated", data->uri);
+    return NULL;
+  }
+
+  return g_steal_pointer (&pixbuf);
+}
+
+
+static GdkPixbuf *
+render (ThumbnailData *data, GCancellable *cancel, GError **error)
+{
+  g_autoptr (EvDocument) doc = NULL;
+  g_autoptr (EvPage) page = NULL;
+  g_autoptr (EvRenderContext) rc = NULL;
+  cairo_surface_t *surface;
+  GdkPixbuf *pixbuf;
+  double width, height;
+
+  doc = ev_document_factory_get_document_for_gfile (data->file,
+                                                    EV_DOCUMENT_LOAD_FLAG_NONE,
+                                                    cancel,
+                                                    error);
+  if (doc == NULL)
+    return NULL;
+
+  ev_document_doc_mutex_lock ();
+  page = ev_document_get_page (doc, 0);
+  ev_document_get_page_size (doc, 0, &width, &height);
+  rc = ev_render_context_new (page, 0, THUMBNAIL_SIZE / MAX (width, height));
+  surface = ev_document_render (doc, rc);
+  ev_document_doc_mutex_unlock ();
+
+  if (surface == NULL) {
+    g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED, "Failed to render %s", data->uri);
+    return NULL;
+  }
+
+  pixbuf = gdk_pixbuf_get_from_surface (surface,
+                                        0, 0,
+                                        cairo_image_surface_get_width (surface),
+                                        cairo_image_surface_get_height (surface));
+  cairo_surface_destroy (surface);
+
+  return pixbuf;
+}
+
+
+static void
+save (ThumbnailData *data, GdkPixbuf *pixbuf, const char *path)
+{
+  g_autoptr (GError) err = NULL;
+  g_autofree char *dir = g_path_get_dirname (path);
+  g_autofree char *buf = NULL;
+  gsize len;
+
+  if (g_mkdir_with_parents (dir, 0700) < 0) {
+    g_warning ("Failed to create %s: %s", dir, g_strerror (errno));
+    return;
+  }
+
+  if (!gdk_pixbuf_save_to_buffer (pixbuf, &buf, &len, "png", &err,
+                                  "tEXt::Thumb::URI", data->uri,
+                                  "tEXt::Thumb::MTime", data->mtime,
+                                  "tEXt::Software", "Phosh",
+                                  NULL)) {
+    g_warning ("Failed to encode thumbnail for %s: %s", data->uri, err->message);
+    return;
+  }
+
+  /* Written atomically as required by the spec */
+  if (!g_file_set_contents_full (path, buf, len, G_FILE_SET_CONTENTS_CONSISTENT, 0600, &err))
+    g_warning ("Failed to save thumbnail for %s: %s", data->uri, err->message);
+}
+
+
+static void
+load_thumbnail_in_thread (GTask        *task,
+                          gpointer      source_object,
+                          gpointer      task_data,
+                          GCancellable *cancel)
+{
+  ThumbnailData *data = task_data;
+  g_autofree char *path = get_thumbnail_path (data->uri);
+  g_autoptr (GFileInfo) info = NULL;
+  GdkPixbuf *pixbuf;
+  GError *err = NULL;
+
+  /* The ticket's info might be from a saved list so check the file itself */
+  info = g_file_query_info (data->file, G_FILE_ATTRIBUTE_TIME_MODIFIED,
+                            G_FILE_QUERY_INFO_NONE, cancel, &err);
+  if (info == NULL) {
+    g_task_return_error (task, err);
+    return;
+  }
+  data->mtime = g_strdup_printf ("%" G_GUINT64_FORMAT,
+                                 g_file_info_get_attribute_uint64 (info,
+                                                                   G_FILE_ATTRIBUTE_TIME_MODIFIED));
+
+  pixbuf = load_cached (data, path);
+  if (pixbuf) {
+    g_task_return_pointer (task, pixbuf, g_object_unref);
+    return;
+  }
+
+  pixbuf = render (data, cancel, &err);
+  if (pixbuf == NULL) {
+    g_task_return_error (task, err);
+    return;
+  }
+
+  save (data, pixbuf, path);
+  g_task_return_pointer (task, pixbuf, g_object_unref);
+}
+
+
+/**
+ * phosh_ticket_thumbnail_load_async:
+ * @ticket: The ticket
+ * @cancel: A cancellable
+ * @callback: The callback
+ * @user_data: The callback's user data
+ *
+ * Renders the first page of a ticket in a worker thread. Renders are
+ * cached as per the freedesktop.org thumbnail spec keyed by the
+ * ticket's modification time so they're instant once a ticket was
+ * rendered.
+ */
+void
+phosh_ticket_thumbnail_load_async (PhoshTicket         *ticket,
+                                   GCancellable        *cancel,
+                                   GAsyncReadyCallback  callback,
+                                   gpointer             user_data)
+{
+  g_autoptr (GTask) task = NULL;
+  ThumbnailData *data;
+
+  g_return_if_fail (PHOSH_IS_TICKET (ticket));
+
+  data = g_new0 (ThumbnailData, 1);
+  data->file = g_object_ref (phosh_ticket_get_file (ticket));
+  data->uri = g_file_get_uri (data->file);
+
+  task = g_task_new (ticket, cancel, callback, user_data);
+  g_task_set_source_tag (task, phosh_ticket_thumbnail_load_async);
+  g_task_set_task_data (task, data, (GDestroyNotify) thumbnail_data_free);
+  g_task_run_in_thread (task, load_thumbnail_in_thread);
+}
+
+/**
+ * phosh_ticket_thumbnail_load_finish:
+ * @res: The result
+ * @error: The error
+ *
+ * Finish an async thumbnail load.
+ *
+ * Returns:(transfer full): The render of the ticket's first page
+ */
+GdkPixbuf *
+phosh_ticket_thumbnail_load_finish (GAsyncResult *res, GError **error)
+{
+  g_return_val_if_fail (g_task_is_valid (res, NULL), NULL);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (res)) == phosh_ticket_thumbnail_load_async,
+                        NULL);
+
+  return g_task_propagate_pointer (G_TASK (res), error);
+}
@@ -0,0 +1,22 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include "ticket.h"
+
+#include <gdk-pixbuf/gdk-pixbuf.h>
+
+G_BEGIN_DECLS
+
+void       phosh_ticket_thumbnail_load_async  (PhoshTicket         *ticket,
+                                               GCancellable        *cancel,
+                                               GAsyncReadyCallback  callback,
+                                               gpointer             user_data);
+GdkPixbuf *phosh_ticket_thumbnail_load_finish (GAsyncResult        *res,
+                                               GError             **error);
+
+G_END_DECLS
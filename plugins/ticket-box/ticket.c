@@ -12,6 +12,7 @@ enum {
   PROP_0,
   PROP_FILE,
   PROP_INFO,
+  PROP_THUMBNAIL,
   PROP_LAST_PROP
 };
 static GParamSpec *props[PROP_LAST_PROP];
@@ -21,6 +22,7 @@ struct _PhoshTicket {
 
   GFile     *file;
   GFileInfo *info;
+  GdkPixbuf *thumbnail;
 };
 G_DEFINE_TYPE (PhoshTicket, phosh_ticket, G_TYPE_OBJECT)
 
@@ -40,6 +42,9 @@ phosh_ticket_set_property (GObject      *object,
   case PROP_INFO:
     self->info = g_value_dup_object (value);
     break;
+  case PROP_THUMBNAIL:
+    phosh_ticket_set_thumbnail (self, g_value_get_object (value));
+    break;
   default:
     G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     break;
@@ -62,6 +67,9 @@ phosh_ticket_get_property (GObject    *object,
   case PROP_INFO:
     g_value_set_object (value, self->info);
     break;
+  case PROP_THUMBNAIL:
+    g_value_set_object (value, self->thumbnail);
+    break;
   default:
     G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     break;
@@ -76,6 +84,7 @@ phosh_ticket_finalize (GObject *object)
 
   g_clear_object (&self->file);
   g_clear_object (&self->info);
+  g_clear_object (&self->thumbnail);
 
   G_OBJECT_CLASS (phosh_ticket_parent_class)->finalize (object);
 }
@@ -100,6 +109,16 @@ phosh_ticket_class_init (PhoshTicketClass *klass)
                          G_TYPE_FILE_INFO,
                          G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
 
+  /**
+   * PhoshTicket:thumbnail:
+   *
+   * A render of the ticket's first page, if available.
+   */
+  props[PROP_THUMBNAIL] =
+    g_param_spec_object ("thumbnail", "", "",
+                         GDK_TYPE_PIXBUF,
+                         G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
+
   g_object_class_install_properties (object_class, PROP_LAST_PROP, props);
 }
 
@@ -153,3 +172,25 @@ phosh_ticket_get_mod_time (PhoshTicket *self)
 
   return g_file_info_get_modification_date_time (self->info);
 }
+
+
+GdkPixbuf *
+phosh_ticket_get_thumbnail (PhoshTicket *self)
+{
+  g_return_val_if_fail (PHOSH_IS_TICKET (self), NULL);
+
+  return self->thumbnail;
+}
+
+
+void
+phosh_ticket_set_thumbnail (PhoshTicket *self, GdkPixbuf *thumbnail)
+{
+  g_return_if_fail (PHOSH_IS_TICKET (self));
+  g_return_if_fail (GDK_IS_PIXBUF (thumbnail) || thumbnail == NULL);
+
+  if (!g_set_object (&self->thumbnail, thumbnail))
+    return;
+
+  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_THUMBNAIL]);
+}
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <gio/gio.h>
+#include <gdk-pixbuf/gdk-pixbuf.h>
 
 G_BEGIN_DECLS
 
@@ -19,5 +20,7 @@ GFile             *phosh_ticket_get_file (PhoshTicket *self);
 const char        *phosh_ticket_get_display_name (PhoshTicket *self);
 GIcon             *phosh_ticket_get_icon (PhoshTicket *self);
 GDateTime         *phosh_ticket_get_mod_time (PhoshTicket *self);
+GdkPixbuf         *phosh_ticket_get_thumbnail (PhoshTicket *self);
+void               phosh_ticket_set_thumbnail (PhoshTicket *self, GdkPixbuf *thumbnail);
 
 G_END_DECLS
@@ -0,0 +1,421 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "phosh-config.h"
+
+#include "calendar-event.h"
+#include "event-index.h"
+
+/**
+ * PhoshEventIndex:
+ *
+ * Buckets the `PhoshCalendarEvent`s of a `GListModel` by the days
+ * (relative to `today`) they happen on. The local day span of each
+ * event is computed once when it's added or changed so that each day
+ * can be shown by binding a list directly to its bucket. Adding,
+ * removing or changing a single event only touches the buckets of the
+ * days it spans.
+ */
+
+enum {
+  PROP_0,
+  PROP_MODEL,
+  PROP_LAST_PROP
+};
+static GParamSpec *props[PROP_LAST_PROP];
+
+typedef struct {
+  PhoshCalendarEvent *event;
+  /* Day offsets relative to today */
+  int                 first_day;
+  int                 last_day;
+} PhoshEventIndexEntry;
+
+struct _PhoshEventIndex {
+  GObject     parent;
+
+  GListModel *model;
+  /* Mirrors the model's order */
+  GPtrArray  *entries;
+  /* A GListStore per day */
+  GPtrArray  *buckets;
+
+  gboolean    have_today;
+  guint32     today;
+};
+G_DEFINE_TYPE (PhoshEventIndex, phosh_event_index, G_TYPE_OBJECT)
+
+
+static void
+entry_free (PhoshEventIndexEntry *entry)
+{
+  g_object_unref (entry->event);
+  g_free (entry);
+}
+
+
+static gint
+calendar_event_begin_compare (gconstpointer a,
+                              gconstpointer b,
+                              gpointer      user_data)
+{
+  PhoshCalendarEvent *ca = PHOSH_CALENDAR_EVENT ((gpointer)a);
+  PhoshCalendarEvent *cb = PHOSH_CALENDAR_EVENT ((gpointer)b);
+
+  return g_date_time_compare (phosh_calendar_event_get_begin (ca),
+                              phosh_calendar_event_get_begin (cb));
+}
+
+
+static guint32
+get_julian (GDateTime *dt)
+{
+  GDate date;
+  int year, month, day;
+
+  g_date_time_get_ymd (dt, &year, &month, &day);
+  g_date_clear (&date, 1);
+  g_date_set_dmy (&date, day, month, year);
+
+  return g_date_get_julian (&date);
+}
+
+
+static void
+compute_span (PhoshEventIndex *self, PhoshEventIndexEntry *entry)
+{
+  GDateTime *begin = phosh_calendar_event_get_begin (entry->event);
+  GDateTime *end = phosh_calendar_event_get_end (entry->event);
+  int begin_day, end_day;
+
+  begin_day = (gint64)get_julian (begin) - self->today;
+  end_day = (gint64)get_julian (end) - self->today;
+
+  /* Prevent multi day events to leak to the next day as they end at midnight */
+  if (end_day > begin_day &&
+      g_date_time_get_hour (end) == 0 &&
+      g_date_time_get_minute (end) == 0) {
+    end_day--;
+  }
+
+  entry->first_day = begin_day;
+  entry->last_day = MAX (begin_day, end_day);
+}
+
+
+static void
+add_to_buckets (PhoshEventIndex *self, PhoshEventIndexEntry *entry)
+{
+  int first = MAX (entry->first_day, 0);
+  int last = MIN (entry->last_day, (int)self->buckets->len - 1);
+
+  for (int day = first; day <= last; day++) {
+    g_list_store_insert_sorted (g_ptr_array_index (self->buckets, day),
+                                entry->event,
+                                calendar_event_begin_compare,
+                                NULL);
+  }
+}
+
+
+static void
+remove_from_buckets (PhoshEventIndex *self, PhoshEventIndexEntry *entry)
+{
+  int first = MAX (entry->first_day, 0);
+  int last = MIN (entry->last_day, (int)self->buckets->len - 1);
+
+  for (int day = first; day <= last; day++) {
+    GListStore *bucket = g_ptr_array_index (self->buckets, day);
+    guint pos;
+
+    if (g_list_store_find (bucket, entry->event, &pos))
+      g_list_store_remove (bucket, pos);
+  }
+}
+
+
+static void
+rebuild (PhoshEventIndex *self)
+{
+  g_autoptr (GPtrArray) days = g_ptr_array_new_with_free_func ((GDestroyNotify)g_ptr_array_unref);
+
+  for (guint i = 0; i < self->buckets->len; i++)
+    g_ptr_array_add (days, g_ptr_array_new ());
+
+  if (self->have_today) {
+    for (guint i = 0; i < self->entries->len; i++) {
+      PhoshEventIndexEntry *entry = g_ptr_array_index (self->entries, i);
+      int first, last;
+
+      compute_span (self, entry);
+      first = MAX (entry->first_day, 0);
+      last = MIN (entry->last_day, (int)self->buckets->len - 1);
+      for (int day = first; day <= last; day++)
+        g_ptr_array_add (g_ptr_array_index (days, day), entry->event);
+    }
+  }
+
+  /* Replace each bucket's content in one go */
+  for (guint i = 0; i < self->buckets->len; i++) {
+    GListStore *bucket = g_ptr_array_index (self->buckets, i);
+    GPtrArray *events = g_ptr_array_index (days, i);
+
+    g_ptr_array_sort_values_with_data (events, calendar_event_begin_compare, NULL);
+    g_list_store_splice (bucket,
+                         0,
+                         g_list_model_get_n_items (G_LIST_MODEL (bucket)),
+                         events->pdata,
+                         events->len);
+  }
+}
+
+
+static void
+on_event_span_changed (PhoshEventIndex *self, GParamSpec *pspec, PhoshCalendarEvent *event)
+{
+  PhoshEventIndexEntry *entry = NULL;
+
+  for (guint i = 0; i < self->entries->len; i++) {
+    PhoshEventIndexEntry *e = g_ptr_array_index (self->entries, i);
+
+    if (e->event == event) {
+      entry = e;
+      break;
+    }
+  }
+  g_return_if_fail (entry);
+
+  if (!self->have_today)
+    return;
+
+  remove_from_buckets (self, entry);
+  compute_span (self, entry);
+  add_to_buckets (self, entry);
+}
+
+
+static void
+on_items_changed (PhoshEventIndex *self,
+                  guint            position,
+                  guint            removed,
+                  guint            added,
+                  GListModel      *model)
+{
+  for (guint i = 0; i < removed; i++) {
+    PhoshEventIndexEntry *entry = g_ptr_array_index (self->entries, position + i);
+
+    g_signal_handlers_disconnect_by_data (entry->event, self);
+    if (self->have_today)
+      remove_from_buckets (self, entry);
+  }
+  g_ptr_array_remove_range (self->entries, position, removed);
+
+  for (guint i = 0; i < added; i++) {
+    PhoshEventIndexEntry *entry = g_new0 (PhoshEventIndexEntry, 1);
+
+    entry->event = g_list_model_get_item (model, position + i);
+    g_object_connect (entry->event,
+                      "swapped-object-signal::notify::begin", on_event_span_changed, self,
+                      "swapped-object-signal::notify::end", on_event_span_changed, self,
+                      NULL);
+    g_ptr_array_insert (self->entries, position + i, entry);
+
+    if (self->have_today) {
+      compute_span (self, entry);
+      add_to_buckets (self, entry);
+    }
+  }
+}
+
+
+static void
+phosh_event_index_set_model (PhoshEventIndex *self, GListModel *model)
+{
+  guint n_items;
+
+  self->model = g_object_ref (model);
+  g_signal_connect_object (self->model, "items-changed",
+                           G_CALLBACK (on_items_changed), self,
+                           G_CONNECT_SWAPPED);
+
+  n_items = g_list_model_get_n_items (self->model);
+  if (n_items)
+    on_items_changed (self, 0, 0, n_items, self->model);
+}
+
+
+static void
+phosh_event_index_set_property (GObject      *object,
+                                guint         property_id,
+                                const GValue *value,
+                                GParamSpec   *pspec)
+{
+  PhoshEventIndex *self = PHOSH_EVENT_INDEX (object);
+
+  switch (property_id) {
+  case PROP_MODEL:
+    phosh_event_index_set_model (self, g_value_get_object (value));
+    break;
+  default:
+    G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    break;
+  }
+}
+
+
+static void
+phosh_event_index_get_property (GObject    *object,
+                                guint       property_id,
+                                GValue     *value,
+                                GParamSpec *pspec)
+{
+  PhoshEventIndex *self = PHOSH_EVENT_INDEX (object);
+
+  switch (property_id) {
+  case PROP_MODEL:
+    g_value_set_object (value, self->model);
+    break;
+  default:
+    G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    break;
+  }
+}
+
+
+static void
+phosh_event_index_dispose (GObject *object)
+{
+  PhoshEventIndex *self = PHOSH_EVENT_INDEX (object);
+
+  for (guint i = 0; i < self->entries->len; i++) {
+    PhoshEventIndexEntry *entry = g_ptr_array_index (self->entries, i);
+
+    g_signal_handlers_disconnect_by_data (entry->event, self);
+  }
+  g_ptr_array_set_size (self->entries, 0);
+
+  if (self->model)
+    g_signal_handlers_disconnect_by_data (self->model, self);
+  g_clear_object (&self->model);
+
+  G_OBJECT_CLASS (phosh_event_index_parent_class)->dispose (object);
+}
+
+
+static void
+phosh_event_index_finalize (GObject *object)
+{
+  PhoshEventIndex *self = PHOSH_EVENT_INDEX (object);
+
+  g_clear_pointer (&self->entries, g_ptr_array_unref);
+  g_clear_pointer (&self->buckets, g_ptr_array_unref);
+
+  G_OBJECT_CLASS (phosh_event_index_parent_class)->finalize (object);
+}
+
+
+static void
+phosh_event_index_class_init (PhoshEventIndexClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->get_property = phosh_event_index_get_property;
+  object_class->set_property = phosh_event_index_set_property;
+  object_class->dispose = phosh_event_index_dispose;
+  object_class->finalize = phosh_event_index_finalize;
+
+  /**
+   * PhoshEventIndex:model:
+   *
+   * The model of `PhoshCalendarEvent`s to index
+   */
+  props[PROP_MODEL] =
+    g_param_spec_object ("model", "", "",
+                         G_TYPE_LIST_MODEL,
+                         G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties (object_class, PROP_LAST_PROP, props);
+}
+
+
+static void
+phosh_event_index_init (PhoshEventIndex *self)
+{
+  self->entries = g_ptr_array_new_with_free_func ((GDestroyNotify)entry_free);
+  self->buckets = g_ptr_array_new_with_free_func (g_object_unref);
+}
+
+
+PhoshEventIndex *
+phosh_event_index_new (GListModel *events)
+{
+  return g_object_new (PHOSH_TYPE_EVENT_INDEX, "model", events, NULL);
+}
+
+/**
+ * phosh_event_index_set_today:
+ * @self: The event index
+ * @today: The reference date
+ *
+ * Sets the date the day offsets are relative to. As this changes
+ * every event's day span all the buckets are rebuilt. Use this on day
+ * and timezone changes.
+ */
+void
+phosh_event_index_set_today (PhoshEventIndex *self, GDateTime *today)
+{
+  g_return_if_fail (PHOSH_IS_EVENT_INDEX (self));
+  g_return_if_fail (today != NULL);
+
+  self->today = get_julian (today);
+  self->have_today = TRUE;
+
+  rebuild (self);
+}
+
+/**
+ * phosh_event_index_set_n_days:
+ * @self: The event index
+ * @n_days: The number of days to bucket events for
+ *
+ * Sets the number of days starting at today that events are
+ * bucketed for.
+ */
+void
+phosh_event_index_set_n_days (PhoshEventIndex *self, guint n_days)
+{
+  g_return_if_fail (PHOSH_IS_EVENT_INDEX (self));
+
+  if (n_days == self->buckets->len)
+    return;
+
+  /* Keep existing buckets so lists bound to them stay valid */
+  if (n_days < self->buckets->len)
+    g_ptr_array_set_size (self->buckets, n_days);
+
+  while (self->buckets->len < n_days)
+    g_ptr_array_add (self->buckets, g_list_store_new (PHOSH_TYPE_CALENDAR_EVENT));
+
+  rebuild (self);
+}
+
+/**
+ * phosh_event_index_get_day:
+ * @self: The event index
+ * @day_offset: The offset in days from today
+ *
+ * Gets the events happening on the given day sorted by their begin.
+ *
+ * Returns:(transfer none): The events
+ */
+GListModel *
+phosh_event_index_get_day (PhoshEventIndex *self, guint day_offset)
+{
+  g_return_val_if_fail (PHOSH_IS_EVENT_INDEX (self), NULL);
+  g_return_val_if_fail (day_offset < self->buckets->len, NULL);
+
+  return G_LIST_MODEL (g_ptr_array_index (self->buckets, day_offset));
+}
@@ -0,0 +1,22 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+#define PHOSH_TYPE_EVENT_INDEX (phosh_event_index_get_type ())
+
+G_DECLARE_FINAL_TYPE (PhoshEventIndex, phosh_event_index, PHOSH, EVENT_INDEX, GObject)
+
+PhoshEventIndex *phosh_event_index_new        (GListModel      *events);
+void             phosh_event_index_set_today  (PhoshEventIndex *self, GDateTime *today);
+void             phosh_event_index_set_n_days (PhoshEventIndex *self, guint n_days);
+GListModel      *phosh_event_index_get_day    (PhoshEventIndex *self, guint day_offset);
+
+G_END_DECLS
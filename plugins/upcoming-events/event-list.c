@@ -10,7 +10,6 @@
 
 #include "calendar-event.h"
 #include "event-list.h"
-#include "gtkfilterlistmodel.h"
 #include "upcoming-event.h"
 
 #include <glib/gi18n.h>
@@ -29,12 +28,9 @@ static GParamSpec *props[PROP_LAST_PROP];
 /**
  * PhoshEventList:
  *
- * A widget that shows a list of events extracted from
- * `GListModel` of `PhoshCalendarEvents` that are valid
- * on `for_day`.
- *
- * TODO: we currently only support a single day but could
- * handle any time range rather by looking at time offsets.
+ * A widget that shows a `GListModel` of `PhoshCalendarEvents`
+ * that are valid on `for_day`. See `PhoshEventIndex` for a
+ * way to get such a model per day.
  */
 struct _PhoshEventList {
   GtkBox              parent;
@@ -43,7 +39,6 @@ struct _PhoshEventList {
   GtkLabel           *label;
 
   GListModel         *model;
-  GtkFilterListModel *filtered_model;
   GtkStack           *stack_events;
 
   GDateTime          *today;
@@ -58,7 +53,7 @@ on_items_changed (PhoshEventList *self)
 {
   const char *page = "no-events";
 
-  if (self->filtered_model && g_list_model_get_n_items (G_LIST_MODEL (self->filtered_model)))
+  if (self->model && g_list_model_get_n_items (self->model))
     page = "events";
 
   gtk_stack_set_visible_child_name (self->stack_events, page);
@@ -88,52 +83,6 @@ create_upcoming_event_row (gpointer item, gpointer user_data)
 }
 
 
-static gboolean
-filter_day (gpointer item, gpointer data)
-{
-  int begin_day_diff, end_day_diff;
-  PhoshCalendarEvent *event = PHOSH_CALENDAR_EVENT (item);
-  PhoshEventList *self = PHOSH_EVENT_LIST (data);
-  GDateTime *begin = phosh_calendar_event_get_begin (event);
-  GDateTime *end = phosh_calendar_event_get_end (event);
-  g_autoptr (GDate) today = NULL;
-  g_autoptr (GDate) begin_date = NULL;
-  g_autoptr (GDate) end_date = NULL;
-
-  today = g_date_new_dmy (g_date_time_get_day_of_month (self->today),
-                          g_date_time_get_month (self->today),
-                          g_date_time_get_year (self->today));
-  begin_date = g_date_new_dmy (g_date_time_get_day_of_month (begin),
-                               g_date_time_get_month (begin),
-                               g_date_time_get_year (begin));
-  end_date = g_date_new_dmy (g_date_time_get_day_of_month (end),
-                             g_date_time_get_month (end),
-                             g_date_time_get_year (end));
-
-  begin_day_diff = g_date_days_between (today, begin_date);
-  end_day_diff = g_date_days_between (today, end_date);
-
-  /* Include events that start at the event-lists day */
-  if (begin_day_diff == self->day_offset)
-    return TRUE;
-
-  /* Include events that started before the event-lists day but are
-     ongoing at the lists day … */
-  if (begin_day_diff < self->day_offset && end_day_diff >= self->day_offset) {
-    /* …but prevent multi day events to leak to the next day as they end at midnight */
-    if (end_day_diff == self->day_offset &&
-        g_date_time_get_hour (end) == 0 &&
-        g_date_time_get_minute (end) == 0) {
-      return FALSE;
-    } else {
-      return TRUE;
-    }
-  }
-
-  return FALSE;
-}
-
-
 static char *
 get_label (PhoshEventList *self)
 {
@@ -165,9 +114,6 @@ phosh_event_list_set_day_offset (PhoshEventList *self, guint offset)
 
   str = get_label (self);
   gtk_label_set_label (self->label, str);
-
-  if (self->filtered_model)
-    gtk_filter_list_model_refilter (self->filtered_model);
 }
 
 
@@ -291,8 +237,7 @@ phosh_event_list_class_init (PhoshEventListClass *klass)
   /**
    * PhoshEventList:model:
    *
-   *
-   * The model to extract the calendar events from.
+   * The calendar events happening on the lists day.
    */
   props[PROP_MODEL] =
     g_param_spec_object ("model", "", "",
@@ -331,22 +276,17 @@ phosh_event_list_bind_model (PhoshEventList *self, GListModel *model)
   if (self->model == model)
     return;
 
+  if (self->model)
+    g_signal_handlers_disconnect_by_data (self->model, self);
   g_set_object (&self->model, model);
-  if (self->filtered_model)
-    g_signal_handlers_disconnect_by_data (self->filtered_model, self);
-  g_clear_object (&self->filtered_model);
 
   if (self->model) {
-    self->filtered_model = gtk_filter_list_model_new (self->model,
-                                                      filter_day,
-                                                      self,
-                                                      NULL);
     gtk_list_box_bind_model (self->lb_events,
-                             G_LIST_MODEL (self->filtered_model),
+                             self->model,
                              create_upcoming_event_row,
                              self, NULL);
 
-    g_signal_connect_swapped (self->filtered_model,
+    g_signal_connect_swapped (self->model,
                               "items-changed",
                               G_CALLBACK (on_items_changed),
                               self);
@@ -371,7 +311,7 @@ phosh_event_list_set_today (PhoshEventList *self, GDateTime *today)
     return;
 
   self->today = g_date_time_ref (today);
-  /* Refresh label and events */
+  /* Refresh label */
   phosh_event_list_set_day_offset (self, self->day_offset);
 }
 
@@ -381,5 +321,8 @@ phosh_event_list_get_n_events (PhoshEventList *self)
 {
   g_return_val_if_fail (PHOSH_IS_EVENT_LIST (self), 0);
 
-  return g_list_model_get_n_items (G_LIST_MODEL (self->filtered_model));
+  if (self->model == NULL)
+    return 0;
+
+  return g_list_model_get_n_items (self->model);
 }
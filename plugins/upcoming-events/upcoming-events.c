@@ -8,6 +8,7 @@
 
 #include "phosh-config.h"
 
+#include "event-index.h"
 #include "event-list.h"
 #include "calendar-event.h"
 #include "upcoming-events.h"
@@ -42,6 +43,7 @@ struct _PhoshUpcomingEvents {
   GListModel                    *event_lists;
   GtkFilterListModel            *event_lists_filtered;
   GListStore                    *events;
+  PhoshEventIndex               *event_index;
   GHashTable                    *event_ids;
   GDateTime                     *since;
   guint                          num_days;
@@ -65,6 +67,7 @@ phosh_upcoming_events_finalize (GObject *object)
   g_clear_handle_id (&self->today_changed_timeout_id, g_source_remove);
   g_cancellable_cancel (self->cancel);
   g_clear_object (&self->cancel);
+  g_clear_object (&self->event_index);
   g_clear_object (&self->events);
   g_clear_object (&self->settings);
   g_clear_object (&self->tz_monitor);
@@ -182,7 +185,6 @@ on_events_added_or_updated (PhoshUpcomingEvents *self, GVariant *events)
   gint64 begin, end;
   const char *id, *summary;
   GVariant *extra_dict;
-  gboolean changed = FALSE;
 
   g_variant_iter_init (&iter, events);
   while (g_variant_iter_next (&iter, EVENT_FORMAT, &id, &summary, &begin, &end, &extra_dict)) {
@@ -201,7 +203,6 @@ on_events_added_or_updated (PhoshUpcomingEvents *self, GVariant *events)
                     "end", g_date_time_new_from_unix_local (end),
                     "color", color,
                     NULL);
-      changed = TRUE;
       continue;
     }
 
@@ -217,17 +218,8 @@ on_events_added_or_updated (PhoshUpcomingEvents *self, GVariant *events)
                                 NULL);
   }
 
+  /* The event index moved changed events to their new days already */
   refilter_event_lists (self);
-
-  if (changed == FALSE)
-    return;
-
-  /* Changed events might be tz change so refilter days */
-  for (int i = 0; i < g_list_model_get_n_items (self->event_lists); i++) {
-    g_autoptr (PhoshEventList) el = g_list_model_get_item (self->event_lists, i);
-
-    phosh_event_list_set_today (el, self->since);
-  }
 }
 
 #undef EVENT_FORMAT
@@ -273,6 +265,10 @@ update_calendar (PhoshUpcomingEvents *self, gboolean force_reload)
 
   load_events (self, force_reload);
 
+  /* Day or timezone changed so recompute the events' days */
+  phosh_event_index_set_today (self->event_index, self->since);
+  refilter_event_lists (self);
+
   for (int i = 0; i < g_list_model_get_n_items (self->event_lists); i++) {
     g_autoptr (PhoshEventList) el = g_list_model_get_item (self->event_lists, i);
 
@@ -389,7 +385,7 @@ create_event_list_func (gpointer item, gpointer user_data)
   el = g_object_new (PHOSH_TYPE_EVENT_LIST,
                      "day-offset", day_offset,
                      "today", self->since,
-                     "model", self->events,
+                     "model", phosh_event_index_get_day (self->event_index, day_offset),
                      "visible", TRUE,
                      NULL);
 
@@ -414,12 +410,14 @@ on_num_days_changed (PhoshUpcomingEvents *self)
   g_debug ("Number of days changed to %u; reconfiguring event lists", self->num_days);
 
   g_list_store_remove_all (G_LIST_STORE (self->event_lists));
+  phosh_event_index_set_n_days (self->event_index, self->num_days);
 
   for (int i = 0; i < self->num_days; i++) {
     GtkWidget *event_list = g_object_new (PHOSH_TYPE_EVENT_LIST,
                                           "day-offset", i,
                                           "today", self->since,
-                                          "model", self->events,
+                                          "model",
+                                          phosh_event_index_get_day (self->event_index, i),
                                           "visible", TRUE,
                                           NULL);
 
@@ -495,6 +493,7 @@ phosh_upcoming_events_init (PhoshUpcomingEvents *self)
                                                           self,
                                                           NULL);
   self->events = g_list_store_new (PHOSH_TYPE_CALENDAR_EVENT);
+  self->event_index = phosh_event_index_new (G_LIST_MODEL (self->events));
 
   self->event_ids = g_hash_table_new_full (g_str_hash,
                                            g_str_equal,
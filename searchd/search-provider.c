@@ -19,6 +19,9 @@
 #include "search-result-meta.h"
 #include "gnome-shell-search-provider.h"
 
+/* Number of result metas to keep per provider */
+#define META_CACHE_SIZE 100
+
 /**
  * PhoshSearchProvider:
  *
@@ -42,6 +45,14 @@ struct _PhoshSearchProviderPrivate {
   char                     *bus_path;
   gboolean                  autostart;
   gboolean                  default_disabled;
+  gboolean                  creating_proxy;
+  /* Monotonic time of the last request, 0 if never used */
+  gint64                    last_used;
+
+  /* Most recently used result metas first */
+  GQueue                    meta_lru;
+  /* key: result id, value: link in meta_lru */
+  GHashTable               *meta_cache;
 };
 
 G_DEFINE_TYPE_WITH_PRIVATE (PhoshSearchProvider, phosh_search_provider, G_TYPE_OBJECT)
@@ -72,10 +83,12 @@ got_proxy (GObject *source_object, GAsyncResult *res, gpointer user_data)
   PhoshSearchProviderPrivate *priv = phosh_search_provider_get_instance_private (self);
   g_autoptr (GError) error = NULL;
 
+  priv->creating_proxy = FALSE;
   priv->proxy = phosh_dbus_search_provider2_proxy_new_for_bus_finish (res, &error);
 
   if (!priv->proxy) {
-    g_warning ("[%s]: Unable to create proxy: %s", priv->bus_path, error->message);
+    if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+      g_warning ("[%s]: Unable to create proxy: %s", priv->bus_path, error->message);
     return;
   }
 
@@ -86,13 +99,11 @@ got_proxy (GObject *source_object, GAsyncResult *res, gpointer user_data)
 
 
 static void
-phosh_search_provider_constructed (GObject *object)
+create_proxy (PhoshSearchProvider *self)
 {
-  PhoshSearchProvider *self = PHOSH_SEARCH_PROVIDER (object);
   PhoshSearchProviderPrivate *priv = phosh_search_provider_get_instance_private (self);
 
-  G_OBJECT_CLASS (phosh_search_provider_parent_class)->constructed (object);
-
+  priv->creating_proxy = TRUE;
   phosh_dbus_search_provider2_proxy_new_for_bus (G_BUS_TYPE_SESSION,
                                                  priv->proxy_flags,
                                                  priv->bus_name,
@@ -103,6 +114,17 @@ phosh_search_provider_constructed (GObject *object)
 }
 
 
+static void
+phosh_search_provider_constructed (GObject *object)
+{
+  PhoshSearchProvider *self = PHOSH_SEARCH_PROVIDER (object);
+
+  G_OBJECT_CLASS (phosh_search_provider_parent_class)->constructed (object);
+
+  create_proxy (self);
+}
+
+
 static void
 phosh_search_provider_finalize (GObject *object)
 {
@@ -122,6 +144,9 @@ phosh_search_provider_finalize (GObject *object)
   g_clear_pointer (&priv->bus_name, g_free);
   g_clear_pointer (&priv->bus_path, g_free);
 
+  g_clear_pointer (&priv->meta_cache, g_hash_table_destroy);
+  g_queue_clear_full (&priv->meta_lru, (GDestroyNotify) phosh_search_result_meta_unref);
+
   G_OBJECT_CLASS (phosh_search_provider_parent_class)->finalize (object);
 }
 
@@ -129,13 +154,7 @@ phosh_search_provider_finalize (GObject *object)
 static void
 parent_canceled (GCancellable *cancellable, PhoshSearchProvider *self)
 {
-  PhoshSearchProviderPrivate *priv = phosh_search_provider_get_instance_private (self);
-
-  g_debug ("Provider %s cancelling", priv->bus_name);
-
-  g_cancellable_cancel (priv->cancellable);
-  g_clear_object (&priv->cancellable);
-  priv->cancellable = g_cancellable_new ();
+  phosh_search_provider_cancel (self);
 }
 
 
@@ -299,6 +318,9 @@ phosh_search_provider_init (PhoshSearchProvider *self)
   priv->cancellable = g_cancellable_new ();
   priv->proxy_flags = G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES;
   priv->autostart = TRUE;
+
+  g_queue_init (&priv->meta_lru);
+  priv->meta_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 }
 
 
@@ -380,6 +402,7 @@ phosh_search_provider_activate_result (PhoshSearchProvider *self,
 {
   PhoshSearchProviderPrivate *priv = phosh_search_provider_get_instance_private (self);
 
+  priv->last_used = g_get_monotonic_time ();
   phosh_dbus_search_provider2_call_activate_result (priv->proxy,
                                                     result,
                                                     terms,
@@ -412,6 +435,7 @@ phosh_search_provider_launch_search (PhoshSearchProvider *self,
 {
   PhoshSearchProviderPrivate *priv = phosh_search_provider_get_instance_private (self);
 
+  priv->last_used = g_get_monotonic_time ();
   phosh_dbus_search_provider2_call_launch_search (PHOSH_DBUS_SEARCH_PROVIDER2 (priv->proxy),
                                                   terms,
                                                   timestamp,
@@ -462,6 +486,63 @@ get_result_icon (PhoshSearchProvider *self, GVariantDict *result_meta)
 }
 
 
+static PhoshSearchResultMeta *
+meta_cache_lookup (PhoshSearchProvider *self, const char *id)
+{
+  PhoshSearchProviderPrivate *priv = phosh_search_provider_get_instance_private (self);
+  GList *link = g_hash_table_lookup (priv->meta_cache, id);
+
+  if (link == NULL)
+    return NULL;
+
+  g_queue_unlink (&priv->meta_lru, link);
+  g_queue_push_head_link (&priv->meta_lru, link);
+
+  return link->data;
+}
+
+
+static void
+meta_cache_insert (PhoshSearchProvider *self, PhoshSearchResultMeta *meta)
+{
+  PhoshSearchProviderPrivate *priv = phosh_search_provider_get_instance_private (self);
+  const char *id = phosh_search_result_meta_get_id (meta);
+  GList *link = g_hash_table_lookup (priv->meta_cache, id);
+
+  if (link) {
+    phosh_search_result_meta_unref (link->data);
+    g_queue_delete_link (&priv->meta_lru, link);
+  }
+
+  g_queue_push_head (&priv->meta_lru, phosh_search_result_meta_ref (meta));
+  g_hash_table_insert (priv->meta_cache, g_strdup (id), priv->meta_lru.head);
+
+  while (priv->meta_lru.length > META_CACHE_SIZE) {
+    PhoshSearchResultMeta *oldest = g_queue_pop_tail (&priv->meta_lru);
+
+    g_hash_table_remove (priv->meta_cache, phosh_search_result_meta_get_id (oldest));
+    phosh_search_result_meta_unref (oldest);
+  }
+}
+
+/* Metas for the requested ids in order, skipping ids we have none for */
+static GPtrArray *
+collect_result_metas (PhoshSearchProvider *self, const char *const *ids)
+{
+  GPtrArray *metas = g_ptr_array_new_full (g_strv_length ((GStrv) ids),
+                                           (GDestroyNotify) phosh_search_result_meta_unref);
+
+  for (int i = 0; ids[i]; i++) {
+    PhoshSearchResultMeta *meta = meta_cache_lookup (self, ids[i]);
+
+    if (meta)
+      g_ptr_array_add (metas, phosh_search_result_meta_ref (meta));
+  }
+
+  return metas;
+}
+
+
 static void
 got_result_meta (GObject *source, GAsyncResult *res, gpointer user_data)
 {
@@ -486,8 +567,6 @@ got_result_meta (GObject *source, GAsyncResult *res, gpointer user_data)
   if (!success)
     g_warning ("[%s]: Failed get result meta: %s", bus_path, error->message);
 
-  results = g_ptr_array_new_full (100, (GDestroyNotify) phosh_search_result_meta_unref);
-
 /*
  * Some providers decide to provide NULL instead of an empty array
  * thus we do what JS does and map NULL to an empty array
@@ -526,9 +605,11 @@ got_result_meta (GObject *source, GAsyncResult *res, gpointer user_data)
 
     meta = phosh_search_result_meta_new (id, name, desc, icon, clipboard);
 
-    g_ptr_array_add (results, meta);
+    meta_cache_insert (self, meta);
+    phosh_search_result_meta_unref (meta);
   }
 
+  results = collect_result_metas (self, g_task_get_task_data (task));
   g_task_return_pointer (task, g_ptr_array_ref (results), (GDestroyNotify) g_ptr_array_unref);
 }
 
@@ -540,14 +621,33 @@ phosh_search_provider_get_result_meta (PhoshSearchProvider *self,
                                        gpointer             callback_data)
 {
   PhoshSearchProviderPrivate *priv = phosh_search_provider_get_instance_private (self);
+  g_autoptr (GStrvBuilder) builder = g_strv_builder_new ();
+  g_auto (GStrv) missing = NULL;
   GTask *task;
 
   task = g_task_new (self, priv->cancellable, callback, callback_data);
 
   g_task_set_source_tag (task, phosh_search_provider_get_result_meta);
+  g_task_set_task_data (task, g_strdupv (results), (GDestroyNotify) g_strfreev);
+
+  /* When narrowing down a search most results are already known */
+  for (int i = 0; results[i]; i++) {
+    if (!g_hash_table_contains (priv->meta_cache, results[i]))
+      g_strv_builder_add (builder, results[i]);
+  }
+  missing = g_strv_builder_end (builder);
+
+  if (missing[0] == NULL) {
+    GPtrArray *metas = collect_result_metas (self, (const char * const *) results);
+
+    g_task_return_pointer (task, metas, (GDestroyNotify) g_ptr_array_unref);
+    g_object_unref (task);
+    return;
+  }
 
+  priv->last_used = g_get_monotonic_time ();
   phosh_dbus_search_provider2_call_get_result_metas (PHOSH_DBUS_SEARCH_PROVIDER2 (priv->proxy),
-                                                     (const char * const*) results,
+                                                     (const char * const*) missing,
                                                      priv->cancellable,
                                                      got_result_meta,
                                                      task);
@@ -604,6 +704,7 @@ phosh_search_provider_get_initial (PhoshSearchProvider *self,
   task = g_task_new (self, priv->cancellable, callback, callback_data);
   g_task_set_source_tag (task, phosh_search_provider_get_initial);
 
+  priv->last_used = g_get_monotonic_time ();
   phosh_dbus_search_provider2_call_get_initial_result_set (PHOSH_DBUS_SEARCH_PROVIDER2 (priv->proxy),
                                                            terms,
                                                            priv->cancellable,
@@ -637,6 +738,7 @@ phosh_search_provider_get_subsearch (PhoshSearchProvider *self,
   task = g_task_new (self, priv->cancellable, callback, callback_data);
   g_task_set_source_tag (task, phosh_search_provider_get_subsearch);
 
+  priv->last_used = g_get_monotonic_time ();
   phosh_dbus_search_provider2_call_get_subsearch_result_set (PHOSH_DBUS_SEARCH_PROVIDER2 (priv->proxy),
                                                              results,
                                                              terms,
@@ -682,3 +784,117 @@ phosh_search_provider_get_bus_path (PhoshSearchProvider  *self)
 
   return priv->bus_path;
 }
+
+
+/**
+ * phosh_search_provider_get_running:
+ * @self: The search provider
+ *
+ * Whether the provider's service is currently running. Querying a
+ * provider that isn't running might spawn it.
+ *
+ * Returns: %TRUE if the service is running
+ */
+gboolean
+phosh_search_provider_get_running (PhoshSearchProvider *self)
+{
+  PhoshSearchProviderPrivate *priv;
+  g_autofree char *owner = NULL;
+
+  g_return_val_if_fail (PHOSH_IS_SEARCH_PROVIDER (self), FALSE);
+
+  priv = phosh_search_provider_get_instance_private (self);
+
+  if (priv->proxy == NULL)
+    return FALSE;
+
+  owner = g_dbus_proxy_get_name_owner (G_DBUS_PROXY (priv->proxy));
+  return owner != NULL;
+}
+
+/**
+ * phosh_search_provider_get_last_used:
+ * @self: The search provider
+ *
+ * Get the monotonic time the provider was last sent a request.
+ *
+ * Returns: The monotonic time or `0` if the provider wasn't used yet
+ */
+gint64
+phosh_search_provider_get_last_used (PhoshSearchProvider *self)
+{
+  PhoshSearchProviderPrivate *priv;
+
+  g_return_val_if_fail (PHOSH_IS_SEARCH_PROVIDER (self), 0);
+
+  priv = phosh_search_provider_get_instance_private (self);
+
+  return priv->last_used;
+}
+
+/**
+ * phosh_search_provider_release:
+ * @self: The search provider
+ *
+ * Drop the D-Bus proxy of an unused provider. The provider isn't ready
+ * afterwards until [method@SearchProvider.ensure_ready] is invoked again.
+ */
+void
+phosh_search_provider_release (PhoshSearchProvider *self)
+{
+  PhoshSearchProviderPrivate *priv;
+
+  g_return_if_fail (PHOSH_IS_SEARCH_PROVIDER (self));
+
+  priv = phosh_search_provider_get_instance_private (self);
+
+  if (priv->proxy == NULL)
+    return;
+
+  g_debug ("[%s]: Releasing proxy", priv->bus_path);
+  g_clear_object (&priv->proxy);
+}
+
+/**
+ * phosh_search_provider_ensure_ready:
+ * @self: The search provider
+ *
+ * Recreate the D-Bus proxy of a released provider. The provider emits
+ * `ready` once done.
+ */
+void
+phosh_search_provider_ensure_ready (PhoshSearchProvider *self)
+{
+  PhoshSearchProviderPrivate *priv;
+
+  g_return_if_fail (PHOSH_IS_SEARCH_PROVIDER (self));
+
+  priv = phosh_search_provider_get_instance_private (self);
+
+  if (priv->proxy || priv->creating_proxy)
+    return;
+
+  create_proxy (self);
+}
+
+/**
+ * phosh_search_provider_cancel:
+ * @self: The search provider
+ *
+ * Cancel all in flight requests to the provider.
+ */
+void
+phosh_search_provider_cancel (PhoshSearchProvider *self)
+{
+  PhoshSearchProviderPrivate *priv;
+
+  g_return_if_fail (PHOSH_IS_SEARCH_PROVIDER (self));
+
+  priv = phosh_search_provider_get_instance_private (self);
+
+  g_debug ("Provider %s cancelling", priv->bus_name);
+
+  g_cancellable_cancel (priv->cancellable);
+  g_clear_object (&priv->cancellable);
+  priv->cancellable = g_cancellable_new ();
+}
@@ -60,5 +60,10 @@ GStrv                phosh_search_provider_get_subsearch_finish   (PhoshSearchPr
                                                                    GError              **error);
 gboolean             phosh_search_provider_get_ready              (PhoshSearchProvider  *self);
 const char          *phosh_search_provider_get_bus_path           (PhoshSearchProvider *self);
+gboolean             phosh_search_provider_get_running            (PhoshSearchProvider *self);
+gint64               phosh_search_provider_get_last_used          (PhoshSearchProvider *self);
+void                 phosh_search_provider_release                (PhoshSearchProvider *self);
+void                 phosh_search_provider_ensure_ready           (PhoshSearchProvider *self);
+void                 phosh_search_provider_cancel                 (PhoshSearchProvider *self);
 
 G_END_DECLS
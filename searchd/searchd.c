@@ -26,9 +26,20 @@
 
 #define GROUP_NAME "Shell Search Provider"
 #define SEARCH_PROVIDERS_SCHEMA "org.gnome.desktop.search-providers"
+#define SEARCH_SCHEMA "mobi.phosh.shell.search"
+#define SEARCH_KEY_PROVIDER_IDLE_TIMEOUT "provider-idle-timeout"
 
 #define LIMIT_RESULTS 5
 
+/* Time a provider has to deliver results before we stop waiting for it */
+#define PROVIDER_DEADLINE_MS 750
+/* Consecutive missed deadlines after which a provider is considered slow */
+#define PROVIDER_MAX_MISSED 3
+/* Providers used within this time are queried right away even when not running */
+#define PROVIDER_RECENTLY_USED (30 * 60 * G_USEC_PER_SEC)
+/* Seconds the user needs to stay on a query before we spawn providers for it */
+#define PROVIDER_ACTIVATE_DELAY 2
+
 /**
  * PhoshSearchApplication:
  *
@@ -43,6 +54,7 @@ struct _PhoshSearchApplicationPrivate {
   PhoshDBusSearch *object;
 
   GSettings *settings;
+  GSettings *search_settings;
 
   /* element-type: Phosh.SearchSource */
   GList        *sources;
@@ -60,6 +72,17 @@ struct _PhoshSearchApplicationPrivate {
 
   gulong        search_timeout;
   int           outstanding_searches;
+  /* Incremented on each search so late results can be detected */
+  guint         search_serial;
+  /* The client's id of the current query */
+  guint         generation;
+  /* key: char * (object path), value: consecutive missed deadlines */
+  GHashTable   *missed_deadlines;
+
+  /* Providers not queried yet as they'd need to be spawned */
+  GPtrArray    *deferred;
+  guint         activate_timeout;
+  guint         release_timeout;
 
   GRegex       *splitter;
 };
@@ -77,9 +100,15 @@ phosh_search_application_finalize (GObject *object)
 
   g_cancellable_cancel (priv->cancellable);
 
+  g_clear_handle_id (&priv->activate_timeout, g_source_remove);
+  g_clear_handle_id (&priv->release_timeout, g_source_remove);
+  g_clear_pointer (&priv->deferred, g_ptr_array_unref);
+
   g_clear_object (&priv->cancellable);
   g_clear_object (&priv->settings);
+  g_clear_object (&priv->search_settings);
   g_clear_pointer (&priv->last_results, g_hash_table_destroy);
+  g_clear_pointer (&priv->missed_deadlines, g_hash_table_destroy);
 
   g_clear_pointer (&priv->query, g_free);
   g_clear_pointer (&priv->query_parts, g_strfreev);
@@ -274,7 +303,10 @@ get_sources (PhoshDBusSearch *interface, GDBusMethodInvocation *invocation, gpoi
 
 
 static gboolean
-get_last_results (PhoshDBusSearch *interface, GDBusMethodInvocation *invocation, gpointer user_data)
+get_last_results (PhoshDBusSearch       *interface,
+                  GDBusMethodInvocation *invocation,
+                  guint                  generation,
+                  gpointer               user_data)
 {
   PhoshSearchApplication *self = PHOSH_SEARCH_APPLICATION (user_data);
   PhoshSearchApplicationPrivate *priv = phosh_search_application_get_instance_private (self);
@@ -284,6 +316,14 @@ get_last_results (PhoshDBusSearch *interface, GDBusMethodInvocation *invocation,
 
   g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{saa{sv}}"));
 
+  if (generation != 0 && generation != priv->generation) {
+    g_debug ("[GetLastResults] No results for generation %u", generation);
+    phosh_dbus_search_complete_get_last_results (interface,
+                                                 invocation,
+                                                 g_variant_builder_end (&builder));
+    return TRUE;
+  }
+
   g_hash_table_iter_init (&iter, priv->last_results);
   while (g_hash_table_iter_next (&iter, &key, &value)) {
     const char *source_id = key;
@@ -309,28 +349,40 @@ get_last_results (PhoshDBusSearch *interface, GDBusMethodInvocation *invocation,
 }
 
 
+struct GotMetasData {
+  PhoshSearchApplication *self;
+  guint                   serial;
+};
+
+
 static void
 got_metas (GObject *source, GAsyncResult *res, gpointer user_data)
 {
-  PhoshSearchApplication *self = PHOSH_SEARCH_APPLICATION (user_data);
+  g_autofree struct GotMetasData *data = user_data;
+  g_autoptr (PhoshSearchApplication) self = data->self;
   PhoshSearchApplicationPrivate *priv = phosh_search_application_get_instance_private (self);
   g_autoptr (GError) error = NULL;
   g_autoptr (GVariant) result = NULL;
+  g_autoptr (GPtrArray) metas = NULL;
   GVariantBuilder builder;
-  GPtrArray *metas;
   char *bus_path;
 
   metas = phosh_search_provider_get_result_meta_finish (PHOSH_SEARCH_PROVIDER (source),
                                                         res,
                                                         &error);
 
-  g_object_get (source, "bus-path", &bus_path, NULL);
-
   if (error) {
-    g_critical ("Failed to load results %s", error->message);
+    if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+      g_critical ("Failed to load results %s", error->message);
     return;
   }
 
+  /* Drop stale results right here rather than sending them to the client */
+  if (data->serial != priv->search_serial)
+    return;
+
+  g_object_get (source, "bus-path", &bus_path, NULL);
+
   g_variant_builder_init (&builder, G_VARIANT_TYPE ("aa{sv}"));
 
   for (int i = 0; i < metas->len; i++) {
@@ -340,7 +392,10 @@ got_metas (GObject *source, GAsyncResult *res, gpointer user_data)
 
   result = g_variant_builder_end (&builder);
 
-  phosh_dbus_search_emit_source_results_changed (priv->object, bus_path, g_variant_ref (result));
+  phosh_dbus_search_emit_source_results_changed (priv->object,
+                                                 bus_path,
+                                                 g_variant_ref (result),
+                                                 priv->generation);
 
   g_hash_table_insert (priv->last_results, bus_path, g_variant_ref (result));
 }
@@ -349,9 +404,113 @@ got_metas (GObject *source, GAsyncResult *res, gpointer user_data)
 struct GotResultsData {
   gboolean initial;
   PhoshSearchApplication *self;
+  char    *bus_path;
+  guint    serial;
+  /* Whether QueryFinished still waits for this provider */
+  gboolean counted;
+  guint    deadline_id;
 };
 
 
+static gboolean
+is_slow_provider (PhoshSearchApplication *self, const char *bus_path)
+{
+  PhoshSearchApplicationPrivate *priv = phosh_search_application_get_instance_private (self);
+  guint missed = GPOINTER_TO_UINT (g_hash_table_lookup (priv->missed_deadlines, bus_path));
+
+  return missed >= PROVIDER_MAX_MISSED;
+}
+
+
+static void
+update_slow_sources (PhoshSearchApplication *self)
+{
+  PhoshSearchApplicationPrivate *priv = phosh_search_application_get_instance_private (self);
+  g_autoptr (GStrvBuilder) builder = g_strv_builder_new ();
+  g_auto (GStrv) slow = NULL;
+  GHashTableIter iter;
+  gpointer key;
+
+  g_hash_table_iter_init (&iter, priv->missed_deadlines);
+  while (g_hash_table_iter_next (&iter, &key, NULL)) {
+    if (is_slow_provider (self, key))
+      g_strv_builder_add (builder, key);
+  }
+
+  slow = g_strv_builder_end (builder);
+  phosh_dbus_search_set_slow_sources (priv->object, (const char * const *) slow);
+}
+
+
+static void
+track_provider_deadline (PhoshSearchApplication *self, const char *bus_path, gboolean missed)
+{
+  PhoshSearchApplicationPrivate *priv = phosh_search_application_get_instance_private (self);
+  gboolean was_slow = is_slow_provider (self, bus_path);
+  guint n_missed = GPOINTER_TO_UINT (g_hash_table_lookup (priv->missed_deadlines, bus_path));
+
+  if (missed) {
+    g_hash_table_insert (priv->missed_deadlines, g_strdup (bus_path), GUINT_TO_POINTER (n_missed + 1));
+  } else {
+    g_hash_table_remove (priv->missed_deadlines, bus_path);
+  }
+
+  if (was_slow != is_slow_provider (self, bus_path)) {
+    g_debug ("[%s]: %s", bus_path, was_slow ? "Delivered in time again" : "Considered slow");
+    update_slow_sources (self);
+  }
+}
+
+
+static guint
+get_max_results (PhoshSearchApplication *self)
+{
+  PhoshSearchApplicationPrivate *priv = phosh_search_application_get_instance_private (self);
+  guint max_results = phosh_dbus_search_get_max_results (priv->object);
+
+  return max_results ?: LIMIT_RESULTS;
+}
+
+
+static void
+finish_search (struct GotResultsData *data)
+{
+  PhoshSearchApplicationPrivate *priv = phosh_search_application_get_instance_private (data->self);
+
+  if (!data->counted)
+    return;
+  data->counted = FALSE;
+
+  /* A newer search reset the counter */
+  if (data->serial != priv->search_serial)
+    return;
+
+  priv->outstanding_searches--;
+
+  /* If all searches are done, emit the signal */
+  if (priv->outstanding_searches == 0) {
+    g_debug ("Query finished: All outstanding searches completed.\n");
+    phosh_dbus_search_emit_query_finished (priv->object, priv->generation);
+  }
+}
+
+
+static gboolean
+on_provider_deadline (gpointer user_data)
+{
+  struct GotResultsData *data = user_data;
+
+  data->deadline_id = 0;
+  g_debug ("[%s]: Missed deadline of %dms", data->bus_path, PROVIDER_DEADLINE_MS);
+
+  track_provider_deadline (data->self, data->bus_path, TRUE);
+  /* Don't hold up QueryFinished, results are still reported when they arrive */
+  finish_search (data);
+
+  return G_SOURCE_REMOVE;
+}
+
+
 static void
 got_results (GObject *source, GAsyncResult *res, gpointer user_data)
 {
@@ -360,13 +519,11 @@ got_results (GObject *source, GAsyncResult *res, gpointer user_data)
   g_autoptr (GError) error = NULL;
   GStrv results = NULL;
   g_autoptr (GPtrArray) sub_res = NULL;
-  g_autofree char *bus_path = NULL;
+  const char *bus_path = data->bus_path;
   GStrv sub_res_strv = NULL;
 
   priv = phosh_search_application_get_instance_private (data->self);
 
-  g_object_get (source, "bus-path", &bus_path, NULL);
-
   if (data->initial) {
     results = phosh_search_provider_get_initial_finish (PHOSH_SEARCH_PROVIDER (source),
                                                         res,
@@ -377,10 +534,19 @@ got_results (GObject *source, GAsyncResult *res, gpointer user_data)
                                                           &error);
   }
 
+  if (data->deadline_id && !g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    track_provider_deadline (data->self, bus_path, FALSE);
+  g_clear_handle_id (&data->deadline_id, g_source_remove);
+
   if (error) {
-    g_warning ("[%s]: %s", bus_path, error->message);
+    if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+      g_warning ("[%s]: %s", bus_path, error->message);
+  } else if (data->serial != priv->search_serial) {
+    g_debug ("[%s]: Ignoring results of previous search", bus_path);
   } else if (results) {
-    sub_res = phosh_search_provider_limit_results (results, LIMIT_RESULTS);
+    struct GotMetasData *metas_data;
+
+    sub_res = phosh_search_provider_limit_results (results, get_max_results (data->self));
 
     sub_res_strv = g_new (char *, sub_res->len + 1);
 
@@ -389,21 +555,19 @@ got_results (GObject *source, GAsyncResult *res, gpointer user_data)
 
     sub_res_strv[sub_res->len] = NULL;
 
+    metas_data = g_new0 (struct GotMetasData, 1);
+    metas_data->self = g_object_ref (data->self);
+    metas_data->serial = data->serial;
     phosh_search_provider_get_result_meta (PHOSH_SEARCH_PROVIDER (source),
                                            sub_res_strv,
                                            got_metas,
-                                           data->self);
+                                           metas_data);
   }
 
-  priv->outstanding_searches--;
-
-  /* If all searches are done, emit the signal */
-  if (priv->outstanding_searches == 0) {
-    g_debug ("Query finished: All outstanding searches completed.\n");
-    phosh_dbus_search_emit_query_finished (priv->object);
-  }
+  finish_search (data);
 
   g_object_unref (data->self);
+  g_free (data->bus_path);
   g_free (data);
 }
 
@@ -434,6 +598,131 @@ extract_result_ids (GVariant *results_variant)
 }
 
 
+static void
+search_provider (PhoshSearchApplication *self, PhoshSearchProvider *provider, gboolean counted)
+{
+  PhoshSearchApplicationPrivate *priv = phosh_search_application_get_instance_private (self);
+  const char *bus_path = phosh_search_provider_get_bus_path (provider);
+  struct GotResultsData *data;
+
+  data = g_new0 (struct GotResultsData, 1);
+  data->self = g_object_ref (self);
+  data->bus_path = g_strdup (bus_path);
+  data->serial = priv->search_serial;
+  /* Don't wait for slow providers, they still stream their results */
+  data->counted = counted && !is_slow_provider (self, bus_path);
+  data->deadline_id = g_timeout_add (PROVIDER_DEADLINE_MS, on_provider_deadline, data);
+  g_source_set_name_by_id (data->deadline_id, "[phosh-searchd] provider deadline");
+
+  /* Increment counter for each provider that will be queried */
+  if (data->counted)
+    priv->outstanding_searches++;
+
+  if (priv->doing_subsearch && g_hash_table_contains (priv->last_results, bus_path)) {
+    GVariant *prev = g_hash_table_lookup (priv->last_results, bus_path);
+    g_auto (GStrv) prev_results = extract_result_ids (prev);
+
+    data->initial = FALSE;
+    phosh_search_provider_get_subsearch (provider,
+                                         (const char * const *) prev_results,
+                                         (const char * const *) priv->query_parts,
+                                         got_results,
+                                         data);
+  } else {
+    data->initial = TRUE;
+    phosh_search_provider_get_initial (provider,
+                                       (const char * const*) priv->query_parts,
+                                       got_results,
+                                       data);
+  }
+}
+
+/*
+ * Only query providers right away that won't need to be spawned or
+ * that the user needed recently. Spawning the others costs lots of
+ * memory and CPU so we only do that once the query settled.
+ */
+static gboolean
+should_activate_now (PhoshSearchProvider *provider)
+{
+  gint64 last_used;
+
+  if (phosh_search_provider_get_running (provider))
+    return TRUE;
+
+  last_used = phosh_search_provider_get_last_used (provider);
+  return last_used && g_get_monotonic_time () - last_used < PROVIDER_RECENTLY_USED;
+}
+
+
+static gboolean
+on_activate_timeout (gpointer user_data)
+{
+  PhoshSearchApplication *self = PHOSH_SEARCH_APPLICATION (user_data);
+  PhoshSearchApplicationPrivate *priv = phosh_search_application_get_instance_private (self);
+
+  priv->activate_timeout = 0;
+
+  if (priv->query_parts == NULL)
+    return G_SOURCE_REMOVE;
+
+  for (guint i = 0; i < priv->deferred->len; i++) {
+    PhoshSearchProvider *provider = g_ptr_array_index (priv->deferred, i);
+
+    if (!phosh_search_provider_get_ready (provider))
+      continue;
+
+    g_debug ("[%s]: Activating", phosh_search_provider_get_bus_path (provider));
+    /* QueryFinished went out already, results are streamed as they arrive */
+    search_provider (self, provider, FALSE);
+  }
+  g_ptr_array_set_size (priv->deferred, 0);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static gboolean
+on_release_timeout (gpointer user_data)
+{
+  PhoshSearchApplication *self = PHOSH_SEARCH_APPLICATION (user_data);
+  PhoshSearchApplicationPrivate *priv = phosh_search_application_get_instance_private (self);
+  guint timeout = g_settings_get_uint (priv->search_settings, SEARCH_KEY_PROVIDER_IDLE_TIMEOUT);
+  gint64 now = g_get_monotonic_time ();
+  GHashTableIter iter;
+  gpointer value;
+
+  priv->release_timeout = 0;
+
+  g_hash_table_iter_init (&iter, priv->providers);
+  while (g_hash_table_iter_next (&iter, NULL, &value)) {
+    PhoshSearchProvider *provider = PHOSH_SEARCH_PROVIDER (value);
+    gint64 last_used = phosh_search_provider_get_last_used (provider);
+
+    if (now - last_used >= (gint64) timeout * G_USEC_PER_SEC)
+      phosh_search_provider_release (provider);
+  }
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static void
+schedule_release (PhoshSearchApplication *self)
+{
+  PhoshSearchApplicationPrivate *priv = phosh_search_application_get_instance_private (self);
+  guint timeout = g_settings_get_uint (priv->search_settings, SEARCH_KEY_PROVIDER_IDLE_TIMEOUT);
+
+  g_clear_handle_id (&priv->release_timeout, g_source_remove);
+
+  if (timeout == 0)
+    return;
+
+  priv->release_timeout = g_timeout_add_seconds (timeout, on_release_timeout, self);
+  g_source_set_name_by_id (priv->release_timeout, "[phosh-searchd] release providers");
+}
+
+
 static void
 search (PhoshSearchApplication *self)
 {
@@ -441,46 +730,44 @@ search (PhoshSearchApplication *self)
   GHashTableIter iter;
   gpointer key, value;
 
+  /* Results of previous searches don't count anymore */
+  priv->search_serial++;
+  priv->outstanding_searches = 0;
+  g_ptr_array_set_size (priv->deferred, 0);
+  g_clear_handle_id (&priv->activate_timeout, g_source_remove);
+
   g_hash_table_iter_init (&iter, priv->providers);
   while (g_hash_table_iter_next (&iter, &key, &value)) {
     PhoshSearchProvider *provider = PHOSH_SEARCH_PROVIDER (value);
-    char *bus_path;
-    struct GotResultsData *data;
-
-    g_object_get (provider, "bus-path", &bus_path, NULL);
+    const char *bus_path = phosh_search_provider_get_bus_path (provider);
 
     if (!phosh_search_provider_get_ready (provider)) {
-      g_warning ("[%s]: not ready", bus_path);
+      g_debug ("[%s]: not ready", bus_path);
+      /* Released due to inactivity, try again once the proxy is back */
+      phosh_search_provider_ensure_ready (provider);
+      g_ptr_array_add (priv->deferred, g_object_ref (provider));
       continue;
     }
 
-    data = g_new (struct GotResultsData, 1);
-    data->self = g_object_ref (self);
-
-    /* Increment counter for each provider that will be queried */
-    priv->outstanding_searches++;
-
-    if (priv->doing_subsearch && g_hash_table_contains (priv->last_results, bus_path)) {
-      GVariant *prev = g_hash_table_lookup (priv->last_results, bus_path);
-      g_auto (GStrv) prev_results = extract_result_ids (prev);
-
-      data->initial = FALSE;
-      phosh_search_provider_get_subsearch (provider,
-                                           (const char * const *) prev_results,
-                                           (const char * const *) priv->query_parts,
-                                           got_results,
-                                           data);
-    } else {
-      data->initial = TRUE;
-      phosh_search_provider_get_initial (provider,
-                                         (const char * const*) priv->query_parts,
-                                         got_results,
-                                         data);
+    if (!should_activate_now (provider)) {
+      g_ptr_array_add (priv->deferred, g_object_ref (provider));
+      continue;
     }
+
+    search_provider (self, provider, TRUE);
   }
 
   g_hash_table_remove_all (priv->last_results);
 
+  if (priv->deferred->len) {
+    priv->activate_timeout = g_timeout_add_seconds (PROVIDER_ACTIVATE_DELAY,
+                                                    on_activate_timeout,
+                                                    self);
+    g_source_set_name_by_id (priv->activate_timeout, "[phosh-searchd] activate providers");
+  }
+
+  schedule_release (self);
+
   if (priv->search_timeout != 0) {
     g_source_remove (priv->search_timeout);
     priv->search_timeout = 0;
@@ -500,16 +787,36 @@ search_timeout (gpointer user_data)
 
   /* Edge case: if no providers are ready/active, emit immediately */
   if (priv->outstanding_searches == 0)
-    phosh_dbus_search_emit_query_finished (priv->object);
+    phosh_dbus_search_emit_query_finished (priv->object, priv->generation);
 
   return G_SOURCE_REMOVE;
 }
 
 
+static void
+cancel_searches (PhoshSearchApplication *self)
+{
+  PhoshSearchApplicationPrivate *priv = phosh_search_application_get_instance_private (self);
+  GHashTableIter iter;
+  gpointer value;
+
+  /* Results still coming in for the previous generation are stale */
+  priv->search_serial++;
+  priv->outstanding_searches = 0;
+  g_ptr_array_set_size (priv->deferred, 0);
+  g_clear_handle_id (&priv->activate_timeout, g_source_remove);
+
+  g_hash_table_iter_init (&iter, priv->providers);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    phosh_search_provider_cancel (PHOSH_SEARCH_PROVIDER (value));
+}
+
+
 static gboolean
 query (PhoshDBusSearch       *interface,
        GDBusMethodInvocation *invocation,
        const char            *query,
+       guint                  generation,
        gpointer               user_data)
 {
   PhoshSearchApplication *self = PHOSH_SEARCH_APPLICATION (user_data);
@@ -524,25 +831,29 @@ query (PhoshDBusSearch       *interface,
   len = parts ? g_strv_length (parts) : 0;
   if (priv->query_parts && g_strv_equal ((const char *const *) priv->query_parts,
                                          (const char *const *) parts)) {
-    phosh_dbus_search_complete_query (interface, invocation, FALSE);
-    phosh_dbus_search_emit_query_finished (interface);
+    /* Same terms, the current results belong to the new generation too */
+    if (priv->search_timeout == 0 && priv->outstanding_searches == 0) {
+      priv->generation = generation;
+      phosh_dbus_search_complete_query (interface, invocation, FALSE);
+      phosh_dbus_search_emit_query_finished (interface, generation);
 
-    return TRUE;
+      return TRUE;
+    }
   }
 
-  g_cancellable_cancel (priv->cancellable);
-  /* Avoid reusing cancellable by creating a new one */
-  g_clear_object (&priv->cancellable);
-  priv->cancellable = g_cancellable_new ();
+  priv->generation = generation;
+  /* Cancel in flight provider calls right away, not only when the next search starts */
+  cancel_searches (self);
 
   if (len == 0) {
     g_clear_pointer (&priv->query, g_free);
     g_clear_pointer (&priv->query_parts, g_strfreev);
 
     priv->doing_subsearch = FALSE;
+    g_clear_handle_id (&priv->search_timeout, g_source_remove);
 
     phosh_dbus_search_complete_query (interface, invocation, FALSE);
-    phosh_dbus_search_emit_query_finished (interface);
+    phosh_dbus_search_emit_query_finished (interface, generation);
 
     return TRUE;
   }
@@ -565,6 +876,37 @@ query (PhoshDBusSearch       *interface,
 }
 
 
+static gboolean
+cancel_query (PhoshDBusSearch       *interface,
+              GDBusMethodInvocation *invocation,
+              guint                  generation,
+              gpointer               user_data)
+{
+  PhoshSearchApplication *self = PHOSH_SEARCH_APPLICATION (user_data);
+  PhoshSearchApplicationPrivate *priv = phosh_search_application_get_instance_private (self);
+
+  if (generation != 0 && generation != priv->generation) {
+    g_debug ("[CancelQuery] Generation %u isn't current", generation);
+    phosh_dbus_search_complete_cancel_query (interface, invocation);
+    return TRUE;
+  }
+
+  g_debug ("[CancelQuery] Cancelling generation %u", priv->generation);
+  cancel_searches (self);
+  g_clear_handle_id (&priv->search_timeout, g_source_remove);
+
+  /* The results are incomplete so the next query can't build on them */
+  g_clear_pointer (&priv->query, g_free);
+  g_clear_pointer (&priv->query_parts, g_strfreev);
+  priv->doing_subsearch = FALSE;
+  g_hash_table_remove_all (priv->last_results);
+
+  phosh_dbus_search_complete_cancel_query (interface, invocation);
+
+  return TRUE;
+}
+
+
 /* Sort algorithm taken straight from remoteSearch.js, comments and all */
 static int
 sort_sources (gconstpointer a, gconstpointer b, gpointer user_data)
@@ -841,10 +1183,13 @@ phosh_search_application_init (PhoshSearchApplication *self)
                                            g_str_equal,
                                            g_free,
                                            (GDestroyNotify) g_object_unref);
+  priv->missed_deadlines = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  priv->deferred = g_ptr_array_new_with_free_func (g_object_unref);
 
   priv->cancellable = g_cancellable_new ();
 
   priv->settings = g_settings_new (SEARCH_PROVIDERS_SCHEMA);
+  priv->search_settings = g_settings_new (SEARCH_SCHEMA);
   g_object_connect (priv->settings,
                     "swapped-object-signal::changed::disabled", reload_providers, self,
                     "swapped-object-signal::changed::enabled", reload_providers, self,
@@ -862,6 +1207,7 @@ phosh_search_application_init (PhoshSearchApplication *self)
                     "object-signal::handle-activate-result", activate_result, self,
                     "object-signal::handle-get-sources", get_sources, self,
                     "object-signal::handle-query", query, self,
+                    "object-signal::handle-cancel-query", cancel_query, self,
                     "object-signal::handle-get-last-results", get_last_results, self,
                     NULL);
 
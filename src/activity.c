@@ -17,6 +17,8 @@
 #include "util.h"
 #include "app-grid-button.h"
 
+#include <math.h>
+
 /**
  * PhoshActivity:
  *
@@ -62,6 +64,7 @@ typedef struct {
   GtkWidget       *preview;
   GtkWidget       *button;
   GtkWidget       *spinner;
+  GtkWidget       *lbl_memory;
 
   gboolean         maximized;
   gboolean         fullscreen;
@@ -71,8 +74,8 @@ typedef struct {
   char            *app_id;
   char            *parent_app_id;
 
+  /* Our copy of the most recent thumbnail */
   cairo_surface_t *surface;
-  PhoshThumbnail  *thumbnail;
 
   gboolean         hovering;
   guint            remove_timeout_id;
@@ -393,7 +396,6 @@ phosh_activity_dispose (GObject *object)
   PhoshActivityPrivate *priv = phosh_activity_get_instance_private (self);
 
   g_clear_pointer (&priv->surface, cairo_surface_destroy);
-  g_clear_object (&priv->thumbnail);
   g_clear_object (&priv->app_info);
 
   if (priv->remove_timeout_id) {
@@ -750,6 +752,7 @@ phosh_activity_class_init (PhoshActivityClass *klass)
   gtk_widget_class_bind_template_child_private (widget_class, PhoshActivity, revealer_close);
   gtk_widget_class_bind_template_child_private (widget_class, PhoshActivity, revealer_unfullscreen);
   gtk_widget_class_bind_template_child_private (widget_class, PhoshActivity, spinner);
+  gtk_widget_class_bind_template_child_private (widget_class, PhoshActivity, lbl_memory);
   gtk_widget_class_bind_template_callback (widget_class, clicked_cb);
   gtk_widget_class_bind_template_callback (widget_class, closed_cb);
   gtk_widget_class_bind_template_callback (widget_class, draw_cb);
@@ -802,49 +805,131 @@ phosh_activity_get_app_id (PhoshActivity *self)
 /**
  * phosh_activity_set_thumbnail:
  * @self: the activity
- * @thumbnail:(transfer full): the thumbnail
+ * @thumbnail: the thumbnail
  *
- * Sets the given thumbnail
+ * Updates the activity's image from the given thumbnail. The image is
+ * downscaled to the activity's size if needed. If the thumbnail
+ * carries damage information and matches the size of the current image
+ * only the damaged region is copied over.
  */
 void
 phosh_activity_set_thumbnail (PhoshActivity *self, PhoshThumbnail *thumbnail)
 {
   PhoshActivityPrivate *priv;
+  const cairo_region_t *damage;
+  cairo_surface_t *source;
   gpointer data;
   guint w, width, height, stride, margin;
+  int scale_factor, surface_width, surface_height;
+  double downscale = 1.0;
   float scale;
   gboolean has_thumbnail;
+  cairo_t *cr;
 
   g_return_if_fail (PHOSH_IS_ACTIVITY (self));
+  g_return_if_fail (PHOSH_IS_THUMBNAIL (thumbnail));
   priv = phosh_activity_get_instance_private (self);
 
-  has_thumbnail = !!priv->thumbnail;
-  g_clear_object (&priv->thumbnail);
-  priv->thumbnail = thumbnail;
+  has_thumbnail = !!priv->surface;
 
   data = phosh_thumbnail_get_image (thumbnail);
   phosh_thumbnail_get_size (thumbnail, &width, &height, &stride);
+  damage = phosh_thumbnail_get_damage (thumbnail);
+
+  /* Downscale once to the size we draw at rather than on every draw */
+  scale_factor = gtk_widget_get_scale_factor (GTK_WIDGET (self));
+  if (priv->allocation.width > 0 && priv->allocation.height > 0) {
+    downscale = MIN ((double)priv->allocation.width * scale_factor / width,
+                     (double)priv->allocation.height * scale_factor / height);
+    downscale = MIN (downscale, 1.0);
+  }
+  surface_width = MAX (1, round (width * downscale));
+  surface_height = MAX (1, round (height * downscale));
+
+  if (priv->surface == NULL ||
+      cairo_image_surface_get_width (priv->surface) != surface_width ||
+      cairo_image_surface_get_height (priv->surface) != surface_height) {
+    g_clear_pointer (&priv->surface, cairo_surface_destroy);
+    priv->surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, surface_width, surface_height);
+    /* Nothing to reuse, copy everything */
+    damage = NULL;
+  }
 
-  g_clear_pointer (&priv->surface, cairo_surface_destroy);
-  priv->surface = cairo_image_surface_create_for_data (data,
-                                                       CAIRO_FORMAT_ARGB32,
-                                                       width, height, stride);
+  source = cairo_image_surface_create_for_data (data, CAIRO_FORMAT_ARGB32, width, height, stride);
+  cr = cairo_create (priv->surface);
+  cairo_set_operator (cr, CAIRO_OPERATOR_SOURCE);
+  if (downscale < 1.0) {
+    cairo_scale (cr, downscale, downscale);
+  } else if (damage) {
+    gdk_cairo_region (cr, damage);
+    cairo_clip (cr);
+  }
+  cairo_set_source_surface (cr, source, 0, 0);
+  cairo_pattern_set_filter (cairo_get_source (cr), CAIRO_FILTER_GOOD);
+  cairo_paint (cr);
+  cairo_destroy (cr);
+  cairo_surface_destroy (source);
 
   phosh_util_toggle_style_class (GTK_WIDGET (self), "phosh-empty", FALSE);
 
   /* Make sure buttons are over the thumbnail */
   w = gtk_widget_get_allocated_width (GTK_WIDGET (self));
   scale = get_scale (self);
-  margin = w ? (w - (width * scale)) / 2 : 0;
+  margin = w ? (w - (surface_width * scale)) / 2 : 0;
   gtk_widget_set_margin_start (priv->btn_unfullscreen, margin);
   gtk_widget_set_margin_end (priv->btn_close, margin);
 
   gtk_widget_queue_draw (GTK_WIDGET (self));
 
-  if (has_thumbnail != !!priv->thumbnail)
+  if (!has_thumbnail)
     g_object_notify_by_pspec (G_OBJECT (self), props[PROP_HAS_THUMBNAIL]);
 }
 
+/**
+ * phosh_activity_clear_thumbnail:
+ * @self: the activity
+ *
+ * Drops the activity's image so only the app's icon is shown.
+ */
+void
+phosh_activity_clear_thumbnail (PhoshActivity *self)
+{
+  PhoshActivityPrivate *priv;
+
+  g_return_if_fail (PHOSH_IS_ACTIVITY (self));
+  priv = phosh_activity_get_instance_private (self);
+
+  if (!priv->surface)
+    return;
+
+  set_hovering (self, FALSE);
+  g_clear_pointer (&priv->surface, cairo_surface_destroy);
+  phosh_util_toggle_style_class (GTK_WIDGET (self), "phosh-empty", TRUE);
+  gtk_widget_queue_draw (GTK_WIDGET (self));
+
+  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_HAS_THUMBNAIL]);
+}
+
+/**
+ * phosh_activity_get_thumbnail_surface:
+ * @self: the activity
+ *
+ * Get the (downscaled) image currently shown by the activity.
+ *
+ * Returns:(transfer none)(nullable): The image
+ */
+cairo_surface_t *
+phosh_activity_get_thumbnail_surface (PhoshActivity *self)
+{
+  PhoshActivityPrivate *priv;
+
+  g_return_val_if_fail (PHOSH_IS_ACTIVITY (self), NULL);
+  priv = phosh_activity_get_instance_private (self);
+
+  return priv->surface;
+}
+
+
 void
 phosh_activity_get_thumbnail_allocation (PhoshActivity *self, GtkAllocation *allocation)
 {
@@ -865,7 +950,7 @@ phosh_activity_get_has_thumbnail (PhoshActivity *self)
 
   g_return_val_if_fail (PHOSH_IS_ACTIVITY (self), FALSE);
 
-  return !!priv->thumbnail;
+  return !!priv->surface;
 }
 
 
@@ -878,3 +963,27 @@ phosh_activity_get_app_info (PhoshActivity *self)
 
   return priv->app_info;
 }
+
+/**
+ * phosh_activity_set_memory:
+ * @self: The activity
+ * @memory: The memory used by the activity's app in bytes
+ *
+ * Show how much memory the app uses. `0` hides the usage.
+ */
+void
+phosh_activity_set_memory (PhoshActivity *self, guint64 memory)
+{
+  PhoshActivityPrivate *priv;
+  g_autofree char *size = NULL;
+
+  g_return_if_fail (PHOSH_IS_ACTIVITY (self));
+  priv = phosh_activity_get_instance_private (self);
+
+  gtk_widget_set_visible (priv->lbl_memory, memory > 0);
+  if (memory == 0)
+    return;
+
+  size = g_format_size (memory);
+  gtk_label_set_label (GTK_LABEL (priv->lbl_memory), size);
+}
@@ -19,7 +19,10 @@ GtkWidget  *phosh_activity_new        (const char *app_id);
 const char *phosh_activity_get_app_id (PhoshActivity   *self);
 void        phosh_activity_set_thumbnail (PhoshActivity *self,
                                           PhoshThumbnail *thumbnail);
+void        phosh_activity_clear_thumbnail (PhoshActivity *self);
+cairo_surface_t *phosh_activity_get_thumbnail_surface (PhoshActivity *self);
 void        phosh_activity_get_thumbnail_allocation (PhoshActivity *self,
                                                      GtkAllocation *allocation);
 gboolean    phosh_activity_get_has_thumbnail (PhoshActivity *self);
 GAppInfo *  phosh_activity_get_app_info (PhoshActivity *self);
+void        phosh_activity_set_memory (PhoshActivity *self, guint64 memory);
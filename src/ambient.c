@@ -17,6 +17,8 @@
 #include "sensor-proxy-manager.h"
 #include "util.h"
 
+#include <math.h>
+
 #define INTERFACE_SCHEMA        "org.gnome.desktop.interface"
 #define HIGH_CONTRAST_THEME     "HighContrast"
 #define KEY_GTK_THEME           "gtk-theme"
@@ -30,6 +32,19 @@
 #define KEY_AMBIENT_ENABLED "ambient-enabled"
 
 #define NUM_VALUES              3
+/* Minimum time between automatic high contrast switches */
+#define HC_HOLD_S               30
+
+/* Release the sensor when the light level didn't change for that long */
+#define DUTY_CYCLE_STABLE_S     30
+/* Time the sensor stays released before sampling again */
+#define DUTY_CYCLE_DOZE_S       10
+/* Same when saving power */
+#define DUTY_CYCLE_DOZE_POWER_SAVER_S 30
+/* Time to wait for a change after re-claiming the sensor */
+#define DUTY_CYCLE_SAMPLE_S     2
+/* Relative change that counts as a significant light level change */
+#define DUTY_CYCLE_THRESHOLD    0.1
 
 /**
  * PhoshAmbient:
@@ -38,6 +53,16 @@
  *
  * #PhoshAmbient handles enabling and disabling the ambient detection
  * based and toggles related actions.
+ *
+ * To save power the sensor is released when the light level was
+ * stable for a while and re-claimed periodically to check for
+ * changes. Consumers don't notice this as auto brightness stays
+ * enabled while the sensor is dozing. When the shell saves power the
+ * sensor dozes longer.
+ *
+ * After switching to or from high contrast the theme is kept for a
+ * while so e.g. walking between sunlight and shade doesn't restyle
+ * the whole shell over and over.
  */
 
 enum {
@@ -70,6 +95,11 @@ typedef struct _PhoshAmbient {
 
   guint         sample_id;
   GArray       *values;
+  guint         hc_hold_id;
+
+  gboolean      dozing;
+  guint         duty_cycle_id;
+  double        stable_level;
 
   PhoshFader   *fader;
   guint         fader_id;
@@ -141,6 +171,22 @@ on_fade_in_done (PhoshAmbient *self)
 }
 
 
+static void check_high_contrast (PhoshAmbient *self, double level);
+
+
+static gboolean
+on_hc_hold_done (gpointer data)
+{
+  PhoshAmbient *self = PHOSH_AMBIENT (data);
+
+  self->hc_hold_id = 0;
+  /* The light level might have changed while holding */
+  check_high_contrast (self, self->light_level);
+
+  return G_SOURCE_REMOVE;
+}
+
+
 static void
 switch_theme (PhoshAmbient *self, gboolean use_hc)
 {
@@ -163,6 +209,10 @@ switch_theme (PhoshAmbient *self, gboolean use_hc)
   g_source_set_name_by_id (self->fader_id, "[phosh] ambient fader");
 
   self->use_hc = use_hc;
+
+  g_clear_handle_id (&self->hc_hold_id, g_source_remove);
+  self->hc_hold_id = g_timeout_add_seconds (HC_HOLD_S, on_hc_hold_done, self);
+  g_source_set_name_by_id (self->hc_hold_id, "[phosh] ambient hc hold");
 }
 
 
@@ -204,6 +254,84 @@ stop_high_contrast_sampling (PhoshAmbient *self)
 }
 
 
+static void phosh_ambient_claim_light (PhoshAmbient *self, gboolean claim);
+static void update_auto_brightness_enabled (PhoshAmbient *self);
+static void schedule_doze (PhoshAmbient *self, guint timeout);
+
+
+static gboolean
+on_duty_cycle_wake (gpointer data)
+{
+  PhoshAmbient *self = PHOSH_AMBIENT (data);
+
+  self->duty_cycle_id = 0;
+  g_debug ("Sampling ambient light");
+  phosh_ambient_claim_light (self, TRUE);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static guint
+get_doze_time (void)
+{
+  PhoshPowerSaverManager *manager;
+
+  manager = phosh_shell_get_power_saver_manager (phosh_shell_get_default ());
+  if (manager && phosh_power_saver_manager_get_active (manager))
+    return DUTY_CYCLE_DOZE_POWER_SAVER_S;
+
+  return DUTY_CYCLE_DOZE_S;
+}
+
+
+static gboolean
+on_duty_cycle_doze (gpointer data)
+{
+  PhoshAmbient *self = PHOSH_AMBIENT (data);
+  guint doze_time;
+
+  self->duty_cycle_id = 0;
+
+  /* Don't interrupt high contrast sampling */
+  if (self->sample_id) {
+    schedule_doze (self, DUTY_CYCLE_SAMPLE_S);
+    return G_SOURCE_REMOVE;
+  }
+
+  doze_time = get_doze_time ();
+  g_debug ("Ambient light stable, releasing sensor for %ds", doze_time);
+  phosh_ambient_claim_light (self, FALSE);
+  self->dozing = TRUE;
+  self->duty_cycle_id = g_timeout_add_seconds (doze_time, on_duty_cycle_wake, self);
+  g_source_set_name_by_id (self->duty_cycle_id, "[phosh] ambient duty cycle wake");
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static void
+schedule_doze (PhoshAmbient *self, guint timeout)
+{
+  g_clear_handle_id (&self->duty_cycle_id, g_source_remove);
+  self->duty_cycle_id = g_timeout_add_seconds (timeout, on_duty_cycle_doze, self);
+  g_source_set_name_by_id (self->duty_cycle_id, "[phosh] ambient duty cycle doze");
+}
+
+
+static void
+stop_duty_cycle (PhoshAmbient *self)
+{
+  g_clear_handle_id (&self->duty_cycle_id, g_source_remove);
+
+  if (!self->dozing)
+    return;
+
+  self->dozing = FALSE;
+  update_auto_brightness_enabled (self);
+}
+
+
 static void
 check_high_contrast (PhoshAmbient *self, double level)
 {
@@ -217,6 +345,10 @@ check_high_contrast (PhoshAmbient *self, double level)
   if (self->sample_id)
     return;
 
+  /* Recently switched, check again once the hold time is over */
+  if (self->hc_hold_id)
+    return;
+
   threshold = g_settings_get_uint (self->phosh_settings, KEY_AUTOMATIC_HC_THRESHOLD);
   /* Use a bit of hysteresis to not switch too often around the threshold */
   hyst = self->use_hc ? 0.9 : 1.1;
@@ -258,6 +390,13 @@ on_ambient_light_level_changed (PhoshAmbient            *self,
   }
 
   g_debug ("Ambient light changed: %.2f %s", level, unit);
+
+  /* Keep the sensor claimed while the light level changes */
+  if (fabs (level - self->stable_level) > DUTY_CYCLE_THRESHOLD * MAX (self->stable_level, 1.0)) {
+    self->stable_level = level;
+    schedule_doze (self, DUTY_CYCLE_STABLE_S);
+  }
+
   if (!G_APPROX_VALUE (self->light_level, level, FLT_EPSILON)) {
     self->light_level = level;
     g_object_notify_by_pspec (G_OBJECT (self), props[PROP_LIGHT_LEVEL]);
@@ -274,7 +413,7 @@ update_auto_brightness_enabled (PhoshAmbient *self)
 
   g_return_if_fail (self->claimed >= 0);
 
-  auto_brightness = (self->claimed &&
+  auto_brightness = ((self->claimed || self->dozing) &&
                      g_settings_get_boolean (self->power_settings, KEY_AMBIENT_ENABLED));
 
   if (self->auto_brightness == auto_brightness)
@@ -305,6 +444,10 @@ on_ambient_claimed (GObject *source_object, GAsyncResult *res, gpointer user_dat
   g_debug ("Claimed ambient sensor");
   self->claimed++;
 
+  /* Go back to sleep soon if nothing changed while dozing */
+  schedule_doze (self, self->dozing ? DUTY_CYCLE_SAMPLE_S : DUTY_CYCLE_STABLE_S);
+  self->dozing = FALSE;
+
   update_auto_brightness_enabled (self);
   on_ambient_light_level_changed (self, NULL, self->sensor_proxy_manager);
 }
@@ -375,6 +518,8 @@ maybe_claim (PhoshAmbient *self)
   }
 
   self->auto_hc = auto_hc;
+  if (!claim)
+    stop_duty_cycle (self);
   update_auto_brightness_enabled (self);
 
   if (claim) {
@@ -423,6 +568,7 @@ on_has_ambient_light_changed (PhoshAmbient         *self,
     return;
   }
 
+  stop_duty_cycle (self);
   if (!self->claimed)
     return;
 
@@ -451,9 +597,10 @@ on_shell_state_changed (PhoshAmbient *self, GParamSpec *pspec, PhoshShell *shell
 
   g_debug ("Shell blanked: %d", self->blanked);
   /* Claim / unclaim the sensor on screen unblank / blank */
-  if (blanked)
+  if (blanked) {
+    stop_duty_cycle (self);
     phosh_ambient_claim_light (self, FALSE);
-  else
+  } else
     maybe_claim (self);
 }
 
@@ -507,7 +654,9 @@ phosh_ambient_dispose (GObject *object)
   g_clear_object (&self->cancel);
 
   g_clear_handle_id (&self->sample_id, g_source_remove);
+  g_clear_handle_id (&self->hc_hold_id, g_source_remove);
   g_clear_pointer (&self->values, g_array_unref);
+  g_clear_handle_id (&self->duty_cycle_id, g_source_remove);
 
   if (self->sensor_proxy_manager) {
     g_signal_handlers_disconnect_by_data (self->sensor_proxy_manager, self);
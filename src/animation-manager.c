@@ -0,0 +1,301 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "phosh-animation-manager"
+
+#include "phosh-config.h"
+
+#include "animation-manager.h"
+#include "phosh-enums.h"
+
+#include <gio/gio.h>
+
+#define PPD_BUS_NAME    "net.hadess.PowerProfiles"
+#define PPD_OBJECT_PATH "/net/hadess/PowerProfiles"
+#define PPD_INTERFACE   "net.hadess.PowerProfiles"
+
+/**
+ * PhoshAnimationManager:
+ *
+ * Picks the global [enum@AnimationProfile] based on the power state
+ * of the device: When the [class@PowerSaverManager] is active or the
+ * device is thermally throttled animations are shortened and motion is
+ * replaced by crossfades. The same happens when the [class@ModeManager]'s
+ * performance tier asks for reduced animations, e.g. on devices with
+ * little memory.
+ *
+ * Disabling animations altogether is left to the user via
+ * `org.gnome.desktop.interface`'s `enable-animations` key which GTK
+ * and libhandy already honor.
+ */
+
+enum {
+  PROP_0,
+  PROP_POWER_SAVER_MANAGER,
+  PROP_MODE_MANAGER,
+  PROP_PROFILE,
+  PROP_LAST_PROP
+};
+static GParamSpec *props[PROP_LAST_PROP];
+
+struct _PhoshAnimationManager {
+  PhoshManager           parent;
+
+  PhoshPowerSaverManager *power_saver_manager;
+  PhoshModeManager       *mode_manager;
+  GDBusProxy             *ppd_proxy;
+  GCancellable           *cancel;
+
+  PhoshAnimationProfile   profile;
+};
+G_DEFINE_TYPE (PhoshAnimationManager, phosh_animation_manager, PHOSH_TYPE_MANAGER)
+
+
+static gboolean
+get_performance_degraded (PhoshAnimationManager *self)
+{
+  g_autoptr (GVariant) degraded = NULL;
+
+  if (self->ppd_proxy == NULL)
+    return FALSE;
+
+  degraded = g_dbus_proxy_get_cached_property (self->ppd_proxy, "PerformanceDegraded");
+  if (degraded == NULL || !g_variant_is_of_type (degraded, G_VARIANT_TYPE_STRING))
+    return FALSE;
+
+  /* Empty when not degraded, otherwise the reason like `high-operating-temperature` */
+  return !!g_variant_get_string (degraded, NULL)[0];
+}
+
+
+static void
+update_profile (PhoshAnimationManager *self)
+{
+  PhoshAnimationProfile profile = PHOSH_ANIMATION_PROFILE_FULL;
+  gboolean power_saving = FALSE, degraded, tier_reduced = FALSE;
+
+  if (self->power_saver_manager)
+    power_saving = phosh_power_saver_manager_get_active (self->power_saver_manager);
+
+  if (self->mode_manager)
+    tier_reduced = phosh_mode_manager_get_perf_profile (self->mode_manager)->reduce_animations;
+
+  degraded = get_performance_degraded (self);
+
+  if (power_saving || degraded || tier_reduced)
+    profile = PHOSH_ANIMATION_PROFILE_REDUCED;
+
+  if (profile == self->profile)
+    return;
+
+  g_debug ("Animation profile %d (power saving: %d, degraded: %d, tier: %d)",
+           profile, power_saving, degraded, tier_reduced);
+  self->profile = profile;
+  phosh_animation_set_profile (profile);
+  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_PROFILE]);
+}
+
+
+static void
+on_ppd_properties_changed (PhoshAnimationManager *self, GVariant *changed)
+{
+  g_autoptr (GVariant) degraded = NULL;
+
+  degraded = g_variant_lookup_value (changed, "PerformanceDegraded", NULL);
+  if (degraded)
+    update_profile (self);
+}
+
+
+static void
+on_ppd_proxy_ready (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+  PhoshAnimationManager *self;
+  g_autoptr (GError) err = NULL;
+  GDBusProxy *proxy;
+
+  proxy = g_dbus_proxy_new_for_bus_finish (res, &err);
+  if (proxy == NULL) {
+    if (!g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+      g_debug ("Failed to get power profiles proxy: %s", err->message);
+    return;
+  }
+
+  self = PHOSH_ANIMATION_MANAGER (user_data);
+  self->ppd_proxy = proxy;
+  g_signal_connect_object (self->ppd_proxy, "g-properties-changed",
+                           G_CALLBACK (on_ppd_properties_changed), self,
+                           G_CONNECT_SWAPPED);
+  update_profile (self);
+}
+
+
+static void
+phosh_animation_manager_idle_init (PhoshManager *manager)
+{
+  PhoshAnimationManager *self = PHOSH_ANIMATION_MANAGER (manager);
+
+  if (self->power_saver_manager) {
+    g_signal_connect_object (self->power_saver_manager, "notify::active",
+                             G_CALLBACK (update_profile), self,
+                             G_CONNECT_SWAPPED);
+  }
+
+  if (self->mode_manager) {
+    g_signal_connect_object (self->mode_manager, "notify::perf-tier",
+                             G_CALLBACK (update_profile), self,
+                             G_CONNECT_SWAPPED);
+  }
+
+  /* For the thermal hint */
+  g_dbus_proxy_new_for_bus (G_BUS_TYPE_SYSTEM,
+                            G_DBUS_PROXY_FLAGS_DO_NOT_CONNECT_SIGNALS,
+                            NULL,
+                            PPD_BUS_NAME,
+                            PPD_OBJECT_PATH,
+                            PPD_INTERFACE,
+                            self->cancel,
+                            on_ppd_proxy_ready,
+                            self);
+
+  update_profile (self);
+}
+
+
+static void
+phosh_animation_manager_set_property (GObject      *object,
+                                      guint         property_id,
+                                      const GValue *value,
+                                      GParamSpec   *pspec)
+{
+  PhoshAnimationManager *self = PHOSH_ANIMATION_MANAGER (object);
+
+  switch (property_id) {
+  case PROP_POWER_SAVER_MANAGER:
+    self->power_saver_manager = g_value_dup_object (value);
+    break;
+  case PROP_MODE_MANAGER:
+    self->mode_manager = g_value_dup_object (value);
+    break;
+  default:
+    G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    break;
+  }
+}
+
+
+static void
+phosh_animation_manager_get_property (GObject    *object,
+                                      guint       property_id,
+                                      GValue     *value,
+                                      GParamSpec *pspec)
+{
+  PhoshAnimationManager *self = PHOSH_ANIMATION_MANAGER (object);
+
+  switch (property_id) {
+  case PROP_POWER_SAVER_MANAGER:
+    g_value_set_object (value, self->power_saver_manager);
+    break;
+  case PROP_MODE_MANAGER:
+    g_value_set_object (value, self->mode_manager);
+    break;
+  case PROP_PROFILE:
+    g_value_set_enum (value, self->profile);
+    break;
+  default:
+    G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    break;
+  }
+}
+
+
+static void
+phosh_animation_manager_dispose (GObject *object)
+{
+  PhoshAnimationManager *self = PHOSH_ANIMATION_MANAGER (object);
+
+  g_cancellable_cancel (self->cancel);
+  g_clear_object (&self->cancel);
+  g_clear_object (&self->ppd_proxy);
+  g_clear_object (&self->power_saver_manager);
+  g_clear_object (&self->mode_manager);
+
+  phosh_animation_set_profile (PHOSH_ANIMATION_PROFILE_FULL);
+
+  G_OBJECT_CLASS (phosh_animation_manager_parent_class)->dispose (object);
+}
+
+
+static void
+phosh_animation_manager_class_init (PhoshAnimationManagerClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  PhoshManagerClass *manager_class = PHOSH_MANAGER_CLASS (klass);
+
+  object_class->get_property = phosh_animation_manager_get_property;
+  object_class->set_property = phosh_animation_manager_set_property;
+  object_class->dispose = phosh_animation_manager_dispose;
+
+  manager_class->idle_init = phosh_animation_manager_idle_init;
+
+  /**
+   * PhoshAnimationManager:power-saver-manager:
+   *
+   * The power saver manager used to check whether to save power
+   */
+  props[PROP_POWER_SAVER_MANAGER] =
+    g_param_spec_object ("power-saver-manager", "", "",
+                         PHOSH_TYPE_POWER_SAVER_MANAGER,
+                         G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+  /**
+   * PhoshAnimationManager:mode-manager:
+   *
+   * The mode manager used to check the performance tier
+   */
+  props[PROP_MODE_MANAGER] =
+    g_param_spec_object ("mode-manager", "", "",
+                         PHOSH_TYPE_MODE_MANAGER,
+                         G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+  /**
+   * PhoshAnimationManager:profile:
+   *
+   * The current animation profile
+   */
+  props[PROP_PROFILE] =
+    g_param_spec_enum ("profile", "", "",
+                       PHOSH_TYPE_ANIMATION_PROFILE,
+                       PHOSH_ANIMATION_PROFILE_FULL,
+                       G_PARAM_READABLE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties (object_class, PROP_LAST_PROP, props);
+}
+
+
+static void
+phosh_animation_manager_init (PhoshAnimationManager *self)
+{
+  self->cancel = g_cancellable_new ();
+}
+
+
+PhoshAnimationManager *
+phosh_animation_manager_new (PhoshPowerSaverManager *power_saver_manager,
+                             PhoshModeManager       *mode_manager)
+{
+  return g_object_new (PHOSH_TYPE_ANIMATION_MANAGER,
+                       "power-saver-manager", power_saver_manager,
+                       "mode-manager", mode_manager,
+                       NULL);
+}
+
+
+PhoshAnimationProfile
+phosh_animation_manager_get_profile (PhoshAnimationManager *self)
+{
+  g_return_val_if_fail (PHOSH_IS_ANIMATION_MANAGER (self), PHOSH_ANIMATION_PROFILE_FULL);
+
+  return self->profile;
+}
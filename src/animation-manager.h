@@ -0,0 +1,25 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include "animation.h"
+#include "manager.h"
+#include "mode-manager.h"
+#include "power-saver-manager.h"
+
+G_BEGIN_DECLS
+
+#define PHOSH_TYPE_ANIMATION_MANAGER (phosh_animation_manager_get_type ())
+
+G_DECLARE_FINAL_TYPE (PhoshAnimationManager, phosh_animation_manager, PHOSH, ANIMATION_MANAGER,
+                      PhoshManager)
+
+PhoshAnimationManager *phosh_animation_manager_new         (PhoshPowerSaverManager *power_saver_manager,
+                                                            PhoshModeManager       *mode_manager);
+PhoshAnimationProfile  phosh_animation_manager_get_profile (PhoshAnimationManager  *self);
+
+G_END_DECLS
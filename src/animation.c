@@ -11,8 +11,32 @@
 #include "animation.h"
 #include <handy.h>
 
+/**
+ * PhoshAnimation:
+ *
+ * An animation interpolating between two values.
+ *
+ * Running animations are not driven by per widget tick callbacks but
+ * stepped together once per frame of the frame clock they run on so
+ * that e.g. several notification banners or swipe away bins
+ * animating at once update in a single pass and end up in the same
+ * frame.
+ */
+
 G_DEFINE_BOXED_TYPE (PhoshAnimation, phosh_animation, phosh_animation_ref, phosh_animation_unref)
 
+/* All animations running on a frame clock */
+typedef struct {
+  GdkFrameClock *frame_clock;
+  gulong         update_id;
+  GPtrArray     *animations;
+} PhoshAnimationClock;
+
+/* key: GdkFrameClock, value: PhoshAnimationClock */
+static GHashTable *clocks;
+
+static PhoshAnimationProfile animation_profile = PHOSH_ANIMATION_PROFILE_FULL;
+
 struct _PhoshAnimation
 {
   gatomicrefcount ref_count;
@@ -26,8 +50,12 @@ struct _PhoshAnimation
   gint64 duration;
   PhoshAnimationType type;
 
+  /* What's used by the running animation as per the profile */
+  gint64 run_duration;
+  PhoshAnimationType run_type;
+
   gint64 start_time;
-  guint tick_cb_id;
+  PhoshAnimationClock *clock;
 
   PhoshAnimationValueCallback value_cb;
   PhoshAnimationDoneCallback done_cb;
@@ -109,16 +137,89 @@ interpolate (PhoshAnimationType type, double t)
   }
 }
 
-static gboolean
-tick_cb (GtkWidget       *widget,
-         GdkFrameClock   *frame_clock,
-         PhoshAnimation  *self)
+static void step (PhoshAnimation *self, gint64 frame_time);
+
+
+static void
+on_frame_clock_update (GdkFrameClock *frame_clock, PhoshAnimationClock *clock)
 {
   gint64 frame_time = gdk_frame_clock_get_frame_time (frame_clock) / 1000;
-  double t = (double) (frame_time - self->start_time) / self->duration;
+  g_autoptr (GPtrArray) animations = NULL;
+
+  /* Callbacks can start, stop or drop animations (and the clock) so work on a copy */
+  animations = g_ptr_array_copy (clock->animations, (GCopyFunc) phosh_animation_ref, NULL);
+  g_ptr_array_set_free_func (animations, (GDestroyNotify) phosh_animation_unref);
+
+  for (guint i = 0; i < animations->len; i++) {
+    PhoshAnimation *animation = g_ptr_array_index (animations, i);
+
+    /* Only step animations that are still running on this clock */
+    if (animation->clock && animation->clock->frame_clock == frame_clock)
+      step (animation, frame_time);
+  }
+}
+
+
+static void
+clock_free (PhoshAnimationClock *clock)
+{
+  g_clear_signal_handler (&clock->update_id, clock->frame_clock);
+  gdk_frame_clock_end_updating (clock->frame_clock);
+  g_clear_object (&clock->frame_clock);
+  g_clear_pointer (&clock->animations, g_ptr_array_unref);
+  g_free (clock);
+}
+
+
+static void
+schedule (PhoshAnimation *self, GdkFrameClock *frame_clock)
+{
+  PhoshAnimationClock *clock;
+
+  if (clocks == NULL)
+    clocks = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify) clock_free);
+
+  clock = g_hash_table_lookup (clocks, frame_clock);
+  if (clock == NULL) {
+    clock = g_new0 (PhoshAnimationClock, 1);
+    clock->frame_clock = g_object_ref (frame_clock);
+    clock->animations = g_ptr_array_new ();
+    clock->update_id = g_signal_connect (frame_clock, "update",
+                                         G_CALLBACK (on_frame_clock_update),
+                                         clock);
+    gdk_frame_clock_begin_updating (frame_clock);
+    g_hash_table_insert (clocks, frame_clock, clock);
+  }
+
+  g_ptr_array_add (clock->animations, self);
+  self->clock = clock;
+}
+
+
+static void
+unschedule (PhoshAnimation *self)
+{
+  PhoshAnimationClock *clock = self->clock;
+
+  if (clock == NULL)
+    return;
+
+  self->clock = NULL;
+  g_ptr_array_remove_fast (clock->animations, self);
+
+  /* Frees the clock */
+  if (clock->animations->len == 0)
+    g_hash_table_remove (clocks, clock->frame_clock);
+}
+
+
+static void
+step (PhoshAnimation *self, gint64 frame_time)
+{
+  double t = (double) (frame_time - self->start_time) / self->run_duration;
 
   if (t >= 1) {
-    self->tick_cb_id = 0;
+    unschedule (self);
 
     set_value (self, self->value_to);
 
@@ -126,12 +227,10 @@ tick_cb (GtkWidget       *widget,
 
     self->done_cb (self->user_data);
 
-    return G_SOURCE_REMOVE;
+    return;
   }
 
-  set_value (self, LERP (self->value_from, self->value_to, interpolate (self->type, t)));
-
-  return G_SOURCE_CONTINUE;
+  set_value (self, LERP (self->value_from, self->value_to, interpolate (self->run_type, t)));
 }
 
 static void
@@ -218,11 +317,19 @@ phosh_animation_unref (PhoshAnimation *self)
 void
 phosh_animation_start (PhoshAnimation *self)
 {
+  GdkFrameClock *frame_clock;
+
   g_return_if_fail (self != NULL);
 
+  self->run_duration = phosh_animation_scale_duration (self->duration);
+  self->run_type = self->type;
+  /* Bouncing is motion for the sake of it */
+  if (animation_profile == PHOSH_ANIMATION_PROFILE_REDUCED && self->type == PHOSH_ANIMATION_TYPE_EASE_OUT_BOUNCE)
+    self->run_type = PHOSH_ANIMATION_TYPE_EASE_OUT_CUBIC;
+
   if (!hdy_get_enable_animations (self->widget) ||
       !gtk_widget_get_mapped (self->widget) ||
-      self->duration <= 0) {
+      self->run_duration <= 0) {
     set_value (self, self->value_to);
 
     self->done_cb (self->user_data);
@@ -230,14 +337,15 @@ phosh_animation_start (PhoshAnimation *self)
     return;
   }
 
-  if (self->tick_cb_id)
-    gtk_widget_remove_tick_callback (self->widget, self->tick_cb_id);
+  if (self->clock)
+    unschedule (self);
   else
     g_signal_connect_swapped (self->widget, "unmap",
                               G_CALLBACK (phosh_animation_stop), self);
 
-  self->start_time = gdk_frame_clock_get_frame_time (gtk_widget_get_frame_clock (self->widget)) / 1000;
-  self->tick_cb_id = gtk_widget_add_tick_callback (self->widget, (GtkTickCallback) tick_cb, self, NULL);
+  frame_clock = gtk_widget_get_frame_clock (self->widget);
+  self->start_time = gdk_frame_clock_get_frame_time (frame_clock) / 1000;
+  schedule (self, frame_clock);
 }
 
 void
@@ -245,11 +353,10 @@ phosh_animation_stop (PhoshAnimation *self)
 {
   g_return_if_fail (self != NULL);
 
-  if (!self->tick_cb_id)
+  if (!self->clock)
     return;
 
-  gtk_widget_remove_tick_callback (self->widget, self->tick_cb_id);
-  self->tick_cb_id = 0;
+  unschedule (self);
 
   g_signal_handlers_disconnect_by_func (self->widget, phosh_animation_stop, self);
 
@@ -263,3 +370,69 @@ phosh_animation_get_value (PhoshAnimation *self)
 
   return self->value;
 }
+
+/**
+ * phosh_animation_set_profile:
+ * @profile: The animation profile
+ *
+ * Sets the profile animations started from now on use. Disabling
+ * animations altogether is left to GTK's `gtk-enable-animations`
+ * setting.
+ */
+void
+phosh_animation_set_profile (PhoshAnimationProfile profile)
+{
+  animation_profile = profile;
+}
+
+/**
+ * phosh_animation_get_profile:
+ *
+ * Gets the current animation profile.
+ *
+ * Returns: The animation profile
+ */
+PhoshAnimationProfile
+phosh_animation_get_profile (void)
+{
+  return animation_profile;
+}
+
+/**
+ * phosh_animation_scale_duration:
+ * @duration: The duration in milliseconds
+ *
+ * Scales an animation's duration according to the current animation
+ * profile. Use this for transitions not driven by a `PhoshAnimation`
+ * like those of `GtkRevealer` or `HdyCarousel`.
+ *
+ * Returns: The duration to use in milliseconds
+ */
+gint64
+phosh_animation_scale_duration (gint64 duration)
+{
+  if (animation_profile == PHOSH_ANIMATION_PROFILE_REDUCED)
+    return duration / 2;
+
+  return duration;
+}
+
+/**
+ * phosh_animation_carousel_scroll_to:
+ * @carousel: The carousel
+ * @widget: The child of the carousel to scroll to
+ *
+ * Like [method@Handy.Carousel.scroll_to] but honors the current
+ * animation profile.
+ */
+void
+phosh_animation_carousel_scroll_to (HdyCarousel *carousel, GtkWidget *widget)
+{
+  gint64 duration;
+
+  g_return_if_fail (HDY_IS_CAROUSEL (carousel));
+  g_return_if_fail (GTK_IS_WIDGET (widget));
+
+  duration = phosh_animation_scale_duration (hdy_carousel_get_animation_duration (carousel));
+  hdy_carousel_scroll_to_full (carousel, widget, duration);
+}
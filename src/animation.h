@@ -8,6 +8,7 @@
 #pragma once
 
 #include <gtk/gtk.h>
+#include <handy.h>
 
 G_BEGIN_DECLS
 
@@ -29,6 +30,19 @@ typedef enum {
   PHOSH_ANIMATION_TYPE_EASE_OUT_BOUNCE,
 } PhoshAnimationType;
 
+/**
+ * PhoshAnimationProfile:
+ * @PHOSH_ANIMATION_PROFILE_FULL: Run animations as designed
+ * @PHOSH_ANIMATION_PROFILE_REDUCED: Shorten animations and prefer crossfades over
+ *   motion, e.g. when saving power
+ *
+ * How animations should be run.
+ */
+typedef enum {
+  PHOSH_ANIMATION_PROFILE_FULL,
+  PHOSH_ANIMATION_PROFILE_REDUCED,
+} PhoshAnimationProfile;
+
 typedef struct _PhoshAnimation PhoshAnimation;
 
 typedef void (*PhoshAnimationValueCallback) (double   value,
@@ -54,6 +68,12 @@ void            phosh_animation_stop      (PhoshAnimation *self);
 
 double          phosh_animation_get_value (PhoshAnimation *self);
 
+void                  phosh_animation_set_profile    (PhoshAnimationProfile profile);
+PhoshAnimationProfile phosh_animation_get_profile    (void);
+gint64                phosh_animation_scale_duration (gint64                duration);
+void                  phosh_animation_carousel_scroll_to (HdyCarousel    *carousel,
+                                                          GtkWidget      *widget);
+
 G_DEFINE_AUTOPTR_CLEANUP_FUNC (PhoshAnimation, phosh_animation_unref)
 
 G_END_DECLS
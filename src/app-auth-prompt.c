@@ -23,6 +23,9 @@
  *
  * The #PhoshAppAuthPrompt is used to authorize applications. It's used
  * by the #PhoshLocationManager and for org.freedesktop.impl.Access.
+ *
+ * A reusable prompt can be filled with the next request via
+ * [method@AppAuthPrompt.set_request] instead of building a new one.
  */
 
 enum {
@@ -76,6 +79,8 @@ G_DEFINE_TYPE (PhoshAppAuthPrompt, phosh_app_auth_prompt, PHOSH_TYPE_SYSTEM_MODA
 #define CHOICE_FORMAT "(ssa(ss)s)"
 #define OPTION_FORMAT "(ss)"
 
+static void update_choices (PhoshAppAuthPrompt *self);
+
 static void
 phosh_app_auth_prompt_set_property (GObject      *obj,
                                     guint         prop_id,
@@ -86,25 +91,27 @@ phosh_app_auth_prompt_set_property (GObject      *obj,
 
   switch (prop_id) {
   case PROP_ICON:
-    self->icon = g_value_dup_object (value);
+    g_set_object (&self->icon, g_value_get_object (value));
     break;
   case PROP_SUBTITLE:
-    self->subtitle = g_value_dup_string (value);
+    g_set_str (&self->subtitle, g_value_get_string (value));
     break;
   case PROP_BODY:
-    self->body = g_value_dup_string (value);
+    g_set_str (&self->body, g_value_get_string (value));
     break;
   case PROP_GRANT_LABEL:
-    self->grant_label = g_value_dup_string (value);
+    g_set_str (&self->grant_label, g_value_get_string (value));
     break;
   case PROP_DENY_LABEL:
-    self->deny_label = g_value_dup_string (value);
+    g_set_str (&self->deny_label, g_value_get_string (value));
     break;
   case PROP_OFFER_REMEMBER:
     self->offer_remember = g_value_get_boolean (value);
     break;
   case PROP_CHOICES:
+    g_clear_pointer (&self->choices, g_variant_unref);
     self->choices = g_value_dup_variant (value);
+    update_choices (self);
     break;
   default:
     G_OBJECT_WARN_INVALID_PROPERTY_ID (obj, prop_id, pspec);
@@ -278,6 +285,42 @@ add_choice_to_gvariant (GtkWidget *child, gpointer builder)
 }
 
 
+static void
+update_choices (PhoshAppAuthPrompt *self)
+{
+  GVariantIter iter_choices;
+  char *choice_id;
+  char *choice_label;
+  g_autoptr (GVariantIter) iter_options = NULL;
+  char *default_option_id;
+  g_autoptr (GList) children = NULL;
+
+  children = gtk_container_get_children (GTK_CONTAINER (self->list_box_choices));
+  for (GList *l = children; l; l = l->next)
+    gtk_widget_destroy (GTK_WIDGET (l->data));
+
+  if (self->choices == NULL) {
+    gtk_widget_set_visible (self->list_box_choices, FALSE);
+    return;
+  }
+
+  g_variant_iter_init (&iter_choices, self->choices);
+  gtk_widget_set_visible (self->list_box_choices, g_variant_iter_n_children (&iter_choices) > 0);
+
+  while (g_variant_iter_loop (&iter_choices, CHOICE_FORMAT,
+                              &choice_id,
+                              &choice_label,
+                              &iter_options,
+                              &default_option_id)) {
+    if (g_variant_iter_n_children (iter_options) == 0) {
+      add_switch_option (self, choice_id, choice_label, default_option_id);
+    } else {
+      add_combo_option (self, choice_id, choice_label, iter_options, default_option_id);
+    }
+  }
+}
+
+
 static void
 phosh_app_auth_prompt_finalize (GObject *obj)
 {
@@ -288,6 +331,7 @@ phosh_app_auth_prompt_finalize (GObject *obj)
   g_clear_pointer (&self->body, g_free);
   g_clear_pointer (&self->grant_label, g_free);
   g_clear_pointer (&self->deny_label, g_free);
+  g_clear_pointer (&self->choices, g_variant_unref);
 
   G_OBJECT_CLASS (phosh_app_auth_prompt_parent_class)->finalize (obj);
 }
@@ -301,32 +345,6 @@ phosh_app_auth_prompt_constructed (GObject *object)
   G_OBJECT_CLASS (phosh_app_auth_prompt_parent_class)->constructed (object);
 
   gtk_widget_grab_default (self->btn_grant);
-
-  if (self->choices != NULL) {
-    GVariantIter iter_choices;
-    char *choice_id;
-    char *choice_label;
-    g_autoptr (GVariantIter) iter_options = NULL;
-    char *default_option_id;
-
-    g_variant_iter_init (&iter_choices, self->choices);
-
-    if (g_variant_iter_n_children (&iter_choices) == 0) {
-      gtk_widget_set_visible (self->list_box_choices, FALSE);
-    }
-
-    while (g_variant_iter_loop (&iter_choices, CHOICE_FORMAT,
-                                &choice_id,
-                                &choice_label,
-                                &iter_options,
-                                &default_option_id)) {
-      if (g_variant_iter_n_children (iter_options) == 0) {
-        add_switch_option (self, choice_id, choice_label, default_option_id);
-      } else {
-        add_combo_option (self, choice_id, choice_label, iter_options, default_option_id);
-      }
-    }
-  }
 }
 
 
@@ -347,7 +365,7 @@ phosh_app_auth_prompt_class_init (PhoshAppAuthPromptClass *klass)
       "Icon",
       "The auth dialog icon",
       G_TYPE_ICON,
-      G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
 
   props[PROP_SUBTITLE] =
     g_param_spec_string (
@@ -355,7 +373,7 @@ phosh_app_auth_prompt_class_init (PhoshAppAuthPromptClass *klass)
       "Subtitle",
       "The auth dialog subtitle",
       "",
-      G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
 
   props[PROP_BODY] =
     g_param_spec_string (
@@ -363,7 +381,7 @@ phosh_app_auth_prompt_class_init (PhoshAppAuthPromptClass *klass)
       "Body",
       "The auth dialog body",
       "",
-      G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
 
   props[PROP_GRANT_LABEL] =
     g_param_spec_string (
@@ -371,7 +389,7 @@ phosh_app_auth_prompt_class_init (PhoshAppAuthPromptClass *klass)
       "Grant label",
       "The auth dialog's grant access button label",
       "",
-      G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
 
   props[PROP_DENY_LABEL] =
     g_param_spec_string (
@@ -379,7 +397,7 @@ phosh_app_auth_prompt_class_init (PhoshAppAuthPromptClass *klass)
       "Deny label",
       "The auth dialog's deny access button label",
       "",
-      G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
 
   props[PROP_OFFER_REMEMBER] =
     g_param_spec_boolean (
@@ -387,7 +405,7 @@ phosh_app_auth_prompt_class_init (PhoshAppAuthPromptClass *klass)
       "Offer Remember",
       "Whether to offer to remember the auth decision result",
       FALSE,
-      G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
 
   props[PROP_CHOICES] =
     g_param_spec_variant (
@@ -396,7 +414,7 @@ phosh_app_auth_prompt_class_init (PhoshAppAuthPromptClass *klass)
       "The dialogs shown permissions and their possible values",
       G_VARIANT_TYPE (PHOSH_APP_AUTH_PROMPT_CHOICES_FORMAT),
       NULL,
-      G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
 
   g_object_class_install_properties (object_class, PROP_LAST_PROP, props);
 
@@ -454,6 +472,53 @@ phosh_app_auth_prompt_new (GIcon      *icon,
                        NULL);
 }
 
+/**
+ * phosh_app_auth_prompt_set_request:
+ * @self: The prompt
+ * @icon:(nullable): The icon
+ * @title: The title
+ * @subtitle: The subtitle
+ * @body: The body
+ * @grant_label:(nullable): The label of the grant button
+ * @deny_label:(nullable): The label of the deny button
+ * @offer_remember: Whether to offer to remember the decision
+ * @choices:(nullable): The choices
+ *
+ * Reset the prompt and fill it with a new request. Use together with
+ * [method@SystemModalDialog.set_reusable] to show several requests in
+ * a row without rebuilding the dialog.
+ */
+void
+phosh_app_auth_prompt_set_request (PhoshAppAuthPrompt *self,
+                                   GIcon              *icon,
+                                   const char         *title,
+                                   const char         *subtitle,
+                                   const char         *body,
+                                   const char         *grant_label,
+                                   const char         *deny_label,
+                                   gboolean            offer_remember,
+                                   GVariant           *choices)
+{
+  g_return_if_fail (PHOSH_IS_APP_AUTH_PROMPT (self));
+
+  self->grant_access = FALSE;
+  self->remember = FALSE;
+  gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (self->checkbtn_remember), FALSE);
+
+  g_object_set (self,
+                "icon", icon,
+                "title", title,
+                "subtitle", subtitle,
+                "body", body,
+                "grant-label", grant_label,
+                "deny-label", deny_label,
+                "offer-remember", offer_remember,
+                "choices", choices,
+                NULL);
+  gtk_widget_grab_default (self->btn_grant);
+}
+
+
 gboolean
 phosh_app_auth_prompt_get_grant_access (GtkWidget *self)
 {
@@ -463,6 +528,16 @@ phosh_app_auth_prompt_get_grant_access (GtkWidget *self)
 }
 
 
+
+gboolean
+phosh_app_auth_prompt_get_remember (GtkWidget *self)
+{
+  g_return_val_if_fail (PHOSH_IS_APP_AUTH_PROMPT (self), FALSE);
+
+  return PHOSH_APP_AUTH_PROMPT (self)->remember;
+}
+
+
 GVariant* phosh_app_auth_prompt_get_selected_choices (GtkWidget *self)
 {
   GVariantBuilder builder;
@@ -26,6 +26,15 @@ GtkWidget *phosh_app_auth_prompt_new (GIcon *icon,
                                       const char *deny_label,
                                       gboolean offer_remember,
                                       GVariant *choices);
+void     phosh_app_auth_prompt_set_request (PhoshAppAuthPrompt *self,
+                                            GIcon              *icon,
+                                            const char         *title,
+                                            const char         *subtitle,
+                                            const char         *body,
+                                            const char         *grant_label,
+                                            const char         *deny_label,
+                                            gboolean            offer_remember,
+                                            GVariant           *choices);
 gboolean phosh_app_auth_prompt_get_grant_access (GtkWidget *self);
 GVariant* phosh_app_auth_prompt_get_selected_choices (GtkWidget *self);
 gboolean phosh_app_auth_prompt_get_remember (GtkWidget *self);
@@ -11,6 +11,7 @@
 #include "app-grid-button.h"
 #include "clamp.h"
 #include "fading-label.h"
+#include "icon-cache.h"
 #include "metainfo-cache.h"
 #include "phosh-enums.h"
 #include "favorite-list-model.h"
@@ -35,10 +36,12 @@ struct _PhoshAppGridButtonPrivate {
   gulong favorite_changed_watcher;
 
   GtkWidget             *icon;
+  GCancellable          *icon_cancel;
   GtkWidget             *popover;
   GtkGesture            *long_gesture;
   GtkGesture            *right_gesture;
 
+  /* Context menu, built on first use */
   GMenu      *menu;
   GMenu      *actions;
   GMenu      *folders;
@@ -115,6 +118,20 @@ phosh_app_grid_button_get_property (GObject    *object,
 }
 
 
+static void
+phosh_app_grid_button_dispose (GObject *object)
+{
+  PhoshAppGridButton *self = PHOSH_APP_GRID_BUTTON (object);
+  PhoshAppGridButtonPrivate *priv = phosh_app_grid_button_get_instance_private (self);
+
+  g_cancellable_cancel (priv->icon_cancel);
+  g_clear_object (&priv->icon_cancel);
+  g_clear_pointer (&priv->popover, gtk_widget_destroy);
+
+  G_OBJECT_CLASS (phosh_app_grid_button_parent_class)->dispose (object);
+}
+
+
 static void
 phosh_app_grid_button_finalize (GObject *object)
 {
@@ -124,6 +141,7 @@ phosh_app_grid_button_finalize (GObject *object)
   g_clear_object (&priv->info);
   g_clear_object (&priv->menu);
   g_clear_object (&priv->actions);
+  g_clear_object (&priv->folders);
   g_clear_object (&priv->action_map);
   g_clear_object (&priv->folder_info);
 
@@ -172,6 +190,71 @@ populate_folders_menu (PhoshAppGridButton *self)
 }
 
 
+static void
+populate_actions_menu (PhoshAppGridButton *self)
+{
+  PhoshAppGridButtonPrivate *priv = phosh_app_grid_button_get_instance_private (self);
+  const char *const *actions = NULL;
+  int i = 0;
+
+  g_menu_remove_all (priv->actions);
+
+  if (!G_IS_DESKTOP_APP_INFO (priv->info))
+    return;
+
+  actions = g_desktop_app_info_list_actions (G_DESKTOP_APP_INFO (priv->info));
+
+  /*
+   * So the dummy GAppInfo for the tests is (for reasons known only to gio)
+   * actually a GDesktopAppInfo rather than something like GDummyAppInfo,
+   * this means that guarding this block with G_IS_DESKTOP_APP_INFO
+   * doesn't actually help much. This seems to surprise even gio as instead
+   * of always returning at least an empty array (as the API promises) it
+   * returns NULL
+   *
+   * tl;dr: we do (actions && actions[i]) instead of (actions[i]) otherwise
+   *        the tests explode because of a condition that can only exist in
+   *        the tests
+   */
+
+  while (actions && actions[i]) {
+    g_autofree char *detailed_action = NULL;
+    g_autofree char *label = NULL;
+
+    detailed_action = g_strdup_printf ("app-btn.action::%s", actions[i]);
+
+    label = g_desktop_app_info_get_action_name (G_DESKTOP_APP_INFO (priv->info),
+                                                actions[i]);
+
+    g_menu_append (priv->actions, label, detailed_action);
+
+    i++;
+  }
+}
+
+/*
+ * Most buttons never show their context menu so only build the
+ * popover and its menu model when it's requested the first time.
+ */
+static void
+ensure_popover (PhoshAppGridButton *self)
+{
+  PhoshAppGridButtonPrivate *priv = phosh_app_grid_button_get_instance_private (self);
+  g_autoptr (GtkBuilder) builder = NULL;
+
+  if (priv->popover)
+    return;
+
+  builder = gtk_builder_new_from_resource ("/mobi/phosh/ui/app-grid-button-menu.ui");
+  priv->menu = g_object_ref (G_MENU (gtk_builder_get_object (builder, "menu")));
+  priv->actions = g_object_ref (G_MENU (gtk_builder_get_object (builder, "actions")));
+  priv->folders = g_object_ref (G_MENU (gtk_builder_get_object (builder, "folders")));
+
+  priv->popover = gtk_popover_new_from_model (GTK_WIDGET (self), G_MENU_MODEL (priv->menu));
+  populate_actions_menu (self);
+}
+
+
 static void
 context_menu (GtkWidget *widget,
               GdkEvent  *event)
@@ -179,6 +262,8 @@ context_menu (GtkWidget *widget,
   PhoshAppGridButton *self = PHOSH_APP_GRID_BUTTON (widget);
   PhoshAppGridButtonPrivate *priv = phosh_app_grid_button_get_instance_private (self);
 
+  ensure_popover (self);
+
   g_menu_remove_all (priv->folders);
   if (!priv->is_favorite && priv->folder_info == NULL)
     populate_folders_menu (self);
@@ -223,6 +308,7 @@ phosh_app_grid_button_class_init (PhoshAppGridButtonClass *klass)
 
   object_class->set_property = phosh_app_grid_button_set_property;
   object_class->get_property = phosh_app_grid_button_get_property;
+  object_class->dispose = phosh_app_grid_button_dispose;
   object_class->finalize = phosh_app_grid_button_finalize;
 
   props[PROP_APP_INFO] =
@@ -282,13 +368,9 @@ phosh_app_grid_button_class_init (PhoshAppGridButtonClass *klass)
   gtk_widget_class_set_template_from_resource (widget_class, "/mobi/phosh/ui/app-grid-button.ui");
 
   gtk_widget_class_bind_template_child_private (widget_class, PhoshAppGridButton, icon);
-  gtk_widget_class_bind_template_child_private (widget_class, PhoshAppGridButton, popover);
 
   gtk_widget_class_bind_template_child_private (widget_class, PhoshAppGridButton, long_gesture);
   gtk_widget_class_bind_template_child_private (widget_class, PhoshAppGridButton, right_gesture);
-  gtk_widget_class_bind_template_child_private (widget_class, PhoshAppGridButton, menu);
-  gtk_widget_class_bind_template_child_private (widget_class, PhoshAppGridButton, actions);
-  gtk_widget_class_bind_template_child_private (widget_class, PhoshAppGridButton, folders);
 
   gtk_widget_class_bind_template_callback (widget_class, on_long_pressed);
   gtk_widget_class_bind_template_callback (widget_class, on_right_pressed);
@@ -660,10 +742,6 @@ phosh_app_grid_button_init (PhoshAppGridButton *self)
   g_type_ensure (PHOSH_TYPE_FADING_LABEL);
 
   gtk_widget_init_template (GTK_WIDGET (self));
-
-  gtk_popover_bind_model (GTK_POPOVER (priv->popover),
-                          G_MENU_MODEL (priv->menu),
-                          NULL);
 }
 
 
@@ -686,6 +764,56 @@ phosh_app_grid_button_new_favorite (GAppInfo *info)
 }
 
 
+static void
+on_icon_loaded (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+  PhoshAppGridButton *self;
+  PhoshAppGridButtonPrivate *priv;
+  g_autoptr (GIcon) icon = NULL;
+  g_autoptr (GError) err = NULL;
+
+  if (!phosh_icon_cache_load_finish (PHOSH_ICON_CACHE (source_object), res, &err) &&
+      g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+    return;
+  }
+
+  self = PHOSH_APP_GRID_BUTTON (user_data);
+  priv = phosh_app_grid_button_get_instance_private (self);
+  g_clear_object (&priv->icon_cancel);
+
+  /* Icon is rendered now so this doesn't block */
+  icon = phosh_util_get_app_icon (priv->info);
+  gtk_image_set_from_gicon (GTK_IMAGE (priv->icon), icon, -1);
+}
+
+
+static void
+update_icon (PhoshAppGridButton *self)
+{
+  PhoshAppGridButtonPrivate *priv = phosh_app_grid_button_get_instance_private (self);
+  PhoshIconCache *icon_cache = phosh_icon_cache_get_default ();
+  g_autoptr (GIcon) icon = phosh_util_get_app_icon (priv->info);
+  int size = gtk_image_get_pixel_size (GTK_IMAGE (priv->icon));
+  int scale = gtk_widget_get_scale_factor (GTK_WIDGET (self));
+
+  if (phosh_icon_cache_peek (icon_cache, icon, size, scale)) {
+    gtk_image_set_from_gicon (GTK_IMAGE (priv->icon), icon, -1);
+    return;
+  }
+
+  /* Render off the main thread, the image keeps its size meanwhile */
+  gtk_image_clear (GTK_IMAGE (priv->icon));
+  priv->icon_cancel = g_cancellable_new ();
+  phosh_icon_cache_load_async (icon_cache,
+                               icon,
+                               size,
+                               scale,
+                               priv->icon_cancel,
+                               on_icon_loaded,
+                               self);
+}
+
+
 static void
 favorites_changed (GListModel         *list,
                    guint               position,
@@ -725,7 +853,6 @@ phosh_app_grid_button_set_app_info (PhoshAppGridButton *self,
 {
   PhoshFavoriteListModel *list = NULL;
   PhoshAppGridButtonPrivate *priv;
-  GIcon *icon;
   const char *name;
 
   g_return_if_fail (PHOSH_IS_APP_GRID_BUTTON (self));
@@ -737,8 +864,8 @@ phosh_app_grid_button_set_app_info (PhoshAppGridButton *self,
     return;
 
   g_clear_object (&priv->info);
-
-  g_menu_remove_all (priv->actions);
+  g_cancellable_cancel (priv->icon_cancel);
+  g_clear_object (&priv->icon_cancel);
 
   list = phosh_favorite_list_model_get_default ();
 
@@ -756,52 +883,9 @@ phosh_app_grid_button_set_app_info (PhoshAppGridButton *self,
     name = g_app_info_get_name (G_APP_INFO (priv->info));
     phosh_app_grid_base_button_set_label (PHOSH_APP_GRID_BASE_BUTTON (self), name);
 
-    icon = g_app_info_get_icon (priv->info);
-    if (G_UNLIKELY (icon == NULL)) {
-      gtk_image_set_from_icon_name (GTK_IMAGE (priv->icon), PHOSH_APP_UNKNOWN_ICON, -1);
-    } else {
-      if (G_IS_THEMED_ICON (icon)) {
-        g_themed_icon_append_name (G_THEMED_ICON (icon),
-                                   PHOSH_APP_UNKNOWN_ICON);
-      }
-      gtk_image_set_from_gicon (GTK_IMAGE (priv->icon), icon, -1);
-    }
+    update_icon (self);
 
     gtk_widget_set_sensitive (GTK_WIDGET (self), TRUE);
-
-    if (G_IS_DESKTOP_APP_INFO (priv->info)) {
-      const char *const *actions = NULL;
-      int i = 0;
-
-      actions = g_desktop_app_info_list_actions (G_DESKTOP_APP_INFO (priv->info));
-
-      /*
-       * So the dummy GAppInfo for the tests is (for reasons known only to gio)
-       * actually a GDesktopAppInfo rather than something like GDummyAppInfo,
-       * this means that guarding this block with G_IS_DESKTOP_APP_INFO
-       * doesn't actually help much. This seems to surprise even gio as instead
-       * of always returning at least an empty array (as the API promises) it
-       * returns NULL
-       *
-       * tl;dr: we do (actions && actions[i]) instead of (actions[i]) otherwise
-       *        the tests explode because of a condition that can only exist in
-       *        the tests
-       */
-
-      while (actions && actions[i]) {
-        g_autofree char *detailed_action = NULL;
-        g_autofree char *label = NULL;
-
-        detailed_action = g_strdup_printf ("app-btn.action::%s", actions[i]);
-
-        label = g_desktop_app_info_get_action_name (G_DESKTOP_APP_INFO (priv->info),
-                                                    actions[i]);
-
-        g_menu_append (priv->actions, label, detailed_action);
-
-        i++;
-      }
-    }
   } else {
     phosh_app_grid_base_button_set_label (PHOSH_APP_GRID_BASE_BUTTON (self), _("Application"));
     gtk_image_set_from_icon_name (GTK_IMAGE (priv->icon), PHOSH_APP_UNKNOWN_ICON, -1);
@@ -809,6 +893,9 @@ phosh_app_grid_button_set_app_info (PhoshAppGridButton *self,
     gtk_widget_set_sensitive (GTK_WIDGET (self), FALSE);
   }
 
+  if (priv->popover)
+    populate_actions_menu (self);
+
   g_object_notify_by_pspec (G_OBJECT (self), props[PROP_APP_INFO]);
 }
 
@@ -10,11 +10,28 @@
 
 #include "app-grid-button.h"
 #include "app-grid-folder-button.h"
+#include "icon-cache.h"
+#include "util.h"
+
+/* app-grid-button uses 64px for its icon. The preview has two rows and
+ * two columns, with 8px for spacing. So 2x + 8 = 64. It means x = 28.
+ * But we use 24 as icons usually have a 2px padding. */
+#define PREVIEW_ICON_SIZE 24
+#define PREVIEW_SPACING 8
+#define PREVIEW_MAX_ICONS 4
+#define MAX_CACHED_PREVIEWS 64
 
 /**
  * PhoshAppGridFolderButton:
  *
  * A widget to display the apps in a folder.
+ *
+ * The preview of the folder's first apps is rendered into a single
+ * surface once the button is drawn the first time, so folders that
+ * aren't scrolled into view don't cost icon lookups. Surfaces are
+ * shared between buttons showing the same apps and dropped when the
+ * icon theme changes. Changes to the folder that don't affect the
+ * apps shown in the preview don't rerender it.
  */
 
 enum {
@@ -34,9 +51,15 @@ struct _PhoshAppGridFolderButton {
   PhoshAppGridBaseButton parent;
 
   PhoshFolderInfo       *folder_info;
-  GtkGrid               *grid;
+  GtkImage              *preview;
+  /* The apps and scale the preview shows, NULL if not built */
+  char                  *preview_key;
+  guint                  build_id;
 };
 
+/* key: apps and scale → cairo_surface_t */
+static GHashTable *previews;
+
 G_DEFINE_TYPE (PhoshAppGridFolderButton, phosh_app_grid_folder_button, PHOSH_TYPE_APP_GRID_BASE_BUTTON);
 
 
@@ -86,43 +109,177 @@ on_activated_cb (PhoshAppGridFolderButton *self)
 
 
 static void
-build_2x2_grid_icon (PhoshAppGridFolderButton *self)
+on_previews_icon_theme_changed (GtkIconTheme *icon_theme)
 {
-  GListModel *apps;
-  g_autoptr (GAppInfo) app_info = NULL;
-  GIcon *icon;
+  g_hash_table_remove_all (previews);
+}
 
-  gtk_grid_remove_row (self->grid, 1);
-  gtk_grid_remove_row (self->grid, 0);
 
-  apps = G_LIST_MODEL (phosh_folder_info_get_app_infos (self->folder_info));
+static GHashTable *
+get_previews (void)
+{
+  if (previews == NULL) {
+    previews = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                      (GDestroyNotify) cairo_surface_destroy);
+    g_signal_connect (gtk_icon_theme_get_default (),
+                      "changed",
+                      G_CALLBACK (on_previews_icon_theme_changed),
+                      NULL);
+  }
+
+  return previews;
+}
+
+
+static char *
+get_preview_key (GListModel *apps, int scale)
+{
+  g_autoptr (GString) key = g_string_new (NULL);
+
+  for (guint i = 0; i < MIN (PREVIEW_MAX_ICONS, g_list_model_get_n_items (apps)); i++) {
+    g_autoptr (GAppInfo) app_info = g_list_model_get_item (apps, i);
+    const char *id = g_app_info_get_id (app_info) ?: g_app_info_get_name (app_info);
+
+    g_string_append_printf (key, "%s;", id);
+  }
+  g_string_append_printf (key, ":%d", scale);
+
+  return g_string_free (g_steal_pointer (&key), FALSE);
+}
+
 
-  for (int i = 0;
-       i < 4 && (app_info = g_list_model_get_item (apps, i)) != NULL;
-       i++) {
-    GtkWidget *image = NULL;
-    app_info = g_list_model_get_item (apps, i);
-
-    icon = g_app_info_get_icon (app_info);
-
-    if (icon == NULL) {
-      image = gtk_image_new_from_icon_name (PHOSH_APP_UNKNOWN_ICON, -1);
-    } else {
-      if (G_IS_THEMED_ICON (icon)) {
-        g_themed_icon_append_name (G_THEMED_ICON (icon),
-                                   PHOSH_APP_UNKNOWN_ICON);
-      }
-      image = gtk_image_new_from_gicon (icon, -1);
-    }
-
-    /* app-grid-button uses 64px for its icon.
-     * Our grid has two rows and two columns, with 8px for spacing.
-     * So 2x + 8 = 64.
-     * It means x = 28. But we use 24 as icons usually have a 2px padding. */
-    gtk_image_set_pixel_size (GTK_IMAGE (image), 24);
-    gtk_widget_set_visible (image, TRUE);
-    gtk_grid_attach (self->grid, image, i % 2, i >= 2, 1, 1);
+static cairo_surface_t *
+render_preview (GListModel *apps, int scale)
+{
+  PhoshIconCache *icon_cache = phosh_icon_cache_get_default ();
+  cairo_surface_t *surface;
+  cairo_t *cr;
+  guint n_icons, cols, rows;
+  int width, height;
+
+  n_icons = MIN (PREVIEW_MAX_ICONS, g_list_model_get_n_items (apps));
+  /* Like a 2x2 grid that only has as many rows and columns as needed */
+  cols = MAX (MIN (n_icons, 2), 1);
+  rows = n_icons > 2 ? 2 : 1;
+
+  width = cols * (PREVIEW_ICON_SIZE + PREVIEW_SPACING) - PREVIEW_SPACING;
+  height = rows * (PREVIEW_ICON_SIZE + PREVIEW_SPACING) - PREVIEW_SPACING;
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width * scale, height * scale);
+  cairo_surface_set_device_scale (surface, scale, scale);
+  cr = cairo_create (surface);
+
+  for (guint i = 0; i < n_icons; i++) {
+    g_autoptr (GAppInfo) app_info = g_list_model_get_item (apps, i);
+    g_autoptr (GIcon) icon = phosh_util_get_app_icon (app_info);
+    g_autoptr (GdkPixbuf) pixbuf = NULL;
+    cairo_surface_t *icon_surface;
+    GtkIconInfo *info;
+
+    info = phosh_icon_cache_lookup (icon_cache, icon, PREVIEW_ICON_SIZE, scale);
+    if (info)
+      pixbuf = gtk_icon_info_load_icon (info, NULL);
+    if (pixbuf == NULL)
+      continue;
+
+    icon_surface = gdk_cairo_surface_create_from_pixbuf (pixbuf, scale, NULL);
+    cairo_set_source_surface (cr,
+                              icon_surface,
+                              (i % 2) * (PREVIEW_ICON_SIZE + PREVIEW_SPACING),
+                              (i / 2) * (PREVIEW_ICON_SIZE + PREVIEW_SPACING));
+    cairo_paint (cr);
+    cairo_surface_destroy (icon_surface);
   }
+
+  cairo_destroy (cr);
+  return surface;
+}
+
+
+static void
+build_preview (PhoshAppGridFolderButton *self)
+{
+  GListModel *apps = G_LIST_MODEL (phosh_folder_info_get_app_infos (self->folder_info));
+  int scale = gtk_widget_get_scale_factor (GTK_WIDGET (self));
+  g_autofree char *key = get_preview_key (apps, scale);
+  GHashTable *cache = get_previews ();
+  cairo_surface_t *surface;
+
+  /* Only the first icons are shown, other changes don't matter */
+  if (g_strcmp0 (key, self->preview_key) == 0)
+    return;
+
+  surface = g_hash_table_lookup (cache, key);
+  if (surface == NULL) {
+    g_debug ("Rendering folder preview %s", key);
+    surface = render_preview (apps, scale);
+    /* Folders are few, this only kicks in with lots of folder content churn */
+    if (g_hash_table_size (cache) >= MAX_CACHED_PREVIEWS)
+      g_hash_table_remove_all (cache);
+    g_hash_table_insert (cache, g_strdup (key), surface);
+  }
+
+  gtk_image_set_from_surface (self->preview, surface);
+  g_free (self->preview_key);
+  self->preview_key = g_steal_pointer (&key);
+}
+
+
+static gboolean
+on_build_preview_idle (gpointer data)
+{
+  PhoshAppGridFolderButton *self = PHOSH_APP_GRID_FOLDER_BUTTON (data);
+
+  self->build_id = 0;
+  build_preview (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static void
+queue_build_preview (PhoshAppGridFolderButton *self)
+{
+  if (self->build_id)
+    return;
+
+  self->build_id = g_idle_add (on_build_preview_idle, self);
+  g_source_set_name_by_id (self->build_id, "[phosh] build folder preview");
+}
+
+
+static void
+on_apps_changed (PhoshAppGridFolderButton *self)
+{
+  /* Not shown yet, will be built on first draw */
+  if (self->preview_key == NULL)
+    return;
+
+  queue_build_preview (self);
+}
+
+
+static void
+invalidate_preview (PhoshAppGridFolderButton *self)
+{
+  if (self->preview_key == NULL)
+    return;
+
+  g_clear_pointer (&self->preview_key, g_free);
+  queue_build_preview (self);
+}
+
+
+static gboolean
+phosh_app_grid_folder_button_draw (GtkWidget *widget, cairo_t *cr)
+{
+  PhoshAppGridFolderButton *self = PHOSH_APP_GRID_FOLDER_BUTTON (widget);
+
+  /* Only drawn when scrolled into view so build the preview now */
+  if (self->preview_key == NULL)
+    queue_build_preview (self);
+
+  return GTK_WIDGET_CLASS (phosh_app_grid_folder_button_parent_class)->draw (widget, cr);
 }
 
 
@@ -131,6 +288,8 @@ phosh_app_grid_folder_button_dispose (GObject *object)
 {
   PhoshAppGridFolderButton *self = PHOSH_APP_GRID_FOLDER_BUTTON (object);
 
+  g_clear_handle_id (&self->build_id, g_source_remove);
+  g_clear_pointer (&self->preview_key, g_free);
   g_clear_object (&self->folder_info);
 
   G_OBJECT_CLASS (phosh_app_grid_folder_button_parent_class)->dispose (object);
@@ -147,9 +306,11 @@ phosh_app_grid_folder_button_constructed (GObject *object)
 
   apps = G_LIST_MODEL (phosh_folder_info_get_app_infos (self->folder_info));
 
-  g_signal_connect_object (apps, "items-changed", G_CALLBACK (build_2x2_grid_icon), self, G_CONNECT_SWAPPED);
+  g_signal_connect_object (apps, "items-changed", G_CALLBACK (on_apps_changed), self, G_CONNECT_SWAPPED);
+  g_signal_connect_object (gtk_icon_theme_get_default (), "changed",
+                           G_CALLBACK (invalidate_preview), self, G_CONNECT_SWAPPED);
+  g_signal_connect (self, "notify::scale-factor", G_CALLBACK (invalidate_preview), NULL);
   g_object_bind_property (self->folder_info, "name", self, "label", G_BINDING_SYNC_CREATE);
-  build_2x2_grid_icon (self);
 }
 
 
@@ -164,6 +325,8 @@ phosh_app_grid_folder_button_class_init (PhoshAppGridFolderButtonClass *klass)
   object_class->dispose = phosh_app_grid_folder_button_dispose;
   object_class->constructed = phosh_app_grid_folder_button_constructed;
 
+  widget_class->draw = phosh_app_grid_folder_button_draw;
+
   /**
    * PhoshAppGridFolderButton:folder-info:
    *
@@ -187,7 +350,7 @@ phosh_app_grid_folder_button_class_init (PhoshAppGridFolderButtonClass *klass)
   gtk_widget_class_set_template_from_resource (widget_class, "/mobi/phosh/ui/app-grid-folder-button.ui");
 
   gtk_widget_class_bind_template_callback (widget_class, on_activated_cb);
-  gtk_widget_class_bind_template_child (widget_class, PhoshAppGridFolderButton, grid);
+  gtk_widget_class_bind_template_child (widget_class, PhoshAppGridFolderButton, preview);
 
   gtk_widget_class_set_css_name (widget_class, "phosh-app-grid-folder-button");
 }
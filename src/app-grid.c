@@ -14,7 +14,12 @@
 #include "app-grid-folder-button.h"
 #include "app-list-model.h"
 #include "favorite-list-model.h"
+#include "icon-cache.h"
+#include "memory-stats.h"
+#include "settings-batch.h"
 #include "shell-priv.h"
+#include "trace.h"
+#include "trace-buffer.h"
 #include "util.h"
 
 #include "gtk-list-models/gtksortlistmodel.h"
@@ -25,7 +30,15 @@
 #define ACTIVE_SEARCH_CLASS "search-active"
 
 #define SEARCH_DEBOUNCE 350
+/* Searching less often while typing saves wakeups when saving power */
+#define SEARCH_DEBOUNCE_POWER_SAVER 700
 #define DEFAULT_GTK_DEBOUNCE 150
+/* Keep enough buttons around to refill a screen of search results */
+#define BUTTON_POOL_SIZE 64
+/* Must match the icon's pixel-size in app-grid-button.ui */
+#define APP_ICON_SIZE 64
+/* Roughly the apps visible without scrolling */
+#define FIRST_PAGE_APPS 24
 
 enum {
   PROP_0,
@@ -42,6 +55,7 @@ static guint signals[N_SIGNALS] = { 0 };
 
 typedef struct _PhoshAppGridPrivate PhoshAppGridPrivate;
 struct _PhoshAppGridPrivate {
+  GtkSortListModel   *sorted;
   GtkFilterListModel *model;
 
   GtkWidget *deck;
@@ -66,12 +80,20 @@ struct _PhoshAppGridPrivate {
   GListModel      *folder_model;
 
   char *search_string;
+  /* The search the model is currently filtered for */
+  char *applied_search;
   gboolean filter_adaptive;
   GSettings *settings;
+  PhoshSettingsBatch *settings_batch;
   GStrv force_adaptive;
   GSimpleActionGroup *actions;
   PhoshAppFilterModeFlags filter_mode;
   guint debounce;
+  /* When the first search change not yet applied happened */
+  gint64 search_changed_time;
+
+  /* Launcher buttons removed from the grid, for reuse */
+  GPtrArray *button_pool;
 };
 
 G_DEFINE_TYPE_WITH_PRIVATE (PhoshAppGrid, phosh_app_grid, GTK_TYPE_BOX)
@@ -197,7 +219,7 @@ get_app_info_index (PhoshAppGrid *self, GAppInfo *app_info)
   PhoshAppGridPrivate *priv = phosh_app_grid_get_instance_private (self);
 
   for (int idx = 0;; idx++) {
-    g_autoptr (GAppInfo) info = g_list_model_get_item (G_LIST_MODEL (priv->model), idx);
+    g_autoptr (GAppInfo) info = g_list_model_get_item (G_LIST_MODEL (priv->sorted), idx);
 
     if (info == NULL)
       return -1;
@@ -240,15 +262,38 @@ folder_launched_cb (GtkWidget       *widget,
 }
 
 
+static PhoshUtilAppMatch
+get_search_score (GAppInfo *info, const char *search)
+{
+  /* Folders show up because some of their apps match */
+  if (PHOSH_IS_FOLDER_INFO (info))
+    return PHOSH_UTIL_APP_MATCH_KEYWORD;
+
+  return phosh_util_score_app_info (info, search);
+}
+
+
 static int
 sort_apps (gconstpointer a, gconstpointer b, gpointer data)
 {
+  PhoshAppGrid *self = PHOSH_APP_GRID (data);
+  PhoshAppGridPrivate *priv = phosh_app_grid_get_instance_private (self);
   const char *empty = "";
   GAppInfo *info1 = G_APP_INFO (a);
   GAppInfo *info2 = G_APP_INFO (b);
+  g_autofree char *s1 = NULL, *s2 = NULL;
 
-  g_autofree char *s1 = g_utf8_casefold (g_app_info_get_name (info1), -1);
-  g_autofree char *s2 = g_utf8_casefold (g_app_info_get_name (info2), -1);
+  /* Best matches first while searching */
+  if (!gm_str_is_null_or_empty (priv->search_string)) {
+    PhoshUtilAppMatch score1 = get_search_score (info1, priv->search_string);
+    PhoshUtilAppMatch score2 = get_search_score (info2, priv->search_string);
+
+    if (score1 != score2)
+      return score2 - score1;
+  }
+
+  s1 = g_utf8_casefold (g_app_info_get_name (info1), -1);
+  s2 = g_utf8_casefold (g_app_info_get_name (info2), -1);
 
   return g_utf8_collate (s1 ?: empty, s2 ?: empty);
 }
@@ -275,9 +320,9 @@ update_filter_adaptive_button (PhoshAppGrid *self)
 
 
 static void
-on_filter_setting_changed (PhoshAppGrid *self,
-                           GParamSpec   *pspec,
-                           gpointer     *unused)
+on_filter_setting_changed (PhoshAppGrid       *self,
+                           GStrv               keys,
+                           PhoshSettingsBatch *batch)
 {
   PhoshAppGridPrivate *priv;
   gboolean show;
@@ -389,18 +434,101 @@ toggle_favorites_revealer (PhoshAppGrid *self)
 }
 
 
+static void
+prefetch_icons (PhoshAppGrid *self)
+{
+  PhoshAppGridPrivate *priv = phosh_app_grid_get_instance_private (self);
+  PhoshIconCache *icon_cache = phosh_icon_cache_get_default ();
+  int scale;
+
+  /* Only once we know the scale icons are rendered at */
+  if (!gtk_widget_get_realized (GTK_WIDGET (self)))
+    return;
+
+  scale = gtk_widget_get_scale_factor (GTK_WIDGET (self));
+  phosh_icon_cache_prefetch_apps (icon_cache,
+                                  G_LIST_MODEL (phosh_favorite_list_model_get_default ()),
+                                  G_MAXUINT,
+                                  APP_ICON_SIZE,
+                                  scale);
+  phosh_icon_cache_prefetch_apps (icon_cache,
+                                  G_LIST_MODEL (priv->sorted),
+                                  FIRST_PAGE_APPS,
+                                  APP_ICON_SIZE,
+                                  scale);
+}
+
+
 static void
 favorites_changed (GListModel *list, guint pos, guint removed, guint added, PhoshAppGrid *self)
 {
   PhoshAppGridPrivate *priv = phosh_app_grid_get_instance_private (self);
 
   toggle_favorites_revealer (self);
+  prefetch_icons (self);
 
   /* We don't show favorites in the main list, filter them out */
   gtk_filter_list_model_refilter (priv->model);
 }
 
 
+static void
+on_launcher_child_destroy (PhoshAppGrid *self, GtkWidget *child)
+{
+  PhoshAppGridPrivate *priv = phosh_app_grid_get_instance_private (self);
+  GtkWidget *btn = gtk_bin_get_child (GTK_BIN (child));
+
+  /* Grid is going away */
+  if (priv->button_pool == NULL || !PHOSH_IS_APP_GRID_BUTTON (btn))
+    return;
+
+  if (priv->button_pool->len >= BUTTON_POOL_SIZE)
+    return;
+
+  /* Rescue the button before the flow box child destroys it */
+  g_ptr_array_add (priv->button_pool, g_object_ref (btn));
+  gtk_container_remove (GTK_CONTAINER (child), btn);
+  phosh_app_grid_button_set_app_info (PHOSH_APP_GRID_BUTTON (btn), NULL);
+}
+
+
+static void
+on_launcher_parent_set (PhoshAppGrid *self, GtkWidget *old_parent, GtkWidget *btn)
+{
+  GtkWidget *parent = gtk_widget_get_parent (btn);
+
+  if (!GTK_IS_FLOW_BOX_CHILD (parent))
+    return;
+
+  g_signal_connect_object (parent, "destroy",
+                           G_CALLBACK (on_launcher_child_destroy), self,
+                           G_CONNECT_SWAPPED);
+}
+
+
+static GtkWidget *
+get_app_launcher (PhoshAppGrid *self, GAppInfo *info)
+{
+  PhoshAppGridPrivate *priv = phosh_app_grid_get_instance_private (self);
+  GtkWidget *btn;
+
+  if (priv->button_pool->len) {
+    btn = g_ptr_array_steal_index_fast (priv->button_pool, priv->button_pool->len - 1);
+    phosh_app_grid_button_set_app_info (PHOSH_APP_GRID_BUTTON (btn), info);
+    /* The flow box takes over our full reference */
+    return btn;
+  }
+
+  btn = phosh_app_grid_button_new (info);
+  g_signal_connect (btn, "app-launched", G_CALLBACK (app_launched_cb), self);
+  g_signal_connect_object (btn, "parent-set",
+                           G_CALLBACK (on_launcher_parent_set), self,
+                           G_CONNECT_SWAPPED);
+
+  return btn;
+}
+
+
 static GtkWidget *
 create_launcher (gpointer item, gpointer self)
 {
@@ -410,8 +538,7 @@ create_launcher (gpointer item, gpointer self)
     btn = phosh_app_grid_folder_button_new_from_folder_info (item);
     g_signal_connect (btn, "folder-launched", G_CALLBACK (folder_launched_cb), self);
   } else {
-    btn = phosh_app_grid_button_new (G_APP_INFO (item));
-    g_signal_connect (btn, "app-launched", G_CALLBACK (app_launched_cb), self);
+    btn = get_app_launcher (PHOSH_APP_GRID (self), G_APP_INFO (item));
   }
 
   gtk_widget_set_visible (btn, TRUE);
@@ -424,12 +551,12 @@ static void
 phosh_app_grid_init (PhoshAppGrid *self)
 {
   PhoshAppGridPrivate *priv = phosh_app_grid_get_instance_private (self);
-  GtkSortListModel *sorted;
   PhoshFavoriteListModel *favorites;
   g_autoptr (GAction) action = NULL;
 
   gtk_widget_init_template (GTK_WIDGET (self));
 
+  priv->button_pool = g_ptr_array_new_with_free_func (g_object_unref);
   favorites = phosh_favorite_list_model_get_default ();
 
   gtk_flow_box_bind_model (GTK_FLOW_BOX (priv->favs),
@@ -442,27 +569,29 @@ phosh_app_grid_init (PhoshAppGrid *self)
                     G_CALLBACK (favorites_changed),
                     self);
 
-  /* fill the grid with apps */
-  sorted = gtk_sort_list_model_new (G_LIST_MODEL (phosh_app_list_model_get_default ()),
-                                    sort_apps,
-                                    NULL,
-                                    NULL);
-  priv->model = gtk_filter_list_model_new (G_LIST_MODEL (sorted),
+  /* fill the grid with apps, filter first so only matches get sorted */
+  priv->model = gtk_filter_list_model_new (G_LIST_MODEL (phosh_app_list_model_get_default ()),
                                            search_apps,
                                            self,
                                            NULL);
-  g_object_unref (sorted);
+  priv->sorted = gtk_sort_list_model_new (G_LIST_MODEL (priv->model),
+                                          sort_apps,
+                                          self,
+                                          NULL);
   gtk_flow_box_bind_model (GTK_FLOW_BOX (priv->apps),
-                           G_LIST_MODEL (priv->model),
+                           G_LIST_MODEL (priv->sorted),
                            create_launcher,
                            self,
                            NULL);
 
   priv->settings = g_settings_new ("sm.puri.phosh");
-  g_object_connect (priv->settings,
-                    "swapped-signal::changed::force-adaptive", on_filter_setting_changed, self,
-                    "swapped-signal::changed::app-filter-mode", on_filter_setting_changed, self,
-                    NULL);
+  /* Refilter once when both keys change */
+  priv->settings_batch = phosh_settings_batch_new (priv->settings,
+                                                   "force-adaptive",
+                                                   "app-filter-mode",
+                                                   NULL);
+  g_signal_connect_swapped (priv->settings_batch, "changed",
+                            G_CALLBACK (on_filter_setting_changed), self);
   on_filter_setting_changed (self, NULL, NULL);
 
   priv->actions = g_simple_action_group_new ();
@@ -471,6 +600,31 @@ phosh_app_grid_init (PhoshAppGrid *self)
   g_action_map_add_action (G_ACTION_MAP (priv->actions), action);
 
   toggle_favorites_revealer (self);
+
+  /* Warm up the icons so the first opening of the grid doesn't stall */
+  g_object_connect (self,
+                    "signal::realize", prefetch_icons, NULL,
+                    "signal::notify::scale-factor", prefetch_icons, NULL,
+                    NULL);
+
+  phosh_memory_stats_register ("app-grid", report_memory, self);
+}
+
+
+static void
+report_memory (gpointer data, guint64 *n_items, guint64 *bytes)
+{
+  PhoshAppGrid *self = PHOSH_APP_GRID (data);
+  PhoshAppGridPrivate *priv = phosh_app_grid_get_instance_private (self);
+  g_autoptr (GList) apps = gtk_container_get_children (GTK_CONTAINER (priv->apps));
+  g_autoptr (GList) favs = gtk_container_get_children (GTK_CONTAINER (priv->favs));
+  int scale = gtk_widget_get_scale_factor (GTK_WIDGET (self));
+
+  *n_items = g_list_length (apps) + g_list_length (favs);
+  if (priv->button_pool)
+    *n_items += priv->button_pool->len;
+  /* Each button renders an icon into an ARGB surface */
+  *bytes = *n_items * (guint64)(APP_ICON_SIZE * scale) * (APP_ICON_SIZE * scale) * 4;
 }
 
 
@@ -480,9 +634,14 @@ phosh_app_grid_dispose (GObject *object)
   PhoshAppGrid *self = PHOSH_APP_GRID (object);
   PhoshAppGridPrivate *priv = phosh_app_grid_get_instance_private (self);
 
+  phosh_memory_stats_unregister (self);
+
+  g_clear_pointer (&priv->button_pool, g_ptr_array_unref);
   g_clear_object (&priv->open_folder);
   g_clear_object (&priv->actions);
+  g_clear_object (&priv->sorted);
   g_clear_object (&priv->model);
+  g_clear_object (&priv->settings_batch);
   g_clear_object (&priv->settings);
   g_clear_handle_id (&priv->debounce, g_source_remove);
 
@@ -497,6 +656,7 @@ phosh_app_grid_finalize (GObject *object)
   PhoshAppGridPrivate *priv = phosh_app_grid_get_instance_private (self);
 
   g_clear_pointer (&priv->search_string, g_free);
+  g_clear_pointer (&priv->applied_search, g_free);
   g_strfreev (priv->force_adaptive);
 
   G_OBJECT_CLASS (phosh_app_grid_parent_class)->finalize (object);
@@ -526,6 +686,12 @@ do_search (gpointer data)
   PhoshAppGridPrivate *priv = phosh_app_grid_get_instance_private (self);
   GtkAdjustment *adjustment;
   gboolean search_active = TRUE;
+  GtkFilterListModelChange change = GTK_FILTER_LIST_MODEL_CHANGE_DIFFERENT;
+  gint64 trace_begin = PHOSH_TRACE_CURRENT_TIME;
+  gint64 start = 0;
+
+  if (phosh_trace_buffer_is_enabled (PHOSH_TRACE_CATEGORY_SEARCH))
+    start = g_get_monotonic_time ();
 
   if (gm_str_is_null_or_empty (priv->search_string)) {
     adjustment = gtk_scrolled_window_get_vadjustment (GTK_SCROLLED_WINDOW (priv->scrolled_window));
@@ -535,7 +701,32 @@ do_search (gpointer data)
 
   phosh_util_toggle_style_class (GTK_WIDGET (priv->apps), ACTIVE_SEARCH_CLASS, search_active);
   toggle_favorites_revealer (self);
-  gtk_filter_list_model_refilter (priv->model);
+
+  /* Typing more only needs to check the current matches */
+  if (search_active && phosh_util_app_search_narrows (priv->search_string, priv->applied_search))
+    change = GTK_FILTER_LIST_MODEL_CHANGE_MORE_STRICT;
+  g_free (priv->applied_search);
+  priv->applied_search = g_strdup (priv->search_string);
+
+  gtk_filter_list_model_refilter_full (priv->model, change);
+  /* Ranking depends on the search, only sorts the matches */
+  gtk_sort_list_model_resort (priv->sorted);
+
+  PHOSH_TRACE_MARK (trace_begin, "app-grid: search", "%u matches%s",
+                    g_list_model_get_n_items (G_LIST_MODEL (priv->model)),
+                    change == GTK_FILTER_LIST_MODEL_CHANGE_MORE_STRICT ? " (narrowed)" : "");
+
+  if (start) {
+    gint64 now = g_get_monotonic_time ();
+
+    phosh_trace_buffer_add (PHOSH_TRACE_CATEGORY_SEARCH, "app-grid search", start, now);
+    /* Includes the debounce */
+    if (priv->search_changed_time) {
+      phosh_trace_buffer_add (PHOSH_TRACE_CATEGORY_SEARCH, "app-grid search latency",
+                              priv->search_changed_time, now);
+    }
+  }
+  priv->search_changed_time = 0;
 
   priv->debounce = 0;
 }
@@ -572,6 +763,19 @@ on_folder_entry_activated (PhoshAppGrid *self, GtkEntry *entry)
 }
 
 
+static guint
+get_search_debounce (void)
+{
+  PhoshPowerSaverManager *manager;
+
+  manager = phosh_shell_get_power_saver_manager (phosh_shell_get_default ());
+  if (manager && phosh_power_saver_manager_get_active (manager))
+    return SEARCH_DEBOUNCE_POWER_SAVER;
+
+  return SEARCH_DEBOUNCE;
+}
+
+
 static void
 on_search_changed (GtkSearchEntry *entry,
                    PhoshAppGrid   *self)
@@ -582,13 +786,15 @@ on_search_changed (GtkSearchEntry *entry,
   g_clear_pointer (&priv->search_string, g_free);
 
   g_clear_handle_id (&priv->debounce, g_source_remove);
+  if (!priv->search_changed_time && phosh_trace_buffer_is_enabled (PHOSH_TRACE_CATEGORY_SEARCH))
+    priv->search_changed_time = g_get_monotonic_time ();
 
   if (search && *search != '\0') {
-    priv->search_string = g_utf8_casefold (search, -1);
+    priv->search_string = phosh_util_fold_search_string (search);
 
     /* GtkSearchEntry already adds 150ms of delay, but it's too little
      * so add a bit more until searching is faster and/or non-blocking */
-    priv->debounce = g_timeout_add_once (SEARCH_DEBOUNCE, do_search, self);
+    priv->debounce = g_timeout_add_once (get_search_debounce (), do_search, self);
     g_source_set_name_by_id (priv->debounce, "[phosh] debounce app grid search (search-changed)");
   } else {
     /* don't add the delay when the entry got cleared */
@@ -607,11 +813,15 @@ on_search_preedit_changed (GtkSearchEntry *entry,
   g_clear_pointer (&priv->search_string, g_free);
 
   if (preedit && *preedit != '\0')
-    priv->search_string = g_utf8_casefold (preedit, -1);
+    priv->search_string = phosh_util_fold_search_string (preedit);
 
   g_clear_handle_id (&priv->debounce, g_source_remove);
+  if (!priv->search_changed_time && phosh_trace_buffer_is_enabled (PHOSH_TRACE_CATEGORY_SEARCH))
+    priv->search_changed_time = g_get_monotonic_time ();
 
-  priv->debounce = g_timeout_add_once (SEARCH_DEBOUNCE + DEFAULT_GTK_DEBOUNCE, do_search, self);
+  priv->debounce = g_timeout_add_once (get_search_debounce () + DEFAULT_GTK_DEBOUNCE,
+                                       do_search,
+                                       self);
   g_source_set_name_by_id (priv->debounce, "[phosh] debounce app grid search (preedit-changed)");
 }
 
@@ -14,10 +14,19 @@
 
 #include "app-list-model.h"
 #include "folder-info.h"
+#include "trace.h"
+#include "util.h"
 
 #include <gmobile.h>
 
 #include <gio/gio.h>
+#include <glib/gstdio.h>
+
+/* Bump when changing the snapshot format */
+#define APP_LIST_SNAPSHOT_VERSION 1
+/* Format version, app dirs and their mtimes, ids of the shown apps */
+#define APP_LIST_SNAPSHOT_TYPE "(ua(st)as)"
+#define APP_LIST_SNAPSHOT_FILENAME "app-list.gvariant"
 
 typedef struct _PhoshAppListModelPrivate PhoshAppListModelPrivate;
 struct _PhoshAppListModelPrivate {
@@ -38,6 +47,13 @@ struct _PhoshAppListModelPrivate {
 
   GHashTable *startup_wm_class;
   GHashTable *exec_to_id;
+  /* All known apps, including hidden ones and the ones in folders */
+  GHashTable *by_id;
+  /* Resolved app-ids, NULL values for unresolvable ones */
+  GHashTable *app_id_cache;
+
+  /* The on disk snapshot matching the current set of apps */
+  GVariant   *snapshot;
 };
 
 static void list_iface_init (GListModelInterface *iface);
@@ -57,8 +73,11 @@ phosh_app_list_model_finalize (GObject *object)
 
   g_clear_pointer (&priv->startup_wm_class, g_hash_table_destroy);
   g_clear_pointer (&priv->exec_to_id, g_hash_table_destroy);
+  g_clear_pointer (&priv->by_id, g_hash_table_destroy);
+  g_clear_pointer (&priv->app_id_cache, g_hash_table_destroy);
   g_clear_object (&priv->monitor);
   g_clear_object (&priv->settings);
+  g_clear_pointer (&priv->snapshot, g_variant_unref);
 
   g_sequence_free (priv->items);
 
@@ -133,22 +152,21 @@ list_iface_init (GListModelInterface *iface)
 }
 
 
-static GList*
-filter_out_apps_in_folder (GList *apps, PhoshFolderInfo *folder_info)
+static GList *
+filter_out_apps_in_folders (GList *apps, GHashTable *in_folder)
 {
-  GList *node, *prev;
+  GList *node = apps;
 
-  /* The length of the list is always at least 2. The first element is always the `folder_info`.
-   * This makes the logic easier as otherwise we would have to check for edge-cases like first
-   * element itself part of folder etc. */
-
-  for (node = g_list_next (apps); node; node = g_list_next (node)) {
+  while (node) {
+    GList *next = g_list_next (node);
     GAppInfo *app_info = G_APP_INFO (node->data);
-    if (phosh_folder_info_contains (folder_info, app_info)) {
-      prev = g_list_previous (node);
+    const char *app_id = g_app_info_get_id (app_info);
+
+    if (!PHOSH_IS_FOLDER_INFO (app_info) && app_id && g_hash_table_contains (in_folder, app_id)) {
+      g_object_unref (app_info);
       apps = g_list_delete_link (apps, node);
-      node = prev;
     }
+    node = next;
   }
 
   return apps;
@@ -159,59 +177,384 @@ static void on_folder_children_changed (PhoshAppListModel *self);
 
 
 static void
-emit_items_changed (PhoshAppListModel *self)
+invalidate_cache (PhoshAppListModel *self)
 {
   PhoshAppListModelPrivate *priv = phosh_app_list_model_get_instance_private (self);
-  int added = g_sequence_get_length (priv->items);
-  int removed = added;
-  g_list_model_items_changed (G_LIST_MODEL (self), 0, removed, added);
+
+  priv->last.is_valid = FALSE;
+  priv->last.iter = NULL;
+  priv->last.position = 0;
+}
+
+
+static void
+on_folder_name_changed (PhoshAppListModel *self, GParamSpec *pspec, PhoshFolderInfo *folder_info)
+{
+  PhoshAppListModelPrivate *priv = phosh_app_list_model_get_instance_private (self);
+  GSequenceIter *iter = g_sequence_get_begin_iter (priv->items);
+
+  for (guint pos = 0; !g_sequence_iter_is_end (iter); pos++, iter = g_sequence_iter_next (iter)) {
+    if (g_sequence_get (iter) == folder_info) {
+      g_list_model_items_changed (G_LIST_MODEL (self), pos, 1, 1);
+      return;
+    }
+  }
+}
+
+/*
+ * The key identifying an item across app info reloads.
+ */
+static char *
+get_item_key (GAppInfo *info)
+{
+  if (PHOSH_IS_FOLDER_INFO (info)) {
+    g_autofree char *path = NULL;
+
+    g_object_get (info, "path", &path, NULL);
+    return g_strconcat ("folder:", path, NULL);
+  }
+
+  return g_strdup (g_app_info_get_id (info));
 }
 
 
 static gboolean
-items_changed (gpointer data)
+strv_equal0 (const char * const *a, const char * const *b)
+{
+  if (a == NULL || b == NULL)
+    return a == b;
+
+  return g_strv_equal (a, b);
+}
+
+static gboolean
+desktop_string_equal (GDesktopAppInfo *info1, GDesktopAppInfo *info2, const char *key)
+{
+  g_autofree char *s1 = g_desktop_app_info_get_string (info1, key);
+  g_autofree char *s2 = g_desktop_app_info_get_string (info2, key);
+
+  return g_strcmp0 (s1, s2) == 0;
+}
+
+/*
+ * Whether the reloaded app info `new` is displayed and filtered like `old`
+ * so we can keep the existing item.
+ */
+static gboolean
+item_unchanged (GAppInfo *old, GAppInfo *new)
+{
+  GDesktopAppInfo *old_desktop, *new_desktop;
+  GIcon *old_icon, *new_icon;
+
+  if (old == new)
+    return TRUE;
+
+  if (!G_IS_DESKTOP_APP_INFO (old) || !G_IS_DESKTOP_APP_INFO (new))
+    return FALSE;
+
+  old_desktop = G_DESKTOP_APP_INFO (old);
+  new_desktop = G_DESKTOP_APP_INFO (new);
+
+  if (g_strcmp0 (g_app_info_get_name (old), g_app_info_get_name (new)) ||
+      g_strcmp0 (g_app_info_get_display_name (old), g_app_info_get_display_name (new)) ||
+      g_strcmp0 (g_app_info_get_description (old), g_app_info_get_description (new)) ||
+      g_strcmp0 (g_app_info_get_commandline (old), g_app_info_get_commandline (new)) ||
+      g_strcmp0 (g_desktop_app_info_get_filename (old_desktop),
+                 g_desktop_app_info_get_filename (new_desktop)) ||
+      g_strcmp0 (g_desktop_app_info_get_startup_wm_class (old_desktop),
+                 g_desktop_app_info_get_startup_wm_class (new_desktop)) ||
+      g_strcmp0 (g_desktop_app_info_get_generic_name (old_desktop),
+                 g_desktop_app_info_get_generic_name (new_desktop)) ||
+      g_strcmp0 (g_desktop_app_info_get_categories (old_desktop),
+                 g_desktop_app_info_get_categories (new_desktop))) {
+    return FALSE;
+  }
+
+  if (!strv_equal0 (g_desktop_app_info_get_keywords (old_desktop),
+                    g_desktop_app_info_get_keywords (new_desktop))) {
+    return FALSE;
+  }
+
+  /* Used for adaptive app filtering */
+  if (!desktop_string_equal (old_desktop, new_desktop, "X-Purism-FormFactor") ||
+      !desktop_string_equal (old_desktop, new_desktop, "X-KDE-FormFactor")) {
+    return FALSE;
+  }
+
+  old_icon = g_app_info_get_icon (old);
+  new_icon = g_app_info_get_icon (new);
+  if (old_icon == NULL || new_icon == NULL)
+    return old_icon == new_icon;
+
+  return g_icon_equal (old_icon, new_icon);
+}
+
+
+typedef struct {
+  GListModel *model;
+  guint       position;
+  guint       removed;
+  guint       added;
+} PendingChange;
+
+
+static void
+pending_change_flush (PendingChange *change)
+{
+  if (change->removed == 0 && change->added == 0)
+    return;
+
+  invalidate_cache (PHOSH_APP_LIST_MODEL (change->model));
+  g_list_model_items_changed (change->model, change->position, change->removed, change->added);
+  change->removed = change->added = 0;
+}
+
+/*
+ * Record that at `position` `removed` items got replaced by `added`
+ * ones. Adjacent changes are merged into a single items-changed
+ * emission.
+ */
+static void
+pending_change_add (PendingChange *change, guint position, guint removed, guint added)
+{
+  if ((change->removed || change->added) && change->position + change->added == position) {
+    change->removed += removed;
+    change->added += added;
+    return;
+  }
+
+  pending_change_flush (change);
+  change->position = position;
+  change->removed = removed;
+  change->added = added;
+}
+
+
+static char *
+get_snapshot_path (void)
+{
+  return g_build_filename (g_get_user_cache_dir (), "phosh", APP_LIST_SNAPSHOT_FILENAME, NULL);
+}
+
+
+static void
+add_app_dir_state (GVariantBuilder *builder, const char *data_dir)
+{
+  g_autofree char *path = g_build_filename (data_dir, "applications", NULL);
+  guint64 mtime = 0;
+  GStatBuf buf;
+
+  if (g_stat (path, &buf) == 0)
+    mtime = (guint64) buf.st_mtim.tv_sec * G_USEC_PER_SEC + buf.st_mtim.tv_nsec / 1000;
+
+  g_variant_builder_add (builder, "(st)", path, mtime);
+}
+
+/*
+ * Adding, removing or renaming a desktop file updates the mtime of
+ * its directory so this detects most changes without parsing any
+ * files. Anything else is picked up when reconciling with the actual
+ * app list.
+ */
+static GVariant *
+get_app_dirs_state (void)
+{
+  const char * const *data_dirs = g_get_system_data_dirs ();
+  GVariantBuilder builder;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(st)"));
+
+  add_app_dir_state (&builder, g_get_user_data_dir ());
+  for (int i = 0; data_dirs[i]; i++)
+    add_app_dir_state (&builder, data_dirs[i]);
+
+  return g_variant_ref_sink (g_variant_builder_end (&builder));
+}
+
+
+static GList *
+load_snapshot (PhoshAppListModel *self)
+{
+  PhoshAppListModelPrivate *priv = phosh_app_list_model_get_instance_private (self);
+  g_autoptr (GError) err = NULL;
+  g_autoptr (GMappedFile) mapped = NULL;
+  g_autoptr (GBytes) bytes = NULL;
+  g_autoptr (GVariant) snapshot = NULL;
+  g_autoptr (GVariant) dirs = NULL;
+  g_autoptr (GVariant) current_dirs = NULL;
+  g_autoptr (GVariant) ids = NULL;
+  g_autofree char *path = get_snapshot_path ();
+  GList *apps = NULL;
+  guint32 version;
+
+  mapped = g_mapped_file_new (path, FALSE, &err);
+  if (!mapped) {
+    if (!g_error_matches (err, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+      g_debug ("Failed to open app list snapshot: %s", err->message);
+    return NULL;
+  }
+
+  bytes = g_mapped_file_get_bytes (mapped);
+  snapshot = g_variant_ref_sink (g_variant_new_from_bytes (G_VARIANT_TYPE (APP_LIST_SNAPSHOT_TYPE),
+                                                           bytes,
+                                                           FALSE));
+
+  g_variant_get_child (snapshot, 0, "u", &version);
+  if (version != APP_LIST_SNAPSHOT_VERSION) {
+    g_debug ("Ignoring app list snapshot version %u", version);
+    return NULL;
+  }
+
+  dirs = g_variant_get_child_value (snapshot, 1);
+  current_dirs = get_app_dirs_state ();
+  if (!g_variant_equal (dirs, current_dirs)) {
+    g_debug ("App list snapshot is outdated");
+    return NULL;
+  }
+
+  ids = g_variant_get_child_value (snapshot, 2);
+  for (gsize i = 0; i < g_variant_n_children (ids); i++) {
+    GDesktopAppInfo *info;
+    const char *id;
+
+    g_variant_get_child (ids, i, "&s", &id);
+    info = g_desktop_app_info_new (id);
+    if (info)
+      apps = g_list_prepend (apps, info);
+  }
+
+  priv->snapshot = g_steal_pointer (&snapshot);
+  g_debug ("Loaded %u apps from snapshot", g_list_length (apps));
+
+  return g_list_reverse (apps);
+}
+
+
+static void
+save_snapshot (PhoshAppListModel *self, GVariant *dirs, GList *apps)
+{
+  PhoshAppListModelPrivate *priv = phosh_app_list_model_get_instance_private (self);
+  g_autoptr (GError) err = NULL;
+  g_autoptr (GVariant) snapshot = NULL;
+  g_autofree char *path = get_snapshot_path ();
+  g_autofree char *dir = g_path_get_dirname (path);
+  GVariantBuilder ids;
+
+  g_variant_builder_init (&ids, G_VARIANT_TYPE_STRING_ARRAY);
+  for (GList *l = apps; l; l = g_list_next (l)) {
+    GAppInfo *app_info = l->data;
+    const char *id = g_app_info_get_id (app_info);
+
+    /* Hidden apps are looked up on demand */
+    if (id && G_IS_DESKTOP_APP_INFO (app_info) && g_app_info_should_show (app_info))
+      g_variant_builder_add (&ids, "s", id);
+  }
+
+  snapshot = g_variant_ref_sink (g_variant_new ("(u@a(st)as)",
+                                                APP_LIST_SNAPSHOT_VERSION,
+                                                dirs,
+                                                &ids));
+
+  if (priv->snapshot && g_variant_equal (priv->snapshot, snapshot))
+    return;
+
+  g_mkdir_with_parents (dir, 0755);
+  if (!g_file_set_contents (path,
+                            g_variant_get_data (snapshot),
+                            g_variant_get_size (snapshot),
+                            &err)) {
+    g_debug ("Failed to save app list snapshot: %s", err->message);
+    return;
+  }
+
+  g_clear_pointer (&priv->snapshot, g_variant_unref);
+  priv->snapshot = g_steal_pointer (&snapshot);
+}
+
+/*
+ * Takes ownership of apps
+ */
+static void
+update_items (PhoshAppListModel *self, GList *apps)
 {
-  PhoshAppListModel *self = PHOSH_APP_LIST_MODEL (data);
   PhoshAppListModelPrivate *priv = phosh_app_list_model_get_instance_private (self);
   g_auto (GStrv) folder_paths = NULL;
-  g_autolist (GAppInfo) new_apps = NULL;
-  int removed;
-  int added = 0;
+  g_autolist (GAppInfo) new_apps = apps;
+  g_autoptr (GHashTable) old_items = NULL;
+  g_autoptr (GHashTable) new_items = NULL;
+  g_autoptr (GHashTable) in_folder = NULL;
+  PendingChange change = { .model = G_LIST_MODEL (self) };
+  GSequenceIter *iter;
+  guint pos, n_items;
+
+  g_hash_table_remove_all (priv->app_id_cache);
+  g_hash_table_remove_all (priv->by_id);
+  for (GList *l = new_apps; l; l = g_list_next (l)) {
+    GAppInfo *app_info = l->data;
+    const char *id = g_app_info_get_id (app_info);
 
-  new_apps = g_app_info_get_all ();
+    if (id)
+      g_hash_table_insert (priv->by_id, g_strdup (id), g_object_ref (app_info));
+  }
 
-  g_return_val_if_fail (new_apps != NULL, G_SOURCE_REMOVE);
+  old_items = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  for (iter = g_sequence_get_begin_iter (priv->items);
+       !g_sequence_iter_is_end (iter);
+       iter = g_sequence_iter_next (iter)) {
+    GAppInfo *app_info = g_sequence_get (iter);
+    char *key = get_item_key (app_info);
 
-  removed = g_sequence_get_length (priv->items);
-  g_sequence_remove_range (g_sequence_get_begin_iter (priv->items),
-                           g_sequence_get_end_iter (priv->items));
-  g_hash_table_remove_all (priv->startup_wm_class);
-  g_hash_table_remove_all (priv->exec_to_id);
+    if (key)
+      g_hash_table_insert (old_items, key, app_info);
+  }
 
   folder_paths = g_settings_get_strv (priv->settings, "folder-children");
+  /* Ids of all apps in any folder, owned by the folders */
+  in_folder = g_hash_table_new (g_str_hash, g_str_equal);
 
   for (int i = 0; i < g_strv_length (folder_paths); i++) {
     char *path = folder_paths[i];
-    PhoshFolderInfo *folder_info = phosh_folder_info_new_from_folder_path (path);
+    g_autofree char *key = g_strconcat ("folder:", path, NULL);
+    PhoshFolderInfo *folder_info = g_hash_table_lookup (old_items, key);
+    const char * const *app_ids;
+
+    /* Keep existing folders, they track their apps themselves */
+    if (PHOSH_IS_FOLDER_INFO (folder_info)) {
+      g_object_ref (folder_info);
+    } else {
+      folder_info = phosh_folder_info_new_for_app_list (path, self);
+      g_signal_connect_object (folder_info, "apps-changed", G_CALLBACK (on_folder_children_changed),
+                               self, G_CONNECT_SWAPPED);
+      g_signal_connect_object (folder_info, "notify::name", G_CALLBACK (on_folder_name_changed),
+                               self, G_CONNECT_SWAPPED);
+    }
     new_apps = g_list_prepend (new_apps, folder_info);
-    new_apps = filter_out_apps_in_folder (new_apps, folder_info);
-    g_signal_connect_object (folder_info, "apps-changed", G_CALLBACK (on_folder_children_changed),
-                             self, G_CONNECT_SWAPPED);
-    g_signal_connect_object (folder_info, "notify::name", G_CALLBACK (emit_items_changed),
-                             self, G_CONNECT_SWAPPED);
+
+    app_ids = phosh_folder_info_get_app_ids (folder_info);
+    for (int j = 0; app_ids[j]; j++)
+      g_hash_table_add (in_folder, (gpointer) app_ids[j]);
   }
+  new_apps = filter_out_apps_in_folders (new_apps, in_folder);
 
+  /* The apps we want to show, by key */
+  g_hash_table_remove_all (priv->startup_wm_class);
+  g_hash_table_remove_all (priv->exec_to_id);
+  new_items = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
   for (GList *l = new_apps; l; l = g_list_next (l)) {
     const char *startup_wm_class;
     GAppInfo *app_info = l->data;
+    char *key;
 
     /* We add folders irrespective of their emptiness because otherwise we won't be able to listen
      * for apps-changed signal. */
     if (!PHOSH_IS_FOLDER_INFO (app_info) && !g_app_info_should_show (app_info))
       continue;
 
-    g_sequence_append (priv->items, g_object_ref (app_info));
-    added++;
+    key = get_item_key (app_info);
+    if (key && !g_hash_table_contains (new_items, key))
+      g_hash_table_insert (new_items, key, app_info);
+    else
+      g_free (key);
 
     if (!G_IS_DESKTOP_APP_INFO (app_info))
       continue;
@@ -224,14 +567,83 @@ items_changed (gpointer data)
     }
   }
 
-  priv->last.is_valid = FALSE;
-  priv->last.iter = NULL;
-  priv->last.position = 0;
+  /* Drop vanished and replace changed items in place. The order of the
+   * model doesn't matter as users sort it anyway. */
+  iter = g_sequence_get_begin_iter (priv->items);
+  pos = 0;
+  while (!g_sequence_iter_is_end (iter)) {
+    GAppInfo *old_info = g_sequence_get (iter);
+    g_autofree char *key = get_item_key (old_info);
+    GAppInfo *new_info = key ? g_hash_table_lookup (new_items, key) : NULL;
+    GSequenceIter *next = g_sequence_iter_next (iter);
+
+    if (new_info == NULL) {
+      invalidate_cache (self);
+      g_sequence_remove (iter);
+      pending_change_add (&change, pos, 1, 0);
+    } else {
+      if (!item_unchanged (old_info, new_info)) {
+        invalidate_cache (self);
+        phosh_util_index_app_info (new_info);
+        g_sequence_set (iter, g_object_ref (new_info));
+        pending_change_add (&change, pos, 1, 1);
+      }
+      /* Mark as handled */
+      g_hash_table_remove (new_items, key);
+      pos++;
+    }
+    iter = next;
+  }
+  pending_change_flush (&change);
+
+  /* Append what's new */
+  n_items = g_sequence_get_length (priv->items);
+  for (GList *l = new_apps; l; l = g_list_next (l)) {
+    GAppInfo *app_info = l->data;
+    g_autofree char *key = NULL;
+
+    if (!PHOSH_IS_FOLDER_INFO (app_info) && !g_app_info_should_show (app_info))
+      continue;
+
+    key = get_item_key (app_info);
+    /* Already present or a duplicate */
+    if (key && !g_hash_table_remove (new_items, key))
+      continue;
 
-  g_list_model_items_changed (G_LIST_MODEL (self), 0, removed, added);
+    /* Build the search index up front rather than on the first keystroke */
+    if (!PHOSH_IS_FOLDER_INFO (app_info))
+      phosh_util_index_app_info (app_info);
+
+    g_sequence_append (priv->items, g_object_ref (app_info));
+  }
+  pending_change_add (&change, n_items, 0, g_sequence_get_length (priv->items) - n_items);
+  pending_change_flush (&change);
+}
+
+
+static gboolean
+items_changed (gpointer data)
+{
+  PhoshAppListModel *self = PHOSH_APP_LIST_MODEL (data);
+  PhoshAppListModelPrivate *priv = phosh_app_list_model_get_instance_private (self);
+  g_autoptr (GVariant) dirs = NULL;
+  GList *new_apps;
+  gint64 trace_begin = PHOSH_TRACE_CURRENT_TIME;
 
   priv->debounce = 0;
 
+  /* Before listing the apps so we don't miss changes in between */
+  dirs = get_app_dirs_state ();
+  new_apps = g_app_info_get_all ();
+
+  g_return_val_if_fail (new_apps != NULL, G_SOURCE_REMOVE);
+
+  save_snapshot (self, dirs, new_apps);
+  update_items (self, new_apps);
+
+  PHOSH_TRACE_MARK (trace_begin, "app-list-model: items changed", "%u apps",
+                    g_sequence_get_length (priv->items));
+
   return G_SOURCE_REMOVE;
 }
 
@@ -243,6 +655,9 @@ on_monitor_changed_cb (GAppInfoMonitor *monitor,
   PhoshAppListModel *self = PHOSH_APP_LIST_MODEL (data);
   PhoshAppListModelPrivate *priv = phosh_app_list_model_get_instance_private (self);
 
+  /* Resolution might already be different, don't wait for the rebuild */
+  g_hash_table_remove_all (priv->app_id_cache);
+
   if (priv->debounce != 0) {
     g_source_remove (priv->debounce);
   }
@@ -262,10 +677,19 @@ on_folder_children_changed (PhoshAppListModel *self)
 }
 
 
+static void
+unref_nullable (gpointer object)
+{
+  if (object)
+    g_object_unref (object);
+}
+
+
 static void
 phosh_app_list_model_init (PhoshAppListModel *self)
 {
   PhoshAppListModelPrivate *priv = phosh_app_list_model_get_instance_private (self);
+  GList *apps;
 
   priv->debounce = 0;
   priv->startup_wm_class = g_hash_table_new_full (g_str_hash,
@@ -276,6 +700,11 @@ phosh_app_list_model_init (PhoshAppListModel *self)
                                             g_str_equal,
                                             g_free,
                                             g_object_unref);
+  priv->by_id = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+  priv->app_id_cache = g_hash_table_new_full (g_str_hash,
+                                              g_str_equal,
+                                              g_free,
+                                              unref_nullable);
 
   priv->last.is_valid = FALSE;
 
@@ -288,6 +717,11 @@ phosh_app_list_model_init (PhoshAppListModel *self)
                            G_CALLBACK (on_folder_children_changed),
                            self, G_CONNECT_SWAPPED);
 
+  /* Populate from the snapshot right away and reconcile with the actual app list later */
+  apps = load_snapshot (self);
+  if (apps)
+    update_items (self, apps);
+
   on_monitor_changed_cb (priv->monitor, self);
 }
 
@@ -332,6 +766,30 @@ phosh_app_list_model_lookup_by_startup_wm_class (PhoshAppListModel *self,
 }
 
 
+/**
+ * phosh_app_list_model_lookup_by_id:
+ * @self: The app list model
+ * @id: The app's desktop file id
+ *
+ * Lookup an app by its id. This also finds apps that aren't part of
+ * the model like apps that shouldn't be shown or apps in folders. It
+ * doesn't hit the disk so it won't find apps before the model was
+ * populated or apps installed since the last refresh.
+ *
+ * Returns: (transfer none)(nullable): The app info for the given id
+ */
+GAppInfo *
+phosh_app_list_model_lookup_by_id (PhoshAppListModel *self, const char *id)
+{
+  PhoshAppListModelPrivate *priv = phosh_app_list_model_get_instance_private (self);
+
+  g_return_val_if_fail (PHOSH_IS_APP_LIST_MODEL (self), NULL);
+  g_return_val_if_fail (id, NULL);
+
+  return g_hash_table_lookup (priv->by_id, id);
+}
+
+
 void
 phosh_app_list_model_add_exec (PhoshAppListModel *self,
                                const char        *exec,
@@ -354,6 +812,8 @@ phosh_app_list_model_add_exec (PhoshAppListModel *self,
     return;
 
   g_hash_table_insert (priv->exec_to_id, g_steal_pointer (&cmd), g_object_ref (info));
+  /* The new mapping might resolve previously unknown app-ids */
+  g_hash_table_remove_all (priv->app_id_cache);
 }
 
 
@@ -364,3 +824,59 @@ phosh_app_list_model_lookup_by_exec (PhoshAppListModel *self, const char *exec)
 
   return g_hash_table_lookup (priv->exec_to_id, exec);
 }
+
+/**
+ * phosh_app_list_model_lookup_app_id_cache:
+ * @self: The app list model
+ * @app_id: The app-id to look up
+ * @info: (out)(transfer full)(nullable): Return location for the cached app info
+ *
+ * Looks up a previous resolution of the given app-id as recorded via
+ * [method@AppListModel.cache_app_id]. The cache is flushed whenever
+ * the installed apps change.
+ *
+ * Returns: %TRUE if the app-id was found in the cache. In this case
+ *   `info` is set to the cached app info which may be %NULL if the
+ *   app-id couldn't be resolved previously.
+ */
+gboolean
+phosh_app_list_model_lookup_app_id_cache (PhoshAppListModel  *self,
+                                          const char         *app_id,
+                                          GDesktopAppInfo   **info)
+{
+  PhoshAppListModelPrivate *priv = phosh_app_list_model_get_instance_private (self);
+  gpointer value;
+
+  g_return_val_if_fail (PHOSH_IS_APP_LIST_MODEL (self), FALSE);
+  g_return_val_if_fail (app_id, FALSE);
+  g_return_val_if_fail (info && *info == NULL, FALSE);
+
+  if (!g_hash_table_lookup_extended (priv->app_id_cache, app_id, NULL, &value))
+    return FALSE;
+
+  *info = value ? g_object_ref (value) : NULL;
+  return TRUE;
+}
+
+/**
+ * phosh_app_list_model_cache_app_id:
+ * @self: The app list model
+ * @app_id: The app-id
+ * @info: (nullable): The app info the app-id resolved to
+ *
+ * Record the result of resolving an app-id. Use %NULL as `info` to
+ * record that the app-id couldn't be resolved.
+ */
+void
+phosh_app_list_model_cache_app_id (PhoshAppListModel *self,
+                                   const char        *app_id,
+                                   GDesktopAppInfo   *info)
+{
+  PhoshAppListModelPrivate *priv = phosh_app_list_model_get_instance_private (self);
+
+  g_return_if_fail (PHOSH_IS_APP_LIST_MODEL (self));
+  g_return_if_fail (app_id);
+  g_return_if_fail (info == NULL || G_IS_DESKTOP_APP_INFO (info));
+
+  g_hash_table_insert (priv->app_id_cache, g_strdup (app_id), info ? g_object_ref (info) : NULL);
+}
@@ -23,8 +23,15 @@ PhoshAppListModel *phosh_app_list_model_get_default (void);
 GDesktopAppInfo *  phosh_app_list_model_lookup_by_startup_wm_class (PhoshAppListModel *self,
                                                                     const char        *class);
 GDesktopAppInfo *  phosh_app_list_model_lookup_by_exec (PhoshAppListModel *self, const char *exec);
+GAppInfo *         phosh_app_list_model_lookup_by_id (PhoshAppListModel *self, const char *id);
 void               phosh_app_list_model_add_exec (PhoshAppListModel *self,
                                                   const char        *exec,
                                                   GAppInfo          *info);
+gboolean           phosh_app_list_model_lookup_app_id_cache (PhoshAppListModel  *self,
+                                                             const char         *app_id,
+                                                             GDesktopAppInfo   **info);
+void               phosh_app_list_model_cache_app_id (PhoshAppListModel *self,
+                                                      const char        *app_id,
+                                                      GDesktopAppInfo   *info);
 
 G_END_DECLS
@@ -0,0 +1,503 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "phosh-app-prefetcher"
+
+#include "phosh-config.h"
+
+#include "app-prefetcher.h"
+
+#include <glib/gstdio.h>
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#define APP_PREFETCH_SCHEMA_ID "mobi.phosh.shell.app-prefetch"
+#define APP_PREFETCH_KEY_ENABLED "enabled"
+
+/* Bump when changing the launch history format */
+#define APP_LAUNCHES_VERSION 1
+/* Format version, app ids with their launch count and files to prefetch */
+#define APP_LAUNCHES_TYPE "(ua{s(uas)})"
+#define APP_LAUNCHES_FILENAME "app-launches.gvariant"
+
+/* Give the app time to load its libraries before looking at them */
+#define RECORD_DELAY_S 10
+#define SAVE_DELAY_S 5
+/* Don't prefetch the same app over and over */
+#define PREFETCH_INTERVAL_US (5 * 60 * G_USEC_PER_SEC)
+#define MAX_FILES 64
+
+/**
+ * PhoshAppPrefetcher:
+ *
+ * Prefetches the files of frequently launched apps
+ *
+ * #PhoshAppPrefetcher counts how often apps get launched and records
+ * which executables and libraries they map. When asked to prefetch it
+ * tells the kernel to read the files of the most frequently launched
+ * app into the page cache so a cold launch doesn't wait on slow
+ * storage. Disabled unless the user opts in.
+ */
+
+typedef struct {
+  guint   count;
+  GStrv   files;
+} PhoshAppLaunches;
+
+typedef struct {
+  PhoshAppPrefetcher *prefetcher; /* unowned */
+  char               *app_id;
+  GPid                pid;
+} PhoshAppRecord;
+
+struct _PhoshAppPrefetcher {
+  GObject       parent;
+
+  GSettings    *settings;
+  gboolean      enabled;
+
+  /* app id → PhoshAppLaunches */
+  GHashTable   *launches;
+  /* PhoshAppRecord waiting for the app to be up */
+  GPtrArray    *records;
+  guint         save_id;
+
+  char         *last_prefetched;
+  gint64        last_prefetch;
+  GCancellable *cancel;
+};
+G_DEFINE_TYPE (PhoshAppPrefetcher, phosh_app_prefetcher, G_TYPE_OBJECT)
+
+
+static void
+phosh_app_launches_free (PhoshAppLaunches *launches)
+{
+  g_strfreev (launches->files);
+  g_free (launches);
+}
+
+
+static void
+phosh_app_record_free (PhoshAppRecord *record)
+{
+  g_free (record->app_id);
+  g_free (record);
+}
+
+
+static char *
+get_launches_path (void)
+{
+  return g_build_filename (g_get_user_cache_dir (), "phosh", APP_LAUNCHES_FILENAME, NULL);
+}
+
+
+static void
+load_launches (PhoshAppPrefetcher *self)
+{
+  g_autoptr (GError) err = NULL;
+  g_autoptr (GMappedFile) mapped = NULL;
+  g_autoptr (GBytes) bytes = NULL;
+  g_autoptr (GVariant) launches = NULL;
+  g_autoptr (GVariantIter) iter = NULL;
+  g_autofree char *path = get_launches_path ();
+  const char *app_id;
+  GStrv files;
+  guint32 version, count;
+
+  mapped = g_mapped_file_new (path, FALSE, &err);
+  if (!mapped) {
+    if (!g_error_matches (err, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+      g_debug ("Failed to open app launches: %s", err->message);
+    return;
+  }
+
+  bytes = g_mapped_file_get_bytes (mapped);
+  launches = g_variant_ref_sink (g_variant_new_from_bytes (G_VARIANT_TYPE (APP_LAUNCHES_TYPE),
+                                                           bytes,
+                                                           FALSE));
+
+  g_variant_get (launches, "(ua{s(uas)})", &version, &iter);
+  if (version != APP_LAUNCHES_VERSION) {
+    g_debug ("Ignoring app launches version %u", version);
+    return;
+  }
+
+  while (g_variant_iter_next (iter, "{&s(u^as)}", &app_id, &count, &files)) {
+    PhoshAppLaunches *entry = g_new0 (PhoshAppLaunches, 1);
+
+    entry->count = count;
+    entry->files = files;
+    g_hash_table_insert (self->launches, g_strdup (app_id), entry);
+  }
+
+  g_debug ("Loaded launch counts of %u apps", g_hash_table_size (self->launches));
+}
+
+
+static void
+save_launches (PhoshAppPrefetcher *self)
+{
+  g_autoptr (GError) err = NULL;
+  g_autoptr (GVariant) launches = NULL;
+  g_autofree char *path = get_launches_path ();
+  g_autofree char *dir = g_path_get_dirname (path);
+  GVariantBuilder builder;
+  GHashTableIter iter;
+  const char *app_id;
+  PhoshAppLaunches *entry;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{s(uas)}"));
+  g_hash_table_iter_init (&iter, self->launches);
+  while (g_hash_table_iter_next (&iter, (gpointer *)&app_id, (gpointer *)&entry)) {
+    const char * const empty[] = { NULL };
+
+    g_variant_builder_add (&builder, "{s(u^as)}", app_id, entry->count,
+                           entry->files ?: (GStrv) empty);
+  }
+
+  launches = g_variant_ref_sink (g_variant_new ("(ua{s(uas)})", APP_LAUNCHES_VERSION, &builder));
+
+  g_mkdir_with_parents (dir, 0755);
+  if (!g_file_set_contents (path,
+                            g_variant_get_data (launches),
+                            g_variant_get_size (launches),
+                            &err)) {
+    g_debug ("Failed to save app launches: %s", err->message);
+  }
+}
+
+
+static gboolean
+on_save_timeout (gpointer data)
+{
+  PhoshAppPrefetcher *self = PHOSH_APP_PREFETCHER (data);
+
+  save_launches (self);
+
+  self->save_id = 0;
+  return G_SOURCE_REMOVE;
+}
+
+
+static void
+queue_save (PhoshAppPrefetcher *self)
+{
+  if (self->save_id)
+    return;
+
+  self->save_id = g_timeout_add_seconds (SAVE_DELAY_S, on_save_timeout, self);
+  g_source_set_name_by_id (self->save_id, "[phosh] app prefetcher save");
+}
+
+/*
+ * The executable mappings of a running app are its binary and the
+ * libraries it uses which is what a cold launch needs to read.
+ */
+static GStrv
+get_mapped_files (GPid pid)
+{
+  g_autoptr (GError) err = NULL;
+  g_autoptr (GStrvBuilder) builder = g_strv_builder_new ();
+  g_autoptr (GHashTable) seen = g_hash_table_new (g_str_hash, g_str_equal);
+  g_autofree char *maps_path = g_strdup_printf ("/proc/%d/maps", pid);
+  g_autofree char *maps = NULL;
+  g_auto (GStrv) lines = NULL;
+
+  if (!g_file_get_contents (maps_path, &maps, NULL, &err)) {
+    g_debug ("Failed to read mappings of %d: %s", pid, err->message);
+    return NULL;
+  }
+
+  lines = g_strsplit (maps, "\n", -1);
+  for (int i = 0; lines[i] && g_hash_table_size (seen) < MAX_FILES; i++) {
+    char perms[5];
+    const char *path;
+
+    /* address perms offset dev inode path */
+    if (sscanf (lines[i], "%*s %4s", perms) != 1 || perms[2] != 'x')
+      continue;
+
+    path = strchr (lines[i], '/');
+    if (path == NULL || g_str_has_suffix (path, " (deleted)"))
+      continue;
+
+    if (!g_hash_table_add (seen, (gpointer) path))
+      continue;
+
+    g_strv_builder_add (builder, path);
+  }
+
+  return g_strv_builder_end (builder);
+}
+
+
+static gboolean
+on_record_timeout (gpointer data)
+{
+  PhoshAppRecord *record = data;
+  PhoshAppPrefetcher *self = record->prefetcher;
+  PhoshAppLaunches *entry;
+  GStrv files;
+
+  entry = g_hash_table_lookup (self->launches, record->app_id);
+  files = get_mapped_files (record->pid);
+  if (entry && files && files[0]) {
+    g_debug ("Recorded %u files of %s", g_strv_length (files), record->app_id);
+    g_strfreev (entry->files);
+    entry->files = files;
+    queue_save (self);
+  } else {
+    g_strfreev (files);
+  }
+
+  g_ptr_array_remove (self->records, record);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static void
+prefetch_thread (GTask        *task,
+                 gpointer      source_object,
+                 gpointer      task_data,
+                 GCancellable *cancel)
+{
+  GStrv files = task_data;
+
+  for (int i = 0; files[i]; i++) {
+    int fd;
+
+    if (g_cancellable_is_cancelled (cancel))
+      break;
+
+    fd = g_open (files[i], O_RDONLY | O_CLOEXEC, 0);
+    if (fd < 0)
+      continue;
+
+    /* Only a hint, the kernel reads the file in the background */
+    posix_fadvise (fd, 0, 0, POSIX_FADV_WILLNEED);
+    close (fd);
+  }
+
+  g_task_return_boolean (task, TRUE);
+}
+
+
+static GStrv
+get_fallback_files (const char *app_id)
+{
+  g_autoptr (GDesktopAppInfo) info = g_desktop_app_info_new (app_id);
+  g_autofree char *path = NULL;
+  const char *executable;
+
+  if (info == NULL)
+    return NULL;
+
+  executable = g_app_info_get_executable (G_APP_INFO (info));
+  if (executable == NULL)
+    return NULL;
+
+  path = g_find_program_in_path (executable);
+  if (path == NULL)
+    return NULL;
+
+  return g_strdupv ((char *[]) { path, NULL });
+}
+
+
+static void
+on_enabled_changed (PhoshAppPrefetcher *self)
+{
+  self->enabled = g_settings_get_boolean (self->settings, APP_PREFETCH_KEY_ENABLED);
+
+  g_debug ("App prefetching enabled: %d", self->enabled);
+}
+
+
+static void
+phosh_app_prefetcher_dispose (GObject *object)
+{
+  PhoshAppPrefetcher *self = PHOSH_APP_PREFETCHER (object);
+
+  g_cancellable_cancel (self->cancel);
+  g_clear_object (&self->cancel);
+
+  if (self->save_id) {
+    save_launches (self);
+    g_clear_handle_id (&self->save_id, g_source_remove);
+  }
+
+  /* Removing the records removes their timeouts */
+  g_clear_pointer (&self->records, g_ptr_array_unref);
+  g_clear_object (&self->settings);
+
+  G_OBJECT_CLASS (phosh_app_prefetcher_parent_class)->dispose (object);
+}
+
+
+static void
+phosh_app_prefetcher_finalize (GObject *object)
+{
+  PhoshAppPrefetcher *self = PHOSH_APP_PREFETCHER (object);
+
+  g_clear_pointer (&self->launches, g_hash_table_destroy);
+  g_clear_pointer (&self->last_prefetched, g_free);
+
+  G_OBJECT_CLASS (phosh_app_prefetcher_parent_class)->finalize (object);
+}
+
+
+static void
+phosh_app_prefetcher_class_init (PhoshAppPrefetcherClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->dispose = phosh_app_prefetcher_dispose;
+  object_class->finalize = phosh_app_prefetcher_finalize;
+}
+
+
+static void
+remove_record (PhoshAppRecord *record)
+{
+  g_source_remove_by_user_data (record);
+  phosh_app_record_free (record);
+}
+
+
+static void
+phosh_app_prefetcher_init (PhoshAppPrefetcher *self)
+{
+  self->cancel = g_cancellable_new ();
+  self->launches = g_hash_table_new_full (g_str_hash,
+                                          g_str_equal,
+                                          g_free,
+                                          (GDestroyNotify) phosh_app_launches_free);
+  self->records = g_ptr_array_new_with_free_func ((GDestroyNotify) remove_record);
+
+  self->settings = g_settings_new (APP_PREFETCH_SCHEMA_ID);
+  g_signal_connect_swapped (self->settings,
+                            "changed::" APP_PREFETCH_KEY_ENABLED,
+                            G_CALLBACK (on_enabled_changed),
+                            self);
+  on_enabled_changed (self);
+
+  load_launches (self);
+}
+
+
+PhoshAppPrefetcher *
+phosh_app_prefetcher_new (void)
+{
+  return g_object_new (PHOSH_TYPE_APP_PREFETCHER, NULL);
+}
+
+/**
+ * phosh_app_prefetcher_record_launch:
+ * @self: The app prefetcher
+ * @info: The launched app
+ * @pid: The pid of the launched process or `0` if unknown
+ *
+ * Record that the app got launched. If the pid is known the
+ * app's mapped files are recorded once it had time to start up.
+ */
+void
+phosh_app_prefetcher_record_launch (PhoshAppPrefetcher *self, GDesktopAppInfo *info, GPid pid)
+{
+  PhoshAppLaunches *entry;
+  PhoshAppRecord *record;
+  const char *app_id;
+
+  g_return_if_fail (PHOSH_IS_APP_PREFETCHER (self));
+  g_return_if_fail (G_IS_DESKTOP_APP_INFO (info));
+
+  if (!self->enabled)
+    return;
+
+  app_id = g_app_info_get_id (G_APP_INFO (info));
+  if (app_id == NULL)
+    return;
+
+  entry = g_hash_table_lookup (self->launches, app_id);
+  if (entry == NULL) {
+    entry = g_new0 (PhoshAppLaunches, 1);
+    g_hash_table_insert (self->launches, g_strdup (app_id), entry);
+  }
+  entry->count++;
+  queue_save (self);
+
+  if (pid <= 0)
+    return;
+
+  record = g_new0 (PhoshAppRecord, 1);
+  record->prefetcher = self;
+  record->app_id = g_strdup (app_id);
+  record->pid = pid;
+  g_ptr_array_add (self->records, record);
+  g_timeout_add_seconds_full (G_PRIORITY_LOW, RECORD_DELAY_S, on_record_timeout, record, NULL);
+}
+
+/**
+ * phosh_app_prefetcher_prefetch:
+ * @self: The app prefetcher
+ *
+ * Prefetch the files of the app that is most likely launched
+ * next. Call this when the user is about to pick an app, e.g. when the
+ * overview opens.
+ */
+void
+phosh_app_prefetcher_prefetch (PhoshAppPrefetcher *self)
+{
+  g_autoptr (GTask) task = NULL;
+  GHashTableIter iter;
+  const char *app_id, *top_app_id = NULL;
+  PhoshAppLaunches *entry, *top = NULL;
+  GStrv files;
+  gint64 now;
+
+  g_return_if_fail (PHOSH_IS_APP_PREFETCHER (self));
+
+  if (!self->enabled)
+    return;
+
+  g_hash_table_iter_init (&iter, self->launches);
+  while (g_hash_table_iter_next (&iter, (gpointer *)&app_id, (gpointer *)&entry)) {
+    if (top == NULL || entry->count > top->count) {
+      top = entry;
+      top_app_id = app_id;
+    }
+  }
+
+  if (top == NULL)
+    return;
+
+  now = g_get_monotonic_time ();
+  if (g_strcmp0 (self->last_prefetched, top_app_id) == 0 &&
+      now - self->last_prefetch < PREFETCH_INTERVAL_US)
+    return;
+
+  if (top->files && top->files[0])
+    files = g_strdupv (top->files);
+  else
+    files = get_fallback_files (top_app_id);
+
+  if (files == NULL)
+    return;
+
+  g_debug ("Prefetching %u files of %s", g_strv_length (files), top_app_id);
+  g_free (self->last_prefetched);
+  self->last_prefetched = g_strdup (top_app_id);
+  self->last_prefetch = now;
+
+  task = g_task_new (self, self->cancel, NULL, NULL);
+  g_task_set_source_tag (task, phosh_app_prefetcher_prefetch);
+  g_task_set_task_data (task, files, (GDestroyNotify) g_strfreev);
+  g_task_run_in_thread (task, prefetch_thread);
+}
@@ -0,0 +1,24 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+#include <gio/gdesktopappinfo.h>
+
+G_BEGIN_DECLS
+
+#define PHOSH_TYPE_APP_PREFETCHER (phosh_app_prefetcher_get_type ())
+
+G_DECLARE_FINAL_TYPE (PhoshAppPrefetcher, phosh_app_prefetcher, PHOSH, APP_PREFETCHER, GObject)
+
+PhoshAppPrefetcher *phosh_app_prefetcher_new            (void);
+void                phosh_app_prefetcher_record_launch  (PhoshAppPrefetcher *self,
+                                                         GDesktopAppInfo    *info,
+                                                         GPid                pid);
+void                phosh_app_prefetcher_prefetch       (PhoshAppPrefetcher *self);
+
+G_END_DECLS
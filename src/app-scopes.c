@@ -0,0 +1,671 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "phosh-app-scopes"
+
+#include "phosh-config.h"
+
+#include "app-scopes.h"
+
+#include <string.h>
+
+#define APP_SCOPES_SCHEMA_ID "mobi.phosh.shell.app-scopes"
+#define APP_SCOPES_KEY_SLICE "slice"
+#define APP_SCOPES_KEY_CPU_WEIGHT "cpu-weight"
+#define APP_SCOPES_KEY_MEMORY_HIGH "memory-high"
+#define APP_SCOPES_KEY_BOOST_FOREGROUND "boost-foreground"
+
+#define SYSTEMD_BUS_NAME "org.freedesktop.systemd1"
+#define SYSTEMD_OBJECT_PATH "/org/freedesktop/systemd1"
+#define SYSTEMD_MANAGER_INTERFACE "org.freedesktop.systemd1.Manager"
+#define SYSTEMD_NO_SUCH_UNIT_ERROR "org.freedesktop.systemd1.NoSuchUnit"
+
+/* CPU and IO weights when boosting, systemd's default is 100 */
+#define FOREGROUND_WEIGHT 200
+#define BACKGROUND_WEIGHT 50
+#define SHELL_BOOST_WEIGHT 1000
+
+/**
+ * PhoshAppScopes:
+ *
+ * Moves launched apps into systemd scopes
+ *
+ * #PhoshAppScopes puts each launched app into its own transient
+ * systemd scope so resources can be tracked and controlled per
+ * app. The scopes are created in batches when the main loop is idle
+ * so they never delay a launch. Apps can be put into a pre-created
+ * slice and the scopes can get resource controls, see the
+ * `mobi.phosh.shell.app-scopes` schema.
+ *
+ * When boosting is enabled the scopes of the focused app get a higher
+ * CPU and IO weight than the ones of background apps and the shell's
+ * own unit gets boosted while it animates.
+ */
+
+typedef struct {
+  PhoshAppScopes *scopes; /* unowned */
+  char           *app_id;
+  char           *unit;
+  GPid            pid;
+} PhoshAppScopeRequest;
+
+typedef struct {
+  char *name;
+  GPid  pid;
+  /* Looked up on first use */
+  char *cgroup;
+} PhoshAppUnit;
+
+struct _PhoshAppScopes {
+  GObject          parent;
+
+  GDBusConnection *bus;
+  GCancellable    *cancel;
+  GSettings       *settings;
+
+  /* PhoshAppScopeRequest waiting for the next batch */
+  GQueue           pending;
+  guint            batch_id;
+
+  /* app id → GPtrArray of started PhoshAppUnit */
+  GHashTable      *units;
+  gboolean         boost;
+  char            *foreground;
+
+  struct {
+    char          *unit;
+    guint          weight;
+    gboolean       boosted;
+    gboolean       failed;
+  } shell;
+};
+G_DEFINE_TYPE (PhoshAppScopes, phosh_app_scopes, G_TYPE_OBJECT)
+
+
+static void
+phosh_app_unit_free (PhoshAppUnit *unit)
+{
+  g_free (unit->name);
+  g_free (unit->cgroup);
+  g_free (unit);
+}
+
+
+static gboolean
+phosh_app_unit_has_name (gconstpointer a, gconstpointer b)
+{
+  const PhoshAppUnit *unit = a;
+
+  return g_str_equal (unit->name, b);
+}
+
+
+static void
+phosh_app_scope_request_free (PhoshAppScopeRequest *request)
+{
+  g_free (request->app_id);
+  g_free (request->unit);
+  g_free (request);
+}
+
+/* Like systemd's unit name escaping, see systemd-escape(1) */
+static char *
+escape_unit_name (const char *name)
+{
+  GString *escaped = g_string_new (NULL);
+
+  for (const char *c = name; *c; c++) {
+    if (g_ascii_isalnum (*c) || *c == ':' || *c == '_' || (*c == '.' && c != name))
+      g_string_append_c (escaped, *c);
+    else
+      g_string_append_printf (escaped, "\\x%02x", (guchar) *c);
+  }
+
+  return g_string_free (escaped, FALSE);
+}
+
+
+static void
+on_start_scope_done (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+  g_autoptr (GVariant) ret = NULL;
+  g_autoptr (GError) err = NULL;
+  PhoshAppScopeRequest *request = user_data;
+  PhoshAppScopes *self;
+  PhoshAppUnit *unit;
+  GPtrArray *units;
+
+  ret = g_dbus_connection_call_finish (G_DBUS_CONNECTION (source_object), res, &err);
+  if (!ret) {
+    if (!g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+      g_warning ("Failed to move '%s' to transient systemd unit: %s",
+                 request->app_id, err->message);
+    }
+    phosh_app_scope_request_free (request);
+    return;
+  }
+
+  g_debug ("Moved '%s' to transient systemd unit", request->app_id);
+
+  self = request->scopes;
+  units = g_hash_table_lookup (self->units, request->app_id);
+  if (units == NULL) {
+    units = g_ptr_array_new_with_free_func ((GDestroyNotify) phosh_app_unit_free);
+    g_hash_table_insert (self->units, g_strdup (request->app_id), units);
+  }
+  unit = g_new0 (PhoshAppUnit, 1);
+  unit->name = g_steal_pointer (&request->unit);
+  unit->pid = request->pid;
+  g_ptr_array_add (units, unit);
+
+  phosh_app_scope_request_free (request);
+}
+
+
+static void
+add_weights (GVariantBuilder *props, guint weight)
+{
+  g_variant_builder_add (props, "(sv)", "CPUWeight", g_variant_new_uint64 (weight));
+  g_variant_builder_add (props, "(sv)", "IOWeight", g_variant_new_uint64 (weight));
+}
+
+
+static void
+remove_unit (PhoshAppScopes *self, const char *app_id, const char *unit)
+{
+  GPtrArray *units = g_hash_table_lookup (self->units, app_id);
+  guint i;
+
+  if (units == NULL)
+    return;
+
+  if (g_ptr_array_find_with_equal_func (units, unit, phosh_app_unit_has_name, &i))
+    g_ptr_array_remove_index_fast (units, i);
+
+  if (units->len == 0)
+    g_hash_table_remove (self->units, app_id);
+}
+
+
+static void
+on_set_unit_properties_done (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+  g_autoptr (GVariant) ret = NULL;
+  g_autoptr (GError) err = NULL;
+  g_autofree char *remote_error = NULL;
+  PhoshAppScopeRequest *request = user_data;
+
+  ret = g_dbus_connection_call_finish (G_DBUS_CONNECTION (source_object), res, &err);
+  if (ret)
+    goto out;
+
+  if (g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    goto out;
+
+  remote_error = g_dbus_error_get_remote_error (err);
+  if (g_strcmp0 (remote_error, SYSTEMD_NO_SUCH_UNIT_ERROR) == 0) {
+    /* The app exited and systemd collected its scope */
+    g_debug ("Dropping gone unit %s", request->unit);
+    remove_unit (request->scopes, request->app_id, request->unit);
+    goto out;
+  }
+
+  g_debug ("Failed to set weights of %s: %s", request->unit, err->message);
+ out:
+  phosh_app_scope_request_free (request);
+}
+
+
+static void
+set_unit_weight (PhoshAppScopes *self, const char *app_id, const char *unit, guint weight)
+{
+  PhoshAppScopeRequest *request;
+  GVariantBuilder props;
+
+  g_variant_builder_init (&props, G_VARIANT_TYPE ("a(sv)"));
+  add_weights (&props, weight);
+
+  request = g_new0 (PhoshAppScopeRequest, 1);
+  request->scopes = self;
+  request->app_id = g_strdup (app_id);
+  request->unit = g_strdup (unit);
+
+  g_debug ("Setting weight of %s to %u", unit, weight);
+  /* Runtime only, the scopes are transient anyway */
+  g_dbus_connection_call (self->bus,
+                          SYSTEMD_BUS_NAME,
+                          SYSTEMD_OBJECT_PATH,
+                          SYSTEMD_MANAGER_INTERFACE,
+                          "SetUnitProperties",
+                          g_variant_new ("(sba(sv))", unit, TRUE, &props),
+                          NULL,
+                          G_DBUS_CALL_FLAGS_NO_AUTO_START,
+                          -1,
+                          self->cancel,
+                          on_set_unit_properties_done,
+                          request);
+}
+
+
+static void
+set_app_weight (PhoshAppScopes *self, const char *app_id, guint weight)
+{
+  GPtrArray *units = g_hash_table_lookup (self->units, app_id);
+
+  if (units == NULL || self->bus == NULL)
+    return;
+
+  for (guint i = 0; i < units->len; i++) {
+    PhoshAppUnit *unit = g_ptr_array_index (units, i);
+
+    set_unit_weight (self, app_id, unit->name, weight);
+  }
+}
+
+
+static void
+start_scope (PhoshAppScopes *self, PhoshAppScopeRequest *request)
+{
+  g_autofree char *escaped = escape_unit_name (request->app_id);
+  g_autofree char *slice = g_settings_get_string (self->settings, APP_SCOPES_KEY_SLICE);
+  guint cpu_weight = g_settings_get_uint (self->settings, APP_SCOPES_KEY_CPU_WEIGHT);
+  guint memory_high = g_settings_get_uint (self->settings, APP_SCOPES_KEY_MEMORY_HIGH);
+  guint32 pid = request->pid;
+  GVariantBuilder props;
+
+  g_variant_builder_init (&props, G_VARIANT_TYPE ("a(sv)"));
+  g_variant_builder_add (&props, "(sv)", "PIDs",
+                         g_variant_new_fixed_array (G_VARIANT_TYPE_UINT32, &pid, 1, sizeof (pid)));
+  g_variant_builder_add (&props, "(sv)", "Description",
+                         g_variant_new_string ("Application launched by phosh"));
+  /* Clean up the unit when the app exits, even if it failed */
+  g_variant_builder_add (&props, "(sv)", "CollectMode",
+                         g_variant_new_string ("inactive-or-failed"));
+
+  if (slice[0] != '\0') {
+    if (g_str_has_suffix (slice, ".slice"))
+      g_variant_builder_add (&props, "(sv)", "Slice", g_variant_new_string (slice));
+    else
+      g_warning ("Ignoring invalid slice '%s'", slice);
+  }
+  if (self->boost)
+    add_weights (&props, g_strcmp0 (self->foreground, request->app_id) ? BACKGROUND_WEIGHT :
+                 FOREGROUND_WEIGHT);
+  else if (cpu_weight)
+    g_variant_builder_add (&props, "(sv)", "CPUWeight", g_variant_new_uint64 (cpu_weight));
+  if (memory_high) {
+    g_variant_builder_add (&props, "(sv)", "MemoryHigh",
+                           g_variant_new_uint64 ((guint64) memory_high * 1024 * 1024));
+  }
+
+  request->unit = g_strdup_printf ("app-phosh-%s-%d.scope", escaped, request->pid);
+  g_debug ("Starting %s for %s", request->unit, request->app_id);
+  g_dbus_connection_call (self->bus,
+                          SYSTEMD_BUS_NAME,
+                          SYSTEMD_OBJECT_PATH,
+                          SYSTEMD_MANAGER_INTERFACE,
+                          "StartTransientUnit",
+                          g_variant_new ("(ssa(sv)a(sa(sv)))", request->unit, "fail", &props,
+                                         NULL),
+                          G_VARIANT_TYPE ("(o)"),
+                          G_DBUS_CALL_FLAGS_NO_AUTO_START,
+                          -1,
+                          self->cancel,
+                          on_start_scope_done,
+                          request);
+}
+
+
+/*
+ * The shell's own unit is the last component of its cgroup,
+ * e.g. phosh.service. Only units of the user's manager can be
+ * changed via the session bus.
+ */
+static gboolean
+lookup_shell_unit (PhoshAppScopes *self)
+{
+  g_autoptr (GError) err = NULL;
+  g_autofree char *contents = NULL;
+  g_autofree char *weight = NULL;
+  g_autofree char *weight_path = NULL;
+  const char *cgroup;
+  char *nl;
+
+  if (!g_file_get_contents ("/proc/self/cgroup", &contents, NULL, &err)) {
+    g_debug ("Failed to read cgroup: %s", err->message);
+    return FALSE;
+  }
+
+  /* cgroup v2 only has the unified hierarchy */
+  if (!g_str_has_prefix (contents, "0::/"))
+    return FALSE;
+
+  cgroup = contents + strlen ("0::");
+  nl = strchr (cgroup, '\n');
+  if (nl)
+    *nl = '\0';
+
+  if (strstr (cgroup, "/user@") == NULL ||
+      !(g_str_has_suffix (cgroup, ".service") || g_str_has_suffix (cgroup, ".scope")))
+    return FALSE;
+
+  /* Restore the configured weight when done */
+  weight_path = g_build_filename ("/sys/fs/cgroup", cgroup, "cpu.weight", NULL);
+  if (!g_file_get_contents (weight_path, &weight, NULL, NULL))
+    return FALSE;
+
+  self->shell.weight = g_ascii_strtoull (weight, NULL, 10) ?: 100;
+  self->shell.unit = g_path_get_basename (cgroup);
+  g_debug ("Shell unit is %s with weight %u", self->shell.unit, self->shell.weight);
+
+  return TRUE;
+}
+
+
+static void
+on_boost_changed (PhoshAppScopes *self)
+{
+  gboolean boost = g_settings_get_boolean (self->settings, APP_SCOPES_KEY_BOOST_FOREGROUND);
+  GHashTableIter iter;
+  const char *app_id;
+
+  if (self->boost == boost)
+    return;
+
+  self->boost = boost;
+  g_debug ("Boosting foreground app: %d", boost);
+
+  /* Back to the configured weight, 0 means systemd's default */
+  g_hash_table_iter_init (&iter, self->units);
+  while (g_hash_table_iter_next (&iter, (gpointer *)&app_id, NULL)) {
+    guint weight;
+
+    if (boost)
+      weight = g_strcmp0 (app_id, self->foreground) ? BACKGROUND_WEIGHT : FOREGROUND_WEIGHT;
+    else
+      weight = g_settings_get_uint (self->settings, APP_SCOPES_KEY_CPU_WEIGHT) ?: 100;
+
+    set_app_weight (self, app_id, weight);
+  }
+
+  if (!boost)
+    phosh_app_scopes_boost_shell (self, FALSE);
+}
+
+
+static gboolean
+on_batch_idle (gpointer data)
+{
+  PhoshAppScopes *self = PHOSH_APP_SCOPES (data);
+  PhoshAppScopeRequest *request;
+
+  /* Send all requests at once without waiting for the replies */
+  while ((request = g_queue_pop_head (&self->pending)))
+    start_scope (self, request);
+
+  self->batch_id = 0;
+  return G_SOURCE_REMOVE;
+}
+
+
+static void
+queue_batch (PhoshAppScopes *self)
+{
+  if (self->batch_id || self->bus == NULL || g_queue_is_empty (&self->pending))
+    return;
+
+  /* Let the launch and the splash go first */
+  self->batch_id = g_idle_add_full (G_PRIORITY_LOW, on_batch_idle, self, NULL);
+  g_source_set_name_by_id (self->batch_id, "[phosh] app scopes batch");
+}
+
+
+static void
+on_bus_get_finished (GObject *source_object, GAsyncResult *res, gpointer data)
+{
+  PhoshAppScopes *self;
+  g_autoptr (GError) err = NULL;
+  GDBusConnection *bus;
+
+  bus = g_bus_get_finish (res, &err);
+  if (!bus) {
+    if (!g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+      g_warning ("Failed to attach to session bus: %s", err->message);
+    return;
+  }
+
+  self = PHOSH_APP_SCOPES (data);
+  self->bus = bus;
+  queue_batch (self);
+}
+
+
+static void
+phosh_app_scopes_dispose (GObject *object)
+{
+  PhoshAppScopes *self = PHOSH_APP_SCOPES (object);
+
+  g_cancellable_cancel (self->cancel);
+  g_clear_object (&self->cancel);
+  g_clear_handle_id (&self->batch_id, g_source_remove);
+  g_queue_clear_full (&self->pending, (GDestroyNotify) phosh_app_scope_request_free);
+
+  g_clear_pointer (&self->units, g_hash_table_destroy);
+  g_clear_pointer (&self->foreground, g_free);
+  g_clear_pointer (&self->shell.unit, g_free);
+
+  g_clear_object (&self->settings);
+  g_clear_object (&self->bus);
+
+  G_OBJECT_CLASS (phosh_app_scopes_parent_class)->dispose (object);
+}
+
+
+static void
+phosh_app_scopes_class_init (PhoshAppScopesClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->dispose = phosh_app_scopes_dispose;
+}
+
+
+static void
+phosh_app_scopes_init (PhoshAppScopes *self)
+{
+  self->cancel = g_cancellable_new ();
+  self->units = g_hash_table_new_full (g_str_hash,
+                                       g_str_equal,
+                                       g_free,
+                                       (GDestroyNotify) g_ptr_array_unref);
+  g_queue_init (&self->pending);
+
+  self->settings = g_settings_new (APP_SCOPES_SCHEMA_ID);
+  g_signal_connect_swapped (self->settings,
+                            "changed::" APP_SCOPES_KEY_BOOST_FOREGROUND,
+                            G_CALLBACK (on_boost_changed),
+                            self);
+  self->boost = g_settings_get_boolean (self->settings, APP_SCOPES_KEY_BOOST_FOREGROUND);
+
+  g_bus_get (G_BUS_TYPE_SESSION, self->cancel, on_bus_get_finished, self);
+}
+
+
+PhoshAppScopes *
+phosh_app_scopes_new (void)
+{
+  return g_object_new (PHOSH_TYPE_APP_SCOPES, NULL);
+}
+
+/**
+ * phosh_app_scopes_add:
+ * @self: The app scopes
+ * @app_id: The app id without the `.desktop` suffix
+ * @pid: The launched process
+ *
+ * Move the launched process into a new scope. This happens
+ * asynchronously in the next batch.
+ */
+void
+phosh_app_scopes_add (PhoshAppScopes *self, const char *app_id, GPid pid)
+{
+  PhoshAppScopeRequest *request;
+
+  g_return_if_fail (PHOSH_IS_APP_SCOPES (self));
+  g_return_if_fail (app_id);
+  g_return_if_fail (pid > 0);
+
+  request = g_new0 (PhoshAppScopeRequest, 1);
+  request->scopes = self;
+  request->app_id = g_strdup (app_id);
+  request->pid = pid;
+  g_queue_push_tail (&self->pending, request);
+
+  queue_batch (self);
+}
+
+/**
+ * phosh_app_scopes_set_foreground:
+ * @self: The app scopes
+ * @app_id: (nullable): The app id of the focused app
+ *
+ * Boost the scopes of the focused app and lower the ones of the
+ * previously focused app. Does nothing unless boosting is enabled.
+ */
+void
+phosh_app_scopes_set_foreground (PhoshAppScopes *self, const char *app_id)
+{
+  g_return_if_fail (PHOSH_IS_APP_SCOPES (self));
+
+  if (g_strcmp0 (self->foreground, app_id) == 0)
+    return;
+
+  if (self->boost && self->foreground)
+    set_app_weight (self, self->foreground, BACKGROUND_WEIGHT);
+
+  g_free (self->foreground);
+  self->foreground = g_strdup (app_id);
+
+  if (self->boost && self->foreground)
+    set_app_weight (self, self->foreground, FOREGROUND_WEIGHT);
+}
+
+/**
+ * phosh_app_scopes_boost_shell:
+ * @self: The app scopes
+ * @boost: Whether to boost the shell
+ *
+ * Boost the shell's own unit e.g. while animating. Does nothing
+ * unless boosting is enabled.
+ */
+void
+phosh_app_scopes_boost_shell (PhoshAppScopes *self, gboolean boost)
+{
+  GVariantBuilder props;
+
+  g_return_if_fail (PHOSH_IS_APP_SCOPES (self));
+
+  if (self->shell.boosted == boost || self->bus == NULL)
+    return;
+
+  if (boost && !self->boost)
+    return;
+
+  if (self->shell.unit == NULL) {
+    if (self->shell.failed || !lookup_shell_unit (self)) {
+      self->shell.failed = TRUE;
+      return;
+    }
+  }
+
+  self->shell.boosted = boost;
+
+  g_variant_builder_init (&props, G_VARIANT_TYPE ("a(sv)"));
+  add_weights (&props, boost ? SHELL_BOOST_WEIGHT : self->shell.weight);
+
+  g_dbus_connection_call (self->bus,
+                          SYSTEMD_BUS_NAME,
+                          SYSTEMD_OBJECT_PATH,
+                          SYSTEMD_MANAGER_INTERFACE,
+                          "SetUnitProperties",
+                          g_variant_new ("(sba(sv))", self->shell.unit, TRUE, &props),
+                          NULL,
+                          G_DBUS_CALL_FLAGS_NO_AUTO_START,
+                          -1,
+                          self->cancel,
+                          NULL,
+                          NULL);
+}
+
+/*
+ * The process might have moved on (e.g. a launcher that exec'ed the
+ * app through another process) so only trust the cgroup if it's still
+ * the unit's one.
+ */
+static const char *
+get_unit_cgroup (PhoshAppUnit *unit)
+{
+  g_autofree char *path = NULL;
+  g_autofree char *contents = NULL;
+  const char *cgroup;
+  char *nl;
+
+  if (unit->cgroup)
+    return unit->cgroup;
+
+  path = g_strdup_printf ("/proc/%d/cgroup", unit->pid);
+  if (!g_file_get_contents (path, &contents, NULL, NULL) || !g_str_has_prefix (contents, "0::/"))
+    return NULL;
+
+  cgroup = contents + strlen ("0::");
+  nl = strchr (cgroup, '\n');
+  if (nl)
+    *nl = '\0';
+
+  if (!g_str_has_suffix (cgroup, unit->name))
+    return NULL;
+
+  unit->cgroup = g_build_filename ("/sys/fs/cgroup", cgroup, NULL);
+  return unit->cgroup;
+}
+
+/**
+ * phosh_app_scopes_get_memory:
+ * @self: The app scopes
+ * @app_id: The app id
+ *
+ * Get the memory currently used by the app's scopes.
+ *
+ * Returns: The used memory in bytes or `0` if not known
+ */
+guint64
+phosh_app_scopes_get_memory (PhoshAppScopes *self, const char *app_id)
+{
+  GPtrArray *units;
+  guint64 memory = 0;
+
+  g_return_val_if_fail (PHOSH_IS_APP_SCOPES (self), 0);
+
+  units = g_hash_table_lookup (self->units, app_id);
+  if (units == NULL)
+    return 0;
+
+  for (guint i = 0; i < units->len; i++) {
+    PhoshAppUnit *unit = g_ptr_array_index (units, i);
+    g_autofree char *path = NULL;
+    g_autofree char *current = NULL;
+    const char *cgroup = get_unit_cgroup (unit);
+
+    if (cgroup == NULL)
+      continue;
+
+    path = g_build_filename (cgroup, "memory.current", NULL);
+    if (g_file_get_contents (path, &current, NULL, NULL))
+      memory += g_ascii_strtoull (current, NULL, 10);
+  }
+
+  return memory;
+}
@@ -0,0 +1,28 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+#define PHOSH_TYPE_APP_SCOPES (phosh_app_scopes_get_type ())
+
+G_DECLARE_FINAL_TYPE (PhoshAppScopes, phosh_app_scopes, PHOSH, APP_SCOPES, GObject)
+
+PhoshAppScopes *phosh_app_scopes_new            (void);
+void            phosh_app_scopes_add            (PhoshAppScopes *self,
+                                                 const char     *app_id,
+                                                 GPid            pid);
+void            phosh_app_scopes_set_foreground (PhoshAppScopes *self,
+                                                 const char     *app_id);
+void            phosh_app_scopes_boost_shell    (PhoshAppScopes *self,
+                                                 gboolean        boost);
+guint64         phosh_app_scopes_get_memory     (PhoshAppScopes *self,
+                                                 const char     *app_id);
+
+G_END_DECLS
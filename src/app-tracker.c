@@ -12,16 +12,16 @@
 #include "phosh-config.h"
 
 #include "app-list-model.h"
+#include "app-prefetcher.h"
+#include "app-scopes.h"
 #include "app-tracker.h"
+#include "launch-stats.h"
 #include "phosh-wayland.h"
 #include "shell-priv.h"
 #include "toplevel-manager.h"
 #include "phosh-marshalers.h"
 #include "util.h"
 
-#define GNOME_DESKTOP_USE_UNSTABLE_API
-#include <libgnome-desktop/gnome-systemd.h>
-
 #include <gtk/gtk.h>
 #include <gio/gio.h>
 #include <gio/gdesktopappinfo.h>
@@ -38,7 +38,9 @@
  *
  * Application state tracker
  *
- * Tracks the startup state of applications
+ * Tracks the startup state of applications. The time it takes
+ * launched apps to become ready and to show their first toplevel is
+ * accounted in [type@LaunchStats].
  */
 
 enum {
@@ -88,6 +90,7 @@ typedef struct  {
 
   char              *startup_id;  /* (owned) */
   GDesktopAppInfo   *info;        /* (owned) */
+  gint64             started;     /* monotonic time in µs */
   PhoshAppTracker   *tracker;     /* (unowned) */
   struct {
     guint              id;
@@ -104,11 +107,27 @@ struct _PhoshAppTracker {
   guint            idle_id;
   struct phosh_private_startup_tracker *wl_tracker; /* PhoshPrivate wayland interface */
   GHashTable      *apps;
+  /* key: app id, value: launch start time of apps waiting for their first toplevel */
+  GHashTable      *awaiting_toplevel;
   GCancellable    *cancel;
+
+  PhoshAppPrefetcher *prefetcher;
+  PhoshAppScopes     *scopes;
 };
 G_DEFINE_TYPE (PhoshAppTracker, phosh_app_tracker, G_TYPE_OBJECT)
 
 
+static void
+launch_failed (PhoshAppTracker *self, PhoshAppState *state)
+{
+  const char *app_id = g_app_info_get_id (G_APP_INFO (state->info));
+
+  phosh_launch_stats_add_failure (app_id);
+  if (app_id)
+    g_hash_table_remove (self->awaiting_toplevel, app_id);
+}
+
+
 static gboolean
 on_startup_timeout (gpointer data)
 {
@@ -152,6 +171,7 @@ on_startup_timeout (gpointer data)
              g_app_info_get_name (G_APP_INFO (state->info)),
              state->startup_id);
 
+  launch_failed (state->tracker, state);
   g_signal_emit (state->tracker, signals[APP_FAILED], 0, state->info, state->startup_id);
   g_hash_table_remove (state->tracker->apps, state->startup_id);
 
@@ -168,6 +188,8 @@ phosh_app_state_new (GDesktopAppInfo    *info,
 {
   PhoshAppState *state = g_new0 (PhoshAppState, 1);
   guint timeout = STARTUP_TIMEOUT;
+  const char *app_id = g_app_info_get_id (G_APP_INFO (info));
+  gint64 *started;
 
   if (G_UNLIKELY (phosh_shell_get_debug_flags () & PHOSH_SHELL_DEBUG_APP_ACTIVATION))
     timeout = DEBUG_STARTUP_TIMEOUT;
@@ -177,10 +199,21 @@ phosh_app_state_new (GDesktopAppInfo    *info,
   state->state = flags;
   state->info = g_object_ref (info);
   state->tracker = tracker;
+  state->started = g_get_monotonic_time ();
   state->timeout.id = g_timeout_add_seconds (timeout, on_startup_timeout, state);
   state->timeout.interval = timeout;
   g_source_set_name_by_id (state->timeout.id, "[phosh] state timeout");
 
+  phosh_launch_stats_add_launch (app_id);
+  /* The first toplevel answers the oldest launch unless that one is stale */
+  started = app_id ? g_hash_table_lookup (tracker->awaiting_toplevel, app_id) : NULL;
+  if (app_id && (started == NULL ||
+                 state->started - *started > APP_TRACKER_MAX_INITIAL_TOPLEVEL_TIMEOUT * G_USEC_PER_SEC)) {
+    g_hash_table_insert (tracker->awaiting_toplevel,
+                         g_strdup (app_id),
+                         g_memdup2 (&state->started, sizeof (gint64)));
+  }
+
   g_debug ("Pid %" G_GINT64_FORMAT ", '%s', startup-id: %s got state %d",
            state->pid,
            g_app_info_get_name (G_APP_INFO (info)),
@@ -313,6 +346,9 @@ startup_tracker_handle_startup_id (void                                 *data,
   }
 
   update_app_state (self, startup_id, PHOSH_APP_TRACKER_STATE_FLAG_WL_STARTUP_ID, 0);
+  phosh_launch_stats_add (g_app_info_get_id (G_APP_INFO (state->info)),
+                          PHOSH_LAUNCH_STATS_READY,
+                          g_get_monotonic_time () - state->started);
   g_signal_emit (self, signals[APP_READY], 0, state->info, startup_id);
 
   /* Startup sequence done */
@@ -375,23 +411,6 @@ on_app_launch_started (PhoshAppTracker   *self,
 }
 
 
-static void
-on_start_systemd_scope_done (GObject *source_object, GAsyncResult *res, gpointer user_data)
-{
-  gboolean success;
-  g_autoptr (GError) err = NULL;
-  g_autofree char * app_id = user_data;
-
-  success = gnome_start_systemd_scope_finish (res, &err);
-  if (!success) {
-    g_warning ("Failed move '%s' to transient systemd unit: %s", app_id, err->message);
-    return;
-  }
-
-  g_debug ("Moved '%s' to transient systemd unit", app_id);
-}
-
-
 static void
 on_app_launched (PhoshAppTracker   *self,
                  GDesktopAppInfo   *info,
@@ -433,14 +452,12 @@ on_app_launched (PhoshAppTracker   *self,
                  info,
                  state->startup_id);
  out:
+  phosh_app_prefetcher_record_launch (self->prefetcher, info, pid);
+
   if (pid && app_id) {
-    gnome_start_systemd_scope (app_id,
-                               pid,
-                               "Application launched by phosh",
-                               self->session_bus,
-                               self->cancel,
-                               on_start_systemd_scope_done,
-                               g_strdup (app_id));
+    g_autofree char *scope_app_id = phosh_strip_suffix_from_app_id (app_id);
+
+    phosh_app_scopes_add (self->scopes, scope_app_id, pid);
   }
 
   g_object_unref (context);
@@ -466,6 +483,7 @@ on_app_launch_failed (PhoshAppTracker   *self,
              g_app_info_get_name (G_APP_INFO (state->info)),
              state->startup_id);
 
+  launch_failed (self, state);
   g_signal_emit (self, signals[APP_FAILED], 0, state->info, startup_id);
 
   g_hash_table_remove (self->apps, startup_id);
@@ -593,6 +611,9 @@ phosh_app_tracker_finalize (GObject *object)
   g_clear_object (&self->cancel);
 
   g_clear_pointer (&self->apps, g_hash_table_destroy);
+  g_clear_pointer (&self->awaiting_toplevel, g_hash_table_destroy);
+  g_clear_object (&self->prefetcher);
+  g_clear_object (&self->scopes);
   g_clear_pointer (&self->wl_tracker, phosh_private_startup_tracker_destroy);
 
   g_clear_handle_id (&self->idle_id, g_source_remove);
@@ -727,6 +748,9 @@ phosh_app_tracker_init (PhoshAppTracker *self)
                                       g_str_equal,
                                       g_free,
                                       (GDestroyNotify) phosh_app_state_free);
+  self->awaiting_toplevel = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+  self->prefetcher = phosh_app_prefetcher_new ();
+  self->scopes = phosh_app_scopes_new ();
   self->idle_id = g_idle_add ((GSourceFunc)on_idle, self);
   g_source_set_name_by_id (self->idle_id, "[PhoshAppTracker] idle");
 
@@ -809,3 +833,70 @@ phosh_app_tracker_launch_app_info (PhoshAppTracker *self, GAppInfo *info)
                 error->message);
   }
 }
+
+
+/**
+ * phosh_app_tracker_prefetch:
+ * @self: The app tracker
+ *
+ * Prefetch the files of the app the user most likely launches
+ * next. Does nothing unless app prefetching is enabled.
+ */
+void
+phosh_app_tracker_prefetch (PhoshAppTracker *self)
+{
+  g_return_if_fail (PHOSH_IS_APP_TRACKER (self));
+
+  phosh_app_prefetcher_prefetch (self->prefetcher);
+}
+
+/**
+ * phosh_app_tracker_get_scopes:
+ * @self: The app tracker
+ *
+ * Get the object that tracks the systemd scopes of launched apps.
+ *
+ * Returns: (transfer none): The app scopes
+ */
+PhoshAppScopes *
+phosh_app_tracker_get_scopes (PhoshAppTracker *self)
+{
+  g_return_val_if_fail (PHOSH_IS_APP_TRACKER (self), NULL);
+
+  return self->scopes;
+}
+
+/**
+ * phosh_app_tracker_add_toplevel:
+ * @self: The app tracker
+ * @toplevel: The toplevel that showed up
+ *
+ * Let the tracker know about a new toplevel. If this is the first
+ * toplevel of a launched app the time since the launch started is
+ * accounted.
+ */
+void
+phosh_app_tracker_add_toplevel (PhoshAppTracker *self, PhoshToplevel *toplevel)
+{
+  g_autoptr (GDesktopAppInfo) info = NULL;
+  const char *app_id;
+  gint64 *started;
+
+  g_return_if_fail (PHOSH_IS_APP_TRACKER (self));
+  g_return_if_fail (PHOSH_IS_TOPLEVEL (toplevel));
+
+  if (g_hash_table_size (self->awaiting_toplevel) == 0)
+    return;
+
+  info = phosh_get_desktop_app_info_for_app_id (phosh_toplevel_get_app_id (toplevel));
+  if (info == NULL)
+    return;
+
+  app_id = g_app_info_get_id (G_APP_INFO (info));
+  started = app_id ? g_hash_table_lookup (self->awaiting_toplevel, app_id) : NULL;
+  if (started == NULL)
+    return;
+
+  phosh_launch_stats_add (app_id, PHOSH_LAUNCH_STATS_TOPLEVEL, g_get_monotonic_time () - *started);
+  g_hash_table_remove (self->awaiting_toplevel, app_id);
+}
@@ -10,6 +10,9 @@
 #include <gio/gio.h>
 #include <gio/gdesktopappinfo.h>
 
+#include "app-scopes.h"
+#include "toplevel.h"
+
 G_BEGIN_DECLS
 
 #define PHOSH_TYPE_APP_TRACKER (phosh_app_tracker_get_type ())
@@ -21,5 +24,9 @@ G_DECLARE_FINAL_TYPE (PhoshAppTracker, phosh_app_tracker, PHOSH, APP_TRACKER, GO
 PhoshAppTracker *phosh_app_tracker_new (void);
 void phosh_app_tracker_launch_app_info (PhoshAppTracker *self,
                                         GAppInfo        *info);
+void phosh_app_tracker_prefetch (PhoshAppTracker *self);
+PhoshAppScopes *phosh_app_tracker_get_scopes (PhoshAppTracker *self);
+void phosh_app_tracker_add_toplevel (PhoshAppTracker *self,
+                                     PhoshToplevel   *toplevel);
 
 G_END_DECLS
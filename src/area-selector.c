@@ -0,0 +1,345 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "phosh-area-selector"
+
+#include "phosh-config.h"
+
+#include "area-selector.h"
+#include "phosh-wayland.h"
+
+#include <math.h>
+
+/**
+ * PhoshAreaSelector:
+ *
+ * A fullscreen overlay on a monitor that lets the user drag out a
+ * rectangle, e.g. to select the area of a screenshot.
+ *
+ * The selection is painted on an otherwise transparent surface and
+ * only the parts where the old and new rectangle differ are redrawn
+ * while dragging. A tap selects the whole monitor, `Escape` cancels.
+ */
+
+#define BORDER_WIDTH 2
+
+enum {
+  PROP_0,
+  PROP_MONITOR,
+  PROP_LAST_PROP,
+};
+static GParamSpec *props[PROP_LAST_PROP];
+
+enum {
+  SELECTED,
+  CANCELLED,
+  N_SIGNALS
+};
+static guint signals[N_SIGNALS];
+
+struct _PhoshAreaSelector {
+  PhoshLayerSurface  parent;
+
+  PhoshMonitor      *monitor;
+  GtkGesture        *drag;
+
+  gboolean           selecting;
+  double             start_x, start_y;
+  /* The current selection in surface coordinates */
+  GdkRectangle       selection;
+};
+G_DEFINE_TYPE (PhoshAreaSelector, phosh_area_selector, PHOSH_TYPE_LAYER_SURFACE)
+
+
+static cairo_region_t *
+get_changed_region (const GdkRectangle *old, const GdkRectangle *new)
+{
+  cairo_region_t *region;
+  GdkRectangle rect, inner;
+
+  /* Everything covered by either selection including the border... */
+  rect = (GdkRectangle) { old->x - BORDER_WIDTH, old->y - BORDER_WIDTH,
+                          old->width + 2 * BORDER_WIDTH, old->height + 2 * BORDER_WIDTH };
+  region = cairo_region_create_rectangle (&rect);
+  rect = (GdkRectangle) { new->x - BORDER_WIDTH, new->y - BORDER_WIDTH,
+                          new->width + 2 * BORDER_WIDTH, new->height + 2 * BORDER_WIDTH };
+  cairo_region_union_rectangle (region, &rect);
+
+  /* ...minus the common interior as that looks the same for both */
+  if (gdk_rectangle_intersect (old, new, &inner)) {
+    inner.x += BORDER_WIDTH;
+    inner.y += BORDER_WIDTH;
+    inner.width -= 2 * BORDER_WIDTH;
+    inner.height -= 2 * BORDER_WIDTH;
+    if (inner.width > 0 && inner.height > 0)
+      cairo_region_subtract_rectangle (region, &inner);
+  }
+
+  return region;
+}
+
+
+static void
+set_selection (PhoshAreaSelector *self, const GdkRectangle *selection)
+{
+  cairo_region_t *region;
+
+  if (gdk_rectangle_equal (&self->selection, selection))
+    return;
+
+  region = get_changed_region (&self->selection, selection);
+  self->selection = *selection;
+  gtk_widget_queue_draw_region (GTK_WIDGET (self), region);
+  cairo_region_destroy (region);
+}
+
+
+static void
+on_drag_begin (PhoshAreaSelector *self, double x, double y)
+{
+  self->selecting = TRUE;
+  self->start_x = x;
+  self->start_y = y;
+  set_selection (self, &(GdkRectangle) { x, y, 0, 0 });
+}
+
+
+static void
+on_drag_update (PhoshAreaSelector *self, double off_x, double off_y)
+{
+  GdkRectangle selection;
+
+  selection.x = floor (MIN (self->start_x, self->start_x + off_x));
+  selection.y = floor (MIN (self->start_y, self->start_y + off_y));
+  selection.width = ceil (fabs (off_x));
+  selection.height = ceil (fabs (off_y));
+
+  set_selection (self, &selection);
+}
+
+
+static void
+on_drag_end (PhoshAreaSelector *self, double off_x, double off_y)
+{
+  GdkRectangle area;
+
+  if (!self->selecting)
+    return;
+
+  on_drag_update (self, off_x, off_y);
+  self->selecting = FALSE;
+
+  area = self->selection;
+  if (area.width == 0 || area.height == 0) {
+    area = (GdkRectangle) { 0, 0,
+                            gtk_widget_get_allocated_width (GTK_WIDGET (self)),
+                            gtk_widget_get_allocated_height (GTK_WIDGET (self)) };
+  }
+
+  /* Make it relative to the global logical layout */
+  area.x += self->monitor->logical.x;
+  area.y += self->monitor->logical.y;
+
+  g_debug ("Selected %d,%d %dx%d", area.x, area.y, area.width, area.height);
+  g_signal_emit (self, signals[SELECTED], 0, &area);
+}
+
+
+static gboolean
+phosh_area_selector_draw (GtkWidget *widget, cairo_t *cr)
+{
+  PhoshAreaSelector *self = PHOSH_AREA_SELECTOR (widget);
+  GtkStyleContext *context = gtk_widget_get_style_context (widget);
+  GdkRGBA color;
+
+  GTK_WIDGET_CLASS (phosh_area_selector_parent_class)->draw (widget, cr);
+
+  if (!self->selecting)
+    return GDK_EVENT_PROPAGATE;
+
+  gtk_style_context_get_color (context, gtk_style_context_get_state (context), &color);
+
+  cairo_save (cr);
+  cairo_rectangle (cr, self->selection.x, self->selection.y,
+                   self->selection.width, self->selection.height);
+  cairo_set_source_rgba (cr, color.red, color.green, color.blue, color.alpha * 0.2);
+  cairo_fill_preserve (cr);
+  gdk_cairo_set_source_rgba (cr, &color);
+  cairo_set_line_width (cr, BORDER_WIDTH);
+  cairo_stroke (cr);
+  cairo_restore (cr);
+
+  return GDK_EVENT_PROPAGATE;
+}
+
+
+static gboolean
+phosh_area_selector_key_press_event (GtkWidget *widget, GdkEventKey *event)
+{
+  PhoshAreaSelector *self = PHOSH_AREA_SELECTOR (widget);
+
+  if (event->keyval == GDK_KEY_Escape) {
+    g_signal_emit (self, signals[CANCELLED], 0);
+    return GDK_EVENT_STOP;
+  }
+
+  return GTK_WIDGET_CLASS (phosh_area_selector_parent_class)->key_press_event (widget, event);
+}
+
+
+static void
+phosh_area_selector_set_property (GObject      *object,
+                                  guint         property_id,
+                                  const GValue *value,
+                                  GParamSpec   *pspec)
+{
+  PhoshAreaSelector *self = PHOSH_AREA_SELECTOR (object);
+
+  switch (property_id) {
+  case PROP_MONITOR:
+    g_set_object (&self->monitor, g_value_get_object (value));
+    break;
+  default:
+    G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    break;
+  }
+}
+
+
+static void
+phosh_area_selector_get_property (GObject    *object,
+                                  guint       property_id,
+                                  GValue     *value,
+                                  GParamSpec *pspec)
+{
+  PhoshAreaSelector *self = PHOSH_AREA_SELECTOR (object);
+
+  switch (property_id) {
+  case PROP_MONITOR:
+    g_value_set_object (value, self->monitor);
+    break;
+  default:
+    G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    break;
+  }
+}
+
+
+static void
+phosh_area_selector_constructed (GObject *object)
+{
+  PhoshAreaSelector *self = PHOSH_AREA_SELECTOR (object);
+  PhoshWayland *wl = phosh_wayland_get_default ();
+
+  g_object_set (PHOSH_LAYER_SURFACE (self),
+                "layer-shell", phosh_wayland_get_zwlr_layer_shell_v1 (wl),
+                "wl-output", phosh_monitor_get_wl_output (self->monitor),
+                "anchor", ZWLR_LAYER_SURFACE_V1_ANCHOR_TOP |
+                ZWLR_LAYER_SURFACE_V1_ANCHOR_BOTTOM |
+                ZWLR_LAYER_SURFACE_V1_ANCHOR_LEFT |
+                ZWLR_LAYER_SURFACE_V1_ANCHOR_RIGHT,
+                "layer", ZWLR_LAYER_SHELL_V1_LAYER_OVERLAY,
+                "kbd-interactivity", TRUE,
+                "exclusive-zone", -1,
+                "namespace", "phosh area selector",
+                NULL);
+
+  G_OBJECT_CLASS (phosh_area_selector_parent_class)->constructed (object);
+
+  gtk_style_context_add_class (gtk_widget_get_style_context (GTK_WIDGET (self)),
+                               "phosh-area-selector");
+
+  self->drag = gtk_gesture_drag_new (GTK_WIDGET (self));
+  gtk_event_controller_set_propagation_phase (GTK_EVENT_CONTROLLER (self->drag), GTK_PHASE_CAPTURE);
+  g_object_connect (self->drag,
+                    "swapped-object-signal::drag-begin", on_drag_begin, self,
+                    "swapped-object-signal::drag-update", on_drag_update, self,
+                    "swapped-object-signal::drag-end", on_drag_end, self,
+                    NULL);
+}
+
+
+static void
+phosh_area_selector_dispose (GObject *object)
+{
+  PhoshAreaSelector *self = PHOSH_AREA_SELECTOR (object);
+
+  g_clear_object (&self->drag);
+  g_clear_object (&self->monitor);
+
+  G_OBJECT_CLASS (phosh_area_selector_parent_class)->dispose (object);
+}
+
+
+static void
+phosh_area_selector_class_init (PhoshAreaSelectorClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
+
+  object_class->get_property = phosh_area_selector_get_property;
+  object_class->set_property = phosh_area_selector_set_property;
+  object_class->constructed = phosh_area_selector_constructed;
+  object_class->dispose = phosh_area_selector_dispose;
+
+  widget_class->draw = phosh_area_selector_draw;
+  widget_class->key_press_event = phosh_area_selector_key_press_event;
+
+  /**
+   * PhoshAreaSelector:monitor:
+   *
+   * The monitor to select an area on
+   */
+  props[PROP_MONITOR] =
+    g_param_spec_object ("monitor", "", "",
+                         PHOSH_TYPE_MONITOR,
+                         G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties (object_class, PROP_LAST_PROP, props);
+
+  /**
+   * PhoshAreaSelector::selected:
+   * @self: The area selector
+   * @area: The selected area in the global logical coordinate space
+   *
+   * Emitted when the user finished selecting an area.
+   */
+  signals[SELECTED] = g_signal_new ("selected",
+                                    G_TYPE_FROM_CLASS (klass),
+                                    G_SIGNAL_RUN_LAST,
+                                    0, NULL, NULL, NULL,
+                                    G_TYPE_NONE,
+                                    1,
+                                    GDK_TYPE_RECTANGLE);
+  /**
+   * PhoshAreaSelector::cancelled:
+   * @self: The area selector
+   *
+   * Emitted when the user cancelled the selection.
+   */
+  signals[CANCELLED] = g_signal_new ("cancelled",
+                                     G_TYPE_FROM_CLASS (klass),
+                                     G_SIGNAL_RUN_LAST,
+                                     0, NULL, NULL, NULL,
+                                     G_TYPE_NONE,
+                                     0);
+}
+
+
+static void
+phosh_area_selector_init (PhoshAreaSelector *self)
+{
+  gtk_widget_add_events (GTK_WIDGET (self),
+                         GDK_BUTTON_PRESS_MASK | GDK_BUTTON_RELEASE_MASK |
+                         GDK_POINTER_MOTION_MASK | GDK_TOUCH_MASK);
+}
+
+
+PhoshAreaSelector *
+phosh_area_selector_new (PhoshMonitor *monitor)
+{
+  return g_object_new (PHOSH_TYPE_AREA_SELECTOR, "monitor", monitor, NULL);
+}
@@ -0,0 +1,21 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include "monitor/monitor.h"
+
+#include <layersurface.h>
+
+G_BEGIN_DECLS
+
+#define PHOSH_TYPE_AREA_SELECTOR (phosh_area_selector_get_type ())
+
+G_DECLARE_FINAL_TYPE (PhoshAreaSelector, phosh_area_selector, PHOSH, AREA_SELECTOR, PhoshLayerSurface)
+
+PhoshAreaSelector *phosh_area_selector_new (PhoshMonitor *monitor);
+
+G_END_DECLS
@@ -17,12 +17,19 @@
  * PhoshAuth:
  *
  * PAM authentication handling
+ *
+ * The PAM handle is kept across attempts so PAM modules are only
+ * loaded once. Use [method@Auth.prepare] to start PAM ahead of time so
+ * an authentication attempt only needs to run `pam_authenticate`.
  */
 
 typedef struct _PhoshAuth {
   GObject       parent;
 
+  /* Protects the PAM handle and the auth token used by the worker threads */
+  GMutex        lock;
   pam_handle_t *pamh;
+  const char   *authtok;
 } PhoshAuth;
 
 
@@ -35,7 +42,8 @@ pam_conversation_cb (int                        num_msg,
                      struct pam_response      **resp,
                      void                      *appdata_ptr)
 {
-  const char *authtok = appdata_ptr;
+  PhoshAuth *self = PHOSH_AUTH (appdata_ptr);
+  const char *authtok = self->authtok;
   int ret = PAM_CONV_ERR;
   g_autofree struct pam_response *pam_resp = g_new0 (struct pam_response, num_msg);
 
@@ -46,6 +54,8 @@ pam_conversation_cb (int                        num_msg,
     switch (msg[i]->msg_style) {
     case PAM_PROMPT_ECHO_OFF:
     case PAM_PROMPT_ECHO_ON:
+      if (authtok == NULL)
+        break;
       pam_resp[i].resp = g_strdup (authtok);
       ret = PAM_SUCCESS;
       break;
@@ -63,35 +73,61 @@ pam_conversation_cb (int                        num_msg,
 }
 
 
-/* return TRUE if auth token is correct, FALSE otherwise */
+/* Must be called with the lock held */
 static gboolean
-authenticate (PhoshAuth *self, const char *authtok)
+start_pam (PhoshAuth *self)
 {
   int ret;
-  gboolean authenticated = FALSE;
+  gint64 start;
   const char *username;
   const struct pam_conv conv = {
     .conv = pam_conversation_cb,
-    .appdata_ptr = (void*)authtok,
+    .appdata_ptr = self,
   };
 
-  if (self->pamh == NULL) {
-    username = g_get_user_name ();
-    ret = pam_start ("phosh", username, &conv, &self->pamh);
-    if (ret != PAM_SUCCESS) {
-      g_warning ("PAM start error %s", pam_strerror (self->pamh, ret));
-      goto out;
-    }
+  if (self->pamh)
+    return TRUE;
+
+  start = g_get_monotonic_time ();
+  username = g_get_user_name ();
+  ret = pam_start ("phosh", username, &conv, &self->pamh);
+  if (ret != PAM_SUCCESS) {
+    g_warning ("PAM start error %s", pam_strerror (self->pamh, ret));
+    self->pamh = NULL;
+    return FALSE;
   }
+  g_debug ("pam_start took %.2fms", (g_get_monotonic_time () - start) / 1000.0);
+
+  return TRUE;
+}
+
+
+/* return TRUE if auth token is correct, FALSE otherwise */
+static gboolean
+authenticate (PhoshAuth *self, const char *authtok)
+{
+  g_autoptr (GMutexLocker) locker = g_mutex_locker_new (&self->lock);
+  int ret;
+  gint64 start;
+  gboolean authenticated = FALSE;
+
+  if (!start_pam (self))
+    return FALSE;
 
+  self->authtok = authtok;
+
+  start = g_get_monotonic_time ();
   ret = pam_authenticate (self->pamh, 0);
+  g_debug ("pam_authenticate took %.2fms", (g_get_monotonic_time () - start) / 1000.0);
   if (ret != PAM_SUCCESS) {
     if (ret != PAM_AUTH_ERR)
       g_warning ("pam_authenticate error %s", pam_strerror (self->pamh, ret));
     goto out;
   }
 
+  start = g_get_monotonic_time ();
   ret = pam_acct_mgmt (self->pamh, 0);
+  g_debug ("pam_acct_mgmt took %.2fms", (g_get_monotonic_time () - start) / 1000.0);
   if (ret != PAM_SUCCESS) {
     g_warning ("pam_acct check failed: %s\n", pam_strerror (self->pamh, ret));
     goto out;
@@ -99,16 +135,32 @@ authenticate (PhoshAuth *self, const char *authtok)
 
   authenticated = TRUE;
 
+  start = g_get_monotonic_time ();
   ret = pam_end (self->pamh, ret);
+  g_debug ("pam_end took %.2fms", (g_get_monotonic_time () - start) / 1000.0);
   if (ret != PAM_SUCCESS)
     g_warning ("pam_end error %d", ret);
   self->pamh = NULL;
 
  out:
+  self->authtok = NULL;
   return authenticated;
 }
 
 
+static void
+prepare_thread (GTask        *task,
+                gpointer      source_object,
+                gpointer      task_data,
+                GCancellable *cancellable)
+{
+  PhoshAuth *self = PHOSH_AUTH (source_object);
+  g_autoptr (GMutexLocker) locker = g_mutex_locker_new (&self->lock);
+
+  g_task_return_boolean (task, start_pam (self));
+}
+
+
 static void
 authenticate_thread (GTask        *task,
                      gpointer      source_object,
@@ -142,6 +194,7 @@ phosh_auth_finalize (GObject *object)
       g_warning ("pam_end error %s", pam_strerror (self->pamh, ret));
     self->pamh = NULL;
   }
+  g_mutex_clear (&self->lock);
 
   parent_class->finalize (object);
 }
@@ -159,6 +212,7 @@ phosh_auth_class_init (PhoshAuthClass *klass)
 static void
 phosh_auth_init (PhoshAuth *self)
 {
+  g_mutex_init (&self->lock);
 }
 
 
@@ -169,6 +223,26 @@ phosh_auth_new (void)
 }
 
 
+/**
+ * phosh_auth_prepare:
+ * @self: The auth object
+ *
+ * Start PAM in a worker thread so a later authentication attempt
+ * doesn't need to load the PAM modules anymore.
+ */
+void
+phosh_auth_prepare (PhoshAuth *self)
+{
+  g_autoptr (GTask) task = NULL;
+
+  g_return_if_fail (PHOSH_IS_AUTH (self));
+
+  task = g_task_new (self, NULL, NULL, NULL);
+  g_task_set_source_tag (task, phosh_auth_prepare);
+  g_task_run_in_thread (task, prepare_thread);
+}
+
+
 void
 phosh_auth_authenticate_async (PhoshAuth           *self,
                                const char          *authtok,
@@ -0,0 +1,346 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "phosh-auto-brightness-filter"
+
+#include "phosh-config.h"
+
+#include "auto-brightness-filter.h"
+
+#include <math.h>
+
+/* Time constant of the exponential moving average */
+#define SMOOTHING_TAU_US       (2 * G_USEC_PER_SEC)
+/* Samples further away than that from the average (in decades) are outliers */
+#define OUTLIER_DELTA          0.5
+/* Number of consecutive outliers in the same direction to accept a new level */
+#define OUTLIER_COUNT          3
+/* Minimum brightness change to notify about */
+#define HYSTERESIS             0.05
+/* Minimum time between two brightness changes */
+#define HOLD_TIME_US           (3 * G_USEC_PER_SEC)
+
+/**
+ * PhoshAutoBrightnessFilter:
+ *
+ * Auto brightness handling that filters the ambient light samples
+ *
+ * Ambient light levels are smoothed with an exponential moving
+ * average in log space. Single spikes (e.g. a shadow of a hand or a
+ * flash light) are rejected and the brightness only changes once the
+ * difference is significant and the last change is old enough. This
+ * avoids flicker that a plain bucket approach suffers from when the
+ * ambient light level hovers around a bucket's border.
+ */
+
+enum {
+  PROP_0,
+  PROP_BRIGHTNESS,
+  PROP_BACKLIGHT,
+  PROP_LAST_PROP
+};
+static GParamSpec *props[PROP_LAST_PROP];
+
+
+typedef struct {
+  double lux;
+  double brightness;
+} CurvePoint;
+
+/* Same data points as PhoshAutoBrightnessBucket, interpolated in log space */
+static CurvePoint curve[] = {
+  {     0, 0.10 },
+  {    10, 0.25 },
+  {    50, 0.40 },
+  {   200, 0.55 },
+  {   300, 0.70 },
+  {   500, 0.85 },
+  {  1000, 1.00 },
+  {  4000, 1.15 },
+  {  8000, 1.30 },
+};
+
+
+struct _PhoshAutoBrightnessFilter {
+  GObject               parent;
+
+  PhoshBacklight       *backlight;
+  double                brightness;
+
+  gboolean              have_level;
+  double                average;
+  gint64                last_sample;
+  gint64                last_change;
+  int                   outliers;
+
+  double                pending;
+  guint                 hold_id;
+};
+
+
+static void auto_brightness_interface_init (PhoshAutoBrightnessInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (PhoshAutoBrightnessFilter, phosh_auto_brightness_filter, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (PHOSH_TYPE_AUTO_BRIGHTNESS,
+                                                auto_brightness_interface_init))
+
+static double
+to_log (double lux)
+{
+  return log10 (MAX (lux, 0.0) + 1.0);
+}
+
+
+static double
+log_to_brightness (double log_lux)
+{
+  double x0, x1;
+
+  if (log_lux <= to_log (curve[0].lux))
+    return curve[0].brightness;
+
+  for (guint i = 1; i < G_N_ELEMENTS (curve); i++) {
+    x1 = to_log (curve[i].lux);
+    if (log_lux > x1)
+      continue;
+
+    x0 = to_log (curve[i - 1].lux);
+    return curve[i - 1].brightness +
+      (curve[i].brightness - curve[i - 1].brightness) * (log_lux - x0) / (x1 - x0);
+  }
+
+  return curve[G_N_ELEMENTS (curve) - 1].brightness;
+}
+
+
+static void
+set_brightness (PhoshAutoBrightnessFilter *self, double brightness, gint64 time)
+{
+  self->last_change = time;
+
+  if (G_APPROX_VALUE (self->brightness, brightness, FLT_EPSILON))
+    return;
+
+  g_debug ("Brightness %.2f -> %.2f", self->brightness, brightness);
+  self->brightness = brightness;
+  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_BRIGHTNESS]);
+}
+
+
+static gboolean
+on_hold_timeout (gpointer user_data)
+{
+  PhoshAutoBrightnessFilter *self = PHOSH_AUTO_BRIGHTNESS_FILTER (user_data);
+
+  self->hold_id = 0;
+  set_brightness (self, self->pending, g_get_monotonic_time ());
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static void
+update_brightness (PhoshAutoBrightnessFilter *self, gint64 time)
+{
+  double brightness = log_to_brightness (self->average);
+  gint64 remaining;
+
+  if (fabs (brightness - self->brightness) < HYSTERESIS) {
+    g_clear_handle_id (&self->hold_id, g_source_remove);
+    return;
+  }
+
+  remaining = self->last_change + HOLD_TIME_US - time;
+  if (remaining <= 0) {
+    g_clear_handle_id (&self->hold_id, g_source_remove);
+    set_brightness (self, brightness, time);
+    return;
+  }
+
+  /* Apply once the hold time passed in case no further samples arrive */
+  self->pending = brightness;
+  if (self->hold_id)
+    return;
+
+  self->hold_id = g_timeout_add (remaining / 1000 + 1, on_hold_timeout, self);
+  g_source_set_name_by_id (self->hold_id, "[phosh] auto brightness hold");
+}
+
+
+static void
+auto_brightness_filter_add_ambient_level (PhoshAutoBrightness *auto_brightness, double level)
+{
+  PhoshAutoBrightnessFilter *self = PHOSH_AUTO_BRIGHTNESS_FILTER (auto_brightness);
+
+  phosh_auto_brightness_filter_add_ambient_level_at (self, level, g_get_monotonic_time ());
+}
+
+
+static double
+auto_brightness_filter_get_brightness (PhoshAutoBrightness *auto_brightness)
+{
+  PhoshAutoBrightnessFilter *self = PHOSH_AUTO_BRIGHTNESS_FILTER (auto_brightness);
+
+  return self->brightness;
+}
+
+
+static PhoshBacklight *
+auto_brightness_filter_get_backlight (PhoshAutoBrightness *auto_brightness)
+{
+  PhoshAutoBrightnessFilter *self = PHOSH_AUTO_BRIGHTNESS_FILTER (auto_brightness);
+
+  return self->backlight;
+}
+
+
+static void
+auto_brightness_interface_init (PhoshAutoBrightnessInterface *iface)
+{
+  iface->add_ambient_level = auto_brightness_filter_add_ambient_level;
+  iface->get_brightness = auto_brightness_filter_get_brightness;
+  iface->get_backlight = auto_brightness_filter_get_backlight;
+}
+
+
+static void
+phosh_auto_brightness_filter_set_property (GObject      *object,
+                                           guint         property_id,
+                                           const GValue *value,
+                                           GParamSpec   *pspec)
+{
+  PhoshAutoBrightnessFilter *self = PHOSH_AUTO_BRIGHTNESS_FILTER (object);
+
+  switch (property_id) {
+  case PROP_BACKLIGHT:
+    g_set_object (&self->backlight, g_value_get_object (value));
+    break;
+  default:
+    G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    break;
+  }
+}
+
+
+static void
+phosh_auto_brightness_filter_get_property (GObject    *object,
+                                           guint       property_id,
+                                           GValue     *value,
+                                           GParamSpec *pspec)
+{
+  PhoshAutoBrightnessFilter *self = PHOSH_AUTO_BRIGHTNESS_FILTER (object);
+
+  switch (property_id) {
+  case PROP_BACKLIGHT:
+    g_value_set_object (value, self->backlight);
+    break;
+  case PROP_BRIGHTNESS:
+    g_value_set_double (value, self->brightness);
+    break;
+  default:
+    G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    break;
+  }
+}
+
+
+static void
+phosh_auto_brightness_filter_dispose (GObject *object)
+{
+  PhoshAutoBrightnessFilter *self = PHOSH_AUTO_BRIGHTNESS_FILTER (object);
+
+  g_clear_handle_id (&self->hold_id, g_source_remove);
+  g_clear_object (&self->backlight);
+
+  G_OBJECT_CLASS (phosh_auto_brightness_filter_parent_class)->dispose (object);
+}
+
+
+static void
+phosh_auto_brightness_filter_class_init (PhoshAutoBrightnessFilterClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->get_property = phosh_auto_brightness_filter_get_property;
+  object_class->set_property = phosh_auto_brightness_filter_set_property;
+  object_class->dispose = phosh_auto_brightness_filter_dispose;
+
+  g_object_class_override_property (object_class, PROP_BACKLIGHT, "backlight");
+  props[PROP_BACKLIGHT] = g_object_class_find_property (object_class, "backlight");
+
+  g_object_class_override_property (object_class, PROP_BRIGHTNESS, "brightness");
+  props[PROP_BRIGHTNESS] = g_object_class_find_property (object_class, "brightness");
+}
+
+
+static void
+phosh_auto_brightness_filter_init (PhoshAutoBrightnessFilter *self)
+{
+  self->brightness = 0.55;
+}
+
+
+PhoshAutoBrightnessFilter *
+phosh_auto_brightness_filter_new (void)
+{
+  return g_object_new (PHOSH_TYPE_AUTO_BRIGHTNESS_FILTER, NULL);
+}
+
+/**
+ * phosh_auto_brightness_filter_add_ambient_level_at:
+ * @self: The auto brightness filter
+ * @level: The ambient light level in lux
+ * @time: The monotonic time the sample was taken in microseconds
+ *
+ * Add an ambient light sample taken at the given time. This is
+ * mostly useful for testing, use `phosh_auto_brightness_add_ambient_level()`
+ * otherwise.
+ */
+void
+phosh_auto_brightness_filter_add_ambient_level_at (PhoshAutoBrightnessFilter *self,
+                                                   double                     level,
+                                                   gint64                     time)
+{
+  double log_level, delta, alpha;
+
+  g_return_if_fail (PHOSH_IS_AUTO_BRIGHTNESS_FILTER (self));
+
+  log_level = to_log (level);
+
+  /* The first sample determines the brightness right away */
+  if (!self->have_level) {
+    self->have_level = TRUE;
+    self->average = log_level;
+    self->last_sample = time;
+    set_brightness (self, log_to_brightness (self->average), time);
+    return;
+  }
+
+  delta = log_level - self->average;
+  if (fabs (delta) > OUTLIER_DELTA) {
+    /* Count consecutive outliers in one direction, reset on direction change */
+    if ((delta > 0) != (self->outliers > 0))
+      self->outliers = 0;
+    self->outliers += delta > 0 ? 1 : -1;
+
+    if (ABS (self->outliers) < OUTLIER_COUNT) {
+      g_debug ("Ignoring outlier %.2f lux", level);
+      return;
+    }
+
+    /* A persistent change (e.g. going outdoors), don't smooth it out */
+    g_debug ("Accepting new ambient light level %.2f lux", level);
+    self->average = log_level;
+  } else {
+    alpha = 1.0 - exp (-(double)MAX (time - self->last_sample, 0) / SMOOTHING_TAU_US);
+    self->average += alpha * delta;
+  }
+
+  self->outliers = 0;
+  self->last_sample = time;
+
+  update_brightness (self, time);
+}
@@ -0,0 +1,25 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include "auto-brightness.h"
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+#define PHOSH_TYPE_AUTO_BRIGHTNESS_FILTER (phosh_auto_brightness_filter_get_type ())
+
+G_DECLARE_FINAL_TYPE (PhoshAutoBrightnessFilter, phosh_auto_brightness_filter,
+                      PHOSH, AUTO_BRIGHTNESS_FILTER, GObject)
+
+PhoshAutoBrightnessFilter *phosh_auto_brightness_filter_new (void);
+void                       phosh_auto_brightness_filter_add_ambient_level_at (PhoshAutoBrightnessFilter *self,
+                                                                              double                     level,
+                                                                              gint64                     time);
+
+G_END_DECLS
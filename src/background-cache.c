@@ -4,6 +4,11 @@
  * SPDX-License-Identifier: GPL-3.0-or-later
  *
  * Author: Guido Günther <agx@sigxcpu.org>
+ *
+ * Scaling derived in parts from GnomeBG which is
+ *
+ * Copyright (C) 2000 Eazel, Inc.
+ * Copyright (C) 2007-2008 Red Hat, Inc.
  */
 
 #define G_LOG_DOMAIN "phosh-background-cache"
@@ -12,29 +17,430 @@
 
 #include "background-cache.h"
 #include "background-image.h"
+#include "memory-stats.h"
 #include "util.h"
 
 #include <gio/gio.h>
 
+#include <errno.h>
+#include <math.h>
+#include <string.h>
+
+/* Number of scaled backgrounds to keep around, e.g. both orientations for two monitors */
+#define MAX_SCALED 6
+/* Number of decoded source images to keep around, e.g. home and lock screen plus next slide */
+#define MAX_IMAGES 4
+/* Memory budget for decoded and scaled images */
+#define MAX_BYTES (128 * 1024 * 1024)
+
+/* Blurred backgrounds are blurred at 1/BLUR_DOWNSCALE of their size */
+#define BLUR_DOWNSCALE 8
+#define BLUR_RADIUS 3
+/* Three box blurs approximate a gaussian blur */
+#define BLUR_PASSES 3
+/* Brightness of dimmed backgrounds in 1/256 */
+#define DIM_FACTOR 154
+
+#define COLOR_TO_PIXEL(color)     ((((int)(color->red   * 255)) << 24) | \
+                                   (((int)(color->green * 255)) << 16) | \
+                                   (((int)(color->blue  * 255)) << 8)  | \
+                                   (((int)(color->alpha * 255))))
+
 /**
  * PhoshBackgroundCache:
  *
  * A cache of background images
+ *
+ * Images are decoded at [method@BackgroundCache.ensure_size] rather
+ * than their native resolution. The results of scaling them to a
+ * monitor are cached too so that e.g. rotating the phone back and
+ * forth or locking the screen doesn't scale the image again.
+ *
+ * The last scaled background for each output size is also stored in
+ * `$XDG_CACHE_HOME/phosh/backgrounds/` as raw pixel data so it can be
+ * mapped and shown right away on the next start while the real image
+ * is still loading. See [method@BackgroundCache.lookup_disk].
+ *
+ * Scaled backgrounds can also have an effect applied, e.g. the lock
+ * screen uses a blurred and dimmed variant. The effect is computed
+ * once when scaling and cached with the scaled background.
+ *
+ * Memory use is bounded by the number of images and their size in
+ * bytes: least recently used images that aren't used by any
+ * background anymore get evicted. On low memory warnings all unused
+ * images are dropped.
  */
 
+#define DISK_CACHE_MAGIC "PHBG"
+#define DISK_CACHE_VERSION 1
+
+/* Header of the on disk cache, followed by the key and the pixel data */
+typedef struct {
+  char    magic[4];
+  guint32 version;
+  guint32 width;
+  guint32 height;
+  guint32 rowstride;
+  guint32 has_alpha;
+  /* Identifies the state of the source image */
+  guint64 mtime;
+  guint64 source_size;
+  guint32 key_len;
+} DiskCacheHeader;
+
+typedef struct {
+  GList      link;
+  char      *key;
+  GFile     *file;
+  /* The source image the pixbuf was scaled from */
+  GWeakRef   image;
+  GdkPixbuf *pixbuf;
+} PhoshBackgroundCacheScaled;
+
+typedef struct {
+  GList                 link;
+  GFile                *file;
+  PhoshBackgroundImage *image;
+  gsize                 bytes;
+} PhoshBackgroundCacheImage;
+
 struct _PhoshBackgroundCache {
   GObject     parent;
 
+  /* key: GFile, value: PhoshBackgroundCacheImage */
   GHashTable *background_images;
+  /* Most recently used first */
+  GQueue      images_lru;
+  int         max_size;
+  /* Memory used by decoded and scaled images */
+  gsize       bytes;
+
+  GMemoryMonitor *memory_monitor;
+
+  /* key: scaled key, value: PhoshBackgroundCacheScaled */
+  GHashTable *scaled;
+  /* Most recently used first */
+  GQueue      scaled_lru;
 };
 G_DEFINE_TYPE (PhoshBackgroundCache, phosh_background_cache, G_TYPE_OBJECT)
 
 
+static void
+scaled_free (PhoshBackgroundCacheScaled *scaled)
+{
+  g_free (scaled->key);
+  g_clear_object (&scaled->file);
+  g_weak_ref_clear (&scaled->image);
+  g_clear_object (&scaled->pixbuf);
+  g_free (scaled);
+}
+
+
+static void
+image_entry_free (PhoshBackgroundCacheImage *entry)
+{
+  g_clear_object (&entry->file);
+  g_clear_object (&entry->image);
+  g_free (entry);
+}
+
+
+static gsize
+get_pixbuf_bytes (GdkPixbuf *pixbuf)
+{
+  return pixbuf ? gdk_pixbuf_get_byte_length (pixbuf) : 0;
+}
+
+
+static void
+drop_scaled (PhoshBackgroundCache *self, PhoshBackgroundCacheScaled *scaled)
+{
+  self->bytes -= get_pixbuf_bytes (scaled->pixbuf);
+  g_queue_unlink (&self->scaled_lru, &scaled->link);
+  /* Frees the entry */
+  g_hash_table_remove (self->scaled, scaled->key);
+}
+
+
+static void
+drop_scaled_for_file (PhoshBackgroundCache *self, GFile *file)
+{
+  GList *l = self->scaled_lru.head;
+
+  while (l) {
+    PhoshBackgroundCacheScaled *scaled = l->data;
+
+    l = l->next;
+    if (file == NULL || g_file_equal (scaled->file, file))
+      drop_scaled (self, scaled);
+  }
+}
+
+
+static void
+drop_image (PhoshBackgroundCache *self, PhoshBackgroundCacheImage *entry)
+{
+  g_debug ("Evicting background %s", g_file_peek_path (entry->file));
+
+  drop_scaled_for_file (self, entry->file);
+  self->bytes -= entry->bytes;
+  g_queue_unlink (&self->images_lru, &entry->link);
+  /* Frees the entry */
+  g_hash_table_remove (self->background_images, entry->file);
+}
+
+
+static gboolean
+image_in_use (PhoshBackgroundCacheImage *entry)
+{
+  /* Backgrounds showing the image hold a reference too */
+  return G_OBJECT (entry->image)->ref_count > 1;
+}
+
+
+/* Evict unused images (lru first) until we're within the given bounds */
+static void
+trim (PhoshBackgroundCache *self, guint max_images, gsize max_bytes)
+{
+  GList *l = self->images_lru.tail;
+
+  while (l && (self->images_lru.length > max_images || self->bytes > max_bytes)) {
+    PhoshBackgroundCacheImage *entry = l->data;
+
+    l = l->prev;
+    if (!image_in_use (entry))
+      drop_image (self, entry);
+  }
+
+  /* Scaled images can be recreated from their source */
+  while (self->scaled_lru.length && self->bytes > max_bytes)
+    drop_scaled (self, self->scaled_lru.tail->data);
+}
+
+
+static void
+on_low_memory_warning (PhoshBackgroundCache       *self,
+                       GMemoryMonitorWarningLevel  level,
+                       GMemoryMonitor             *monitor)
+{
+  g_debug ("Low memory warning %d, dropping unused backgrounds", level);
+  trim (self, 0, 0);
+}
+
+
+static char *
+get_scaled_key (GFile                   *file,
+                int                      width,
+                int                      height,
+                GDesktopBackgroundStyle  style,
+                const GdkRGBA           *color,
+                PhoshBackgroundEffect    effect)
+{
+  g_autofree char *uri = g_file_get_uri (file);
+  guint32 pixel = 0;
+
+  /* Only 'scaled' fills the borders with the color */
+  if (style == G_DESKTOP_BACKGROUND_STYLE_SCALED)
+    pixel = COLOR_TO_PIXEL (color);
+  else
+    style = G_DESKTOP_BACKGROUND_STYLE_ZOOM;
+
+  if (effect == PHOSH_BACKGROUND_EFFECT_NONE)
+    return g_strdup_printf ("%s|%dx%d|%d|%08x", uri, width, height, style, pixel);
+
+  return g_strdup_printf ("%s|%dx%d|%d|%08x|%d", uri, width, height, style, pixel, effect);
+}
+
+
+/* Box blur along rows using a running sum */
+static void
+box_blur_h (const guint8 *src, guint8 *dst, int width, int height, int rowstride, int n_channels)
+{
+  const int div = 2 * BLUR_RADIUS + 1;
+
+  for (int y = 0; y < height; y++) {
+    const guint8 *in = src + y * rowstride;
+    guint8 *out = dst + y * rowstride;
+
+    for (int c = 0; c < n_channels; c++) {
+      guint sum = 0;
+
+      for (int i = -BLUR_RADIUS; i <= BLUR_RADIUS; i++)
+        sum += in[CLAMP (i, 0, width - 1) * n_channels + c];
+
+      for (int x = 0; x < width; x++) {
+        out[x * n_channels + c] = sum / div;
+        sum += in[MIN (x + BLUR_RADIUS + 1, width - 1) * n_channels + c];
+        sum -= in[MAX (x - BLUR_RADIUS, 0) * n_channels + c];
+      }
+    }
+  }
+}
+
+
+/* Box blur along columns. Sums whole rows at once to stay cache friendly */
+static void
+box_blur_v (const guint8 *src, guint8 *dst, int width, int height, int rowstride, int n_channels)
+{
+  const int div = 2 * BLUR_RADIUS + 1;
+  const int len = width * n_channels;
+  g_autofree guint *sums = g_new0 (guint, len);
+
+  for (int i = -BLUR_RADIUS; i <= BLUR_RADIUS; i++) {
+    const guint8 *in = src + CLAMP (i, 0, height - 1) * rowstride;
+
+    for (int k = 0; k < len; k++)
+      sums[k] += in[k];
+  }
+
+  for (int y = 0; y < height; y++) {
+    const guint8 *add = src + MIN (y + BLUR_RADIUS + 1, height - 1) * rowstride;
+    const guint8 *sub = src + MAX (y - BLUR_RADIUS, 0) * rowstride;
+    guint8 *out = dst + y * rowstride;
+
+    for (int k = 0; k < len; k++) {
+      out[k] = sums[k] / div;
+      sums[k] = sums[k] + add[k] - sub[k];
+    }
+  }
+}
+
+
+static void
+dim_pixels (guint8 *pixels, int width, int height, int rowstride, int n_channels)
+{
+  for (int y = 0; y < height; y++) {
+    guint8 *row = pixels + y * rowstride;
+
+    for (int x = 0; x < width; x++) {
+      /* Leave alpha alone */
+      for (int c = 0; c < 3; c++)
+        row[x * n_channels + c] = (row[x * n_channels + c] * DIM_FACTOR) >> 8;
+    }
+  }
+}
+
+
+/*
+ * Blurring the full size image is slow so downsample, blur and
+ * upscale again. Upscaling smooths out the remaining artifacts.
+ */
+static GdkPixbuf *
+blur_pixbuf (GdkPixbuf *src)
+{
+  g_autoptr (GdkPixbuf) small = NULL;
+  g_autoptr (GdkPixbuf) tmp = NULL;
+  int width, height, small_width, small_height, rowstride, n_channels;
+  guint8 *pixels, *tmp_pixels;
+
+  width = gdk_pixbuf_get_width (src);
+  height = gdk_pixbuf_get_height (src);
+  small_width = MAX (1, width / BLUR_DOWNSCALE);
+  small_height = MAX (1, height / BLUR_DOWNSCALE);
+
+  small = gdk_pixbuf_scale_simple (src, small_width, small_height, GDK_INTERP_BILINEAR);
+  tmp = gdk_pixbuf_copy (small);
+  if (small == NULL || tmp == NULL)
+    return NULL;
+
+  pixels = gdk_pixbuf_get_pixels (small);
+  tmp_pixels = gdk_pixbuf_get_pixels (tmp);
+  rowstride = gdk_pixbuf_get_rowstride (small);
+  n_channels = gdk_pixbuf_get_n_channels (small);
+  g_assert (rowstride == gdk_pixbuf_get_rowstride (tmp));
+
+  for (int i = 0; i < BLUR_PASSES; i++) {
+    box_blur_h (pixels, tmp_pixels, small_width, small_height, rowstride, n_channels);
+    box_blur_v (tmp_pixels, pixels, small_width, small_height, rowstride, n_channels);
+  }
+  dim_pixels (pixels, small_width, small_height, rowstride, n_channels);
+
+  return gdk_pixbuf_scale_simple (small, width, height, GDK_INTERP_BILINEAR);
+}
+
+
+static GdkPixbuf *
+pb_scale_to_fit (GdkPixbuf *src, int width, int height, const GdkRGBA *color)
+{
+  int orig_width, orig_height;
+  int final_width, final_height;
+  int off_x, off_y;
+  double ratio_horiz, ratio_vert, ratio;
+  GdkPixbuf *bg;
+
+  bg = gdk_pixbuf_new (GDK_COLORSPACE_RGB, FALSE, 8, width, height);
+  gdk_pixbuf_fill (bg, COLOR_TO_PIXEL(color));
+
+  orig_width = gdk_pixbuf_get_width (src);
+  orig_height = gdk_pixbuf_get_height (src);
+  ratio_horiz = (double) width / orig_width;
+  ratio_vert = (double) height / orig_height;
+
+  ratio = ratio_horiz > ratio_vert ? ratio_vert : ratio_horiz;
+  final_width = ceil (ratio * orig_width);
+  final_height = ceil (ratio * orig_height);
+
+  off_x = (width - final_width) / 2;
+  off_y = (height - final_height) / 2;
+  gdk_pixbuf_composite (src,
+                        bg,
+                        off_x, off_y, /* dest x,y */
+                        final_width,
+                        final_height,
+                        off_x, off_y, /* offset x, y */
+                        ratio,
+                        ratio,
+                        GDK_INTERP_BILINEAR,
+                        255);
+  return bg;
+}
+
+
+static GdkPixbuf *
+image_background (PhoshBackgroundImage    *image,
+                  guint                    width,
+                  guint                    height,
+                  GDesktopBackgroundStyle  style,
+                  const GdkRGBA           *color)
+{
+  GdkPixbuf *scaled_bg = NULL;;
+
+  if (image == NULL) {
+    g_debug ("No image, using 'none' desktop style");
+    style = G_DESKTOP_BACKGROUND_STYLE_NONE;
+  }
+
+  switch (style) {
+  case G_DESKTOP_BACKGROUND_STYLE_NONE:
+    /* Nothing to do */
+    break;
+  case G_DESKTOP_BACKGROUND_STYLE_SCALED:
+    scaled_bg = pb_scale_to_fit (phosh_background_image_get_pixbuf (image), width, height, color);
+    break;
+  case G_DESKTOP_BACKGROUND_STYLE_WALLPAPER:
+  case G_DESKTOP_BACKGROUND_STYLE_CENTERED:
+  case G_DESKTOP_BACKGROUND_STYLE_STRETCHED:
+  case G_DESKTOP_BACKGROUND_STYLE_SPANNED:
+    g_warning ("Unimplemented style %d, using zoom", style);
+    G_GNUC_FALLTHROUGH;
+  case G_DESKTOP_BACKGROUND_STYLE_ZOOM:
+  default:
+    scaled_bg = phosh_utils_pixbuf_scale_to_min (phosh_background_image_get_pixbuf (image),
+                                                 width,
+                                                 height);
+    break;
+  }
+
+  return scaled_bg;
+}
+
+
 static void
 on_background_image_loaded (GObject *source_object, GAsyncResult *res, gpointer user_data)
 {
   g_autoptr (GTask) task = G_TASK (user_data);
   PhoshBackgroundCache *self;
+  PhoshBackgroundCacheImage *entry;
   PhoshBackgroundImage *image;
   GError *err = NULL;
   GFile *file;
@@ -48,17 +454,47 @@ on_background_image_loaded (GObject *source_object, GAsyncResult *res, gpointer
   self = PHOSH_BACKGROUND_CACHE (g_task_get_source_object (task));
   g_return_if_fail (PHOSH_IS_BACKGROUND_CACHE (self));
   file = phosh_background_image_get_file (image);
-  g_hash_table_insert (self->background_images, g_object_ref (file), g_object_ref (image));
+
+  entry = g_hash_table_lookup (self->background_images, file);
+  if (entry)
+    drop_image (self, entry);
+
+  entry = g_new0 (PhoshBackgroundCacheImage, 1);
+  entry->file = g_object_ref (file);
+  entry->image = g_object_ref (image);
+  entry->bytes = get_pixbuf_bytes (phosh_background_image_get_pixbuf (image));
+  entry->link.data = entry;
+
+  g_hash_table_insert (self->background_images, entry->file, entry);
+  g_queue_push_head_link (&self->images_lru, &entry->link);
+  self->bytes += entry->bytes;
+  trim (self, MAX_IMAGES, MAX_BYTES);
 
   g_task_return_pointer (task, g_steal_pointer (&image), g_object_unref);
 }
 
 
+static void
+report_memory (gpointer data, guint64 *n_items, guint64 *bytes)
+{
+  PhoshBackgroundCache *self = PHOSH_BACKGROUND_CACHE (data);
+
+  *n_items = self->images_lru.length + self->scaled_lru.length;
+  *bytes = self->bytes;
+}
+
+
 static void
 phosh_background_cache_finalize (GObject *object)
 {
   PhoshBackgroundCache *self = PHOSH_BACKGROUND_CACHE (object);
 
+  phosh_memory_stats_unregister (self);
+  g_clear_object (&self->memory_monitor);
+  drop_scaled_for_file (self, NULL);
+  g_clear_pointer (&self->scaled, g_hash_table_destroy);
+  /* Entries are freed with the hash table */
+  g_queue_init (&self->images_lru);
   g_clear_pointer (&self->background_images, g_hash_table_destroy);
 
   G_OBJECT_CLASS (phosh_background_cache_parent_class)->finalize (object);
@@ -79,8 +515,19 @@ phosh_background_cache_init (PhoshBackgroundCache *self)
 {
   self->background_images = g_hash_table_new_full (g_file_hash,
                                                    (GEqualFunc) g_file_equal,
-                                                   g_object_unref,
-                                                   g_object_unref);
+                                                   NULL,
+                                                   (GDestroyNotify) image_entry_free);
+  self->scaled = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                        NULL, (GDestroyNotify) scaled_free);
+
+  self->memory_monitor = g_memory_monitor_dup_default ();
+  g_signal_connect_object (self->memory_monitor,
+                           "low-memory-warning",
+                           G_CALLBACK (on_low_memory_warning),
+                           self,
+                           G_CONNECT_SWAPPED);
+
+  phosh_memory_stats_register ("background-cache", report_memory, self);
 }
 
 /**
@@ -119,7 +566,8 @@ phosh_background_cache_fetch_async (PhoshBackgroundCache *self,
                                     GAsyncReadyCallback   callback,
                                     gpointer              user_data)
 {
-  PhoshBackgroundImage *image;
+  PhoshBackgroundCacheImage *entry;
+  PhoshBackgroundImage *image = NULL;
   g_autoptr (GTask) task = NULL;
 
   g_return_if_fail (PHOSH_IS_BACKGROUND_CACHE (self));
@@ -129,13 +577,29 @@ phosh_background_cache_fetch_async (PhoshBackgroundCache *self,
   task = g_task_new (self, cancel, callback, user_data);
   g_task_set_source_tag (task, phosh_background_cache_fetch_async);
 
-  image = g_hash_table_lookup (self->background_images, file);
+  entry = g_hash_table_lookup (self->background_images, file);
+  if (entry) {
+    image = entry->image;
+    g_queue_unlink (&self->images_lru, &entry->link);
+    g_queue_push_head_link (&self->images_lru, &entry->link);
+  }
+
+  /* Images decoded for smaller monitors (or at full size) need a reload */
+  if (image && phosh_background_image_get_max_size (image) < self->max_size) {
+    g_debug ("Cached background %s too small", g_file_peek_path (file));
+    image = NULL;
+  }
+
   if (image) {
     g_debug ("Background cache hit for %s", g_file_peek_path (file));
     g_task_return_pointer (task, g_object_ref (image), g_object_unref);
   } else {
     g_debug ("Background cache miss for %s", g_file_peek_path (file));
-    phosh_background_image_new (file, cancel, on_background_image_loaded, g_steal_pointer (&task));
+    phosh_background_image_new (file,
+                                self->max_size,
+                                cancel,
+                                on_background_image_loaded,
+                                g_steal_pointer (&task));
   }
 }
 
@@ -173,10 +637,14 @@ phosh_background_cache_fetch_finish (PhoshBackgroundCache *self,
 PhoshBackgroundImage *
 phosh_background_cache_lookup_background (PhoshBackgroundCache *self, GFile *file)
 {
+  PhoshBackgroundCacheImage *entry;
+
   g_return_val_if_fail (PHOSH_IS_BACKGROUND_CACHE (self), NULL);
   g_return_val_if_fail (G_IS_FILE (file), NULL);
 
-  return g_hash_table_lookup (self->background_images, file);
+  entry = g_hash_table_lookup (self->background_images, file);
+
+  return entry ? entry->image : NULL;
 }
 
 /**
@@ -189,13 +657,17 @@ phosh_background_cache_lookup_background (PhoshBackgroundCache *self, GFile *fil
 void
 phosh_background_cache_remove (PhoshBackgroundCache *self, GFile *file)
 {
-  gboolean success;
+  PhoshBackgroundCacheImage *entry;
 
   g_return_if_fail (PHOSH_IS_BACKGROUND_CACHE (self));
 
-  success = g_hash_table_remove (self->background_images, file);
-  if (!success)
-    g_warning ("'%s' not found in cache", g_file_peek_path (file));
+  drop_scaled_for_file (self, file);
+  entry = g_hash_table_lookup (self->background_images, file);
+  /* Might have been evicted already */
+  if (entry)
+    drop_image (self, entry);
+  else
+    g_debug ("'%s' not found in cache", g_file_peek_path (file));
 }
 
 /**
@@ -210,5 +682,393 @@ phosh_background_cache_clear_all (PhoshBackgroundCache *self)
   g_return_if_fail (PHOSH_IS_BACKGROUND_CACHE (self));
 
   g_debug ("Clearing background image cache");
-  g_hash_table_remove_all (self->background_images);
+  drop_scaled_for_file (self, NULL);
+  while (self->images_lru.head)
+    drop_image (self, self->images_lru.head->data);
+}
+
+/**
+ * phosh_background_cache_ensure_size:
+ * @self: The background cache
+ * @size: The largest dimension of a monitor in pixels
+ *
+ * Makes sure images loaded from now on are large enough to cover a
+ * monitor whose width and height are at most `size` pixels. The
+ * cache only ever grows its size so images fit all monitors.
+ */
+void
+phosh_background_cache_ensure_size (PhoshBackgroundCache *self, int size)
+{
+  g_return_if_fail (PHOSH_IS_BACKGROUND_CACHE (self));
+
+  if (size <= self->max_size)
+    return;
+
+  g_debug ("Decoding backgrounds at %dpx", size);
+  self->max_size = size;
+}
+
+typedef struct {
+  PhoshBackgroundImage    *image;
+  int                      width;
+  int                      height;
+  GDesktopBackgroundStyle  style;
+  GdkRGBA                  color;
+  PhoshBackgroundEffect    effect;
+  char                    *key;
+} ScaleData;
+
+
+static void
+scale_data_free (ScaleData *data)
+{
+  g_clear_object (&data->image);
+  g_free (data->key);
+  g_free (data);
+}
+
+
+static char *
+get_disk_cache_path (int width, int height)
+{
+  g_autofree char *name = g_strdup_printf ("%dx%d.raw", width, height);
+
+  return g_build_filename (g_get_user_cache_dir (), "phosh", "backgrounds", name, NULL);
+}
+
+
+static gboolean
+get_source_info (GFile *file, guint64 *mtime, guint64 *size, GError **error)
+{
+  g_autoptr (GFileInfo) info = NULL;
+
+  info = g_file_query_info (file,
+                            G_FILE_ATTRIBUTE_TIME_MODIFIED "," G_FILE_ATTRIBUTE_STANDARD_SIZE,
+                            G_FILE_QUERY_INFO_NONE,
+                            NULL,
+                            error);
+  if (info == NULL)
+    return FALSE;
+
+  *mtime = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED);
+  *size = g_file_info_get_size (info);
+
+  return TRUE;
+}
+
+
+static void
+save_to_disk (ScaleData *data, GdkPixbuf *pixbuf)
+{
+  g_autoptr (GByteArray) contents = g_byte_array_new ();
+  g_autoptr (GError) err = NULL;
+  g_autofree char *path = NULL;
+  g_autofree char *dir = NULL;
+  DiskCacheHeader header;
+  guint64 mtime, size;
+
+  if (!get_source_info (phosh_background_image_get_file (data->image), &mtime, &size, &err)) {
+    g_debug ("Not caching background: %s", err->message);
+    return;
+  }
+
+  memset (&header, 0, sizeof (header));
+  memcpy (header.magic, DISK_CACHE_MAGIC, sizeof (header.magic));
+  header.version = DISK_CACHE_VERSION;
+  header.width = gdk_pixbuf_get_width (pixbuf);
+  header.height = gdk_pixbuf_get_height (pixbuf);
+  header.rowstride = gdk_pixbuf_get_rowstride (pixbuf);
+  header.has_alpha = gdk_pixbuf_get_has_alpha (pixbuf);
+  header.mtime = mtime;
+  header.source_size = size;
+  header.key_len = strlen (data->key);
+
+  g_byte_array_append (contents, (guint8 *)&header, sizeof (header));
+  g_byte_array_append (contents, (guint8 *)data->key, header.key_len);
+  g_byte_array_append (contents, gdk_pixbuf_read_pixels (pixbuf), gdk_pixbuf_get_byte_length (pixbuf));
+
+  path = get_disk_cache_path (data->width, data->height);
+  dir = g_path_get_dirname (path);
+  if (g_mkdir_with_parents (dir, 0700) < 0) {
+    g_warning ("Failed to create %s: %s", dir, g_strerror (errno));
+    return;
+  }
+
+  if (!g_file_set_contents_full (path, (char *)contents->data, contents->len,
+                                 G_FILE_SET_CONTENTS_CONSISTENT, 0600, &err)) {
+    g_warning ("Failed to write background cache %s: %s", path, err->message);
+  }
+}
+
+
+static void
+scale_in_thread (GTask        *task,
+                 gpointer      source_object,
+                 gpointer      task_data,
+                 GCancellable *cancellable)
+{
+  ScaleData *data = task_data;
+  GdkPixbuf *pixbuf;
+
+  pixbuf = image_background (data->image, data->width, data->height, data->style, &data->color);
+  if (pixbuf == NULL) {
+    g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_FAILED, "Failed to scale background");
+    return;
+  }
+
+  if (data->effect == PHOSH_BACKGROUND_EFFECT_BLUR) {
+    g_autoptr (GdkPixbuf) scaled = pixbuf;
+
+    pixbuf = blur_pixbuf (scaled);
+    if (pixbuf == NULL) {
+      g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_FAILED, "Failed to blur background");
+      return;
+    }
+  } else {
+    /* Only the plain background is shown on startup */
+    save_to_disk (data, pixbuf);
+  }
+  g_task_return_pointer (task, pixbuf, g_object_unref);
+}
+
+
+static void
+insert_scaled (PhoshBackgroundCache *self, ScaleData *data, GdkPixbuf *pixbuf)
+{
+  PhoshBackgroundCacheScaled *scaled;
+
+  scaled = g_hash_table_lookup (self->scaled, data->key);
+  if (scaled)
+    drop_scaled (self, scaled);
+
+  scaled = g_new0 (PhoshBackgroundCacheScaled, 1);
+  scaled->key = g_strdup (data->key);
+  scaled->file = g_object_ref (phosh_background_image_get_file (data->image));
+  g_weak_ref_init (&scaled->image, data->image);
+  scaled->pixbuf = g_object_ref (pixbuf);
+  scaled->link.data = scaled;
+  self->bytes += get_pixbuf_bytes (pixbuf);
+  g_hash_table_insert (self->scaled, scaled->key, scaled);
+  g_queue_push_head_link (&self->scaled_lru, &scaled->link);
+
+  while (self->scaled_lru.length > MAX_SCALED)
+    drop_scaled (self, self->scaled_lru.tail->data);
+
+  trim (self, MAX_IMAGES, MAX_BYTES);
+}
+
+
+static void
+on_scale_done (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+  PhoshBackgroundCache *self = PHOSH_BACKGROUND_CACHE (source_object);
+  g_autoptr (GTask) task = G_TASK (user_data);
+  g_autoptr (GdkPixbuf) pixbuf = NULL;
+  GError *err = NULL;
+
+  pixbuf = g_task_propagate_pointer (G_TASK (res), &err);
+  if (pixbuf == NULL) {
+    g_task_return_error (task, err);
+    return;
+  }
+
+  /* Cache the result even if the caller went away in the meantime */
+  insert_scaled (self, g_task_get_task_data (G_TASK (res)), pixbuf);
+  g_task_return_pointer (task, g_steal_pointer (&pixbuf), g_object_unref);
+}
+
+/**
+ * phosh_background_cache_scale_async:
+ * @self: The background cache
+ * @image:(nullable): The background image
+ * @width: The width to scale to
+ * @height: The height to scale to
+ * @style: How to scale the image
+ * @color: The color to fill borders with
+ * @effect: The effect to apply after scaling
+ * @cancel: A cancellable
+ * @callback: The callback to invoke when done
+ * @user_data: The user data for @callback
+ *
+ * Scales the given background image to the given size in a worker
+ * thread. Results are cached so different backgrounds showing the same
+ * image (e.g. the lock screen's and the home screen's) at the same
+ * size share them.
+ */
+void
+phosh_background_cache_scale_async (PhoshBackgroundCache    *self,
+                                    PhoshBackgroundImage    *image,
+                                    int                      width,
+                                    int                      height,
+                                    GDesktopBackgroundStyle  style,
+                                    const GdkRGBA           *color,
+                                    PhoshBackgroundEffect    effect,
+                                    GCancellable            *cancel,
+                                    GAsyncReadyCallback      callback,
+                                    gpointer                 user_data)
+{
+  g_autoptr (PhoshBackgroundImage) scaled_image = NULL;
+  g_autoptr (GTask) task = NULL;
+  g_autoptr (GTask) scale_task = NULL;
+  PhoshBackgroundCacheScaled *scaled;
+  g_autofree char *key = NULL;
+  ScaleData *data;
+
+  g_return_if_fail (PHOSH_IS_BACKGROUND_CACHE (self));
+  g_return_if_fail (image == NULL || PHOSH_IS_BACKGROUND_IMAGE (image));
+  g_return_if_fail (color);
+  g_return_if_fail (cancel == NULL || G_IS_CANCELLABLE (cancel));
+
+  task = g_task_new (self, cancel, callback, user_data);
+  g_task_set_source_tag (task, phosh_background_cache_scale_async);
+
+  /* Nothing to scale */
+  if (image == NULL || style == G_DESKTOP_BACKGROUND_STYLE_NONE) {
+    g_task_return_pointer (task, NULL, NULL);
+    return;
+  }
+
+  key = get_scaled_key (phosh_background_image_get_file (image), width, height, style, color,
+                        effect);
+  scaled = g_hash_table_lookup (self->scaled, key);
+  if (scaled) {
+    scaled_image = g_weak_ref_get (&scaled->image);
+    if (scaled_image == image) {
+      g_debug ("Scaled background cache hit for %s", key);
+      g_queue_unlink (&self->scaled_lru, &scaled->link);
+      g_queue_push_head_link (&self->scaled_lru, &scaled->link);
+      g_task_return_pointer (task, g_object_ref (scaled->pixbuf), g_object_unref);
+      return;
+    }
+    /* Scaled from an outdated image */
+    drop_scaled (self, scaled);
+  }
+
+  data = g_new0 (ScaleData, 1);
+  data->image = g_object_ref (image);
+  data->width = width;
+  data->height = height;
+  data->style = style;
+  data->color = *color;
+  data->effect = effect;
+  data->key = g_steal_pointer (&key);
+
+  g_debug ("Scaling %s", data->key);
+  /* Don't cancel the scaling itself so others can use the result */
+  scale_task = g_task_new (self, NULL, on_scale_done, g_steal_pointer (&task));
+  g_task_set_task_data (scale_task, data, (GDestroyNotify) scale_data_free);
+  g_task_run_in_thread (scale_task, scale_in_thread);
+}
+
+/**
+ * phosh_background_cache_scale_finish:
+ * @self: The background cache
+ * @res: The Result
+ * @error: The return location for errors
+ *
+ * Finishes the async operation started with
+ * [method@BackgroundCache.scale_async].
+ *
+ * Returns:(transfer full)(nullable): The scaled image. `NULL` with
+ *   no error set means there's nothing to show.
+ */
+GdkPixbuf *
+phosh_background_cache_scale_finish (PhoshBackgroundCache *self,
+                                     GAsyncResult         *res,
+                                     GError              **error)
+{
+  g_return_val_if_fail (PHOSH_IS_BACKGROUND_CACHE (self), NULL);
+  g_return_val_if_fail (g_task_is_valid (res, self), NULL);
+
+  return g_task_propagate_pointer (G_TASK (res), error);
+}
+
+/**
+ * phosh_background_cache_lookup_disk:
+ * @self: The background cache
+ * @file: The background's file
+ * @width: The width of the background
+ * @height: The height of the background
+ * @style: How the image is scaled
+ * @color: The color to fill borders with
+ *
+ * Looks up a previously scaled background in the on disk cache. The
+ * result is only returned when the source image didn't change
+ * since. The pixel data is mapped, not copied.
+ *
+ * Returns:(transfer full)(nullable): The scaled background
+ */
+GdkPixbuf *
+phosh_background_cache_lookup_disk (PhoshBackgroundCache    *self,
+                                    GFile                   *file,
+                                    int                      width,
+                                    int                      height,
+                                    GDesktopBackgroundStyle  style,
+                                    const GdkRGBA           *color)
+{
+  g_autoptr (GMappedFile) mapped = NULL;
+  g_autoptr (GBytes) bytes = NULL;
+  g_autoptr (GBytes) pixels = NULL;
+  g_autofree char *path = NULL;
+  g_autofree char *key = NULL;
+  const char *contents;
+  DiskCacheHeader header;
+  guint64 mtime, size;
+  gsize len, pixel_len, offset;
+
+  g_return_val_if_fail (PHOSH_IS_BACKGROUND_CACHE (self), NULL);
+  g_return_val_if_fail (G_IS_FILE (file), NULL);
+  g_return_val_if_fail (color, NULL);
+
+  if (style == G_DESKTOP_BACKGROUND_STYLE_NONE)
+    return NULL;
+
+  path = get_disk_cache_path (width, height);
+  mapped = g_mapped_file_new (path, FALSE, NULL);
+  if (mapped == NULL)
+    return NULL;
+
+  contents = g_mapped_file_get_contents (mapped);
+  len = g_mapped_file_get_length (mapped);
+  if (len < sizeof (header))
+    return NULL;
+
+  memcpy (&header, contents, sizeof (header));
+  if (memcmp (header.magic, DISK_CACHE_MAGIC, sizeof (header.magic)) != 0 ||
+      header.version != DISK_CACHE_VERSION ||
+      header.width != width ||
+      header.height != height ||
+      header.rowstride < header.width * (header.has_alpha ? 4 : 3)) {
+    g_debug ("Invalid background cache %s", path);
+    return NULL;
+  }
+
+  key = get_scaled_key (file, width, height, style, color, PHOSH_BACKGROUND_EFFECT_NONE);
+  offset = sizeof (header) + header.key_len;
+  pixel_len = (gsize)header.rowstride * (header.height - 1) +
+    header.width * (header.has_alpha ? 4 : 3);
+  if (len < offset + pixel_len ||
+      header.key_len != strlen (key) ||
+      memcmp (contents + sizeof (header), key, header.key_len) != 0) {
+    g_debug ("Background cache %s doesn't match %s", path, key);
+    return NULL;
+  }
+
+  if (!get_source_info (file, &mtime, &size, NULL) ||
+      mtime != header.mtime || size != header.source_size) {
+    g_debug ("Background cache %s is outdated", path);
+    return NULL;
+  }
+
+  g_debug ("Using cached background %s", path);
+  bytes = g_mapped_file_get_bytes (mapped);
+  pixels = g_bytes_new_from_bytes (bytes, offset, pixel_len);
+
+  return gdk_pixbuf_new_from_bytes (pixels,
+                                    GDK_COLORSPACE_RGB,
+                                    header.has_alpha,
+                                    8,
+                                    header.width,
+                                    header.height,
+                                    header.rowstride);
 }
@@ -8,11 +8,25 @@
 
 #include "background-image.h"
 
+#include <gdesktop-enums.h>
+#include <gdk/gdk.h>
 #include <glib-object.h>
 #include <gio/gio.h>
 
 G_BEGIN_DECLS
 
+/**
+ * PhoshBackgroundEffect:
+ * @PHOSH_BACKGROUND_EFFECT_NONE: Show the background as is
+ * @PHOSH_BACKGROUND_EFFECT_BLUR: Blur and dim the background
+ *
+ * Effects applied to scaled backgrounds.
+ */
+typedef enum {
+  PHOSH_BACKGROUND_EFFECT_NONE = 0,
+  PHOSH_BACKGROUND_EFFECT_BLUR = 1,
+} PhoshBackgroundEffect;
+
 #define PHOSH_TYPE_BACKGROUND_CACHE (phosh_background_cache_get_type ())
 
 G_DECLARE_FINAL_TYPE (PhoshBackgroundCache, phosh_background_cache, PHOSH, BACKGROUND_CACHE, GObject)
@@ -31,5 +45,26 @@ PhoshBackgroundImage         *phosh_background_cache_lookup_background (PhoshBac
 void                          phosh_background_cache_remove            (PhoshBackgroundCache *self,
                                                                         GFile                *file);
 void                          phosh_background_cache_clear_all         (PhoshBackgroundCache *self);
+void                          phosh_background_cache_ensure_size       (PhoshBackgroundCache *self,
+                                                                        int                   size);
+void                          phosh_background_cache_scale_async       (PhoshBackgroundCache    *self,
+                                                                        PhoshBackgroundImage    *image,
+                                                                        int                      width,
+                                                                        int                      height,
+                                                                        GDesktopBackgroundStyle  style,
+                                                                        const GdkRGBA           *color,
+                                                                        PhoshBackgroundEffect    effect,
+                                                                        GCancellable            *cancel,
+                                                                        GAsyncReadyCallback      callback,
+                                                                        gpointer                 user_data);
+GdkPixbuf                    *phosh_background_cache_scale_finish      (PhoshBackgroundCache    *self,
+                                                                        GAsyncResult            *res,
+                                                                        GError                 **error);
+GdkPixbuf                    *phosh_background_cache_lookup_disk       (PhoshBackgroundCache    *self,
+                                                                        GFile                   *file,
+                                                                        int                      width,
+                                                                        int                      height,
+                                                                        GDesktopBackgroundStyle  style,
+                                                                        const GdkRGBA           *color);
 
 G_END_DECLS
@@ -19,10 +19,19 @@
  * PhoshBackgroundImage:
  *
  * An image for a [type@Background] that can be loaded async via [type@BackgroundCache].
+ *
+ * When [property@BackgroundImage:max-size] is set the image is decoded
+ * at the smallest size that still covers a `max-size` × `max-size`
+ * square so it can fill any monitor in any orientation without
+ * keeping a full resolution camera picture in memory.
  */
+
+#define READ_CHUNK_SIZE (64 * 1024)
+
 enum {
   PROP_0,
   PROP_FILE,
+  PROP_MAX_SIZE,
   PROP_LAST_PROP
 };
 static GParamSpec *props[PROP_LAST_PROP];
@@ -31,6 +40,7 @@ struct _PhoshBackgroundImage {
   GObject            parent;
 
   GFile             *file;
+  int                max_size;
   GdkPixbuf         *pixbuf;
   GTimer            *load_timer;
 };
@@ -43,6 +53,55 @@ G_DEFINE_TYPE_WITH_CODE (PhoshBackgroundImage, phosh_background_image, G_TYPE_OB
                          G_IMPLEMENT_INTERFACE (G_TYPE_ASYNC_INITABLE, async_initable_iface_init));
 
 
+static void
+on_size_prepared (PhoshBackgroundImage *self, int width, int height, GdkPixbufLoader *loader)
+{
+  double scale;
+
+  /* The shorter side needs to cover the largest monitor dimension */
+  if (MIN (width, height) <= self->max_size)
+    return;
+
+  scale = (double) self->max_size / MIN (width, height);
+  g_debug ("Decoding %dx%d background at %.2f", width, height, scale);
+  gdk_pixbuf_loader_set_size (loader,
+                              MAX (1, (int) (width * scale + 0.5)),
+                              MAX (1, (int) (height * scale + 0.5)));
+}
+
+
+static GdkPixbuf *
+load_pixbuf (PhoshBackgroundImage *self, GInputStream *stream, GCancellable *cancel, GError **error)
+{
+  g_autoptr (GdkPixbufLoader) loader = gdk_pixbuf_loader_new ();
+  g_autofree guchar *buffer = g_malloc (READ_CHUNK_SIZE);
+  GdkPixbuf *pixbuf;
+  gssize n_read;
+
+  if (self->max_size > 0)
+    g_signal_connect_swapped (loader, "size-prepared", G_CALLBACK (on_size_prepared), self);
+
+  do {
+    n_read = g_input_stream_read (stream, buffer, READ_CHUNK_SIZE, cancel, error);
+    if (n_read < 0 || (n_read > 0 && !gdk_pixbuf_loader_write (loader, buffer, n_read, error))) {
+      gdk_pixbuf_loader_close (loader, NULL);
+      return NULL;
+    }
+  } while (n_read > 0);
+
+  if (!gdk_pixbuf_loader_close (loader, error))
+    return NULL;
+
+  pixbuf = gdk_pixbuf_loader_get_pixbuf (loader);
+  if (pixbuf == NULL) {
+    g_set_error (error, GDK_PIXBUF_ERROR, GDK_PIXBUF_ERROR_FAILED, "Failed to decode image");
+    return NULL;
+  }
+
+  return g_object_ref (pixbuf);
+}
+
+
 static gboolean
 initable_init (GInitable *initable, GCancellable *cancel, GError **error)
 {
@@ -58,7 +117,7 @@ initable_init (GInitable *initable, GCancellable *cancel, GError **error)
     return FALSE;
   }
 
-  pixbuf = gdk_pixbuf_new_from_stream (G_INPUT_STREAM (stream), cancel, &local_error);
+  pixbuf = load_pixbuf (self, G_INPUT_STREAM (stream), cancel, &local_error);
   if (pixbuf == NULL) {
     g_propagate_error (error, local_error);
     return FALSE;
@@ -103,6 +162,9 @@ phosh_background_image_set_property (GObject      *object,
   case PROP_FILE:
     self->file = g_value_dup_object (value);
     break;
+  case PROP_MAX_SIZE:
+    self->max_size = g_value_get_int (value);
+    break;
   default:
     G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     break;
@@ -122,6 +184,9 @@ phosh_background_image_get_property (GObject    *object,
   case PROP_FILE:
     g_value_set_object (value, self->file);
     break;
+  case PROP_MAX_SIZE:
+    g_value_set_int (value, self->max_size);
+    break;
   default:
     G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     break;
@@ -155,6 +220,16 @@ phosh_background_image_class_init (PhoshBackgroundImageClass *klass)
     g_param_spec_object ("file", "", "",
                          G_TYPE_FILE,
                          G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+  /**
+   * PhoshBackgroundImage:max-size:
+   *
+   * The size in pixels the shorter side of the image is scaled down
+   * to while decoding. `0` decodes the image at full size.
+   */
+  props[PROP_MAX_SIZE] =
+    g_param_spec_int ("max-size", "", "",
+                      0, G_MAXINT, 0,
+                      G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
 
   g_object_class_install_properties (object_class, PROP_LAST_PROP, props);
 }
@@ -168,18 +243,20 @@ phosh_background_image_init (PhoshBackgroundImage *self)
 
 
 PhoshBackgroundImage *
-phosh_background_image_new_sync (GFile *file, GCancellable *cancel, GError **error)
+phosh_background_image_new_sync (GFile *file, int max_size, GCancellable *cancel, GError **error)
 {
   return PHOSH_BACKGROUND_IMAGE (g_initable_new (PHOSH_TYPE_BACKGROUND_IMAGE,
                                                  cancel,
                                                  error,
                                                  "file", file,
+                                                 "max-size", max_size,
                                                  NULL));
 }
 
 
 void
 phosh_background_image_new (GFile              *file,
+                            int                 max_size,
                             GCancellable       *cancellable,
                             GAsyncReadyCallback callback,
                             gpointer            user_data)
@@ -192,6 +269,7 @@ phosh_background_image_new (GFile              *file,
                               callback,
                               user_data,
                               "file", file,
+                              "max-size", max_size,
                               NULL);
 }
 
@@ -241,3 +319,19 @@ phosh_background_image_get_file (PhoshBackgroundImage *self)
 
   return self->file;
 }
+
+/**
+ * phosh_background_image_get_max_size:
+ * @self: The background image
+ *
+ * Gets the size the image was decoded for, see [property@BackgroundImage:max-size].
+ *
+ * Returns: The max size or `0` if decoded at full size
+ */
+int
+phosh_background_image_get_max_size (PhoshBackgroundImage *self)
+{
+  g_return_val_if_fail (PHOSH_IS_BACKGROUND_IMAGE (self), 0);
+
+  return self->max_size;
+}
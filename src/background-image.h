@@ -17,9 +17,11 @@ G_BEGIN_DECLS
 G_DECLARE_FINAL_TYPE (PhoshBackgroundImage, phosh_background_image, PHOSH, BACKGROUND_IMAGE, GObject)
 
 PhoshBackgroundImage     *phosh_background_image_new_sync               (GFile                *file,
+                                                                         int                   max_size,
                                                                          GCancellable         *cancellable,
                                                                          GError               **error);
 void                      phosh_background_image_new                    (GFile                *file,
+                                                                         int                   max_size,
                                                                          GCancellable         *cancellable,
                                                                          GAsyncReadyCallback   callback,
                                                                          gpointer              user_data);
@@ -27,6 +29,7 @@ PhoshBackgroundImage     *phosh_background_image_new_finish             (GAsyncR
                                                                          GError               **error);
 GdkPixbuf                *phosh_background_image_get_pixbuf             (PhoshBackgroundImage *self);
 GFile                    *phosh_background_image_get_file               (PhoshBackgroundImage *self);
+int                       phosh_background_image_get_max_size           (PhoshBackgroundImage *self);
 
 
 
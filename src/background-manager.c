@@ -16,7 +16,10 @@
 #include "manager.h"
 #include "monitor/monitor.h"
 #include "phosh-wayland.h"
+#include "settings-batch.h"
 #include "shell-priv.h"
+#include "toplevel.h"
+#include "toplevel-manager.h"
 #include "util.h"
 
 #define GNOME_DESKTOP_USE_UNSTABLE_API
@@ -44,6 +47,9 @@
  * the background (or wallpaper). Whenever either the monitors'
  * configuration or the configured wallpaper properties change the
  * backgrounds are notified to update their contents.
+ *
+ * Backgrounds fully covered by a fullscreen application are marked as
+ * occluded so they can drop their images.
  */
 
 enum {
@@ -61,10 +67,14 @@ struct _PhoshBackgroundManager {
 
   GDesktopBackgroundStyle  style;
   GnomeBGSlideShow        *slideshow;
+  guint                    slide;       /* The currently shown slide */
+  guint                    slide_id;    /* Advances to the next slide */
+  guint                    preload_id;  /* Preloads the next slide */
   GFile                   *file;        /* Background XML or image */
   GFileMonitor            *monitor;     /* Monitors file */
   GdkRGBA                  color;
   GSettings               *settings;
+  PhoshSettingsBatch      *settings_batch;
   GSettings               *interface_settings;
 
   GCancellable            *cancel_load;
@@ -93,6 +103,194 @@ update_all_backgrounds (PhoshBackgroundManager *self)
 }
 
 
+static GFile *
+get_slide_file (PhoshBackgroundManager *self, guint slide, int width, int height)
+{
+  gboolean fixed;
+  const char *file1 = NULL, *file2 = NULL;
+
+  gnome_bg_slide_show_get_slide (self->slideshow, slide, width, height,
+                                 NULL, NULL, &fixed, &file1, &file2);
+
+  /* We don't cross fade so show the transition's target right away */
+  if (!fixed && file2)
+    return g_file_new_for_path (file2);
+
+  return file1 ? g_file_new_for_path (file1) : NULL;
+}
+
+
+static void
+get_background_size (PhoshBackground *background, int *width, int *height)
+{
+  *width = phosh_layer_surface_get_configured_width (PHOSH_LAYER_SURFACE (background));
+  *height = phosh_layer_surface_get_configured_height (PHOSH_LAYER_SURFACE (background));
+}
+
+
+static guint
+get_next_slide (PhoshBackgroundManager *self)
+{
+  return (self->slide + 1) % gnome_bg_slide_show_get_num_slides (self->slideshow);
+}
+
+
+static void
+on_slide_fetched (GObject *source_object, GAsyncResult *res, gpointer data)
+{
+  g_autoptr (PhoshBackgroundImage) image = NULL;
+  g_autoptr (GError) err = NULL;
+
+  image = phosh_background_cache_fetch_finish (PHOSH_BACKGROUND_CACHE (source_object), res, &err);
+  if (!image)
+    phosh_async_error_warn (err, "Failed to preload slide");
+}
+
+
+/* The number of upcoming slides to keep ready as picked by the performance tier */
+static guint
+get_n_preload_slides (PhoshBackgroundManager *self)
+{
+  PhoshModeManager *mode_manager = phosh_shell_get_mode_manager (phosh_shell_get_default ());
+  guint n_slides = gnome_bg_slide_show_get_num_slides (self->slideshow);
+  guint n_preload = 1;
+
+  if (mode_manager)
+    n_preload = phosh_mode_manager_get_perf_profile (mode_manager)->preload_backgrounds;
+
+  return MIN (n_preload, n_slides - 1);
+}
+
+
+static gboolean
+on_preload_idle (gpointer user_data)
+{
+  PhoshBackgroundManager *self = PHOSH_BACKGROUND_MANAGER (user_data);
+  guint n_slides, n_preload;
+  GHashTableIter iter;
+  PhoshBackground *background;
+
+  self->preload_id = 0;
+  g_return_val_if_fail (self->slideshow, G_SOURCE_REMOVE);
+
+  n_slides = gnome_bg_slide_show_get_num_slides (self->slideshow);
+  n_preload = get_n_preload_slides (self);
+
+  g_hash_table_iter_init (&iter, self->backgrounds);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&background)) {
+    int width, height;
+
+    get_background_size (background, &width, &height);
+    if (width <= 0 || height <= 0)
+      continue;
+
+    for (guint i = 1; i <= n_preload; i++) {
+      g_autoptr (GFile) file = get_slide_file (self, (self->slide + i) % n_slides, width, height);
+
+      if (file == NULL)
+        continue;
+
+      /* Scale the next slide, only decode the ones after it */
+      if (i == 1) {
+        phosh_background_preload (background, file);
+      } else {
+        phosh_background_cache_fetch_async (phosh_background_cache_get_default (),
+                                            file,
+                                            NULL,
+                                            on_slide_fetched,
+                                            NULL);
+      }
+    }
+  }
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static void
+stop_slideshow (PhoshBackgroundManager *self)
+{
+  g_clear_handle_id (&self->slide_id, g_source_remove);
+  g_clear_handle_id (&self->preload_id, g_source_remove);
+  self->slide = 0;
+}
+
+
+static void schedule_next_slide (PhoshBackgroundManager *self);
+
+
+static void
+drop_slide (PhoshBackgroundManager *self, guint slide)
+{
+  PhoshBackgroundCache *cache = phosh_background_cache_get_default ();
+  GHashTableIter iter;
+  PhoshBackground *background;
+
+  /* Drop images no longer shown so only the current and next slide stay in memory */
+  g_hash_table_iter_init (&iter, self->backgrounds);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&background)) {
+    g_autoptr (GFile) old = NULL;
+    g_autoptr (GFile) new = NULL;
+    int width, height;
+
+    get_background_size (background, &width, &height);
+    if (width <= 0 || height <= 0)
+      continue;
+
+    old = get_slide_file (self, slide, width, height);
+    new = get_slide_file (self, self->slide, width, height);
+    if (old && !phosh_util_file_equal (old, new))
+      phosh_background_cache_remove (cache, old);
+  }
+}
+
+
+static gboolean
+on_slide_timeout (gpointer user_data)
+{
+  PhoshBackgroundManager *self = PHOSH_BACKGROUND_MANAGER (user_data);
+  guint old_slide = self->slide;
+
+  self->slide_id = 0;
+  self->slide = get_next_slide (self);
+  g_debug ("Switching to slide %u", self->slide);
+
+  update_all_backgrounds (self);
+  drop_slide (self, old_slide);
+  schedule_next_slide (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static void
+schedule_next_slide (PhoshBackgroundManager *self)
+{
+  double duration = 0.0;
+
+  g_clear_handle_id (&self->slide_id, g_source_remove);
+  g_clear_handle_id (&self->preload_id, g_source_remove);
+
+  if (gnome_bg_slide_show_get_num_slides (self->slideshow) < 2)
+    return;
+
+  gnome_bg_slide_show_get_slide (self->slideshow, self->slide, 1, 1,
+                                 NULL, &duration, NULL, NULL, NULL);
+
+  self->slide_id = g_timeout_add_seconds (MAX (1, (guint)round (duration)),
+                                          on_slide_timeout,
+                                          self);
+  g_source_set_name_by_id (self->slide_id, "[phosh] background slide");
+
+  if (get_n_preload_slides (self) == 0)
+    return;
+
+  /* Get the next slides ready without competing with the current frame */
+  self->preload_id = g_idle_add_full (G_PRIORITY_LOW, on_preload_idle, self, NULL);
+  g_source_set_name_by_id (self->preload_id, "[phosh] background preload");
+}
+
+
 static void
 on_slideshow_loaded (GObject *source_object, GAsyncResult *res, gpointer user_data)
 {
@@ -109,7 +307,9 @@ on_slideshow_loaded (GObject *source_object, GAsyncResult *res, gpointer user_da
   }
 
   self->slideshow = g_steal_pointer (&slideshow);
+  stop_slideshow (self);
   update_all_backgrounds (self);
+  schedule_next_slide (self);
 }
 
 
@@ -246,6 +446,7 @@ on_settings_changed (PhoshBackgroundManager *self)
 
   self->style = style;
   self->color = color;
+  stop_slideshow (self);
   g_clear_object (&self->slideshow);
   g_clear_object (&self->file);
   self->file = g_steal_pointer (&file);
@@ -329,6 +530,7 @@ on_monitor_configured (PhoshBackgroundManager *self, PhoshMonitor *monitor)
   if (background == NULL) {
     background = create_background_for_monitor (self, monitor);
     g_hash_table_insert (self->backgrounds, g_object_ref (monitor), background);
+    phosh_background_set_occluded (background, is_occluded (self, monitor));
   } else {
     phosh_background_needs_update (background);
   }
@@ -356,6 +558,42 @@ on_monitor_added (PhoshBackgroundManager *self,
 }
 
 
+static gboolean
+is_occluded (PhoshBackgroundManager *self, PhoshMonitor *monitor)
+{
+  PhoshShell *shell = phosh_shell_get_default ();
+  PhoshToplevelManager *toplevel_manager = phosh_shell_get_toplevel_manager (shell);
+
+  /* The overview shows the background */
+  if (phosh_shell_get_state (shell) & PHOSH_STATE_OVERVIEW)
+    return FALSE;
+
+  for (guint i = 0; i < phosh_toplevel_manager_get_num_toplevels (toplevel_manager); i++) {
+    PhoshToplevel *toplevel = phosh_toplevel_manager_get_toplevel (toplevel_manager, i);
+
+    if (phosh_toplevel_is_fullscreen (toplevel) &&
+        phosh_toplevel_is_activated (toplevel) &&
+        phosh_toplevel_is_on_output (toplevel, monitor->wl_output)) {
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+
+static void
+update_occlusion (PhoshBackgroundManager *self)
+{
+  GHashTableIter iter;
+  gpointer key, value;
+
+  g_hash_table_iter_init (&iter, self->backgrounds);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    phosh_background_set_occluded (PHOSH_BACKGROUND (value), is_occluded (self, PHOSH_MONITOR (key)));
+}
+
+
 static void
 on_primary_monitor_changed (PhoshBackgroundManager *self,
                             GParamSpec             *pspec,
@@ -395,12 +633,15 @@ phosh_background_manager_idle_init (PhoshManager *manager)
   PhoshMonitorManager *monitor_manager = phosh_shell_get_monitor_manager (shell);
 
   self->settings = g_settings_new ("org.gnome.desktop.background");
-  g_object_connect (self->settings,
-                    "swapped-signal::changed::" BG_KEY_PICTURE_URI, on_settings_changed, self,
-                    "swapped-signal::changed::" BG_KEY_PICTURE_URI_DARK, on_settings_changed, self,
-                    "swapped-signal::changed::" BG_KEY_PICTURE_OPTIONS, on_settings_changed, self,
-                    "swapped-signal::changed::" BG_KEY_PRIMARY_COLOR, on_settings_changed, self,
-                    NULL);
+  /* Settings panels usually change picture and options together, load only once */
+  self->settings_batch = phosh_settings_batch_new (self->settings,
+                                                   BG_KEY_PICTURE_URI,
+                                                   BG_KEY_PICTURE_URI_DARK,
+                                                   BG_KEY_PICTURE_OPTIONS,
+                                                   BG_KEY_PRIMARY_COLOR,
+                                                   NULL);
+  g_signal_connect_swapped (self->settings_batch, "changed",
+                            G_CALLBACK (on_settings_changed), self);
   self->interface_settings = g_settings_new ("org.gnome.desktop.interface");
   g_signal_connect_swapped (self->interface_settings,
                             "changed::" IF_KEY_COLOR_SCHEME,
@@ -419,6 +660,16 @@ phosh_background_manager_idle_init (PhoshManager *manager)
                             self);
   self->primary_monitor = g_object_ref (phosh_shell_get_primary_monitor (shell));
 
+  g_object_connect (phosh_shell_get_toplevel_manager (shell),
+                    "swapped-object-signal::toplevel-added", update_occlusion, self,
+                    "swapped-object-signal::toplevel-changed", update_occlusion, self,
+                    "swapped-object-signal::notify::num-toplevels", update_occlusion, self,
+                    NULL);
+  g_signal_connect_object (shell, "notify::shell-state",
+                           G_CALLBACK (update_occlusion),
+                           self,
+                           G_CONNECT_SWAPPED);
+
   /* catch up with monitors already present */
   for (int i = 0; i < phosh_monitor_manager_get_num_monitors (monitor_manager); i++) {
     PhoshMonitor *monitor = phosh_monitor_manager_get_monitor (monitor_manager, i);
@@ -435,9 +686,11 @@ phosh_background_manager_finalize (GObject *object)
 
   g_cancellable_cancel (self->cancel_load);
   g_clear_object (&self->cancel_load);
+  stop_slideshow (self);
 
   g_hash_table_destroy (self->backgrounds);
   g_clear_object (&self->primary_monitor);
+  g_clear_object (&self->settings_batch);
   g_clear_object (&self->settings);
   g_clear_object (&self->interface_settings);
   g_clear_object (&self->slideshow);
@@ -531,13 +784,9 @@ phosh_background_manager_get_data (PhoshBackgroundManager *self, PhoshBackground
     return g_steal_pointer (&bg_data);
 
   if (self->slideshow) {
-    gint width, height;
-    gboolean fixed;
-    const char *file1;
-
-    width = phosh_layer_surface_get_configured_width (PHOSH_LAYER_SURFACE (background));
-    height = phosh_layer_surface_get_configured_height (PHOSH_LAYER_SURFACE (background));
+    int width, height;
 
+    get_background_size (background, &width, &height);
     if (width <= 0 || height <= 0) {
       g_critical ("Layer surface not yet configured");
       return g_steal_pointer (&bg_data);
@@ -545,17 +794,40 @@ phosh_background_manager_get_data (PhoshBackgroundManager *self, PhoshBackground
 
     g_assert (GNOME_BG_IS_SLIDE_SHOW (self->slideshow));
 
-    /* TODO: handle actual slideshows (fixed == false) */
-    gnome_bg_slide_show_get_slide (self->slideshow, 0, width, height,
-                                   NULL, NULL, &fixed, &file1, NULL);
-    g_debug ("Background file: %s, fixed: %d", file1, fixed);
-    if (!fixed)
-      g_warning ("Only fixed slideshows supported properly atm");
-
-    bg_data->uri = g_file_new_for_path (file1);
+    bg_data->uri = get_slide_file (self, self->slide, width, height);
+    g_debug ("Background file: %s, slide: %u",
+             bg_data->uri ? g_file_peek_path (bg_data->uri) : "(none)", self->slide);
   } else if (self->file) {
     bg_data->uri = g_object_ref (self->file);
   }
 
   return g_steal_pointer (&bg_data);
 }
+
+/**
+ * phosh_background_manager_prepare_rotation:
+ * @self: The background manager
+ * @monitor: The monitor that is about to rotate
+ *
+ * Prepares the background on @monitor for a switch between portrait
+ * and landscape. This is meant to be invoked right before the new
+ * transform is sent to the compositor.
+ */
+void
+phosh_background_manager_prepare_rotation (PhoshBackgroundManager *self, PhoshMonitor *monitor)
+{
+  PhoshBackground *background;
+
+  g_return_if_fail (PHOSH_IS_BACKGROUND_MANAGER (self));
+  g_return_if_fail (PHOSH_IS_MONITOR (monitor));
+
+  /* Slides depend on the background's size, let them load as usual */
+  if (self->slideshow)
+    return;
+
+  background = g_hash_table_lookup (self->backgrounds, monitor);
+  if (!background)
+    return;
+
+  phosh_background_prepare_rotation (background);
+}
@@ -25,5 +25,7 @@ PhoshBackgroundManager *phosh_background_manager_new      (void);
 GList                  *phosh_background_manager_get_backgrounds (PhoshBackgroundManager *self);
 PhoshBackgroundData    *phosh_background_manager_get_data (PhoshBackgroundManager *self,
                                                            PhoshBackground        *background);
+void                    phosh_background_manager_prepare_rotation (PhoshBackgroundManager *self,
+                                                                   PhoshMonitor           *monitor);
 
 G_END_DECLS
@@ -21,6 +21,7 @@
 #include "layersurface-priv.h"
 #include "shell-priv.h"
 #include "top-panel.h"
+#include "trace.h"
 #include "util.h"
 
 #define GNOME_DESKTOP_USE_UNSTABLE_API
@@ -29,13 +30,8 @@
 
 #include <gio/gio.h>
 
-#include <math.h>
 #include <string.h>
 
-#define COLOR_TO_PIXEL(color)     ((((int)(color->red   * 255)) << 24) | \
-                                   (((int)(color->green * 255)) << 16) | \
-                                   (((int)(color->blue  * 255)) << 8)  | \
-                                   (((int)(color->alpha * 255))))
 /**
  * PhoshBackground:
  *
@@ -61,15 +57,25 @@ struct _PhoshBackground
   GFile                   *uri;
   PhoshBackgroundImage    *cached_bg_image;
   GCancellable            *cancel_load;
+  GCancellable            *cancel_preload;
   /* How the background in rendered */
   GDesktopBackgroundStyle  style;
   GdkRGBA                  color;
   GdkPixbuf               *pixbuf;
+  /* The window scale the pixbuf was rendered for */
+  int                      pixbuf_scale;
+  /* The pixbuf converted for drawing */
+  cairo_surface_t         *surface;
   gboolean                 needs_update;
+  /* Fully covered (e.g. by a fullscreen app) */
+  gboolean                 occluded;
 
   /* The monitor backed by PhoshBackground */
   gboolean                 primary;
   gboolean                 configured;
+
+  /* Start of the last update_image () */
+  gint64                   trace_begin;
 };
 
 
@@ -122,79 +128,13 @@ phosh_background_get_property (GObject    *object,
 }
 
 
-static GdkPixbuf *
-pb_scale_to_fit (GdkPixbuf *src, int width, int height, GdkRGBA *color)
-{
-  int orig_width, orig_height;
-  int final_width, final_height;
-  int off_x, off_y;
-  double ratio_horiz, ratio_vert, ratio;
-  GdkPixbuf *bg;
-
-  bg = gdk_pixbuf_new (GDK_COLORSPACE_RGB, FALSE, 8, width, height);
-  gdk_pixbuf_fill (bg, COLOR_TO_PIXEL(color));
-
-  orig_width = gdk_pixbuf_get_width (src);
-  orig_height = gdk_pixbuf_get_height (src);
-  ratio_horiz = (double) width / orig_width;
-  ratio_vert = (double) height / orig_height;
-
-  ratio = ratio_horiz > ratio_vert ? ratio_vert : ratio_horiz;
-  final_width = ceil (ratio * orig_width);
-  final_height = ceil (ratio * orig_height);
-
-  off_x = (width - final_width) / 2;
-  off_y = (height - final_height) / 2;
-  gdk_pixbuf_composite (src,
-                        bg,
-                        off_x, off_y, /* dest x,y */
-                        final_width,
-                        final_height,
-                        off_x, off_y, /* offset x, y */
-                        ratio,
-                        ratio,
-                        GDK_INTERP_BILINEAR,
-                        255);
-  return bg;
-}
-
-
-static GdkPixbuf *
-image_background (PhoshBackgroundImage    *image,
-                  guint                    width,
-                  guint                    height,
-                  GDesktopBackgroundStyle  style,
-                  GdkRGBA                 *color)
+static void
+set_pixbuf (PhoshBackground *self, GdkPixbuf *pixbuf)
 {
-  GdkPixbuf *scaled_bg = NULL;;
-
-  if (image == NULL) {
-    g_debug ("No image, using 'none' desktop style");
-    style = G_DESKTOP_BACKGROUND_STYLE_NONE;
-  }
-
-  switch (style) {
-  case G_DESKTOP_BACKGROUND_STYLE_NONE:
-    /* Nothing to do */
-    break;
-  case G_DESKTOP_BACKGROUND_STYLE_SCALED:
-    scaled_bg = pb_scale_to_fit (phosh_background_image_get_pixbuf (image), width, height, color);
-    break;
-  case G_DESKTOP_BACKGROUND_STYLE_WALLPAPER:
-  case G_DESKTOP_BACKGROUND_STYLE_CENTERED:
-  case G_DESKTOP_BACKGROUND_STYLE_STRETCHED:
-  case G_DESKTOP_BACKGROUND_STYLE_SPANNED:
-    g_warning ("Unimplemented style %d, using zoom", style);
-    G_GNUC_FALLTHROUGH;
-  case G_DESKTOP_BACKGROUND_STYLE_ZOOM:
-  default:
-    scaled_bg = phosh_utils_pixbuf_scale_to_min (phosh_background_image_get_pixbuf (image),
-                                                 width,
-                                                 height);
-    break;
-  }
-
-  return scaled_bg;
+  g_set_object (&self->pixbuf, pixbuf);
+  self->pixbuf_scale = gtk_widget_get_scale_factor (GTK_WIDGET (self));
+  g_clear_pointer (&self->surface, cairo_surface_destroy);
+  gtk_widget_queue_draw (GTK_WIDGET (self));
 }
 
 
@@ -227,7 +167,13 @@ phosh_background_draw (GtkWidget *widget, cairo_t *cr)
   }
 
   if (self->pixbuf) {
-    gdk_cairo_set_source_pixbuf (cr, self->pixbuf, x, y);
+    /* Convert once instead of on every frame */
+    if (self->surface == NULL) {
+      self->surface = gdk_cairo_surface_create_from_pixbuf (self->pixbuf,
+                                                            self->pixbuf_scale,
+                                                            gtk_widget_get_window (widget));
+    }
+    cairo_set_source_surface (cr, self->surface, x, y);
     cairo_paint (cr);
   }
 
@@ -237,6 +183,54 @@ phosh_background_draw (GtkWidget *widget, cairo_t *cr)
 }
 
 
+static void
+get_image_size (PhoshBackground *self, int *width, int *height)
+{
+  if (self->primary) {
+    phosh_shell_get_usable_area (phosh_shell_get_default (), NULL, NULL, width, height);
+  } else {
+    *width = phosh_layer_surface_get_configured_width (PHOSH_LAYER_SURFACE (self));
+    *height = phosh_layer_surface_get_configured_height (PHOSH_LAYER_SURFACE (self));
+  }
+}
+
+/*
+ * Scale the image to the window's buffer size so drawing it is a plain
+ * copy rather than upscaling it on every frame.
+ */
+static void
+get_image_buffer_size (PhoshBackground *self, int *width, int *height)
+{
+  int scale = gtk_widget_get_scale_factor (GTK_WIDGET (self));
+
+  get_image_size (self, width, height);
+  *width *= scale;
+  *height *= scale;
+}
+
+
+static void
+on_background_cache_scale_ready (GObject *source_object, GAsyncResult *res, gpointer data)
+{
+  g_autoptr (GError) err = NULL;
+  g_autoptr (GdkPixbuf) pixbuf = NULL;
+  PhoshBackground *self;
+
+  pixbuf = phosh_background_cache_scale_finish (PHOSH_BACKGROUND_CACHE (source_object), res, &err);
+  if (err) {
+    phosh_async_error_warn (err, "Failed to scale background image");
+    return;
+  }
+
+  self = PHOSH_BACKGROUND (data);
+  set_pixbuf (self, pixbuf);
+  self->needs_update = FALSE;
+
+  PHOSH_TRACE_MARK (self->trace_begin, "background: update image", "%dx%d",
+                    gdk_pixbuf_get_width (pixbuf), gdk_pixbuf_get_height (pixbuf));
+}
+
+
 static void
 update_image (PhoshBackground *self)
 {
@@ -245,23 +239,24 @@ update_image (PhoshBackground *self)
   if (!self->configured)
     return;
 
-  if (self->primary) {
-    phosh_shell_get_usable_area (phosh_shell_get_default (), NULL, NULL, &width, &height);
-  } else {
-    width = phosh_layer_surface_get_configured_width (PHOSH_LAYER_SURFACE (self));
-    height = phosh_layer_surface_get_configured_height (PHOSH_LAYER_SURFACE (self));
-  }
+  get_image_buffer_size (self, &width, &height);
 
   g_return_if_fail (width > 0 && height > 0);
 
   g_debug ("Scaling background %p to %dx%d", self, width, height);
-
-  g_clear_object (&self->pixbuf);
-  self->pixbuf = image_background (self->cached_bg_image, width, height,
-                                   self->style, &self->color);
-
-  self->needs_update = FALSE;
-  gtk_widget_queue_draw (GTK_WIDGET (self));
+  self->trace_begin = PHOSH_TRACE_CURRENT_TIME;
+
+  /* Keep showing the current pixbuf until the new one is ready */
+  phosh_background_cache_scale_async (phosh_background_cache_get_default (),
+                                      self->cached_bg_image,
+                                      width,
+                                      height,
+                                      self->style,
+                                      &self->color,
+                                      PHOSH_BACKGROUND_EFFECT_NONE,
+                                      self->cancel_load,
+                                      on_background_cache_scale_ready,
+                                      self);
 }
 
 
@@ -294,6 +289,12 @@ trigger_update (PhoshBackground *self)
   PhoshBackgroundManager *manager = phosh_shell_get_background_manager (phosh_shell_get_default ());
   g_autoptr (PhoshBackgroundData) bg_data = NULL;
 
+  /* Will update when unoccluded */
+  if (self->occluded) {
+    self->needs_update = TRUE;
+    return;
+  }
+
   g_debug ("Updating Background %p", self);
   bg_data = phosh_background_manager_get_data (manager, self);
 
@@ -302,11 +303,38 @@ trigger_update (PhoshBackground *self)
   self->color = bg_data->color;
   g_set_object (&self->uri, bg_data->uri);
 
+  /* Without an image non primary backgrounds are a single color */
+  if (self->uri == NULL && !self->primary) {
+    GdkRGBA color = self->color;
+
+    color.alpha = 1.0;
+    phosh_layer_surface_set_solid_color (PHOSH_LAYER_SURFACE (self), &color);
+  } else {
+    phosh_layer_surface_set_solid_color (PHOSH_LAYER_SURFACE (self), NULL);
+  }
+
   g_cancellable_cancel (self->cancel_load);
   g_clear_object (&self->cancel_load);
   self->cancel_load = g_cancellable_new ();
 
   if (self->uri) {
+    if (self->configured) {
+      int width, height;
+
+      get_image_buffer_size (self, &width, &height);
+      phosh_background_cache_ensure_size (cache, MAX (width, height));
+
+      /* Show the last scaled background until the real one is loaded */
+      if (self->pixbuf == NULL) {
+        g_autoptr (GdkPixbuf) pixbuf = NULL;
+
+        pixbuf = phosh_background_cache_lookup_disk (cache, self->uri, width, height,
+                                                     self->style, &self->color);
+        if (pixbuf)
+          set_pixbuf (self, pixbuf);
+      }
+    }
+
     phosh_background_cache_fetch_async (cache,
                                         self->uri,
                                         self->cancel_load,
@@ -319,6 +347,51 @@ trigger_update (PhoshBackground *self)
 }
 
 
+static void
+on_preload_scale_ready (GObject *source_object, GAsyncResult *res, gpointer data)
+{
+  g_autoptr (GError) err = NULL;
+  g_autoptr (GdkPixbuf) pixbuf = NULL;
+
+  /* The scaled pixbuf is kept in the cache, nothing else to do */
+  pixbuf = phosh_background_cache_scale_finish (PHOSH_BACKGROUND_CACHE (source_object), res, &err);
+  if (err)
+    phosh_async_error_warn (err, "Failed to preload background image");
+}
+
+
+static void
+on_preload_fetch_ready (GObject *source_object, GAsyncResult *res, gpointer data)
+{
+  g_autoptr (GError) err = NULL;
+  g_autoptr (PhoshBackgroundImage) image = NULL;
+  PhoshBackgroundCache *cache = PHOSH_BACKGROUND_CACHE (source_object);
+  PhoshBackground *self;
+  int width, height;
+
+  image = phosh_background_cache_fetch_finish (cache, res, &err);
+  if (!image) {
+    phosh_async_error_warn (err, "Failed to preload background image");
+    return;
+  }
+
+  self = PHOSH_BACKGROUND (data);
+  get_image_buffer_size (self, &width, &height);
+  g_return_if_fail (width > 0 && height > 0);
+
+  phosh_background_cache_scale_async (cache,
+                                      image,
+                                      width,
+                                      height,
+                                      self->style,
+                                      &self->color,
+                                      PHOSH_BACKGROUND_EFFECT_NONE,
+                                      self->cancel_preload,
+                                      on_preload_scale_ready,
+                                      self);
+}
+
+
 static void
 phosh_background_configured (PhoshLayerSurface *layer_surface)
 {
@@ -331,6 +404,18 @@ phosh_background_configured (PhoshLayerSurface *layer_surface)
 }
 
 
+static void
+phosh_background_unrealize (GtkWidget *widget)
+{
+  PhoshBackground *self = PHOSH_BACKGROUND (widget);
+
+  /* The surface is tied to our window */
+  g_clear_pointer (&self->surface, cairo_surface_destroy);
+
+  GTK_WIDGET_CLASS (phosh_background_parent_class)->unrealize (widget);
+}
+
+
 static void
 phosh_background_finalize (GObject *object)
 {
@@ -338,6 +423,9 @@ phosh_background_finalize (GObject *object)
 
   g_cancellable_cancel (self->cancel_load);
   g_clear_object (&self->cancel_load);
+  g_cancellable_cancel (self->cancel_preload);
+  g_clear_object (&self->cancel_preload);
+  g_clear_pointer (&self->surface, cairo_surface_destroy);
   g_clear_object (&self->pixbuf);
   g_clear_object (&self->cached_bg_image);
 
@@ -357,6 +445,7 @@ phosh_background_class_init (PhoshBackgroundClass *klass)
   object_class->get_property = phosh_background_get_property;
 
   widget_class->draw = phosh_background_draw;
+  widget_class->unrealize = phosh_background_unrealize;
 
   layer_surface_class->configured = phosh_background_configured;
 
@@ -384,6 +473,9 @@ phosh_background_class_init (PhoshBackgroundClass *klass)
 static void
 phosh_background_init (PhoshBackground *self)
 {
+  self->pixbuf_scale = 1;
+
+  g_signal_connect (self, "notify::scale-factor", G_CALLBACK (phosh_background_needs_update), NULL);
 }
 
 
@@ -443,3 +535,113 @@ phosh_background_needs_update (PhoshBackground *self)
 
   trigger_update (self);
 }
+
+/**
+ * phosh_background_preload:
+ * @self: The background
+ * @file: The image to preload
+ *
+ * Decodes and scales @file for this background in the background cache
+ * so a later switch to it doesn't need to wait for the image to load. A
+ * new preload cancels the previous one.
+ */
+void
+phosh_background_preload (PhoshBackground *self, GFile *file)
+{
+  g_return_if_fail (PHOSH_IS_BACKGROUND (self));
+  g_return_if_fail (G_IS_FILE (file));
+
+  if (!self->configured || self->occluded)
+    return;
+
+  g_cancellable_cancel (self->cancel_preload);
+  g_clear_object (&self->cancel_preload);
+  self->cancel_preload = g_cancellable_new ();
+
+  g_debug ("Preloading '%s' for background %p", g_file_peek_path (file), self);
+  phosh_background_cache_fetch_async (phosh_background_cache_get_default (),
+                                      file,
+                                      self->cancel_preload,
+                                      on_preload_fetch_ready,
+                                      self);
+}
+
+/**
+ * phosh_background_prepare_rotation:
+ * @self: The background
+ *
+ * Scales the current image for the size the background will have
+ * once its monitor switches between portrait and landscape so the
+ * image is already in the [type@BackgroundCache] when the compositor
+ * sends the new size.
+ */
+void
+phosh_background_prepare_rotation (PhoshBackground *self)
+{
+  int width, height, conf_width, conf_height;
+
+  g_return_if_fail (PHOSH_IS_BACKGROUND (self));
+
+  if (!self->configured || self->occluded || !self->cached_bg_image)
+    return;
+
+  conf_width = phosh_layer_surface_get_configured_width (PHOSH_LAYER_SURFACE (self));
+  conf_height = phosh_layer_surface_get_configured_height (PHOSH_LAYER_SURFACE (self));
+  get_image_size (self, &width, &height);
+
+  /* Panels keep their size, so is the area they cover */
+  width = conf_height - (conf_width - width);
+  height = conf_width - (conf_height - height);
+  g_return_if_fail (width > 0 && height > 0);
+  width *= gtk_widget_get_scale_factor (GTK_WIDGET (self));
+  height *= gtk_widget_get_scale_factor (GTK_WIDGET (self));
+
+  g_cancellable_cancel (self->cancel_preload);
+  g_clear_object (&self->cancel_preload);
+  self->cancel_preload = g_cancellable_new ();
+
+  g_debug ("Preparing background %p for %dx%d", self, width, height);
+  phosh_background_cache_ensure_size (phosh_background_cache_get_default (), MAX (width, height));
+  phosh_background_cache_scale_async (phosh_background_cache_get_default (),
+                                      self->cached_bg_image,
+                                      width,
+                                      height,
+                                      self->style,
+                                      &self->color,
+                                      PHOSH_BACKGROUND_EFFECT_NONE,
+                                      self->cancel_preload,
+                                      on_preload_scale_ready,
+                                      self);
+}
+
+/**
+ * phosh_background_set_occluded:
+ * @self: The background
+ * @occluded: Whether the background is fully covered
+ *
+ * While occluded the background drops its image so it only uses
+ * memory when visible. It's restored from the
+ * [type@BackgroundCache] once unoccluded.
+ */
+void
+phosh_background_set_occluded (PhoshBackground *self, gboolean occluded)
+{
+  g_return_if_fail (PHOSH_IS_BACKGROUND (self));
+
+  if (self->occluded == occluded)
+    return;
+
+  self->occluded = occluded;
+  g_debug ("Background %p occluded: %d", self, occluded);
+
+  if (occluded) {
+    g_cancellable_cancel (self->cancel_load);
+    g_cancellable_cancel (self->cancel_preload);
+    g_clear_object (&self->cached_bg_image);
+    set_pixbuf (self, NULL);
+    return;
+  }
+
+  if (self->configured)
+    trigger_update (self);
+}
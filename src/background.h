@@ -36,6 +36,11 @@ float               phosh_background_get_scale        (PhoshBackground         *
 void                phosh_background_set_scale        (PhoshBackground         *self,
                                                        float                    scale);
 void                phosh_background_needs_update     (PhoshBackground         *self);
+void                phosh_background_preload          (PhoshBackground         *self,
+                                                       GFile                   *file);
+void                phosh_background_prepare_rotation (PhoshBackground         *self);
+void                phosh_background_set_occluded     (PhoshBackground         *self,
+                                                       gboolean                 occluded);
 
 void                phosh_background_data_free        (PhoshBackgroundData    *bg_data);
 
@@ -356,6 +356,29 @@ phosh_backlight_set_relative (PhoshBacklight *self, double val)
   phosh_backlight_set_brightness (self, brightness);
 }
 
+/**
+ * phosh_backlight_relative_to_level:
+ * @self: The backlight
+ * @val: The relative brightness
+ *
+ * Get the hardware brightness level a relative brightness value
+ * between `[0.0, 1.0]` maps to. This allows to e.g. check if two
+ * relative values result in the same brightness.
+ *
+ * Returns: The brightness level
+ */
+int
+phosh_backlight_relative_to_level (PhoshBacklight *self, double val)
+{
+  PhoshBacklightPrivate *priv = phosh_backlight_get_instance_private (self);
+  double brightness;
+
+  g_return_val_if_fail (PHOSH_IS_BACKLIGHT (self), -1);
+
+  brightness = priv->brightness.min + ((priv->brightness.max - priv->brightness.min) * val);
+  return phosh_backlight_brightness_to_level (self, brightness);
+}
+
 /**
  * phosh_backlight_get_relative:
  * @self: The backlight
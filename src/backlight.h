@@ -24,6 +24,7 @@ int                 phosh_backlight_get_brightness (PhoshBacklight *self);
 void                phosh_backlight_set_brightness (PhoshBacklight *self, double brightness);
 double              phosh_backlight_get_relative (PhoshBacklight *self);
 void                phosh_backlight_set_relative (PhoshBacklight *self, double val);
+int                 phosh_backlight_relative_to_level (PhoshBacklight *self, double val);
 void                phosh_backlight_get_range (PhoshBacklight *self,
                                                int            *min_brightness,
                                                int            *max_brightness);
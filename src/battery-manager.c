@@ -11,6 +11,7 @@
 #include "phosh-config.h"
 #include "battery-manager.h"
 
+#include "property-batch.h"
 #include "upower.h"
 
 #include <math.h>
@@ -26,38 +27,46 @@ enum {
   PROP_PRESENT,
   PROP_ICON_NAME,
   PROP_PERCENT,
+  PROP_LOW,
   PROP_LAST_PROP
 };
 static GParamSpec *props[PROP_LAST_PROP];
 
 struct _PhoshBatteryManager {
-  PhoshManager  parent;
+  PhoshManager        parent;
 
-  UpClient     *upower;
-  UpDevice     *device;
-  GCancellable *cancel;
+  UpClient           *upower;
+  UpDevice           *device;
+  PhoshPropertyBatch *device_batch;
+  GCancellable       *cancel;
 
-  gboolean      present;
-  char         *icon_name;
-  uint          percent;
+  gboolean            present;
+  char               *icon_name;
+  uint                percent;
+  gboolean            low;
 };
 G_DEFINE_TYPE (PhoshBatteryManager, phosh_battery_manager, PHOSH_TYPE_MANAGER)
 
 
 static void
-on_property_changed (PhoshBatteryManager *self,
-                     GParamSpec          *pspec,
-                     UpDevice            *device)
+on_properties_changed (PhoshBatteryManager *self)
 {
+  UpDevice *device = self->device;
   UpDeviceState state;
+  UpDeviceLevel warning_level;
   double percentage;
   int smallest_ten;
   uint percent;
   gboolean is_charging;
   gboolean is_charged;
+  gboolean low;
   g_autofree char *icon_name = NULL;
 
-  g_object_get (device, "state", &state, "percentage", &percentage, NULL);
+  g_object_get (device,
+                "state", &state,
+                "percentage", &percentage,
+                "warning-level", &warning_level,
+                NULL);
 
   is_charging = state == UP_DEVICE_STATE_CHARGING;
   smallest_ten = floor (percentage / 10.0) * 10;
@@ -84,6 +93,13 @@ on_property_changed (PhoshBatteryManager *self,
     self->percent = percent;
     g_object_notify_by_pspec (G_OBJECT (self), props[PROP_PERCENT]);
   }
+
+  low = state == UP_DEVICE_STATE_DISCHARGING && warning_level >= UP_DEVICE_LEVEL_LOW;
+  if (self->low != low) {
+    self->low = low;
+    g_debug ("Battery low: %d", self->low);
+    g_object_notify_by_pspec (G_OBJECT (self), props[PROP_LOW]);
+  }
 }
 
 
@@ -110,17 +126,18 @@ on_up_client_new_ready (GObject *source, GAsyncResult *result, gpointer data)
   }
 
   g_debug ("Got upower display device");
-  g_object_connect (self->device,
-                    "swapped-object-signal::notify::percentage",
-                    G_CALLBACK (on_property_changed),
-                    self,
-                    "swapped-object-signal::notify::state",
-                    G_CALLBACK (on_property_changed),
-                    self,
-                    NULL);
+  /* Percentage, state and warning level usually change together */
+  self->device_batch = phosh_property_batch_new (self->device,
+                                                 "percentage",
+                                                 "state",
+                                                 "warning-level",
+                                                 NULL);
+  g_signal_connect_object (self->device_batch, "changed",
+                           G_CALLBACK (on_properties_changed), self,
+                           G_CONNECT_SWAPPED);
 
   self->present = TRUE;
-  on_property_changed (self, NULL, self->device);
+  on_properties_changed (self);
   g_object_notify_by_pspec (G_OBJECT (self), props[PROP_PRESENT]);
 }
 
@@ -152,6 +169,9 @@ phosh_battery_manager_get_property (GObject    *object,
   case PROP_PERCENT:
     g_value_set_uint (value, self->percent);
     break;
+  case PROP_LOW:
+    g_value_set_boolean (value, self->low);
+    break;
   default:
     G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     break;
@@ -166,6 +186,7 @@ phosh_battery_manager_dispose (GObject *object)
 
   g_cancellable_cancel (self->cancel);
   g_clear_object (&self->cancel);
+  g_clear_object (&self->device_batch);
   g_clear_object (&self->device);
   g_clear_object (&self->upower);
 
@@ -213,6 +234,16 @@ phosh_battery_manager_class_init (PhoshBatteryManagerClass *klass)
     g_param_spec_uint ("percent", "", "",
                        0, G_MAXUINT, 0,
                        G_PARAM_READABLE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+  /**
+   * PhoshBatteryManager:low:
+   *
+   * Whether the main battery is discharging and reached a low
+   * warning level
+   */
+  props[PROP_LOW] =
+    g_param_spec_boolean ("low", "", "",
+                          FALSE,
+                          G_PARAM_READABLE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
 
   g_object_class_install_properties (object_class, PROP_LAST_PROP, props);
 }
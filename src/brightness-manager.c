@@ -12,7 +12,9 @@
 
 #include "auto-brightness.h"
 #include "auto-brightness-bucket.h"
+#include "auto-brightness-filter.h"
 #include "brightness-manager.h"
+#include "phosh-settings-enums.h"
 #include "shell-priv.h"
 #include "util.h"
 
@@ -26,6 +28,7 @@
 
 #define BRIGHTNESS_SCHEMA_ID "mobi.phosh.shell.brightness"
 #define BRIGHTNESS_KEY_AUTO_BRIGHTNESS_OFFSET "auto-brightness-offset"
+#define BRIGHTNESS_KEY_AUTO_BRIGHTNESS_TRACKER "auto-brightness-tracker"
 
 /**
  * PhoshBrightnessManager:
@@ -51,6 +54,13 @@ enum {
 static GParamSpec *props[LAST_PROP];
 
 #define MAX_KEYBOARD_LEVELS 20
+/* Apply brightness key presses at most once per frame */
+#define KEY_FRAME_MS        16
+/* Presses closer together than this are a held key */
+#define KEY_HOLD_GAP_US     (250 * G_USEC_PER_SEC / 1000)
+/* Speed up by one step per press each second the key is held */
+#define KEY_ACCEL_US        G_USEC_PER_SEC
+#define KEY_MAX_ACCEL       3
 
 struct _PhoshBrightnessManager {
   PhoshDBusBrightnessSkeleton parent;
@@ -84,6 +94,14 @@ struct _PhoshBrightnessManager {
     uint   id;
   } transition;
 
+  struct {
+    int      steps;
+    gboolean up;
+    gint64   hold_start;
+    gint64   last_press;
+    guint    id;
+  } keys;
+
   const char *icon_name;
   int         dbus_name_id;
   double      saved_brightness;
@@ -147,7 +165,7 @@ static void
 transition_to_brightness (PhoshBrightnessManager *self, double target)
 {
   double current = phosh_backlight_get_relative (self->backlight);
-  uint steps;
+  uint steps, levels;
 
   g_clear_handle_id (&self->transition.id, g_source_remove);
 
@@ -155,11 +173,21 @@ transition_to_brightness (PhoshBrightnessManager *self, double target)
   if (G_APPROX_VALUE (current, self->transition.target, FLT_EPSILON))
     return;
 
+  /* No point in having more steps than hardware levels in between */
+  levels = ABS (phosh_backlight_relative_to_level (self->backlight, target) -
+                phosh_backlight_relative_to_level (self->backlight, current));
+  if (levels <= 1) {
+    g_debug ("Setting auto brightness to %.2f", target);
+    phosh_backlight_set_relative (self->backlight, target);
+    return;
+  }
+
   self->transition.interval = target > current ? AUTO_UP_INTERVAL : AUTO_DOWN_INTERVAL;
 
   self->transition.elapsed = 0;
   self->transition.start = current;
-  steps = ceil (ABS (self->transition.target - self->transition.start) / 0.025);
+  steps = ceil (ABS (self->transition.target - self->transition.start) / AUTO_STEP_CHANGE);
+  steps = MIN (steps, levels);
   if (steps * self->transition.interval > AUTO_MAX_DURATION) {
     g_debug ("Limiting max transition duration from %.0fms to %dms",
              steps * self->transition.interval, AUTO_MAX_DURATION);
@@ -280,11 +308,23 @@ on_night_light_temp_changed (PhoshBrightnessManager *self,
 static void
 set_auto_brightness_tracker (PhoshBrightnessManager *self)
 {
+  PhoshAutoBrightnessTracker tracker;
+
   if (self->auto_brightness.tracker)
     return;
 
-  /* TODO: allow for different brightness trackers */
-  self->auto_brightness.tracker = PHOSH_AUTO_BRIGHTNESS (phosh_auto_brightness_bucket_new ());
+  tracker = g_settings_get_enum (self->settings_brightness, BRIGHTNESS_KEY_AUTO_BRIGHTNESS_TRACKER);
+  switch (tracker) {
+  case PHOSH_AUTO_BRIGHTNESS_TRACKER_FILTER:
+    self->auto_brightness.tracker = PHOSH_AUTO_BRIGHTNESS (phosh_auto_brightness_filter_new ());
+    break;
+  case PHOSH_AUTO_BRIGHTNESS_TRACKER_BUCKET:
+  default:
+    self->auto_brightness.tracker = PHOSH_AUTO_BRIGHTNESS (phosh_auto_brightness_bucket_new ());
+    break;
+  }
+  g_debug ("Using auto brightness tracker %s", G_OBJECT_TYPE_NAME (self->auto_brightness.tracker));
+
   g_signal_connect_swapped (self->auto_brightness.tracker,
                             "notify::brightness",
                             G_CALLBACK (on_auto_brightness_changed),
@@ -582,6 +622,26 @@ on_auto_brightness_offset_changed (PhoshBrightnessManager *self,
 }
 
 
+static void
+on_auto_brightness_tracker_changed (PhoshBrightnessManager *self)
+{
+  PhoshAmbient *ambient = phosh_shell_get_ambient (phosh_shell_get_default ());
+
+  g_clear_object (&self->auto_brightness.tracker);
+
+  /* If auto brightness is disabled we'll pick up the tracker when it gets enabled */
+  if (!self->auto_brightness.enabled)
+    return;
+
+  set_auto_brightness_tracker (self);
+  if (ambient) {
+    phosh_auto_brightness_add_ambient_level (self->auto_brightness.tracker,
+                                             phosh_ambient_get_light_level (ambient));
+  }
+  on_auto_brightness_changed (self);
+}
+
+
 static void
 show_osd (PhoshBrightnessManager *self, double brightness)
 {
@@ -600,23 +660,18 @@ show_osd (PhoshBrightnessManager *self, double brightness)
 
 
 static void
-adjust_brightness (PhoshBrightnessManager *self, gboolean up)
+apply_key_steps (PhoshBrightnessManager *self)
 {
   int levels;
   double brightness, step;
 
-  if (!self->backlight)
-    return;
-
   levels = phosh_backlight_get_levels (self->backlight);
   levels = MIN (MAX_KEYBOARD_LEVELS, levels);
   step = 1.0 / levels;
   brightness = phosh_backlight_get_relative (self->backlight);
 
-  if (up)
-    brightness += step;
-  else
-    brightness -= step;
+  brightness += self->keys.steps * step;
+  self->keys.steps = 0;
 
   brightness = CLAMP (brightness, 0.0, 1.0);
   phosh_backlight_set_relative (self->backlight, brightness);
@@ -625,6 +680,54 @@ adjust_brightness (PhoshBrightnessManager *self, gboolean up)
 }
 
 
+static gboolean
+on_key_frame (gpointer data)
+{
+  PhoshBrightnessManager *self = PHOSH_BRIGHTNESS_MANAGER (data);
+
+  if (self->keys.steps == 0 || !self->backlight) {
+    self->keys.steps = 0;
+    self->keys.id = 0;
+    return G_SOURCE_REMOVE;
+  }
+
+  apply_key_steps (self);
+  return G_SOURCE_CONTINUE;
+}
+
+/*
+ * Key repeat can fire faster than the backlight and the OSD can
+ * keep up. Apply the first press right away and accumulate the
+ * ones arriving within the same frame so there's one backlight
+ * write and OSD update per frame. Holding a key speeds it up.
+ */
+static void
+adjust_brightness (PhoshBrightnessManager *self, gboolean up)
+{
+  gint64 now = g_get_monotonic_time ();
+  int accel;
+
+  if (!self->backlight)
+    return;
+
+  if (now - self->keys.last_press > KEY_HOLD_GAP_US || up != self->keys.up)
+    self->keys.hold_start = now;
+  self->keys.last_press = now;
+  self->keys.up = up;
+
+  accel = MIN (1 + (now - self->keys.hold_start) / KEY_ACCEL_US, KEY_MAX_ACCEL);
+  self->keys.steps += up ? accel : -accel;
+
+  /* Picked up with the next frame */
+  if (self->keys.id)
+    return;
+
+  apply_key_steps (self);
+  self->keys.id = g_timeout_add (KEY_FRAME_MS, on_key_frame, self);
+  g_source_set_name_by_id (self->keys.id, "[phosh] brightness keys");
+}
+
+
 static void
 on_brightness_up (GSimpleAction *action, GVariant *param, gpointer data)
 {
@@ -742,6 +845,7 @@ phosh_brightness_manager_dispose (GObject *object)
   PhoshBrightnessManager *self = PHOSH_BRIGHTNESS_MANAGER (object);
 
   g_clear_handle_id (&self->transition.id, g_source_remove);
+  g_clear_handle_id (&self->keys.id, g_source_remove);
   g_clear_handle_id (&self->dbus_name_id, g_bus_unown_name);
 
   if (g_dbus_interface_skeleton_get_object_path (G_DBUS_INTERFACE_SKELETON (self)))
@@ -818,6 +922,10 @@ phosh_brightness_manager_init (PhoshBrightnessManager *self)
                             "changed::" BRIGHTNESS_KEY_AUTO_BRIGHTNESS_OFFSET,
                             G_CALLBACK (on_auto_brightness_offset_changed),
                             self);
+  g_signal_connect_swapped (self->settings_brightness,
+                            "changed::" BRIGHTNESS_KEY_AUTO_BRIGHTNESS_TRACKER,
+                            G_CALLBACK (on_auto_brightness_tracker_changed),
+                            self);
 
   self->adjustment = g_object_ref_sink (gtk_adjustment_new (0, 0, 1.0, 0.01, 0.01, 0));
   self->value_changed_id = g_signal_connect_swapped (self->adjustment,
@@ -12,6 +12,7 @@
 #include "phosh-config.h"
 
 #include "bt-manager.h"
+#include "property-batch.h"
 #include "shell-priv.h"
 #include "dbus/gsd-rfkill-dbus.h"
 #include "util.h"
@@ -54,11 +55,16 @@ struct _PhoshBtManager {
   guint               n_connected;
   guint               n_devices;
   char               *info;
+  /* Connectable and connected devices, holds a ref */
+  GHashTable         *connected;
+  /* The connected device the info is about, unowned */
+  BluetoothDevice    *info_device;
 
   BluetoothClient    *bt_client;
   GtkFilterListModel *connectable_devices;
 
   PhoshDBusRfkill    *proxy;
+  PhoshPropertyBatch *rfkill_batch;
 };
 G_DEFINE_TYPE (PhoshBtManager, phosh_bt_manager, PHOSH_TYPE_MANAGER);
 
@@ -179,6 +185,17 @@ on_bt_has_airplane_mode_changed (PhoshBtManager *self, GParamSpec *pspec, PhoshD
 }
 
 
+static void
+on_rfkill_changed (PhoshBtManager *self, GStrv properties)
+{
+  /* Updating `present` syncs `enabled` too */
+  if (g_strv_contains ((const char * const *)properties, "bluetooth-has-airplane-mode"))
+    on_bt_has_airplane_mode_changed (self, NULL, self->proxy);
+  else
+    on_bt_airplane_mode_changed (self, NULL, self->proxy);
+}
+
+
 static void
 on_proxy_new_for_bus_finish (GObject *source_object, GAsyncResult *res, gpointer user_data)
 {
@@ -194,14 +211,13 @@ on_proxy_new_for_bus_finish (GObject *source_object, GAsyncResult *res, gpointer
     goto out;
   }
 
-  g_object_connect (self->proxy,
-                    "swapped-object-signal::notify::bluetooth-airplane-mode",
-                    G_CALLBACK (on_bt_airplane_mode_changed),
-                    self,
-                    "swapped-object-signal::notify::bluetooth-has-airplane-mode",
-                    G_CALLBACK (on_bt_has_airplane_mode_changed),
-                    self,
-                    NULL);
+  self->rfkill_batch = phosh_property_batch_new (self->proxy,
+                                                 "bluetooth-airplane-mode",
+                                                 "bluetooth-has-airplane-mode",
+                                                 NULL);
+  g_signal_connect_object (self->rfkill_batch, "changed",
+                           G_CALLBACK (on_rfkill_changed), self,
+                           G_CONNECT_SWAPPED);
   on_bt_airplane_mode_changed (self, NULL, self->proxy);
   on_bt_has_airplane_mode_changed (self, NULL, self->proxy);
 
@@ -231,8 +247,13 @@ phosh_bt_manager_dispose (GObject *object)
 {
   PhoshBtManager *self = PHOSH_BT_MANAGER (object);
 
+  g_clear_object (&self->rfkill_batch);
   g_clear_object (&self->proxy);
+  if (self->connectable_devices)
+    g_signal_handlers_disconnect_by_data (self->connectable_devices, self);
   g_clear_object (&self->connectable_devices);
+  self->info_device = NULL;
+  g_clear_pointer (&self->connected, g_hash_table_destroy);
   g_clear_object (&self->bt_client);
 
   g_clear_pointer (&self->info, g_free);
@@ -327,50 +348,111 @@ filter_devices (gpointer item, gpointer data)
 
 
 static void
-refilter_cb (PhoshBtManager *self)
+update_info (PhoshBtManager *self)
 {
-  g_assert (PHOSH_IS_BT_MANAGER (self));
+  g_autofree char *info = NULL;
+
+  if (self->info_device)
+    g_object_get (self->info_device, "alias", &info, NULL);
 
-  gtk_filter_list_model_refilter (self->connectable_devices);
+  if (g_strcmp0 (self->info, info)) {
+    g_debug ("New info: %s", info);
+    g_free (self->info);
+    self->info = g_steal_pointer (&info);
+    g_object_notify_by_pspec (G_OBJECT (self), props[PROP_INFO]);
+  }
 }
 
 
 static void
-recount_cb (PhoshBtManager *self)
+update_n_connected (PhoshBtManager *self)
 {
-  g_autofree char *last_info = NULL;
-  guint n_devices, n_connected = 0;
+  guint n_connected = g_hash_table_size (self->connected);
 
-  g_assert (PHOSH_IS_BT_MANAGER (self));
+  if (self->n_connected != n_connected) {
+    g_debug ("%d Bluetooth devices connected", n_connected);
+    self->n_connected = n_connected;
+    g_object_notify_by_pspec (G_OBJECT (self), props[PROP_N_CONNECTED]);
+  }
+}
 
-  n_devices = g_list_model_get_n_items (G_LIST_MODEL (self->connectable_devices));
-  for (int i = 0; i < n_devices; i++) {
-    g_autoptr (BluetoothDevice) device = NULL;
-    g_autofree char *info = NULL;
-    gboolean connected;
 
-    device = g_list_model_get_item (G_LIST_MODEL (self->connectable_devices), i);
-    g_object_get (device, "connected", &connected, "alias", &info, NULL);
+static void
+remove_connected (PhoshBtManager *self, BluetoothDevice *device)
+{
+  if (self->info_device == device)
+    self->info_device = NULL;
 
-    if (connected) {
-      n_connected++;
-      last_info = g_steal_pointer (&info);
-    }
-  }
+  g_hash_table_remove (self->connected, device);
 
-  if (g_strcmp0 (self->info, last_info)) {
-    g_debug ("New info: %s", last_info);
-    g_free (self->info);
-    self->info = g_steal_pointer (&last_info);
-    g_object_notify_by_pspec (G_OBJECT (self), props[PROP_INFO]);
+  /* Fall back to any other connected device */
+  if (self->info_device == NULL) {
+    GHashTableIter iter;
+
+    g_hash_table_iter_init (&iter, self->connected);
+    g_hash_table_iter_next (&iter, (gpointer *)&self->info_device, NULL);
   }
+}
 
-  if (self->n_connected != n_connected) {
-    g_debug ("%d Bluetooth devices connected", n_connected);
-    self->n_connected = n_connected;
-    g_object_notify_by_pspec (G_OBJECT (self), props[PROP_N_CONNECTED]);
+
+static void
+update_device (PhoshBtManager *self, BluetoothDevice *device)
+{
+  gboolean connectable, connected, counted;
+
+  g_object_get (device, "connectable", &connectable, "connected", &connected, NULL);
+
+  counted = connectable && connected;
+  if (counted == g_hash_table_contains (self->connected, device))
+    return;
+
+  if (counted) {
+    g_hash_table_add (self->connected, g_object_ref (device));
+    self->info_device = device;
+  } else {
+    remove_connected (self, device);
   }
 
+  update_info (self);
+  update_n_connected (self);
+}
+
+
+static void
+on_device_connectable_changed (PhoshBtManager *self, GParamSpec *pspec, BluetoothDevice *device)
+{
+  GListModel *devices;
+  guint pos;
+
+  g_assert (PHOSH_IS_BT_MANAGER (self));
+  g_assert (BLUETOOTH_IS_DEVICE (device));
+
+  devices = gtk_filter_list_model_get_model (self->connectable_devices);
+  if (g_list_store_find (G_LIST_STORE (devices), device, &pos))
+    gtk_filter_list_model_refilter_item (self->connectable_devices, pos);
+
+  update_device (self, device);
+}
+
+
+static void
+on_device_connected_changed (PhoshBtManager *self, GParamSpec *pspec, BluetoothDevice *device)
+{
+  g_assert (PHOSH_IS_BT_MANAGER (self));
+  g_assert (BLUETOOTH_IS_DEVICE (device));
+
+  update_device (self, device);
+}
+
+
+static void
+on_connectable_devices_changed (PhoshBtManager *self)
+{
+  guint n_devices;
+
+  g_assert (PHOSH_IS_BT_MANAGER (self));
+
+  n_devices = g_list_model_get_n_items (G_LIST_MODEL (self->connectable_devices));
   if (self->n_devices != n_devices) {
     g_debug ("%d Bluetooth devices", n_devices);
     self->n_devices = n_devices;
@@ -385,19 +467,37 @@ on_device_added (PhoshBtManager *self, BluetoothDevice *device)
   g_assert (PHOSH_IS_BT_MANAGER (self));
   g_assert (BLUETOOTH_IS_DEVICE (device));
 
-  g_signal_connect_swapped (device, "notify::connectable", G_CALLBACK (refilter_cb), self);
-  g_signal_connect_swapped (device, "notify::connected", G_CALLBACK (recount_cb), self);
+  /* The filter model picks up the new device itself */
+  g_signal_connect_object (device, "notify::connectable",
+                           G_CALLBACK (on_device_connectable_changed), self,
+                           G_CONNECT_SWAPPED);
+  g_signal_connect_object (device, "notify::connected",
+                           G_CALLBACK (on_device_connected_changed), self,
+                           G_CONNECT_SWAPPED);
 
-  refilter_cb (self);
-  recount_cb (self);
+  update_device (self, device);
 }
 
 
 static void
-on_device_removed (PhoshBtManager *self, BluetoothDevice *device)
+on_device_removed (PhoshBtManager *self, const char *object_path)
 {
-  refilter_cb (self);
-  recount_cb (self);
+  GHashTableIter iter;
+  BluetoothDevice *device;
+
+  g_assert (PHOSH_IS_BT_MANAGER (self));
+
+  /* Only connected devices affect the counts */
+  g_hash_table_iter_init (&iter, self->connected);
+  while (g_hash_table_iter_next (&iter, (gpointer *)&device, NULL)) {
+    if (g_strcmp0 (bluetooth_device_get_object_path (device), object_path) == 0) {
+      g_signal_handlers_disconnect_by_data (device, self);
+      remove_connected (self, device);
+      update_info (self);
+      update_n_connected (self);
+      break;
+    }
+  }
 }
 
 
@@ -413,6 +513,8 @@ setup_devices (PhoshBtManager *self)
                                                          filter_devices,
                                                          self,
                                                          NULL);
+  g_signal_connect_swapped (self->connectable_devices, "items-changed",
+                            G_CALLBACK (on_connectable_devices_changed), self);
   g_object_connect (self->bt_client,
                     "swapped-object-signal::device-added", on_device_added, self,
                     "swapped-object-signal::device-removed", on_device_removed, self,
@@ -427,7 +529,7 @@ setup_devices (PhoshBtManager *self)
     on_device_added (self, device);
   }
 
-  recount_cb (self);
+  on_connectable_devices_changed (self);
 }
 
 
@@ -435,6 +537,7 @@ static void
 phosh_bt_manager_init (PhoshBtManager *self)
 {
   self->icon_name = "bluetooth-disabled-symbolic";
+  self->connected = g_hash_table_new_full (g_direct_hash, g_direct_equal, g_object_unref, NULL);
 
   self->bt_client = bluetooth_client_new ();
   g_object_connect (self->bt_client,
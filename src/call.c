@@ -9,11 +9,15 @@
 #define G_LOG_DOMAIN "phosh-call"
 
 #include "call.h"
+#include "timer-service.h"
 #include "util.h"
 
 #include <gmobile.h>
 #include <cui-call.h>
 
+#define ACTIVE_TIME_INTERVAL  500 /* ms */
+#define ACTIVE_TIME_TOLERANCE 100 /* ms */
+
 /**
  * PhoshCall:
  *
@@ -172,6 +176,17 @@ on_active_time_ticked (gpointer data)
 }
 
 
+static void
+clear_active_time_timeout (PhoshCall *self)
+{
+  if (!self->timer_id)
+    return;
+
+  phosh_timer_service_remove_timeout (phosh_timer_service_get_default (), self->timer_id);
+  self->timer_id = 0;
+}
+
+
 static void
 on_state_changed (PhoshCall *self)
 {
@@ -184,10 +199,14 @@ on_state_changed (PhoshCall *self)
   if (cui_call_get_state (CUI_CALL (self)) == CUI_CALL_STATE_ACTIVE &&
       !self->timer) {
     self->timer = g_timer_new ();
-    self->timer_id = g_timeout_add (500, on_active_time_ticked, self);
-    g_source_set_name_by_id (self->timer_id, "[phosh] call timeout");
+    /* The active time is read from the timer so it's fine to skip ticks when the screen is off */
+    self->timer_id = phosh_timer_service_add_timeout (phosh_timer_service_get_default (),
+                                                      ACTIVE_TIME_INTERVAL,
+                                                      ACTIVE_TIME_TOLERANCE,
+                                                      on_active_time_ticked,
+                                                      self);
   } else if (cui_call_get_state (CUI_CALL (self)) == CUI_CALL_STATE_DISCONNECTED) {
-    g_clear_handle_id (&self->timer_id, g_source_remove);
+    clear_active_time_timeout (self);
     g_clear_pointer (&self->timer, g_timer_destroy);
   }
 
@@ -304,7 +323,7 @@ phosh_call_dispose (GObject *object)
   g_signal_handlers_disconnect_by_data (self->proxy, self);
   g_clear_object (&self->proxy);
   g_clear_object (&self->avatar_icon);
-  g_clear_handle_id (&self->timer_id, g_source_remove);
+  clear_active_time_timeout (self);
   g_clear_pointer (&self->timer, g_timer_destroy);
 
   G_OBJECT_CLASS (phosh_call_parent_class)->dispose (object);
@@ -125,22 +125,12 @@ on_call_state_changed (PhoshCallsManager *self, GParamSpec *pspec, PhoshDBusCall
 
 
 static void
-on_call_proxy_new_for_bus_finish (GObject *source_object, GAsyncResult *res, gpointer data)
+add_call (PhoshCallsManager *self, PhoshDBusCallsCall *proxy)
 {
   const char *path;
   gboolean inbound;
-  PhoshCallsManager *self;
-  g_autoptr (PhoshDBusCallsCall) proxy = NULL;
   g_autoptr (PhoshCall) call = NULL;
-  g_autoptr (GError) err = NULL;
 
-  proxy = phosh_dbus_calls_call_proxy_new_for_bus_finish (res, &err);
-  if (!proxy) {
-    phosh_async_error_warn (err, "Failed to get call proxy");
-    return;
-  }
-
-  self = PHOSH_CALLS_MANAGER (data);
   path = g_dbus_proxy_get_object_path (G_DBUS_PROXY (proxy));
   if (g_hash_table_contains (self->calls, path)) {
     g_warning ("Already got a call with path %s", path);
@@ -153,10 +143,11 @@ on_call_proxy_new_for_bus_finish (GObject *source_object, GAsyncResult *res, gpo
   g_hash_table_insert (self->calls, g_strdup (path), call);
   g_list_store_append (self->calls_store, call);
 
-  g_signal_connect_swapped (proxy,
-                            "notify::state",
-                            G_CALLBACK (on_call_state_changed),
-                            self);
+  g_signal_connect_object (proxy,
+                           "notify::state",
+                           G_CALLBACK (on_call_state_changed),
+                           self,
+                           G_CONNECT_SWAPPED);
   on_call_state_changed (self, NULL, proxy);
 
   inbound = phosh_dbus_calls_call_get_inbound (proxy);
@@ -170,6 +161,7 @@ static void
 on_call_obj_added (PhoshCallsManager *self, GDBusObject *object)
 {
   const char *path;
+  g_autoptr (PhoshDBusCallsCall) proxy = NULL;
 
   g_return_if_fail (PHOSH_IS_CALLS_MANAGER (self));
 
@@ -178,13 +170,15 @@ on_call_obj_added (PhoshCallsManager *self, GDBusObject *object)
   if (!g_str_has_prefix (path, OBJECT_PATHS_CALLS_PREFIX))
     return;
 
-  phosh_dbus_calls_call_proxy_new_for_bus (G_BUS_TYPE_SESSION,
-                                           G_DBUS_PROXY_FLAGS_NONE,
-                                           BUS_NAME,
-                                           path,
-                                           self->cancel,
-                                           on_call_proxy_new_for_bus_finish,
-                                           self);
+  /* The object manager already fetched the call's properties so use
+   * its proxy right away instead of creating (and waiting for) our own */
+  proxy = phosh_dbus_object_get_calls_call (PHOSH_DBUS_OBJECT (object));
+  if (proxy == NULL) {
+    g_warning ("Call obj at %s lacks call interface", path);
+    return;
+  }
+
+  add_call (self, proxy);
 }
 
 
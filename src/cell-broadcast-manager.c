@@ -20,11 +20,30 @@
 
 #define PHOSH_CELL_BROOADCAST_SCHEMA_ID "mobi.phosh.shell.cell-broadcast"
 
+/* Bump when changing the history format */
+#define CBM_HISTORY_VERSION 1
+/* Format version, channel, message code, update number and time received */
+#define CBM_HISTORY_TYPE "(ua(uuux))"
+#define CBM_HISTORY_FILENAME "cell-broadcasts.gvariant"
+/* Networks repeat alerts for hours, remember them for a day */
+#define CBM_HISTORY_MAX_AGE_S (24 * 60 * 60)
+#define CBM_HISTORY_MAX_ENTRIES 256
+
 /**
  * PhoshCellBroadcastManager:
  *
  * Handles the display of Cell Broadcast messages
  *
+ * Networks retransmit messages periodically and in every cell so the
+ * same message arrives many times. Messages are identified by their
+ * channel and message code, the update number tells updated messages
+ * from repetitions. Repetitions are dropped, updates replace the text
+ * of the message they update. The history is kept on disk so
+ * repetitions are also detected after a restart.
+ *
+ * A single prompt is used for all messages. Messages arriving while
+ * it's shown are queued.
+ *
  *  Since: 0.44.0
  */
 
@@ -35,15 +54,169 @@ enum {
 };
 static GParamSpec *props[PROP_LAST_PROP];
 
+typedef struct {
+  guint  update;
+  gint64 received;
+} PhoshCbmRecord;
+
+
+typedef struct {
+  guint  key;
+  char  *title;
+  char  *message;
+} PhoshCbm;
+
+
 struct _PhoshCellBroadcastManager {
-  GObject    parent;
+  GObject                   parent;
 
-  gboolean   enabled;
-  GSettings *settings;
+  gboolean                  enabled;
+  GSettings                *settings;
+
+  /* key: channel and message code, value: PhoshCbmRecord */
+  GHashTable               *history;
+  /* The shown message first */
+  GQueue                    queue;
+  PhoshCellBroadcastPrompt *prompt;
 };
 G_DEFINE_TYPE (PhoshCellBroadcastManager, phosh_cell_broadcast_manager, G_TYPE_OBJECT)
 
 
+static void
+phosh_cbm_free (PhoshCbm *cbm)
+{
+  g_free (cbm->title);
+  g_free (cbm->message);
+  g_free (cbm);
+}
+
+
+static guint
+get_key (guint channel, guint message_code)
+{
+  /* The message code has 10 bits, channels 16 */
+  return (channel << 10) | (message_code & 0x3ff);
+}
+
+
+static char *
+get_history_path (void)
+{
+  return g_build_filename (g_get_user_cache_dir (), "phosh", CBM_HISTORY_FILENAME, NULL);
+}
+
+
+static gboolean
+is_expired (PhoshCbmRecord *record, gint64 now)
+{
+  return now - record->received > CBM_HISTORY_MAX_AGE_S;
+}
+
+
+static void
+prune_history (PhoshCellBroadcastManager *self, gint64 now)
+{
+  GHashTableIter iter;
+  PhoshCbmRecord *record, *oldest;
+  gpointer key, oldest_key;
+
+  g_hash_table_iter_init (&iter, self->history);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&record)) {
+    if (is_expired (record, now))
+      g_hash_table_iter_remove (&iter);
+  }
+
+  while (g_hash_table_size (self->history) > CBM_HISTORY_MAX_ENTRIES) {
+    oldest = NULL;
+    oldest_key = NULL;
+
+    g_hash_table_iter_init (&iter, self->history);
+    while (g_hash_table_iter_next (&iter, &key, (gpointer *)&record)) {
+      if (oldest == NULL || record->received < oldest->received) {
+        oldest = record;
+        oldest_key = key;
+      }
+    }
+    g_hash_table_remove (self->history, oldest_key);
+  }
+}
+
+
+static void
+load_history (PhoshCellBroadcastManager *self)
+{
+  g_autoptr (GError) err = NULL;
+  g_autoptr (GVariant) history = NULL;
+  g_autoptr (GVariantIter) iter = NULL;
+  g_autoptr (GBytes) bytes = NULL;
+  g_autofree char *path = get_history_path ();
+  g_autofree char *contents = NULL;
+  guint32 version, channel, code, update;
+  gint64 received;
+  gsize len;
+
+  if (!g_file_get_contents (path, &contents, &len, &err)) {
+    if (!g_error_matches (err, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+      g_debug ("Failed to load cbm history: %s", err->message);
+    return;
+  }
+
+  bytes = g_bytes_new_take (g_steal_pointer (&contents), len);
+  history = g_variant_ref_sink (g_variant_new_from_bytes (G_VARIANT_TYPE (CBM_HISTORY_TYPE),
+                                                          bytes,
+                                                          FALSE));
+  g_variant_get (history, CBM_HISTORY_TYPE, &version, &iter);
+  if (version != CBM_HISTORY_VERSION) {
+    g_debug ("Ignoring cbm history version %u", version);
+    return;
+  }
+
+  while (g_variant_iter_next (iter, "(uuux)", &channel, &code, &update, &received)) {
+    PhoshCbmRecord *record = g_new0 (PhoshCbmRecord, 1);
+
+    record->update = update;
+    record->received = received;
+    g_hash_table_insert (self->history, GUINT_TO_POINTER (get_key (channel, code)), record);
+  }
+
+  prune_history (self, g_get_real_time () / G_USEC_PER_SEC);
+  g_debug ("Loaded %u cbms", g_hash_table_size (self->history));
+}
+
+
+static void
+save_history (PhoshCellBroadcastManager *self)
+{
+  g_autoptr (GError) err = NULL;
+  g_autoptr (GVariant) history = NULL;
+  g_autofree char *path = get_history_path ();
+  g_autofree char *dir = g_path_get_dirname (path);
+  GVariantBuilder builder;
+  GHashTableIter iter;
+  PhoshCbmRecord *record;
+  gpointer key;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(uuux)"));
+  g_hash_table_iter_init (&iter, self->history);
+  while (g_hash_table_iter_next (&iter, &key, (gpointer *)&record)) {
+    guint k = GPOINTER_TO_UINT (key);
+
+    g_variant_builder_add (&builder, "(uuux)", k >> 10, k & 0x3ff, record->update,
+                           record->received);
+  }
+
+  history = g_variant_ref_sink (g_variant_new (CBM_HISTORY_TYPE, CBM_HISTORY_VERSION, &builder));
+
+  g_mkdir_with_parents (dir, 0755);
+  if (!g_file_set_contents (path,
+                            g_variant_get_data (history),
+                            g_variant_get_size (history),
+                            &err)) {
+    g_warning ("Failed to save cbm history: %s", err->message);
+  }
+}
+
+
 static const char *
 id_to_title (guint id)
 {
@@ -62,20 +235,123 @@ id_to_title (guint id)
 
 
 static void
-on_new_cbm (PhoshCellBroadcastManager *self, const char *message, guint id)
+notify_user (void)
+{
+  phosh_trigger_feedback ("message-new-cellbroadcast");
+  phosh_shell_activate_action (phosh_shell_get_default (), "screensaver.wakeup-screen", NULL);
+}
+
+
+static void
+show_next (PhoshCellBroadcastManager *self)
+{
+  PhoshCbm *cbm = g_queue_peek_head (&self->queue);
+
+  if (cbm == NULL)
+    return;
+
+  phosh_system_modal_dialog_set_title (PHOSH_SYSTEM_MODAL_DIALOG (self->prompt), cbm->title);
+  phosh_cell_broadcast_prompt_set_message (self->prompt, cbm->message);
+  phosh_system_modal_dialog_present (PHOSH_SYSTEM_MODAL_DIALOG (self->prompt));
+  notify_user ();
+}
+
+
+static void
+on_prompt_closed (PhoshCellBroadcastManager *self)
+{
+  phosh_cbm_free (g_queue_pop_head (&self->queue));
+
+  if (g_queue_is_empty (&self->queue))
+    phosh_system_modal_dialog_close (PHOSH_SYSTEM_MODAL_DIALOG (self->prompt));
+  else
+    show_next (self);
+}
+
+
+static void
+ensure_prompt (PhoshCellBroadcastManager *self)
 {
   GtkWidget *prompt;
 
-  g_debug ("New cbm: %s", message);
+  if (self->prompt)
+    return;
+
+  g_debug ("Building cell broadcast prompt");
+  prompt = phosh_cell_broadcast_prompt_new ("", "");
+  self->prompt = PHOSH_CELL_BROADCAST_PROMPT (g_object_ref_sink (prompt));
+  phosh_system_modal_dialog_set_reusable (PHOSH_SYSTEM_MODAL_DIALOG (self->prompt), TRUE);
+  g_signal_connect_object (self->prompt, "closed",
+                           G_CALLBACK (on_prompt_closed),
+                           self,
+                           G_CONNECT_SWAPPED);
+}
+
+
+static int
+cmp_key (gconstpointer a, gconstpointer b)
+{
+  const PhoshCbm *cbm = a;
+
+  return cbm->key != GPOINTER_TO_UINT (b);
+}
+
+
+static void
+on_new_cbm (PhoshCellBroadcastManager *self,
+            const char                *message,
+            guint                      channel,
+            guint                      message_code,
+            guint                      update)
+{
+  gint64 now = g_get_real_time () / G_USEC_PER_SEC;
+  guint key = get_key (channel, message_code);
+  PhoshCbmRecord *record;
+  PhoshCbm *cbm;
+  GList *queued;
+
+  g_debug ("New cbm %u/%u/%u: %s", channel, message_code, update, message);
 
   if (!self->enabled)
     return;
 
-  prompt = phosh_cell_broadcast_prompt_new (message, id_to_title (id));
-  g_signal_connect (prompt, "closed", G_CALLBACK (gtk_widget_destroy), NULL);
-  gtk_widget_set_visible (prompt, TRUE);
-  phosh_trigger_feedback ("message-new-cellbroadcast");
-  phosh_shell_activate_action (phosh_shell_get_default (), "screensaver.wakeup-screen", NULL);
+  record = g_hash_table_lookup (self->history, GUINT_TO_POINTER (key));
+  if (record && record->update == update && !is_expired (record, now)) {
+    g_debug ("Dropping repeated cbm %u/%u/%u", channel, message_code, update);
+    return;
+  }
+
+  if (record == NULL) {
+    record = g_new0 (PhoshCbmRecord, 1);
+    g_hash_table_insert (self->history, GUINT_TO_POINTER (key), record);
+  }
+  record->update = update;
+  record->received = now;
+  prune_history (self, now);
+  save_history (self);
+
+  /* An update to a message that's not yet dismissed replaces its text */
+  queued = g_queue_find_custom (&self->queue, GUINT_TO_POINTER (key), cmp_key);
+  if (queued) {
+    cbm = queued->data;
+    g_free (cbm->message);
+    cbm->message = g_strdup (message);
+    if (queued == self->queue.head) {
+      phosh_cell_broadcast_prompt_set_message (self->prompt, message);
+      notify_user ();
+    }
+    return;
+  }
+
+  cbm = g_new0 (PhoshCbm, 1);
+  cbm->key = key;
+  cbm->title = g_strdup (id_to_title (channel));
+  cbm->message = g_strdup (message);
+  g_queue_push_tail (&self->queue, cbm);
+
+  ensure_prompt (self);
+  if (g_queue_get_length (&self->queue) == 1)
+    show_next (self);
 
   /* We rely on the Chat application to remove the CBM later on */
 }
@@ -124,6 +400,11 @@ phosh_cell_broadcast_manager_finalize (GObject *object)
 {
   PhoshCellBroadcastManager *self = PHOSH_CELL_BROADCAST_MANAGER (object);
 
+  g_queue_clear_full (&self->queue, (GDestroyNotify) phosh_cbm_free);
+  if (self->prompt)
+    gtk_widget_destroy (GTK_WIDGET (self->prompt));
+  g_clear_object (&self->prompt);
+  g_clear_pointer (&self->history, g_hash_table_destroy);
   g_clear_object (&self->settings);
 
   G_OBJECT_CLASS (phosh_cell_broadcast_manager_parent_class)->finalize (object);
@@ -159,6 +440,10 @@ phosh_cell_broadcast_manager_init (PhoshCellBroadcastManager *self)
   PhoshShell *shell = phosh_shell_get_default ();
   PhoshWWan *wwan = phosh_shell_get_wwan (shell);
 
+  g_queue_init (&self->queue);
+  self->history = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, g_free);
+  load_history (self);
+
   self->settings = g_settings_new (PHOSH_CELL_BROOADCAST_SCHEMA_ID);
   g_settings_bind (self->settings, "enabled", self, "enabled", G_SETTINGS_BIND_GET);
 
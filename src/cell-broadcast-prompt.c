@@ -24,6 +24,9 @@
  *
  * Since it's about emergencies it can be shown above the
  * lock screen.
+ *
+ * The message can be changed while the prompt is shown so repeated
+ * or updated messages can reuse it.
  */
 
 enum {
@@ -144,7 +147,7 @@ phosh_cell_broadcast_prompt_class_init (PhoshCellBroadcastPromptClass *klass)
   props[PROP_MESSAGE] =
     g_param_spec_string ("message", "", "",
                          "",
-                         G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_CONSTRUCT_ONLY);
+                         G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
 
   g_object_class_install_properties (object_class, PROP_LAST_PROP, props);
 
@@ -177,3 +180,12 @@ phosh_cell_broadcast_prompt_new (const char *message, const char *title)
                        "title", title,
                        NULL);
 }
+
+
+void
+phosh_cell_broadcast_prompt_set_message (PhoshCellBroadcastPrompt *self, const char *message)
+{
+  g_return_if_fail (PHOSH_IS_CELL_BROADCAST_PROMPT (self));
+
+  set_message (self, message);
+}
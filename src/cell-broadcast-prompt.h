@@ -15,3 +15,5 @@ G_DECLARE_FINAL_TYPE (PhoshCellBroadcastPrompt, phosh_cell_broadcast_prompt, PHO
                       CELL_BROADCAST_PROMPT, PhoshSystemModalDialog)
 
 GtkWidget        *phosh_cell_broadcast_prompt_new (const char *message, const char *title);
+void              phosh_cell_broadcast_prompt_set_message (PhoshCellBroadcastPrompt *self,
+                                                           const char               *message);
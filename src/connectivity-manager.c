@@ -11,6 +11,7 @@
 #include "config.h"
 
 #include "connectivity-manager.h"
+#include "nm-client.h"
 #include "notify-manager.h"
 #include "shell-priv.h"
 #include "util.h"
@@ -219,7 +220,7 @@ on_nm_client_ready (GObject *obj, GAsyncResult *res, gpointer user_data)
   g_autoptr (GError) err = NULL;
   NMClient *nmclient;
 
-  nmclient = nm_client_new_finish (res, &err);
+  nmclient = phosh_nm_client_get_finish (res, &err);
   if (!nmclient) {
     phosh_async_error_warn (err, "Failed to init NM");
     return;
@@ -242,7 +243,7 @@ phosh_connectivity_manager_idle_init (PhoshManager *manager)
 {
   PhoshConnectivityManager *self = PHOSH_CONNECTIVITY_MANAGER (manager);
 
-  nm_client_new_async (self->cancel, on_nm_client_ready, self);
+  phosh_nm_client_get_async (self->cancel, on_nm_client_ready, self);
 }
 
 
@@ -51,9 +51,23 @@ typedef struct {
   GVariantBuilder                   builder_vpn;
 } ShellAgentRequest;
 
+/* How long secrets fetched from the keyring are reused */
+#define SHELL_SECRETS_CACHE_TIMEOUT_US (60 * G_USEC_PER_SEC)
+
+typedef struct {
+  GVariant                         *setting;
+  gint64                            expires;
+} ShellSecretsCacheEntry;
+
 struct _ShellNetworkAgentPrivate {
   /* <char *request_id, ShellAgentRequest *request> */
   GHashTable *requests;
+  /* <char *uuid/setting_name, ShellSecretsCacheEntry *entry> */
+  GHashTable *secrets_cache;
+  /* <char *service, NMVpnPluginInfo *info> */
+  GHashTable *vpn_plugins;
+  /* <char *dir, GFileMonitor *monitor> */
+  GHashTable *vpn_plugin_monitors;
 };
 
 G_DEFINE_TYPE_WITH_PRIVATE (ShellNetworkAgent, shell_network_agent, NM_TYPE_SECRET_AGENT_OLD)
@@ -69,6 +83,73 @@ static const SecretSchema network_agent_schema = {
                   }
 };
 
+static void
+shell_secrets_cache_entry_free (gpointer data)
+{
+  ShellSecretsCacheEntry *entry = data;
+
+  g_variant_unref (entry->setting);
+  g_free (entry);
+}
+
+static char *
+secrets_cache_key (NMConnection *connection, const char *setting_name)
+{
+  return g_strdup_printf ("%s/%s", nm_connection_get_uuid (connection), setting_name);
+}
+
+static GVariant *
+secrets_cache_lookup (ShellNetworkAgent *self,
+                      NMConnection      *connection,
+                      const char        *setting_name)
+{
+  ShellSecretsCacheEntry *entry;
+  g_autofree char *key = secrets_cache_key (connection, setting_name);
+
+  entry = g_hash_table_lookup (self->priv->secrets_cache, key);
+  if (entry == NULL)
+    return NULL;
+
+  if (g_get_monotonic_time () > entry->expires)
+    {
+      g_hash_table_remove (self->priv->secrets_cache, key);
+      return NULL;
+    }
+
+  return g_variant_ref (entry->setting);
+}
+
+static void
+secrets_cache_insert (ShellNetworkAgent *self,
+                      NMConnection      *connection,
+                      const char        *setting_name,
+                      GVariant          *setting)
+{
+  ShellSecretsCacheEntry *entry = g_new0 (ShellSecretsCacheEntry, 1);
+
+  entry->setting = g_variant_ref_sink (setting);
+  entry->expires = g_get_monotonic_time () + SHELL_SECRETS_CACHE_TIMEOUT_US;
+
+  g_hash_table_replace (self->priv->secrets_cache,
+                        secrets_cache_key (connection, setting_name),
+                        entry);
+}
+
+static void
+secrets_cache_remove_uuid (ShellNetworkAgent *self, const char *uuid)
+{
+  GHashTableIter iter;
+  const char *key;
+  gsize len = strlen (uuid);
+
+  g_hash_table_iter_init (&iter, self->priv->secrets_cache);
+  while (g_hash_table_iter_next (&iter, (gpointer *)&key, NULL))
+    {
+      if (strncmp (key, uuid, len) == 0 && key[len] == '/')
+        g_hash_table_iter_remove (&iter);
+    }
+}
+
 static void
 shell_agent_request_free (gpointer data)
 {
@@ -114,6 +195,12 @@ shell_network_agent_init (ShellNetworkAgent *agent)
   priv = agent->priv = shell_network_agent_get_instance_private (agent);
   priv->requests = g_hash_table_new_full (g_str_hash, g_str_equal,
 					  g_free, shell_agent_request_free);
+  priv->secrets_cache = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                               g_free, shell_secrets_cache_entry_free);
+  priv->vpn_plugins = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                             g_free, g_object_unref);
+  priv->vpn_plugin_monitors = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                     g_free, g_object_unref);
 }
 
 static void
@@ -141,6 +228,9 @@ shell_network_agent_finalize (GObject *object)
     }
 
   g_hash_table_destroy (priv->requests);
+  g_hash_table_destroy (priv->secrets_cache);
+  g_hash_table_destroy (priv->vpn_plugins);
+  g_hash_table_destroy (priv->vpn_plugin_monitors);
   g_error_free (error);
 
   G_OBJECT_CLASS (shell_network_agent_parent_class)->finalize (object);
@@ -231,6 +321,8 @@ is_connection_always_ask (NMConnection *connection)
   return FALSE;
 }
 
+static void reply_secrets (ShellAgentRequest *closure, GVariant *setting, gboolean secrets_found);
+
 static void
 get_secrets_keyring_cb (GObject            *source,
                         GAsyncResult       *result,
@@ -244,7 +336,7 @@ get_secrets_keyring_cb (GObject            *source,
   GList *items;
   GList *l;
   gboolean secrets_found = FALSE;
-  GVariantBuilder builder_setting, builder_connection;
+  GVariantBuilder builder_setting;
   GVariant *setting;
 
   items = secret_service_search_finish (NULL, result, &secret_error);
@@ -307,6 +399,23 @@ get_secrets_keyring_cb (GObject            *source,
   g_list_free_full (items, g_object_unref);
   setting = g_variant_builder_end (&builder_setting);
 
+  /* Let reconnects skip the keyring round trip */
+  if (secrets_found)
+    secrets_cache_insert (self, closure->connection, closure->setting_name, setting);
+
+  reply_secrets (closure, setting, secrets_found);
+  return;
+
+ out:
+  g_hash_table_remove (priv->requests, closure->request_id);
+  g_clear_error (&error);
+}
+
+static void
+reply_secrets (ShellAgentRequest *closure, GVariant *setting, gboolean secrets_found)
+{
+  GVariantBuilder builder_connection;
+
   /* All VPN requests get sent to the VPN's auth dialog, since it knows better
    * than the agent about what secrets are required.  Otherwise, if no secrets
    * were found and interaction is allowed the ask for some secrets, because
@@ -332,9 +441,7 @@ get_secrets_keyring_cb (GObject            *source,
                      g_variant_builder_end (&builder_connection), NULL,
                      closure->callback_data);
 
- out:
-  g_hash_table_remove (priv->requests, closure->request_id);
-  g_clear_error (&error);
+  g_hash_table_remove (closure->self->priv->requests, closure->request_id);
 }
 
 static void
@@ -350,6 +457,7 @@ shell_network_agent_get_secrets (NMSecretAgentOld                 *agent,
   ShellNetworkAgent *self = SHELL_NETWORK_AGENT (agent);
   ShellAgentRequest *request;
   GHashTable *attributes;
+  GVariant *setting;
   char *request_id;
 
   request_id = g_strdup_printf ("%s/%s", connection_path, setting_name);
@@ -386,6 +494,15 @@ shell_network_agent_get_secrets (NMSecretAgentOld                 *agent,
       return;
     }
 
+  setting = secrets_cache_lookup (self, connection, setting_name);
+  if (setting)
+    {
+      g_debug ("Using cached secrets for %s/%s", nm_connection_get_uuid (connection), setting_name);
+      reply_secrets (request, setting, TRUE);
+      g_variant_unref (setting);
+      return;
+    }
+
   attributes = secret_attributes_build (&network_agent_schema,
                                         SHELL_KEYRING_UUID_TAG, nm_connection_get_uuid (connection),
                                         SHELL_KEYRING_SN_TAG, setting_name,
@@ -530,6 +647,73 @@ search_vpn_plugin (GTask        *task,
     }
 }
 
+static void
+on_vpn_plugin_dir_changed (ShellNetworkAgent *self)
+{
+  /* Plugins got added, removed or updated */
+  g_hash_table_remove_all (self->priv->vpn_plugins);
+}
+
+static void
+watch_vpn_plugin_dir (ShellNetworkAgent *self, NMVpnPluginInfo *info)
+{
+  ShellNetworkAgentPrivate *priv = self->priv;
+  g_autoptr(GFile) file = NULL;
+  g_autoptr(GError) error = NULL;
+  GFileMonitor *monitor;
+  char *dir;
+
+  if (nm_vpn_plugin_info_get_filename (info) == NULL)
+    return;
+
+  dir = g_path_get_dirname (nm_vpn_plugin_info_get_filename (info));
+  if (g_hash_table_contains (priv->vpn_plugin_monitors, dir))
+    {
+      g_free (dir);
+      return;
+    }
+
+  file = g_file_new_for_path (dir);
+  monitor = g_file_monitor_directory (file, G_FILE_MONITOR_NONE, NULL, &error);
+  if (monitor == NULL)
+    {
+      g_warning ("Failed to monitor %s: %s", dir, error->message);
+      g_free (dir);
+      return;
+    }
+
+  g_signal_connect_object (monitor, "changed",
+                           G_CALLBACK (on_vpn_plugin_dir_changed), self,
+                           G_CONNECT_SWAPPED);
+  g_hash_table_insert (priv->vpn_plugin_monitors, dir, monitor);
+}
+
+static void
+on_vpn_plugin_searched (GObject      *source_object,
+                        GAsyncResult *result,
+                        gpointer      user_data)
+{
+  ShellNetworkAgent *self = SHELL_NETWORK_AGENT (source_object);
+  g_autoptr(GTask) task = user_data;
+  g_autoptr(GError) error = NULL;
+  NMVpnPluginInfo *info;
+
+  info = g_task_propagate_pointer (G_TASK (result), &error);
+  if (info == NULL)
+    {
+      g_task_return_error (task, g_steal_pointer (&error));
+      return;
+    }
+
+  /* Only found plugins are cached so newly installed ones get picked up */
+  watch_vpn_plugin_dir (self, info);
+  g_hash_table_replace (self->priv->vpn_plugins,
+                        g_strdup (g_task_get_task_data (task)),
+                        g_object_ref (info));
+
+  g_task_return_pointer (task, info, g_object_unref);
+}
+
 void
 shell_network_agent_search_vpn_plugin (ShellNetworkAgent   *self,
                                        const char          *service,
@@ -537,6 +721,8 @@ shell_network_agent_search_vpn_plugin (ShellNetworkAgent   *self,
                                        gpointer             user_data)
 {
   g_autoptr(GTask) task = NULL;
+  GTask *search_task;
+  NMVpnPluginInfo *info;
 
   g_return_if_fail (SHELL_IS_NETWORK_AGENT (self));
   g_return_if_fail (service != NULL);
@@ -545,7 +731,18 @@ shell_network_agent_search_vpn_plugin (ShellNetworkAgent   *self,
   g_task_set_source_tag (task, shell_network_agent_search_vpn_plugin);
   g_task_set_task_data (task, g_strdup (service), g_free);
 
-  g_task_run_in_thread (task, search_vpn_plugin);
+  info = g_hash_table_lookup (self->priv->vpn_plugins, service);
+  if (info)
+    {
+      g_task_return_pointer (task, g_object_ref (info), g_object_unref);
+      return;
+    }
+
+  /* Scanning the plugin dirs hits the filesystem so do it in a thread */
+  search_task = g_task_new (self, NULL, on_vpn_plugin_searched, g_steal_pointer (&task));
+  g_task_set_task_data (search_task, g_strdup (service), g_free);
+  g_task_run_in_thread (search_task, search_vpn_plugin);
+  g_object_unref (search_task);
 }
 
 /**
@@ -589,6 +786,21 @@ shell_network_agent_cancel_get_secrets (NMSecretAgentOld *agent,
   shell_agent_request_cancel (request);
 }
 
+/**
+ * shell_network_agent_clear_secrets_cache:
+ * @self: The network agent
+ *
+ * Drops all secrets kept in memory so that the next request needs to
+ * go to the keyring again. Use this e.g. when the session gets locked.
+ */
+void
+shell_network_agent_clear_secrets_cache (ShellNetworkAgent *self)
+{
+  g_return_if_fail (SHELL_IS_NETWORK_AGENT (self));
+
+  g_hash_table_remove_all (self->priv->secrets_cache);
+}
+
 /************************* saving of secrets ****************************************/
 
 static GHashTable *
@@ -853,6 +1065,8 @@ shell_network_agent_delete_secrets (NMSecretAgentOld                  *agent,
   uuid = nm_setting_connection_get_uuid (s_con);
   g_assert (uuid);
 
+  secrets_cache_remove_uuid (SHELL_NETWORK_AGENT (agent), uuid);
+
   secret_password_clear (&network_agent_schema, NULL, delete_items_cb, r,
                          SHELL_KEYRING_UUID_TAG, uuid,
                          NULL);
@@ -66,6 +66,7 @@ void               shell_network_agent_search_vpn_plugin (ShellNetworkAgent   *s
 NMVpnPluginInfo   *shell_network_agent_search_vpn_plugin_finish (ShellNetworkAgent  *self,
                                                                  GAsyncResult       *result,
                                                                  GError            **error);
+void               shell_network_agent_clear_secrets_cache (ShellNetworkAgent *self);
 
 /* If these are kept in sync with nm-applet, secrets will be shared */
 #define SHELL_KEYRING_UUID_TAG "connection-uuid"
@@ -11,8 +11,15 @@
 #include "phosh-config.h"
 
 #include "debug-control.h"
+#include "frame-stats.h"
+#include "launch-stats.h"
+#include "memory-stats.h"
 #include "phosh-enums.h"
+#include "plugin-loader.h"
 #include "shell-priv.h"
+#include "source-stats.h"
+#include "startup-timeline.h"
+#include "trace-buffer.h"
 
 #include <gio/gio.h>
 
@@ -46,9 +53,170 @@ G_DEFINE_TYPE_WITH_CODE (PhoshDebugControl, phosh_debug_control,
                          G_IMPLEMENT_INTERFACE (PHOSH_DBUS_TYPE_DEBUG_CONTROL,
                                                 phosh_dbus_debug_control_iface_init))
 
+static gboolean
+handle_get_startup_timeline (PhoshDBusDebugControl *object,
+                             GDBusMethodInvocation *invocation)
+{
+  g_autofree char *timeline = phosh_startup_timeline_to_json ();
+
+  phosh_dbus_debug_control_complete_get_startup_timeline (object, invocation, timeline);
+
+  return TRUE;
+}
+
+
+static gboolean
+handle_get_plugin_stats (PhoshDBusDebugControl *object,
+                         GDBusMethodInvocation *invocation)
+{
+  phosh_dbus_debug_control_complete_get_plugin_stats (object,
+                                                      invocation,
+                                                      phosh_plugin_loader_get_stats ());
+
+  return TRUE;
+}
+
+
+static gboolean
+handle_get_source_stats (PhoshDBusDebugControl *object,
+                         GDBusMethodInvocation *invocation)
+{
+  GVariant *stats;
+  guint64 wakeups;
+
+  stats = phosh_source_stats_get (&wakeups);
+  phosh_dbus_debug_control_complete_get_source_stats (object, invocation, wakeups, stats);
+
+  return TRUE;
+}
+
+
+static gboolean
+handle_reset_source_stats (PhoshDBusDebugControl *object,
+                           GDBusMethodInvocation *invocation)
+{
+  phosh_source_stats_reset ();
+  phosh_dbus_debug_control_complete_reset_source_stats (object, invocation);
+
+  return TRUE;
+}
+
+
+static gboolean
+handle_get_frame_stats (PhoshDBusDebugControl *object,
+                        GDBusMethodInvocation *invocation)
+{
+  phosh_dbus_debug_control_complete_get_frame_stats (object, invocation, phosh_frame_stats_get ());
+
+  return TRUE;
+}
+
+
+static gboolean
+handle_reset_frame_stats (PhoshDBusDebugControl *object,
+                          GDBusMethodInvocation *invocation)
+{
+  phosh_frame_stats_reset ();
+  phosh_dbus_debug_control_complete_reset_frame_stats (object, invocation);
+
+  return TRUE;
+}
+
+
+static gboolean
+handle_get_launch_stats (PhoshDBusDebugControl *object,
+                         GDBusMethodInvocation *invocation)
+{
+  phosh_dbus_debug_control_complete_get_launch_stats (object, invocation, phosh_launch_stats_get ());
+
+  return TRUE;
+}
+
+
+static gboolean
+handle_reset_launch_stats (PhoshDBusDebugControl *object,
+                           GDBusMethodInvocation *invocation)
+{
+  phosh_launch_stats_reset ();
+  phosh_dbus_debug_control_complete_reset_launch_stats (object, invocation);
+
+  return TRUE;
+}
+
+
+static gboolean
+handle_get_memory_stats (PhoshDBusDebugControl *object,
+                         GDBusMethodInvocation *invocation)
+{
+  phosh_dbus_debug_control_complete_get_memory_stats (object, invocation, phosh_memory_stats_get ());
+
+  return TRUE;
+}
+
+
+static gboolean
+handle_get_trace (PhoshDBusDebugControl *object,
+                  GDBusMethodInvocation *invocation)
+{
+  g_autofree char *trace = phosh_trace_buffer_to_json ();
+
+  phosh_dbus_debug_control_complete_get_trace (object, invocation, trace);
+
+  return TRUE;
+}
+
+
+static gboolean
+handle_clear_trace (PhoshDBusDebugControl *object,
+                    GDBusMethodInvocation *invocation)
+{
+  phosh_trace_buffer_clear ();
+  phosh_dbus_debug_control_complete_clear_trace (object, invocation);
+
+  return TRUE;
+}
+
+
 static void
 phosh_dbus_debug_control_iface_init (PhoshDBusDebugControlIface *iface)
 {
+  iface->handle_get_startup_timeline = handle_get_startup_timeline;
+  iface->handle_get_plugin_stats = handle_get_plugin_stats;
+  iface->handle_get_source_stats = handle_get_source_stats;
+  iface->handle_reset_source_stats = handle_reset_source_stats;
+  iface->handle_get_frame_stats = handle_get_frame_stats;
+  iface->handle_reset_frame_stats = handle_reset_frame_stats;
+  iface->handle_get_launch_stats = handle_get_launch_stats;
+  iface->handle_reset_launch_stats = handle_reset_launch_stats;
+  iface->handle_get_memory_stats = handle_get_memory_stats;
+  iface->handle_get_trace = handle_get_trace;
+  iface->handle_clear_trace = handle_clear_trace;
+}
+
+
+static void
+on_source_stats_changed (PhoshDebugControl *self)
+{
+  phosh_source_stats_set_enabled (
+    phosh_dbus_debug_control_get_source_stats (PHOSH_DBUS_DEBUG_CONTROL (self)));
+}
+
+
+static void
+on_frame_stats_changed (PhoshDebugControl *self)
+{
+  phosh_frame_stats_set_enabled (
+    phosh_dbus_debug_control_get_frame_stats (PHOSH_DBUS_DEBUG_CONTROL (self)));
+}
+
+
+static void
+on_trace_categories_changed (PhoshDebugControl *self)
+{
+  const char *const *names;
+
+  names = phosh_dbus_debug_control_get_trace_categories (PHOSH_DBUS_DEBUG_CONTROL (self));
+  phosh_trace_buffer_set_categories (phosh_trace_buffer_categories_from_strv (names));
 }
 
 
@@ -145,11 +313,27 @@ phosh_debug_control_class_init (PhoshDebugControlClass *klass)
 static void
 phosh_debug_control_init (PhoshDebugControl *self)
 {
+  g_auto (GStrv) categories = NULL;
+
   g_object_bind_property (phosh_shell_get_default (),
                           "log-domains",
                           self,
                           "log-domains",
                           G_BINDING_SYNC_CREATE | G_BINDING_BIDIRECTIONAL);
+
+  phosh_dbus_debug_control_set_source_stats (PHOSH_DBUS_DEBUG_CONTROL (self),
+                                             phosh_source_stats_get_enabled ());
+  g_signal_connect (self, "notify::source-stats", G_CALLBACK (on_source_stats_changed), NULL);
+
+  phosh_dbus_debug_control_set_frame_stats (PHOSH_DBUS_DEBUG_CONTROL (self),
+                                            phosh_frame_stats_get_enabled ());
+  g_signal_connect (self, "notify::frame-stats", G_CALLBACK (on_frame_stats_changed), NULL);
+
+  categories = phosh_trace_buffer_categories_to_strv (phosh_trace_buffer_get_categories ());
+  phosh_dbus_debug_control_set_trace_categories (PHOSH_DBUS_DEBUG_CONTROL (self),
+                                                 (const char *const *)categories);
+  g_signal_connect (self, "notify::trace-categories",
+                    G_CALLBACK (on_trace_categories_changed), NULL);
 }
 
 
@@ -14,6 +14,8 @@
 #include "mode-manager.h"
 #include "shell-priv.h"
 
+#include <gtk/gtk.h>
+
 #define DOCKED_DISABLED_ICON "phone-undocked-symbolic"
 #define DOCKED_ENABLED_ICON  "phone-docked-symbolic"
 
@@ -30,6 +32,10 @@
  * #PhoshDockedManager allows to dock the phone to additional hardware
  * and performs the necessary configuration changes
  * (disable OSK, don't maximize windows by default, ...)
+ *
+ * As many parts of the shell react to these changes on their own
+ * the shell's windows don't get updated while switching modes. They're
+ * updated in one go once all the reactions ran.
  */
 
 enum {
@@ -56,6 +62,10 @@ struct _PhoshDockedManager {
   GSettings        *a11y_settings;
   GSettings        *gtk_settings;
   GSettings        *gtk4_settings;
+
+  /* The windows frozen during a mode transition */
+  GPtrArray        *frozen_windows;
+  guint             transition_id;
 };
 G_DEFINE_TYPE (PhoshDockedManager, phosh_docked_manager, G_TYPE_OBJECT);
 
@@ -109,6 +119,54 @@ phosh_docked_manager_set_property (GObject      *object,
 }
 
 
+static void
+thaw_window (GdkWindow *window)
+{
+  if (!gdk_window_is_destroyed (window))
+    gdk_window_thaw_updates (window);
+  g_object_unref (window);
+}
+
+
+static gboolean
+on_transition_done (gpointer data)
+{
+  PhoshDockedManager *self = PHOSH_DOCKED_MANAGER (data);
+
+  g_debug ("Mode transition done, updating %u windows", self->frozen_windows->len);
+  g_ptr_array_set_size (self->frozen_windows, 0);
+  self->transition_id = 0;
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static void
+begin_transition (PhoshDockedManager *self)
+{
+  g_autoptr (GList) toplevels = NULL;
+
+  /* Already in a transition, the pending thaw covers this one too */
+  if (self->transition_id)
+    return;
+
+  toplevels = gtk_window_list_toplevels ();
+  for (GList *l = toplevels; l; l = l->next) {
+    GdkWindow *window = gtk_widget_get_window (GTK_WIDGET (l->data));
+
+    if (window == NULL || !gtk_widget_get_mapped (GTK_WIDGET (l->data)))
+      continue;
+
+    gdk_window_freeze_updates (window);
+    g_ptr_array_add (self->frozen_windows, g_object_ref (window));
+  }
+
+  /* Let the reactions to the mode change (settings, layout, …) run first */
+  self->transition_id = g_idle_add_full (G_PRIORITY_LOW, on_transition_done, self, NULL);
+  g_source_set_name_by_id (self->transition_id, "[phosh] docked mode transition");
+}
+
+
 static void
 mode_changed_cb (PhoshDockedManager *self, GParamSpec *pspec, PhoshModeManager *manager)
 {
@@ -185,6 +243,9 @@ phosh_docked_manager_dispose (GObject *object)
   g_clear_object (&self->gtk4_settings);
   g_clear_object (&self->mode_manager);
 
+  g_clear_handle_id (&self->transition_id, g_source_remove);
+  g_clear_pointer (&self->frozen_windows, g_ptr_array_unref);
+
   G_OBJECT_CLASS (phosh_docked_manager_parent_class)->dispose (object);
 }
 
@@ -241,6 +302,7 @@ phosh_docked_manager_init (PhoshDockedManager *self)
   self->icon_name = DOCKED_DISABLED_ICON;
   self->can_dock = -1;
   self->enabled = -1;
+  self->frozen_windows = g_ptr_array_new_with_free_func ((GDestroyNotify) thaw_window);
 }
 
 
@@ -291,6 +353,7 @@ phosh_docked_manager_set_enabled (PhoshDockedManager *self, gboolean enable)
   if (self->enabled == enable)
     return;
 
+  begin_transition (self);
   g_object_freeze_notify (G_OBJECT (self));
 
   self->enabled = enable;
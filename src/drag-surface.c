@@ -158,6 +158,8 @@ drag_surface_handle_drag_end (void                                    *data,
   priv->drag_state = state;
   g_debug ("DragSurface %p: state, %d", self, priv->drag_state);
   g_object_notify_by_pspec (G_OBJECT (self), props[PROP_DRAG_STATE]);
+
+  phosh_layer_surface_log_input_latency (PHOSH_LAYER_SURFACE (self));
 }
 
 
@@ -173,6 +175,7 @@ drag_surface_handle_dragged (void                                    *data,
 
   priv = phosh_drag_surface_get_instance_private (self);
 
+  phosh_layer_surface_mark_input (PHOSH_LAYER_SURFACE (self));
   g_signal_emit (self, signals[SIGNAL_DRAGGED], 0, margin);
 
   if (priv->drag_state == PHOSH_DRAG_SURFACE_STATE_DRAGGED)
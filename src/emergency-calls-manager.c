@@ -39,6 +39,9 @@
  * If you are calling an emergency contact it is advised
  * that you use `phosh_emergency_calls_call` or `phosh_emergency_calls_row_call` instead of
  * calling `phosh_emergency_calls_manager_call` directly.
+ *
+ * While the session is locked the [type@EmergencyMenu] is built ahead
+ * of time so it shows up instantly when requested.
  */
 
 enum {
@@ -63,12 +66,95 @@ struct _PhoshEmergencyCallsManager {
   GListStore          *emergency_contacts;
 
   PhoshEmergencyMenu  *dialog;
+  gboolean             dialog_shown;
+  guint                prebuild_id;
   GSettings           *settings;
   gboolean             enabled;
 };
 G_DEFINE_TYPE (PhoshEmergencyCallsManager, phosh_emergency_calls_manager, PHOSH_TYPE_MANAGER);
 
 
+static void
+close_menu (PhoshEmergencyCallsManager *self)
+{
+  g_debug ("Closing emergency call menu");
+
+  self->dialog_shown = FALSE;
+  if (self->dialog)
+    phosh_system_modal_dialog_close (PHOSH_SYSTEM_MODAL_DIALOG (self->dialog));
+}
+
+
+static void
+drop_menu (PhoshEmergencyCallsManager *self)
+{
+  g_clear_handle_id (&self->prebuild_id, g_source_remove);
+
+  if (self->dialog_shown || self->dialog == NULL)
+    return;
+
+  g_debug ("Dropping emergency call menu");
+  gtk_widget_destroy (GTK_WIDGET (self->dialog));
+  g_clear_object (&self->dialog);
+}
+
+
+static void
+on_emergency_menu_done (PhoshEmergencyCallsManager *self)
+{
+  g_return_if_fail (PHOSH_IS_EMERGENCY_CALLS_MANAGER (self));
+
+  close_menu (self);
+}
+
+
+static void
+ensure_menu (PhoshEmergencyCallsManager *self)
+{
+  if (self->dialog)
+    return;
+
+  g_debug ("Building emergency call menu");
+  self->dialog = g_object_ref_sink (phosh_emergency_menu_new ());
+  phosh_system_modal_dialog_set_reusable (PHOSH_SYSTEM_MODAL_DIALOG (self->dialog), TRUE);
+  g_signal_connect_object (self->dialog, "done",
+                           G_CALLBACK (on_emergency_menu_done),
+                           self,
+                           G_CONNECT_SWAPPED);
+}
+
+
+static gboolean
+on_prebuild_idle (gpointer data)
+{
+  PhoshEmergencyCallsManager *self = PHOSH_EMERGENCY_CALLS_MANAGER (data);
+
+  self->prebuild_id = 0;
+
+  if (self->enabled == TRUE && phosh_shell_get_locked (phosh_shell_get_default ()))
+    ensure_menu (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static void
+on_shell_locked_changed (PhoshEmergencyCallsManager *self, GParamSpec *pspec, PhoshShell *shell)
+{
+  if (!phosh_shell_get_locked (shell)) {
+    drop_menu (self);
+    return;
+  }
+
+  if (self->enabled != TRUE || self->dialog || self->prebuild_id)
+    return;
+
+  /* Build the menu once the lock screen is up so opening it is instant */
+  self->prebuild_id = g_idle_add_full (G_PRIORITY_LOW, on_prebuild_idle, self, NULL);
+  g_source_set_name_by_id (self->prebuild_id, "[phosh] prebuild emergency menu");
+}
+
+
 static void
 phosh_emergency_calls_manager_set_if_enabled (PhoshEmergencyCallsManager *self, gboolean enabled)
 {
@@ -88,24 +174,11 @@ phosh_emergency_calls_manager_set_if_enabled (PhoshEmergencyCallsManager *self,
   action = g_action_map_lookup_action (G_ACTION_MAP (phosh_shell_get_default ()),
                                        "emergency.toggle-menu");
   g_simple_action_set_enabled (G_SIMPLE_ACTION (action), enabled);
-}
 
-
-static void
-close_menu (PhoshEmergencyCallsManager *self)
-{
-  g_debug ("Closing emergency call menu");
-
-  g_clear_pointer ((PhoshSystemModalDialog**)&self->dialog, phosh_system_modal_dialog_close);
-}
-
-
-static void
-on_emergency_menu_done (PhoshEmergencyCallsManager *self)
-{
-  g_return_if_fail (PHOSH_IS_EMERGENCY_CALLS_MANAGER (self));
-
-  close_menu (self);
+  if (enabled)
+    on_shell_locked_changed (self, NULL, phosh_shell_get_default ());
+  else
+    drop_menu (self);
 }
 
 
@@ -114,16 +187,14 @@ on_emergency_menu_activated (GSimpleAction *action, GVariant *param, gpointer da
 {
   PhoshEmergencyCallsManager *self = PHOSH_EMERGENCY_CALLS_MANAGER (data);
 
-  if (self->dialog) {
+  if (self->dialog_shown) {
     close_menu (self);
     return;
   }
 
-  self->dialog = phosh_emergency_menu_new ();
-  g_signal_connect_swapped (self->dialog, "done",
-                            G_CALLBACK (on_emergency_menu_done), self);
-
-  gtk_widget_set_visible (GTK_WIDGET (self->dialog), TRUE);
+  ensure_menu (self);
+  self->dialog_shown = TRUE;
+  phosh_system_modal_dialog_present (PHOSH_SYSTEM_MODAL_DIALOG (self->dialog));
 }
 
 
@@ -319,6 +390,12 @@ phosh_emergency_calls_manager_idle_init (PhoshManager *manager)
 {
   PhoshEmergencyCallsManager *self = PHOSH_EMERGENCY_CALLS_MANAGER (manager);
 
+  g_signal_connect_object (phosh_shell_get_default (),
+                           "notify::locked",
+                           G_CALLBACK (on_shell_locked_changed),
+                           self,
+                           G_CONNECT_SWAPPED);
+
   /* Connect to call's emergency call DBus interface */
   phosh_dbus_emergency_calls_proxy_new_for_bus (G_BUS_TYPE_SESSION,
                                                 G_DBUS_PROXY_FLAGS_NONE,
@@ -338,6 +415,9 @@ emergency_calls_manager_dispose (GObject *object)
   g_action_map_remove_action (G_ACTION_MAP (phosh_shell_get_default ()),
                               "emergency.toggle-menu");
 
+  self->dialog_shown = FALSE;
+  drop_menu (self);
+
   g_cancellable_cancel (self->cancel);
   g_clear_object (&self->cancel);
   g_clear_object (&self->dbus_proxy);
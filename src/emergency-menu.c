@@ -10,6 +10,7 @@
 
 #include "phosh-config.h"
 
+#include "animation.h"
 #include "emergency-menu.h"
 #include "emergency-calls-manager.h"
 #include "emergency-contact-row.h"
@@ -76,7 +77,8 @@ on_go_back_activated (GSimpleAction *action, GVariant *param, gpointer data)
   if (close) {
     g_signal_emit (self, signals[DONE], 0);
   } else {
-    hdy_carousel_scroll_to (self->emergency_carousel, GTK_WIDGET (self->emergency_dialpad_box));
+    phosh_animation_carousel_scroll_to (self->emergency_carousel,
+                                        GTK_WIDGET (self->emergency_dialpad_box));
   }
 }
 
@@ -165,10 +167,11 @@ emergency_menu_constructed (GObject *object)
   on_n_items_changed (self, NULL, emergency_contacts_list);
 
   gtk_label_set_label (self->emergency_owner_name, g_get_real_name ());
-  g_signal_connect_swapped (self->manager,
-                            "dial-error",
-                            G_CALLBACK (on_dial_error),
-                            self);
+  g_signal_connect_object (self->manager,
+                           "dial-error",
+                           G_CALLBACK (on_dial_error),
+                           self,
+                           G_CONNECT_SWAPPED);
 }
 
 
@@ -182,6 +185,21 @@ emergency_menu_dispose (GObject *object)
   G_OBJECT_CLASS (phosh_emergency_menu_parent_class)->dispose (object);
 }
 
+
+static void
+emergency_menu_map (GtkWidget *widget)
+{
+  PhoshEmergencyMenu *self = PHOSH_EMERGENCY_MENU (widget);
+
+  /* The menu is reused so always start at the dial pad */
+  hdy_carousel_scroll_to_full (self->emergency_carousel,
+                               GTK_WIDGET (self->emergency_dialpad_box),
+                               0);
+
+  GTK_WIDGET_CLASS (phosh_emergency_menu_parent_class)->map (widget);
+}
+
+
 static void
 on_dialpad_dialed (PhoshEmergencyMenu *self, const char *number)
 {
@@ -210,7 +228,8 @@ static void
 on_emergency_contacts_button_clicked (PhoshEmergencyMenu *self)
 {
   g_debug ("Emergency info button pressed");
-  hdy_carousel_scroll_to (self->emergency_carousel, GTK_WIDGET (self->emergency_info_box));
+  phosh_animation_carousel_scroll_to (self->emergency_carousel,
+                                      GTK_WIDGET (self->emergency_info_box));
 }
 
 
@@ -223,6 +242,8 @@ phosh_emergency_menu_class_init (PhoshEmergencyMenuClass *klass)
   object_class->constructed  = emergency_menu_constructed;
   object_class->dispose  = emergency_menu_dispose;
 
+  widget_class->map = emergency_menu_map;
+
   signals[DONE] = g_signal_new ("done",
                                 G_TYPE_FROM_CLASS (klass),
                                 G_SIGNAL_RUN_LAST,
@@ -136,6 +136,11 @@ phosh_fader_show (GtkWidget *widget)
     style_class = self->style_class ?: PHOSH_FADER_DEFAULT_STYLE_CLASS;
     context = gtk_widget_get_style_context (widget);
     gtk_style_context_add_class (context, style_class);
+    /* Lets the style sheet shorten the fade in */
+    if (phosh_animation_get_profile () == PHOSH_ANIMATION_PROFILE_REDUCED)
+      gtk_style_context_add_class (context, "reduced-motion");
+    else
+      gtk_style_context_remove_class (context, "reduced-motion");
   }
 
   GTK_WIDGET_CLASS (phosh_fader_parent_class)->show (widget);
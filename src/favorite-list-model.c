@@ -26,6 +26,8 @@
 typedef struct _PhoshFavoriteListModelPrivate {
   /* The complete list as stored in @settings */
   GStrv items_inc_missing;
+  /* @items_inc_missing as a set for fast lookups */
+  GHashTable *favorites;
 
   /* The sanitised list */
   GStrv items;
@@ -51,6 +53,7 @@ phosh_favorite_list_model_finalize (GObject *object)
   g_clear_object (&priv->settings);
 
   g_clear_pointer (&priv->items_inc_missing, g_strfreev);
+  g_clear_pointer (&priv->favorites, g_hash_table_destroy);
   g_clear_pointer (&priv->items, g_strfreev);
 
   G_OBJECT_CLASS (phosh_favorite_list_model_parent_class)->finalize (object);
@@ -73,6 +76,22 @@ list_get_item_type (GListModel *list)
 }
 
 
+/*
+ * Resolve the id via the already loaded apps and only hit the disk
+ * for apps not (yet) known there.
+ */
+static GAppInfo *
+get_app_info (const char *id)
+{
+  GAppInfo *info = phosh_app_list_model_lookup_by_id (phosh_app_list_model_get_default (), id);
+
+  if (info)
+    return g_object_ref (info);
+
+  return G_APP_INFO (g_desktop_app_info_new (id));
+}
+
+
 static gpointer
 list_get_item (GListModel *list, guint position)
 {
@@ -83,7 +102,7 @@ list_get_item (GListModel *list, guint position)
     return NULL;
   }
 
-  return g_desktop_app_info_new (priv->items[position]);
+  return get_app_info (priv->items[position]);
 }
 
 
@@ -118,11 +137,16 @@ refresh_favorites_items (PhoshFavoriteListModel *self)
   /* Clear the old items */
   removed = priv->len;
 
+  /* The set only points to the strings in @items_inc_missing */
+  g_hash_table_remove_all (priv->favorites);
+  for (int i = 0; priv->items_inc_missing[i]; i++)
+    g_hash_table_add (priv->favorites, priv->items_inc_missing[i]);
+
   for (int i = 0; priv->items_inc_missing[i]; i++) {
-    g_autoptr (GDesktopAppInfo) info = NULL;
+    g_autoptr (GAppInfo) info = NULL;
 
     /* We don't actually care about this value, just that it isn't NULL */
-    info = g_desktop_app_info_new (priv->items_inc_missing[i]);
+    info = get_app_info (priv->items_inc_missing[i]);
 
     if (G_UNLIKELY (info == NULL)) {
       g_debug ("Missing favorite %s, skipping", priv->items_inc_missing[i]);
@@ -153,6 +177,7 @@ on_favorites_changed (GSettings *settings, const char *key, PhoshFavoriteListMod
 {
   PhoshFavoriteListModelPrivate *priv = phosh_favorite_list_model_get_instance_private (self);
 
+  g_hash_table_remove_all (priv->favorites);
   g_clear_pointer (&priv->items_inc_missing, g_strfreev);
   /* Get the new list */
   priv->items_inc_missing = g_settings_get_strv (settings, key);
@@ -173,6 +198,8 @@ phosh_favorite_list_model_init (PhoshFavoriteListModel *self)
 {
   PhoshFavoriteListModelPrivate *priv = phosh_favorite_list_model_get_instance_private (self);
 
+  priv->favorites = g_hash_table_new (g_str_hash, g_str_equal);
+
   priv->settings = g_settings_new ("sm.puri.phosh");
   g_signal_connect (priv->settings, "changed::" FAVORITES_KEY,
                     G_CALLBACK (on_favorites_changed), self);
@@ -230,10 +257,43 @@ phosh_favorite_list_model_app_is_favorite (PhoshFavoriteListModel *self, GAppInf
   if (G_UNLIKELY (id == NULL))
     return FALSE;
 
-  if (g_strv_contains ((const char *const *) priv->items_inc_missing, id))
-    return TRUE;
+  return g_hash_table_contains (priv->favorites, id);
+}
 
-  return FALSE;
+/**
+ * phosh_favorite_list_model_apps_are_favorite:
+ * @self: (nullable): the #PhoshFavoriteListModel, use %NULL for the default
+ * @apps: (array length=n_apps): The #GAppInfo s to lookup
+ * @n_apps: The number of apps
+ * @is_favorite: (array length=n_apps)(out caller-allocates): Return location for the results
+ *
+ * Looks up whether each of the given apps is currently a favorite. This
+ * is the same as calling [method@FavoriteListModel.app_is_favorite] for
+ * each app but avoids the per call overhead when checking many apps.
+ */
+void
+phosh_favorite_list_model_apps_are_favorite (PhoshFavoriteListModel *self,
+                                             GAppInfo              **apps,
+                                             guint                   n_apps,
+                                             gboolean               *is_favorite)
+{
+  PhoshFavoriteListModel *list = self != NULL ? self : phosh_favorite_list_model_get_default ();
+  PhoshFavoriteListModelPrivate *priv = phosh_favorite_list_model_get_instance_private (list);
+
+  g_return_if_fail (apps != NULL || n_apps == 0);
+  g_return_if_fail (is_favorite != NULL || n_apps == 0);
+
+  for (guint i = 0; i < n_apps; i++) {
+    const char *id;
+
+    is_favorite[i] = FALSE;
+    if (PHOSH_IS_FOLDER_INFO (apps[i]) || !G_IS_APP_INFO (apps[i]))
+      continue;
+
+    id = g_app_info_get_id (apps[i]);
+    if (G_LIKELY (id))
+      is_favorite[i] = g_hash_table_contains (priv->favorites, id);
+  }
 }
 
 
@@ -22,6 +22,10 @@ struct _PhoshFavoriteListModelClass
 PhoshFavoriteListModel *phosh_favorite_list_model_get_default     (void);
 gboolean                phosh_favorite_list_model_app_is_favorite (PhoshFavoriteListModel *self,
                                                                    GAppInfo                *app);
+void                    phosh_favorite_list_model_apps_are_favorite (PhoshFavoriteListModel *self,
+                                                                     GAppInfo              **apps,
+                                                                     guint                   n_apps,
+                                                                     gboolean               *is_favorite);
 void                    phosh_favorite_list_model_add_app         (PhoshFavoriteListModel *self,
                                                                    GAppInfo                *app);
 void                    phosh_favorite_list_model_remove_app      (PhoshFavoriteListModel *self,
@@ -26,6 +26,9 @@
 #define PHOSH_FEEDBACK_ICON_QUIET "feedback-quiet-symbolic"
 #define PHOSH_FEEDBACK_ICON_SILENT "notifications-disabled-symbolic"
 
+/* A button press can e.g. also activate a row, only give feedback once */
+#define SUPPRESS_INTERVAL_US (50 * 1000)
+
 enum {
   PROP_0,
   PROP_ICON_NAME,
@@ -50,6 +53,76 @@ struct _PhoshFeedbackManager {
 
 G_DEFINE_TYPE (PhoshFeedbackManager, phosh_feedback_manager, G_TYPE_OBJECT);
 
+typedef struct {
+  LfbEvent *event;
+  gint64    last_triggered;
+} PhoshFeedbackEvent;
+
+/* Event name → PhoshFeedbackEvent, so triggering doesn't build events */
+static GHashTable *events;
+/* Hints for events sent without an LfbEvent, reused for every call */
+static GVariant *empty_hints;
+
+
+static void
+feedback_event_free (PhoshFeedbackEvent *event)
+{
+  g_object_unref (event->event);
+  g_free (event);
+}
+
+
+static PhoshFeedbackEvent *
+get_event (const char *name)
+{
+  PhoshFeedbackEvent *event;
+
+  if (G_UNLIKELY (events == NULL)) {
+    events = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                    g_free, (GDestroyNotify) feedback_event_free);
+  }
+
+  event = g_hash_table_lookup (events, name);
+  if (event)
+    return event;
+
+  event = g_new0 (PhoshFeedbackEvent, 1);
+  event->event = lfb_event_new (name);
+  g_hash_table_insert (events, g_strdup (name), event);
+
+  return event;
+}
+
+
+static void
+trigger_button_feedback (const char *name)
+{
+  PhoshFeedbackEvent *event;
+  gint64 now;
+
+  if (!lfb_is_initted ())
+    return;
+
+  event = get_event (name);
+  now = g_get_monotonic_time ();
+  if (now - event->last_triggered < SUPPRESS_INTERVAL_US)
+    return;
+  event->last_triggered = now;
+
+  if (G_UNLIKELY (empty_hints == NULL))
+    empty_hints = g_variant_ref_sink (g_variant_new ("a{sv}", NULL));
+
+  /* Without a callback GDBus doesn't ask for a reply so nothing waits on feedbackd */
+  lfb_gdbus_feedback_call_trigger_feedback (lfb_get_proxy (),
+                                            lfb_get_app_id (),
+                                            name,
+                                            empty_hints,
+                                            -1,
+                                            NULL,
+                                            NULL,
+                                            NULL);
+}
+
 
 static void
 on_event_triggered (LfbEvent      *event,
@@ -136,7 +209,7 @@ on_signal_hook (GSignalInvocationHint *ihint,
 
   g_return_val_if_fail (event_name, TRUE);
 
-  phosh_trigger_feedback (event_name);
+  trigger_button_feedback (event_name);
   return TRUE;
 }
 
@@ -205,6 +278,9 @@ phosh_feedback_manager_finalize (GObject *object)
 
   if (self->inited) {
     g_signal_handlers_disconnect_by_data (lfb_get_proxy (), self);
+    /* Events need libfeedback */
+    g_clear_pointer (&events, g_hash_table_unref);
+    g_clear_pointer (&empty_hints, g_variant_unref);
     lfb_uninit ();
     self->inited = FALSE;
   }
@@ -323,18 +399,19 @@ phosh_feedback_manager_toggle (PhoshFeedbackManager *self)
  * phosh_trigger_feedback:
  * @name: The event's name to trigger feedback for
  *
- * Trigger feedback for the given event asynchronously
+ * Trigger feedback for the given event asynchronously. The event is
+ * reused for later triggers of the same name.
  */
 void
 phosh_trigger_feedback (const char *name)
 {
-  g_autoptr (LfbEvent) event = NULL;
+  PhoshFeedbackEvent *event;
 
   g_return_if_fail (lfb_is_initted ());
   g_return_if_fail (name);
 
-  event = lfb_event_new (name);
-  lfb_event_trigger_feedback_async (event,
+  event = get_event (name);
+  lfb_event_trigger_feedback_async (event->event,
                                     NULL,
                                     (GAsyncReadyCallback)on_event_triggered,
                                     NULL);
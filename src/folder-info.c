@@ -11,6 +11,7 @@
 #include "folder-info.h"
 #include "util.h"
 
+#include "app-list-model.h"
 #include "favorite-list-model.h"
 #include "gtk-list-models/gtkfilterlistmodel.h"
 
@@ -30,6 +31,7 @@
 enum {
   PROP_0,
   PROP_PATH,
+  PROP_APP_LIST,
   PROP_NAME,
   PROP_APP_INFOS,
   PROP_LAST_PROP,
@@ -50,12 +52,17 @@ struct _PhoshFolderInfo {
 
   /* Contains all apps belonging to the folder */
   GListStore             *app_infos;
+  /* Ids of the above and a set of them for fast lookups */
+  GStrv                   app_ids;
+  GHashTable             *app_id_set;
   /* Filters the above to show only required apps,
    * like non-favorite etc. */
   GtkFilterListModel     *filtered_app_infos;
 
   PhoshFavoriteListModel *favorites;
   GSettings              *settings;
+  /* Used to share app-infos and their search index with the app grid */
+  PhoshAppListModel      *app_list;
 
   /* The current search term (only valid during refilter) */
   const char             *search;
@@ -79,6 +86,9 @@ phosh_folder_info_set_property (GObject      *object,
   case PROP_PATH:
     self->path = g_value_dup_string (value);
     break;
+  case PROP_APP_LIST:
+    g_set_weak_pointer (&self->app_list, g_value_get_object (value));
+    break;
   case PROP_NAME:
     phosh_folder_info_set_name (self, g_value_get_string (value));
     break;
@@ -101,6 +111,9 @@ phosh_folder_info_get_property (GObject    *object,
   case PROP_PATH:
     g_value_set_string (value, self->path);
     break;
+  case PROP_APP_LIST:
+    g_value_set_object (value, self->app_list);
+    break;
   case PROP_NAME:
     g_value_set_string (value, self->name);
     break;
@@ -202,23 +215,58 @@ on_settings_name_changed (PhoshFolderInfo *self, GSettings *settings, char *key)
 }
 
 
+static GAppInfo *
+lookup_app_info (PhoshFolderInfo *self, const char *app_id)
+{
+  GAppInfo *app_info = NULL;
+
+  if (self->app_list)
+    app_info = phosh_app_list_model_lookup_by_id (self->app_list, app_id);
+
+  if (app_info)
+    return g_object_ref (app_info);
+
+  return G_APP_INFO (g_desktop_app_info_new (app_id));
+}
+
+
 static void
 load_apps (PhoshFolderInfo *self)
 {
-  g_auto (GStrv) apps;
+  g_autoptr (GStrvBuilder) builder = g_strv_builder_new ();
+  g_autoptr (GPtrArray) app_infos = g_ptr_array_new_with_free_func (g_object_unref);
+  g_auto (GStrv) apps = NULL;
 
   apps = g_settings_get_strv (self->settings, "apps");
 
   for (int i = 0; apps[i]; i++) {
-    g_autoptr (GDesktopAppInfo) app_info = g_desktop_app_info_new (apps[i]);
+    g_autoptr (GAppInfo) app_info = lookup_app_info (self, apps[i]);
 
-    if (app_info == NULL)
+    if (app_info == NULL) {
       g_debug ("Unable to load app-info for %s", apps[i]);
-    else if (!g_app_info_should_show (G_APP_INFO (app_info)))
       continue;
-    else
-      g_list_store_append (self->app_infos, app_info);
+    }
+
+    if (!g_app_info_should_show (app_info))
+      continue;
+
+    /* Apps in folders aren't in the app list so index them here */
+    phosh_util_index_app_info (app_info);
+    g_strv_builder_add (builder, apps[i]);
+    g_ptr_array_add (app_infos, g_steal_pointer (&app_info));
   }
+
+  g_hash_table_remove_all (self->app_id_set);
+  g_clear_pointer (&self->app_ids, g_strfreev);
+  self->app_ids = g_strv_builder_end (builder);
+  for (int i = 0; self->app_ids[i]; i++)
+    g_hash_table_add (self->app_id_set, self->app_ids[i]);
+
+  g_list_store_splice (self->app_infos,
+                       0,
+                       g_list_model_get_n_items (G_LIST_MODEL (self->app_infos)),
+                       app_infos->pdata,
+                       app_infos->len);
 }
 
 
@@ -226,7 +274,6 @@ static void
 on_settings_apps_changed (PhoshFolderInfo *self, GSettings *settings, char *key)
 {
   g_signal_emit (self, signals[APPS_CHANGED], 0);
-  g_list_store_remove_all (self->app_infos);
   load_apps (self);
 }
 
@@ -260,7 +307,10 @@ phosh_folder_info_dispose (GObject *object)
   g_clear_pointer (&self->name, g_free);
   g_clear_object (&self->filtered_app_infos);
   g_clear_object (&self->app_infos);
+  g_clear_pointer (&self->app_id_set, g_hash_table_destroy);
+  g_clear_pointer (&self->app_ids, g_strfreev);
   g_clear_object (&self->settings);
+  g_clear_weak_pointer (&self->app_list);
 
   G_OBJECT_CLASS (phosh_folder_info_parent_class)->dispose (object);
 }
@@ -275,6 +325,7 @@ phosh_folder_info_constructed (GObject *object)
   G_OBJECT_CLASS (phosh_folder_info_parent_class)->constructed (object);
 
   self->app_infos = g_list_store_new (G_TYPE_APP_INFO);
+  self->app_id_set = g_hash_table_new (g_str_hash, g_str_equal);
   self->favorites = phosh_favorite_list_model_get_default ();
   self->filtered_app_infos = gtk_filter_list_model_new (G_LIST_MODEL (self->app_infos),
                                                         filter_app,
@@ -324,6 +375,19 @@ phosh_folder_info_class_init (PhoshFolderInfoClass *klass)
                          G_PARAM_CONSTRUCT_ONLY |
                          G_PARAM_STATIC_STRINGS);
 
+  /**
+   * PhoshFolderInfo:app-list:
+   *
+   * The app list to look up the folder's apps in. Apps not found
+   * there are loaded from their desktop files.
+   */
+  props[PROP_APP_LIST] =
+    g_param_spec_object ("app-list", "", "",
+                         PHOSH_TYPE_APP_LIST_MODEL,
+                         G_PARAM_READWRITE |
+                         G_PARAM_CONSTRUCT_ONLY |
+                         G_PARAM_STATIC_STRINGS);
+
   /**
    * PhoshFolderInfo:name:
    *
@@ -369,6 +433,22 @@ phosh_folder_info_new_from_folder_path (char *path)
   return g_object_new (PHOSH_TYPE_FOLDER_INFO, "path", path, NULL);
 }
 
+/**
+ * phosh_folder_info_new_for_app_list:
+ * @path: Relative GSettings path to folder
+ * @app_list: The app list to look up the folder's apps in
+ *
+ * Like [ctor@FolderInfo.new_from_folder_path] but reuses the
+ * app-infos of `app_list` where possible.
+ *
+ * Returns: The folder info
+ */
+PhoshFolderInfo *
+phosh_folder_info_new_for_app_list (char *path, PhoshAppListModel *app_list)
+{
+  return g_object_new (PHOSH_TYPE_FOLDER_INFO, "path", path, "app-list", app_list, NULL);
+}
+
 
 char *
 phosh_folder_info_get_name (PhoshFolderInfo *self)
@@ -406,15 +486,36 @@ phosh_folder_info_get_app_infos (PhoshFolderInfo *self)
 gboolean
 phosh_folder_info_contains (PhoshFolderInfo *self, GAppInfo *app_info)
 {
+  const char *app_id;
   gboolean found = FALSE;
   g_return_val_if_fail (PHOSH_IS_FOLDER_INFO (self), FALSE);
 
+  app_id = g_app_info_get_id (app_info);
+  if (app_id)
+    return g_hash_table_contains (self->app_id_set, app_id);
+
   found = g_list_store_find_with_equal_func (self->app_infos, app_info,
                                              (GEqualFunc) g_app_info_equal, NULL);
 
   return found;
 }
 
+/**
+ * phosh_folder_info_get_app_ids:
+ * @self: A folder info
+ *
+ * Get the ids of the apps in the folder.
+ *
+ * Returns:(transfer none): The app ids
+ */
+const char * const *
+phosh_folder_info_get_app_ids (PhoshFolderInfo *self)
+{
+  g_return_val_if_fail (PHOSH_IS_FOLDER_INFO (self), NULL);
+
+  return (const char * const *) self->app_ids;
+}
+
 
 gboolean
 phosh_folder_info_refilter (PhoshFolderInfo *self, const char *search)
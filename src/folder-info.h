@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include "app-list-model.h"
+
 #include <gio/gio.h>
 
 G_BEGIN_DECLS
@@ -16,11 +18,13 @@ G_BEGIN_DECLS
 G_DECLARE_FINAL_TYPE (PhoshFolderInfo, phosh_folder_info, PHOSH, FOLDER_INFO, GObject)
 
 PhoshFolderInfo *phosh_folder_info_new_from_folder_path (char *path);
+PhoshFolderInfo *phosh_folder_info_new_for_app_list (char *path, PhoshAppListModel *app_list);
 
 char       *phosh_folder_info_get_name (PhoshFolderInfo *self);
 void        phosh_folder_info_set_name (PhoshFolderInfo *self, const char *name);
 GListModel *phosh_folder_info_get_app_infos (PhoshFolderInfo *self);
 gboolean    phosh_folder_info_contains (PhoshFolderInfo *self, GAppInfo *app_info);
+const char * const *phosh_folder_info_get_app_ids (PhoshFolderInfo *self);
 gboolean    phosh_folder_info_refilter (PhoshFolderInfo *self, const char *search);
 void        phosh_folder_info_add_app_info (PhoshFolderInfo *self, GAppInfo *app_info);
 gboolean    phosh_folder_info_remove_app_info (PhoshFolderInfo *self, GAppInfo *app_info);
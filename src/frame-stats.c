@@ -0,0 +1,260 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "phosh-frame-stats"
+
+#include "phosh-config.h"
+
+#include "frame-stats.h"
+#include "trace.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * PhoshFrameStats:
+ *
+ * Accounts frame timings per layer surface
+ *
+ * Layer surfaces report their frame clock phase durations, the time
+ * from a compositor driven drag to the next commit, the time from
+ * commit to presentation and the time from a drag to the presentation
+ * of the resulting frame (input to photon latency). The last `MAX_SAMPLES` samples of each kind
+ * are kept per surface namespace so percentiles can be reported.
+ *
+ * This is meant for debugging and available via the `GetFrameStats`
+ * method of `mobi.phosh.Shell.DebugControl`.
+ */
+
+#define MAX_SAMPLES 512
+/* A frame taking longer than this likely missed the next vblank at 60Hz */
+#define LONG_FRAME_US 16667
+
+typedef struct {
+  gint64  samples[MAX_SAMPLES];
+  guint   n_samples;
+  guint   next;
+  gint64  max;
+} PhoshFrameStatsSeries;
+
+typedef struct {
+  guint64 frames;
+  guint64 long_frames;
+  PhoshFrameStatsSeries series[PHOSH_FRAME_STATS_N_KINDS];
+} PhoshFrameStat;
+
+static const char *kind_names[PHOSH_FRAME_STATS_N_KINDS] = {
+  [PHOSH_FRAME_STATS_LAYOUT] = "layout",
+  [PHOSH_FRAME_STATS_PAINT] = "paint",
+  [PHOSH_FRAME_STATS_FRAME] = "frame",
+  [PHOSH_FRAME_STATS_INPUT] = "input",
+  [PHOSH_FRAME_STATS_PRESENTATION] = "presentation",
+  [PHOSH_FRAME_STATS_LATENCY] = "latency",
+};
+
+static struct {
+  gboolean    enabled;
+  /* key: surface namespace, value: PhoshFrameStat */
+  GHashTable *stats;
+} frame_stats;
+
+/**
+ * phosh_frame_stats_set_enabled:
+ * @enabled: Whether to account frame timings
+ *
+ * Enable or disable accounting. Stats collected so far are kept.
+ */
+void
+phosh_frame_stats_set_enabled (gboolean enabled)
+{
+  enabled = !!enabled;
+  if (frame_stats.enabled == enabled)
+    return;
+
+  frame_stats.enabled = enabled;
+  g_debug ("%s frame stats", enabled ? "Enabling" : "Disabling");
+
+  if (enabled && frame_stats.stats == NULL)
+    frame_stats.stats = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+}
+
+
+gboolean
+phosh_frame_stats_get_enabled (void)
+{
+  return frame_stats.enabled;
+}
+
+/**
+ * phosh_frame_stats_reset:
+ *
+ * Clear the collected stats.
+ */
+void
+phosh_frame_stats_reset (void)
+{
+  if (frame_stats.stats)
+    g_hash_table_remove_all (frame_stats.stats);
+}
+
+/**
+ * phosh_frame_stats_add:
+ * @name: The surface's namespace
+ * @kind: The kind of duration
+ * @duration: The duration in microseconds
+ *
+ * Add a sample for the given surface. Does nothing when accounting is
+ * disabled.
+ */
+void
+phosh_frame_stats_add (const char *name, PhoshFrameStatsKind kind, gint64 duration)
+{
+  PhoshFrameStat *stat;
+  PhoshFrameStatsSeries *series;
+
+  g_return_if_fail (kind < PHOSH_FRAME_STATS_N_KINDS);
+
+  if (!frame_stats.enabled)
+    return;
+
+  name = name ?: "(unnamed)";
+  stat = g_hash_table_lookup (frame_stats.stats, name);
+  if (stat == NULL) {
+    stat = g_new0 (PhoshFrameStat, 1);
+    g_hash_table_insert (frame_stats.stats, g_strdup (name), stat);
+  }
+
+  series = &stat->series[kind];
+  series->samples[series->next] = duration;
+  series->next = (series->next + 1) % MAX_SAMPLES;
+  series->n_samples = MIN (series->n_samples + 1, MAX_SAMPLES);
+  series->max = MAX (series->max, duration);
+
+  if (kind != PHOSH_FRAME_STATS_FRAME)
+    return;
+
+  stat->frames++;
+  if (duration > LONG_FRAME_US) {
+    stat->long_frames++;
+    g_debug ("Long frame in '%s': %" G_GINT64_FORMAT "us", name, duration);
+    /* The frame just ended, sysprof uses nanoseconds */
+    PHOSH_TRACE_MARK (PHOSH_TRACE_CURRENT_TIME - duration * 1000, "long frame", "%s", name);
+  }
+}
+
+
+static int
+cmp_samples (gconstpointer a, gconstpointer b)
+{
+  gint64 sa = *(const gint64 *)a;
+  gint64 sb = *(const gint64 *)b;
+
+  return (sa > sb) - (sa < sb);
+}
+
+
+static void
+series_get_percentiles (PhoshFrameStatsSeries *series, gint64 *p50, gint64 *p90, gint64 *p99)
+{
+  gint64 sorted[MAX_SAMPLES];
+  guint n = series->n_samples;
+
+  if (n == 0) {
+    *p50 = *p90 = *p99 = 0;
+    return;
+  }
+
+  memcpy (sorted, series->samples, n * sizeof (gint64));
+  qsort (sorted, n, sizeof (gint64), cmp_samples);
+
+  *p50 = sorted[(n - 1) * 50 / 100];
+  *p90 = sorted[(n - 1) * 90 / 100];
+  *p99 = sorted[(n - 1) * 99 / 100];
+}
+
+
+static GVariant *
+series_to_variant (PhoshFrameStatsSeries *series)
+{
+  gint64 p50, p90, p99;
+
+  series_get_percentiles (series, &p50, &p90, &p99);
+
+  return g_variant_new ("(xxxx)", p50, p90, p99, series->max);
+}
+
+/**
+ * phosh_frame_stats_get:
+ *
+ * Get the collected stats. Keys are surface namespaces, values a
+ * dictionary with the number of frames ("frames"), the number of
+ * frames that took longer than a 60Hz refresh cycle ("long-frames")
+ * and for each kind of duration ("layout", "paint", "frame", "input"
+ * "presentation" and "latency") the 50th, 90th and 99th percentile and the
+ * maximum. Times are in microseconds.
+ *
+ * Returns:(transfer floating): The stats as `a{sa{sv}}`
+ */
+GVariant *
+phosh_frame_stats_get (void)
+{
+  GVariantBuilder builder;
+  GHashTableIter iter;
+  gpointer key, value;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sa{sv}}"));
+
+  if (frame_stats.stats == NULL)
+    return g_variant_builder_end (&builder);
+
+  g_hash_table_iter_init (&iter, frame_stats.stats);
+  while (g_hash_table_iter_next (&iter, &key, &value)) {
+    PhoshFrameStat *stat = value;
+    GVariantBuilder props;
+
+    g_variant_builder_init (&props, G_VARIANT_TYPE_VARDICT);
+    g_variant_builder_add (&props, "{sv}", "frames", g_variant_new_uint64 (stat->frames));
+    g_variant_builder_add (&props, "{sv}", "long-frames", g_variant_new_uint64 (stat->long_frames));
+    for (int i = 0; i < PHOSH_FRAME_STATS_N_KINDS; i++) {
+      g_variant_builder_add (&props, "{sv}", kind_names[i],
+                             series_to_variant (&stat->series[i]));
+    }
+    g_variant_builder_add (&builder, "{sa{sv}}", key, &props);
+  }
+
+  return g_variant_builder_end (&builder);
+}
+
+/**
+ * phosh_frame_stats_log:
+ * @name: The surface's namespace
+ * @kind: The kind of duration
+ *
+ * Log the 50th and 99th percentile of the given kind of duration
+ * for the given surface, e.g. at the end of a drag.
+ */
+void
+phosh_frame_stats_log (const char *name, PhoshFrameStatsKind kind)
+{
+  PhoshFrameStat *stat;
+  PhoshFrameStatsSeries *series;
+  gint64 p50, p90, p99;
+
+  g_return_if_fail (kind < PHOSH_FRAME_STATS_N_KINDS);
+
+  if (!frame_stats.enabled)
+    return;
+
+  name = name ?: "(unnamed)";
+  stat = g_hash_table_lookup (frame_stats.stats, name);
+  if (stat == NULL || stat->series[kind].n_samples == 0)
+    return;
+
+  series = &stat->series[kind];
+  series_get_percentiles (series, &p50, &p90, &p99);
+  g_debug ("'%s' %s over %u samples: p50 %" G_GINT64_FORMAT "us, p99 %" G_GINT64_FORMAT "us",
+           name, kind_names[kind], series->n_samples, p50, p99);
+}
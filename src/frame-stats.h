@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/**
+ * PhoshFrameStatsKind:
+ * @PHOSH_FRAME_STATS_LAYOUT: Time spent updating and laying out a frame
+ * @PHOSH_FRAME_STATS_PAINT: Time spent painting a frame
+ * @PHOSH_FRAME_STATS_FRAME: Time from the start of a frame to its commit
+ * @PHOSH_FRAME_STATS_INPUT: Time from a compositor driven drag to the commit
+ * @PHOSH_FRAME_STATS_PRESENTATION: Time from a commit to its presentation
+ * @PHOSH_FRAME_STATS_LATENCY: Time from a compositor driven drag to the
+ *   presentation of the resulting frame
+ *
+ * The durations accounted per surface.
+ */
+typedef enum {
+  PHOSH_FRAME_STATS_LAYOUT,
+  PHOSH_FRAME_STATS_PAINT,
+  PHOSH_FRAME_STATS_FRAME,
+  PHOSH_FRAME_STATS_INPUT,
+  PHOSH_FRAME_STATS_PRESENTATION,
+  PHOSH_FRAME_STATS_LATENCY,
+  PHOSH_FRAME_STATS_N_KINDS,
+} PhoshFrameStatsKind;
+
+void      phosh_frame_stats_set_enabled (gboolean enabled);
+gboolean  phosh_frame_stats_get_enabled (void);
+void      phosh_frame_stats_reset       (void);
+void      phosh_frame_stats_add         (const char          *name,
+                                         PhoshFrameStatsKind  kind,
+                                         gint64               duration);
+GVariant *phosh_frame_stats_get         (void);
+void      phosh_frame_stats_log         (const char          *name,
+                                         PhoshFrameStatsKind  kind);
+
+G_END_DECLS
@@ -15,6 +15,7 @@
 #include "gnome-shell-manager.h"
 #include "shell-priv.h"
 #include "lockscreen-manager.h"
+#include "phosh-wayland.h"
 
 #define GNOME_DESKTOP_USE_UNSTABLE_API
 #include <libgnome-desktop/gnome-desktop-version.h>
@@ -51,6 +52,9 @@ typedef struct _PhoshGnomeShellManager {
   gboolean                    do_repeat;
   guint                       repeat_delay_ms;
   guint                       repeat_interval_ms;
+  /* Like the compositor only the most recently pressed accelerator repeats */
+  struct _AcceleratorInfo    *repeat_info;
+  guint                       repeat_id;
 
   gboolean                    overview_active;
 } PhoshGnomeShellManager;
@@ -70,9 +74,10 @@ typedef struct _AcceleratorInfo {
   char                            *sender;
   guint                            mode_flags;
   guint                            grab_flags;
-  guint                            repeat_id;
 } AcceleratorInfo;
 
+static void stop_repeat (PhoshGnomeShellManager *self);
+
 static void
 remove_action_entries (char *accelerator)
 {
@@ -87,10 +92,12 @@ static void
 free_accelerator_info_from_hash_table (gpointer data)
 {
   AcceleratorInfo *info = (AcceleratorInfo *) data;
+  PhoshGnomeShellManager *self = phosh_gnome_shell_manager_get_default ();
   g_return_if_fail (info != NULL);
 
   remove_action_entries (info->accelerator);
-  g_clear_handle_id (&info->repeat_id, g_source_remove);
+  if (self->repeat_info == info)
+    stop_repeat (self);
   g_free (info->accelerator);
   g_free (info->sender);
   g_free (info);
@@ -417,15 +424,25 @@ accelerator_activated (PhoshDBusGnomeShell *skeleton,
 
 
 static void
-on_keyboard_setting_changed (PhoshGnomeShellManager *self,
-                             const char             *key,
-                             GSettings              *settings)
+update_repeat_info (PhoshGnomeShellManager *self)
 {
+  int rate, delay;
+
   g_assert (PHOSH_IS_GNOME_SHELL_MANAGER (self));
 
-  self->do_repeat = g_settings_get_boolean (self->keyboard_settings, "repeat");
-  self->repeat_delay_ms = g_settings_get_uint (self->keyboard_settings, "delay");
-  self->repeat_interval_ms = g_settings_get_uint (self->keyboard_settings, "repeat-interval");
+  /* Prefer what the compositor uses for all other keys */
+  if (phosh_wayland_get_key_repeat_info (phosh_wayland_get_default (), &rate, &delay)) {
+    self->do_repeat = rate > 0;
+    self->repeat_delay_ms = delay;
+    self->repeat_interval_ms = rate > 0 ? MAX (1000 / rate, 1) : 0;
+  } else {
+    self->do_repeat = g_settings_get_boolean (self->keyboard_settings, "repeat");
+    self->repeat_delay_ms = g_settings_get_uint (self->keyboard_settings, "delay");
+    self->repeat_interval_ms = g_settings_get_uint (self->keyboard_settings, "repeat-interval");
+  }
+
+  if (!self->do_repeat)
+    stop_repeat (self);
 
   g_debug ("Key repeat %sabled (delay: %u, interval: %u)",
            self->do_repeat ? "en" : "dis", self->repeat_delay_ms, self->repeat_interval_ms);
@@ -515,15 +532,23 @@ do_activate_accelerator (AcceleratorInfo *info)
 }
 
 
+static void
+stop_repeat (PhoshGnomeShellManager *self)
+{
+  g_clear_handle_id (&self->repeat_id, g_source_remove);
+  self->repeat_info = NULL;
+}
+
+
 static gboolean
 on_accelerator_repeat (gpointer data)
 {
-  AcceleratorInfo *info = data;
+  PhoshGnomeShellManager *self = PHOSH_GNOME_SHELL_MANAGER (data);
 
-  g_assert (info);
-  g_assert (info->action_id);
+  g_assert (self->repeat_info);
+  g_assert (self->repeat_info->action_id);
 
-  do_activate_accelerator (info);
+  do_activate_accelerator (self->repeat_info);
 
   return G_SOURCE_CONTINUE;
 }
@@ -532,17 +557,15 @@ on_accelerator_repeat (gpointer data)
 static gboolean
 on_accelerator_repeat_delay (gpointer data)
 {
-  PhoshGnomeShellManager *self = phosh_gnome_shell_manager_get_default ();
-  AcceleratorInfo *info = data;
-  g_autofree char *source_name = g_strdup_printf ("[phosh] key repeat for id %u", info->action_id);
+  PhoshGnomeShellManager *self = PHOSH_GNOME_SHELL_MANAGER (data);
 
-  g_assert (info);
-  g_assert (info->action_id);
+  g_assert (self->repeat_info);
+  g_assert (self->repeat_info->action_id);
 
-  do_activate_accelerator (info);
+  do_activate_accelerator (self->repeat_info);
 
-  info->repeat_id = g_timeout_add (self->repeat_interval_ms, on_accelerator_repeat, info);
-  g_source_set_name_by_id (info->repeat_id, source_name);
+  self->repeat_id = g_timeout_add (self->repeat_interval_ms, on_accelerator_repeat, self);
+  g_source_set_name_by_id (self->repeat_id, "[phosh] key repeat");
 
   return G_SOURCE_REMOVE;
 }
@@ -561,16 +584,19 @@ accelerator_activated_action (GSimpleAction *action,
   action_id = info->action_id;
   if (!press) {
     g_debug ("accelerator released for id %u", action_id);
-    g_clear_handle_id (&info->repeat_id, g_source_remove);
+    if (self->repeat_info == info)
+      stop_repeat (self);
     return;
   }
   g_debug ("accelerator action activated for id %u", action_id);
 
+  /* A new press stops any other repeating accelerator */
+  stop_repeat (self);
   if ((info->grab_flags & PHOSH_SHELL_KEY_BINDING_IGNORE_AUTOREPEAT) == 0 && self->do_repeat) {
-    g_autofree char *source_name = g_strdup_printf ("[phosh] key-repeat-delay for %u", action_id);
     g_debug ("setting up accelerator autorepeat for id %u", action_id);
-    info->repeat_id = g_timeout_add (self->repeat_delay_ms, on_accelerator_repeat_delay, info);
-    g_source_set_name_by_id (info->repeat_id, source_name);
+    self->repeat_info = info;
+    self->repeat_id = g_timeout_add (self->repeat_delay_ms, on_accelerator_repeat_delay, self);
+    g_source_set_name_by_id (self->repeat_id, "[phosh] key repeat delay");
   }
 
   do_activate_accelerator (info);
@@ -701,6 +727,7 @@ phosh_gnome_shell_manager_dispose (GObject *object)
   if (g_dbus_interface_skeleton_get_object_path (G_DBUS_INTERFACE_SKELETON (self)))
     g_dbus_interface_skeleton_unexport (G_DBUS_INTERFACE_SKELETON (self));
 
+  stop_repeat (self);
   g_clear_pointer (&self->info_by_action, g_hash_table_unref);
   g_clear_object (&self->keyboard_settings);
 
@@ -775,11 +802,15 @@ phosh_gnome_shell_manager_init (PhoshGnomeShellManager *self)
   self->keyboard_settings = g_settings_new ("org.gnome.desktop.peripherals.keyboard");
 
   g_object_connect (self->keyboard_settings,
-    "swapped-signal::changed::repeat", G_CALLBACK (on_keyboard_setting_changed), self,
-    "swapped-signal::changed::repeat-interval", G_CALLBACK (on_keyboard_setting_changed), self,
-    "swapped-signal::changed::delay", G_CALLBACK (on_keyboard_setting_changed), self,
+    "swapped-signal::changed::repeat", G_CALLBACK (update_repeat_info), self,
+    "swapped-signal::changed::repeat-interval", G_CALLBACK (update_repeat_info), self,
+    "swapped-signal::changed::delay", G_CALLBACK (update_repeat_info), self,
     NULL);
-  on_keyboard_setting_changed (self, NULL, self->keyboard_settings);
+  g_signal_connect_object (phosh_wayland_get_default (), "notify::key-repeat-rate",
+                           G_CALLBACK (update_repeat_info), self, G_CONNECT_SWAPPED);
+  g_signal_connect_object (phosh_wayland_get_default (), "notify::key-repeat-delay",
+                           G_CALLBACK (update_repeat_info), self, G_CONNECT_SWAPPED);
+  update_repeat_info (self);
 
   g_object_set (G_OBJECT (self), "shell-version", version, NULL);
 }
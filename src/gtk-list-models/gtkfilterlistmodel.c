@@ -660,6 +660,26 @@ gtk_filter_list_model_has_filter (GtkFilterListModel *self)
  **/
 void
 gtk_filter_list_model_refilter (GtkFilterListModel *self)
+{
+  gtk_filter_list_model_refilter_full (self, GTK_FILTER_LIST_MODEL_CHANGE_DIFFERENT);
+}
+
+/**
+ * gtk_filter_list_model_refilter_full:
+ * @self: a #GtkFilterListModel
+ * @change: How the filter function changed
+ *
+ * Causes @self to refilter the items in the model whose visibility
+ * can change according to @change.
+ *
+ * Use this instead of gtk_filter_list_model_refilter() when the filter
+ * became more or less strict, e.g. when a search string got extended,
+ * so only the visible or hidden items are run through the filter
+ * function.
+ **/
+void
+gtk_filter_list_model_refilter_full (GtkFilterListModel       *self,
+                                     GtkFilterListModelChange  change)
 {
   FilterNode *node;
   guint i, first_change, last_change;
@@ -679,7 +699,12 @@ gtk_filter_list_model_refilter (GtkFilterListModel *self)
        node != NULL;
        i++, node = gtk_rb_tree_node_get_next (node))
     {
-      visible = gtk_filter_list_model_run_filter (self, i);
+      if ((change == GTK_FILTER_LIST_MODEL_CHANGE_LESS_STRICT && node->visible) ||
+          (change == GTK_FILTER_LIST_MODEL_CHANGE_MORE_STRICT && !node->visible))
+        visible = node->visible;
+      else
+        visible = gtk_filter_list_model_run_filter (self, i);
+
       if (visible == node->visible)
         {
           if (visible)
@@ -709,3 +734,39 @@ gtk_filter_list_model_refilter (GtkFilterListModel *self)
     }
 }
 
+
+/**
+ * gtk_filter_list_model_refilter_item:
+ * @self: a #GtkFilterListModel
+ * @position: the position of the item in the underlying model
+ *
+ * Causes @self to refilter the item at @position of the underlying
+ * model.
+ *
+ * Use this instead of gtk_filter_list_model_refilter() when only the
+ * data of a single item used by the filter function changed.
+ **/
+void
+gtk_filter_list_model_refilter_item (GtkFilterListModel *self,
+                                     guint               position)
+{
+  FilterNode *node;
+  guint filtered;
+  gboolean visible;
+
+  g_return_if_fail (GTK_IS_FILTER_LIST_MODEL (self));
+
+  if (self->items == NULL || self->model == NULL)
+    return;
+
+  node = gtk_filter_list_model_get_nth (self->items, position, &filtered);
+  g_return_if_fail (node != NULL);
+
+  visible = gtk_filter_list_model_run_filter (self, position);
+  if (visible == node->visible)
+    return;
+
+  node->visible = visible;
+  gtk_rb_tree_node_mark_dirty (node);
+  g_list_model_items_changed (G_LIST_MODEL (self), filtered, visible ? 0 : 1, visible ? 1 : 0);
+}
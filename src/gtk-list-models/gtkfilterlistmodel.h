@@ -45,6 +45,26 @@ G_DECLARE_FINAL_TYPE (GtkFilterListModel, gtk_filter_list_model, GTK, FILTER_LIS
  */
 typedef gboolean (* GtkFilterListModelFilterFunc) (gpointer item, gpointer user_data);
 
+/**
+ * GtkFilterListModelChange:
+ * @GTK_FILTER_LIST_MODEL_CHANGE_DIFFERENT: The filter function changed
+ *   in unknown ways, every item needs to be filtered again
+ * @GTK_FILTER_LIST_MODEL_CHANGE_LESS_STRICT: The filter function
+ *   keeps every currently visible item, only hidden items need to be
+ *   filtered again
+ * @GTK_FILTER_LIST_MODEL_CHANGE_MORE_STRICT: The filter function
+ *   keeps every currently hidden item hidden, only visible items need
+ *   to be filtered again
+ *
+ * Describes how the filter function changed so refiltering can skip
+ * the items whose visibility can't change.
+ */
+typedef enum {
+  GTK_FILTER_LIST_MODEL_CHANGE_DIFFERENT = 0,
+  GTK_FILTER_LIST_MODEL_CHANGE_LESS_STRICT,
+  GTK_FILTER_LIST_MODEL_CHANGE_MORE_STRICT,
+} GtkFilterListModelChange;
+
 GDK_AVAILABLE_IN_ALL
 GtkFilterListModel *    gtk_filter_list_model_new               (GListModel             *model,
                                                                  GtkFilterListModelFilterFunc filter_func,
@@ -68,6 +88,12 @@ gboolean                gtk_filter_list_model_has_filter        (GtkFilterListMo
 
 GDK_AVAILABLE_IN_ALL
 void                    gtk_filter_list_model_refilter          (GtkFilterListModel     *self);
+GDK_AVAILABLE_IN_ALL
+void                    gtk_filter_list_model_refilter_full     (GtkFilterListModel     *self,
+                                                                 GtkFilterListModelChange change);
+GDK_AVAILABLE_IN_ALL
+void                    gtk_filter_list_model_refilter_item     (GtkFilterListModel     *self,
+                                                                 guint                   position);
 
 G_END_DECLS
 
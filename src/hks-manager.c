@@ -31,6 +31,9 @@ G_DEFINE_AUTOPTR_CLEANUP_FUNC (RfKillEvent, g_free);
 #define RFKILL_TYPE_CAMERA_ 9
 #define RFKILL_TYPE_MIC_ 10
 
+/* Switches killing several devices emit an event per device */
+#define HKS_BATCH_TIMEOUT_MS 50
+
 /**
  * PhoshHksManager:
  *
@@ -38,6 +41,12 @@ G_DEFINE_AUTOPTR_CLEANUP_FUNC (RfKillEvent, g_free);
  *
  * Monitor hardware kill switch state. This will be submitted to gnome-settings-daemon
  * once we figured out the kernel interfaces.
+ *
+ * A single rfkill fd is used for all kill switches. The fd is only read
+ * when the kernel reports events, the state is never queried. As a single
+ * switch can kill several devices (e.g. camera and microphone) events
+ * arriving in quick succession are batched so the status icons get
+ * updated once.
  */
 
 typedef enum {
@@ -73,7 +82,9 @@ struct _PhoshHksManager {
   GObject     parent;
 
   GIOChannel *channel;
-  int         watch_id;
+  guint       watch_id;
+  GList      *pending_events;
+  guint       batch_id;
 
   Hks         mic;
   Hks         camera;
@@ -278,13 +289,24 @@ process_events (PhoshHksManager *self, GList *events)
 }
 
 
+static gboolean
+on_batch_timeout (gpointer data)
+{
+  PhoshHksManager *self = PHOSH_HKS_MANAGER (data);
+  g_autolist (RfKillEvent) events = g_steal_pointer (&self->pending_events);
+
+  self->batch_id = 0;
+  process_events (self, g_list_reverse (events));
+
+  return G_SOURCE_REMOVE;
+}
+
+
 static gboolean
 rfkill_event_cb (GIOChannel      *source,
                  GIOCondition     condition,
                  PhoshHksManager *self)
 {
-  g_autolist (RfKillEvent) events = NULL;
-
   if (condition & G_IO_IN) {
     GIOStatus status;
     RfKillEvent event = { 0 };
@@ -300,7 +322,7 @@ rfkill_event_cb (GIOChannel      *source,
     while (status == G_IO_STATUS_NORMAL && read >= RFKILL_EVENT_SIZE_V1) {
       print_event (&event);
       event_ptr = g_memdup2 (&event, sizeof(event));
-      events = g_list_prepend (events, event_ptr);
+      self->pending_events = g_list_prepend (self->pending_events, event_ptr);
 
       status = g_io_channel_read_chars (source,
                                         (char *) &event,
@@ -308,14 +330,18 @@ rfkill_event_cb (GIOChannel      *source,
                                         &read,
                                         NULL);
     }
-    events = g_list_reverse (events);
   } else {
     g_debug ("Something unexpected happened on rfkill fd");
-    return FALSE;
+    self->watch_id = 0;
+    return G_SOURCE_REMOVE;
   }
 
-  process_events (self, events);
-  return TRUE;
+  if (self->pending_events && !self->batch_id) {
+    self->batch_id = g_timeout_add (HKS_BATCH_TIMEOUT_MS, on_batch_timeout, self);
+    g_source_set_name_by_id (self->batch_id, "[phosh] hks batch");
+  }
+
+  return G_SOURCE_CONTINUE;
 }
 
 
@@ -409,11 +435,13 @@ phosh_hks_manager_dispose (GObject *object)
 {
   PhoshHksManager *self = PHOSH_HKS_MANAGER (object);
 
-  if (self->watch_id > 0) {
-    g_source_remove (self->watch_id);
-    self->watch_id = 0;
+  g_clear_handle_id (&self->batch_id, g_source_remove);
+  g_list_free_full (g_steal_pointer (&self->pending_events), g_free);
+
+  g_clear_handle_id (&self->watch_id, g_source_remove);
+  if (self->channel) {
     g_io_channel_shutdown (self->channel, FALSE, NULL);
-    g_io_channel_unref (self->channel);
+    g_clear_pointer (&self->channel, g_io_channel_unref);
   }
 
   G_OBJECT_CLASS (phosh_hks_manager_parent_class)->dispose (object);
@@ -63,7 +63,8 @@ struct _PhoshHome
   GtkWidget *powerbar;
   GtkWidget *evbox_home_bar;
 
-  guint      debounce_handle;
+  /* The drag handle needs to follow the overview's layout */
+  gboolean   handle_dirty;
   gboolean   focus_app_search;
 
   PhoshHomeState state;
@@ -306,12 +307,22 @@ fold_cb (PhoshHome *self, PhoshOverview *overview)
 
 
 static void
-delayed_handle_resize (gpointer data)
+on_layout_settled (PhoshHome *self)
 {
-  PhoshHome *self = PHOSH_HOME (data);
+  guint handle;
 
-  self->debounce_handle = 0;
-  update_drag_handle (self, TRUE);
+  if (!self->handle_dirty)
+    return;
+
+  handle = phosh_drag_surface_get_drag_handle (PHOSH_DRAG_SURFACE (self));
+  update_drag_handle (self, FALSE);
+  if (handle == phosh_drag_surface_get_drag_handle (PHOSH_DRAG_SURFACE (self))) {
+    self->handle_dirty = FALSE;
+    return;
+  }
+
+  /* Commit the new handle, the layout might still be changing */
+  gtk_widget_queue_draw (GTK_WIDGET (self));
 }
 
 
@@ -320,11 +331,9 @@ on_has_activities_changed (PhoshHome *self)
 {
   g_return_if_fail (PHOSH_IS_HOME (self));
 
-  /* TODO: we need to debounce the handle resize a little until all
-     the queued resizing is done, would be nicer to have that tied to
-     a signal */
-  self->debounce_handle = g_timeout_add_once (200, delayed_handle_resize, self);
-  g_source_set_name_by_id (self->debounce_handle, "[phosh] delayed_handle_resize");
+  /* Update the drag mode right away, the handle once queued resizes are done */
+  update_drag_handle (self, TRUE);
+  self->handle_dirty = TRUE;
 }
 
 
@@ -469,6 +478,28 @@ phosh_home_dragged (PhoshDragSurface *drag_surface, int margin)
 }
 
 
+static void
+prefetch_apps (PhoshHome *self)
+{
+  PhoshAppTracker *app_tracker = phosh_shell_get_app_tracker (phosh_shell_get_default ());
+
+  /* The user is likely about to launch an app */
+  if (app_tracker)
+    phosh_app_tracker_prefetch (app_tracker);
+}
+
+
+static void
+boost_shell (PhoshHome *self, gboolean boost)
+{
+  PhoshAppTracker *app_tracker = phosh_shell_get_app_tracker (phosh_shell_get_default ());
+
+  /* Keep apps from stealing CPU time while the user drags */
+  if (app_tracker)
+    phosh_app_scopes_boost_shell (phosh_app_tracker_get_scopes (app_tracker), boost);
+}
+
+
 static void
 on_drag_state_changed (PhoshHome *self)
 {
@@ -487,6 +518,9 @@ on_drag_state_changed (PhoshHome *self)
       self->focus_app_search = FALSE;
     }
     phosh_home_set_background_alpha (self, 1.0);
+    /* Unfolding without a drag */
+    if (self->state == PHOSH_HOME_STATE_FOLDED)
+      prefetch_apps (self);
     break;
   case PHOSH_DRAG_SURFACE_STATE_FOLDED:
     state = PHOSH_HOME_STATE_FOLDED;
@@ -495,14 +529,18 @@ on_drag_state_changed (PhoshHome *self)
     break;
   case PHOSH_DRAG_SURFACE_STATE_DRAGGED:
     state = PHOSH_HOME_STATE_TRANSITION;
-    if (self->state == PHOSH_HOME_STATE_FOLDED)
+    if (self->state == PHOSH_HOME_STATE_FOLDED) {
       phosh_overview_refresh (PHOSH_OVERVIEW (self->overview));
+      prefetch_apps (self);
+    }
     break;
   default:
     g_return_if_reached ();
     return;
   }
 
+  boost_shell (self, state == PHOSH_HOME_STATE_TRANSITION);
+
   if (self->state != state) {
     self->state = state;
     g_object_notify_by_pspec (G_OBJECT (self), props[PROP_HOME_STATE]);
@@ -609,8 +647,6 @@ phosh_home_dispose (GObject *object)
                                                        self->action_names);
     g_clear_pointer (&self->action_names, g_strfreev);
   }
-  g_clear_handle_id (&self->debounce_handle, g_source_remove);
-
   g_clear_pointer (&self->background, phosh_cp_widget_destroy);
 
   G_OBJECT_CLASS (phosh_home_parent_class)->dispose (object);
@@ -694,6 +730,7 @@ phosh_home_init (PhoshHome *self)
 
   /* Adjust margins and folded state on size changes */
   g_signal_connect (self, "configure-event", G_CALLBACK (on_configure_event), NULL);
+  g_signal_connect (self, "layout-settled", G_CALLBACK (on_layout_settled), NULL);
 
   settings = g_settings_new (PHOSH_SETTINGS);
   g_settings_bind (settings, "osk-unfold-delay",
@@ -0,0 +1,488 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "phosh-icon-cache"
+
+#include "phosh-config.h"
+
+#include "icon-cache.h"
+#include "memory-stats.h"
+#include "util.h"
+
+/**
+ * PhoshIconCache:
+ *
+ * Keeps rendered icons around for the shell's widgets
+ *
+ * The app grid, the overview, splash screens and search results show
+ * the same app icons over and over. `PhoshIconCache` looks up and
+ * renders icons keyed by (icon, size, scale) and holds on to the
+ * resulting `GtkIconInfo`s. As these carry the rendered pixbuf and
+ * the icon theme hands out the very same info for the same lookup,
+ * `GtkImage`s showing a cached icon skip the lookup and the SVG
+ * rasterization. Icons can be prefetched in idle so e.g. the first
+ * opening of the app grid doesn't stall on icon loading. Icons can
+ * also be rendered in a worker thread via
+ * [method@IconCache.load_async].
+ *
+ * The cache is dropped when the icon theme changes.
+ */
+
+typedef struct {
+  GIcon *icon;
+  int    size;
+  int    scale;
+} PhoshIconCacheRequest;
+
+typedef struct {
+  PhoshIconCache *self;
+  char           *key;
+  guint           generation;
+} PhoshIconCacheLoad;
+
+struct _PhoshIconCache {
+  GObject     parent;
+
+  /* "icon:size:scale" → GtkIconInfo, NULL for misses */
+  GHashTable *infos;
+  /* "icon:size:scale" → GPtrArray of GTasks waiting for the icon */
+  GHashTable *loading;
+  /* Bumped when the icon theme changes */
+  guint       generation;
+  /* PhoshIconCacheRequest to prefetch */
+  GQueue      pending;
+  guint       prefetch_id;
+};
+G_DEFINE_TYPE (PhoshIconCache, phosh_icon_cache, G_TYPE_OBJECT)
+
+
+static void
+request_free (PhoshIconCacheRequest *request)
+{
+  g_object_unref (request->icon);
+  g_free (request);
+}
+
+
+static void
+icon_info_unref (gpointer data)
+{
+  if (data)
+    g_object_unref (data);
+}
+
+
+static char *
+get_key (GIcon *icon, int size, int scale)
+{
+  g_autofree char *str = g_icon_to_string (icon);
+
+  /* Not serializable so we can't tell if it's the same icon */
+  if (str == NULL)
+    return NULL;
+
+  return g_strdup_printf ("%s:%d:%d", str, size, scale);
+}
+
+
+static GtkIconInfo *
+lookup_icon (GIcon *icon, int size, int scale)
+{
+  /* Match the flags GtkImage uses for icons with a pixel size */
+  GtkIconLookupFlags flags = GTK_ICON_LOOKUP_USE_BUILTIN | GTK_ICON_LOOKUP_FORCE_SIZE;
+
+  if (gtk_widget_get_default_direction () == GTK_TEXT_DIR_RTL)
+    flags |= GTK_ICON_LOOKUP_DIR_RTL;
+  else
+    flags |= GTK_ICON_LOOKUP_DIR_LTR;
+
+  return gtk_icon_theme_lookup_by_gicon_for_scale (gtk_icon_theme_get_default (),
+                                                   icon, size, scale, flags);
+}
+
+
+static GtkIconInfo *
+load_icon (GIcon *icon, int size, int scale)
+{
+  g_autoptr (GdkPixbuf) pixbuf = NULL;
+  g_autoptr (GError) err = NULL;
+  GtkIconInfo *info;
+
+  info = lookup_icon (icon, size, scale);
+  if (info == NULL)
+    return NULL;
+
+  /* Render now, the info keeps the pixbuf */
+  pixbuf = gtk_icon_info_load_icon (info, &err);
+  if (pixbuf == NULL)
+    g_debug ("Failed to load icon: %s", err->message);
+
+  return info;
+}
+
+
+static GtkIconInfo *
+ensure_icon (PhoshIconCache *self, GIcon *icon, int size, int scale)
+{
+  g_autofree char *key = get_key (icon, size, scale);
+  GtkIconInfo *info;
+
+  if (key == NULL)
+    return NULL;
+
+  if (g_hash_table_lookup_extended (self->infos, key, NULL, (gpointer *)&info))
+    return info;
+
+  info = load_icon (icon, size, scale);
+  /* Remember misses too so we don't look them up over and over */
+  g_hash_table_insert (self->infos, g_steal_pointer (&key), info);
+
+  return info;
+}
+
+
+static void
+on_icon_info_loaded (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+  PhoshIconCacheLoad *load = user_data;
+  PhoshIconCache *self = load->self;
+  GtkIconInfo *info = GTK_ICON_INFO (source_object);
+  g_autoptr (GdkPixbuf) pixbuf = NULL;
+  g_autoptr (GPtrArray) waiters = NULL;
+  g_autoptr (GError) err = NULL;
+
+  /* The info keeps the pixbuf */
+  pixbuf = gtk_icon_info_load_icon_finish (info, res, &err);
+  if (pixbuf == NULL)
+    g_debug ("Failed to load icon: %s", err->message);
+
+  /* Don't cache icons of the previous icon theme */
+  if (load->generation == self->generation)
+    g_hash_table_insert (self->infos, g_strdup (load->key), g_object_ref (info));
+
+  g_hash_table_steal_extended (self->loading, load->key, NULL, (gpointer *)&waiters);
+  for (guint i = 0; waiters && i < waiters->len; i++)
+    g_task_return_boolean (g_ptr_array_index (waiters, i), pixbuf != NULL);
+
+  g_free (load->key);
+  g_object_unref (load->self);
+  g_free (load);
+}
+
+
+static gboolean
+on_prefetch_idle (gpointer data)
+{
+  PhoshIconCache *self = PHOSH_ICON_CACHE (data);
+  PhoshIconCacheRequest *request = g_queue_pop_head (&self->pending);
+
+  /* One icon per main loop iteration to not delay any input */
+  ensure_icon (self, request->icon, request->size, request->scale);
+  request_free (request);
+
+  if (!g_queue_is_empty (&self->pending))
+    return G_SOURCE_CONTINUE;
+
+  g_debug ("Prefetched %u icons", g_hash_table_size (self->infos));
+  self->prefetch_id = 0;
+  return G_SOURCE_REMOVE;
+}
+
+
+static void
+on_icon_theme_changed (PhoshIconCache *self)
+{
+  g_debug ("Icon theme changed, dropping %u icons", g_hash_table_size (self->infos));
+  g_hash_table_remove_all (self->infos);
+  self->generation++;
+}
+
+
+static void
+report_memory (gpointer data, guint64 *n_items, guint64 *bytes)
+{
+  PhoshIconCache *self = PHOSH_ICON_CACHE (data);
+
+  /* Icon infos are small, the pixels are owned by GTK's icon theme */
+  *n_items = g_hash_table_size (self->infos);
+}
+
+
+static void
+phosh_icon_cache_dispose (GObject *object)
+{
+  PhoshIconCache *self = PHOSH_ICON_CACHE (object);
+
+  phosh_memory_stats_unregister (self);
+
+  g_clear_handle_id (&self->prefetch_id, g_source_remove);
+  g_queue_clear_full (&self->pending, (GDestroyNotify) request_free);
+
+  G_OBJECT_CLASS (phosh_icon_cache_parent_class)->dispose (object);
+}
+
+
+static void
+phosh_icon_cache_finalize (GObject *object)
+{
+  PhoshIconCache *self = PHOSH_ICON_CACHE (object);
+
+  g_clear_pointer (&self->infos, g_hash_table_unref);
+  g_clear_pointer (&self->loading, g_hash_table_unref);
+
+  G_OBJECT_CLASS (phosh_icon_cache_parent_class)->finalize (object);
+}
+
+
+static void
+phosh_icon_cache_class_init (PhoshIconCacheClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->dispose = phosh_icon_cache_dispose;
+  object_class->finalize = phosh_icon_cache_finalize;
+}
+
+
+static void
+phosh_icon_cache_init (PhoshIconCache *self)
+{
+  self->infos = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, icon_info_unref);
+  self->loading = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                         g_free, (GDestroyNotify) g_ptr_array_unref);
+  g_queue_init (&self->pending);
+
+  g_signal_connect_object (gtk_icon_theme_get_default (),
+                           "changed",
+                           G_CALLBACK (on_icon_theme_changed),
+                           self,
+                           G_CONNECT_SWAPPED);
+
+  phosh_memory_stats_register ("icon-cache", report_memory, self);
+}
+
+/**
+ * phosh_icon_cache_get_default:
+ *
+ * Returns: (transfer none): The global #PhoshIconCache singleton
+ */
+PhoshIconCache *
+phosh_icon_cache_get_default (void)
+{
+  static PhoshIconCache *instance;
+
+  if (instance == NULL) {
+    instance = g_object_new (PHOSH_TYPE_ICON_CACHE, NULL);
+    g_object_add_weak_pointer (G_OBJECT (instance), (gpointer *) &instance);
+  }
+
+  return instance;
+}
+
+/**
+ * phosh_icon_cache_lookup:
+ * @self: The icon cache
+ * @icon: The icon to look up
+ * @size: The icon size in logical pixels
+ * @scale: The scale factor
+ *
+ * Looks up and renders the given icon unless it's cached already.
+ *
+ * Returns:(transfer none)(nullable): The icon info with the rendered icon
+ */
+GtkIconInfo *
+phosh_icon_cache_lookup (PhoshIconCache *self, GIcon *icon, int size, int scale)
+{
+  g_return_val_if_fail (PHOSH_IS_ICON_CACHE (self), NULL);
+  g_return_val_if_fail (G_IS_ICON (icon), NULL);
+
+  return ensure_icon (self, icon, size, scale);
+}
+
+/**
+ * phosh_icon_cache_peek:
+ * @self: The icon cache
+ * @icon: The icon to look up
+ * @size: The icon size in logical pixels
+ * @scale: The scale factor
+ *
+ * Checks whether the given icon is cached already. Showing a cached
+ * icon doesn't block on the icon theme.
+ *
+ * Returns: `TRUE` if the icon is cached
+ */
+gboolean
+phosh_icon_cache_peek (PhoshIconCache *self, GIcon *icon, int size, int scale)
+{
+  g_autofree char *key = NULL;
+
+  g_return_val_if_fail (PHOSH_IS_ICON_CACHE (self), FALSE);
+  g_return_val_if_fail (G_IS_ICON (icon), FALSE);
+
+  key = get_key (icon, size, scale);
+  if (key == NULL)
+    return FALSE;
+
+  return g_hash_table_contains (self->infos, key);
+}
+
+/**
+ * phosh_icon_cache_load_async:
+ * @self: The icon cache
+ * @icon: The icon to load
+ * @size: The icon size in logical pixels
+ * @scale: The scale factor
+ * @cancellable:(nullable): A cancellable
+ * @callback: The callback to invoke when the icon is cached
+ * @user_data:(nullable): user data
+ *
+ * Looks up the given icon and renders it in a worker thread unless
+ * it's cached already. Concurrent loads of the same icon are only
+ * rendered once.
+ */
+void
+phosh_icon_cache_load_async (PhoshIconCache      *self,
+                             GIcon               *icon,
+                             int                  size,
+                             int                  scale,
+                             GCancellable        *cancellable,
+                             GAsyncReadyCallback  callback,
+                             gpointer             user_data)
+{
+  g_autoptr (GTask) task = NULL;
+  g_autofree char *key = NULL;
+  PhoshIconCacheLoad *load;
+  GtkIconInfo *info;
+  GPtrArray *waiters;
+
+  g_return_if_fail (PHOSH_IS_ICON_CACHE (self));
+  g_return_if_fail (G_IS_ICON (icon));
+
+  task = g_task_new (self, cancellable, callback, user_data);
+  g_task_set_source_tag (task, phosh_icon_cache_load_async);
+
+  key = get_key (icon, size, scale);
+  if (key == NULL) {
+    g_task_return_boolean (task, FALSE);
+    return;
+  }
+
+  if (g_hash_table_lookup_extended (self->infos, key, NULL, (gpointer *)&info)) {
+    g_task_return_boolean (task, info != NULL);
+    return;
+  }
+
+  waiters = g_hash_table_lookup (self->loading, key);
+  if (waiters) {
+    g_ptr_array_add (waiters, g_steal_pointer (&task));
+    return;
+  }
+
+  info = lookup_icon (icon, size, scale);
+  if (info == NULL) {
+    g_hash_table_insert (self->infos, g_steal_pointer (&key), NULL);
+    g_task_return_boolean (task, FALSE);
+    return;
+  }
+
+  waiters = g_ptr_array_new_with_free_func (g_object_unref);
+  g_ptr_array_add (waiters, g_steal_pointer (&task));
+  g_hash_table_insert (self->loading, g_strdup (key), waiters);
+
+  load = g_new0 (PhoshIconCacheLoad, 1);
+  load->self = g_object_ref (self);
+  load->key = g_steal_pointer (&key);
+  load->generation = self->generation;
+  /* Other waiters might still be interested so don't pass on the cancellable */
+  gtk_icon_info_load_icon_async (info, NULL, on_icon_info_loaded, load);
+  g_object_unref (info);
+}
+
+/**
+ * phosh_icon_cache_load_finish:
+ * @self: The icon cache
+ * @res: The async result
+ * @error: The return location for a recoverable error
+ *
+ * Finishes loading an icon started with [method@IconCache.load_async].
+ *
+ * Returns: `TRUE` if the icon is cached and rendered. Otherwise `FALSE`
+ *   with `error` only set if the operation got cancelled.
+ */
+gboolean
+phosh_icon_cache_load_finish (PhoshIconCache *self, GAsyncResult *res, GError **error)
+{
+  g_return_val_if_fail (PHOSH_IS_ICON_CACHE (self), FALSE);
+  g_return_val_if_fail (g_task_is_valid (res, self), FALSE);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (res)) == phosh_icon_cache_load_async, FALSE);
+
+  return g_task_propagate_boolean (G_TASK (res), error);
+}
+
+/**
+ * phosh_icon_cache_prefetch:
+ * @self: The icon cache
+ * @icon: The icon to prefetch
+ * @size: The icon size in logical pixels
+ * @scale: The scale factor
+ *
+ * Queues the icon to be looked up and rendered when the main loop is
+ * idle.
+ */
+void
+phosh_icon_cache_prefetch (PhoshIconCache *self, GIcon *icon, int size, int scale)
+{
+  PhoshIconCacheRequest *request;
+
+  g_return_if_fail (PHOSH_IS_ICON_CACHE (self));
+  g_return_if_fail (G_IS_ICON (icon));
+
+  request = g_new0 (PhoshIconCacheRequest, 1);
+  request->icon = g_object_ref (icon);
+  request->size = size;
+  request->scale = scale;
+  g_queue_push_tail (&self->pending, request);
+
+  if (self->prefetch_id)
+    return;
+
+  self->prefetch_id = g_idle_add_full (G_PRIORITY_LOW, on_prefetch_idle, self, NULL);
+  g_source_set_name_by_id (self->prefetch_id, "[phosh] icon prefetch");
+}
+
+/**
+ * phosh_icon_cache_prefetch_apps:
+ * @self: The icon cache
+ * @apps: A model of apps
+ * @n_items: How many of the model's items to prefetch
+ * @size: The icon size in logical pixels
+ * @scale: The scale factor
+ *
+ * Prefetches the icons of the first `n_items` apps in `apps`. Items
+ * that aren't a `GAppInfo` are skipped.
+ */
+void
+phosh_icon_cache_prefetch_apps (PhoshIconCache *self,
+                                GListModel     *apps,
+                                guint           n_items,
+                                int             size,
+                                int             scale)
+{
+  g_return_if_fail (PHOSH_IS_ICON_CACHE (self));
+  g_return_if_fail (G_IS_LIST_MODEL (apps));
+
+  n_items = MIN (n_items, g_list_model_get_n_items (apps));
+  for (guint i = 0; i < n_items; i++) {
+    g_autoptr (GObject) item = g_list_model_get_item (apps, i);
+    g_autoptr (GIcon) icon = NULL;
+
+    if (!G_IS_APP_INFO (item))
+      continue;
+
+    icon = phosh_util_get_app_icon (G_APP_INFO (item));
+    phosh_icon_cache_prefetch (self, icon, size, scale);
+  }
+}
@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <gtk/gtk.h>
+
+G_BEGIN_DECLS
+
+#define PHOSH_TYPE_ICON_CACHE (phosh_icon_cache_get_type ())
+
+G_DECLARE_FINAL_TYPE (PhoshIconCache, phosh_icon_cache, PHOSH, ICON_CACHE, GObject)
+
+PhoshIconCache *phosh_icon_cache_get_default     (void);
+GtkIconInfo    *phosh_icon_cache_lookup          (PhoshIconCache *self,
+                                                  GIcon          *icon,
+                                                  int             size,
+                                                  int             scale);
+gboolean        phosh_icon_cache_peek            (PhoshIconCache *self,
+                                                  GIcon          *icon,
+                                                  int             size,
+                                                  int             scale);
+void            phosh_icon_cache_load_async      (PhoshIconCache      *self,
+                                                  GIcon               *icon,
+                                                  int                  size,
+                                                  int                  scale,
+                                                  GCancellable        *cancellable,
+                                                  GAsyncReadyCallback  callback,
+                                                  gpointer             user_data);
+gboolean        phosh_icon_cache_load_finish     (PhoshIconCache      *self,
+                                                  GAsyncResult        *res,
+                                                  GError             **error);
+void            phosh_icon_cache_prefetch        (PhoshIconCache *self,
+                                                  GIcon          *icon,
+                                                  int             size,
+                                                  int             scale);
+void            phosh_icon_cache_prefetch_apps   (PhoshIconCache *self,
+                                                  GListModel     *apps,
+                                                  guint           n_items,
+                                                  int             size,
+                                                  int             scale);
+
+G_END_DECLS
@@ -17,6 +17,16 @@
  * PhoshKeyboardEvents:
  *
  * Grabs and manages special keyboard events
+ *
+ * Each action's name is the accelerator it is bound to. Once the
+ * compositor confirmed a grab the action is looked up once and
+ * cached so a key press only needs a single lookup by the
+ * compositor's action id.
+ *
+ * Ungrabs are deferred to an idle callback. Managers update their
+ * bindings by removing and re-adding all of their actions, so
+ * unchanged accelerators keep their grab this way and only changed
+ * ones get grabbed or ungrabbed.
  */
 
 enum {
@@ -26,11 +36,24 @@ enum {
 };
 static guint signals[N_SIGNALS] = { 0 };
 
+typedef struct {
+  char     *accelerator;
+  /* The action bound to the accelerator, NULL while pending ungrab */
+  GAction  *action;
+  gboolean  has_param;
+} PhoshKeyboardEventsGrab;
+
+
 struct _PhoshKeyboardEvents {
   GSimpleActionGroup                   parent;
 
   struct phosh_private_keyboard_event *kbevent;
+  /* action id -> PhoshKeyboardEventsGrab */
   GHashTable                          *accelerators;
+  /* accelerator -> action id */
+  GHashTable                          *action_ids;
+  GHashTable                          *pending_ungrabs;
+  guint                                ungrab_id;
 };
 
 static void initable_iface_init (GInitableIface *iface);
@@ -38,6 +61,36 @@ static void initable_iface_init (GInitableIface *iface);
 G_DEFINE_TYPE_WITH_CODE (PhoshKeyboardEvents, phosh_keyboard_events, G_TYPE_SIMPLE_ACTION_GROUP,
                          G_IMPLEMENT_INTERFACE(G_TYPE_INITABLE, initable_iface_init));
 
+
+static void
+grab_set_action (PhoshKeyboardEventsGrab *grab, GAction *action)
+{
+  g_set_object (&grab->action, action);
+  grab->has_param = action && g_action_get_parameter_type (action);
+}
+
+
+static void
+grab_free (PhoshKeyboardEventsGrab *grab)
+{
+  g_free (grab->accelerator);
+  g_clear_object (&grab->action);
+  g_free (grab);
+}
+
+
+static PhoshKeyboardEventsGrab *
+lookup_grab_by_accelerator (PhoshKeyboardEvents *self, const char *accelerator)
+{
+  gpointer action_id;
+
+  if (!g_hash_table_lookup_extended (self->action_ids, accelerator, NULL, &action_id))
+    return NULL;
+
+  return g_hash_table_lookup (self->accelerators, action_id);
+}
+
+
 static void
 handle_accelerator_activated_event (void *data,
                                     struct phosh_private_keyboard_event *kbevent,
@@ -45,21 +98,19 @@ handle_accelerator_activated_event (void *data,
                                     uint32_t timestamp)
 {
   PhoshKeyboardEvents *self = PHOSH_KEYBOARD_EVENTS (data);
-  const char *action;
-  GVariant *pressed = NULL;
+  PhoshKeyboardEventsGrab *grab;
 
-  action = g_hash_table_lookup (self->accelerators, GUINT_TO_POINTER (action_id));
-  g_return_if_fail (action);
+  grab = g_hash_table_lookup (self->accelerators, GUINT_TO_POINTER (action_id));
+  g_return_if_fail (grab);
 
-  g_debug ("Accelerator %d activated: %s", action_id, action);
+  g_debug ("Accelerator %d activated: %s", action_id, grab->accelerator);
 
-  g_return_if_fail (g_action_group_has_action (G_ACTION_GROUP (self), action));
-  g_signal_emit (self, signals[PRESSED], 0, action);
-
-  if (g_action_group_get_action_parameter_type (G_ACTION_GROUP (self), action))
-    pressed = g_variant_new_boolean (TRUE);
+  /* Action got removed, ungrab is pending */
+  if (grab->action == NULL)
+    return;
 
-  g_action_group_activate_action (G_ACTION_GROUP (self), action, pressed);
+  g_signal_emit (self, signals[PRESSED], 0, grab->accelerator);
+  g_action_activate (grab->action, grab->has_param ? g_variant_new_boolean (TRUE) : NULL);
 }
 
 
@@ -70,21 +121,23 @@ handle_accelerator_released_event (void *data,
                                    uint32_t timestamp)
 {
   PhoshKeyboardEvents *self = PHOSH_KEYBOARD_EVENTS (data);
-  const char *action;
+  PhoshKeyboardEventsGrab *grab;
 
-  action = g_hash_table_lookup (self->accelerators, GUINT_TO_POINTER (action_id));
-  g_return_if_fail (action);
+  grab = g_hash_table_lookup (self->accelerators, GUINT_TO_POINTER (action_id));
+  g_return_if_fail (grab);
 
-  g_debug ("Accelerator %d released: %s", action_id, action);
+  g_debug ("Accelerator %d released: %s", action_id, grab->accelerator);
 
-  g_return_if_fail (g_action_group_has_action (G_ACTION_GROUP (self), action));
-  g_signal_emit (self, signals[RELEASED], 0, action);
+  if (grab->action == NULL)
+    return;
+
+  g_signal_emit (self, signals[RELEASED], 0, grab->accelerator);
 
   /* Action doesn't have a parameter so we only notify press */
-  if (g_action_group_get_action_parameter_type (G_ACTION_GROUP (self), action) == NULL)
+  if (!grab->has_param)
     return;
 
-  g_action_group_activate_action (G_ACTION_GROUP (self), action, g_variant_new_boolean (FALSE));
+  g_action_activate (grab->action, g_variant_new_boolean (FALSE));
 }
 
 
@@ -116,8 +169,23 @@ handle_grab_success_event (void *data,
                            uint32_t action_id)
 {
   PhoshKeyboardEvents *self = PHOSH_KEYBOARD_EVENTS (data);
+  PhoshKeyboardEventsGrab *grab = g_new0 (PhoshKeyboardEventsGrab, 1);
+  GAction *action = NULL;
+
+  gboolean pending = g_hash_table_contains (self->pending_ungrabs, accelerator);
 
-  g_hash_table_insert (self->accelerators, GUINT_TO_POINTER (action_id), g_strdup (accelerator));
+  grab->accelerator = g_strdup (accelerator);
+  /* If removed meanwhile the pending ungrab takes care of it */
+  if (!pending)
+    action = g_action_map_lookup_action (G_ACTION_MAP (self), accelerator);
+  grab_set_action (grab, action);
+
+  g_hash_table_insert (self->action_ids, grab->accelerator, GUINT_TO_POINTER (action_id));
+  g_hash_table_insert (self->accelerators, GUINT_TO_POINTER (action_id), grab);
+
+  /* Removed before the grab completed and after the ungrabs got flushed */
+  if (!action && !pending)
+    phosh_private_keyboard_event_ungrab_accelerator_request (self->kbevent, action_id);
 }
 
 
@@ -127,9 +195,14 @@ handle_ungrab_success_event (void *data,
                              uint32_t action_id)
 {
   PhoshKeyboardEvents *self = PHOSH_KEYBOARD_EVENTS (data);
+  PhoshKeyboardEventsGrab *grab;
 
   g_return_if_fail (PHOSH_IS_KEYBOARD_EVENTS (data));
   g_debug ("Ungrab of %d successful", action_id);
+
+  grab = g_hash_table_lookup (self->accelerators, GUINT_TO_POINTER (action_id));
+  if (grab)
+    g_hash_table_remove (self->action_ids, grab->accelerator);
   g_hash_table_remove (self->accelerators, GUINT_TO_POINTER (action_id));
 }
 
@@ -154,11 +227,46 @@ static const struct phosh_private_keyboard_event_listener keyboard_event_listene
 };
 
 
+static void
+on_ungrab_idle (gpointer data)
+{
+  PhoshKeyboardEvents *self = PHOSH_KEYBOARD_EVENTS (data);
+  GHashTableIter iter;
+  const char *accelerator;
+
+  self->ungrab_id = 0;
+
+  g_hash_table_iter_init (&iter, self->pending_ungrabs);
+  while (g_hash_table_iter_next (&iter, (gpointer *)&accelerator, NULL)) {
+    gpointer action_id;
+
+    if (!g_hash_table_lookup_extended (self->action_ids, accelerator, NULL, &action_id))
+      continue;
+
+    g_debug ("Ungrabbing accelerator %s", accelerator);
+    phosh_private_keyboard_event_ungrab_accelerator_request (self->kbevent,
+                                                             GPOINTER_TO_UINT (action_id));
+  }
+  g_hash_table_remove_all (self->pending_ungrabs);
+}
+
+
 static void
 on_action_added (PhoshKeyboardEvents *self,
                  char                *action_name,
                  GActionGroup        *action_group)
 {
+  PhoshKeyboardEventsGrab *grab;
+
+  if (g_hash_table_remove (self->pending_ungrabs, action_name)) {
+    g_debug ("Keeping grab for accelerator %s", action_name);
+    /* NULL if the grab is still in flight, the grab handler picks up the action */
+    grab = lookup_grab_by_accelerator (self, action_name);
+    if (grab)
+      grab_set_action (grab, g_action_map_lookup_action (G_ACTION_MAP (self), action_name));
+    return;
+  }
+
   g_debug ("Grabbing accelerator %s", action_name);
   phosh_private_keyboard_event_grab_accelerator_request (self->kbevent, action_name);
 }
@@ -169,17 +277,16 @@ on_action_removed (PhoshKeyboardEvents *self,
                    char                *action_name,
                    GActionGroup        *action_group)
 {
-  GHashTableIter iter;
-  gpointer key, value;
+  PhoshKeyboardEventsGrab *grab = lookup_grab_by_accelerator (self, action_name);
 
-  g_debug ("Ungrabbing accelerator %s", action_name);
+  /* Don't activate removed actions while the ungrab is pending */
+  if (grab)
+    grab_set_action (grab, NULL);
 
-  g_hash_table_iter_init (&iter, self->accelerators);
-  while (g_hash_table_iter_next (&iter, &key, &value)) {
-    if (!g_strcmp0 (action_name, value)) {
-      phosh_private_keyboard_event_ungrab_accelerator_request (self->kbevent,
-                                                               GPOINTER_TO_UINT (key));
-    }
+  g_hash_table_add (self->pending_ungrabs, g_strdup (action_name));
+  if (!self->ungrab_id) {
+    self->ungrab_id = g_idle_add_once (on_ungrab_idle, self);
+    g_source_set_name_by_id (self->ungrab_id, "[phosh] keyboard events ungrab");
   }
 }
 
@@ -239,6 +346,7 @@ phosh_keyboard_events_dispose (GObject *object)
 {
   PhoshKeyboardEvents *self = PHOSH_KEYBOARD_EVENTS (object);
 
+  g_clear_handle_id (&self->ungrab_id, g_source_remove);
   g_clear_pointer (&self->kbevent, phosh_private_keyboard_event_destroy);
 
   G_OBJECT_CLASS (phosh_keyboard_events_parent_class)->dispose (object);
@@ -251,6 +359,8 @@ phosh_keyboard_events_finalize (GObject *object)
   PhoshKeyboardEvents *self = PHOSH_KEYBOARD_EVENTS (object);
 
   g_clear_pointer (&self->accelerators, g_hash_table_unref);
+  g_clear_pointer (&self->action_ids, g_hash_table_unref);
+  g_clear_pointer (&self->pending_ungrabs, g_hash_table_unref);
 
   G_OBJECT_CLASS (phosh_keyboard_events_parent_class)->finalize (object);
 }
@@ -300,7 +410,10 @@ phosh_keyboard_events_init (PhoshKeyboardEvents *self)
   self->accelerators = g_hash_table_new_full (g_direct_hash,
                                               g_direct_equal,
                                               NULL,
-                                              g_free);
+                                              (GDestroyNotify) grab_free);
+  /* Keys are owned by the grabs */
+  self->action_ids = g_hash_table_new (g_str_hash, g_str_equal);
+  self->pending_ungrabs = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 }
 
 
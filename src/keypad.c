@@ -24,24 +24,23 @@
  * PIN codes on e.g. a #PhoshLockscreen. It can randomly
  * distribute (shuffle) the digits.
  *
+ * Shuffling only changes the digit each button carries. The buttons
+ * themselves stay attached to the grid so reshuffling doesn't cause
+ * a relayout of the keypad.
+ *
  * # CSS nodes
  *
  * #PhoshKeypad has a single CSS node with name phosh-keypad.
  */
 
 #define NUM_DIGITS 10
-/* Positions of the buttons in the grid we shuffle as x,y coordinates */
-static int btn_pos[NUM_DIGITS][2] = { { 1, 3 },
-                                      { 0, 0 }, { 1, 0 }, { 2, 0 },
-                                      { 0, 1 }, { 1, 1 }, { 2, 1 },
-                                      { 0, 2 }, { 1, 2 }, { 2, 2 }};
 
 typedef struct _PhoshKeypad {
   GtkGrid    parent;
 
   GtkEntry  *entry;
-  /* The digit buttinos 1..9 and 0 */
-  GtkWidget *buttons[10];
+  /* The digit buttons. buttons[i] shows digit i unless shuffled */
+  GtkWidget *buttons[NUM_DIGITS];
 
   gboolean   shuffle;
 } PhoshKeypad;
@@ -145,68 +144,40 @@ phosh_keypad_get_property (GObject    *object,
 
 
 static void
-swap_buttons (PhoshKeypad *self, int pos_a, int pos_b)
+set_digit (GtkWidget *button, int digit)
 {
-  GtkWidget *a, *b;
-
-  int c_a = btn_pos[pos_a][0];
-  int r_a = btn_pos[pos_a][1];
-  int c_b = btn_pos[pos_b][0];
-  int r_b = btn_pos[pos_b][1];
+  GtkLabel *label = GTK_LABEL (gtk_bin_get_child (GTK_BIN (button)));
+  char text[2] = { '0' + digit, '\0' };
 
-  if (pos_a == pos_b)
+  /* Avoid resizes for unchanged labels */
+  if (g_strcmp0 (gtk_label_get_label (label), text) == 0)
     return;
 
-  a = gtk_grid_get_child_at (GTK_GRID (self), c_a, r_a);
-  gtk_container_remove (GTK_CONTAINER (self), a);
-
-  b = gtk_grid_get_child_at (GTK_GRID (self), c_b, r_b);
-  gtk_container_remove (GTK_CONTAINER (self), b);
-
-  gtk_grid_attach (GTK_GRID (self), a, c_b, r_b, 1, 1);
-  gtk_grid_attach (GTK_GRID (self), b, c_a, r_a, 1, 1);
+  gtk_label_set_label (label, text);
 }
 
 
 static void
 distribute_buttons (PhoshKeypad *self, gboolean shuffle)
 {
+  int digits[NUM_DIGITS];
+
+  for (int i = 0; i < NUM_DIGITS; i++)
+    digits[i] = i;
+
   if (shuffle) {
     /* Fisher-Yates shuffle */
-    for (int i = 0; i < NUM_DIGITS-1; i++) {
-        int j = g_random_int_range (i, NUM_DIGITS);
-        swap_buttons (self, i, j);
-    }
-  } else {
-    /* Use sorted positions */
-    for (int i = 0; i < NUM_DIGITS; i++) {
-      GtkWidget *old;
-      int c = btn_pos[i][0];
-      int r = btn_pos[i][1];
-
-      old = gtk_grid_get_child_at (GTK_GRID (self), c, r);
-      gtk_container_remove (GTK_CONTAINER (self), old);
-    }
-
-    for (int i = 0; i < NUM_DIGITS; i++) {
-      int c = btn_pos[i][0];
-      int r = btn_pos[i][1];
+    for (int i = 0; i < NUM_DIGITS - 1; i++) {
+      int j = g_random_int_range (i, NUM_DIGITS);
+      int tmp = digits[i];
 
-      gtk_grid_attach (GTK_GRID (self), self->buttons[i], c, r, 1, 1);
+      digits[i] = digits[j];
+      digits[j] = tmp;
     }
   }
-}
-
-
-static void
-phosh_keypad_dispose (GObject *object)
-{
-  PhoshKeypad *self = PHOSH_KEYPAD (object);
 
   for (int i = 0; i < NUM_DIGITS; i++)
-    g_clear_object (&self->buttons[i]);
-
-  G_OBJECT_CLASS (phosh_keypad_parent_class)->dispose (object);
+    set_digit (self->buttons[i], digits[i]);
 }
 
 
@@ -216,7 +187,6 @@ phosh_keypad_class_init (PhoshKeypadClass *klass)
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
   GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
 
-  object_class->dispose = phosh_keypad_dispose;
   object_class->set_property = phosh_keypad_set_property;
   object_class->get_property = phosh_keypad_get_property;
 
@@ -293,11 +263,6 @@ phosh_keypad_init (PhoshKeypad *self)
 {
   gtk_widget_init_template (GTK_WIDGET (self));
 
-  for (int i = 0; i < NUM_DIGITS; i++) {
-    /* We hold an extra reference since we remove buttons when reordering
-       them and so we don't need to bother then */
-    g_object_ref (self->buttons[i]);
-  }
   distribute_buttons (self, self->shuffle);
 
   gtk_widget_set_direction (GTK_WIDGET (self), GTK_TEXT_DIR_LTR);
@@ -0,0 +1,204 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "phosh-launch-stats"
+
+#include "phosh-config.h"
+
+#include "launch-stats.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * PhoshLaunchStats:
+ *
+ * Accounts app launch latencies per app
+ *
+ * The app tracker reports the time from the start of a launch until
+ * the app used its startup id and until its first toplevel showed
+ * up. The last `MAX_SAMPLES` samples of each kind are kept per app id
+ * so percentiles can be reported.
+ *
+ * As launches are rare compared to frames this is always enabled and
+ * available via the `GetLaunchStats` method of
+ * `mobi.phosh.Shell.DebugControl`.
+ */
+
+#define MAX_SAMPLES 64
+
+typedef struct {
+  gint64  samples[MAX_SAMPLES];
+  guint   n_samples;
+  guint   next;
+  gint64  max;
+} PhoshLaunchStatsSeries;
+
+typedef struct {
+  guint64 launches;
+  guint64 failures;
+  PhoshLaunchStatsSeries series[PHOSH_LAUNCH_STATS_N_KINDS];
+} PhoshLaunchStat;
+
+static const char *kind_names[PHOSH_LAUNCH_STATS_N_KINDS] = {
+  [PHOSH_LAUNCH_STATS_READY] = "ready",
+  [PHOSH_LAUNCH_STATS_TOPLEVEL] = "toplevel",
+};
+
+static struct {
+  /* key: app id, value: PhoshLaunchStat */
+  GHashTable *stats;
+} launch_stats;
+
+
+static PhoshLaunchStat *
+get_stat (const char *app_id)
+{
+  PhoshLaunchStat *stat;
+
+  if (launch_stats.stats == NULL)
+    launch_stats.stats = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+
+  app_id = app_id ?: "(unknown)";
+  stat = g_hash_table_lookup (launch_stats.stats, app_id);
+  if (stat == NULL) {
+    stat = g_new0 (PhoshLaunchStat, 1);
+    g_hash_table_insert (launch_stats.stats, g_strdup (app_id), stat);
+  }
+
+  return stat;
+}
+
+/**
+ * phosh_launch_stats_reset:
+ *
+ * Clear the collected stats.
+ */
+void
+phosh_launch_stats_reset (void)
+{
+  if (launch_stats.stats)
+    g_hash_table_remove_all (launch_stats.stats);
+}
+
+/**
+ * phosh_launch_stats_add_launch:
+ * @app_id: The app's id
+ *
+ * Account the start of a launch of the given app.
+ */
+void
+phosh_launch_stats_add_launch (const char *app_id)
+{
+  get_stat (app_id)->launches++;
+}
+
+/**
+ * phosh_launch_stats_add_failure:
+ * @app_id: The app's id
+ *
+ * Account a failed or timed out launch of the given app.
+ */
+void
+phosh_launch_stats_add_failure (const char *app_id)
+{
+  get_stat (app_id)->failures++;
+}
+
+/**
+ * phosh_launch_stats_add:
+ * @app_id: The app's id
+ * @kind: The kind of duration
+ * @duration: The duration in microseconds
+ *
+ * Add a sample for the given app.
+ */
+void
+phosh_launch_stats_add (const char *app_id, PhoshLaunchStatsKind kind, gint64 duration)
+{
+  PhoshLaunchStatsSeries *series;
+
+  g_return_if_fail (kind < PHOSH_LAUNCH_STATS_N_KINDS);
+
+  series = &get_stat (app_id)->series[kind];
+  series->samples[series->next] = duration;
+  series->next = (series->next + 1) % MAX_SAMPLES;
+  series->n_samples = MIN (series->n_samples + 1, MAX_SAMPLES);
+  series->max = MAX (series->max, duration);
+
+  g_debug ("'%s' %s after %" G_GINT64_FORMAT "us", app_id, kind_names[kind], duration);
+}
+
+
+static int
+cmp_samples (gconstpointer a, gconstpointer b)
+{
+  gint64 sa = *(const gint64 *)a;
+  gint64 sb = *(const gint64 *)b;
+
+  return (sa > sb) - (sa < sb);
+}
+
+
+static GVariant *
+series_to_variant (PhoshLaunchStatsSeries *series)
+{
+  gint64 sorted[MAX_SAMPLES];
+  guint n = series->n_samples;
+
+  if (n == 0)
+    return g_variant_new ("(xxxx)", 0, 0, 0, 0);
+
+  memcpy (sorted, series->samples, n * sizeof (gint64));
+  qsort (sorted, n, sizeof (gint64), cmp_samples);
+
+  return g_variant_new ("(xxxx)",
+                        sorted[(n - 1) * 50 / 100],
+                        sorted[(n - 1) * 90 / 100],
+                        sorted[(n - 1) * 99 / 100],
+                        series->max);
+}
+
+/**
+ * phosh_launch_stats_get:
+ *
+ * Get the collected stats. Keys are app ids, values a dictionary with
+ * the number of launches ("launches"), the number of failed launches
+ * ("failures") and for each kind of duration ("ready" and
+ * "toplevel") the 50th, 90th and 99th percentile and the
+ * maximum. Times are in microseconds.
+ *
+ * Returns:(transfer floating): The stats as `a{sa{sv}}`
+ */
+GVariant *
+phosh_launch_stats_get (void)
+{
+  GVariantBuilder builder;
+  GHashTableIter iter;
+  gpointer key, value;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sa{sv}}"));
+
+  if (launch_stats.stats == NULL)
+    return g_variant_builder_end (&builder);
+
+  g_hash_table_iter_init (&iter, launch_stats.stats);
+  while (g_hash_table_iter_next (&iter, &key, &value)) {
+    PhoshLaunchStat *stat = value;
+    GVariantBuilder props;
+
+    g_variant_builder_init (&props, G_VARIANT_TYPE_VARDICT);
+    g_variant_builder_add (&props, "{sv}", "launches", g_variant_new_uint64 (stat->launches));
+    g_variant_builder_add (&props, "{sv}", "failures", g_variant_new_uint64 (stat->failures));
+    for (int i = 0; i < PHOSH_LAUNCH_STATS_N_KINDS; i++) {
+      g_variant_builder_add (&props, "{sv}", kind_names[i],
+                             series_to_variant (&stat->series[i]));
+    }
+    g_variant_builder_add (&builder, "{sa{sv}}", key, &props);
+  }
+
+  return g_variant_builder_end (&builder);
+}
@@ -0,0 +1,34 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/**
+ * PhoshLaunchStatsKind:
+ * @PHOSH_LAUNCH_STATS_READY: Time from launch until the app used its startup id
+ * @PHOSH_LAUNCH_STATS_TOPLEVEL: Time from launch until the app's first toplevel showed up
+ *
+ * The durations accounted per app.
+ */
+typedef enum {
+  PHOSH_LAUNCH_STATS_READY,
+  PHOSH_LAUNCH_STATS_TOPLEVEL,
+  PHOSH_LAUNCH_STATS_N_KINDS,
+} PhoshLaunchStatsKind;
+
+void      phosh_launch_stats_reset       (void);
+void      phosh_launch_stats_add_launch  (const char           *app_id);
+void      phosh_launch_stats_add_failure (const char           *app_id);
+void      phosh_launch_stats_add         (const char           *app_id,
+                                          PhoshLaunchStatsKind  kind,
+                                          gint64                duration);
+GVariant *phosh_launch_stats_get         (void);
+
+G_END_DECLS
@@ -26,8 +26,18 @@
  *
  * We currently don't own the `com.canonical.Unity` DBus name which is used
  * by clients to refresh their values as most clients don't seem to care.
+ *
+ * Apps can send updates many times a second (e.g. for download progress).
+ * Updates are hence merged per app (latest value wins) and emitted at most
+ * once per frame. Only apps someone is interested in (see
+ * [method@LauncherEntryManager.watch_app]) get updates emitted at all, the
+ * last known info of other apps is available via
+ * [method@LauncherEntryManager.get_info].
  */
 
+/* One frame at 60Hz */
+#define UPDATE_INTERVAL_MS 16
+
 enum {
   INFO_UPDATED,
   N_SIGNALS
@@ -42,11 +52,63 @@ typedef struct _PhoshLauncherEntryManager
   GDBusConnection *session_bus;
 
   GCancellable    *cancel;
+
+  /* app id → a{sv} of the latest values */
+  GHashTable      *entries;
+  /* app id → number of watchers */
+  GHashTable      *watched;
+  /* app ids with updates to emit */
+  GHashTable      *pending;
+  guint            update_id;
 } PhoshLauncherEntryManager;
 
 G_DEFINE_TYPE (PhoshLauncherEntryManager, phosh_launcher_entry_manager, PHOSH_TYPE_MANAGER);
 
 
+static gboolean
+on_update_timeout (gpointer user_data)
+{
+  PhoshLauncherEntryManager *self = PHOSH_LAUNCHER_ENTRY_MANAGER (user_data);
+  g_autoptr (GHashTable) pending = NULL;
+  GHashTableIter iter;
+  const char *app_id;
+
+  self->update_id = 0;
+
+  /* Handlers might trigger new updates */
+  pending = g_steal_pointer (&self->pending);
+  self->pending = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+  g_hash_table_iter_init (&iter, pending);
+  while (g_hash_table_iter_next (&iter, (gpointer *)&app_id, NULL)) {
+    GVariant *properties = g_hash_table_lookup (self->entries, app_id);
+
+    if (properties == NULL || !g_hash_table_contains (self->watched, app_id))
+      continue;
+
+    g_signal_emit (self, signals[INFO_UPDATED], 0, app_id, properties);
+  }
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static GVariant *
+merge_properties (GVariant *old, GVariant *properties)
+{
+  g_auto (GVariantDict) dict = G_VARIANT_DICT_INIT (old);
+  GVariantIter iter;
+  const char *key;
+  GVariant *value;
+
+  g_variant_iter_init (&iter, properties);
+  while (g_variant_iter_loop (&iter, "{&sv}", &key, &value))
+    g_variant_dict_insert_value (&dict, key, value);
+
+  return g_variant_ref_sink (g_variant_dict_end (&dict));
+}
+
+
 static void
 on_update (GDBusConnection *connection,
            const char      *sender_name,
@@ -77,7 +139,19 @@ on_update (GDBusConnection *connection,
 
   g_debug ("%s: %s: %s", object_path, desktop_file, signal_name);
 
-  g_signal_emit (self, signals[INFO_UPDATED], 0, desktop_file, properties);
+  g_hash_table_insert (self->entries,
+                       g_strdup (desktop_file),
+                       merge_properties (g_hash_table_lookup (self->entries, desktop_file),
+                                         properties));
+
+  if (!g_hash_table_contains (self->watched, desktop_file))
+    return;
+
+  g_hash_table_add (self->pending, g_strdup (desktop_file));
+  if (self->update_id == 0) {
+    self->update_id = g_timeout_add (UPDATE_INTERVAL_MS, on_update_timeout, self);
+    g_source_set_name_by_id (self->update_id, "[phosh] launcher entry update");
+  }
 #undef APP_URI_SCHEME
 }
 
@@ -128,6 +202,11 @@ phosh_launcher_entry_manager_finalize (GObject *object)
   g_cancellable_cancel (self->cancel);
   g_clear_object (&self->cancel);
 
+  g_clear_handle_id (&self->update_id, g_source_remove);
+  g_clear_pointer (&self->entries, g_hash_table_unref);
+  g_clear_pointer (&self->watched, g_hash_table_unref);
+  g_clear_pointer (&self->pending, g_hash_table_unref);
+
   if (self->dbus_id) {
     g_dbus_connection_signal_unsubscribe (self->session_bus, self->dbus_id);
     self->dbus_id = 0;
@@ -167,6 +246,10 @@ static void
 phosh_launcher_entry_manager_init (PhoshLauncherEntryManager *self)
 {
   self->cancel = g_cancellable_new ();
+  self->entries = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                         g_free, (GDestroyNotify)g_variant_unref);
+  self->watched = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  self->pending = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 }
 
 
@@ -175,3 +258,67 @@ phosh_launcher_entry_manager_new (void)
 {
   return g_object_new (PHOSH_TYPE_LAUNCHER_ENTRY_MANAGER, NULL);
 }
+
+
+/**
+ * phosh_launcher_entry_manager_watch_app:
+ * @self: The launcher entry manager
+ * @app_id: The app id (desktop file name) to watch
+ *
+ * Request `info-updated` signals for the given app. Each call must be
+ * balanced by a call to [method@LauncherEntryManager.unwatch_app].
+ */
+void
+phosh_launcher_entry_manager_watch_app (PhoshLauncherEntryManager *self, const char *app_id)
+{
+  guint count;
+
+  g_return_if_fail (PHOSH_IS_LAUNCHER_ENTRY_MANAGER (self));
+  g_return_if_fail (app_id);
+
+  count = GPOINTER_TO_UINT (g_hash_table_lookup (self->watched, app_id));
+  g_hash_table_insert (self->watched, g_strdup (app_id), GUINT_TO_POINTER (count + 1));
+}
+
+/**
+ * phosh_launcher_entry_manager_unwatch_app:
+ * @self: The launcher entry manager
+ * @app_id: The app id (desktop file name) to not watch anymore
+ *
+ * Drop a request made via [method@LauncherEntryManager.watch_app].
+ */
+void
+phosh_launcher_entry_manager_unwatch_app (PhoshLauncherEntryManager *self, const char *app_id)
+{
+  guint count;
+
+  g_return_if_fail (PHOSH_IS_LAUNCHER_ENTRY_MANAGER (self));
+  g_return_if_fail (app_id);
+
+  count = GPOINTER_TO_UINT (g_hash_table_lookup (self->watched, app_id));
+  g_return_if_fail (count > 0);
+
+  if (count == 1)
+    g_hash_table_remove (self->watched, app_id);
+  else
+    g_hash_table_insert (self->watched, g_strdup (app_id), GUINT_TO_POINTER (count - 1));
+}
+
+/**
+ * phosh_launcher_entry_manager_get_info:
+ * @self: The launcher entry manager
+ * @app_id: The app id (desktop file name)
+ *
+ * Get the last known launcher entry properties of an app. This allows
+ * to initialize e.g. newly created launchers.
+ *
+ * Returns:(transfer none)(nullable): The properties as `a{sv}`
+ */
+GVariant *
+phosh_launcher_entry_manager_get_info (PhoshLauncherEntryManager *self, const char *app_id)
+{
+  g_return_val_if_fail (PHOSH_IS_LAUNCHER_ENTRY_MANAGER (self), NULL);
+  g_return_val_if_fail (app_id, NULL);
+
+  return g_hash_table_lookup (self->entries, app_id);
+}
@@ -19,6 +19,12 @@ G_BEGIN_DECLS
 G_DECLARE_FINAL_TYPE (PhoshLauncherEntryManager, phosh_launcher_entry_manager,
                       PHOSH, LAUNCHER_ENTRY_MANAGER, PhoshManager)
 
-PhoshLauncherEntryManager *phosh_launcher_entry_manager_new (void);
+PhoshLauncherEntryManager *phosh_launcher_entry_manager_new         (void);
+void                       phosh_launcher_entry_manager_watch_app   (PhoshLauncherEntryManager *self,
+                                                                     const char                *app_id);
+void                       phosh_launcher_entry_manager_unwatch_app (PhoshLauncherEntryManager *self,
+                                                                     const char                *app_id);
+GVariant                  *phosh_launcher_entry_manager_get_info    (PhoshLauncherEntryManager *self,
+                                                                     const char                *app_id);
 
 G_END_DECLS
@@ -41,10 +41,19 @@ int                               phosh_layer_surface_get_configured_width  (Pho
 int                               phosh_layer_surface_get_configured_height (PhoshLayerSurface *self);
 void                              phosh_layer_surface_set_alpha (PhoshLayerSurface *self,
                                                                  double             alpha);
+void                              phosh_layer_surface_set_solid_color (PhoshLayerSurface *self,
+                                                                       const GdkRGBA     *color);
 void                              phosh_layer_surface_set_stacked_above (PhoshLayerSurface *self,
                                                                          PhoshLayerSurface *target);
 void                              phosh_layer_surface_set_stacked_below (PhoshLayerSurface *self,
                                                                          PhoshLayerSurface *target);
 gpointer                          phosh_layer_surface_get_wl_output (PhoshLayerSurface *self);
+void                              phosh_layer_surface_mark_input (PhoshLayerSurface *self);
+void                              phosh_layer_surface_log_input_latency (PhoshLayerSurface *self);
+
+void                              phosh_layer_surface_pool_add (PhoshLayerSurface *self);
+PhoshLayerSurface                *phosh_layer_surface_pool_take (GType    type,
+                                                                 gpointer wl_output);
+void                              phosh_layer_surface_pool_clear (void);
 
 G_END_DECLS
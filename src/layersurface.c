@@ -10,9 +10,12 @@
 #define G_LOG_DOMAIN "phosh-layer-surface"
 
 #include "phosh-config.h"
+#include "frame-stats.h"
 #include "layersurface-priv.h"
 #include "phosh-wayland.h"
 #include "phoc-layer-shell-effects-unstable-v1-client-protocol.h"
+#include "startup-timeline.h"
+#include "trace-buffer.h"
 
 #include <gdk/gdkwayland.h>
 
@@ -49,11 +52,24 @@ static GParamSpec *props[LAST_PROP];
 
 enum {
   CONFIGURED,
+  LAYOUT_SETTLED,
   N_SIGNALS
 };
 static guint signals[N_SIGNALS];
 
+/*
+ * Mapping doesn't wait for the compositor. The surface stays frozen
+ * and the effect objects get created once the initial configure
+ * arrived.
+ */
+typedef enum {
+  PHOSH_LAYER_SURFACE_STATE_UNMAPPED,
+  PHOSH_LAYER_SURFACE_STATE_PENDING_CONFIGURE,
+  PHOSH_LAYER_SURFACE_STATE_CONFIGURED,
+} PhoshLayerSurfaceState;
+
 typedef struct {
+  PhoshLayerSurfaceState state;
   struct wl_surface *wl_surface;
   struct zwlr_layer_surface_v1          *layer_surface;
   struct zphoc_alpha_layer_surface_v1   *alpha_surface;
@@ -73,14 +89,76 @@ typedef struct {
   struct wl_output *wl_output;
   /* alpha_layer_surface_v1 */
   double   alpha;
+  /* Whether the opaque region last sent assumed a fully opaque surface */
+  gboolean alpha_opaque;
+  /* Reallocated in the current frame */
+  gboolean layout_pending;
   /* stacked_layer_surface_v1 */
   PhoshLayerSurface *stack_target;
   gboolean stack_above;
+  /* Solid color via wp_single_pixel_buffer_v1 */
+  gboolean solid;
+  GdkRGBA  solid_color;
+  gboolean solid_attached;
+  struct wl_buffer  *solid_buffer;
+  struct wp_viewport *viewport;
+  /* frame stats */
+  gint64   frame_start;
+  gint64   layout_done;
+  gint64   paint_done;
+  gint64   input_time;
+  gint64   commit_time;
+  gint64   commit_input_time;
+  /* trace buffer */
+  gint64   configure_requested;
+  gint64   commit_frame;
 } PhoshLayerSurfacePrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (PhoshLayerSurface, phosh_layer_surface, GTK_TYPE_WINDOW)
 
 
+static void set_alpha (PhoshLayerSurface *self, double alpha);
+static void update_opaque_region (PhoshLayerSurface *self, gboolean commit);
+static void attach_solid (PhoshLayerSurface *self);
+static void phosh_layer_surface_set_stacked (PhoshLayerSurface *self,
+                                             PhoshLayerSurface *target,
+                                             gboolean           above);
+
+
+static void
+on_initial_configure (PhoshLayerSurface *self)
+{
+  PhoshLayerSurfacePrivate *priv = phosh_layer_surface_get_instance_private (self);
+  PhoshWayland *wl = phosh_wayland_get_default ();
+  struct zphoc_layer_shell_effects_v1 *layer_shell_effects;
+
+  priv->state = PHOSH_LAYER_SURFACE_STATE_CONFIGURED;
+
+  layer_shell_effects = phosh_wayland_get_zphoc_layer_shell_effects_v1 (wl);
+  priv->alpha_surface =
+    zphoc_layer_shell_effects_v1_get_alpha_layer_surface (layer_shell_effects,
+                                                          priv->layer_surface);
+  priv->stacked_surface =
+    zphoc_layer_shell_effects_v1_get_stacked_layer_surface (layer_shell_effects,
+                                                            priv->layer_surface);
+
+  /* Catch up with alpha values set before the surface got configured */
+  if (!G_APPROX_VALUE (priv->alpha, 1.0, FLT_EPSILON))
+    set_alpha (self, priv->alpha);
+
+  /* Catch up with stackings set before the surface got configured */
+  if (priv->stacked_surface)
+    phosh_layer_surface_set_stacked (self, priv->stack_target, priv->stack_above);
+
+  /* Solid surfaces keep GTK from drawing and attach a single pixel instead */
+  if (priv->solid)
+    attach_solid (self);
+
+  /* Now that the configure is acked GTK may attach buffers */
+  gdk_window_thaw_updates (gtk_widget_get_window (GTK_WIDGET (self)));
+}
+
+
 static void
 layer_surface_configure (void                         *data,
                          struct zwlr_layer_surface_v1 *surface,
@@ -90,12 +168,17 @@ layer_surface_configure (void                         *data,
 {
   PhoshLayerSurface *self = data;
   PhoshLayerSurfacePrivate *priv;
-  gboolean changed = FALSE;
+  gboolean changed = FALSE, initial;
+  gint64 trace_start = 0;
 
   g_return_if_fail (PHOSH_IS_LAYER_SURFACE (self));
+  if (phosh_trace_buffer_is_enabled (PHOSH_TRACE_CATEGORY_LAYER_SURFACE))
+    trace_start = g_get_monotonic_time ();
+
   priv = phosh_layer_surface_get_instance_private (self);
   gtk_window_resize (GTK_WINDOW (self), width, height);
   zwlr_layer_surface_v1_ack_configure (surface, serial);
+  initial = priv->state == PHOSH_LAYER_SURFACE_STATE_PENDING_CONFIGURE;
 
   if (priv->configured_height != height) {
     priv->configured_height = height;
@@ -109,9 +192,28 @@ layer_surface_configure (void                         *data,
     g_object_notify_by_pspec (G_OBJECT (self), props[PROP_CONFIGURED_WIDTH]);
   }
 
+  if (initial)
+    on_initial_configure (self);
+  else if (changed && priv->solid_attached)
+    attach_solid (self);
+
   g_debug ("Configured '%s' (%p) (%dx%d)", priv->namespace, self, width, height);
-  if (changed)
+  /* Surfaces stacked relative to us wait for the initial configure too */
+  if (changed || initial)
     g_signal_emit (self, signals[CONFIGURED], 0);
+
+  if (trace_start) {
+    phosh_trace_buffer_add (PHOSH_TRACE_CATEGORY_LAYER_SURFACE, priv->namespace,
+                            trace_start, g_get_monotonic_time ());
+    /* The compositor round trip until the surface can be drawn */
+    if (initial && priv->configure_requested) {
+      g_autofree char *name = g_strdup_printf ("%s initial-configure", priv->namespace);
+
+      phosh_trace_buffer_add (PHOSH_TRACE_CATEGORY_LAYER_SURFACE, name,
+                              priv->configure_requested, trace_start);
+    }
+  }
+  priv->configure_requested = 0;
 }
 
 
@@ -143,28 +245,223 @@ static void
 set_alpha (PhoshLayerSurface *self, double alpha)
 {
   PhoshLayerSurfacePrivate *priv = phosh_layer_surface_get_instance_private (self);
+  gboolean opaque = alpha >= 1.0;
 
   priv->alpha = alpha;
 
   if (!priv->alpha_surface)
     return;
 
+  /*
+   * Translucent surfaces must not claim to be opaque. As the region
+   * only depends on whether the surface is fully opaque only update
+   * it when that changes so fades (e.g. during drags) stay cheap.
+   */
+  if (opaque != priv->alpha_opaque) {
+    priv->alpha_opaque = opaque;
+    update_opaque_region (self, TRUE);
+  }
   zphoc_alpha_layer_surface_v1_set_alpha (priv->alpha_surface, wl_fixed_from_double (alpha));
   wl_surface_commit (priv->wl_surface);
 }
 
 
+/**
+ * get_opaque_region:
+ * @self: The layer surface
+ *
+ * Figure out which parts of the surface are fully opaque so the
+ * compositor can skip blending them and drawing what's below. We only
+ * look at the surface's own background and rounded corners, content
+ * drawn by child widgets isn't taken into account.
+ *
+ * Returns:(transfer full)(nullable): The opaque region
+ */
+static cairo_region_t *
+get_opaque_region (PhoshLayerSurface *self)
+{
+  PhoshLayerSurfacePrivate *priv = phosh_layer_surface_get_instance_private (self);
+  GtkWidget *widget = GTK_WIDGET (self);
+  GtkStyleContext *context = gtk_widget_get_style_context (widget);
+  cairo_region_t *region;
+  GdkRGBA *color = NULL;
+  int radius = 0, width, height;
+  gboolean opaque;
+
+  if (priv->alpha < 1.0 || gtk_widget_get_opacity (widget) < 1.0)
+    return NULL;
+
+  gtk_style_context_get (context,
+                         gtk_style_context_get_state (context),
+                         GTK_STYLE_PROPERTY_BACKGROUND_COLOR, &color,
+                         GTK_STYLE_PROPERTY_BORDER_RADIUS, &radius,
+                         NULL);
+  opaque = priv->solid_attached ? priv->solid_color.alpha >= 1.0 : color->alpha >= 1.0;
+  gdk_rgba_free (color);
+  if (!opaque)
+    return NULL;
+
+  width = gtk_widget_get_allocated_width (widget);
+  height = gtk_widget_get_allocated_height (widget);
+  if (width <= 0 || height <= 0)
+    return NULL;
+
+  region = cairo_region_create_rectangle (&(cairo_rectangle_int_t) { 0, 0, width, height });
+  if (radius > 0 && !priv->solid_attached) {
+    radius = MIN (radius, MIN (width, height) / 2);
+    cairo_region_subtract_rectangle (region, &(cairo_rectangle_int_t) {
+        0, 0, radius, radius });
+    cairo_region_subtract_rectangle (region, &(cairo_rectangle_int_t) {
+        width - radius, 0, radius, radius });
+    cairo_region_subtract_rectangle (region, &(cairo_rectangle_int_t) {
+        0, height - radius, radius, radius });
+    cairo_region_subtract_rectangle (region, &(cairo_rectangle_int_t) {
+        width - radius, height - radius, radius, radius });
+  }
+
+  return region;
+}
+
+
+/**
+ * update_opaque_region:
+ * @self: The layer surface
+ * @commit: Whether the region is committed by us rather than GTK
+ *
+ * GTK applies the opaque region with the next frame it draws. Surfaces
+ * not drawn by GTK (e.g. single pixel buffers) or changes that need to
+ * go out with our own commit (like alpha changes) set it right away.
+ */
+static void
+update_opaque_region (PhoshLayerSurface *self, gboolean commit)
+{
+  PhoshLayerSurfacePrivate *priv = phosh_layer_surface_get_instance_private (self);
+  GdkWindow *window = gtk_widget_get_window (GTK_WIDGET (self));
+  cairo_region_t *region;
+
+  if (window == NULL)
+    return;
+
+  region = get_opaque_region (self);
+  gdk_window_set_opaque_region (window, region);
+
+  if ((commit || priv->solid_attached) && priv->wl_surface) {
+    struct wl_compositor *compositor;
+    struct wl_region *wl_region = NULL;
+
+    compositor = gdk_wayland_display_get_wl_compositor (gtk_widget_get_display (GTK_WIDGET (self)));
+    if (region) {
+      wl_region = wl_compositor_create_region (compositor);
+      for (int i = 0; i < cairo_region_num_rectangles (region); i++) {
+        cairo_rectangle_int_t rect;
+
+        cairo_region_get_rectangle (region, i, &rect);
+        wl_region_add (wl_region, rect.x, rect.y, rect.width, rect.height);
+      }
+    }
+    wl_surface_set_opaque_region (priv->wl_surface, wl_region);
+    g_clear_pointer (&wl_region, wl_region_destroy);
+  }
+
+  g_clear_pointer (&region, cairo_region_destroy);
+}
+
+
+static void
+attach_solid (PhoshLayerSurface *self)
+{
+  PhoshLayerSurfacePrivate *priv = phosh_layer_surface_get_instance_private (self);
+  PhoshWayland *wl = phosh_wayland_get_default ();
+  struct wp_single_pixel_buffer_manager_v1 *manager;
+  struct wp_viewporter *viewporter;
+  struct wl_buffer *old_buffer;
+  const GdkRGBA *c = &priv->solid_color;
+
+  manager = phosh_wayland_get_wp_single_pixel_buffer_manager_v1 (wl);
+  viewporter = phosh_wayland_get_wp_viewporter (wl);
+  if (manager == NULL || viewporter == NULL)
+    return;
+
+  if (priv->configured_width <= 0 || priv->configured_height <= 0)
+    return;
+
+  if (priv->state != PHOSH_LAYER_SURFACE_STATE_CONFIGURED)
+    return;
+
+  /* GTK must not attach its own buffers while we show the single pixel one */
+  if (!priv->solid_attached) {
+    gdk_window_freeze_updates (gtk_widget_get_window (GTK_WIDGET (self)));
+    priv->solid_attached = TRUE;
+  }
+
+  if (priv->viewport == NULL)
+    priv->viewport = wp_viewporter_get_viewport (viewporter, priv->wl_surface);
+
+  /* Values are premultiplied */
+  old_buffer = priv->solid_buffer;
+  priv->solid_buffer =
+    wp_single_pixel_buffer_manager_v1_create_u32_rgba_buffer (manager,
+                                                              c->red * c->alpha * UINT32_MAX,
+                                                              c->green * c->alpha * UINT32_MAX,
+                                                              c->blue * c->alpha * UINT32_MAX,
+                                                              c->alpha * UINT32_MAX);
+  wp_viewport_set_destination (priv->viewport, priv->configured_width, priv->configured_height);
+  update_opaque_region (self, TRUE);
+  wl_surface_attach (priv->wl_surface, priv->solid_buffer, 0, 0);
+  wl_surface_damage (priv->wl_surface, 0, 0, INT32_MAX, INT32_MAX);
+  wl_surface_commit (priv->wl_surface);
+
+  g_clear_pointer (&old_buffer, wl_buffer_destroy);
+}
+
+
+static void
+detach_solid (PhoshLayerSurface *self)
+{
+  PhoshLayerSurfacePrivate *priv = phosh_layer_surface_get_instance_private (self);
+
+  g_clear_pointer (&priv->viewport, wp_viewport_destroy);
+  g_clear_pointer (&priv->solid_buffer, wl_buffer_destroy);
+
+  if (!priv->solid_attached)
+    return;
+
+  priv->solid_attached = FALSE;
+  /* Let GTK draw the whole surface again */
+  gdk_window_thaw_updates (gtk_widget_get_window (GTK_WIDGET (self)));
+  gtk_widget_queue_draw (GTK_WIDGET (self));
+  update_opaque_region (self, FALSE);
+}
+
+
+static void
+on_stack_target_configured (PhoshLayerSurface *self, PhoshLayerSurface *target)
+{
+  PhoshLayerSurfacePrivate *priv = phosh_layer_surface_get_instance_private (self);
+
+  g_signal_handlers_disconnect_by_func (target, on_stack_target_configured, self);
+
+  if (priv->stack_target != target)
+    return;
+
+  phosh_layer_surface_set_stacked (self, target, priv->stack_above);
+}
+
+
 static void
 phosh_layer_surface_set_stacked (PhoshLayerSurface *self, PhoshLayerSurface *target, gboolean above)
 {
   PhoshLayerSurfacePrivate *priv = phosh_layer_surface_get_instance_private (self);
-  PhoshLayerSurfacePrivate *target_priv = phosh_layer_surface_get_instance_private (target);
+  PhoshLayerSurfacePrivate *target_priv;
 
-  if (priv->stack_target)
+  if (priv->stack_target) {
+    g_signal_handlers_disconnect_by_func (priv->stack_target, on_stack_target_configured, self);
     g_object_remove_weak_pointer (G_OBJECT (priv->stack_target),
                                   (gpointer *)&priv->stack_target);
+  }
 
   priv->stack_target = target;
+  priv->stack_above = above;
 
   if (priv->stack_target) {
     g_object_add_weak_pointer (G_OBJECT (priv->stack_target),
@@ -174,13 +471,18 @@ phosh_layer_surface_set_stacked (PhoshLayerSurface *self, PhoshLayerSurface *tar
     return;
   }
 
+  target_priv = phosh_layer_surface_get_instance_private (target);
   if (priv->stacked_surface == NULL) {
     g_debug ("Trying to stack an unmapped layer surface '%s'", priv->namespace);
     return;
   }
 
   if (target_priv->stacked_surface == NULL) {
-    g_debug ("Trying to stack above an unmapped layer surface '%s'", target_priv->namespace);
+    g_debug ("Stack target '%s' not configured yet", target_priv->namespace);
+    g_signal_connect_object (target, "configured",
+                             G_CALLBACK (on_stack_target_configured),
+                             self,
+                             G_CONNECT_SWAPPED);
     return;
   }
 
@@ -331,6 +633,50 @@ phosh_layer_surface_get_property (GObject    *object,
 }
 
 
+static void
+on_layout_settled (PhoshLayerSurface *self, GdkFrameClock *frame_clock)
+{
+  PhoshLayerSurfacePrivate *priv = phosh_layer_surface_get_instance_private (self);
+
+  g_signal_handlers_disconnect_by_func (frame_clock, on_layout_settled, self);
+  priv->layout_pending = FALSE;
+
+  g_signal_emit (self, signals[LAYOUT_SETTLED], 0);
+}
+
+
+static void
+phosh_layer_surface_size_allocate (GtkWidget *widget, GtkAllocation *allocation)
+{
+  PhoshLayerSurface *self = PHOSH_LAYER_SURFACE (widget);
+  PhoshLayerSurfacePrivate *priv = phosh_layer_surface_get_instance_private (self);
+
+  GTK_WIDGET_CLASS (phosh_layer_surface_parent_class)->size_allocate (widget, allocation);
+
+  /* GtkWindow sets its own (corner unaware) opaque region, override it */
+  update_opaque_region (self, FALSE);
+
+  /* Queued resizes of children end up here too, they're all done by after-paint */
+  if (gtk_widget_get_mapped (widget) && !priv->layout_pending) {
+    priv->layout_pending = TRUE;
+    g_signal_connect_object (gtk_widget_get_frame_clock (widget),
+                             "after-paint",
+                             G_CALLBACK (on_layout_settled),
+                             self,
+                             G_CONNECT_SWAPPED | G_CONNECT_AFTER);
+  }
+}
+
+
+static void
+phosh_layer_surface_style_updated (GtkWidget *widget)
+{
+  GTK_WIDGET_CLASS (phosh_layer_surface_parent_class)->style_updated (widget);
+
+  update_opaque_region (PHOSH_LAYER_SURFACE (widget), FALSE);
+}
+
+
 static void
 phosh_layer_surface_realize (GtkWidget *widget)
 {
@@ -348,13 +694,152 @@ phosh_layer_surface_realize (GtkWidget *widget)
 }
 
 
+static void
+on_first_frame (PhoshLayerSurface *self, GdkFrameClock *frame_clock)
+{
+  PhoshLayerSurfacePrivate *priv = phosh_layer_surface_get_instance_private (self);
+  g_autofree char *name = g_strdup_printf ("%s first-frame", priv->namespace);
+
+  g_signal_handlers_disconnect_by_func (frame_clock, on_first_frame, self);
+  phosh_startup_timeline_mark (name);
+}
+
+
+static void
+on_before_paint (PhoshLayerSurface *self, GdkFrameClock *frame_clock)
+{
+  PhoshLayerSurfacePrivate *priv = phosh_layer_surface_get_instance_private (self);
+  GdkFrameTimings *timings;
+  gint64 presentation_time;
+
+  if (!phosh_frame_stats_get_enabled () &&
+      !phosh_trace_buffer_is_enabled (PHOSH_TRACE_CATEGORY_FRAME))
+    return;
+
+  priv->frame_start = g_get_monotonic_time ();
+
+  if (priv->commit_time == 0)
+    return;
+
+  /* Presentation time is only known once the compositor sent feedback */
+  timings = gdk_frame_clock_get_timings (frame_clock, priv->commit_frame);
+  if (timings == NULL || !gdk_frame_timings_get_complete (timings))
+    return;
+
+  presentation_time = gdk_frame_timings_get_presentation_time (timings);
+  if (presentation_time > priv->commit_time) {
+    phosh_frame_stats_add (priv->namespace,
+                           PHOSH_FRAME_STATS_PRESENTATION,
+                           presentation_time - priv->commit_time);
+    if (priv->commit_input_time) {
+      phosh_frame_stats_add (priv->namespace,
+                             PHOSH_FRAME_STATS_LATENCY,
+                             presentation_time - priv->commit_input_time);
+    }
+  }
+  priv->commit_time = priv->commit_input_time = 0;
+}
+
+
+static void
+on_layout (PhoshLayerSurface *self)
+{
+  PhoshLayerSurfacePrivate *priv = phosh_layer_surface_get_instance_private (self);
+
+  if (priv->frame_start)
+    priv->layout_done = g_get_monotonic_time ();
+}
+
+
+static void
+on_paint (PhoshLayerSurface *self)
+{
+  PhoshLayerSurfacePrivate *priv = phosh_layer_surface_get_instance_private (self);
+
+  if (priv->frame_start)
+    priv->paint_done = g_get_monotonic_time ();
+}
+
+
+static void
+on_after_paint (PhoshLayerSurface *self, GdkFrameClock *frame_clock)
+{
+  PhoshLayerSurfacePrivate *priv = phosh_layer_surface_get_instance_private (self);
+  gint64 now;
+
+  if (priv->frame_start == 0)
+    return;
+
+  /* GDK commits the surface in its after-paint handler which ran before us */
+  now = g_get_monotonic_time ();
+  if (priv->layout_done) {
+    phosh_frame_stats_add (priv->namespace, PHOSH_FRAME_STATS_LAYOUT,
+                           priv->layout_done - priv->frame_start);
+  }
+  if (priv->paint_done) {
+    phosh_frame_stats_add (priv->namespace, PHOSH_FRAME_STATS_PAINT,
+                           priv->paint_done - (priv->layout_done ?: priv->frame_start));
+  }
+  phosh_frame_stats_add (priv->namespace, PHOSH_FRAME_STATS_FRAME, now - priv->frame_start);
+  phosh_trace_buffer_add (PHOSH_TRACE_CATEGORY_FRAME, priv->namespace, priv->frame_start, now);
+
+  if (priv->input_time)
+    phosh_frame_stats_add (priv->namespace, PHOSH_FRAME_STATS_INPUT, now - priv->input_time);
+
+  /* Only paints are committed */
+  if (priv->paint_done) {
+    priv->commit_time = now;
+    priv->commit_input_time = priv->input_time;
+    priv->commit_frame = gdk_frame_clock_get_frame_counter (frame_clock);
+  }
+  priv->input_time = 0;
+
+  priv->frame_start = priv->layout_done = priv->paint_done = 0;
+}
+
+
+static void
+connect_frame_stats (PhoshLayerSurface *self, GdkFrameClock *frame_clock)
+{
+  g_signal_connect_object (frame_clock, "before-paint",
+                           G_CALLBACK (on_before_paint),
+                           self,
+                           G_CONNECT_SWAPPED);
+  /* Run after the handlers doing the actual work */
+  g_signal_connect_object (frame_clock, "layout",
+                           G_CALLBACK (on_layout),
+                           self,
+                           G_CONNECT_SWAPPED | G_CONNECT_AFTER);
+  g_signal_connect_object (frame_clock, "paint",
+                           G_CALLBACK (on_paint),
+                           self,
+                           G_CONNECT_SWAPPED | G_CONNECT_AFTER);
+  g_signal_connect_object (frame_clock, "after-paint",
+                           G_CALLBACK (on_after_paint),
+                           self,
+                           G_CONNECT_SWAPPED | G_CONNECT_AFTER);
+}
+
+
+static void
+disconnect_frame_stats (PhoshLayerSurface *self, GdkFrameClock *frame_clock)
+{
+  PhoshLayerSurfacePrivate *priv = phosh_layer_surface_get_instance_private (self);
+
+  g_signal_handlers_disconnect_by_func (frame_clock, on_before_paint, self);
+  g_signal_handlers_disconnect_by_func (frame_clock, on_layout, self);
+  g_signal_handlers_disconnect_by_func (frame_clock, on_paint, self);
+  g_signal_handlers_disconnect_by_func (frame_clock, on_after_paint, self);
+  priv->frame_start = priv->layout_done = priv->paint_done = 0;
+  priv->input_time = priv->commit_time = priv->commit_input_time = 0;
+}
+
+
 static void
 phosh_layer_surface_map (GtkWidget *widget)
 {
   PhoshLayerSurface *self = PHOSH_LAYER_SURFACE (widget);
   PhoshLayerSurfacePrivate *priv = phosh_layer_surface_get_instance_private (self);
-  PhoshWayland *wl = phosh_wayland_get_default ();
-  struct zphoc_layer_shell_effects_v1 *layer_shell_effects;
 
   GTK_WIDGET_CLASS (phosh_layer_surface_parent_class)->map (widget);
 
@@ -367,6 +852,15 @@ phosh_layer_surface_map (GtkWidget *widget)
   }
   g_debug ("Mapped '%s' (%p)", priv->namespace, self);
 
+  if (phosh_startup_timeline_is_active ()) {
+    g_signal_connect_object (gtk_widget_get_frame_clock (widget),
+                             "after-paint",
+                             G_CALLBACK (on_first_frame),
+                             self,
+                             G_CONNECT_SWAPPED);
+  }
+  connect_frame_stats (self, gtk_widget_get_frame_clock (widget));
+
   priv->layer_surface = zwlr_layer_shell_v1_get_layer_surface (priv->layer_shell,
                                                                priv->wl_surface,
                                                                priv->wl_output,
@@ -384,27 +878,14 @@ phosh_layer_surface_map (GtkWidget *widget)
   zwlr_layer_surface_v1_add_listener (priv->layer_surface,
                                       &layer_surface_listener,
                                       self);
+  if (phosh_trace_buffer_is_enabled (PHOSH_TRACE_CATEGORY_LAYER_SURFACE))
+    priv->configure_requested = g_get_monotonic_time ();
   wl_surface_commit (priv->wl_surface);
 
-  /* Process all pending events, otherwise we end up sending ack configure
-   * to a not yet configured surface */
-  wl_display_roundtrip (gdk_wayland_display_get_wl_display (gdk_display_get_default ()));
-
-  layer_shell_effects = phosh_wayland_get_zphoc_layer_shell_effects_v1 (wl);
-  priv->alpha_surface =
-    zphoc_layer_shell_effects_v1_get_alpha_layer_surface (layer_shell_effects,
-                                                          priv->layer_surface);
-  priv->stacked_surface =
-    zphoc_layer_shell_effects_v1_get_stacked_layer_surface (layer_shell_effects,
-                                                            priv->layer_surface);
-
-  /* Catch up with alpha values set before map */
-  if (!G_APPROX_VALUE (priv->alpha, 1.0, FLT_EPSILON))
-    set_alpha (self, priv->alpha);
-
-  /* Catch up with stackings set before map */
-  if (priv->stacked_surface)
-    phosh_layer_surface_set_stacked (self, priv->stack_target, priv->stack_above);
+  /* Attaching a buffer before the initial configure is acked is a protocol
+   * error so don't let GTK draw until then, see on_initial_configure() */
+  priv->state = PHOSH_LAYER_SURFACE_STATE_PENDING_CONFIGURE;
+  gdk_window_freeze_updates (gtk_widget_get_window (widget));
 }
 
 
@@ -414,6 +895,20 @@ phosh_layer_surface_unmap (GtkWidget *widget)
   PhoshLayerSurface *self = PHOSH_LAYER_SURFACE (widget);
   PhoshLayerSurfacePrivate *priv = phosh_layer_surface_get_instance_private (self);
 
+  disconnect_frame_stats (self, gtk_widget_get_frame_clock (widget));
+  if (priv->layout_pending) {
+    g_signal_handlers_disconnect_by_func (gtk_widget_get_frame_clock (widget),
+                                          on_layout_settled,
+                                          self);
+    priv->layout_pending = FALSE;
+  }
+
+  if (priv->state == PHOSH_LAYER_SURFACE_STATE_PENDING_CONFIGURE)
+    gdk_window_thaw_updates (gtk_widget_get_window (widget));
+  /* Drops the freeze taken for the single pixel buffer */
+  detach_solid (self);
+  priv->state = PHOSH_LAYER_SURFACE_STATE_UNMAPPED;
+
   g_clear_pointer (&priv->alpha_surface, zphoc_alpha_layer_surface_v1_destroy);
   g_clear_pointer (&priv->stacked_surface, zphoc_stacked_layer_surface_v1_destroy);
   g_clear_pointer (&priv->layer_surface, zwlr_layer_surface_v1_destroy);
@@ -460,6 +955,8 @@ phosh_layer_surface_class_init (PhoshLayerSurfaceClass *klass)
   widget_class->realize = phosh_layer_surface_realize;
   widget_class->map = phosh_layer_surface_map;
   widget_class->unmap = phosh_layer_surface_unmap;
+  widget_class->size_allocate = phosh_layer_surface_size_allocate;
+  widget_class->style_updated = phosh_layer_surface_style_updated;
 
   layer_surface_class->configured = phosh_layer_surface_configured_impl;
 
@@ -607,7 +1104,8 @@ phosh_layer_surface_class_init (PhoshLayerSurfaceClass *klass)
    * @self: The #PhoshLayerSurface instance.
    *
    * This signal is emitted once we received the configure event from the
-   * compositor.
+   * compositor. It's emitted on the initial configure after each map and
+   * whenever the configured size changes.
    */
   signals[CONFIGURED] =
     g_signal_new ("configured",
@@ -616,6 +1114,23 @@ phosh_layer_surface_class_init (PhoshLayerSurfaceClass *klass)
                   G_STRUCT_OFFSET (PhoshLayerSurfaceClass, configured),
                   NULL, NULL, NULL,
                   G_TYPE_NONE, 0);
+
+  /**
+   * PhoshLayerSurface::layout-settled
+   * @self: The #PhoshLayerSurface instance.
+   *
+   * This signal is emitted at the end of a frame in which the
+   * surface got allocated, e.g. after a configure or once the
+   * resizes queued by its children got processed. Sizes and positions
+   * of the surface's widgets are up to date at this point.
+   */
+  signals[LAYOUT_SETTLED] =
+    g_signal_new ("layout-settled",
+                  G_TYPE_FROM_CLASS (klass),
+                  G_SIGNAL_RUN_LAST,
+                  0,
+                  NULL, NULL, NULL,
+                  G_TYPE_NONE, 0);
 }
 
 
@@ -625,6 +1140,7 @@ phosh_layer_surface_init (PhoshLayerSurface *self)
   PhoshLayerSurfacePrivate *priv = phosh_layer_surface_get_instance_private (self);
 
   priv->alpha = 1.0;
+  priv->alpha_opaque = TRUE;
 }
 
 
@@ -954,12 +1470,50 @@ phosh_layer_surface_set_alpha (PhoshLayerSurface *self, double alpha)
 
   g_return_if_fail (alpha >= 0.0 && alpha <= 1.0);
 
-  if (G_APPROX_VALUE (priv->alpha, alpha, FLT_EPSILON))
+  /* The compositor only gets 1/256 steps, skip changes it can't show */
+  if (wl_fixed_from_double (priv->alpha) == wl_fixed_from_double (alpha))
     return;
 
   set_alpha (self, alpha);
 }
 
+/**
+ * phosh_layer_surface_set_solid_color:
+ * @self: The layer surface
+ * @color:(nullable): The color or `NULL` to let GTK draw the surface
+ *
+ * Show the surface as a single color. If the compositor supports
+ * `wp_single_pixel_buffer_v1` and `wp_viewporter` a single pixel
+ * buffer is stretched to the surface's size instead of GTK drawing a
+ * full size buffer. The widget's own drawing must then match
+ * `color`, it's used as fallback. Combine with
+ * [method@LayerSurface.set_alpha] for translucency.
+ */
+void
+phosh_layer_surface_set_solid_color (PhoshLayerSurface *self, const GdkRGBA *color)
+{
+  PhoshLayerSurfacePrivate *priv;
+
+  g_return_if_fail (PHOSH_IS_LAYER_SURFACE (self));
+  priv = phosh_layer_surface_get_instance_private (self);
+
+  if (color == NULL) {
+    if (!priv->solid)
+      return;
+
+    priv->solid = FALSE;
+    detach_solid (self);
+    return;
+  }
+
+  if (priv->solid && gdk_rgba_equal (&priv->solid_color, color))
+    return;
+
+  priv->solid = TRUE;
+  priv->solid_color = *color;
+  attach_solid (self);
+}
+
 /**
  * phosh_layer_surface_set_stacked_above:
  * @self: The surface to be stacked
@@ -1005,3 +1559,150 @@ phosh_layer_surface_set_stacked_below (PhoshLayerSurface *self, PhoshLayerSurfac
 
   phosh_layer_surface_set_stacked (self, target, FALSE);
 }
+
+/**
+ * phosh_layer_surface_mark_input:
+ * @self: The surface
+ *
+ * Notes that the compositor sent input (e.g. a drag) the surface
+ * reacts to so the time until the next commit can be accounted in
+ * the frame stats. Only the first input since the last commit counts.
+ */
+void
+phosh_layer_surface_mark_input (PhoshLayerSurface *self)
+{
+  PhoshLayerSurfacePrivate *priv;
+
+  g_return_if_fail (PHOSH_IS_LAYER_SURFACE (self));
+
+  if (!phosh_frame_stats_get_enabled ())
+    return;
+
+  priv = phosh_layer_surface_get_instance_private (self);
+  if (priv->input_time == 0)
+    priv->input_time = g_get_monotonic_time ();
+}
+
+/**
+ * phosh_layer_surface_log_input_latency:
+ * @self: The surface
+ *
+ * Logs percentiles of the latency from input marked via
+ * [method@LayerSurface.mark_input] to the presentation of the
+ * resulting frames when frame stats are enabled.
+ */
+void
+phosh_layer_surface_log_input_latency (PhoshLayerSurface *self)
+{
+  PhoshLayerSurfacePrivate *priv;
+
+  g_return_if_fail (PHOSH_IS_LAYER_SURFACE (self));
+
+  if (!phosh_frame_stats_get_enabled ())
+    return;
+
+  priv = phosh_layer_surface_get_instance_private (self);
+  phosh_frame_stats_log (priv->namespace, PHOSH_FRAME_STATS_LATENCY);
+}
+
+/* Hidden surfaces kept around for reuse, by type */
+static GHashTable *surface_pool;
+
+
+static void
+on_pooled_surface_destroy (PhoshLayerSurface *self)
+{
+  GType type = G_OBJECT_TYPE (self);
+
+  if (surface_pool && g_hash_table_lookup (surface_pool, GSIZE_TO_POINTER (type)) == self)
+    g_hash_table_remove (surface_pool, GSIZE_TO_POINTER (type));
+}
+
+/**
+ * phosh_layer_surface_pool_add:
+ * @self: The surface
+ *
+ * Hides the surface and keeps it for reuse via
+ * [func@LayerSurface.pool_take] instead of destroying it. This keeps
+ * the widget tree alive so showing a transient surface again only
+ * needs a content update and a map. Only one surface per type is
+ * kept, if there's one already `self` is destroyed.
+ */
+void
+phosh_layer_surface_pool_add (PhoshLayerSurface *self)
+{
+  GType type;
+
+  g_return_if_fail (PHOSH_IS_LAYER_SURFACE (self));
+
+  type = G_OBJECT_TYPE (self);
+  if (surface_pool == NULL)
+    surface_pool = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+  if (g_hash_table_contains (surface_pool, GSIZE_TO_POINTER (type))) {
+    gtk_widget_destroy (GTK_WIDGET (self));
+    return;
+  }
+
+  gtk_widget_set_visible (GTK_WIDGET (self), FALSE);
+  g_hash_table_insert (surface_pool, GSIZE_TO_POINTER (type), self);
+  g_signal_connect (self, "destroy", G_CALLBACK (on_pooled_surface_destroy), NULL);
+}
+
+/**
+ * phosh_layer_surface_pool_take:
+ * @type: The type of the surface
+ * @wl_output: The output the surface should be on
+ *
+ * Takes a surface of the given type out of the pool. Surfaces for
+ * other outputs are dropped as the output can't be changed after
+ * construction.
+ *
+ * Returns:(transfer none)(nullable): The hidden surface or %NULL
+ */
+PhoshLayerSurface *
+phosh_layer_surface_pool_take (GType type, gpointer wl_output)
+{
+  PhoshLayerSurface *surface;
+
+  g_return_val_if_fail (g_type_is_a (type, PHOSH_TYPE_LAYER_SURFACE), NULL);
+
+  if (surface_pool == NULL)
+    return NULL;
+
+  surface = g_hash_table_lookup (surface_pool, GSIZE_TO_POINTER (type));
+  if (surface == NULL)
+    return NULL;
+
+  g_hash_table_remove (surface_pool, GSIZE_TO_POINTER (type));
+  g_signal_handlers_disconnect_by_func (surface, on_pooled_surface_destroy, NULL);
+
+  if (phosh_layer_surface_get_wl_output (surface) != wl_output) {
+    g_debug ("Dropping pooled %s for other output", G_OBJECT_TYPE_NAME (surface));
+    gtk_widget_destroy (GTK_WIDGET (surface));
+    return NULL;
+  }
+
+  return surface;
+}
+
+/**
+ * phosh_layer_surface_pool_clear:
+ *
+ * Destroys all pooled surfaces, e.g. when outputs go away.
+ */
+void
+phosh_layer_surface_pool_clear (void)
+{
+  g_autoptr (GList) surfaces = NULL;
+
+  if (surface_pool == NULL)
+    return;
+
+  surfaces = g_hash_table_get_values (surface_pool);
+  /* Destroying removes them from the pool */
+  for (GList *l = surfaces; l; l = l->next)
+    gtk_widget_destroy (GTK_WIDGET (l->data));
+
+  g_clear_pointer (&surface_pool, g_hash_table_destroy);
+}
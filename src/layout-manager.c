@@ -34,6 +34,12 @@ static guint signals[N_SIGNALS] = { 0 };
  *
  * Calculations are done in GTKs coordinates (thus scaled).
  *
+ * The layout only depends on the builtin monitor's geometry, scale
+ * and transform and the display panel's cutouts (which don't change).
+ * It's hence only recomputed when one of these changed and
+ * [signal@LayoutManager::layout-changed] is only emitted when the
+ * result changed.
+ *
  * Since: 0.29.0
  */
 
@@ -51,6 +57,16 @@ struct _PhoshLayoutManager {
   guint                       indicators_box_shift;
 
   PhoshMonitor               *builtin;
+
+  /* The inputs the current layout was computed from */
+  struct {
+    gboolean                  valid;
+    PhoshShellLayout          layout;
+    int                       width;
+    int                       logical_width;
+    float                     scale;
+    PhoshMonitorTransform     transform;
+  } inputs;
 };
 G_DEFINE_TYPE (PhoshLayoutManager, phosh_layout_manager, G_TYPE_OBJECT)
 
@@ -294,6 +310,40 @@ G_GNUC_END_IGNORE_DEPRECATIONS
 }
 
 
+static gboolean
+update_inputs (PhoshLayoutManager *self)
+{
+  int width = 0, logical_width = 0;
+  float scale = 1.0;
+  PhoshMonitorTransform transform = PHOSH_MONITOR_TRANSFORM_NORMAL;
+
+  if (self->builtin) {
+    width = self->builtin->width;
+    logical_width = self->builtin->logical.width;
+    scale = phosh_monitor_get_fractional_scale (self->builtin);
+    transform = phosh_monitor_get_transform (self->builtin);
+  }
+
+  if (self->inputs.valid &&
+      self->inputs.layout == self->layout &&
+      self->inputs.width == width &&
+      self->inputs.logical_width == logical_width &&
+      G_APPROX_VALUE (self->inputs.scale, scale, FLT_EPSILON) &&
+      self->inputs.transform == transform) {
+    return FALSE;
+  }
+
+  self->inputs.valid = TRUE;
+  self->inputs.layout = self->layout;
+  self->inputs.width = width;
+  self->inputs.logical_width = logical_width;
+  self->inputs.scale = scale;
+  self->inputs.transform = transform;
+
+  return TRUE;
+}
+
+
 static void
 update_layout (PhoshLayoutManager *self)
 {
@@ -301,6 +351,9 @@ update_layout (PhoshLayoutManager *self)
   guint corner_shift, clock_box_shift = 0;
   guint network_box_shift = 0, indicators_box_shift = 0;
 
+  if (!update_inputs (self))
+    return;
+
   corner_shift = get_corner_shift (self);
   get_cutout_shifts (self, &network_box_shift, &indicators_box_shift);
   pos = get_clock_pos (self, &clock_box_shift);
@@ -15,14 +15,16 @@
 
 #include "shell-priv.h"
 
+#include <glib/gi18n.h>
+
 /**
  * PhoshLocationInfo:
  *
  * A widget to display the location service status
  *
- * #PhoshLocationInfo indicates if the location service is active.
- * The widgets container should hide the widget if
- * #PhoshLocationInfo:active is %FALSE.
+ * #PhoshLocationInfo indicates if the location service is active
+ * and which app is using it. The widgets container should hide the
+ * widget if #PhoshLocationInfo:active is %FALSE.
  */
 
 enum {
@@ -93,6 +95,24 @@ active_to_icon_name (GBinding     *binding,
 }
 
 
+static void
+on_app_info_changed (PhoshLocationInfo *self)
+{
+  g_autofree char *info = NULL;
+  GAppInfo *app_info = NULL;
+
+  g_object_get (self->manager, "app-info", &app_info, NULL);
+  if (app_info) {
+    /* Translators: %s is the name of an app using location services */
+    info = g_strdup_printf (_("Used by %s"), g_app_info_get_display_name (app_info));
+    g_object_unref (app_info);
+  }
+
+  phosh_status_icon_set_info (PHOSH_STATUS_ICON (self), info);
+  gtk_widget_set_tooltip_text (GTK_WIDGET (self), info);
+}
+
+
 static void
 phosh_location_info_constructed (GObject *object)
 {
@@ -111,6 +131,12 @@ phosh_location_info_constructed (GObject *object)
                                active_to_icon_name,
                                NULL, NULL, NULL);
 
+  g_signal_connect_object (self->manager, "notify::app-info",
+                           G_CALLBACK (on_app_info_changed),
+                           self,
+                           G_CONNECT_SWAPPED);
+  on_app_info_changed (self);
+
   G_OBJECT_CLASS (phosh_location_info_parent_class)->constructed (object);
 }
 
@@ -14,6 +14,7 @@
 #include "geoclue-manager-dbus.h"
 #include "location-manager.h"
 #include "shell-priv.h"
+#include "toplevel-manager.h"
 #include "util.h"
 
 #include <gdesktop-enums.h>
@@ -27,6 +28,11 @@
  * The #PhoshLocationManager provides the agent interface and authorizes
  * clients based on the org.gnome.system.location 'enabled' gsetting. Note
  * the phosh needs to be enabled as agent in geoclue's config.
+ *
+ * To save power the accuracy handed to an app can be capped per app
+ * and the accuracy of all clients can be lowered below the level that
+ * needs GNSS while no app using location is in the foreground. See
+ * the `mobi.phosh.shell.location` schema.
  */
 #define LOCATION_AGENT_DBUS_NAME  "org.freedesktop.GeoClue2.Agent"
 #define LOCATION_AGENT_DBUS_PATH  "/org/freedesktop/GeoClue2/Agent"
@@ -34,6 +40,10 @@
 #define GEOCLUE_SERVICE           "org.freedesktop.GeoClue2"
 #define GEOCLUE_MANAGER_PATH      "/org/freedesktop/GeoClue2/Manager"
 
+#define LOCATION_SCHEMA_ID        "mobi.phosh.shell.location"
+#define LOCATION_KEY_APP_LEVELS   "app-accuracy-levels"
+#define LOCATION_KEY_FOREGROUND   "foreground-only"
+
 /**
  * AccuracyLevel:
  * @LEVEL_NONE: Accuracy level unknown or unset.
@@ -59,6 +69,7 @@ enum {
   PROP_0,
   PROP_ENABLED,
   PROP_ACTIVE,
+  PROP_APP_INFO,
   PROP_LAST_PROP
 };
 static GParamSpec *props[PROP_LAST_PROP];
@@ -69,6 +80,7 @@ typedef struct _PhoshLocationManager {
   PhoshDBusGeoClue2Manager      *manager_proxy;
   guint                          dbus_name_id;
   GSettings                     *location_settings;
+  GSettings                     *settings;
   gboolean                       enabled;
   gboolean                       active;
   GDBusConnection               *connection;
@@ -77,6 +89,15 @@ typedef struct _PhoshLocationManager {
   GtkWidget                     *prompt;
   GDBusMethodInvocation         *invocation;
   AccuracyLevel                  req_level;
+  char                          *req_desktop_id;
+  GDesktopAppInfo               *req_app_info;
+
+  /* desktop id → GDesktopAppInfo of apps granted access */
+  GHashTable                    *authorized;
+  /* Desktop id of the focused app */
+  char                          *activated;
+  char                          *last_authorized;
+  GAppInfo                      *app_info;
 
   GCancellable                  *cancel;
 } PhoshLocationManager;
@@ -91,7 +112,7 @@ G_DEFINE_TYPE_WITH_CODE (PhoshLocationManager,
 
 
 static guint
-get_max_level (PhoshLocationManager *self)
+get_allowed_level (PhoshLocationManager *self)
 {
   gint level = LEVEL_NONE;
 
@@ -124,6 +145,65 @@ get_max_level (PhoshLocationManager *self)
 }
 
 
+static GAppInfo *
+get_foreground_app (PhoshLocationManager *self)
+{
+  if (self->activated == NULL)
+    return NULL;
+
+  return g_hash_table_lookup (self->authorized, self->activated);
+}
+
+
+static guint
+get_max_level (PhoshLocationManager *self)
+{
+  guint level = get_allowed_level (self);
+
+  /* City level doesn't need GNSS */
+  if (g_settings_get_boolean (self->settings, LOCATION_KEY_FOREGROUND) &&
+      get_foreground_app (self) == NULL)
+    level = MIN (level, LEVEL_CITY);
+
+  return level;
+}
+
+
+static AccuracyLevel
+parse_level (const char *level)
+{
+  if (g_strcmp0 (level, "none") == 0)
+    return LEVEL_NONE;
+  if (g_strcmp0 (level, "country") == 0)
+    return LEVEL_COUNTRY;
+  if (g_strcmp0 (level, "city") == 0)
+    return LEVEL_CITY;
+  if (g_strcmp0 (level, "neighborhood") == 0)
+    return LEVEL_NEIGHBORHOOD;
+  if (g_strcmp0 (level, "street") == 0)
+    return LEVEL_STREET;
+  if (g_strcmp0 (level, "exact") == 0)
+    return LEVEL_EXACT;
+
+  g_warning ("Unknown accuracy level '%s'", level);
+  return LEVEL_NONE;
+}
+
+
+static AccuracyLevel
+get_app_level (PhoshLocationManager *self, const char *desktop_id)
+{
+  g_autoptr (GVariant) levels = NULL;
+  const char *level;
+
+  levels = g_settings_get_value (self->settings, LOCATION_KEY_APP_LEVELS);
+  if (!g_variant_lookup (levels, desktop_id, "&s", &level))
+    return LEVEL_EXACT;
+
+  return parse_level (level);
+}
+
+
 static void
 update_accuracy_level (PhoshLocationManager *self, gboolean enabled)
 {
@@ -153,6 +233,9 @@ phosh_location_manager_get_property (GObject    *object,
   case PROP_ACTIVE:
     g_value_set_boolean (value, self->active);
     break;
+  case PROP_APP_INFO:
+    g_value_set_object (value, self->app_info);
+    break;
   default:
     G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     break;
@@ -179,6 +262,69 @@ phosh_location_manager_set_property (GObject      *object,
 }
 
 
+static void
+set_app_info (PhoshLocationManager *self, GAppInfo *app_info)
+{
+  if (!g_set_object (&self->app_info, app_info))
+    return;
+
+  g_debug ("Location used by %s", app_info ? g_app_info_get_id (app_info) : "(none)");
+  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_APP_INFO]);
+}
+
+
+static void
+update_app_info (PhoshLocationManager *self)
+{
+  GAppInfo *app_info = NULL;
+
+  if (self->active) {
+    app_info = get_foreground_app (self);
+    /* Keep what we have when switching to an app not using location */
+    if (app_info == NULL)
+      app_info = self->app_info;
+    if (app_info == NULL && self->last_authorized)
+      app_info = g_hash_table_lookup (self->authorized, self->last_authorized);
+  }
+
+  set_app_info (self, app_info);
+}
+
+
+static void
+on_toplevel_changed (PhoshLocationManager *self, PhoshToplevel *toplevel)
+{
+  g_autofree char *desktop_id = NULL;
+  const char *app_id;
+
+  if (!phosh_toplevel_is_activated (toplevel))
+    return;
+
+  app_id = phosh_toplevel_get_app_id (toplevel);
+  if (app_id) {
+    desktop_id = g_strdup (app_id);
+    if (g_str_has_suffix (desktop_id, ".desktop"))
+      desktop_id[strlen (desktop_id) - strlen (".desktop")] = '\0';
+  }
+
+  if (g_strcmp0 (desktop_id, self->activated) == 0)
+    return;
+
+  g_free (self->activated);
+  self->activated = g_steal_pointer (&desktop_id);
+
+  update_accuracy_level (self, self->enabled);
+  update_app_info (self);
+}
+
+
+static void
+on_settings_changed (PhoshLocationManager *self)
+{
+  update_accuracy_level (self, self->enabled);
+}
+
+
 static void
 on_app_auth_prompt_closed (PhoshLocationManager *self, PhoshAppAuthPrompt *prompt)
 {
@@ -188,6 +334,16 @@ on_app_auth_prompt_closed (PhoshLocationManager *self, PhoshAppAuthPrompt *promp
   g_return_if_fail (PHOSH_IS_APP_AUTH_PROMPT (prompt));
 
   grant_access = phosh_app_auth_prompt_get_grant_access (GTK_WIDGET (prompt));
+  if (grant_access) {
+    g_free (self->last_authorized);
+    self->last_authorized = g_strdup (self->req_desktop_id);
+    g_hash_table_insert (self->authorized,
+                         g_steal_pointer (&self->req_desktop_id),
+                         g_object_ref (self->req_app_info));
+    /* The app might already be focused */
+    update_accuracy_level (self, self->enabled);
+    update_app_info (self);
+  }
 
   g_debug ("Granting access for %p at level %d: %s",
            self->invocation,
@@ -204,6 +360,8 @@ on_app_auth_prompt_closed (PhoshLocationManager *self, PhoshAppAuthPrompt *promp
   self->req_level = LEVEL_NONE;
   self->invocation = NULL;
   self->prompt = NULL;
+  g_clear_object (&self->req_app_info);
+  g_clear_pointer (&self->req_desktop_id, g_free);
 
   return;
 }
@@ -221,11 +379,12 @@ handle_authorize_app (PhoshDBusGeoClue2Agent *object,
   g_autofree char *subtitle = NULL;
 
   g_autoptr (GDesktopAppInfo) app_info = NULL;
-  gint level;
+  gint level, app_level;
 
   g_debug ("Authorizing %s: %d", arg_desktop_id, self->enabled);
 
-  level = get_max_level (self);
+  /* The foreground policy only lowers the accuracy, it doesn't deny access */
+  level = get_allowed_level (self);
   if (arg_req_accuracy_level > level) {
     g_debug ("Req accuracy level %d > max allowed %d", arg_req_accuracy_level, level);
     phosh_dbus_geo_clue2_agent_complete_authorize_app (object,
@@ -235,6 +394,16 @@ handle_authorize_app (PhoshDBusGeoClue2Agent *object,
     return TRUE;
   }
 
+  app_level = get_app_level (self, arg_desktop_id);
+  if (app_level == LEVEL_NONE) {
+    g_debug ("Location access disabled for %s", arg_desktop_id);
+    phosh_dbus_geo_clue2_agent_complete_authorize_app (object,
+                                                       invocation,
+                                                       FALSE,
+                                                       arg_req_accuracy_level);
+    return TRUE;
+  }
+
   desktop_file = g_strjoin (".", arg_desktop_id, "desktop", NULL);
   app_info = g_desktop_app_info_new (desktop_file);
   if (app_info == NULL) {
@@ -261,8 +430,12 @@ handle_authorize_app (PhoshDBusGeoClue2Agent *object,
       arg_req_accuracy_level);
   }
 
-  self->req_level = arg_req_accuracy_level;
+  /* Hand out at most the app's configured level */
+  self->req_level = MIN (arg_req_accuracy_level, app_level);
   self->invocation = invocation;
+  g_free (self->req_desktop_id);
+  self->req_desktop_id = g_strdup (arg_desktop_id);
+  g_set_object (&self->req_app_info, app_info);
   subtitle = g_strdup_printf (_("Allow '%s' to access your location information?"),
                               g_app_info_get_display_name (G_APP_INFO (app_info)));
 
@@ -359,6 +532,7 @@ on_agent_in_use_changed (PhoshLocationManager *self)
 
   self->active = in_use;
   g_object_notify_by_pspec (G_OBJECT (self), props[PROP_ACTIVE]);
+  update_app_info (self);
 }
 
 
@@ -445,6 +619,10 @@ phosh_location_manager_dispose (GObject *object)
     g_dbus_interface_skeleton_unexport (G_DBUS_INTERFACE_SKELETON (self));
 
   g_clear_object (&self->location_settings);
+  g_clear_object (&self->settings);
+  g_clear_object (&self->req_app_info);
+  g_clear_object (&self->app_info);
+  g_clear_pointer (&self->authorized, g_hash_table_unref);
   g_clear_object (&self->manager_proxy);
   g_clear_object (&self->connection);
 
@@ -452,6 +630,19 @@ phosh_location_manager_dispose (GObject *object)
 }
 
 
+static void
+phosh_location_manager_finalize (GObject *object)
+{
+  PhoshLocationManager *self = PHOSH_LOCATION_MANAGER (object);
+
+  g_free (self->req_desktop_id);
+  g_free (self->activated);
+  g_free (self->last_authorized);
+
+  G_OBJECT_CLASS (phosh_location_manager_parent_class)->finalize (object);
+}
+
+
 static void
 phosh_location_manager_constructed (GObject *object)
 {
@@ -459,6 +650,17 @@ phosh_location_manager_constructed (GObject *object)
 
   G_OBJECT_CLASS (phosh_location_manager_parent_class)->constructed (object);
 
+  self->settings = g_settings_new (LOCATION_SCHEMA_ID);
+  g_signal_connect_object (self->settings, "changed",
+                           G_CALLBACK (on_settings_changed),
+                           self,
+                           G_CONNECT_SWAPPED);
+  g_signal_connect_object (phosh_shell_get_toplevel_manager (phosh_shell_get_default ()),
+                           "toplevel-changed",
+                           G_CALLBACK (on_toplevel_changed),
+                           self,
+                           G_CONNECT_SWAPPED);
+
   self->location_settings = g_settings_new ("org.gnome.system.location");
   g_settings_bind (self->location_settings, "enabled",
                    self, "enabled",
@@ -483,6 +685,7 @@ phosh_location_manager_class_init (PhoshLocationManagerClass *klass)
 
   object_class->constructed = phosh_location_manager_constructed;
   object_class->dispose = phosh_location_manager_dispose;
+  object_class->finalize = phosh_location_manager_finalize;
 
   object_class->set_property = phosh_location_manager_set_property;
   object_class->get_property = phosh_location_manager_get_property;
@@ -505,6 +708,16 @@ phosh_location_manager_class_init (PhoshLocationManagerClass *klass)
     g_param_spec_boolean ("active", "", "",
                           FALSE,
                           G_PARAM_READABLE | G_PARAM_STATIC_STRINGS);
+  /**
+   * LocationManager:app-info:
+   *
+   * The app that is most likely using location services. This
+   * prefers the focused app if it got access.
+   */
+  props[PROP_APP_INFO] =
+    g_param_spec_object ("app-info", "", "",
+                         G_TYPE_APP_INFO,
+                         G_PARAM_READABLE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
 
   g_object_class_install_properties (object_class, PROP_LAST_PROP, props);
 }
@@ -514,6 +727,7 @@ static void
 phosh_location_manager_init (PhoshLocationManager *self)
 {
   self->cancel = g_cancellable_new ();
+  self->authorized = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
 }
 
 
@@ -10,6 +10,7 @@
 
 #include "phosh-config.h"
 
+#include "background-cache.h"
 #include "shell-priv.h"
 #include "lockscreen-bg.h"
 #include "style-manager.h"
@@ -21,17 +22,25 @@
 
 #include <gtk/gtk.h>
 
+#define LOCKSCREEN_SCHEMA_ID "sm.puri.phosh.lockscreen"
+#define BLUR_BACKGROUND_KEY  "blur-background"
+
 /**
  * PhoshLockscreenBg:
  *
- * The lockscreen's background
+ * The lockscreen's background. It can optionally be blurred and
+ * dimmed.
  */
 
 struct _PhoshLockscreenBg {
   PhoshLayerSurface     parent;
 
   GdkPixbuf            *pixbuf;
+  /* The pixbuf converted for drawing */
+  cairo_surface_t      *surface;
   PhoshBackgroundImage *bg_image;
+  GCancellable         *cancel_scale;
+  GSettings            *settings;
 
   gboolean              configured;
   gboolean              use_background;
@@ -39,9 +48,31 @@ struct _PhoshLockscreenBg {
 G_DEFINE_TYPE (PhoshLockscreenBg, phosh_lockscreen_bg, PHOSH_TYPE_LAYER_SURFACE)
 
 
+static void
+on_background_cache_scale_ready (GObject *source_object, GAsyncResult *res, gpointer data)
+{
+  g_autoptr (GError) err = NULL;
+  g_autoptr (GdkPixbuf) pixbuf = NULL;
+  PhoshLockscreenBg *self;
+
+  pixbuf = phosh_background_cache_scale_finish (PHOSH_BACKGROUND_CACHE (source_object), res, &err);
+  if (err) {
+    phosh_async_error_warn (err, "Failed to scale lockscreen background");
+    return;
+  }
+
+  self = PHOSH_LOCKSCREEN_BG (data);
+  g_set_object (&self->pixbuf, pixbuf);
+  g_clear_pointer (&self->surface, cairo_surface_destroy);
+  gtk_widget_queue_draw (GTK_WIDGET (self));
+}
+
+
 static void
 update_image (PhoshLockscreenBg *self)
 {
+  const GdkRGBA black = { 0.0, 0.0, 0.0, 1.0 };
+  PhoshBackgroundEffect effect = PHOSH_BACKGROUND_EFFECT_NONE;
   int width, height;
 
   if (!self->configured)
@@ -54,13 +85,24 @@ update_image (PhoshLockscreenBg *self)
 
   g_debug ("Scaling lockscreen background %p to %dx%d", self, width, height);
 
-  g_clear_object (&self->pixbuf);
-  if (self->bg_image) {
-    GdkPixbuf *pixbuf = phosh_background_image_get_pixbuf (self->bg_image);
-    self->pixbuf = phosh_utils_pixbuf_scale_to_min (pixbuf, width, height);
-  }
-
-  gtk_widget_queue_draw (GTK_WIDGET (self));
+  g_cancellable_cancel (self->cancel_scale);
+  g_clear_object (&self->cancel_scale);
+  self->cancel_scale = g_cancellable_new ();
+
+  if (g_settings_get_boolean (self->settings, BLUR_BACKGROUND_KEY))
+    effect = PHOSH_BACKGROUND_EFFECT_BLUR;
+
+  /* Same as the home screen's zoomed background so we can share the result */
+  phosh_background_cache_scale_async (phosh_background_cache_get_default (),
+                                      self->bg_image,
+                                      width,
+                                      height,
+                                      G_DESKTOP_BACKGROUND_STYLE_ZOOM,
+                                      &black,
+                                      effect,
+                                      self->cancel_scale,
+                                      on_background_cache_scale_ready,
+                                      self);
 }
 
 
@@ -96,7 +138,13 @@ phosh_lockscreen_bg_draw (GtkWidget *widget, cairo_t *cr)
   gtk_render_background (context, cr, 0, 0, width, height);
 
   if (self->pixbuf && self->use_background) {
-    gdk_cairo_set_source_pixbuf (cr, self->pixbuf, x, y);
+    /* Convert once instead of on every frame */
+    if (self->surface == NULL) {
+      self->surface = gdk_cairo_surface_create_from_pixbuf (self->pixbuf,
+                                                            1,
+                                                            gtk_widget_get_window (widget));
+    }
+    cairo_set_source_surface (cr, self->surface, x, y);
     cairo_paint (cr);
   }
 
@@ -117,12 +165,28 @@ on_theme_name_changed (PhoshLockscreenBg *self, GParamSpec *pspec, PhoshStyleMan
 }
 
 
+static void
+phosh_lockscreen_bg_unrealize (GtkWidget *widget)
+{
+  PhoshLockscreenBg *self = PHOSH_LOCKSCREEN_BG (widget);
+
+  /* The surface is tied to our window */
+  g_clear_pointer (&self->surface, cairo_surface_destroy);
+
+  GTK_WIDGET_CLASS (phosh_lockscreen_bg_parent_class)->unrealize (widget);
+}
+
+
 static void
 phosh_lockscreen_bg_finalize (GObject *object)
 {
   PhoshLockscreenBg *self = PHOSH_LOCKSCREEN_BG (object);
 
+  g_cancellable_cancel (self->cancel_scale);
+  g_clear_object (&self->cancel_scale);
   g_clear_object (&self->bg_image);
+  g_clear_object (&self->settings);
+  g_clear_pointer (&self->surface, cairo_surface_destroy);
   g_clear_object (&self->pixbuf);
 
   G_OBJECT_CLASS (phosh_lockscreen_bg_parent_class)->finalize (object);
@@ -139,6 +203,7 @@ phosh_lockscreen_bg_class_init (PhoshLockscreenBgClass *klass)
   object_class->finalize = phosh_lockscreen_bg_finalize;
 
   widget_class->draw = phosh_lockscreen_bg_draw;
+  widget_class->unrealize = phosh_lockscreen_bg_unrealize;
 
   layer_surface_class->configured = phosh_lockscreen_bg_configured;
 
@@ -158,6 +223,13 @@ phosh_lockscreen_bg_init (PhoshLockscreenBg *self)
                            G_CALLBACK (on_theme_name_changed),
                            self,
                            G_CONNECT_SWAPPED);
+
+  self->settings = g_settings_new (LOCKSCREEN_SCHEMA_ID);
+  g_signal_connect_object (self->settings,
+                           "changed::" BLUR_BACKGROUND_KEY,
+                           G_CALLBACK (update_image),
+                           self,
+                           G_CONNECT_SWAPPED);
 }
 
 
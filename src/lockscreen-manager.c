@@ -17,6 +17,7 @@
 #include "monitor-manager.h"
 #include "monitor/monitor.h"
 #include "phosh-wayland.h"
+#include "settings-batch.h"
 #include "shell-priv.h"
 #include "util.h"
 
@@ -28,6 +29,13 @@
 #define KEY_PICTURE_URI       "picture-uri"
 #define KEY_PICTURE_OPTIONS   "picture-options"
 
+#define LOCKSCREEN_SETTINGS   "sm.puri.phosh.lockscreen"
+#define KEY_PREBUILD          "prebuild"
+#define PLUGINS_SETTINGS      "sm.puri.phosh.plugins"
+#define KEY_PLUGINS           "lock-screen"
+/* Give unlock animations and app startup some room before building the spare */
+#define PREBUILD_DELAY_S      2
+
 /**
  * PhoshLockscreenManager:
  *
@@ -36,6 +44,10 @@
  * The #PhoshLockscreenManager is responsible for putting the #PhoshLockscreen
  * on the primary output and a #PhoshLockshield on other outputs when the session
  * becomes idle or when invoked explicitly via phosh_lockscreen_manager_set_locked().
+ *
+ * Unless disabled via the `prebuild` setting a spare, unmapped #PhoshLockscreen
+ * is kept around while unlocked so locking only needs to map it. The spare is
+ * rebuilt when the primary monitor or the lock screen plugins change.
  */
 
 enum {
@@ -59,7 +71,14 @@ struct _PhoshLockscreenManager {
   PhoshLockscreen         *lockscreen;     /* phone display lock screen */
   GPtrArray               *shields;        /* other outputs */
 
+  GSettings               *settings;
+  GSettings               *plugin_settings;
+  PhoshLockscreen         *spare;          /* prebuilt, unmapped lock screen */
+  PhoshMonitor            *spare_monitor;  /* the monitor the spare was built for */
+  guint                    prebuild_id;
+
   GSettings               *bg_settings;
+  PhoshSettingsBatch      *bg_settings_batch;
   GFile                   *bg_file;
   GFileMonitor            *bg_file_monitor;
   GDesktopBackgroundStyle  bg_style;
@@ -96,6 +115,8 @@ on_background_cache_fetch_ready (GObject *source_object, GAsyncResult *res, gpoi
   g_set_object (&self->cached_bg_image, image);
   if (self->lockscreen)
     phosh_lockscreen_set_bg_image (self->lockscreen, self->cached_bg_image);
+  if (self->spare)
+    phosh_lockscreen_set_bg_image (self->spare, self->cached_bg_image);
 }
 
 
@@ -194,6 +215,94 @@ on_picture_params_changed (PhoshLockscreenManager *self)
 }
 
 
+static PhoshLockscreen *
+build_lockscreen (PhoshLockscreenManager *self, PhoshMonitor *monitor)
+{
+  PhoshWayland *wl = phosh_wayland_get_default ();
+  PhoshShell *shell = phosh_shell_get_default ();
+  PhoshLockscreen *lockscreen;
+
+  lockscreen = PHOSH_LOCKSCREEN (phosh_lockscreen_new (phosh_shell_get_lockscreen_type (shell),
+                                                       phosh_wayland_get_zwlr_layer_shell_v1 (wl),
+                                                       monitor->wl_output,
+                                                       self->calls_manager));
+  phosh_lockscreen_set_bg_image (lockscreen, self->cached_bg_image);
+
+  return lockscreen;
+}
+
+
+static void schedule_prebuild (PhoshLockscreenManager *self);
+
+
+static void
+drop_spare (PhoshLockscreenManager *self)
+{
+  g_clear_handle_id (&self->prebuild_id, g_source_remove);
+  g_clear_pointer (&self->spare, phosh_cp_widget_destroy);
+
+  if (self->spare_monitor) {
+    PhoshShell *shell = phosh_shell_get_default ();
+
+    g_signal_handlers_disconnect_by_func (shell, schedule_prebuild, self);
+    g_signal_handlers_disconnect_by_func (phosh_shell_get_monitor_manager (shell),
+                                          schedule_prebuild, self);
+    g_clear_object (&self->spare_monitor);
+  }
+}
+
+
+static void
+on_prebuild_timeout (gpointer data)
+{
+  PhoshLockscreenManager *self = PHOSH_LOCKSCREEN_MANAGER (data);
+  PhoshShell *shell = phosh_shell_get_default ();
+  PhoshMonitor *primary_monitor;
+
+  self->prebuild_id = 0;
+
+  if (self->locked || self->locking)
+    return;
+
+  /* Don't compete with the shell's own startup */
+  if (!phosh_shell_is_startup_finished (shell)) {
+    self->prebuild_id = g_timeout_add_seconds_once (PREBUILD_DELAY_S, on_prebuild_timeout, self);
+    g_source_set_name_by_id (self->prebuild_id, "[phosh] lockscreen-manager prebuild");
+    return;
+  }
+
+  primary_monitor = phosh_shell_get_primary_monitor (shell);
+  if (!primary_monitor)
+    return;
+
+  g_debug ("Prebuilding lockscreen for %s", primary_monitor->name);
+  self->spare = build_lockscreen (self, primary_monitor);
+  self->spare_monitor = g_object_ref (primary_monitor);
+
+  /* Rebuild when the spare would end up on the wrong output */
+  g_signal_connect_swapped (shell, "notify::primary-monitor",
+                            G_CALLBACK (schedule_prebuild), self);
+  g_signal_connect_swapped (phosh_shell_get_monitor_manager (shell), "monitor-removed",
+                            G_CALLBACK (schedule_prebuild), self);
+}
+
+
+static void
+schedule_prebuild (PhoshLockscreenManager *self)
+{
+  drop_spare (self);
+
+  if (!g_settings_get_boolean (self->settings, KEY_PREBUILD))
+    return;
+
+  if (self->locked || self->locking)
+    return;
+
+  self->prebuild_id = g_timeout_add_seconds_once (PREBUILD_DELAY_S, on_prebuild_timeout, self);
+  g_source_set_name_by_id (self->prebuild_id, "[phosh] lockscreen-manager prebuild");
+}
+
+
 static void
 on_lockscreen_unlock (PhoshLockscreenManager *self, PhoshLockscreen *lockscreen)
 {
@@ -215,6 +324,8 @@ on_lockscreen_unlock (PhoshLockscreenManager *self, PhoshLockscreen *lockscreen)
   self->locked = FALSE;
   self->active_time = 0;
   g_object_notify_by_pspec (G_OBJECT (self), props[PROP_LOCKED]);
+
+  schedule_prebuild (self);
 }
 
 
@@ -307,26 +418,25 @@ on_monitor_added (PhoshLockscreenManager *self,
 static void
 lock_primary_monitor (PhoshLockscreenManager *self)
 {
-  GType lockscreen_type;
   PhoshMonitor *primary_monitor;
-  PhoshWayland *wl = phosh_wayland_get_default ();
   PhoshShell *shell = phosh_shell_get_default ();
 
-  lockscreen_type = phosh_shell_get_lockscreen_type (shell);
   primary_monitor = phosh_shell_get_primary_monitor (shell);
   g_assert (PHOSH_IS_MONITOR (primary_monitor));
 
   /* The primary output gets the clock, keypad, ... */
-  self->lockscreen = PHOSH_LOCKSCREEN (phosh_lockscreen_new (
-                                         lockscreen_type,
-                                         phosh_wayland_get_zwlr_layer_shell_v1 (wl),
-                                         primary_monitor->wl_output,
-                                         self->calls_manager));
+  if (self->spare && self->spare_monitor == primary_monitor) {
+    g_debug ("Using prebuilt lockscreen");
+    self->lockscreen = g_steal_pointer (&self->spare);
+  } else {
+    self->lockscreen = build_lockscreen (self, primary_monitor);
+  }
+  drop_spare (self);
+
   g_object_connect (self->lockscreen,
                     "swapped-object-signal::lockscreen-unlock", on_lockscreen_unlock, self,
                     "swapped-object-signal::wakeup-output", on_lockscreen_wakeup_output, self,
                     NULL);
-  phosh_lockscreen_set_bg_image (self->lockscreen, self->cached_bg_image);
 
   gtk_widget_set_visible (GTK_WIDGET (self->lockscreen), TRUE);
   /* Old lockscreen gets remove due to `layer_surface_closed` */
@@ -471,6 +581,9 @@ phosh_lockscreen_manager_dispose (GObject *object)
 
   g_clear_pointer (&self->shields, g_ptr_array_unref);
   g_clear_pointer (&self->lockscreen, phosh_cp_widget_destroy);
+  drop_spare (self);
+  g_clear_object (&self->settings);
+  g_clear_object (&self->plugin_settings);
   g_clear_object (&self->calls_manager);
 
   g_cancellable_cancel (self->bg_load_cancel);
@@ -478,6 +591,7 @@ phosh_lockscreen_manager_dispose (GObject *object)
 
   g_clear_object (&self->bg_file_monitor);
   g_clear_object (&self->bg_file);
+  g_clear_object (&self->bg_settings_batch);
   g_clear_object (&self->bg_settings);
   g_clear_object (&self->cached_bg_image);
 
@@ -497,6 +611,8 @@ phosh_lockscreen_manager_constructed (GObject *object)
                            G_CALLBACK (on_calls_call_added),
                            self,
                            G_CONNECT_SWAPPED);
+
+  schedule_prebuild (self);
 }
 
 
@@ -546,15 +662,23 @@ phosh_lockscreen_manager_init (PhoshLockscreenManager *self)
 {
   self->bg_settings = g_settings_new (SCREENSAVER_SETTINGS);
 
-  g_object_connect (self->bg_settings,
-                    "swapped-object-signal::changed::" KEY_PICTURE_URI,
-                    G_CALLBACK (on_picture_params_changed),
-                    self,
-                    "swapped-object-signal::changed::" KEY_PICTURE_OPTIONS,
-                    G_CALLBACK (on_picture_params_changed),
-                    self,
-                    NULL);
+  self->bg_settings_batch = phosh_settings_batch_new (self->bg_settings,
+                                                      KEY_PICTURE_URI,
+                                                      KEY_PICTURE_OPTIONS,
+                                                      NULL);
+  g_signal_connect_object (self->bg_settings_batch, "changed",
+                           G_CALLBACK (on_picture_params_changed),
+                           self,
+                           G_CONNECT_SWAPPED);
   on_picture_params_changed (self);
+
+  self->settings = g_settings_new (LOCKSCREEN_SETTINGS);
+  g_signal_connect_swapped (self->settings, "changed::" KEY_PREBUILD,
+                            G_CALLBACK (schedule_prebuild), self);
+  /* The lock screen only picks up its plugins when built */
+  self->plugin_settings = g_settings_new (PLUGINS_SETTINGS);
+  g_signal_connect_swapped (self->plugin_settings, "changed::" KEY_PLUGINS,
+                            G_CALLBACK (schedule_prebuild), self);
 }
 
 
@@ -9,6 +9,7 @@
 
 #define G_LOG_DOMAIN "phosh-lockscreen"
 
+#include "animation.h"
 #include "auth.h"
 #include "call-notification.h"
 #include "calls-manager.h"
@@ -20,6 +21,7 @@
 #include "notifications/notification-frame.h"
 #include "osk-manager.h"
 #include "shell-priv.h"
+#include "timer-service.h"
 #include "util.h"
 #include "widget-box.h"
 #include "wall-clock-priv.h"
@@ -35,6 +37,7 @@
 
 
 #define LOCKSCREEN_IDLE_SECONDS 5
+#define LOCKSCREEN_IDLE_TOLERANCE 500 /* ms */
 #define LOCKSCREEN_SMALL_DATE_AND_TIME_CLASS "p-small"
 
 #define LOCKSCREEN_SMALL_DISPLAY 700
@@ -103,6 +106,7 @@ typedef struct {
   guint idle_timer;
   gint64 last_input;
   PhoshAuth          *auth;
+  gboolean            authenticating;
   GSettings          *lockscreen_settings;
 
   struct {
@@ -293,6 +297,19 @@ clear_input (PhoshLockscreen *self, gboolean clear_all)
 }
 
 
+static void
+clear_idle_timer (PhoshLockscreen *self)
+{
+  PhoshLockscreenPrivate *priv = phosh_lockscreen_get_instance_private (self);
+
+  if (!priv->idle_timer)
+    return;
+
+  phosh_timer_service_remove_timeout (phosh_timer_service_get_default (), priv->idle_timer);
+  priv->idle_timer = 0;
+}
+
+
 static gboolean
 keypad_check_idle (PhoshLockscreen *self)
 {
@@ -300,7 +317,7 @@ keypad_check_idle (PhoshLockscreen *self)
   gint64 now = g_get_monotonic_time ();
 
   g_assert (PHOSH_IS_LOCKSCREEN (self));
-  if (priv->auth == NULL && now - priv->last_input > LOCKSCREEN_IDLE_SECONDS * 1000 * 1000) {
+  if (!priv->authenticating && now - priv->last_input > LOCKSCREEN_IDLE_SECONDS * 1000 * 1000) {
     phosh_lockscreen_set_page (self, priv->default_page);
     priv->idle_timer = 0;
     return G_SOURCE_REMOVE;
@@ -383,6 +400,7 @@ on_auth_authenticate_ready (GObject *source_object, GAsyncResult *result, gpoint
   gboolean authenticated;
 
   priv = phosh_lockscreen_get_instance_private (self);
+  priv->authenticating = FALSE;
   authenticated = phosh_auth_authenticate_finish (auth, result, &error);
   if (error != NULL) {
     g_warning ("Auth failed unexpected: %s", error->message);
@@ -397,7 +415,6 @@ on_auth_authenticate_ready (GObject *source_object, GAsyncResult *result, gpoint
     phosh_lockscreen_shake_pin_entry (self);
     phosh_keypad_distribute (PHOSH_KEYPAD (priv->keypad));
   }
-  g_clear_object (&priv->auth);
   priv->last_input = g_get_monotonic_time ();
 }
 
@@ -550,17 +567,9 @@ wall_clock_notify_cb (PhoshLockscreen *self,
                       PhoshWallClock  *wall_clock)
 {
   PhoshLockscreenPrivate *priv = phosh_lockscreen_get_instance_private (self);
-  const char *time;
-  g_autofree char *date = NULL;
-  g_autofree char *stripped = NULL;
-
-  time = phosh_wall_clock_get_clock (wall_clock, TRUE);
-
-  stripped = phosh_wall_clock_strip_am_pm (wall_clock, time);
-  gtk_label_set_text (GTK_LABEL (priv->lbl_clock), stripped);
 
-  date = phosh_wall_clock_local_date (wall_clock);
-  gtk_label_set_label (GTK_LABEL (priv->lbl_date), date);
+  gtk_label_set_text (GTK_LABEL (priv->lbl_clock), phosh_wall_clock_get_time_stripped (wall_clock));
+  gtk_label_set_label (GTK_LABEL (priv->lbl_date), phosh_wall_clock_get_local_date (wall_clock));
 }
 
 
@@ -570,7 +579,12 @@ carousel_position_notified_cb (PhoshLockscreen *self,
                                HdyCarousel     *carousel)
 {
   PhoshLockscreenPrivate *priv = phosh_lockscreen_get_instance_private (self);
-  g_clear_handle_id (&priv->idle_timer, g_source_remove);
+
+  clear_idle_timer (self);
+
+  /* The user is heading for the PIN entry, wake up the OSK */
+  if (priv->require_unlock && phosh_lockscreen_get_page (self) != PHOSH_LOCKSCREEN_PAGE_UNLOCK)
+    phosh_osk_manager_prewarm (phosh_shell_get_osk_manager (phosh_shell_get_default ()));
 }
 
 static void
@@ -589,15 +603,22 @@ carousel_page_changed_cb (PhoshLockscreen *self,
 
     if (!priv->idle_timer) {
       priv->last_input = g_get_monotonic_time ();
-      priv->idle_timer = g_timeout_add_seconds (LOCKSCREEN_IDLE_SECONDS,
-                                                (GSourceFunc) keypad_check_idle,
-                                                self);
-      g_source_set_name_by_id (priv->idle_timer, "[PhoshLockscreen] keypad check");
+      /* Checking can wait until the screen is on again */
+      priv->idle_timer = phosh_timer_service_add_timeout (phosh_timer_service_get_default (),
+                                                          LOCKSCREEN_IDLE_SECONDS * 1000,
+                                                          LOCKSCREEN_IDLE_TOLERANCE,
+                                                          (GSourceFunc) keypad_check_idle,
+                                                          self);
     }
     if (!priv->require_unlock) {
       g_signal_emit (self, signals[LOCKSCREEN_UNLOCK], 0);
       return;
     }
+
+    /* Load PAM modules while the user enters the PIN */
+    if (priv->auth == NULL)
+      priv->auth = PHOSH_AUTH (phosh_auth_new ());
+    phosh_auth_prepare (priv->auth);
   } else {
     gtk_widget_set_sensitive (priv->entry_pin, FALSE);
     clear_input (self, TRUE);
@@ -982,7 +1003,7 @@ phosh_lockscreen_dispose (GObject *object)
   PhoshLockscreenPrivate *priv = phosh_lockscreen_get_instance_private (self);
 
   g_clear_object (&priv->notification_settings);
-  g_clear_handle_id (&priv->idle_timer, g_source_remove);
+  clear_idle_timer (self);
   g_clear_object (&priv->calls_manager);
   g_clear_pointer (&priv->active, g_free);
   g_clear_object (&priv->lockscreen_settings);
@@ -1038,6 +1059,7 @@ on_unlock_submit (PhoshLockscreen *self)
 
   if (priv->auth == NULL)
     priv->auth = PHOSH_AUTH (phosh_auth_new ());
+  priv->authenticating = TRUE;
   phosh_auth_authenticate_async (priv->auth,
                                  input,
                                  NULL,
@@ -1294,7 +1316,7 @@ phosh_lockscreen_set_page (PhoshLockscreen *self, PhoshLockscreenPage page)
     break;
   }
 
-  hdy_carousel_scroll_to (HDY_CAROUSEL (priv->carousel), scroll_to);
+  phosh_animation_carousel_scroll_to (HDY_CAROUSEL (priv->carousel), scroll_to);
 }
 
 /**
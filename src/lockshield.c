@@ -10,6 +10,7 @@
 
 #include "phosh-config.h"
 
+#include "layersurface-priv.h"
 #include "lockshield.h"
 
 /**
@@ -19,6 +20,9 @@
  *
  * The #PhoshLockshield is displayed on lock screens
  * which are not the primary one.
+ *
+ * As it's just its background color it's shown as a single pixel
+ * buffer when the compositor allows for that.
  */
 struct _PhoshLockshield
 {
@@ -28,6 +32,23 @@ struct _PhoshLockshield
 G_DEFINE_TYPE(PhoshLockshield, phosh_lockshield, PHOSH_TYPE_LAYER_SURFACE)
 
 
+static void
+phosh_lockshield_style_updated (GtkWidget *widget)
+{
+  GtkStyleContext *context = gtk_widget_get_style_context (widget);
+  GdkRGBA *color = NULL;
+
+  GTK_WIDGET_CLASS (phosh_lockshield_parent_class)->style_updated (widget);
+
+  gtk_style_context_get (context,
+                         gtk_style_context_get_state (context),
+                         GTK_STYLE_PROPERTY_BACKGROUND_COLOR, &color,
+                         NULL);
+  phosh_layer_surface_set_solid_color (PHOSH_LAYER_SURFACE (widget), color);
+  gdk_rgba_free (color);
+}
+
+
 static void
 phosh_lockshield_constructed (GObject *object)
 {
@@ -45,8 +66,10 @@ static void
 phosh_lockshield_class_init (PhoshLockshieldClass *klass)
 {
   GObjectClass *object_class = (GObjectClass *)klass;
+  GtkWidgetClass *widget_class = (GtkWidgetClass *)klass;
 
   object_class->constructed = phosh_lockshield_constructed;
+  widget_class->style_updated = phosh_lockshield_style_updated;
 }
 
 
@@ -11,6 +11,7 @@
 #include "phosh-config.h"
 
 #include "manager.h"
+#include "startup-timeline.h"
 
 /**
  * PhoshManager:
@@ -34,10 +35,17 @@ on_idle (gpointer user_data)
   PhoshManager *self = PHOSH_MANAGER (user_data);
   PhoshManagerClass *klass = PHOSH_MANAGER_GET_CLASS (self);
   PhoshManagerPrivate *priv = phosh_manager_get_instance_private (self);
+  gint64 start = g_get_monotonic_time ();
 
   if (klass->idle_init)
     (*klass->idle_init) (self);
 
+  if (phosh_startup_timeline_is_active ()) {
+    g_autofree char *name = g_strdup_printf ("%s idle-init", G_OBJECT_TYPE_NAME (self));
+
+    phosh_startup_timeline_add_span (name, start);
+  }
+
   priv->idle_id = 0;
 }
 
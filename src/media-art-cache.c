@@ -0,0 +1,449 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "phosh-media-art-cache"
+
+#include "phosh-config.h"
+
+#include "media-art-cache.h"
+#include "memory-stats.h"
+#include "util.h"
+
+#include <math.h>
+
+/* Number of images to keep around */
+#define MAX_ENTRIES 16
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (cairo_t, cairo_destroy)
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (cairo_surface_t, cairo_surface_destroy)
+
+/**
+ * PhoshMediaArtCache:
+ *
+ * A cache of album art ready to be displayed
+ *
+ * Album art is fetched, decoded, scaled to the requested size, centered
+ * and rounded once in a worker thread. All media player widgets
+ * requesting the same URL at the same size then share the resulting
+ * pixbuf. Concurrent requests for the same image are coalesced.
+ */
+
+typedef struct {
+  GList      link;
+  char      *key;
+  GdkPixbuf *pixbuf;
+} PhoshMediaArtCacheEntry;
+
+struct _PhoshMediaArtCache {
+  GObject     parent;
+
+  /* key: cache key, value: PhoshMediaArtCacheEntry */
+  GHashTable *entries;
+  /* Most recently used first */
+  GQueue      lru;
+  /* key: cache key, value: GPtrArray of waiting GTasks */
+  GHashTable *pending;
+};
+G_DEFINE_TYPE (PhoshMediaArtCache, phosh_media_art_cache, G_TYPE_OBJECT)
+
+typedef struct {
+  char *url;
+  int   size;
+} LoadData;
+
+
+static void
+load_data_free (LoadData *data)
+{
+  g_free (data->url);
+  g_free (data);
+}
+
+
+static void
+entry_free (PhoshMediaArtCacheEntry *entry)
+{
+  g_free (entry->key);
+  g_clear_object (&entry->pixbuf);
+  g_free (entry);
+}
+
+
+static char *
+get_key (const char *url, int size)
+{
+  /* Don't keep whole images around as keys */
+  if (g_strcmp0 (g_uri_peek_scheme (url), "data") == 0) {
+    g_autofree char *checksum = g_compute_checksum_for_string (G_CHECKSUM_SHA256, url, -1);
+
+    return g_strdup_printf ("%d:data:%s", size, checksum);
+  }
+
+  return g_strdup_printf ("%d:%s", size, url);
+}
+
+
+static GdkPixbuf *
+center_pixbuf (GdkPixbuf *pixbuf)
+{
+  int width, height, size;
+  g_autoptr (cairo_t) cr = NULL;
+  g_autoptr (cairo_surface_t) surface = NULL;
+
+  g_return_val_if_fail (GDK_IS_PIXBUF (pixbuf), NULL);
+
+  width = gdk_pixbuf_get_width (pixbuf);
+  height = gdk_pixbuf_get_height (pixbuf);
+
+  if (width == height)
+    return g_object_ref (pixbuf);
+
+  size = MAX (width, height);
+  /* gdk_pixbuf_copy_area would work as well but that goes via gdk_pixbuf_scale, …*/
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, size, size);
+  cr = cairo_create (surface);
+  if (width > height)
+    gdk_cairo_set_source_pixbuf (cr, pixbuf, 0, (width - height) / 2.0);
+  else
+    gdk_cairo_set_source_pixbuf (cr, pixbuf, (height - width) / 2.0, 0);
+  cairo_paint (cr);
+
+  return gdk_pixbuf_get_from_surface (surface, 0, 0, size, size);
+}
+
+
+static GdkPixbuf *
+round_corners (GdkPixbuf *pixbuf)
+{
+  g_autoptr (cairo_t) cr = NULL;
+  g_autoptr (cairo_surface_t) surface = NULL;
+  int width, height, size;
+  double radius;
+  const double degrees = M_PI / 180.0;
+
+  g_return_val_if_fail (GDK_IS_PIXBUF (pixbuf), NULL);
+
+  width = gdk_pixbuf_get_width (pixbuf);
+  height = gdk_pixbuf_get_height (pixbuf);
+
+  /* We only round square images */
+  g_return_val_if_fail (width == height, NULL);
+
+  size = width;
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, size, size);
+  cr = cairo_create (surface);
+
+  radius = size / 8.0;
+  cairo_new_path (cr);
+  cairo_arc (cr, size - radius, radius, radius, -90 * degrees, 0 * degrees);
+  cairo_arc (cr, size - radius, size - radius, radius, 0 * degrees, 90 * degrees);
+  cairo_arc (cr, radius, size - radius, radius, 90 * degrees, 180 * degrees);
+  cairo_arc (cr, radius, radius, radius, 180 * degrees, 270 * degrees);
+  cairo_close_path (cr);
+  cairo_clip (cr);
+
+  gdk_cairo_set_source_pixbuf (cr, pixbuf, 0, 0);
+  cairo_paint (cr);
+
+  return gdk_pixbuf_get_from_surface (surface, 0, 0, size, size);
+}
+
+
+static GdkPixbuf *
+load_pixbuf (const char *url, int size, GCancellable *cancellable, GError **error)
+{
+  const char *scheme = g_uri_peek_scheme (url);
+
+  if (g_strcmp0 (scheme, "data") == 0)
+    return phosh_util_data_uri_to_pixbuf (url, error);
+
+  if (g_strcmp0 (scheme, "file") == 0 ||
+      g_strcmp0 (scheme, "http") == 0 ||
+      g_strcmp0 (scheme, "https") == 0) {
+    g_autoptr (GFile) file = g_file_new_for_uri (url);
+    g_autoptr (GIcon) icon = g_file_icon_new (file);
+    g_autoptr (GInputStream) stream = NULL;
+
+    stream = g_loadable_icon_load (G_LOADABLE_ICON (icon), size, NULL, cancellable, error);
+    if (stream == NULL)
+      return NULL;
+
+    return gdk_pixbuf_new_from_stream_at_scale (stream, size, size, TRUE, cancellable, error);
+  }
+
+  g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED, "Unsupported URL scheme '%s'", scheme);
+  return NULL;
+}
+
+
+static void
+load_in_thread (GTask        *task,
+                gpointer      source_object,
+                gpointer      task_data,
+                GCancellable *cancellable)
+{
+  LoadData *data = task_data;
+  g_autoptr (GdkPixbuf) pixbuf = NULL;
+  g_autoptr (GdkPixbuf) centered = NULL;
+  GError *err = NULL;
+  int width, height;
+
+  pixbuf = load_pixbuf (data->url, data->size, cancellable, &err);
+  if (pixbuf == NULL) {
+    g_task_return_error (task, err);
+    return;
+  }
+
+  /* Data URIs and some loaders ignore the requested size */
+  width = gdk_pixbuf_get_width (pixbuf);
+  height = gdk_pixbuf_get_height (pixbuf);
+  if (width > data->size || height > data->size) {
+    double scale = (double) data->size / MAX (width, height);
+    GdkPixbuf *scaled;
+
+    scaled = gdk_pixbuf_scale_simple (pixbuf,
+                                      MAX (1, round (width * scale)),
+                                      MAX (1, round (height * scale)),
+                                      GDK_INTERP_BILINEAR);
+    g_set_object (&pixbuf, scaled);
+    g_object_unref (scaled);
+  }
+
+  centered = center_pixbuf (pixbuf);
+  g_task_return_pointer (task, round_corners (centered), g_object_unref);
+}
+
+
+static void
+insert_entry (PhoshMediaArtCache *self, const char *key, GdkPixbuf *pixbuf)
+{
+  PhoshMediaArtCacheEntry *entry;
+
+  entry = g_new0 (PhoshMediaArtCacheEntry, 1);
+  entry->key = g_strdup (key);
+  entry->pixbuf = g_object_ref (pixbuf);
+  entry->link.data = entry;
+
+  g_hash_table_replace (self->entries, entry->key, entry);
+  g_queue_push_head_link (&self->lru, &entry->link);
+
+  while (self->lru.length > MAX_ENTRIES) {
+    PhoshMediaArtCacheEntry *last = self->lru.tail->data;
+
+    g_queue_unlink (&self->lru, &last->link);
+    g_debug ("Evicting %s", last->key);
+    g_hash_table_remove (self->entries, last->key);
+  }
+}
+
+
+static void
+on_load_done (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+  PhoshMediaArtCache *self = PHOSH_MEDIA_ART_CACHE (source_object);
+  g_autofree char *key = user_data;
+  g_autofree char *pending_key = NULL;
+  g_autoptr (GPtrArray) waiting = NULL;
+  g_autoptr (GdkPixbuf) pixbuf = NULL;
+  g_autoptr (GError) err = NULL;
+
+  pixbuf = g_task_propagate_pointer (G_TASK (res), &err);
+
+  g_hash_table_steal_extended (self->pending, key, (gpointer *)&pending_key, (gpointer *)&waiting);
+  if (pixbuf)
+    insert_entry (self, key, pixbuf);
+  else
+    g_debug ("Failed to load %s: %s", key, err->message);
+
+  for (guint i = 0; waiting && i < waiting->len; i++) {
+    GTask *task = g_ptr_array_index (waiting, i);
+
+    if (pixbuf)
+      g_task_return_pointer (task, g_object_ref (pixbuf), g_object_unref);
+    else
+      g_task_return_error (task, g_error_copy (err));
+  }
+}
+
+
+static void
+report_memory (gpointer data, guint64 *n_items, guint64 *bytes)
+{
+  PhoshMediaArtCache *self = PHOSH_MEDIA_ART_CACHE (data);
+
+  *n_items = self->lru.length;
+  for (GList *l = self->lru.head; l; l = l->next) {
+    PhoshMediaArtCacheEntry *entry = l->data;
+
+    *bytes += gdk_pixbuf_get_byte_length (entry->pixbuf);
+  }
+}
+
+
+static void
+phosh_media_art_cache_finalize (GObject *object)
+{
+  PhoshMediaArtCache *self = PHOSH_MEDIA_ART_CACHE (object);
+
+  phosh_memory_stats_unregister (self);
+
+  g_clear_pointer (&self->pending, g_hash_table_destroy);
+  g_clear_pointer (&self->entries, g_hash_table_destroy);
+
+  G_OBJECT_CLASS (phosh_media_art_cache_parent_class)->finalize (object);
+}
+
+
+static void
+phosh_media_art_cache_class_init (PhoshMediaArtCacheClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = phosh_media_art_cache_finalize;
+}
+
+
+static void
+phosh_media_art_cache_init (PhoshMediaArtCache *self)
+{
+  self->entries = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                         NULL, (GDestroyNotify) entry_free);
+  self->pending = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                         g_free, (GDestroyNotify) g_ptr_array_unref);
+
+  phosh_memory_stats_register ("media-art-cache", report_memory, self);
+}
+
+/**
+ * phosh_media_art_cache_get_default:
+ *
+ * Get the media art cache singleton
+ *
+ * Returns:(transfer none): The media art cache singleton
+ */
+PhoshMediaArtCache *
+phosh_media_art_cache_get_default (void)
+{
+  static PhoshMediaArtCache *instance;
+
+  if (instance == NULL) {
+    instance = g_object_new (PHOSH_TYPE_MEDIA_ART_CACHE, NULL);
+    g_object_add_weak_pointer (G_OBJECT (instance), (gpointer *)&instance);
+  }
+
+  return instance;
+}
+
+/**
+ * phosh_media_art_cache_lookup:
+ * @self: The media art cache
+ * @url: The URL of the album art
+ * @size: The size in pixels
+ *
+ * Looks up already processed album art.
+ *
+ * Returns:(transfer full)(nullable): The album art or %NULL if not cached
+ */
+GdkPixbuf *
+phosh_media_art_cache_lookup (PhoshMediaArtCache *self, const char *url, int size)
+{
+  g_autofree char *key = NULL;
+  PhoshMediaArtCacheEntry *entry;
+
+  g_return_val_if_fail (PHOSH_IS_MEDIA_ART_CACHE (self), NULL);
+  g_return_val_if_fail (url, NULL);
+
+  key = get_key (url, size);
+  entry = g_hash_table_lookup (self->entries, key);
+  if (entry == NULL)
+    return NULL;
+
+  g_queue_unlink (&self->lru, &entry->link);
+  g_queue_push_head_link (&self->lru, &entry->link);
+
+  return g_object_ref (entry->pixbuf);
+}
+
+/**
+ * phosh_media_art_cache_load_async:
+ * @self: The media art cache
+ * @url: The URL of the album art
+ * @size: The size in pixels
+ * @cancellable: (nullable): A cancellable
+ * @callback: The callback to invoke when done
+ * @user_data: The user data for @callback
+ *
+ * Fetches the album art at @url, scales it to fit into @size and rounds
+ * its corners. `file`, `http`, `https` and `data` URLs are supported.
+ */
+void
+phosh_media_art_cache_load_async (PhoshMediaArtCache  *self,
+                                  const char          *url,
+                                  int                  size,
+                                  GCancellable        *cancellable,
+                                  GAsyncReadyCallback  callback,
+                                  gpointer             user_data)
+{
+  g_autoptr (GTask) task = NULL;
+  g_autoptr (GTask) load_task = NULL;
+  g_autoptr (GdkPixbuf) pixbuf = NULL;
+  g_autofree char *key = NULL;
+  GPtrArray *waiting;
+  LoadData *data;
+
+  g_return_if_fail (PHOSH_IS_MEDIA_ART_CACHE (self));
+  g_return_if_fail (url);
+  g_return_if_fail (size > 0);
+
+  task = g_task_new (self, cancellable, callback, user_data);
+  g_task_set_source_tag (task, phosh_media_art_cache_load_async);
+
+  pixbuf = phosh_media_art_cache_lookup (self, url, size);
+  if (pixbuf) {
+    g_task_return_pointer (task, g_steal_pointer (&pixbuf), g_object_unref);
+    return;
+  }
+
+  key = get_key (url, size);
+  waiting = g_hash_table_lookup (self->pending, key);
+  if (waiting) {
+    g_ptr_array_add (waiting, g_steal_pointer (&task));
+    return;
+  }
+
+  waiting = g_ptr_array_new_with_free_func (g_object_unref);
+  g_ptr_array_add (waiting, g_steal_pointer (&task));
+  g_hash_table_insert (self->pending, g_strdup (key), waiting);
+
+  data = g_new0 (LoadData, 1);
+  data->url = g_strdup (url);
+  data->size = size;
+
+  g_debug ("Loading %s", key);
+  /* Callers might cancel but others might still want the image */
+  load_task = g_task_new (self, NULL, on_load_done, g_steal_pointer (&key));
+  g_task_set_task_data (load_task, data, (GDestroyNotify) load_data_free);
+  g_task_run_in_thread (load_task, load_in_thread);
+}
+
+/**
+ * phosh_media_art_cache_load_finish:
+ * @self: The media art cache
+ * @res: The async result
+ * @error: The return location for errors
+ *
+ * Finishes loading album art.
+ *
+ * Returns:(transfer full): The album art or %NULL on error
+ */
+GdkPixbuf *
+phosh_media_art_cache_load_finish (PhoshMediaArtCache *self, GAsyncResult *res, GError **error)
+{
+  g_return_val_if_fail (PHOSH_IS_MEDIA_ART_CACHE (self), NULL);
+  g_return_val_if_fail (g_task_is_valid (res, self), NULL);
+
+  return g_task_propagate_pointer (G_TASK (res), error);
+}
@@ -13,8 +13,11 @@
 
 #include "mpris-dbus.h"
 #include "mpris-manager.h"
+#include "media-art-cache.h"
 #include "media-player.h"
+#include "property-batch.h"
 #include "shell-priv.h"
+#include "timer-service.h"
 #include "util.h"
 
 #include <gmobile.h>
@@ -22,6 +25,8 @@
 
 #include <glib/gi18n.h>
 
+#include <float.h>
+
 #include <handy.h>
 
 #define ART_PIXEL_SIZE 48
@@ -29,9 +34,6 @@
 #define SEEK_BACK (-10 * SEEK_SECOND)
 #define SEEK_FORWARD (30 * SEEK_SECOND)
 
-G_DEFINE_AUTOPTR_CLEANUP_FUNC (cairo_t, cairo_destroy)
-G_DEFINE_AUTOPTR_CLEANUP_FUNC (cairo_surface_t, cairo_surface_destroy)
-
 /**
  * PhoshMediaPlayer:
  *
@@ -88,14 +90,19 @@ typedef struct _PhoshMediaPlayerPrivate {
   GCancellable                *cancel;
   GCancellable                *fetch_icon_cancel;
   PhoshMprisManager           *manager;
+  PhoshPowerSaverManager      *power_saver_manager;
   /* Actual player controls */
   PhoshDBusMediaPlayer2Player *player;
+  PhoshPropertyBatch          *player_batch;
   PhoshMediaPlayerStatus       status;
   gboolean                     attached;
   gboolean                     playable;
   gint64                       track_length;
+  /* Last known position and the monotonic time it was valid at */
   gint64                       track_position;
-  guint                        pos_poller_id;
+  gint64                       position_time;
+  double                       rate;
+  guint                        pos_update_id;
 } PhoshMediaPlayerPrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (PhoshMediaPlayer, phosh_media_player, GTK_TYPE_GRID);
@@ -155,40 +162,141 @@ set_attached (PhoshMediaPlayer *self, gboolean attached)
 }
 
 
+/* Extrapolate the current position from the last known one */
+static gint64
+get_position (PhoshMediaPlayer *self)
+{
+  PhoshMediaPlayerPrivate *priv = phosh_media_player_get_instance_private (self);
+  gint64 position;
+
+  if (priv->track_position < 0 || priv->status != PHOSH_MEDIA_PLAYER_STATUS_PLAYING)
+    return priv->track_position;
+
+  position = priv->track_position +
+    (g_get_monotonic_time () - priv->position_time) * priv->rate;
+  position = MAX (position, 0);
+  if (priv->track_length > 0)
+    position = MIN (position, priv->track_length);
+
+  return position;
+}
+
+
 static void
 update_position (PhoshMediaPlayer *self)
 {
   PhoshMediaPlayerPrivate *priv = phosh_media_player_get_instance_private (self);
   g_autofree char *position_text = NULL;
   double level = 0.0;
+  gint64 position = get_position (self);
 
-  if (priv->track_position >= 0)
-    position_text = cui_call_format_duration ((double) priv->track_position / G_USEC_PER_SEC);
+  if (position >= 0)
+    position_text = cui_call_format_duration ((double) position / G_USEC_PER_SEC);
 
   gtk_label_set_label (GTK_LABEL (priv->lbl_position), position_text ?: "-");
 
-  if (priv->track_position > 0 && priv->track_length > 0)
-    level = ((double) priv->track_position) / priv->track_length;
+  if (position > 0 && priv->track_length > 0)
+    level = ((double) position) / priv->track_length;
   gtk_progress_bar_set_fraction (GTK_PROGRESS_BAR (priv->prb_position), level);
 }
 
 
 static void
-stop_pos_poller (PhoshMediaPlayer *self)
+stop_pos_updates (PhoshMediaPlayer *self)
+{
+  PhoshMediaPlayerPrivate *priv = phosh_media_player_get_instance_private (self);
+
+  if (priv->pos_update_id == 0)
+    return;
+
+  phosh_timer_service_remove_timeout (phosh_timer_service_get_default (), priv->pos_update_id);
+  priv->pos_update_id = 0;
+}
+
+
+static gboolean on_pos_update (gpointer user_data);
+
+#define POS_UPDATE_TOLERANCE 100 /* ms */
+/*
+ * Schedule an update for when the displayed position changes. This
+ * only happens while the label can be seen, the track is playing and
+ * we're not saving power.
+ */
+static void
+schedule_pos_update (PhoshMediaPlayer *self)
 {
   PhoshMediaPlayerPrivate *priv = phosh_media_player_get_instance_private (self);
+  gint64 position, next;
+  guint delay;
+
+  stop_pos_updates (self);
 
-  if (priv->pos_poller_id <= 0)
+  if (!gtk_widget_get_mapped (GTK_WIDGET (self)) ||
+      !gtk_widget_get_visible (priv->box_pos_len) ||
+      priv->status != PHOSH_MEDIA_PLAYER_STATUS_PLAYING ||
+      priv->track_position < 0 ||
+      priv->rate <= 0.0) {
     return;
+  }
+
+  if (priv->power_saver_manager &&
+      phosh_power_saver_manager_get_active (priv->power_saver_manager))
+    return;
+
+  position = get_position (self);
+  if (priv->track_length > 0 && position >= priv->track_length)
+    return;
+
+  next = (position / G_USEC_PER_SEC + 1) * G_USEC_PER_SEC;
+  delay = (next - position) / priv->rate / G_TIME_SPAN_MILLISECOND + 1;
+
+  priv->pos_update_id = phosh_timer_service_add_timeout (phosh_timer_service_get_default (),
+                                                         delay,
+                                                         POS_UPDATE_TOLERANCE,
+                                                         on_pos_update,
+                                                         self);
+}
+
+
+static gboolean
+on_pos_update (gpointer user_data)
+{
+  PhoshMediaPlayer *self = PHOSH_MEDIA_PLAYER (user_data);
+  PhoshMediaPlayerPrivate *priv = phosh_media_player_get_instance_private (self);
+
+  priv->pos_update_id = 0;
+  update_position (self);
+  schedule_pos_update (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static void
+on_power_saving_changed (PhoshMediaPlayer *self)
+{
+  /* Catch up on what we skipped while saving power */
+  update_position (self);
+  schedule_pos_update (self);
+}
 
-  g_debug ("Stopping position poller");
-  g_source_remove (priv->pos_poller_id);
-  priv->pos_poller_id = 0;
+
+static void
+set_position (PhoshMediaPlayer *self, gint64 position)
+{
+  PhoshMediaPlayerPrivate *priv = phosh_media_player_get_instance_private (self);
+
+  priv->track_position = position;
+  priv->position_time = g_get_monotonic_time ();
+  g_debug ("MPRIS Position: %" G_GINT64_FORMAT, position);
+
+  update_position (self);
+  schedule_pos_update (self);
 }
 
 
 static void
-on_poll_position_done (GObject *source_object, GAsyncResult *res, gpointer user_data)
+on_sync_position_done (GObject *source_object, GAsyncResult *res, gpointer user_data)
 {
   GDBusProxy *proxy = G_DBUS_PROXY (source_object);
   PhoshMediaPlayer *self;
@@ -209,70 +317,41 @@ on_poll_position_done (GObject *source_object, GAsyncResult *res, gpointer user_
 
     /* Return variant has type "(v)" where v has type x (i.e. gint64) */
     g_variant_get_child (var, 0, "v", &var2);
-    priv->track_position = g_variant_get_int64 (var2);
-    g_debug ("MPRIS Position: %" G_GINT64_FORMAT, priv->track_position);
+    set_position (self, g_variant_get_int64 (var2));
   } else {
     g_warning ("Could not get Position from MPRIS player, hiding box_pos_len: %s", err->message);
-    priv->track_position = -1;
     gtk_widget_set_visible (priv->box_pos_len, FALSE);
-    stop_pos_poller (self);
+    set_position (self, -1);
   }
-
-  update_position (self);
 }
 
-
-static gboolean
-poll_position (PhoshMediaPlayer *self)
+/*
+ * Fetch the current position from the player. MPRIS doesn't notify
+ * about position changes during playback so we only do this when the
+ * playback state changes and extrapolate the position otherwise.
+ */
+static void
+sync_position (PhoshMediaPlayer *self)
 {
   PhoshMediaPlayerPrivate *priv = phosh_media_player_get_instance_private (self);
 
-  g_return_val_if_fail (PHOSH_IS_MEDIA_PLAYER (self), G_SOURCE_CONTINUE);
-
   if (!priv->attached || priv->player == NULL) {
     g_debug ("No MPRIS player attached");
-    priv->pos_poller_id = 0;
-    return G_SOURCE_REMOVE;
+    return;
   }
 
-  if (!gtk_widget_is_visible (priv->lbl_position)) {
-    g_debug ("Widget hidden, not updating Position");
-    return G_SOURCE_CONTINUE;
+  if (!gtk_widget_get_visible (priv->box_pos_len)) {
+    g_debug ("box_pos_len not visible, not syncing Position");
+    return;
   }
 
   g_dbus_proxy_call (G_DBUS_PROXY (priv->player),
                      "org.freedesktop.DBus.Properties.Get",
                      g_variant_new ("(ss)", "org.mpris.MediaPlayer2.Player", "Position"),
                      G_DBUS_CALL_FLAGS_NONE, -1, priv->cancel,
-                     on_poll_position_done, self);
-
-  return G_SOURCE_CONTINUE;
+                     on_sync_position_done, self);
 }
 
-
-#define POLLER_INTERVAL 1 /* seconds */
-static void
-start_pos_poller (PhoshMediaPlayer *self)
-{
-  PhoshMediaPlayerPrivate *priv = phosh_media_player_get_instance_private (self);
-
-  if (!gtk_widget_get_visible (priv->box_pos_len)) {
-    g_debug ("box_pos_len not visible, not starting position poller");
-    return;
-  }
-  if (priv->pos_poller_id != 0) {
-    g_debug ("Position poller already running");
-    return;
-  }
-  g_debug ("Starting position poller");
-  poll_position (self);
-  priv->pos_poller_id = g_timeout_add_seconds (POLLER_INTERVAL,
-                                               (GSourceFunc) poll_position,
-                                               self);
-  g_source_set_name_by_id (priv->pos_poller_id, "[PhoshMediaPlayer] pos_poller");
-}
-
-
 static void
 on_play_pause_done (GObject *source_object, GAsyncResult *res, gpointer user_data)
 {
@@ -304,7 +383,6 @@ on_next_done (GObject *source_object, GAsyncResult *res, gpointer user_data)
 {
   PhoshDBusMediaPlayer2Player *player = PHOSH_DBUS_MEDIA_PLAYER2_PLAYER (source_object);
   PhoshMediaPlayer *self = PHOSH_MEDIA_PLAYER (user_data);
-  PhoshMediaPlayerPrivate *priv = phosh_media_player_get_instance_private (self);
   g_autoptr (GError) err = NULL;
 
   g_return_if_fail (PHOSH_DBUS_IS_MEDIA_PLAYER2_PLAYER (player));
@@ -313,7 +391,7 @@ on_next_done (GObject *source_object, GAsyncResult *res, gpointer user_data)
     phosh_async_error_warn (err, "Failed to trigger next");
     return;
   }
-  priv->track_position = 0;
+  set_position (self, 0);
 }
 
 
@@ -335,7 +413,6 @@ on_previous_done (GObject *source_object, GAsyncResult *res, gpointer user_data)
 {
   PhoshDBusMediaPlayer2Player *player = PHOSH_DBUS_MEDIA_PLAYER2_PLAYER (source_object);
   PhoshMediaPlayer *self = PHOSH_MEDIA_PLAYER (user_data);
-  PhoshMediaPlayerPrivate *priv = phosh_media_player_get_instance_private (self);
   g_autoptr (GError) err = NULL;
 
   g_return_if_fail (PHOSH_DBUS_IS_MEDIA_PLAYER2_PLAYER (player));
@@ -344,7 +421,7 @@ on_previous_done (GObject *source_object, GAsyncResult *res, gpointer user_data)
     phosh_async_error_warn (err, "Failed to trigger prev");
     return;
   }
-  priv->track_position = 0;
+  set_position (self, 0);
 }
 
 
@@ -377,7 +454,8 @@ on_seek_done (GObject *source_object, GAsyncResult *res, gpointer user_data)
     g_warning ("Failed to trigger seek: %s", err->message);
     return;
   }
-  poll_position (self);
+  /* Not all players emit Seeked so sync explicitly */
+  sync_position (self);
 }
 
 
@@ -448,144 +526,25 @@ btn_details_clicked_cb (PhoshMediaPlayer *self, GtkButton *button)
 }
 
 
-static GdkPixbuf *
-center_pixbuf (GdkPixbuf *pixbuf)
-{
-  int width, height, size;
-  g_autoptr (GdkPixbuf) centered = NULL;
-  g_autoptr (cairo_t) cr = NULL;
-  g_autoptr (cairo_surface_t) surface = NULL;
-
-  g_return_val_if_fail (GDK_IS_PIXBUF (pixbuf), NULL);
-
-  width = gdk_pixbuf_get_width (pixbuf);
-  height = gdk_pixbuf_get_height (pixbuf);
-
-  if (width == height)
-    return g_object_ref (pixbuf);
-
-  size = MAX (width, height);
-  /* gdk_pixbuf_copy_area would work as well but that goes via gdk_pixbuf_scale, …*/
-  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, size, size);
-  cr = cairo_create (surface);
-  if (width > height)
-    gdk_cairo_set_source_pixbuf (cr, pixbuf, 0, (width - height) / 2.0);
-  else
-    gdk_cairo_set_source_pixbuf (cr, pixbuf, (height - width) / 2.0, 0);
-  cairo_paint (cr);
-
-  return gdk_pixbuf_get_from_surface (surface, 0, 0, size, size);
-}
-
-
-static GdkPixbuf *
-round_corners (GdkPixbuf *pixbuf)
-{
-  g_autoptr (GdkPixbuf) rounded = NULL;
-  g_autoptr (cairo_t) cr = NULL;
-  g_autoptr (cairo_surface_t) surface = NULL;
-  int width, height, size;
-  double radius;
-  const double degrees = M_PI / 180.0;
-
-  g_return_val_if_fail (GDK_IS_PIXBUF (pixbuf), NULL);
-
-  width = gdk_pixbuf_get_width (pixbuf);
-  height = gdk_pixbuf_get_height (pixbuf);
-
-  /* We only round square images */
-  g_return_val_if_fail (width == height, NULL);
-
-  size = width;
-  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, size, size);
-  cr = cairo_create (surface);
-
-  radius = size / 8.0;
-  cairo_new_path (cr);
-  cairo_arc (cr, size - radius, radius, radius, -90 * degrees, 0 * degrees);
-  cairo_arc (cr, size - radius, size - radius, radius, 0 * degrees, 90 * degrees);
-  cairo_arc (cr, radius, size - radius, radius, 90 * degrees, 180 * degrees);
-  cairo_arc (cr, radius, radius, radius, 180 * degrees, 270 * degrees);
-  cairo_close_path (cr);
-  cairo_clip (cr);
-
-  gdk_cairo_set_source_pixbuf (cr, pixbuf, 0, 0);
-  cairo_paint (cr);
-
-  return gdk_pixbuf_get_from_surface (surface, 0, 0, size, size);
-}
-
-
 static void
 phosh_media_player_set_image (PhoshMediaPlayer *self, GdkPixbuf *pixbuf)
 {
   PhoshMediaPlayerPrivate *priv = phosh_media_player_get_instance_private (self);
-  g_autoptr (GdkPixbuf) centered = NULL;
-  g_autoptr (GdkPixbuf) rounded = NULL;
 
-  centered = center_pixbuf (pixbuf);
-  rounded = round_corners (centered);
-  g_object_set (priv->img_art, "gicon", rounded, NULL);
+  g_object_set (priv->img_art, "gicon", pixbuf, NULL);
 }
 
 
 static void
-on_fetch_icon_ready (GObject *source_object, GAsyncResult *res, gpointer user_data)
-{
-  PhoshMediaPlayer *self;
-  PhoshMediaPlayerPrivate *priv;
-  g_autoptr (GInputStream) stream = NULL;
-  g_autoptr (GError) err = NULL;
-  g_autofree char *type = NULL;
-  g_autoptr (GdkPixbuf) pixbuf = NULL;
-
-  stream = g_loadable_icon_load_finish (G_LOADABLE_ICON (source_object), res, &type, &err);
-  if (!stream) {
-    g_warning ("Failed to fetch icon: %s", err->message);
-    return;
-  }
-
-  g_debug ("Loading icon of type: %s", type);
-  self = PHOSH_MEDIA_PLAYER (user_data);
-  priv = phosh_media_player_get_instance_private (self);
-  pixbuf = gdk_pixbuf_new_from_stream (stream, priv->fetch_icon_cancel, &err);
-
-  phosh_media_player_set_image (self, pixbuf);
-}
-
-
-static void
-fetch_icon_async (PhoshMediaPlayer *self, const char *url)
-
-{
-  PhoshMediaPlayerPrivate *priv = phosh_media_player_get_instance_private (self);
-  g_autoptr (GFile) file = g_file_new_for_uri (url);
-  GIcon *icon;
-
-  g_debug ("Fetching icon for %s", url);
-
-  if (!priv->fetch_icon_cancel)
-    priv->fetch_icon_cancel = g_cancellable_new ();
-
-  icon = g_file_icon_new (file);
-  g_loadable_icon_load_async (G_LOADABLE_ICON (icon),
-                              ART_PIXEL_SIZE,
-                              priv->fetch_icon_cancel,
-                              on_fetch_icon_ready,
-                              self);
-}
-
-
-static void
-on_load_icon_from_file_ready (GObject *source_object, GAsyncResult *res, gpointer user_data)
+on_load_art_ready (GObject *source_object, GAsyncResult *res, gpointer user_data)
 {
   PhoshMediaPlayer *self;
   g_autoptr (GdkPixbuf) pixbuf = NULL;
   g_autoptr (GError) err = NULL;
 
-  pixbuf = gdk_pixbuf_new_from_stream_finish (res, &err);
+  pixbuf = phosh_media_art_cache_load_finish (PHOSH_MEDIA_ART_CACHE (source_object), res, &err);
   if (!pixbuf) {
-    phosh_async_error_warn (err, "Failed to load image");
+    phosh_async_error_warn (err, "Failed to load album art");
     return;
   }
 
@@ -594,36 +553,14 @@ on_load_icon_from_file_ready (GObject *source_object, GAsyncResult *res, gpointe
 }
 
 
-static void
-phosh_media_player_load_icon_from_file_async (PhoshMediaPlayer *self, GFile *file)
-{
-  PhoshMediaPlayerPrivate *priv = phosh_media_player_get_instance_private (self);
-  g_autoptr (GFileInputStream) stream = NULL;
-  g_autoptr (GError) err = NULL;
-
-  stream = g_file_read (file, NULL, &err);
-  if (stream == NULL) {
-    g_autofree char *path = g_file_get_path (file);
-
-    g_warning ("Failed to open '%s': %s", path, err->message);
-    return;
-  }
-
-  if (!priv->fetch_icon_cancel)
-    priv->fetch_icon_cancel = g_cancellable_new ();
-
-  gdk_pixbuf_new_from_stream_async (G_INPUT_STREAM (stream),
-                                    priv->fetch_icon_cancel,
-                                    on_load_icon_from_file_ready,
-                                    self);
-}
-
-
 static gboolean
 phosh_media_player_load_icon (PhoshMediaPlayer *self, const char *url)
 {
   PhoshMediaPlayerPrivate *priv = phosh_media_player_get_instance_private (self);
-  gboolean has_art = FALSE;
+  PhoshMediaArtCache *cache = phosh_media_art_cache_get_default ();
+  g_autoptr (GdkPixbuf) pixbuf = NULL;
+  const char *scheme;
+  int size;
 
   if (!g_set_str (&priv->url, url)) {
     g_debug ("Media URL did not change, skippig load");
@@ -635,27 +572,32 @@ phosh_media_player_load_icon (PhoshMediaPlayer *self, const char *url)
   g_cancellable_cancel (priv->fetch_icon_cancel);
   g_clear_object (&priv->fetch_icon_cancel);
 
-  if (url && g_strcmp0 (g_uri_peek_scheme (url), "file") == 0) {
-    g_autoptr (GFile) file = g_file_new_for_uri (url);
-
-    phosh_media_player_load_icon_from_file_async (self, file);
-  } else if (url && (g_strcmp0 (g_uri_peek_scheme (url), "http") == 0 ||
-                     g_strcmp0 (g_uri_peek_scheme (url), "https") == 0)) {
-    fetch_icon_async (self, url);
-  } else if (url && g_strcmp0 (g_uri_peek_scheme (url), "data") == 0) {
-    g_autoptr (GdkPixbuf) pixbuf = NULL;
-    g_autoptr (GError) error = NULL;
-
-    pixbuf = phosh_util_data_uri_to_pixbuf (url, &error);
-    if (pixbuf) {
-      phosh_media_player_set_image (self, pixbuf);
-      has_art = TRUE;
-    } else {
-      g_warning_once ("Failed to load album art from base64 string: %s", error->message);
-    }
+  if (url == NULL)
+    return FALSE;
+
+  scheme = g_uri_peek_scheme (url);
+  if (g_strcmp0 (scheme, "file") != 0 &&
+      g_strcmp0 (scheme, "http") != 0 &&
+      g_strcmp0 (scheme, "https") != 0 &&
+      g_strcmp0 (scheme, "data") != 0) {
+    return FALSE;
   }
 
-  return has_art;
+  size = ART_PIXEL_SIZE * gtk_widget_get_scale_factor (GTK_WIDGET (self));
+  pixbuf = phosh_media_art_cache_lookup (cache, url, size);
+  if (pixbuf) {
+    phosh_media_player_set_image (self, pixbuf);
+    return TRUE;
+  }
+
+  priv->fetch_icon_cancel = g_cancellable_new ();
+  phosh_media_art_cache_load_async (cache,
+                                    url,
+                                    size,
+                                    priv->fetch_icon_cancel,
+                                    on_load_art_ready,
+                                    self);
+  return FALSE;
 }
 
 
@@ -704,13 +646,13 @@ on_metadata_changed (PhoshMediaPlayer *self, GParamSpec *psepc, PhoshDBusMediaPl
     gtk_label_set_label (GTK_LABEL (priv->lbl_length), length_text);
     g_debug ("Metadata has length, showing box_pos_len");
     gtk_widget_set_visible (priv->box_pos_len, TRUE);
-    if (priv->status == PHOSH_MEDIA_PLAYER_STATUS_PLAYING)
-      start_pos_poller (self);
   } else {
     gtk_label_set_label (GTK_LABEL (priv->lbl_length), "-");
   }
   priv->track_length = length;
   update_position (self);
+  /* Might be a new track */
+  sync_position (self);
 
   has_art = phosh_media_player_load_icon (self, url);
 
@@ -738,19 +680,21 @@ on_playback_status_changed (PhoshMediaPlayer            *self,
 
   g_debug ("Status: '%s'", status);
   current = priv->status;
+  /* Anchor the extrapolated position at the status change */
+  priv->track_position = get_position (self);
+  priv->position_time = g_get_monotonic_time ();
+
   if (!g_strcmp0 ("Playing", status)) {
     priv->status = PHOSH_MEDIA_PLAYER_STATUS_PLAYING;
     icon = "media-playback-pause-symbolic";
-    start_pos_poller (self);
+    sync_position (self);
   } else if (!g_strcmp0 ("Paused", status)) {
     priv->status = PHOSH_MEDIA_PLAYER_STATUS_PAUSED;
-    stop_pos_poller (self);
-    poll_position (self);
+    stop_pos_updates (self);
+    sync_position (self);
   } else if (!g_strcmp0 ("Stopped", status)) {
     priv->status = PHOSH_MEDIA_PLAYER_STATUS_STOPPED;
-    stop_pos_poller (self);
-    priv->track_position = 0;
-    update_position (self);
+    set_position (self, 0);
   } else {
     g_warning ("Unknown status %s", status);
     g_warn_if_reached ();
@@ -821,13 +765,97 @@ on_can_seek (PhoshMediaPlayer *self, GParamSpec *psepc, PhoshDBusMediaPlayer2Pla
 }
 
 
+static void
+on_rate_changed (PhoshMediaPlayer *self, GParamSpec *psepc, PhoshDBusMediaPlayer2Player *player)
+{
+  PhoshMediaPlayerPrivate *priv = phosh_media_player_get_instance_private (self);
+  double rate;
+
+  g_return_if_fail (PHOSH_IS_MEDIA_PLAYER (self));
+
+  rate = phosh_dbus_media_player2_player_get_rate (player);
+  /* Players not implementing Rate play at normal speed */
+  if (G_APPROX_VALUE (rate, 0.0, DBL_EPSILON))
+    rate = 1.0;
+
+  if (G_APPROX_VALUE (rate, priv->rate, DBL_EPSILON))
+    return;
+
+  g_debug ("Rate: %f", rate);
+  priv->track_position = get_position (self);
+  priv->position_time = g_get_monotonic_time ();
+  priv->rate = rate;
+  schedule_pos_update (self);
+}
+
+
+static const struct {
+  const char *name;
+  void      (*update) (PhoshMediaPlayer *self, GParamSpec *pspec, PhoshDBusMediaPlayer2Player *player);
+} player_properties[] = {
+  { "metadata", on_metadata_changed },
+  { "playback-status", on_playback_status_changed },
+  { "can-go-next", on_can_go_next_changed },
+  { "can-go-previous", on_can_go_previous_changed },
+  { "can-play", on_can_play },
+  { "can-seek", on_can_seek },
+  { "rate", on_rate_changed },
+};
+
+/* properties is %NULL to update everything */
+static void
+on_player_properties_changed (PhoshMediaPlayer *self, GStrv properties)
+{
+  PhoshMediaPlayerPrivate *priv = phosh_media_player_get_instance_private (self);
+
+  for (int i = 0; i < G_N_ELEMENTS (player_properties); i++) {
+    if (properties &&
+        !g_strv_contains ((const char * const *)properties, player_properties[i].name))
+      continue;
+
+    player_properties[i].update (self, NULL, priv->player);
+  }
+}
+
+
+static void
+on_seeked (PhoshMediaPlayer *self, gint64 position, PhoshDBusMediaPlayer2Player *player)
+{
+  g_return_if_fail (PHOSH_IS_MEDIA_PLAYER (self));
+
+  g_debug ("Seeked to %" G_GINT64_FORMAT, position);
+  set_position (self, position);
+}
+
+
+static void
+phosh_media_player_map (GtkWidget *widget)
+{
+  PhoshMediaPlayer *self = PHOSH_MEDIA_PLAYER (widget);
+
+  GTK_WIDGET_CLASS (phosh_media_player_parent_class)->map (widget);
+
+  update_position (self);
+  schedule_pos_update (self);
+}
+
+
+static void
+phosh_media_player_unmap (GtkWidget *widget)
+{
+  stop_pos_updates (PHOSH_MEDIA_PLAYER (widget));
+
+  GTK_WIDGET_CLASS (phosh_media_player_parent_class)->unmap (widget);
+}
+
+
 static void
 phosh_media_player_dispose (GObject *object)
 {
   PhoshMediaPlayer *self = PHOSH_MEDIA_PLAYER (object);
   PhoshMediaPlayerPrivate *priv = phosh_media_player_get_instance_private (self);
 
-  stop_pos_poller (self);
+  stop_pos_updates (self);
   g_cancellable_cancel (priv->cancel);
   g_clear_object (&priv->cancel);
 
@@ -835,6 +863,8 @@ phosh_media_player_dispose (GObject *object)
   g_clear_object (&priv->fetch_icon_cancel);
 
   g_clear_object (&priv->manager);
+  g_clear_object (&priv->power_saver_manager);
+  g_clear_object (&priv->player_batch);
   g_clear_object (&priv->player);
 
   g_clear_pointer (&priv->url, g_free);
@@ -852,6 +882,9 @@ phosh_media_player_class_init (PhoshMediaPlayerClass *klass)
   object_class->dispose = phosh_media_player_dispose;
   object_class->get_property = phosh_media_player_get_property;
 
+  widget_class->map = phosh_media_player_map;
+  widget_class->unmap = phosh_media_player_unmap;
+
   /**
    * PhoshMediaPlayer:attached
    *
@@ -927,13 +960,14 @@ phosh_media_player_init (PhoshMediaPlayer *self)
 {
   PhoshMediaPlayerPrivate *priv = phosh_media_player_get_instance_private (self);
   PhoshMprisManager *manager = phosh_shell_get_mpris_manager (phosh_shell_get_default ());
+  PhoshPowerSaverManager *power_saver_manager;
 
   gtk_widget_init_template (GTK_WIDGET (self));
 
   priv->cancel = g_cancellable_new ();
   priv->track_length = -1;
   priv->track_position = -1;
-  priv->pos_poller_id = 0;
+  priv->rate = 1.0;
 
   if (manager) {
     priv->manager = g_object_ref (manager);
@@ -944,6 +978,14 @@ phosh_media_player_init (PhoshMediaPlayer *self)
                             "sensitive",
                             G_BINDING_DEFAULT);
   }
+
+  power_saver_manager = phosh_shell_get_power_saver_manager (phosh_shell_get_default ());
+  if (power_saver_manager) {
+    priv->power_saver_manager = g_object_ref (power_saver_manager);
+    g_signal_connect_object (priv->power_saver_manager, "notify::active",
+                             G_CALLBACK (on_power_saving_changed), self,
+                             G_CONNECT_SWAPPED);
+  }
 }
 
 
@@ -1000,6 +1042,7 @@ phosh_media_player_set_player (PhoshMediaPlayer *self, PhoshDBusMediaPlayer2Play
 
   if (priv->player)
     g_signal_handlers_disconnect_by_data (priv->player, self);
+  g_clear_object (&priv->player_batch);
 
   g_set_object (&priv->player, player);
 
@@ -1009,36 +1052,26 @@ phosh_media_player_set_player (PhoshMediaPlayer *self, PhoshDBusMediaPlayer2Play
   }
 
   g_debug ("Connected player %p", priv->player);
-  g_object_connect (priv->player,
-                    "swapped-object-signal::notify::metadata",
-                    G_CALLBACK (on_metadata_changed),
-                    self,
-                    "swapped-object-signal::notify::playback-status",
-                    G_CALLBACK (on_playback_status_changed),
-                    self,
-                    "swapped-object-signal::notify::can-go-next",
-                    G_CALLBACK (on_can_go_next_changed),
-                    self,
-                    "swapped-object-signal::notify::can-go-previous",
-                    G_CALLBACK (on_can_go_previous_changed),
-                    self,
-                    "swapped-object-signal::notify::can-play",
-                    G_CALLBACK (on_can_play),
-                    self,
-                    "swapped-object-signal::notify::can-seek",
-                    G_CALLBACK (on_can_seek),
-                    self,
-                    NULL);
-
-  /* Set 'attached' before running notifiers, since we check it on e.g. start_pos_poller() */
+  priv->player_batch = phosh_property_batch_new (priv->player,
+                                                 "metadata",
+                                                 "playback-status",
+                                                 "can-go-next",
+                                                 "can-go-previous",
+                                                 "can-play",
+                                                 "can-seek",
+                                                 "rate",
+                                                 NULL);
+  g_signal_connect_object (priv->player_batch, "changed",
+                           G_CALLBACK (on_player_properties_changed), self,
+                           G_CONNECT_SWAPPED);
+  g_signal_connect_object (priv->player, "seeked",
+                           G_CALLBACK (on_seeked), self,
+                           G_CONNECT_SWAPPED);
+
+  /* Set 'attached' before running notifiers, since we check it on e.g. sync_position() */
   set_attached (self, TRUE);
   /* Hide progress bar box by default, it's shown if track length is given in metadata */
   gtk_widget_set_visible (priv->box_pos_len, FALSE);
 
-  g_object_notify (G_OBJECT (priv->player), "metadata");
-  g_object_notify (G_OBJECT (priv->player), "playback-status");
-  g_object_notify (G_OBJECT (priv->player), "can-go-next");
-  g_object_notify (G_OBJECT (priv->player), "can-go-previous");
-  g_object_notify (G_OBJECT (priv->player), "can-play");
-  g_object_notify (G_OBJECT (priv->player), "can-seek");
+  on_player_properties_changed (self, NULL);
 }
@@ -0,0 +1,315 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "phosh-memory-manager"
+
+#include "phosh-config.h"
+
+#include "app-tracker.h"
+#include "memory-manager.h"
+#include "notify-manager.h"
+#include "shell-priv.h"
+#include "toplevel-manager.h"
+
+#include <glib/gi18n.h>
+#include <glib-unix.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#define PSI_MEMORY_PATH "/proc/pressure/memory"
+/* Stalled for 200ms within any 2s window */
+#define PSI_TRIGGER "some 200000 2000000"
+#define SUGGEST_COOLDOWN_US (60 * G_USEC_PER_SEC)
+#define NOTI_TIMEOUT (30 * 1000)
+
+/**
+ * PhoshMemoryManager:
+ *
+ * `PhoshMemoryManager` watches the kernel's memory pressure stall
+ * information (PSI) and when tasks stall on memory it suggests closing
+ * the least recently used app via a notification, listing how much
+ * memory that would free up.
+ */
+
+struct _PhoshMemoryManager {
+  PhoshManager       parent;
+
+  int                psi_fd;
+  guint              psi_id;
+  gint64             last_suggestion;
+
+  /* PhoshToplevel → last activation time */
+  GHashTable        *last_active;
+
+  PhoshNotification *noti;
+  PhoshToplevel     *suggested;
+};
+G_DEFINE_TYPE (PhoshMemoryManager, phosh_memory_manager, PHOSH_TYPE_MANAGER)
+
+
+static void
+on_notification_actioned (PhoshMemoryManager *self, const char *action)
+{
+  if (g_strcmp0 (action, "close") != 0 || self->suggested == NULL)
+    return;
+
+  g_debug ("Closing '%s' to free up memory", phosh_toplevel_get_app_id (self->suggested));
+  phosh_toplevel_close (self->suggested);
+}
+
+
+static void
+on_notification_closed (PhoshMemoryManager *self)
+{
+  g_clear_object (&self->noti);
+  g_clear_object (&self->suggested);
+}
+
+
+static PhoshToplevel *
+find_least_recently_used (PhoshMemoryManager *self)
+{
+  GHashTableIter iter;
+  gpointer key, value;
+  PhoshToplevel *lru = NULL;
+  gint64 lru_time = G_MAXINT64;
+
+  g_hash_table_iter_init (&iter, self->last_active);
+  while (g_hash_table_iter_next (&iter, &key, &value)) {
+    PhoshToplevel *toplevel = PHOSH_TOPLEVEL (key);
+    gint64 time = *(gint64 *)value;
+
+    if (phosh_toplevel_is_activated (toplevel))
+      continue;
+
+    if (time < lru_time) {
+      lru = toplevel;
+      lru_time = time;
+    }
+  }
+
+  return lru;
+}
+
+
+static void
+suggest_close (PhoshMemoryManager *self)
+{
+  PhoshNotifyManager *nm = phosh_notify_manager_get_default ();
+  PhoshAppTracker *app_tracker = phosh_shell_get_app_tracker (phosh_shell_get_default ());
+  g_autoptr (GIcon) icon = g_themed_icon_new ("dialog-warning-symbolic");
+  g_autofree char *body = NULL;
+  g_autofree char *size = NULL;
+  char *actions[] = { "close", _("Close App"), NULL };
+  PhoshToplevel *toplevel;
+  const char *title;
+  guint64 memory = 0;
+
+  toplevel = find_least_recently_used (self);
+  if (toplevel == NULL) {
+    g_debug ("Memory pressure but no app to suggest closing");
+    return;
+  }
+
+  if (app_tracker) {
+    memory = phosh_app_scopes_get_memory (phosh_app_tracker_get_scopes (app_tracker),
+                                          phosh_toplevel_get_app_id (toplevel));
+  }
+
+  title = phosh_toplevel_get_title (toplevel);
+  if (memory) {
+    size = g_format_size (memory);
+    /* Translators: first argument is the window title, second an amount of memory */
+    body = g_strdup_printf (_("Closing '%s' frees up %s"), title, size);
+  } else {
+    body = g_strdup_printf (_("Closing '%s' frees up memory"), title);
+  }
+
+  g_set_object (&self->suggested, toplevel);
+  if (self->noti) {
+    phosh_notification_set_body (self->noti, body);
+    phosh_notification_expires (self->noti, NOTI_TIMEOUT);
+    return;
+  }
+
+  self->noti = g_object_new (PHOSH_TYPE_NOTIFICATION,
+                             "summary", _("Memory is running low"),
+                             "body", body,
+                             "image", icon,
+                             "actions", actions,
+                             NULL);
+  g_object_connect (self->noti,
+                    "swapped-object-signal::actioned", on_notification_actioned, self,
+                    "swapped-object-signal::closed", on_notification_closed, self,
+                    NULL);
+  phosh_notify_manager_add_shell_notification (nm, self->noti, 0, NOTI_TIMEOUT);
+  phosh_notification_set_transient (self->noti, TRUE);
+  phosh_notification_set_profile (self->noti, "silent");
+}
+
+
+static gboolean
+on_memory_pressure (int fd, GIOCondition condition, gpointer user_data)
+{
+  PhoshMemoryManager *self = PHOSH_MEMORY_MANAGER (user_data);
+  gint64 now;
+
+  if (condition & G_IO_ERR) {
+    g_warning ("Memory pressure monitoring failed, disabling");
+    self->psi_id = 0;
+    return G_SOURCE_REMOVE;
+  }
+
+  now = g_get_monotonic_time ();
+  if (self->last_suggestion && now - self->last_suggestion < SUGGEST_COOLDOWN_US)
+    return G_SOURCE_CONTINUE;
+
+  g_debug ("Memory pressure threshold exceeded");
+  self->last_suggestion = now;
+  suggest_close (self);
+
+  return G_SOURCE_CONTINUE;
+}
+
+
+static void
+update_last_active (PhoshMemoryManager *self, PhoshToplevel *toplevel)
+{
+  gint64 *time = g_new (gint64, 1);
+
+  *time = phosh_toplevel_is_activated (toplevel) ? g_get_monotonic_time () : 0;
+  g_hash_table_insert (self->last_active, g_object_ref (toplevel), time);
+}
+
+
+static void
+on_toplevel_activated_changed (PhoshMemoryManager *self,
+                               GParamSpec         *pspec,
+                               PhoshToplevel      *toplevel)
+{
+  gint64 *time;
+
+  time = g_hash_table_lookup (self->last_active, toplevel);
+  if (time == NULL)
+    return;
+
+  /* Track when the toplevel went to the background */
+  *time = g_get_monotonic_time ();
+}
+
+
+static void
+on_toplevel_closed (PhoshMemoryManager *self, PhoshToplevel *toplevel)
+{
+  if (self->suggested == toplevel && self->noti)
+    phosh_notification_close (self->noti, PHOSH_NOTIFICATION_REASON_CLOSED);
+
+  g_hash_table_remove (self->last_active, toplevel);
+}
+
+
+static void
+on_toplevel_added (PhoshMemoryManager *self, PhoshToplevel *toplevel)
+{
+  g_signal_connect_object (toplevel, "notify::activated",
+                           G_CALLBACK (on_toplevel_activated_changed), self,
+                           G_CONNECT_SWAPPED);
+  g_signal_connect_object (toplevel, "closed",
+                           G_CALLBACK (on_toplevel_closed), self,
+                           G_CONNECT_SWAPPED);
+  update_last_active (self, toplevel);
+}
+
+
+static gboolean
+setup_psi_trigger (PhoshMemoryManager *self)
+{
+  g_autofd int fd = -1;
+
+  fd = open (PSI_MEMORY_PATH, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+  if (fd < 0) {
+    g_debug ("Failed to open " PSI_MEMORY_PATH ": %s", g_strerror (errno));
+    return FALSE;
+  }
+
+  if (write (fd, PSI_TRIGGER, strlen (PSI_TRIGGER) + 1) < 0) {
+    g_debug ("Failed to set memory pressure trigger: %s", g_strerror (errno));
+    return FALSE;
+  }
+
+  self->psi_fd = g_steal_fd (&fd);
+  return TRUE;
+}
+
+
+static void
+phosh_memory_manager_idle_init (PhoshManager *manager)
+{
+  PhoshMemoryManager *self = PHOSH_MEMORY_MANAGER (manager);
+  PhoshToplevelManager *toplevel_manager;
+
+  if (!setup_psi_trigger (self)) {
+    g_info ("Memory pressure information unavailable");
+    return;
+  }
+
+  self->psi_id = g_unix_fd_add (self->psi_fd, G_IO_PRI | G_IO_ERR, on_memory_pressure, self);
+  g_source_set_name_by_id (self->psi_id, "[phosh] memory pressure");
+
+  toplevel_manager = phosh_shell_get_toplevel_manager (phosh_shell_get_default ());
+  g_signal_connect_object (toplevel_manager, "toplevel-added",
+                           G_CALLBACK (on_toplevel_added), self,
+                           G_CONNECT_SWAPPED);
+  for (guint i = 0; i < phosh_toplevel_manager_get_num_toplevels (toplevel_manager); i++)
+    on_toplevel_added (self, phosh_toplevel_manager_get_toplevel (toplevel_manager, i));
+}
+
+
+static void
+phosh_memory_manager_finalize (GObject *object)
+{
+  PhoshMemoryManager *self = PHOSH_MEMORY_MANAGER (object);
+
+  g_clear_handle_id (&self->psi_id, g_source_remove);
+  g_clear_fd (&self->psi_fd, NULL);
+
+  g_clear_object (&self->noti);
+  g_clear_object (&self->suggested);
+  g_clear_pointer (&self->last_active, g_hash_table_unref);
+
+  G_OBJECT_CLASS (phosh_memory_manager_parent_class)->finalize (object);
+}
+
+
+static void
+phosh_memory_manager_class_init (PhoshMemoryManagerClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  PhoshManagerClass *manager_class = PHOSH_MANAGER_CLASS (klass);
+
+  object_class->finalize = phosh_memory_manager_finalize;
+
+  manager_class->idle_init = phosh_memory_manager_idle_init;
+}
+
+
+static void
+phosh_memory_manager_init (PhoshMemoryManager *self)
+{
+  self->psi_fd = -1;
+  self->last_active = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                             g_object_unref, g_free);
+}
+
+
+PhoshMemoryManager *
+phosh_memory_manager_new (void)
+{
+  return g_object_new (PHOSH_TYPE_MEMORY_MANAGER, NULL);
+}
@@ -0,0 +1,22 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include "manager.h"
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+#define PHOSH_TYPE_MEMORY_MANAGER (phosh_memory_manager_get_type ())
+
+G_DECLARE_FINAL_TYPE (PhoshMemoryManager, phosh_memory_manager, PHOSH, MEMORY_MANAGER,
+                      PhoshManager)
+
+PhoshMemoryManager *phosh_memory_manager_new (void);
+
+G_END_DECLS
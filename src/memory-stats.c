@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "phosh-memory-stats"
+
+#include "phosh-config.h"
+
+#include "memory-stats.h"
+
+#include <stdio.h>
+#include <unistd.h>
+
+/**
+ * PhoshMemoryStats:
+ *
+ * Reports the memory held by caches and models
+ *
+ * Subsystems holding on to larger amounts of memory (e.g. decoded
+ * images) register a callback that reports the number of items they
+ * hold and the approximate number of bytes used by them. The numbers
+ * are only gathered when asked for so this doesn't cost anything
+ * otherwise. Reporters registered under the same name (e.g. one per
+ * instance) are summed up.
+ *
+ * This is meant for debugging and available via the `GetMemoryStats`
+ * method of `mobi.phosh.Shell.DebugControl`.
+ */
+
+#define PROCESS_NAME "process"
+
+typedef struct {
+  char                 *name;
+  PhoshMemoryStatsFunc  func;
+  gpointer              data;
+} PhoshMemoryStatsReporter;
+
+typedef struct {
+  guint64 n_items;
+  guint64 bytes;
+} PhoshMemoryStat;
+
+static struct {
+  GPtrArray *reporters;
+} memory_stats;
+
+
+static void
+reporter_free (PhoshMemoryStatsReporter *reporter)
+{
+  g_free (reporter->name);
+  g_free (reporter);
+}
+
+/**
+ * phosh_memory_stats_register:
+ * @name: The name to report the memory under
+ * @func:(scope notified): The function reporting the memory use
+ * @data: The data passed to @func
+ *
+ * Register a reporter for the memory held by a subsystem. Use
+ * [func@memory_stats_unregister] with the same @data before @data
+ * goes away.
+ */
+void
+phosh_memory_stats_register (const char *name, PhoshMemoryStatsFunc func, gpointer data)
+{
+  PhoshMemoryStatsReporter *reporter;
+
+  g_return_if_fail (name != NULL);
+  g_return_if_fail (func != NULL);
+
+  if (memory_stats.reporters == NULL)
+    memory_stats.reporters = g_ptr_array_new_with_free_func ((GDestroyNotify)reporter_free);
+
+  reporter = g_new0 (PhoshMemoryStatsReporter, 1);
+  reporter->name = g_strdup (name);
+  reporter->func = func;
+  reporter->data = data;
+  g_ptr_array_add (memory_stats.reporters, reporter);
+}
+
+/**
+ * phosh_memory_stats_unregister:
+ * @data: The data the reporters were registered with
+ *
+ * Remove all reporters registered with the given data.
+ */
+void
+phosh_memory_stats_unregister (gpointer data)
+{
+  if (memory_stats.reporters == NULL)
+    return;
+
+  for (guint i = memory_stats.reporters->len; i > 0; i--) {
+    PhoshMemoryStatsReporter *reporter = g_ptr_array_index (memory_stats.reporters, i - 1);
+
+    if (reporter->data == data)
+      g_ptr_array_remove_index (memory_stats.reporters, i - 1);
+  }
+}
+
+
+static gboolean
+get_process_rss (guint64 *bytes)
+{
+  g_autofree char *contents = NULL;
+  guint64 size, resident;
+
+  if (!g_file_get_contents ("/proc/self/statm", &contents, NULL, NULL))
+    return FALSE;
+
+  if (sscanf (contents, "%" G_GUINT64_FORMAT " %" G_GUINT64_FORMAT, &size, &resident) != 2)
+    return FALSE;
+
+  *bytes = resident * sysconf (_SC_PAGESIZE);
+  return TRUE;
+}
+
+/**
+ * phosh_memory_stats_get:
+ *
+ * Get the memory held by the registered subsystems. Keys are the
+ * names the reporters were registered under, values a dictionary with
+ * the number of items ("items") and the approximate number of bytes
+ * used by them ("bytes"). The resident set size of the whole process
+ * is reported as "process".
+ *
+ * Returns:(transfer floating): The stats as `a{sa{sv}}`
+ */
+GVariant *
+phosh_memory_stats_get (void)
+{
+  g_autoptr (GHashTable) stats = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_free);
+  GVariantBuilder builder;
+  GHashTableIter iter;
+  gpointer key, value;
+  guint64 rss;
+
+  for (guint i = 0; memory_stats.reporters && i < memory_stats.reporters->len; i++) {
+    PhoshMemoryStatsReporter *reporter = g_ptr_array_index (memory_stats.reporters, i);
+    PhoshMemoryStat *stat = g_hash_table_lookup (stats, reporter->name);
+    guint64 n_items = 0, bytes = 0;
+
+    if (stat == NULL) {
+      stat = g_new0 (PhoshMemoryStat, 1);
+      g_hash_table_insert (stats, reporter->name, stat);
+    }
+
+    reporter->func (reporter->data, &n_items, &bytes);
+    stat->n_items += n_items;
+    stat->bytes += bytes;
+  }
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sa{sv}}"));
+
+  g_hash_table_iter_init (&iter, stats);
+  while (g_hash_table_iter_next (&iter, &key, &value)) {
+    PhoshMemoryStat *stat = value;
+    GVariantBuilder props;
+
+    g_variant_builder_init (&props, G_VARIANT_TYPE_VARDICT);
+    g_variant_builder_add (&props, "{sv}", "items", g_variant_new_uint64 (stat->n_items));
+    g_variant_builder_add (&props, "{sv}", "bytes", g_variant_new_uint64 (stat->bytes));
+    g_variant_builder_add (&builder, "{sa{sv}}", key, &props);
+  }
+
+  if (get_process_rss (&rss)) {
+    GVariantBuilder props;
+
+    g_variant_builder_init (&props, G_VARIANT_TYPE_VARDICT);
+    g_variant_builder_add (&props, "{sv}", "bytes", g_variant_new_uint64 (rss));
+    g_variant_builder_add (&builder, "{sa{sv}}", PROCESS_NAME, &props);
+  }
+
+  return g_variant_builder_end (&builder);
+}
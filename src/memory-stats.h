@@ -0,0 +1,29 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/**
+ * PhoshMemoryStatsFunc:
+ * @data: The data passed when registering
+ * @n_items:(out): The number of items currently held
+ * @bytes:(out): The approximate number of bytes used by them
+ *
+ * Reports the memory held by a subsystem.
+ */
+typedef void (*PhoshMemoryStatsFunc) (gpointer data, guint64 *n_items, guint64 *bytes);
+
+void      phosh_memory_stats_register   (const char           *name,
+                                         PhoshMemoryStatsFunc  func,
+                                         gpointer              data);
+void      phosh_memory_stats_unregister (gpointer              data);
+GVariant *phosh_memory_stats_get        (void);
+
+G_END_DECLS
@@ -15,15 +15,27 @@
 #include "util.h"
 #include "dbus/hostname1-dbus.h"
 
+#include <unistd.h>
+
 #define BUS_NAME "org.freedesktop.hostname1"
 #define OBJECT_PATH "/org/freedesktop/hostname1"
 
+/* Devices with at most this much RAM use the low memory tier */
+#define LOW_MEMORY_BYTES (2048ULL * 1024 * 1024)
+
 /**
  * PhoshModeManager:
  *
  * Determines the device mode
  *
  * #PhoshModeManager tracks the device mode and attached hardware.
+ *
+ * From the device's mimicry and the amount of memory it also derives
+ * a [enum@ModePerfTier]. Components query the tier's
+ * [struct@ModePerfProfile] for resource limits instead of using
+ * constants tuned for a single device class. A docked phone gets the
+ * desktop tier while devices with little memory always use the low
+ * memory tier.
  */
 
 enum {
@@ -31,17 +43,47 @@ enum {
   PROP_DEVICE_TYPE,
   PROP_HW_FLAGS,
   PROP_MIMICRY,
+  PROP_PERF_TIER,
 
   PROP_LAST_PROP
 };
 static GParamSpec *props[PROP_LAST_PROP];
 
+static const PhoshModePerfProfile perf_profiles[] = {
+  [PHOSH_MODE_PERF_TIER_PHONE] = {
+    .thumbnail_scale = 1.0,
+    .preload_backgrounds = 1,
+    .reduce_animations = FALSE,
+    .notification_history = 100,
+  },
+  [PHOSH_MODE_PERF_TIER_TABLET] = {
+    .thumbnail_scale = 1.0,
+    .preload_backgrounds = 1,
+    .reduce_animations = FALSE,
+    .notification_history = 200,
+  },
+  [PHOSH_MODE_PERF_TIER_DESKTOP] = {
+    .thumbnail_scale = 1.0,
+    .preload_backgrounds = 2,
+    .reduce_animations = FALSE,
+    .notification_history = 500,
+  },
+  [PHOSH_MODE_PERF_TIER_LOW_MEMORY] = {
+    .thumbnail_scale = 0.5,
+    .preload_backgrounds = 0,
+    .reduce_animations = TRUE,
+    .notification_history = 30,
+  },
+};
+
 struct _PhoshModeManager {
   PhoshManager                 parent;
 
   PhoshModeDeviceType          device_type;
   PhoshModeDeviceType          mimicry;
   PhoshModeHwFlags             hw_flags;
+  PhoshModePerfTier            perf_tier;
+  gboolean                     low_memory;
 
   PhoshMonitorManager         *monitor_manager;
 
@@ -75,6 +117,9 @@ phosh_mode_manager_get_property (GObject    *object,
   case PROP_MIMICRY:
     g_value_set_enum (value, self->mimicry);
     break;
+  case PROP_PERF_TIER:
+    g_value_set_enum (value, self->perf_tier);
+    break;
   default:
     G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     break;
@@ -112,10 +157,46 @@ has_external_display (PhoshModeManager *self)
 }
 
 
+static gboolean
+is_low_memory (void)
+{
+  long pages = sysconf (_SC_PHYS_PAGES);
+  long page_size = sysconf (_SC_PAGESIZE);
+
+  if (pages <= 0 || page_size <= 0)
+    return FALSE;
+
+  return (guint64) pages * page_size <= LOW_MEMORY_BYTES;
+}
+
+
+static PhoshModePerfTier
+get_perf_tier (PhoshModeManager *self, PhoshModeDeviceType mimicry)
+{
+  if (self->low_memory)
+    return PHOSH_MODE_PERF_TIER_LOW_MEMORY;
+
+  switch (mimicry) {
+  case PHOSH_MODE_DEVICE_TYPE_LAPTOP:
+  case PHOSH_MODE_DEVICE_TYPE_DESKTOP:
+    return PHOSH_MODE_PERF_TIER_DESKTOP;
+  case PHOSH_MODE_DEVICE_TYPE_TABLET:
+  case PHOSH_MODE_DEVICE_TYPE_CONVERTIBLE:
+    return PHOSH_MODE_PERF_TIER_TABLET;
+  case PHOSH_MODE_DEVICE_TYPE_UNKNOWN:
+  case PHOSH_MODE_DEVICE_TYPE_PHONE:
+  case PHOSH_MODE_DEVICE_TYPE_EMBEDDED:
+  default:
+    return PHOSH_MODE_PERF_TIER_PHONE;
+  }
+}
+
+
 static void
 update_props (PhoshModeManager *self)
 {
   PhoshModeDeviceType device_type, mimicry;
+  PhoshModePerfTier perf_tier;
   PhoshModeHwFlags hw;
 
   /* Self->Chassis type */
@@ -188,6 +269,15 @@ update_props (PhoshModeManager *self)
     g_object_notify_by_pspec (G_OBJECT (self), props[PROP_HW_FLAGS]);
   }
 
+  perf_tier = get_perf_tier (self, mimicry);
+  if (perf_tier != self->perf_tier) {
+    g_autofree char *name = g_enum_to_string (PHOSH_TYPE_MODE_PERF_TIER, perf_tier);
+
+    self->perf_tier = perf_tier;
+    g_debug ("Performance tier is %s", name);
+    g_object_notify_by_pspec (G_OBJECT (self), props[PROP_PERF_TIER]);
+  }
+
   g_object_thaw_notify (G_OBJECT (self));
 }
 
@@ -431,6 +521,18 @@ phosh_mode_manager_class_init (PhoshModeManagerClass *klass)
                        G_PARAM_EXPLICIT_NOTIFY |
                        G_PARAM_STATIC_STRINGS);
 
+  /**
+   * PhoshModeManager:perf-tier:
+   *
+   * The performance tier. Use [method@ModeManager.get_perf_profile]
+   * to get its resource limits.
+   */
+  props[PROP_PERF_TIER] =
+    g_param_spec_enum ("perf-tier", "", "",
+                       PHOSH_TYPE_MODE_PERF_TIER,
+                       PHOSH_MODE_PERF_TIER_PHONE,
+                       G_PARAM_READABLE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+
   g_object_class_install_properties (object_class, PROP_LAST_PROP, props);
 }
 
@@ -443,6 +545,8 @@ phosh_mode_manager_init (PhoshModeManager *self)
   self->mimicry = PHOSH_MODE_DEVICE_TYPE_UNKNOWN;
   self->cancel = g_cancellable_new ();
   self->is_tablet_mode = -1;
+  self->low_memory = is_low_memory ();
+  self->perf_tier = get_perf_tier (self, self->mimicry);
 }
 
 
@@ -469,3 +573,37 @@ phosh_mode_manager_get_mimicry (PhoshModeManager *self)
 
   return self->mimicry;
 }
+
+
+/**
+ * phosh_mode_manager_get_perf_tier:
+ * @self: The mode manager
+ *
+ * Get the current performance tier
+ *
+ * Returns: The performance tier
+ */
+PhoshModePerfTier
+phosh_mode_manager_get_perf_tier (PhoshModeManager *self)
+{
+  g_return_val_if_fail (PHOSH_IS_MODE_MANAGER (self), PHOSH_MODE_PERF_TIER_PHONE);
+
+  return self->perf_tier;
+}
+
+/**
+ * phosh_mode_manager_get_perf_profile:
+ * @self: The mode manager
+ *
+ * Get the resource limits of the current performance tier. Listen to
+ * `notify::perf-tier` to pick up changes.
+ *
+ * Returns:(transfer none): The performance profile
+ */
+const PhoshModePerfProfile *
+phosh_mode_manager_get_perf_profile (PhoshModeManager *self)
+{
+  g_return_val_if_fail (PHOSH_IS_MODE_MANAGER (self), &perf_profiles[PHOSH_MODE_PERF_TIER_PHONE]);
+
+  return &perf_profiles[self->perf_tier];
+}
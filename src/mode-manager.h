@@ -51,6 +51,41 @@ typedef enum {
   PHOSH_MODE_HW_POINTER     = (1 << 3),
 } PhoshModeHwFlags;
 
+/**
+ * PhoshModePerfTier:
+ * @PHOSH_MODE_PERF_TIER_PHONE: A phone or similar handheld device
+ * @PHOSH_MODE_PERF_TIER_TABLET: A tablet or convertible in tablet mode
+ * @PHOSH_MODE_PERF_TIER_DESKTOP: A laptop, desktop or docked device
+ * @PHOSH_MODE_PERF_TIER_LOW_MEMORY: A device with little memory
+ *
+ * The performance tier picks resource limits suitable for the device class
+ */
+typedef enum {
+  PHOSH_MODE_PERF_TIER_PHONE,
+  PHOSH_MODE_PERF_TIER_TABLET,
+  PHOSH_MODE_PERF_TIER_DESKTOP,
+  PHOSH_MODE_PERF_TIER_LOW_MEMORY,
+} PhoshModePerfTier;
+
+/**
+ * PhoshModePerfProfile:
+ * @thumbnail_scale: Factor to apply to the monitor scale when capturing
+ *   window thumbnails
+ * @preload_backgrounds: How many upcoming slides of a background slide show
+ *   to preload
+ * @reduce_animations: Whether to prefer the reduced animation profile
+ * @notification_history: The number of notifications to keep in memory
+ *   unless the user configured a limit. `0` means no limit.
+ *
+ * The resource limits of a [enum@ModePerfTier]
+ */
+typedef struct {
+  float    thumbnail_scale;
+  guint    preload_backgrounds;
+  gboolean reduce_animations;
+  guint    notification_history;
+} PhoshModePerfProfile;
+
 /* TODO: Use phoc-device-state for keyboard detection */
 #define PHOSH_MODE_DOCKED_PHONE_MASK (PHOSH_MODE_HW_EXT_DISPLAY | PHOSH_MODE_HW_POINTER)
 #define PHOSH_MODE_DOCKED_TABLET_MASK (PHOSH_MODE_HW_POINTER)
@@ -63,5 +98,7 @@ G_DECLARE_FINAL_TYPE (PhoshModeManager, phosh_mode_manager, PHOSH, MODE_MANAGER,
 PhoshModeManager *phosh_mode_manager_new (void);
 PhoshModeDeviceType phosh_mode_manager_get_device_type (PhoshModeManager *self);
 PhoshModeDeviceType phosh_mode_manager_get_mimicry (PhoshModeManager *self);
+PhoshModePerfTier phosh_mode_manager_get_perf_tier (PhoshModeManager *self);
+const PhoshModePerfProfile *phosh_mode_manager_get_perf_profile (PhoshModeManager *self);
 
 G_END_DECLS
@@ -18,6 +18,7 @@
 #include "wlr-gamma-control-unstable-v1-client-protocol.h"
 #include "phosh-wayland.h"
 #include "shell-priv.h"
+#include "trace.h"
 
 #include "util.h"
 
@@ -25,9 +26,16 @@
 
 #include <gdk/gdkwayland.h>
 
+#include <math.h>
+
 #define GSD_COLOR_BUS_NAME "org.gnome.SettingsDaemon.Color"
 #define GSD_COLOR_OBJECT_PATH "/org/gnome/SettingsDaemon/Color"
 
+#define NIGHT_LIGHT_SCHEMA_ID "mobi.phosh.shell.night-light"
+#define NIGHT_LIGHT_KEY_TRANSITION_DURATION "transition-duration"
+/* Roughly display rate */
+#define NIGHT_LIGHT_STEP_MS 16
+
 /**
  * PhoshMonitorManager:
  *
@@ -72,7 +80,15 @@ typedef struct _PhoshMonitorManager
   GBinding                *sensor_proxy_binding;
 
   PhoshDBusColor          *gsd_color_proxy;
-  guint32                  night_light_temp;
+  guint32                  night_light_temp;     /* The target temperature */
+  GSettings               *night_light_settings;
+  struct {
+    guint32                applied;              /* What's currently on the outputs */
+    guint32                from;
+    gint64                 start;
+    guint                  duration;             /* ms */
+    guint                  id;
+  } night_light_transition;
 
   GPtrArray *monitors;   /* Currently known monitors */
   GPtrArray *heads;      /* Currently known heads */
@@ -83,6 +99,29 @@ typedef struct _PhoshMonitorManager
   PhoshHead *pending_primary;
   uint32_t zwlr_output_serial;
 
+  /* Built DBus replies, valid until the heads change */
+  struct {
+    PhoshHead *primary;
+    GVariant  *crtcs;
+    GVariant  *outputs;
+    GVariant  *modes;
+  } resources;
+  struct {
+    PhoshHead *primary;
+    GVariant  *monitors;
+    GVariant  *logical_monitors;
+    GVariant  *properties;
+  } current_state;
+
+  struct {
+    guint                      depth;
+    gboolean                   apply;
+    gboolean                   set_power_save;
+    PhoshMonitorPowerSaveMode  power_save_mode;
+  } transaction;
+  /* Start of the last configuration sent to the compositor */
+  gint64                   trace_apply;
+
   GCancellable            *cancel;
 } PhoshMonitorManager;
 
@@ -182,6 +221,21 @@ phosh_monitor_manager_get_head_from_monitor (PhoshMonitorManager *self, PhoshMon
  * DBus Interface
  */
 
+static void
+invalidate_dbus_state (PhoshMonitorManager *self)
+{
+  self->resources.primary = NULL;
+  g_clear_pointer (&self->resources.crtcs, g_variant_unref);
+  g_clear_pointer (&self->resources.outputs, g_variant_unref);
+  g_clear_pointer (&self->resources.modes, g_variant_unref);
+
+  self->current_state.primary = NULL;
+  g_clear_pointer (&self->current_state.monitors, g_variant_unref);
+  g_clear_pointer (&self->current_state.logical_monitors, g_variant_unref);
+  g_clear_pointer (&self->current_state.properties, g_variant_unref);
+}
+
+
 static gboolean
 phosh_monitor_manager_handle_get_resources (PhoshDBusDisplayConfig *skeleton,
                                             GDBusMethodInvocation  *invocation)
@@ -215,6 +269,13 @@ phosh_monitor_manager_handle_get_resources (PhoshDBusDisplayConfig *skeleton,
     return TRUE;
   }
 
+  if (self->resources.crtcs && self->resources.primary == primary_head)
+    goto out;
+
+  g_clear_pointer (&self->resources.crtcs, g_variant_unref);
+  g_clear_pointer (&self->resources.outputs, g_variant_unref);
+  g_clear_pointer (&self->resources.modes, g_variant_unref);
+
   g_variant_builder_init (&crtc_builder, G_VARIANT_TYPE ("a(uxiiiiiuaua{sv})"));
   g_variant_builder_init (&output_builder, G_VARIANT_TYPE ("a(uxiausauaua{sv})"));
   g_variant_builder_init (&mode_builder, G_VARIANT_TYPE ("a(uxuudu)"));
@@ -284,13 +345,19 @@ phosh_monitor_manager_handle_get_resources (PhoshDBusDisplayConfig *skeleton,
 
   /* Don't bother setting up modes, they're ignored */
 
+  self->resources.primary = primary_head;
+  self->resources.crtcs = g_variant_ref_sink (g_variant_builder_end (&crtc_builder));
+  self->resources.outputs = g_variant_ref_sink (g_variant_builder_end (&output_builder));
+  self->resources.modes = g_variant_ref_sink (g_variant_builder_end (&mode_builder));
+
+ out:
   phosh_dbus_display_config_complete_get_resources (
     skeleton,
     invocation,
     self->serial,
-    g_variant_builder_end (&crtc_builder),
-    g_variant_builder_end (&output_builder),
-    g_variant_builder_end (&mode_builder),
+    self->resources.crtcs,
+    self->resources.outputs,
+    self->resources.modes,
     65535,  /* max_screen_width */
     65535   /* max_screen_height */
     );
@@ -387,8 +454,6 @@ build_mode (GVariantBuilder *modes_builder, PhoshHeadMode *mode, gboolean is_cur
   double scale = 1.0;
   GVariantBuilder supported_scales_builder, mode_properties_builder;
   const char *name = "default";
-  int n;
-  g_autofree float *scales = NULL;
 
   if (mode->name)
     name = mode->name;
@@ -398,10 +463,9 @@ build_mode (GVariantBuilder *modes_builder, PhoshHeadMode *mode, gboolean is_cur
   }
 
   g_variant_builder_init (&supported_scales_builder, G_VARIANT_TYPE ("ad"));
-  scales = phosh_util_calculate_supported_mode_scales (mode->width, mode->height, &n, TRUE);
-  for (int l = 0; l < n; l++) {
+  for (int l = 0; l < mode->n_scales; l++) {
     g_variant_builder_add (&supported_scales_builder, "d",
-                           (double)scales[l]);
+                           (double)mode->scales[l]);
   }
 
   g_variant_builder_init (&mode_properties_builder,
@@ -450,6 +514,9 @@ phosh_monitor_manager_handle_get_current_state (PhoshDBusDisplayConfig *skeleton
     return TRUE;
   }
 
+  if (self->current_state.monitors && self->current_state.primary == primary_head)
+    goto out;
+
   g_variant_builder_init (&monitors_builder,
                           G_VARIANT_TYPE (MONITORS_FORMAT));
   g_variant_builder_init (&logical_monitors_builder,
@@ -536,13 +603,23 @@ phosh_monitor_manager_handle_get_current_state (PhoshDBusDisplayConfig *skeleton
                          "supports-changing-layout-mode",
                          g_variant_new_boolean (TRUE));
 
+  g_clear_pointer (&self->current_state.monitors, g_variant_unref);
+  g_clear_pointer (&self->current_state.logical_monitors, g_variant_unref);
+  g_clear_pointer (&self->current_state.properties, g_variant_unref);
+  self->current_state.primary = primary_head;
+  self->current_state.monitors = g_variant_ref_sink (g_variant_builder_end (&monitors_builder));
+  self->current_state.logical_monitors =
+    g_variant_ref_sink (g_variant_builder_end (&logical_monitors_builder));
+  self->current_state.properties = g_variant_ref_sink (g_variant_builder_end (&properties_builder));
+
+ out:
   phosh_dbus_display_config_complete_get_current_state (
     skeleton,
     invocation,
     self->serial,
-    g_variant_builder_end (&monitors_builder),
-    g_variant_builder_end (&logical_monitors_builder),
-    g_variant_builder_end (&properties_builder));
+    self->current_state.monitors,
+    self->current_state.logical_monitors,
+    self->current_state.properties);
 
   return TRUE;
 }
@@ -995,8 +1072,8 @@ on_monitor_configured (PhoshMonitorManager *self, PhoshMonitor *monitor)
   phosh_monitor_manager_set_night_light_supported (self);
 
   /* Update night light */
-  if (self->night_light_temp > 0 && phosh_monitor_has_gamma (monitor))
-    phosh_monitor_set_color_temp (monitor, self->night_light_temp);
+  if (self->night_light_transition.applied > 0 && phosh_monitor_has_gamma (monitor))
+    phosh_monitor_set_color_temp (monitor, self->night_light_transition.applied);
 }
 
 
@@ -1078,6 +1155,7 @@ on_head_finished (PhoshMonitorManager *self,
   else
     g_warning ("Tried to remove inexistend head %p", head);
 
+  invalidate_dbus_state (self);
   phosh_dbus_display_config_emit_monitors_changed (PHOSH_DBUS_DISPLAY_CONFIG (self));
 }
 
@@ -1096,6 +1174,7 @@ zwlr_output_manager_v1_handle_head (void                          *data,
   g_debug ("New head %p", head);
   g_ptr_array_add (self->heads, head);
   g_signal_connect_swapped (head, "head-finished", G_CALLBACK (on_head_finished), self);
+  invalidate_dbus_state (self);
 
   phosh_dbus_display_config_emit_monitors_changed (PHOSH_DBUS_DISPLAY_CONFIG (self));
 }
@@ -1112,6 +1191,7 @@ zwlr_output_manager_v1_handle_done (void                          *data,
   g_debug ("Got zwlr_output_manager serial %u", serial);
   self->zwlr_output_serial = serial;
   self->serial++;
+  invalidate_dbus_state (self);
 
   phosh_dbus_display_config_emit_monitors_changed (PHOSH_DBUS_DISPLAY_CONFIG (self));
 }
@@ -1127,8 +1207,11 @@ static void
 zwlr_output_configuration_v1_handle_succeeded (void                                *data,
                                                struct zwlr_output_configuration_v1 *config)
 {
+  PhoshMonitorManager *self = PHOSH_MONITOR_MANAGER (data);
+
   g_debug ("New output configuration %p applied", config);
   zwlr_output_configuration_v1_destroy (config);
+  PHOSH_TRACE_MARK (self->trace_apply, "monitor-manager: apply config", "succeeded");
 }
 
 
@@ -1136,9 +1219,12 @@ static void
 zwlr_output_configuration_v1_handle_failed (void                                *data,
                                             struct zwlr_output_configuration_v1 *config)
 {
+  PhoshMonitorManager *self = PHOSH_MONITOR_MANAGER (data);
+
   /* TODO: bubble up error */
   g_warning ("Failed to apply New output %p configuration", config);
   zwlr_output_configuration_v1_destroy (config);
+  PHOSH_TRACE_MARK (self->trace_apply, "monitor-manager: apply config", "failed");
 }
 
 
@@ -1146,8 +1232,11 @@ static void
 zwlr_output_configuration_v1_handle_cancelled (void                                *data,
                                                struct zwlr_output_configuration_v1 *config)
 {
+  PhoshMonitorManager *self = PHOSH_MONITOR_MANAGER (data);
+
   zwlr_output_configuration_v1_destroy (config);
   g_warning ("Failed to apply New output configuration %p due to changes", config);
+  PHOSH_TRACE_MARK (self->trace_apply, "monitor-manager: apply config", "cancelled");
 }
 
 
@@ -1172,6 +1261,8 @@ phosh_monitor_manager_dispose (GObject *object)
   g_clear_pointer (&self->sensor_proxy_binding, g_binding_unbind);
 
   g_clear_object (&self->gsd_color_proxy);
+  g_clear_handle_id (&self->night_light_transition.id, g_source_remove);
+  g_clear_object (&self->night_light_settings);
   g_cancellable_cancel (self->cancel);
   g_clear_object (&self->cancel);
 
@@ -1184,6 +1275,7 @@ phosh_monitor_manager_finalize (GObject *object)
 {
   PhoshMonitorManager *self = PHOSH_MONITOR_MANAGER (object);
 
+  invalidate_dbus_state (self);
   g_ptr_array_free (self->monitors, TRUE);
   g_ptr_array_free (self->heads, TRUE);
 
@@ -1238,6 +1330,68 @@ phosh_monitor_manager_get_property (GObject    *object,
 }
 
 
+static void
+apply_color_temp (PhoshMonitorManager *self, guint32 temp)
+{
+  if (self->night_light_transition.applied == temp)
+    return;
+
+  self->night_light_transition.applied = temp;
+  g_debug ("Setting night light: %dK", temp);
+  /* All monitors' gamma tables get sent with a single flush by the main loop */
+  for (int i = 0; i < self->monitors->len; i++) {
+    gboolean success;
+    PhoshMonitor *monitor = g_ptr_array_index (self->monitors, i);
+
+    success = phosh_monitor_set_color_temp (monitor, temp);
+    if (!success)
+      g_warning ("Failed to set gamma for %s", monitor->name);
+  }
+}
+
+
+static gboolean
+monitors_off (PhoshMonitorManager *self)
+{
+  for (int i = 0; i < self->monitors->len; i++) {
+    PhoshMonitor *monitor = g_ptr_array_index (self->monitors, i);
+
+    if (phosh_monitor_has_gamma (monitor) &&
+        phosh_monitor_get_power_save_mode (monitor) == PHOSH_MONITOR_POWER_SAVE_MODE_ON) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+
+static gboolean
+on_night_light_transition_step (gpointer data)
+{
+  PhoshMonitorManager *self = PHOSH_MONITOR_MANAGER (data);
+  double t;
+  guint32 temp;
+
+  t = (double)(g_get_monotonic_time () - self->night_light_transition.start) /
+    (self->night_light_transition.duration * 1000);
+
+  /* No need to animate when nobody can see it */
+  if (t >= 1.0 || monitors_off (self)) {
+    self->night_light_transition.id = 0;
+    apply_color_temp (self, self->night_light_temp);
+    return G_SOURCE_REMOVE;
+  }
+
+  temp = round (self->night_light_transition.from +
+                t * ((double)self->night_light_temp - self->night_light_transition.from));
+  /* Only upload when the temperature actually changed */
+  apply_color_temp (self, temp);
+
+  return G_SOURCE_CONTINUE;
+}
+
+
 static void
 on_gsd_color_temperature_changed (PhoshMonitorManager*self)
 {
@@ -1251,14 +1405,22 @@ on_gsd_color_temperature_changed (PhoshMonitorManager*self)
   self->night_light_temp = temp;
 
   g_return_if_fail (self->night_light_temp > 0);
-  g_debug ("Setting night light: %dK", self->night_light_temp);
-  for (int i = 0; i < self->monitors->len; i++) {
-    gboolean success;
-    PhoshMonitor *monitor = g_ptr_array_index (self->monitors, i);
-
-    success = phosh_monitor_set_color_temp (monitor, self->night_light_temp);
-    if (!success)
-      g_warning ("Failed to set gamma for %s", monitor->name);
+  g_clear_handle_id (&self->night_light_transition.id, g_source_remove);
+
+  self->night_light_transition.duration = g_settings_get_uint (self->night_light_settings,
+                                                              NIGHT_LIGHT_KEY_TRANSITION_DURATION);
+  if (self->night_light_transition.applied == 0 ||
+      self->night_light_transition.duration == 0 ||
+      monitors_off (self)) {
+    apply_color_temp (self, self->night_light_temp);
+  } else {
+    /* Continue from where a running transition got to */
+    self->night_light_transition.from = self->night_light_transition.applied;
+    self->night_light_transition.start = g_get_monotonic_time ();
+    self->night_light_transition.id = g_timeout_add (NIGHT_LIGHT_STEP_MS,
+                                                     on_night_light_transition_step,
+                                                     self);
+    g_source_set_name_by_id (self->night_light_transition.id, "[phosh] night light transition");
   }
 
   g_object_notify_by_pspec (G_OBJECT (self), props[PROP_NIGHT_LIGHT_TEMP]);
@@ -1427,6 +1589,7 @@ phosh_monitor_manager_init (PhoshMonitorManager *self)
   self->monitors = g_ptr_array_new_with_free_func ((GDestroyNotify) (g_object_unref));
   self->heads = g_ptr_array_new_with_free_func ((GDestroyNotify) (g_object_unref));
   self->serial = 1;
+  self->night_light_settings = g_settings_new (NIGHT_LIGHT_SCHEMA_ID);
 
   self->cancel = g_cancellable_new ();
 }
@@ -1538,22 +1701,16 @@ phosh_monitor_manager_set_monitor_scale (PhoshMonitorManager  *self,
   phosh_head_set_pending_scale (head, scale, self->heads);
 }
 
-/**
- * phosh_monitor_manager_apply_monitor_config
- * @self: a #PhoshMonitorManager
- *
- * Applies a full output configuration
- */
-void
-phosh_monitor_manager_apply_monitor_config (PhoshMonitorManager *self)
+
+static void
+apply_monitor_config (PhoshMonitorManager *self)
 {
   PhoshWayland *wl = phosh_wayland_get_default ();
   struct zwlr_output_configuration_v1 *config;
   struct zwlr_output_manager_v1 *output_manager =
     phosh_wayland_get_zwlr_output_manager_v1 (wl);
 
-  g_return_if_fail (PHOSH_IS_MONITOR_MANAGER (self));
-
+  self->trace_apply = PHOSH_TRACE_CURRENT_TIME;
   config = zwlr_output_manager_v1_create_configuration (output_manager,
                                                         self->zwlr_output_serial);
 
@@ -1593,6 +1750,79 @@ phosh_monitor_manager_apply_monitor_config (PhoshMonitorManager *self)
   zwlr_output_configuration_v1_apply (config);
 }
 
+/**
+ * phosh_monitor_manager_apply_monitor_config
+ * @self: a #PhoshMonitorManager
+ *
+ * Applies a full output configuration. Within a transaction this is
+ * deferred until the transaction is committed.
+ */
+void
+phosh_monitor_manager_apply_monitor_config (PhoshMonitorManager *self)
+{
+  g_return_if_fail (PHOSH_IS_MONITOR_MANAGER (self));
+
+  if (self->transaction.depth) {
+    self->transaction.apply = TRUE;
+    return;
+  }
+
+  apply_monitor_config (self);
+}
+
+/**
+ * phosh_monitor_manager_begin_config:
+ * @self: a #PhoshMonitorManager
+ *
+ * Begins a configuration transaction. Calls to
+ * [method@MonitorManager.apply_monitor_config] and
+ * [method@MonitorManager.set_power_save_mode] are deferred until the
+ * matching call to [method@MonitorManager.commit_config]. This
+ * allows to merge e.g. transform and scale changes of all monitors
+ * into a single output configuration so the compositor only needs to
+ * reconfigure (and clients like layer surfaces only relayout) once.
+ *
+ * Transactions can be nested, changes are applied when the outermost
+ * transaction is committed.
+ */
+void
+phosh_monitor_manager_begin_config (PhoshMonitorManager *self)
+{
+  g_return_if_fail (PHOSH_IS_MONITOR_MANAGER (self));
+
+  self->transaction.depth++;
+}
+
+/**
+ * phosh_monitor_manager_commit_config:
+ * @self: a #PhoshMonitorManager
+ *
+ * Commits a configuration transaction started by
+ * [method@MonitorManager.begin_config]. All pending monitor changes
+ * are sent to the compositor in one output configuration followed by
+ * power save mode changes.
+ */
+void
+phosh_monitor_manager_commit_config (PhoshMonitorManager *self)
+{
+  g_return_if_fail (PHOSH_IS_MONITOR_MANAGER (self));
+  g_return_if_fail (self->transaction.depth > 0);
+
+  self->transaction.depth--;
+  if (self->transaction.depth)
+    return;
+
+  if (self->transaction.apply) {
+    self->transaction.apply = FALSE;
+    apply_monitor_config (self);
+  }
+
+  if (self->transaction.set_power_save) {
+    self->transaction.set_power_save = FALSE;
+    phosh_monitor_manager_set_power_save_mode (self, self->transaction.power_save_mode);
+  }
+}
+
 void
 phosh_monitor_manager_set_sensor_proxy_manager (PhoshMonitorManager     *self,
                                                 PhoshSensorProxyManager *manager)
@@ -1617,7 +1847,8 @@ phosh_monitor_manager_set_sensor_proxy_manager (PhoshMonitorManager     *self,
  * @self: a #PhoshMonitorManager
  * @mode: The power save mode to set
  *
- * Applies a power save mode to all monitors
+ * Applies a power save mode to all monitors. Within a transaction this
+ * is deferred until the transaction is committed.
  */
 void
 phosh_monitor_manager_set_power_save_mode (PhoshMonitorManager       *self,
@@ -1625,6 +1856,12 @@ phosh_monitor_manager_set_power_save_mode (PhoshMonitorManager       *self,
 {
   g_return_if_fail (PHOSH_IS_MONITOR_MANAGER (self));
 
+  if (self->transaction.depth) {
+    self->transaction.set_power_save = TRUE;
+    self->transaction.power_save_mode = mode;
+    return;
+  }
+
   for (int i = 0; i < self->monitors->len; i++) {
     PhoshMonitor *monitor = g_ptr_array_index (self->monitors, i);
 
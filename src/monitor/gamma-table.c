@@ -12,7 +12,7 @@
 
 #include "gamma-table.h"
 
-#include <math.h>
+#include <string.h>
 
 static const float blackbody_color[] = {
   1.00000000,  0.18172716,  0.00000000,       /* 1000K */
@@ -260,6 +260,19 @@ static const float blackbody_color[] = {
 };
 
 
+/* Number of recently computed tables to keep around */
+#define MAX_CACHED_TABLES 4
+
+typedef struct {
+  guint32  ramp_size;
+  guint32  temp;
+  guint16 *table;
+} CachedTable;
+
+/* Most recently used first */
+static CachedTable cached_tables[MAX_CACHED_TABLES];
+
+
 static void
 interpolate_color (float a, const float *c1, const float *c2, float *c)
 {
@@ -269,52 +282,103 @@ interpolate_color (float a, const float *c1, const float *c2, float *c)
 }
 
 
-/* Helper macro used in the fill functions */
-#define F(Y, C)  pow ((Y) *brightness * white_point[C], 1.0 / gamma[C])
-
+/*
+ * As we use a gamma and brightness of 1.0 each ramp is linear in
+ * the white point so there's no need for pow (). The loop is free
+ * of branches and function calls so the compiler can vectorize it.
+ */
 static void
 colorramp_fill (guint16 *gamma_r,
                 guint16 *gamma_g,
                 guint16 *gamma_b,
-                int      ramp_size,
+                guint32  ramp_size,
                 guint32  temp)
 {
   /* Approximate white point */
   float white_point[3];
   float alpha = (temp % 100) / 100.0;
   int temp_index = ((temp - 1000) / 100) * 3;
-  float brightness = 1.0;
-  float gamma[3] = { 1.0, 1.0, 1.0 };
+  double wp_r, wp_g, wp_b;
 
   interpolate_color (alpha,
                      &blackbody_color[temp_index],
                      &blackbody_color[temp_index+3],
                      white_point);
+  wp_r = white_point[0];
+  wp_g = white_point[1];
+  wp_b = white_point[2];
+
+  for (guint32 i = 0; i < ramp_size; i++) {
+    /* The identity ramp */
+    guint16 value = (double)i / ramp_size * (G_MAXUINT16 + 1);
+
+    gamma_r[i] = value * wp_r;
+    gamma_g[i] = value * wp_g;
+    gamma_b[i] = value * wp_b;
+  }
+}
+
+
+static guint16 *
+lookup_table (guint32 ramp_size, guint32 temp)
+{
+  for (int i = 0; i < MAX_CACHED_TABLES; i++) {
+    CachedTable hit = cached_tables[i];
+
+    if (hit.table == NULL)
+      break;
 
-  for (int i = 0; i < ramp_size; i++) {
-    gamma_r[i] = F ((double)gamma_r[i]/(G_MAXUINT16+1), 0) * (G_MAXUINT16+1);
-    gamma_g[i] = F ((double)gamma_g[i]/(G_MAXUINT16+1), 1) * (G_MAXUINT16+1);
-    gamma_b[i] = F ((double)gamma_b[i]/(G_MAXUINT16+1), 2) * (G_MAXUINT16+1);
+    if (hit.ramp_size != ramp_size || hit.temp != temp)
+      continue;
+
+    /* Move to front */
+    memmove (&cached_tables[1], &cached_tables[0], i * sizeof (CachedTable));
+    cached_tables[0] = hit;
+    return hit.table;
   }
+
+  return NULL;
 }
 
 
+static guint16 *
+insert_table (guint32 ramp_size, guint32 temp)
+{
+  CachedTable *last = &cached_tables[MAX_CACHED_TABLES - 1];
+  guint16 *table;
+
+  g_free (last->table);
+  memmove (&cached_tables[1], &cached_tables[0], (MAX_CACHED_TABLES - 1) * sizeof (CachedTable));
+
+  table = g_new (guint16, 3 * ramp_size);
+  colorramp_fill (table, table + ramp_size, table + 2 * ramp_size, ramp_size, temp);
+  cached_tables[0] = (CachedTable) { .ramp_size = ramp_size, .temp = temp, .table = table };
+
+  return table;
+}
+
+/**
+ * phosh_gamma_table_fill:
+ * @table: The table to fill
+ * @ramp_size: The number of entries per color channel
+ * @temp: The color temperature in Kelvin
+ *
+ * Fills @table with the red, green and blue gamma ramps for the
+ * given color temperature. The last few tables are remembered so
+ * e.g. several monitors with the same ramp size or repeated updates
+ * during night light transitions don't need to compute them again.
+ */
 void
 phosh_gamma_table_fill (guint16 *table, guint32 ramp_size, guint32 temp)
 {
-  guint16 *r = table;
-  guint16 *g = table + ramp_size;
-  guint16 *b = table + 2 * ramp_size;
+  guint16 *cached;
 
   g_return_if_fail (temp >= 1000 && temp <= 25000);
+  g_return_if_fail (ramp_size > 0);
 
-  /* Initialize gamma ramps to pure state */
-  for (guint32 i = 0; i < ramp_size; i++) {
-    guint16 value = (double)i / ramp_size * (G_MAXUINT16+1);
-    r[i] = value;
-    g[i] = value;
-    b[i] = value;
-  }
+  cached = lookup_table (ramp_size, temp);
+  if (cached == NULL)
+    cached = insert_table (ramp_size, temp);
 
-  colorramp_fill (r, g, b, ramp_size, temp);
+  memcpy (table, cached, 3 * ramp_size * sizeof (guint16));
 }
@@ -31,6 +31,8 @@ typedef struct _PhoshHeadMode {
   int32_t                     refresh;
   gboolean                    preferred;
   char                       *name;
+  float                      *scales;
+  int                         n_scales;
 } PhoshHeadMode;
 
 struct _PhoshHead {
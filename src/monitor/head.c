@@ -9,6 +9,7 @@
 #define G_LOG_DOMAIN "phosh-head"
 
 #include "head-priv.h"
+#include "util.h"
 
 #include <gdk/gdkwayland.h>
 
@@ -46,6 +47,7 @@ phosh_head_mode_destroy (PhoshHeadMode *mode)
 
   g_clear_pointer (&mode->wlr_mode, zwlr_output_mode_v1_destroy);
   g_free (mode->name);
+  g_free (mode->scales);
   g_free (mode);
 }
 
@@ -74,6 +76,10 @@ zwlr_output_mode_v1_handle_size (void *data, struct zwlr_output_mode_v1 *wlr_mod
   mode->width = width;
   mode->height = height;
   mode_name (mode);
+
+  /* Only changes with the mode's size so calculate it once */
+  g_free (mode->scales);
+  mode->scales = phosh_util_calculate_supported_mode_scales (width, height, &mode->n_scales, TRUE);
 }
 
 
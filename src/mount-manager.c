@@ -34,7 +34,8 @@ typedef struct _PhoshMountManager {
 
   GVolumeMonitor *monitor;
   GSettings      *settings;
-  GPtrArray      *cancellables;
+  /* GVolume → GCancellable of ongoing mounts */
+  GHashTable     *mounting;
 
 } PhoshMountManager;
 
@@ -42,15 +43,22 @@ typedef struct _PhoshMountManager {
 G_DEFINE_TYPE (PhoshMountManager, phosh_mount_manager, G_TYPE_OBJECT)
 
 
+static gboolean
+want_debug (void)
+{
+  return !g_log_writer_default_would_drop (G_LOG_LEVEL_DEBUG, G_LOG_DOMAIN);
+}
+
+
 static void
 on_drive_connected (PhoshMountManager *self, GDrive *drive, GVolumeMonitor *monitor)
 {
-  g_autofree char *name = NULL;
-
   g_return_if_fail (G_IS_DRIVE (drive));
 
-  name = g_drive_get_name (drive);
-  g_debug ("Drive '%s' connected", name);
+  if (want_debug ()) {
+    g_autofree char *name = g_drive_get_name (drive);
+    g_debug ("Drive '%s' connected", name);
+  }
 
   if (!phosh_shell_is_session_active (phosh_shell_get_default ()))
     return;
@@ -62,12 +70,12 @@ on_drive_connected (PhoshMountManager *self, GDrive *drive, GVolumeMonitor *moni
 static void
 on_drive_disconnected (PhoshMountManager *self, GDrive *drive, GVolumeMonitor *monitor)
 {
-  g_autofree char *name = NULL;
-
   g_return_if_fail (G_IS_DRIVE (drive));
 
-  name = g_drive_get_name (drive);
-  g_debug ("Drive '%s' disconnected", name);
+  if (want_debug ()) {
+    g_autofree char *name = g_drive_get_name (drive);
+    g_debug ("Drive '%s' disconnected", name);
+  }
 
   if (!phosh_shell_is_session_active (phosh_shell_get_default ()))
     return;
@@ -77,24 +85,25 @@ on_drive_disconnected (PhoshMountManager *self, GDrive *drive, GVolumeMonitor *m
 
 
 static void
-on_mount_finished (GVolume *vol, GAsyncResult *res, PhoshMountManager *self)
+on_mount_finished (GObject *source_object, GAsyncResult *res, gpointer user_data)
 {
+  PhoshMountManager *self;
+  GVolume *vol = G_VOLUME (source_object);
   g_autoptr (GError) err = NULL;
-  GCancellable *cancellable;
+  gboolean success;
 
-  g_return_if_fail (PHOSH_IS_MOUNT_MANAGER (self));
-  g_return_if_fail (G_IS_VOLUME (vol));
+  success = g_volume_mount_finish (vol, res, &err);
+  /* Manager or volume is gone */
+  if (g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    return;
 
-  if (!g_volume_mount_finish (vol, res, &err)) {
+  self = PHOSH_MOUNT_MANAGER (user_data);
+  if (!success && !g_error_matches (err, G_IO_ERROR, G_IO_ERROR_FAILED_HANDLED)) {
     g_autofree char *name = g_volume_get_name (vol);
     g_warning ("Failed to mount volume '%s': %s", name, err->message);
   }
 
-  cancellable = g_object_get_data (G_OBJECT (vol), "phosh-cancel");
-  g_ptr_array_remove_fast (self->cancellables, cancellable);
-  g_ptr_array_unref (self->cancellables);
-  g_object_unref (vol);
-  g_object_unref (self);
+  g_hash_table_remove (self->mounting, vol);
 }
 
 
@@ -103,17 +112,17 @@ on_volume_added (PhoshMountManager *self, GVolume *vol, GVolumeMonitor *monitor)
 {
   gboolean automount;
   gboolean mount_all;
-  GCancellable *cancellable;
+  g_autoptr (GCancellable) cancellable = NULL;
   g_autoptr (PhoshMountOperation) op = NULL;
-
   g_autoptr (GMount) mount = NULL;
-  g_autofree char *name = NULL;
 
   g_return_if_fail (PHOSH_IS_MOUNT_MANAGER (self));
   g_return_if_fail (G_IS_VOLUME (vol));
 
-  name = g_volume_get_name (vol);
-  g_debug ("Volume added '%s'", name);
+  if (want_debug ()) {
+    g_autofree char *name = g_volume_get_name (vol);
+    g_debug ("Volume added '%s'", name);
+  }
 
   if (!phosh_shell_is_session_active (phosh_shell_get_default ()))
     return;
@@ -123,6 +132,10 @@ on_volume_added (PhoshMountManager *self, GVolume *vol, GVolumeMonitor *monitor)
   if (phosh_shell_get_locked (phosh_shell_get_default ()) && !mount_all)
     return;
 
+  /* Already being mounted */
+  if (g_hash_table_contains (self->mounting, vol))
+    return;
+
   mount = g_volume_get_mount (vol);
   if (mount)
     return;
@@ -132,7 +145,7 @@ on_volume_added (PhoshMountManager *self, GVolume *vol, GVolumeMonitor *monitor)
     return;
 
   if (!g_volume_can_mount (vol)) {
-    g_debug ("Volume '%s' can not be mounted", name);
+    g_debug ("Volume can not be mounted");
     return;
   }
 
@@ -140,29 +153,37 @@ on_volume_added (PhoshMountManager *self, GVolume *vol, GVolumeMonitor *monitor)
   if (!mount_all)
     op = phosh_mount_operation_new ();
 
+  /* Each volume mounts independently so slow ones don't hold up the others */
   cancellable = g_cancellable_new ();
-  g_object_set_data (G_OBJECT (vol), "phosh-cancel", cancellable);
-  g_ptr_array_add (self->cancellables, cancellable);
-  g_ptr_array_ref (self->cancellables);
-  g_debug ("Mounting '%s'", name);
-  g_volume_mount (g_object_ref (vol), G_MOUNT_MOUNT_NONE, G_MOUNT_OPERATION (op), cancellable,
-                  (GAsyncReadyCallback)on_mount_finished, g_object_ref (self));
+  g_hash_table_insert (self->mounting, g_object_ref (vol), g_object_ref (cancellable));
+  g_debug ("Mounting volume, %u mounts in flight", g_hash_table_size (self->mounting));
+  g_volume_mount (vol, G_MOUNT_MOUNT_NONE, G_MOUNT_OPERATION (op), cancellable,
+                  on_mount_finished, self);
 }
 
 
 static void
 on_volume_removed (PhoshMountManager *self, GVolume *vol, GVolumeMonitor *monitor)
 {
-  g_autofree char *name = NULL;
+  GCancellable *cancellable;
 
   g_return_if_fail (PHOSH_IS_MOUNT_MANAGER (self));
   g_return_if_fail (G_IS_VOLUME (vol));
 
+  /* Don't wait for a mount of a vanished volume to time out */
+  cancellable = g_hash_table_lookup (self->mounting, vol);
+  if (cancellable) {
+    g_cancellable_cancel (cancellable);
+    g_hash_table_remove (self->mounting, vol);
+  }
+
   if (!phosh_shell_is_session_active (phosh_shell_get_default ()))
     return;
 
-  name = g_volume_get_name (vol);
-  g_debug ("Volume '%s' removed", name);
+  if (want_debug ()) {
+    g_autofree char *name = g_volume_get_name (vol);
+    g_debug ("Volume '%s' removed", name);
+  }
 }
 
 
@@ -196,7 +217,6 @@ on_mount_added (PhoshMountManager *self, GMount *mount, GVolumeMonitor *monitor)
 static void
 on_mount_removed (PhoshMountManager *self, GMount *mount, GVolumeMonitor *monitor)
 {
-  g_autofree char *name = NULL;
   PhoshNotifyManager *nm;
   gpointer data;
   int id;
@@ -212,8 +232,10 @@ on_mount_removed (PhoshMountManager *self, GMount *mount, GVolumeMonitor *monito
     return;
 
   id = GPOINTER_TO_INT (data);
-  name = g_mount_get_name (mount);
-  g_debug ("Mount '%s' removed, id %d", name, id);
+  if (want_debug ()) {
+    g_autofree char *name = g_mount_get_name (mount);
+    g_debug ("Mount '%s' removed, id %d", name, id);
+  }
   nm = phosh_notify_manager_get_default ();
   phosh_notify_manager_close_notification_by_id (nm, id, PHOSH_NOTIFICATION_REASON_UNDEFINED);
 }
@@ -264,7 +286,8 @@ phosh_mount_manager_constructed (GObject *object)
   PhoshMountManager *self = PHOSH_MOUNT_MANAGER (object);
   PhoshSessionManager *sm;
 
-  self->cancellables = g_ptr_array_new_with_free_func (g_object_unref);
+  self->mounting = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                          g_object_unref, g_object_unref);
   self->monitor = g_volume_monitor_get ();
   self->settings = g_settings_new ("org.gnome.desktop.media-handling");
 
@@ -287,15 +310,21 @@ phosh_mount_manager_dispose (GObject *object)
 {
   PhoshMountManager *self = PHOSH_MOUNT_MANAGER (object);
 
+  if (self->monitor)
+    g_signal_handlers_disconnect_by_data (self->monitor, self);
   g_clear_object (&self->settings);
   g_clear_object (&self->monitor);
 
   /* Cancel all ongoing mount operations */
-  for (int i = 0; i < self->cancellables->len; i++) {
-    GCancellable *cancellable = g_ptr_array_index (self->cancellables, i);
-    g_cancellable_cancel (cancellable);
+  if (self->mounting) {
+    GHashTableIter iter;
+    GCancellable *cancellable;
+
+    g_hash_table_iter_init (&iter, self->mounting);
+    while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&cancellable))
+      g_cancellable_cancel (cancellable);
   }
-  g_clear_pointer (&self->cancellables, g_ptr_array_unref);
+  g_clear_pointer (&self->mounting, g_hash_table_unref);
 
   G_OBJECT_CLASS (phosh_mount_manager_parent_class)->dispose (object);
 }
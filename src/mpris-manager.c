@@ -25,6 +25,11 @@
  * The #PhoshMprisManger interfaces with
  * [org.mpris.MediaPlayer2](https://specifications.freedesktop.org/mpris-spec/latest/)
  * based players allowing widgets to get an actual media player object.
+ *
+ * There's at most one player proxy per bus name. The current player
+ * and the [method@MprisManager.get_known_players] model hand out the
+ * same objects so all widgets share one property cache and one set of
+ * match rules per player.
  */
 
 enum {
@@ -50,6 +55,8 @@ struct _PhoshMprisManager {
   gboolean                     can_raise;
 
   GListStore                  *known_players;
+  /* key: bus name, value: PhoshDBusMediaPlayer2Player */
+  GHashTable                  *players;
 };
 G_DEFINE_TYPE (PhoshMprisManager, phosh_mpris_manager, G_TYPE_OBJECT)
 
@@ -104,6 +111,7 @@ phosh_mpris_manager_dispose (GObject *object)
   g_clear_object (&self->session_bus);
   g_clear_object (&self->mpris);
   g_clear_object (&self->known_players);
+  g_clear_pointer (&self->players, g_hash_table_destroy);
   g_clear_object (&self->player);
 
   G_OBJECT_CLASS (phosh_mpris_manager_parent_class)->dispose (object);
@@ -141,32 +149,16 @@ phosh_mpris_manager_class_init (PhoshMprisManagerClass *klass)
 }
 
 
-static gboolean
-cmp_by_name (gconstpointer a, gconstpointer b)
-{
-  GDBusProxy *proxy1 = G_DBUS_PROXY (a);
-  GDBusProxy *proxy2 = G_DBUS_PROXY (b);
-  const char *name1, *name2;
-
-  name1 = g_dbus_proxy_get_name (proxy1);
-  name2 = g_dbus_proxy_get_name (proxy2);
-
-  return g_strcmp0 (name1, name2) == 0;
-}
-
-
 static void
 add_to_known_players (PhoshMprisManager *self, PhoshDBusMediaPlayer2Player *player)
 {
-  if (g_list_store_find_with_equal_func (self->known_players,
-                                         player,
-                                         cmp_by_name,
-                                         NULL)) {
+  const char *name = g_dbus_proxy_get_name (G_DBUS_PROXY (player));
+
+  if (g_hash_table_contains (self->players, name))
     return;
-  }
 
-  g_debug ("Player %s not yet known, adding to known players",
-           g_dbus_proxy_get_name (G_DBUS_PROXY (player)));
+  g_debug ("Player %s not yet known, adding to known players", name);
+  g_hash_table_insert (self->players, g_strdup (name), g_object_ref (player));
   g_list_store_append (self->known_players, player);
 }
 
@@ -174,17 +166,18 @@ add_to_known_players (PhoshMprisManager *self, PhoshDBusMediaPlayer2Player *play
 static void
 remove_from_known_players (PhoshMprisManager *self, const char *name)
 {
-  for (int i = 0; i < g_list_model_get_n_items (G_LIST_MODEL (self->known_players)); i++) {
-    g_autoptr (GDBusProxy) proxy = NULL;
+  PhoshDBusMediaPlayer2Player *player;
+  guint pos;
 
-    proxy = G_DBUS_PROXY (g_list_model_get_item (G_LIST_MODEL (self->known_players), i));
+  player = g_hash_table_lookup (self->players, name);
+  if (player == NULL)
+    return;
 
-    if (g_strcmp0 (g_dbus_proxy_get_name (proxy), name) == 0) {
-      g_debug ("Removing '%s' from known players", name);
-      g_list_store_remove (self->known_players, i);
-      return;
-    }
+  if (g_list_store_find (self->known_players, player, &pos)) {
+    g_debug ("Removing '%s' from known players", name);
+    g_list_store_remove (self->known_players, pos);
   }
+  g_hash_table_remove (self->players, name);
 }
 
 
@@ -208,7 +201,10 @@ on_attach_player_ready (GObject *source_object, GAsyncResult *res, gpointer user
   g_return_if_fail (PHOSH_IS_MPRIS_MANAGER (self));
 
   add_to_known_players (self, player);
-  phosh_mpris_manager_set_player (self, player);
+  /* Another attach for the same name might have won the race, use the registered proxy */
+  phosh_mpris_manager_set_player (self,
+                                  g_hash_table_lookup (self->players,
+                                                       g_dbus_proxy_get_name (G_DBUS_PROXY (player))));
 }
 
 
@@ -242,19 +238,27 @@ on_attach_mpris_ready (GObject *source_object, GAsyncResult *res, gpointer user_
 static void
 attach_player (PhoshMprisManager *self, const char *name)
 {
+  PhoshDBusMediaPlayer2Player *player;
+
   g_clear_object (&self->mpris);
-  phosh_mpris_manager_set_player (self, NULL);
 
   g_debug ("Trying to attach player for %s", name);
 
   /* The player interface with the controls */
-  phosh_dbus_media_player2_player_proxy_new_for_bus (G_BUS_TYPE_SESSION,
-                                                     G_DBUS_PROXY_FLAGS_DO_NOT_AUTO_START,
-                                                     name,
-                                                     MPRIS_OBJECT_PATH,
-                                                     self->cancel,
-                                                     on_attach_player_ready,
-                                                     self);
+  player = g_hash_table_lookup (self->players, name);
+  if (player) {
+    g_debug ("Reusing known player for %s", name);
+    phosh_mpris_manager_set_player (self, player);
+  } else {
+    phosh_mpris_manager_set_player (self, NULL);
+    phosh_dbus_media_player2_player_proxy_new_for_bus (G_BUS_TYPE_SESSION,
+                                                       G_DBUS_PROXY_FLAGS_DO_NOT_AUTO_START,
+                                                       name,
+                                                       MPRIS_OBJECT_PATH,
+                                                       self->cancel,
+                                                       on_attach_player_ready,
+                                                       self);
+  }
 
   /* The player base interface to e.g. raise the player */
   phosh_dbus_media_player2_proxy_new_for_bus (G_BUS_TYPE_SESSION,
@@ -392,7 +396,7 @@ on_bus_get_finished (GObject *source_object, GAsyncResult *res, gpointer user_da
 
   g_return_if_fail (PHOSH_IS_MPRIS_MANAGER (self));
   self->session_bus = session_bus;
-  /* Listen for name owner changes to detect new mpris players */
+  /* Listen for name owner changes to detect new mpris players, only for MPRIS names */
   /* We don't need to hold a ref since the callback won't be invoked after unsubscribe
    * from the same thread */
   self->dbus_id = g_dbus_connection_signal_subscribe (self->session_bus,
@@ -400,8 +404,8 @@ on_bus_get_finished (GObject *source_object, GAsyncResult *res, gpointer user_da
                                                       "org.freedesktop.DBus",
                                                       "NameOwnerChanged",
                                                       "/org/freedesktop/DBus",
-                                                      NULL,
-                                                      G_DBUS_SIGNAL_FLAGS_NONE,
+                                                      "org.mpris.MediaPlayer2",
+                                                      G_DBUS_SIGNAL_FLAGS_MATCH_ARG0_NAMESPACE,
                                                       on_dbus_name_owner_changed,
                                                       self, NULL);
   /* Find player initially */
@@ -414,6 +418,7 @@ phosh_mpris_manager_init (PhoshMprisManager *self)
 {
   self->cancel = g_cancellable_new ();
   self->known_players = g_list_store_new (PHOSH_DBUS_TYPE_MEDIA_PLAYER2_PLAYER);
+  self->players = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
 
   g_bus_get (G_BUS_TYPE_SESSION,
              self->cancel,
@@ -47,6 +47,7 @@ struct _PhoshNetworkAuthManager {
   NMDeviceWifi           *dev;
   ShellNetworkAgent      *network_agent;
   PhoshNetworkAuthPrompt *network_prompt;
+  GBinding               *network_prompt_binding;
 };
 G_DEFINE_TYPE (PhoshNetworkAuthManager, phosh_network_auth_manager, G_TYPE_OBJECT);
 
@@ -56,32 +57,42 @@ network_prompt_done_cb (PhoshNetworkAuthManager *self)
 {
   g_return_if_fail (PHOSH_IS_NETWORK_AUTH_MANAGER (self));
 
-  g_clear_pointer ((PhoshSystemModalDialog**)&self->network_prompt,
-                   phosh_system_modal_dialog_close);
+  if (!self->network_prompt)
+    return;
+
+  /* Keep the prompt around so the next request doesn't need to build it again */
+  g_clear_pointer (&self->network_prompt_binding, g_binding_unbind);
+  phosh_network_auth_prompt_clear_request (self->network_prompt);
+  phosh_system_modal_dialog_close (PHOSH_SYSTEM_MODAL_DIALOG (self->network_prompt));
 }
 
 
 static void
 network_agent_setup_prompt (PhoshNetworkAuthManager *self)
 {
-  GtkWidget *network_prompt;
+  PhoshShell *shell = phosh_shell_get_default ();
 
   g_return_if_fail (PHOSH_IS_NETWORK_AUTH_MANAGER (self));
 
-  if (self->network_prompt)
+  if (self->network_prompt_binding)
     return;
 
-  network_prompt = phosh_network_auth_prompt_new (self->network_agent);
-  self->network_prompt = PHOSH_NETWORK_AUTH_PROMPT (network_prompt);
+  if (!self->network_prompt) {
+    GtkWidget *network_prompt = phosh_network_auth_prompt_new (self->network_agent);
 
-  g_signal_connect_object (self->network_prompt, "done",
-                           G_CALLBACK (network_prompt_done_cb),
-                           self, G_CONNECT_SWAPPED);
+    self->network_prompt = PHOSH_NETWORK_AUTH_PROMPT (g_object_ref_sink (network_prompt));
+    phosh_system_modal_dialog_set_reusable (PHOSH_SYSTEM_MODAL_DIALOG (self->network_prompt), TRUE);
+    g_signal_connect_object (self->network_prompt, "done",
+                             G_CALLBACK (network_prompt_done_cb),
+                             self, G_CONNECT_SWAPPED);
+  }
 
   /* Show widget when not locked and keep that in sync */
-  g_object_bind_property (phosh_shell_get_default (), "locked",
-                          self->network_prompt, "visible",
-                          G_BINDING_SYNC_CREATE | G_BINDING_INVERT_BOOLEAN);
+  self->network_prompt_binding = g_object_bind_property (shell, "locked",
+                                                         self->network_prompt, "visible",
+                                                         G_BINDING_INVERT_BOOLEAN);
+  if (!phosh_shell_get_locked (shell))
+    phosh_system_modal_dialog_present (PHOSH_SYSTEM_MODAL_DIALOG (self->network_prompt));
 }
 
 
@@ -610,8 +621,6 @@ secret_request_new_cb (PhoshNetworkAuthManager     *self,
     return;
   }
 
-  g_return_if_fail (!self->network_prompt);
-
   network_agent_setup_prompt (self);
   ret = phosh_network_auth_prompt_set_request (self->network_prompt,
                                                request_id, connection, setting_name,
@@ -709,6 +718,18 @@ setup_network_agent (PhoshNetworkAuthManager *self)
 }
 
 
+static void
+on_shell_locked_changed (PhoshNetworkAuthManager *self, GParamSpec *pspec, PhoshShell *shell)
+{
+  if (!phosh_shell_get_locked (shell))
+    return;
+
+  /* Don't keep secrets around in memory while locked */
+  if (self->network_agent)
+    shell_network_agent_clear_secrets_cache (self->network_agent);
+}
+
+
 static void
 phosh_network_auth_manager_constructed (GObject *object)
 {
@@ -717,6 +738,9 @@ phosh_network_auth_manager_constructed (GObject *object)
   self->cancel = g_cancellable_new ();
 
   setup_network_agent (self);
+  g_signal_connect_object (phosh_shell_get_default (), "notify::locked",
+                           G_CALLBACK (on_shell_locked_changed), self,
+                           G_CONNECT_SWAPPED);
   g_debug ("Network-auth-manager initialized");
 
   G_OBJECT_CLASS (phosh_network_auth_manager_parent_class)->constructed (object);
@@ -734,6 +758,11 @@ phosh_network_auth_manager_dispose (GObject *object)
   g_cancellable_cancel (self->cancel);
   g_clear_object (&self->cancel);
 
+  g_clear_pointer (&self->network_prompt_binding, g_binding_unbind);
+  if (self->network_prompt)
+    gtk_widget_destroy (GTK_WIDGET (self->network_prompt));
+  g_clear_object (&self->network_prompt);
+
   g_clear_object (&self->network_agent);
 
   G_OBJECT_CLASS (phosh_network_auth_manager_parent_class)->dispose (object);
@@ -480,6 +480,24 @@ phosh_network_auth_prompt_new (ShellNetworkAgent *agent)
 }
 
 
+/**
+ * phosh_network_auth_prompt_clear_request:
+ * @self: The prompt
+ *
+ * Drops the current request and the entered secrets so the prompt
+ * can be used for another request.
+ */
+void
+phosh_network_auth_prompt_clear_request (PhoshNetworkAuthPrompt *self)
+{
+  g_return_if_fail (PHOSH_IS_NETWORK_AUTH_PROMPT (self));
+
+  g_clear_pointer (&self->request_id, g_free);
+  g_clear_pointer (&self->secrets, g_ptr_array_unref);
+  g_clear_object (&self->connection);
+  gtk_entry_buffer_set_text (GTK_ENTRY_BUFFER (self->password_buffer), "", -1);
+}
+
 /**
  * phosh_network_auth_prompt_set_request:
  * @self: The prompt
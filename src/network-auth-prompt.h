@@ -41,4 +41,5 @@ gboolean   phosh_network_auth_prompt_set_request (PhoshNetworkAuthPrompt
                                                   const char                    *title,
                                                   const char                    *message,
                                                   GPtrArray                     *secrets);
+void       phosh_network_auth_prompt_clear_request (PhoshNetworkAuthPrompt *self);
 G_END_DECLS
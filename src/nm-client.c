@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "phosh-nm-client"
+
+#include "phosh-config.h"
+
+#include "nm-client.h"
+
+/**
+ * PhoshNmClient:
+ *
+ * A `NMClient` shared between all NetworkManager consumers
+ *
+ * Each `NMClient` keeps its own cache of NetworkManager's objects and
+ * adds its own D-Bus match rules. To avoid that all consumers should
+ * get the client via [func@nm_client_get_async]. The client is created
+ * on the first request and kept around as long as there are users.
+ * Requests made while the client initializes are completed once it's
+ * ready.
+ */
+
+/* (transfer none): Weak pointer to the shared client */
+static NMClient *shared_client;
+/* Requests waiting for the client to initialize */
+static GPtrArray *pending_tasks;
+
+
+static void
+on_nm_client_ready (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+  g_autoptr (GError) err = NULL;
+  g_autoptr (GPtrArray) tasks = g_steal_pointer (&pending_tasks);
+  g_autoptr (NMClient) client = NULL;
+
+  client = nm_client_new_finish (res, &err);
+  if (client) {
+    g_debug ("Shared NM client ready");
+    shared_client = client;
+    g_object_add_weak_pointer (G_OBJECT (shared_client), (gpointer *)&shared_client);
+  }
+
+  for (guint i = 0; i < tasks->len; i++) {
+    GTask *task = g_ptr_array_index (tasks, i);
+
+    if (client)
+      g_task_return_pointer (task, g_object_ref (client), g_object_unref);
+    else
+      g_task_return_error (task, g_error_copy (err));
+  }
+}
+
+/**
+ * phosh_nm_client_get_async:
+ * @cancellable: (nullable): A cancellable
+ * @callback: The callback to invoke once the client is ready
+ * @user_data: The user data for the callback
+ *
+ * Get the shared `NMClient`. Use [func@nm_client_get_finish] in the
+ * callback to get the result.
+ */
+void
+phosh_nm_client_get_async (GCancellable        *cancellable,
+                           GAsyncReadyCallback  callback,
+                           gpointer             user_data)
+{
+  g_autoptr (GTask) task = NULL;
+
+  task = g_task_new (NULL, cancellable, callback, user_data);
+  g_task_set_source_tag (task, phosh_nm_client_get_async);
+
+  if (shared_client) {
+    g_task_return_pointer (task, g_object_ref (shared_client), g_object_unref);
+    return;
+  }
+
+  if (pending_tasks) {
+    g_ptr_array_add (pending_tasks, g_steal_pointer (&task));
+    return;
+  }
+
+  pending_tasks = g_ptr_array_new_with_free_func (g_object_unref);
+  g_ptr_array_add (pending_tasks, g_steal_pointer (&task));
+
+  /* Not cancellable as other requests might depend on it */
+  nm_client_new_async (NULL, on_nm_client_ready, NULL);
+}
+
+/**
+ * phosh_nm_client_get_finish:
+ * @res: The async result
+ * @error: The error location
+ *
+ * Finish getting the shared `NMClient`.
+ *
+ * Returns:(transfer full): The client or %NULL on error
+ */
+NMClient *
+phosh_nm_client_get_finish (GAsyncResult *res, GError **error)
+{
+  g_return_val_if_fail (g_task_is_valid (res, NULL), NULL);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (res)) == phosh_nm_client_get_async, NULL);
+
+  return g_task_propagate_pointer (G_TASK (res), error);
+}
@@ -0,0 +1,19 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <NetworkManager.h>
+
+G_BEGIN_DECLS
+
+void      phosh_nm_client_get_async  (GCancellable        *cancellable,
+                                      GAsyncReadyCallback  callback,
+                                      gpointer             user_data);
+NMClient *phosh_nm_client_get_finish (GAsyncResult        *res,
+                                      GError             **error);
+
+G_END_DECLS
@@ -43,6 +43,9 @@ struct _PhoshNotificationContent {
 
   gboolean   show_body;
   GStrv      action_filter_keys;
+
+  /* Whether image and actions got set up */
+  gboolean   populated;
 };
 typedef struct _PhoshNotificationContent PhoshNotificationContent;
 
@@ -224,10 +227,12 @@ on_actions_changed (PhoshNotification        *notification,
 
 
 static void
-phosh_notification_content_set_notification (PhoshNotificationContent *self,
-                                             PhoshNotification        *notification)
+populate (PhoshNotificationContent *self)
 {
-  g_set_object (&self->notification, notification);
+  if (self->populated || self->notification == NULL)
+    return;
+
+  self->populated = TRUE;
 
   /* Use the "transform" function to show/hide when set/unset */
   g_object_bind_property_full (self->notification, "image",
@@ -238,6 +243,21 @@ phosh_notification_content_set_notification (PhoshNotificationContent *self,
                                self,
                                NULL);
 
+  g_signal_connect_object (self->notification, "notify::actions",
+                           G_CALLBACK (on_actions_changed), self, 0);
+  set_actions (self, self->notification);
+}
+
+
+static void
+phosh_notification_content_set_notification (PhoshNotificationContent *self,
+                                             PhoshNotification        *notification)
+{
+  g_set_object (&self->notification, notification);
+
+  /* Image and actions are only set up once shown, see populate () */
+  gtk_widget_set_visible (self->img_image, FALSE);
+
   g_object_bind_property_full (self->notification, "summary",
                                self->lbl_summary,  "label",
                                G_BINDING_SYNC_CREATE,
@@ -254,10 +274,6 @@ phosh_notification_content_set_notification (PhoshNotificationContent *self,
                                self,
                                NULL);
 
-  g_signal_connect_object (self->notification, "notify::actions",
-                           G_CALLBACK (on_actions_changed), self, 0);
-  set_actions (self, self->notification);
-
   g_object_notify_by_pspec (G_OBJECT (self), props[PROP_NOTIFICATION]);
 }
 
@@ -314,6 +330,22 @@ phosh_notification_content_get_property (GObject    *object,
 }
 
 
+static void
+phosh_notification_content_map (GtkWidget *widget)
+{
+  PhoshNotificationContent *self = PHOSH_NOTIFICATION_CONTENT (widget);
+
+  /*
+   * Rows in the message tray are created for every notification, defer
+   * the expensive bits (image loading, action buttons) until the row is
+   * actually shown.
+   */
+  populate (self);
+
+  GTK_WIDGET_CLASS (phosh_notification_content_parent_class)->map (widget);
+}
+
+
 static void
 phosh_notification_content_finalize (GObject *object)
 {
@@ -336,6 +368,8 @@ phosh_notification_content_class_init (PhoshNotificationContentClass *klass)
   object_class->set_property = phosh_notification_content_set_property;
   object_class->get_property = phosh_notification_content_get_property;
 
+  widget_class->map = phosh_notification_content_map;
+
   /**
    * PhoshNotificationContent:notification:
    * @self: the #PhoshNotificationContent
@@ -9,8 +9,18 @@
 #define G_LOG_DOMAIN "phosh-notification-list"
 
 #include "phosh-config.h"
+#include "dbus-notification.h"
 #include "notification-source.h"
 #include "notification-list.h"
+#include "memory-stats.h"
+
+#include <gio/gdesktopappinfo.h>
+#include <glib/gstdio.h>
+
+#include <errno.h>
+#include <string.h>
+
+#define SPILL_RECORD_TYPE "(sa{sv})"
 
 /**
  * PhoshNotificationList:
@@ -19,8 +29,29 @@
  *
  * #PhoshNotificationList maps between #PhoshNotificationSource objects and their
  * notifications creating and removing sources on the fly.
+ *
+ * To bound memory use the oldest notifications are spilled to disk
+ * once a source or the whole list exceeds
+ * [property@NotificationList:max-per-source] or
+ * [property@NotificationList:max-total]. They're loaded back via
+ * [method@NotificationList.load_spilled] or once the source has no other
+ * notifications left.
  */
 
+enum {
+  PROP_0,
+  PROP_MAX_PER_SOURCE,
+  PROP_MAX_TOTAL,
+  LAST_PROP
+};
+static GParamSpec *props[LAST_PROP];
+
+enum {
+  NOTIFICATION_RESTORED,
+  N_SIGNALS
+};
+static guint signals[N_SIGNALS];
+
 
 struct _PhoshNotificationList {
   GObject     parent;
@@ -40,6 +71,10 @@ struct _PhoshNotificationList {
 
   /* Map of id -> notification */
   GHashTable *notifications;
+
+  guint       max_per_source;
+  guint       max_total;
+  char       *spill_dir;
 };
 typedef struct _PhoshNotificationList PhoshNotificationList;
 
@@ -49,12 +84,120 @@ static void list_iface_init (GListModelInterface *iface);
 G_DEFINE_TYPE_WITH_CODE (PhoshNotificationList, phosh_notification_list, G_TYPE_OBJECT,
                          G_IMPLEMENT_INTERFACE (G_TYPE_LIST_MODEL, list_iface_init))
 
+static void restore_source (PhoshNotificationList *self, PhoshNotificationSource *source);
+
+
+static char *
+get_spill_path (PhoshNotificationList *self, PhoshNotificationSource *source)
+{
+  g_autofree char *checksum = NULL;
+  g_autofree char *filename = NULL;
+
+  checksum = g_compute_checksum_for_string (G_CHECKSUM_SHA1,
+                                            phosh_notification_source_get_name (source),
+                                            -1);
+  filename = g_strdup_printf ("%s.log", checksum);
+
+  return g_build_filename (self->spill_dir, filename, NULL);
+}
+
+
+static void
+phosh_notification_list_set_property (GObject      *object,
+                                      guint         property_id,
+                                      const GValue *value,
+                                      GParamSpec   *pspec)
+{
+  PhoshNotificationList *self = PHOSH_NOTIFICATION_LIST (object);
+
+  switch (property_id) {
+  case PROP_MAX_PER_SOURCE:
+    phosh_notification_list_set_max_per_source (self, g_value_get_uint (value));
+    break;
+  case PROP_MAX_TOTAL:
+    phosh_notification_list_set_max_total (self, g_value_get_uint (value));
+    break;
+  default:
+    G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    break;
+  }
+}
+
+
+static void
+phosh_notification_list_get_property (GObject    *object,
+                                      guint       property_id,
+                                      GValue     *value,
+                                      GParamSpec *pspec)
+{
+  PhoshNotificationList *self = PHOSH_NOTIFICATION_LIST (object);
+
+  switch (property_id) {
+  case PROP_MAX_PER_SOURCE:
+    g_value_set_uint (value, self->max_per_source);
+    break;
+  case PROP_MAX_TOTAL:
+    g_value_set_uint (value, self->max_total);
+    break;
+  default:
+    G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    break;
+  }
+}
+
+
+static guint64
+get_icon_bytes (GIcon *icon)
+{
+  if (GDK_IS_PIXBUF (icon))
+    return gdk_pixbuf_get_byte_length (GDK_PIXBUF (icon));
+
+  return 0;
+}
+
+
+static void
+report_memory (gpointer data, guint64 *n_items, guint64 *bytes)
+{
+  PhoshNotificationList *self = PHOSH_NOTIFICATION_LIST (data);
+  GHashTableIter iter;
+  gpointer value;
+
+  *n_items = g_hash_table_size (self->notifications);
+
+  /* Only image data sent along with the notification is owned by us */
+  g_hash_table_iter_init (&iter, self->notifications);
+  while (g_hash_table_iter_next (&iter, NULL, &value)) {
+    PhoshNotification *notification = PHOSH_NOTIFICATION (value);
+
+    *bytes += get_icon_bytes (phosh_notification_get_image (notification));
+    *bytes += get_icon_bytes (phosh_notification_get_app_icon (notification));
+  }
+}
+
 
 static void
 phosh_notification_list_finalize (GObject *object)
 {
   PhoshNotificationList *self = PHOSH_NOTIFICATION_LIST (object);
+  GSequenceIter *iter;
+
+  phosh_memory_stats_unregister (self);
+
+  /* Spilled notifications don't outlive the list */
+  for (iter = g_sequence_get_begin_iter (self->source_list);
+       !g_sequence_iter_is_end (iter);
+       iter = g_sequence_iter_next (iter)) {
+    PhoshNotificationSource *source = g_sequence_get (iter);
+
+    if (phosh_notification_source_get_n_spilled (source)) {
+      g_autofree char *path = get_spill_path (self, source);
 
+      g_unlink (path);
+    }
+  }
+
+  g_clear_pointer (&self->spill_dir, g_free);
   g_clear_pointer (&self->source_list, g_sequence_free);
   g_clear_pointer (&self->source_map, g_hash_table_unref);
 
@@ -70,6 +213,49 @@ phosh_notification_list_class_init (PhoshNotificationListClass *klass)
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
 
   object_class->finalize = phosh_notification_list_finalize;
+  object_class->set_property = phosh_notification_list_set_property;
+  object_class->get_property = phosh_notification_list_get_property;
+
+  /**
+   * PhoshNotificationList:max-per-source:
+   *
+   * The maximum number of notifications per source kept in memory.
+   * Older ones are spilled to disk. `0` means no limit.
+   */
+  props[PROP_MAX_PER_SOURCE] =
+    g_param_spec_uint ("max-per-source", "", "",
+                       0, G_MAXUINT, 0,
+                       G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+  /**
+   * PhoshNotificationList:max-total:
+   *
+   * The maximum number of notifications kept in memory. The oldest
+   * notifications of the least recently used sources are spilled to
+   * disk first. Each source keeps at least its latest
+   * notification. `0` means no limit.
+   */
+  props[PROP_MAX_TOTAL] =
+    g_param_spec_uint ("max-total", "", "",
+                       0, G_MAXUINT, 0,
+                       G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties (object_class, LAST_PROP, props);
+
+  /**
+   * PhoshNotificationList::notification-restored:
+   * @self: The notification list
+   * @notification: The restored notification
+   *
+   * A notification that was spilled to disk got loaded back into
+   * the list.
+   */
+  signals[NOTIFICATION_RESTORED] = g_signal_new ("notification-restored",
+                                                 G_TYPE_FROM_CLASS (klass),
+                                                 G_SIGNAL_RUN_LAST,
+                                                 0, NULL, NULL, NULL,
+                                                 G_TYPE_NONE,
+                                                 1,
+                                                 PHOSH_TYPE_NOTIFICATION);
 }
 
 
@@ -141,6 +327,10 @@ phosh_notification_list_init (PhoshNotificationList *self)
                                                g_direct_equal,
                                                NULL,
                                                NULL);
+
+  self->spill_dir = g_build_filename (g_get_user_cache_dir (), "phosh", "notifications", NULL);
+
+  phosh_memory_stats_register ("notifications", report_memory, self);
 }
 
 
@@ -177,6 +367,13 @@ empty (PhoshNotificationSource *source,
   g_return_if_fail (PHOSH_IS_NOTIFICATION_LIST (self));
   g_return_if_fail (PHOSH_IS_NOTIFICATION_SOURCE (source));
 
+  /* Show older notifications once the in memory ones are gone */
+  if (phosh_notification_source_get_n_spilled (source)) {
+    restore_source (self, source);
+    if (g_list_model_get_n_items (G_LIST_MODEL (source)))
+      return;
+  }
+
   source_id = phosh_notification_source_get_name (source);
 
   iter = g_hash_table_lookup (self->source_map, source_id);
@@ -222,6 +419,327 @@ closed (PhoshNotification       *notification,
 }
 
 
+static GVariant *
+serialize_notification (PhoshNotification *notification)
+{
+  GVariantBuilder builder;
+  GType type = G_OBJECT_TYPE (notification);
+  GDateTime *timestamp;
+  GAppInfo *info;
+  GIcon *icon;
+  GStrv actions;
+  struct {
+    const char *key;
+    const char *value;
+  } strings[] = {
+    { "app-name", phosh_notification_get_app_name (notification) },
+    { "summary", phosh_notification_get_summary (notification) },
+    { "body", phosh_notification_get_body (notification) },
+    { "category", phosh_notification_get_category (notification) },
+    { "profile", phosh_notification_get_profile (notification) },
+    { "sound-file", phosh_notification_get_sound_file (notification) },
+  };
+
+  /* Subclasses like mount notifications carry state we can't restore */
+  if (type != PHOSH_TYPE_NOTIFICATION && type != PHOSH_TYPE_DBUS_NOTIFICATION)
+    return NULL;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
+
+  g_variant_builder_add (&builder, "{sv}", "id",
+                         g_variant_new_uint32 (phosh_notification_get_id (notification)));
+  for (int i = 0; i < G_N_ELEMENTS (strings); i++) {
+    if (strings[i].value)
+      g_variant_builder_add (&builder, "{sv}", strings[i].key, g_variant_new_string (strings[i].value));
+  }
+  g_variant_builder_add (&builder, "{sv}", "urgency",
+                         g_variant_new_uint32 (phosh_notification_get_urgency (notification)));
+  g_variant_builder_add (&builder, "{sv}", "transient",
+                         g_variant_new_boolean (phosh_notification_get_transient (notification)));
+  g_variant_builder_add (&builder, "{sv}", "resident",
+                         g_variant_new_boolean (phosh_notification_get_resident (notification)));
+
+  actions = phosh_notification_get_actions (notification);
+  if (actions)
+    g_variant_builder_add (&builder, "{sv}", "actions", g_variant_new_strv ((const char * const *)actions, -1));
+
+  timestamp = phosh_notification_get_timestamp (notification);
+  if (timestamp)
+    g_variant_builder_add (&builder, "{sv}", "timestamp",
+                           g_variant_new_int64 (g_date_time_to_unix_usec (timestamp)));
+
+  info = phosh_notification_get_app_info (notification);
+  if (info && g_app_info_get_id (info))
+    g_variant_builder_add (&builder, "{sv}", "app-info", g_variant_new_string (g_app_info_get_id (info)));
+
+  icon = phosh_notification_get_app_icon (notification);
+  if (icon) {
+    GVariant *serialized = g_icon_serialize (icon);
+
+    if (serialized)
+      g_variant_builder_add (&builder, "{sv}", "app-icon", serialized);
+  }
+
+  icon = phosh_notification_get_image (notification);
+  if (icon) {
+    GVariant *serialized = g_icon_serialize (icon);
+
+    if (serialized)
+      g_variant_builder_add (&builder, "{sv}", "image", serialized);
+  }
+
+  return g_variant_ref_sink (g_variant_new (SPILL_RECORD_TYPE, g_type_name (type), &builder));
+}
+
+
+static PhoshNotification *
+deserialize_notification (GVariant *record)
+{
+  g_autoptr (GVariant) props = NULL;
+  g_autoptr (GVariant) value = NULL;
+  g_autoptr (GIcon) icon = NULL;
+  g_autoptr (GDateTime) timestamp = NULL;
+  g_autofree char *app_info_id = NULL;
+  g_autofree const char **actions = NULL;
+  PhoshNotification *notification;
+  const char *type_name, *str;
+  gboolean boolean;
+  gint64 usec;
+  guint32 u32;
+  GType type;
+
+  g_variant_get (record, "(&s@a{sv})", &type_name, &props);
+
+  type = g_type_from_name (type_name);
+  if (type != PHOSH_TYPE_NOTIFICATION && type != PHOSH_TYPE_DBUS_NOTIFICATION) {
+    g_warning ("Can't restore notification of type %s", type_name);
+    return NULL;
+  }
+
+  notification = g_object_new (type, NULL);
+
+  if (g_variant_lookup (props, "id", "u", &u32))
+    phosh_notification_set_id (notification, u32);
+  if (g_variant_lookup (props, "app-name", "&s", &str))
+    phosh_notification_set_app_name (notification, str);
+
+  value = g_variant_lookup_value (props, "app-icon", NULL);
+  if (value) {
+    icon = g_icon_deserialize (value);
+    phosh_notification_set_app_icon (notification, icon);
+    g_clear_object (&icon);
+    g_clear_pointer (&value, g_variant_unref);
+  }
+
+  /* Set info after fallback name and icon */
+  if (g_variant_lookup (props, "app-info", "s", &app_info_id)) {
+    g_autoptr (GDesktopAppInfo) info = g_desktop_app_info_new (app_info_id);
+
+    if (info)
+      phosh_notification_set_app_info (notification, G_APP_INFO (info));
+  }
+
+  value = g_variant_lookup_value (props, "image", NULL);
+  if (value) {
+    icon = g_icon_deserialize (value);
+    phosh_notification_set_image (notification, icon);
+    g_clear_pointer (&value, g_variant_unref);
+  }
+
+  if (g_variant_lookup (props, "summary", "&s", &str))
+    phosh_notification_set_summary (notification, str);
+  if (g_variant_lookup (props, "body", "&s", &str))
+    phosh_notification_set_body (notification, str);
+  if (g_variant_lookup (props, "urgency", "u", &u32))
+    phosh_notification_set_urgency (notification, u32);
+  if (g_variant_lookup (props, "actions", "^a&s", &actions))
+    phosh_notification_set_actions (notification, (GStrv) actions);
+  if (g_variant_lookup (props, "transient", "b", &boolean))
+    phosh_notification_set_transient (notification, boolean);
+  if (g_variant_lookup (props, "resident", "b", &boolean))
+    phosh_notification_set_resident (notification, boolean);
+  if (g_variant_lookup (props, "category", "&s", &str))
+    phosh_notification_set_category (notification, str);
+  if (g_variant_lookup (props, "profile", "&s", &str))
+    phosh_notification_set_profile (notification, str);
+  if (g_variant_lookup (props, "sound-file", "&s", &str))
+    phosh_notification_set_sound_file (notification, str);
+  if (g_variant_lookup (props, "timestamp", "x", &usec)) {
+    timestamp = g_date_time_new_from_unix_usec_local (usec);
+    phosh_notification_set_timestamp (notification, timestamp);
+  }
+
+  return notification;
+}
+
+
+static gboolean
+write_spill_record (PhoshNotificationList *self, const char *path, GVariant *record, gboolean truncate)
+{
+  g_autoptr (GError) err = NULL;
+  g_autoptr (GFile) file = g_file_new_for_path (path);
+  g_autoptr (GFileOutputStream) stream = NULL;
+  guint32 size = GUINT32_TO_LE (g_variant_get_size (record));
+
+  if (g_mkdir_with_parents (self->spill_dir, 0700) < 0) {
+    g_warning ("Failed to create %s: %s", self->spill_dir, g_strerror (errno));
+    return FALSE;
+  }
+
+  /* The first record of a source overwrites anything left over from previous sessions */
+  if (truncate)
+    stream = g_file_replace (file, NULL, FALSE, G_FILE_CREATE_PRIVATE, NULL, &err);
+  else
+    stream = g_file_append_to (file, G_FILE_CREATE_PRIVATE, NULL, &err);
+
+  if (stream == NULL ||
+      !g_output_stream_write_all (G_OUTPUT_STREAM (stream), &size, sizeof (size), NULL, NULL, &err) ||
+      !g_output_stream_write_all (G_OUTPUT_STREAM (stream),
+                                  g_variant_get_data (record),
+                                  g_variant_get_size (record),
+                                  NULL, NULL, &err) ||
+      !g_output_stream_close (G_OUTPUT_STREAM (stream), NULL, &err)) {
+    g_warning ("Failed to spill notification to %s: %s", path, err->message);
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+
+static gboolean
+spill_oldest (PhoshNotificationList *self, PhoshNotificationSource *source)
+{
+  g_autoptr (PhoshNotification) oldest = NULL;
+  g_autoptr (GVariant) record = NULL;
+  g_autofree char *path = NULL;
+  guint n_items, n_spilled;
+
+  /* Always keep the latest notification around */
+  n_items = g_list_model_get_n_items (G_LIST_MODEL (source));
+  if (n_items < 2)
+    return FALSE;
+
+  oldest = g_list_model_get_item (G_LIST_MODEL (source), n_items - 1);
+  record = serialize_notification (oldest);
+  if (record == NULL)
+    return FALSE;
+
+  path = get_spill_path (self, source);
+  n_spilled = phosh_notification_source_get_n_spilled (source);
+  if (!write_spill_record (self, path, record, n_spilled == 0))
+    return FALSE;
+
+  g_clear_object (&oldest);
+  oldest = phosh_notification_source_take_oldest (source);
+  g_signal_handlers_disconnect_by_func (oldest, closed, self);
+  g_hash_table_remove (self->notifications,
+                       GUINT_TO_POINTER (phosh_notification_get_id (oldest)));
+  phosh_notification_source_set_n_spilled (source, n_spilled + 1);
+
+  g_debug ("Spilled notification %u of %s", phosh_notification_get_id (oldest),
+           phosh_notification_source_get_name (source));
+
+  return TRUE;
+}
+
+
+static void
+enforce_limits (PhoshNotificationList *self, PhoshNotificationSource *source)
+{
+  GSequenceIter *iter;
+
+  if (self->max_per_source && source) {
+    while (g_list_model_get_n_items (G_LIST_MODEL (source)) > self->max_per_source) {
+      if (!spill_oldest (self, source))
+        break;
+    }
+  }
+
+  if (self->max_total == 0 || g_hash_table_size (self->notifications) <= self->max_total)
+    return;
+
+  /* Least recently used sources go first */
+  iter = g_sequence_get_end_iter (self->source_list);
+  while (!g_sequence_iter_is_begin (iter)) {
+    PhoshNotificationSource *lru_source;
+
+    iter = g_sequence_iter_prev (iter);
+    lru_source = g_sequence_get (iter);
+
+    while (g_hash_table_size (self->notifications) > self->max_total) {
+      if (!spill_oldest (self, lru_source))
+        break;
+    }
+
+    if (g_hash_table_size (self->notifications) <= self->max_total)
+      break;
+  }
+}
+
+
+static void
+restore_source (PhoshNotificationList *self, PhoshNotificationSource *source)
+{
+  g_autoptr (GError) err = NULL;
+  g_autoptr (GPtrArray) restored = NULL;
+  g_autofree char *path = NULL;
+  g_autofree char *contents = NULL;
+  gsize len, pos = 0;
+
+  if (phosh_notification_source_get_n_spilled (source) == 0)
+    return;
+
+  path = get_spill_path (self, source);
+  phosh_notification_source_set_n_spilled (source, 0);
+
+  if (!g_file_get_contents (path, &contents, &len, &err)) {
+    g_warning ("Failed to load spilled notifications: %s", err->message);
+    return;
+  }
+  g_unlink (path);
+
+  restored = g_ptr_array_new_with_free_func (g_object_unref);
+  while (pos + sizeof (guint32) <= len) {
+    g_autoptr (GVariant) record = NULL;
+    g_autoptr (GBytes) bytes = NULL;
+    PhoshNotification *notification;
+    guint32 size;
+
+    memcpy (&size, contents + pos, sizeof (size));
+    size = GUINT32_FROM_LE (size);
+    pos += sizeof (size);
+    if (size > len - pos) {
+      g_warning ("Truncated notification spill file %s", path);
+      break;
+    }
+
+    /* Copy as restored icons may reference the record's data */
+    bytes = g_bytes_new (contents + pos, size);
+    record = g_variant_ref_sink (g_variant_new_from_bytes (G_VARIANT_TYPE (SPILL_RECORD_TYPE),
+                                                           bytes,
+                                                           FALSE));
+    pos += size;
+
+    notification = deserialize_notification (record);
+    if (notification)
+      g_ptr_array_add (restored, notification);
+  }
+
+  /* Records were spilled oldest first, append the newest first */
+  for (int i = restored->len - 1; i >= 0; i--) {
+    PhoshNotification *notification = g_ptr_array_index (restored, i);
+
+    g_hash_table_insert (self->notifications,
+                         GUINT_TO_POINTER (phosh_notification_get_id (notification)),
+                         notification);
+    phosh_notification_source_append (source, notification);
+    g_signal_connect (notification, "closed", G_CALLBACK (closed), self);
+    g_signal_emit (self, signals[NOTIFICATION_RESTORED], 0, notification);
+  }
+}
+
+
 /**
  * phosh_notification_list_add:
  * @self: the #PhoshNotificationList
@@ -295,6 +813,8 @@ phosh_notification_list_add (PhoshNotificationList *self,
   phosh_notification_source_add (source, notification);
 
   g_signal_connect (notification, "closed", G_CALLBACK (closed), self);
+
+  enforce_limits (self, source);
 }
 
 
@@ -320,3 +840,49 @@ phosh_notification_list_get_by_id (PhoshNotificationList *self,
 
   return notification;
 }
+
+/**
+ * phosh_notification_list_load_spilled:
+ * @self: the #PhoshNotificationList
+ *
+ * Load all notifications that were spilled to disk back into @self.
+ */
+void
+phosh_notification_list_load_spilled (PhoshNotificationList *self)
+{
+  GSequenceIter *iter;
+
+  g_return_if_fail (PHOSH_IS_NOTIFICATION_LIST (self));
+
+  for (iter = g_sequence_get_begin_iter (self->source_list);
+       !g_sequence_iter_is_end (iter);
+       iter = g_sequence_iter_next (iter)) {
+    restore_source (self, g_sequence_get (iter));
+  }
+}
+
+
+void
+phosh_notification_list_set_max_per_source (PhoshNotificationList *self, guint max_per_source)
+{
+  g_return_if_fail (PHOSH_IS_NOTIFICATION_LIST (self));
+
+  if (self->max_per_source == max_per_source)
+    return;
+
+  self->max_per_source = max_per_source;
+  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_MAX_PER_SOURCE]);
+}
+
+
+void
+phosh_notification_list_set_max_total (PhoshNotificationList *self, guint max_total)
+{
+  g_return_if_fail (PHOSH_IS_NOTIFICATION_LIST (self));
+
+  if (self->max_total == max_total)
+    return;
+
+  self->max_total = max_total;
+  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_MAX_TOTAL]);
+}
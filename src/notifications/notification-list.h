@@ -27,5 +27,10 @@ void                   phosh_notification_list_add       (PhoshNotificationList
                                                           PhoshNotification     *notification);
 PhoshNotification     *phosh_notification_list_get_by_id (PhoshNotificationList *self,
                                                           guint                  id);
+void                   phosh_notification_list_load_spilled (PhoshNotificationList *self);
+void                   phosh_notification_list_set_max_per_source (PhoshNotificationList *self,
+                                                                   guint                  max_per_source);
+void                   phosh_notification_list_set_max_total (PhoshNotificationList *self,
+                                                              guint                  max_total);
 
 G_END_DECLS
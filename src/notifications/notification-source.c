@@ -27,6 +27,8 @@ typedef struct _PhoshNotificationSource {
   GListStore *list;
 
   char       *name;
+  /* Notifications moved out of memory by the #PhoshNotificationList */
+  guint       n_spilled;
 } PhoshNotificationSource;
 
 
@@ -255,6 +257,75 @@ phosh_notification_source_add (PhoshNotificationSource *self,
                            G_CONNECT_SWAPPED);
 }
 
+/**
+ * phosh_notification_source_append:
+ * @self: The notification source
+ * @notification: The notification
+ *
+ * Adds @notification at the end of the source, used for notifications
+ * older than all the others.
+ */
+void
+phosh_notification_source_append (PhoshNotificationSource *self,
+                                  PhoshNotification       *notification)
+{
+  g_return_if_fail (PHOSH_IS_NOTIFICATION_SOURCE (self));
+  g_return_if_fail (PHOSH_IS_NOTIFICATION (notification));
+
+  g_list_store_append (self->list, notification);
+
+  g_signal_connect_object (notification,
+                           "closed",
+                           G_CALLBACK (closed),
+                           self,
+                           G_CONNECT_SWAPPED);
+}
+
+/**
+ * phosh_notification_source_take_oldest:
+ * @self: The notification source
+ *
+ * Removes the oldest notification from @self without closing it.
+ *
+ * Returns:(transfer full)(nullable): The removed notification
+ */
+PhoshNotification *
+phosh_notification_source_take_oldest (PhoshNotificationSource *self)
+{
+  PhoshNotification *notification;
+  guint n_items;
+
+  g_return_val_if_fail (PHOSH_IS_NOTIFICATION_SOURCE (self), NULL);
+
+  n_items = g_list_model_get_n_items (G_LIST_MODEL (self->list));
+  if (n_items == 0)
+    return NULL;
+
+  notification = g_list_model_get_item (G_LIST_MODEL (self->list), n_items - 1);
+  g_signal_handlers_disconnect_by_func (notification, closed, self);
+  g_list_store_remove (self->list, n_items - 1);
+
+  return notification;
+}
+
+
+guint
+phosh_notification_source_get_n_spilled (PhoshNotificationSource *self)
+{
+  g_return_val_if_fail (PHOSH_IS_NOTIFICATION_SOURCE (self), 0);
+
+  return self->n_spilled;
+}
+
+
+void
+phosh_notification_source_set_n_spilled (PhoshNotificationSource *self, guint n_spilled)
+{
+  g_return_if_fail (PHOSH_IS_NOTIFICATION_SOURCE (self));
+
+  self->n_spilled = n_spilled;
+}
+
 
 const char *
 phosh_notification_source_get_name (PhoshNotificationSource *self)
@@ -25,5 +25,11 @@ PhoshNotificationSource *phosh_notification_source_new      (const char
 void                     phosh_notification_source_add      (PhoshNotificationSource *self,
                                                              PhoshNotification       *notification);
 const char              *phosh_notification_source_get_name (PhoshNotificationSource *self);
+void                     phosh_notification_source_append   (PhoshNotificationSource *self,
+                                                             PhoshNotification       *notification);
+PhoshNotification       *phosh_notification_source_take_oldest (PhoshNotificationSource *self);
+guint                    phosh_notification_source_get_n_spilled (PhoshNotificationSource *self);
+void                     phosh_notification_source_set_n_spilled (PhoshNotificationSource *self,
+                                                                  guint                    n_spilled);
 
 G_END_DECLS
@@ -19,6 +19,7 @@
 #include "notify-feedback.h"
 #include "shell-priv.h"
 #include "phosh-enums.h"
+#include "trace.h"
 #include "util.h"
 
 #include <gmobile.h>
@@ -32,6 +33,17 @@
 #define NOTIFICATIONS_APP_KEY_ENABLE "enable"
 
 #define NOTIFICATIONS_SPEC_VERSION "1.2"
+#define PHOSH_NOTIFICATIONS_SETTINGS_SCHEMA_ID "sm.puri.phosh.notifications"
+#define PHOSH_NOTIFICATIONS_KEY_RATE_LIMIT_BURST "rate-limit-burst"
+#define PHOSH_NOTIFICATIONS_KEY_RATE_LIMIT_RATE "rate-limit-rate"
+#define PHOSH_NOTIFICATIONS_KEY_COALESCE_WINDOW "coalesce-window"
+#define PHOSH_NOTIFICATIONS_KEY_MAX_PER_SOURCE "max-per-source"
+#define PHOSH_NOTIFICATIONS_KEY_MAX_TOTAL "max-total"
+/* Only prune idle rate limits once we have that many */
+#define RATE_LIMITS_PRUNE_SIZE 32
+
+/* Notification images are shown at 32px, leave room for scale 4 */
+#define NOTIFICATIONS_IMAGE_MAX_SIZE 128
 
 /**
  * PhoshNotifyManager:
@@ -65,6 +77,13 @@ typedef struct _PhoshNotifyManager
   GStrv app_children;
 
   GSettings *settings;
+  GSettings *phosh_settings;
+
+  /* key: source id, value: RateLimit */
+  GHashTable *rate_limits;
+  /* Notifications arriving in the coalescing window only get the last one announced */
+  guint coalesce_id;
+  PhoshNotification *pending_new;
 
   /* Notification to be handled on unlock */
   struct {
@@ -74,8 +93,24 @@ typedef struct _PhoshNotifyManager
 
   PhoshNotificationList *list;
   PhoshNotifyFeedback *feedback;
+
+  /* key: content hash, value: IconCacheEntry */
+  GHashTable *icon_cache;
 } PhoshNotifyManager;
 
+typedef struct {
+  PhoshNotifyManager *manager;
+  char               *key;
+  GIcon              *icon;
+} IconCacheEntry;
+
+typedef struct {
+  double tokens;
+  gint64 last_refill;
+  /* The last notification added for the source */
+  guint  last_id;
+} RateLimit;
+
 static void phosh_notify_manager_notify_iface_init (PhoshDBusNotificationsIface *iface);
 G_DEFINE_TYPE_WITH_CODE (PhoshNotifyManager,
                          phosh_notify_manager,
@@ -264,6 +299,27 @@ on_notification_closed (PhoshNotifyManager      *self,
 }
 
 
+static void
+connect_notification (PhoshNotifyManager *self, PhoshNotification *notification)
+{
+  g_signal_connect_object (notification,
+                           "expired",
+                           G_CALLBACK (on_notification_expired),
+                           self,
+                           G_CONNECT_SWAPPED);
+  g_signal_connect_object (notification,
+                           "actioned",
+                           G_CALLBACK (on_notification_actioned),
+                           self,
+                           G_CONNECT_SWAPPED);
+  g_signal_connect_object (notification,
+                           "closed",
+                           G_CALLBACK (on_notification_closed),
+                           self,
+                           G_CONNECT_SWAPPED);
+}
+
+
 static gboolean
 phosh_notify_manager_is_notification_enabled (PhoshNotification *notification)
 {
@@ -295,57 +351,149 @@ phosh_notify_manager_is_notification_enabled (PhoshNotification *notification)
 static GIcon *
 parse_icon_data (GVariant *variant)
 {
-  GVariant *wrapped_data = NULL;
-  guchar *data = NULL;
-  GIcon *icon = NULL;
+  g_autoptr (GVariant) wrapped_data = NULL;
+  g_autoptr (GBytes) bytes = NULL;
+  g_autoptr (GdkPixbuf) pixbuf = NULL;
   int width = 0;
   int height = 0;
   int row_stride = 0;
   int has_alpha = 0;
   int sample_size = 0;
   int channels = 0;
+  gsize size_should_be;
+  double scale;
 
-  if (g_variant_is_of_type (variant, G_VARIANT_TYPE ("(iiibiiay)"))) {
-    gsize size_should_be;
+  if (!g_variant_is_of_type (variant, G_VARIANT_TYPE ("(iiibiiay)")))
+    return NULL;
 
-    g_variant_get (variant,
-                   "(iiibii@ay)",
-                   &width,
-                   &height,
-                   &row_stride,
-                   &has_alpha,
-                   &sample_size,
-                   &channels,
-                   &wrapped_data);
+  g_variant_get (variant,
+                 "(iiibii@ay)",
+                 &width,
+                 &height,
+                 &row_stride,
+                 &has_alpha,
+                 &sample_size,
+                 &channels,
+                 &wrapped_data);
+
+  if (width <= 0 || height <= 0 || sample_size != 8 || channels != (has_alpha ? 4 : 3)) {
+    g_warning ("Rejecting image, unsupported format %dx%d, %d bits, %d channels",
+               width, height, sample_size, channels);
+    return NULL;
+  }
 
-    size_should_be = (height - 1) * row_stride + width * ((channels * sample_size + 7) / 8);
+  size_should_be = (height - 1) * row_stride + width * ((channels * sample_size + 7) / 8);
 
-    if (size_should_be != g_variant_get_size (wrapped_data)) {
-      g_warning ("Rejecting image, %" G_GSIZE_FORMAT
-                 " (expected) != %" G_GSIZE_FORMAT,
-                 size_should_be, g_variant_get_size (wrapped_data));
+  if (size_should_be != g_variant_get_size (wrapped_data)) {
+    g_warning ("Rejecting image, %" G_GSIZE_FORMAT
+               " (expected) != %" G_GSIZE_FORMAT,
+               size_should_be, g_variant_get_size (wrapped_data));
 
-      return NULL;
-    }
+    return NULL;
+  }
+
+  /* Reference the message's data rather than copying it */
+  bytes = g_variant_get_data_as_bytes (wrapped_data);
+  pixbuf = gdk_pixbuf_new_from_bytes (bytes,
+                                      GDK_COLORSPACE_RGB,
+                                      has_alpha,
+                                      sample_size,
+                                      width,
+                                      height,
+                                      row_stride);
+
+  if (MAX (width, height) <= NOTIFICATIONS_IMAGE_MAX_SIZE)
+    return G_ICON (g_steal_pointer (&pixbuf));
+
+  /* Downscale once so we don't keep full size images around for every notification */
+  scale = (double) NOTIFICATIONS_IMAGE_MAX_SIZE / MAX (width, height);
+  return G_ICON (gdk_pixbuf_scale_simple (pixbuf,
+                                          MAX (1, (int) (width * scale)),
+                                          MAX (1, (int) (height * scale)),
+                                          GDK_INTERP_BILINEAR));
+}
+
+
+static void
+on_cached_icon_finalized (gpointer data, GObject *where_the_object_was)
+{
+  IconCacheEntry *entry = data;
+
+  /* The last notification using the icon is gone */
+  entry->icon = NULL;
+  g_hash_table_remove (entry->manager->icon_cache, entry->key);
+}
+
+
+static void
+icon_cache_entry_free (IconCacheEntry *entry)
+{
+  if (entry->icon)
+    g_object_weak_unref (G_OBJECT (entry->icon), on_cached_icon_finalized, entry);
+
+  g_free (entry->key);
+  g_free (entry);
+}
+
+
+static GIcon *
+icon_cache_lookup (PhoshNotifyManager *self, const char *key)
+{
+  IconCacheEntry *entry = g_hash_table_lookup (self->icon_cache, key);
+
+  if (entry == NULL)
+    return NULL;
+
+  return g_object_ref (entry->icon);
+}
 
-    /* Extract a copy of the raw data */
-    data = (guchar *) g_memdup2 (g_variant_get_data (wrapped_data), size_should_be);
-
-    icon = G_ICON (gdk_pixbuf_new_from_data (data,
-                                             GDK_COLORSPACE_RGB,
-                                             has_alpha,
-                                             sample_size,
-                                             width,
-                                             height,
-                                             row_stride,
-                                             (GdkPixbufDestroyNotify) g_free,
-                                             NULL));
+
+static GIcon *
+icon_cache_insert (PhoshNotifyManager *self, char *key, GIcon *icon)
+{
+  IconCacheEntry *entry;
+
+  if (icon == NULL) {
+    g_free (key);
+    return NULL;
   }
 
+  /* The cache doesn't hold a reference, notifications do */
+  entry = g_new0 (IconCacheEntry, 1);
+  entry->manager = self;
+  entry->key = key;
+  entry->icon = icon;
+  g_object_weak_ref (G_OBJECT (icon), on_cached_icon_finalized, entry);
+  g_hash_table_replace (self->icon_cache, entry->key, entry);
+
   return icon;
 }
 
 
+static GIcon *
+get_icon_for_data (PhoshNotifyManager *self, GVariant *variant)
+{
+  g_autofree char *key = NULL;
+  g_autofree char *checksum = NULL;
+  GIcon *icon;
+
+  if (!g_variant_is_of_type (variant, G_VARIANT_TYPE ("(iiibiiay)")))
+    return NULL;
+
+  /* Senders usually send the same avatar over and over, only decode it once */
+  checksum = g_compute_checksum_for_data (G_CHECKSUM_SHA256,
+                                          g_variant_get_data (variant),
+                                          g_variant_get_size (variant));
+  key = g_strdup_printf ("data:%s", checksum);
+
+  icon = icon_cache_lookup (self, key);
+  if (icon)
+    return icon;
+
+  return icon_cache_insert (self, g_steal_pointer (&key), parse_icon_data (variant));
+}
+
+
 static GIcon *
 parse_icon_string (const char *string)
 {
@@ -370,6 +518,111 @@ parse_icon_string (const char *string)
 }
 
 
+static GIcon *
+get_icon_for_string (PhoshNotifyManager *self, const char *string)
+{
+  g_autofree char *key = NULL;
+  GIcon *icon;
+
+  if (string == NULL || strlen (string) < 1)
+    return NULL;
+
+  key = g_strdup_printf ("string:%s", string);
+
+  icon = icon_cache_lookup (self, key);
+  if (icon)
+    return icon;
+
+  return icon_cache_insert (self, g_steal_pointer (&key), parse_icon_string (string));
+}
+
+
+static void
+refill_rate_limit (RateLimit *limit, guint burst, guint rate, gint64 now)
+{
+  double refill = (double) (now - limit->last_refill) * rate / (60.0 * G_USEC_PER_SEC);
+
+  limit->tokens = MIN (limit->tokens + refill, burst);
+  limit->last_refill = now;
+}
+
+
+static void
+prune_rate_limits (PhoshNotifyManager *self, guint burst, guint rate, gint64 now)
+{
+  GHashTableIter iter;
+  gpointer value;
+
+  g_hash_table_iter_init (&iter, self->rate_limits);
+  while (g_hash_table_iter_next (&iter, NULL, &value)) {
+    RateLimit *limit = value;
+
+    refill_rate_limit (limit, burst, rate, now);
+    if (limit->tokens >= burst)
+      g_hash_table_iter_remove (&iter);
+  }
+}
+
+/*
+ * take_rate_limit_token:
+ * @self: The notify manager
+ * @source_id: The source of the notification
+ *
+ * Token bucket per notification source: each notification takes one
+ * token, tokens refill at `rate-limit-rate` per minute up to
+ * `rate-limit-burst`.
+ *
+ * Returns: The rate limit of the source or %NULL if the source is out
+ *   of tokens and the notification should be collapsed.
+ */
+static RateLimit *
+take_rate_limit_token (PhoshNotifyManager *self, const char *source_id)
+{
+  static RateLimit unlimited;
+  guint burst, rate;
+  RateLimit *limit;
+  gint64 now;
+
+  burst = g_settings_get_uint (self->phosh_settings, PHOSH_NOTIFICATIONS_KEY_RATE_LIMIT_BURST);
+  if (burst == 0)
+    return &unlimited;
+
+  rate = g_settings_get_uint (self->phosh_settings, PHOSH_NOTIFICATIONS_KEY_RATE_LIMIT_RATE);
+  now = g_get_monotonic_time ();
+
+  limit = g_hash_table_lookup (self->rate_limits, source_id);
+  if (limit == NULL) {
+    if (g_hash_table_size (self->rate_limits) >= RATE_LIMITS_PRUNE_SIZE)
+      prune_rate_limits (self, burst, rate, now);
+
+    limit = g_new0 (RateLimit, 1);
+    limit->tokens = burst;
+    limit->last_refill = now;
+    g_hash_table_insert (self->rate_limits, g_strdup (source_id), limit);
+  } else {
+    refill_rate_limit (limit, burst, rate, now);
+  }
+
+  if (limit->tokens < 1.0)
+    return NULL;
+
+  limit->tokens -= 1.0;
+  return limit;
+}
+
+
+static PhoshNotification *
+get_collapse_target (PhoshNotifyManager *self, const char *source_id)
+{
+  RateLimit *limit = g_hash_table_lookup (self->rate_limits, source_id);
+
+  if (limit == NULL || limit->last_id == 0)
+    return NULL;
+
+  return phosh_notification_list_get_by_id (self->list, limit->last_id);
+}
+
+
 static void
 phosh_notify_manager_add_application (PhoshNotifyManager *self, GAppInfo *info)
 {
@@ -433,12 +686,14 @@ handle_notify (PhoshDBusNotifications *skeleton,
   g_autofree char *sound_file = NULL;
   GIcon *icon = NULL;
   GIcon *image = NULL;
+  RateLimit *limit = NULL;
+  gint64 trace_begin = PHOSH_TRACE_CURRENT_TIME;
 
   g_return_val_if_fail (PHOSH_IS_NOTIFY_MANAGER (self), FALSE);
 
   g_debug ("DBus call Notify: %s (%u): %s (%s), %s, %d", app_name, replaces_id, summary, body, app_icon, expire_timeout);
 
-  app_gicon = parse_icon_string (app_icon);
+  app_gicon = get_icon_for_string (self, app_icon);
 
   g_variant_iter_init (&iter, hints);
   while ((item = g_variant_iter_next_value (&iter))) {
@@ -455,14 +710,14 @@ handle_notify (PhoshDBusNotifications *skeleton,
       }
     } else if ((g_strcmp0 (key, "image-data") == 0) ||
                (g_strcmp0 (key, "image_data") == 0)) {
-      data_gicon = parse_icon_data (value);
+      data_gicon = get_icon_for_data (self, value);
     } else if ((g_strcmp0 (key, "image-path") == 0) ||
                (g_strcmp0 (key, "image_path") == 0)) {
       if (g_variant_is_of_type (value, G_VARIANT_TYPE_STRING)) {
-        path_gicon = parse_icon_string (g_variant_get_string (value, NULL));
+        path_gicon = get_icon_for_string (self, g_variant_get_string (value, NULL));
       }
     } else if (g_strcmp0 (key, "icon_data") == 0) {
-      old_data_gicon = parse_icon_data (value);
+      old_data_gicon = get_icon_for_data (self, value);
     } else if ((g_strcmp0 (key, "desktop_entry") == 0) ||
                (g_strcmp0 (key, "desktop-entry") == 0)) {
       if (g_variant_is_of_type (value, G_VARIANT_TYPE_STRING))
@@ -524,10 +779,21 @@ handle_notify (PhoshDBusNotifications *skeleton,
   if (replaces_id)
     notification = phosh_notification_list_get_by_id (self->list, replaces_id);
 
+  if (notification == NULL && urgency != PHOSH_NOTIFICATION_URGENCY_CRITICAL) {
+    limit = take_rate_limit_token (self, source_id);
+    /* Source is flooding us, update its last notification instead of adding another one */
+    if (limit == NULL) {
+      notification = get_collapse_target (self, source_id);
+      if (notification)
+        g_debug ("Rate limiting %s, updating notification %u", source_id,
+                 phosh_notification_get_id (notification));
+    }
+  }
+
   escaped_body = phosh_util_escape_markup (body, TRUE);
 
   if (notification) {
-    id = replaces_id;
+    id = phosh_notification_get_id (notification);
 
     g_object_set (notification,
                   "app_name", app_name,
@@ -568,10 +834,15 @@ handle_notify (PhoshDBusNotifications *skeleton,
                                            source_id,
                                            expire_timeout,
                                            PHOSH_NOTIFICATION (dbus_notification));
+    limit = g_hash_table_lookup (self->rate_limits, source_id);
+    if (limit)
+      limit->last_id = id;
   }
 
   phosh_dbus_notifications_complete_notify (skeleton, invocation, id);
 
+  PHOSH_TRACE_MARK (trace_begin, "notify-manager: notify", "%s (%u)", app_name, id);
+
   return TRUE;
 }
 
@@ -656,7 +927,10 @@ phosh_notify_manager_dispose (GObject *object)
   if (g_dbus_interface_skeleton_get_object_path (G_DBUS_INTERFACE_SKELETON (self)))
     g_dbus_interface_skeleton_unexport (G_DBUS_INTERFACE_SKELETON (self));
 
+  g_clear_handle_id (&self->coalesce_id, g_source_remove);
+  g_clear_object (&self->pending_new);
   g_clear_object (&self->settings);
+  g_clear_object (&self->phosh_settings);
   g_clear_object (&self->feedback);
   g_clear_object (&self->list);
 
@@ -670,12 +944,33 @@ phosh_notify_manager_finalize (GObject *object)
   PhoshNotifyManager *self = PHOSH_NOTIFY_MANAGER (object);
 
   g_strfreev (self->app_children);
+  g_hash_table_destroy (self->icon_cache);
+  g_hash_table_destroy (self->rate_limits);
 
   G_OBJECT_CLASS (phosh_notify_manager_parent_class)->finalize (object);
 }
 
 
 
+/* A limit set by the user wins, otherwise the performance tier picks it */
+static void
+update_max_total (PhoshNotifyManager *self)
+{
+  PhoshModeManager *mode_manager = phosh_shell_get_mode_manager (phosh_shell_get_default ());
+  g_autoptr (GVariant) user_value = NULL;
+  guint max_total;
+
+  user_value = g_settings_get_user_value (self->phosh_settings, PHOSH_NOTIFICATIONS_KEY_MAX_TOTAL);
+  if (user_value == NULL && mode_manager)
+    max_total = phosh_mode_manager_get_perf_profile (mode_manager)->notification_history;
+  else
+    max_total = g_settings_get_uint (self->phosh_settings, PHOSH_NOTIFICATIONS_KEY_MAX_TOTAL);
+
+  g_debug ("Keeping at most %u notifications in memory", max_total);
+  g_object_set (self->list, "max-total", max_total, NULL);
+}
+
+
 static void
 phosh_notify_manager_constructed (GObject *object)
 {
@@ -702,6 +997,22 @@ phosh_notify_manager_constructed (GObject *object)
                             G_CALLBACK (on_notification_apps_setting_changed), self);
   on_notification_apps_setting_changed (self, NULL, self->settings);
 
+  self->phosh_settings = g_settings_new (PHOSH_NOTIFICATIONS_SETTINGS_SCHEMA_ID);
+  g_settings_bind (self->phosh_settings, PHOSH_NOTIFICATIONS_KEY_MAX_PER_SOURCE,
+                   self->list, "max-per-source", G_SETTINGS_BIND_GET);
+  g_signal_connect_swapped (self->phosh_settings, "changed::" PHOSH_NOTIFICATIONS_KEY_MAX_TOTAL,
+                            G_CALLBACK (update_max_total), self);
+  if (phosh_shell_get_mode_manager (shell)) {
+    g_signal_connect_object (phosh_shell_get_mode_manager (shell), "notify::perf-tier",
+                             G_CALLBACK (update_max_total), self,
+                             G_CONNECT_SWAPPED);
+  }
+  update_max_total (self);
+  /* Spilled notifications are new objects, hook them up again */
+  g_signal_connect_object (self->list, "notification-restored",
+                           G_CALLBACK (connect_notification), self,
+                           G_CONNECT_SWAPPED);
+
   g_signal_connect_swapped (shell, "notify::locked", G_CALLBACK (on_shell_lock_changed), self);
 
   self->feedback = phosh_notify_feedback_new (self->list);
@@ -762,6 +1073,11 @@ phosh_notify_manager_init (PhoshNotifyManager *self)
   self->next_id = 1;
 
   self->list = phosh_notification_list_new ();
+  self->icon_cache = g_hash_table_new_full (g_str_hash,
+                                            g_str_equal,
+                                            NULL,
+                                            (GDestroyNotify) icon_cache_entry_free);
+  self->rate_limits = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
 }
 
 /**
@@ -833,6 +1149,56 @@ phosh_notify_manager_get_notification_id (PhoshNotifyManager *self)
   return self->next_id++;
 }
 
+static gboolean
+on_coalesce_timeout (gpointer user_data)
+{
+  PhoshNotifyManager *self = PHOSH_NOTIFY_MANAGER (user_data);
+  g_autoptr (PhoshNotification) notification = g_steal_pointer (&self->pending_new);
+  guint window;
+
+  self->coalesce_id = 0;
+
+  /* Only announce the notification if it's still around */
+  if (notification == NULL ||
+      phosh_notification_list_get_by_id (self->list,
+                                         phosh_notification_get_id (notification)) != notification)
+    return G_SOURCE_REMOVE;
+
+  g_signal_emit (self, signals[NEW_NOTIFICATION], 0, notification);
+
+  /* Keep the window open while notifications keep coming in */
+  window = g_settings_get_uint (self->phosh_settings, PHOSH_NOTIFICATIONS_KEY_COALESCE_WINDOW);
+  if (window) {
+    self->coalesce_id = g_timeout_add (window, on_coalesce_timeout, self);
+    g_source_set_name_by_id (self->coalesce_id, "[PhoshNotifyManager] coalesce");
+  }
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static void
+emit_new_notification (PhoshNotifyManager *self, PhoshNotification *notification)
+{
+  guint window;
+
+  /* Notifications in the same window collapse into a single announcement (and banner) */
+  if (self->coalesce_id) {
+    g_set_object (&self->pending_new, notification);
+    return;
+  }
+
+  g_signal_emit (self, signals[NEW_NOTIFICATION], 0, notification);
+
+  window = g_settings_get_uint (self->phosh_settings, PHOSH_NOTIFICATIONS_KEY_COALESCE_WINDOW);
+  if (window == 0)
+    return;
+
+  self->coalesce_id = g_timeout_add (window, on_coalesce_timeout, self);
+  g_source_set_name_by_id (self->coalesce_id, "[PhoshNotifyManager] coalesce");
+}
+
+
 /**
  * phosh_notify_manager_add_notification
  * @self: the #PhoshNotifyManager
@@ -861,26 +1227,12 @@ phosh_notify_manager_add_notification (PhoshNotifyManager *self,
 
   phosh_notification_list_add (self->list, source_id, notification);
 
-  g_signal_connect_object (notification,
-                           "expired",
-                           G_CALLBACK (on_notification_expired),
-                           self,
-                           G_CONNECT_SWAPPED);
-  g_signal_connect_object (notification,
-                           "actioned",
-                           G_CALLBACK (on_notification_actioned),
-                           self,
-                           G_CONNECT_SWAPPED);
-  g_signal_connect_object (notification,
-                           "closed",
-                           G_CALLBACK (on_notification_closed),
-                           self,
-                           G_CONNECT_SWAPPED);
+  connect_notification (self, notification);
 
   if (expire_timeout)
     phosh_notification_expires (notification, expire_timeout);
 
-  g_signal_emit (self, signals[NEW_NOTIFICATION], 0, notification);
+  emit_new_notification (self, notification);
 }
 
 
@@ -9,6 +9,7 @@
 #include "timestamp-label.h"
 #include "timestamp-label-priv.h"
 #include "phosh-config.h"
+#include "timer-service.h"
 #include <glib/gi18n.h>
 
 /**
@@ -18,6 +19,9 @@
  *
  * The #PhoshTimestampLabel is used to display the time difference between
  * the timestamp stored in the #PhoshTimestampLabel and the current time.
+ *
+ * All mapped labels share a single timer so updates are coalesced
+ * into as few wakeups as possible.
  */
 
 
@@ -26,9 +30,23 @@ struct _PhoshTimestampLabel {
 
   GtkLabel  *label;
   GDateTime *date;
-  guint      refresh_time;
+  /* Wall clock time (µs) at which the label text changes next */
+  gint64     next_update;
+  gboolean   subscribed;
 };
 
+/* Updates due within that many ms of the timer are handled at once */
+#define TICK_TOLERANCE 1000
+#define USEC_PER_MINUTE (60 * G_USEC_PER_SEC)
+
+/* The shared timer all mapped timestamp labels subscribe to */
+static struct {
+  GList    *labels;
+  guint     timeout_id;
+} ticker;
+
+static void ticker_schedule (void);
+
 
 enum {
   PROP_0,
@@ -243,32 +261,100 @@ phosh_timestamp_label_calc_timeout (PhoshTimestampLabel *self)
 }
 
 
-static gboolean
+static void
 phosh_timestamp_label_update (PhoshTimestampLabel *self)
 {
   g_autofree char *str = NULL;
 
   if (self->date != NULL) {
-    GTimeSpan time;
-
     str = phosh_time_ago_in_words (self->date);
     gtk_label_set_label (self->label, str);
-
-    g_clear_handle_id (&(self->refresh_time), g_source_remove);
-    time = phosh_timestamp_label_calc_timeout (self);
-    self->refresh_time = g_timeout_add (time / G_TIME_SPAN_MILLISECOND,
-                                        (GSourceFunc) phosh_timestamp_label_update,
-                                        self);
-    g_source_set_name_by_id (self->refresh_time, "[PhoshTimestampLable] refresh");
+    self->next_update = g_get_real_time () + phosh_timestamp_label_calc_timeout (self);
   } else {
     gtk_label_set_label (self->label, "");
+    self->next_update = G_MAXINT64;
+  }
+}
+
+
+static gboolean
+on_ticker_timeout (gpointer unused)
+{
+  gint64 now = g_get_real_time ();
+
+  ticker.timeout_id = 0;
 
-    g_clear_handle_id (&(self->refresh_time), g_source_remove);
+  for (GList *l = ticker.labels; l; l = l->next) {
+    PhoshTimestampLabel *label = l->data;
+
+    if (label->next_update <= now + TICK_TOLERANCE * G_TIME_SPAN_MILLISECOND)
+      phosh_timestamp_label_update (label);
   }
+
+  ticker_schedule ();
+
   return G_SOURCE_REMOVE;
 }
 
 
+static void
+ticker_schedule (void)
+{
+  gint64 next = G_MAXINT64, now;
+  guint delay;
+
+  if (ticker.timeout_id) {
+    phosh_timer_service_remove_timeout (phosh_timer_service_get_default (), ticker.timeout_id);
+    ticker.timeout_id = 0;
+  }
+
+  for (GList *l = ticker.labels; l; l = l->next) {
+    PhoshTimestampLabel *label = l->data;
+
+    next = MIN (next, label->next_update);
+  }
+
+  if (next == G_MAXINT64)
+    return;
+
+  now = g_get_real_time ();
+  /* Past the first minute labels change at most once a minute, align to full minutes */
+  if (next - now > USEC_PER_MINUTE)
+    next = ((next + USEC_PER_MINUTE - 1) / USEC_PER_MINUTE) * USEC_PER_MINUTE;
+
+  /* The timer service suspends us while the screen is off and catches up on resume */
+  delay = MAX (next - now, 0) / G_TIME_SPAN_MILLISECOND;
+  ticker.timeout_id = phosh_timer_service_add_timeout (phosh_timer_service_get_default (),
+                                                       delay,
+                                                       TICK_TOLERANCE,
+                                                       on_ticker_timeout,
+                                                       NULL);
+}
+
+
+static void
+ticker_subscribe (PhoshTimestampLabel *self)
+{
+  if (self->subscribed)
+    return;
+
+  self->subscribed = TRUE;
+  ticker.labels = g_list_prepend (ticker.labels, self);
+}
+
+
+static void
+ticker_unsubscribe (PhoshTimestampLabel *self)
+{
+  if (!self->subscribed)
+    return;
+
+  self->subscribed = FALSE;
+  ticker.labels = g_list_remove (ticker.labels, self);
+  ticker_schedule ();
+}
+
+
 static void
 phosh_timestamp_label_get_property (GObject    *object,
                                     guint       property_id,
@@ -312,13 +398,36 @@ phosh_timestamp_label_dispose (GObject *object)
 {
   PhoshTimestampLabel *self = PHOSH_TIMESTAMP_LABEL (object);
 
+  ticker_unsubscribe (self);
   g_clear_pointer (&self->date, g_date_time_unref);
-  g_clear_handle_id (&(self->refresh_time), g_source_remove);
 
   G_OBJECT_CLASS (phosh_timestamp_label_parent_class)->dispose (object);
 }
 
 
+static void
+phosh_timestamp_label_map (GtkWidget *widget)
+{
+  PhoshTimestampLabel *self = PHOSH_TIMESTAMP_LABEL (widget);
+
+  /* Only labels that are shown need updates */
+  phosh_timestamp_label_update (self);
+  ticker_subscribe (self);
+  ticker_schedule ();
+
+  GTK_WIDGET_CLASS (phosh_timestamp_label_parent_class)->map (widget);
+}
+
+
+static void
+phosh_timestamp_label_unmap (GtkWidget *widget)
+{
+  ticker_unsubscribe (PHOSH_TIMESTAMP_LABEL (widget));
+
+  GTK_WIDGET_CLASS (phosh_timestamp_label_parent_class)->unmap (widget);
+}
+
+
 static void
 phosh_timestamp_label_class_init (PhoshTimestampLabelClass *klass)
 {
@@ -329,6 +438,9 @@ phosh_timestamp_label_class_init (PhoshTimestampLabelClass *klass)
   object_class->set_property = phosh_timestamp_label_set_property;
   object_class->get_property = phosh_timestamp_label_get_property;
 
+  widget_class->map = phosh_timestamp_label_map;
+  widget_class->unmap = phosh_timestamp_label_unmap;
+
   props[PROP_TIMESTAMP] =
     g_param_spec_boxed (
       "timestamp",
@@ -389,6 +501,8 @@ phosh_timestamp_label_set_timestamp (PhoshTimestampLabel *self,
   if (date != NULL)
     self->date = g_date_time_ref (date);
   phosh_timestamp_label_update (self);
+  if (self->subscribed)
+    ticker_schedule ();
 
   g_object_notify_by_pspec (G_OBJECT (self), props[PROP_TIMESTAMP]);
 }
@@ -23,6 +23,10 @@
  *
  * The #PhoshOsdWindow displays contents fed via the
  * OSD (on screen display) DBus interface.
+ *
+ * Repeated updates (e.g. when holding a volume key) usually only
+ * change the level so unchanged properties don't touch the widgets
+ * to avoid needless relayouts.
  */
 
 enum {
@@ -57,10 +61,12 @@ G_DEFINE_TYPE (PhoshOsdWindow, phosh_osd_window, PHOSH_TYPE_SYSTEM_MODAL)
 
 
 static void
-adjust_icon (PhoshOsdWindow *self, gboolean box_visible)
+adjust_icon (PhoshOsdWindow *self)
 {
+  gboolean box_visible;
   int size;
 
+  box_visible = gtk_widget_get_visible (self->lbl) || gtk_widget_get_visible (self->bar);
   gtk_widget_set_visible (self->box, box_visible);
 
   size = box_visible ? 16 : 32;
@@ -69,17 +75,20 @@ adjust_icon (PhoshOsdWindow *self, gboolean box_visible)
 
 
 static void
-set_label (PhoshOsdWindow *self, char *label)
+set_label (PhoshOsdWindow *self, const char *label)
 {
   gboolean visible;
 
+  if (g_strcmp0 (self->label, label) == 0)
+    return;
+
   g_free (self->label);
-  self->label = label;
+  self->label = g_strdup (label);
   gtk_label_set_label (GTK_LABEL (self->lbl), self->label);
 
   visible = !gm_str_is_null_or_empty (label);
   gtk_widget_set_visible (GTK_WIDGET (self->lbl), visible);
-  adjust_icon (self, visible);
+  adjust_icon (self);
 }
 
 
@@ -88,6 +97,9 @@ set_level (PhoshOsdWindow *self, double level)
 {
   gboolean visible;
 
+  if (G_APPROX_VALUE (self->level, level, FLT_EPSILON))
+    return;
+
   self->level = level;
 
   if (level >= 0.0)
@@ -95,7 +107,7 @@ set_level (PhoshOsdWindow *self, double level)
 
   visible = level >= 0.0;
   gtk_widget_set_visible (self->bar, visible);
-  adjust_icon (self, visible);
+  adjust_icon (self);
 }
 
 
@@ -114,9 +126,11 @@ phosh_osd_window_set_property (GObject      *obj,
     self->connector = g_value_dup_string (value);
     break;
   case PROP_LABEL:
-    set_label (self, g_value_dup_string (value));
+    set_label (self, g_value_get_string (value));
     break;
   case PROP_ICON_NAME:
+    if (g_strcmp0 (self->icon_name, g_value_get_string (value)) == 0)
+      break;
     g_free (self->icon_name);
     self->icon_name = g_value_dup_string (value);
     gtk_image_set_from_icon_name (GTK_IMAGE (self->icon), self->icon_name, GTK_ICON_SIZE_INVALID);
@@ -271,6 +285,12 @@ phosh_osd_window_init (PhoshOsdWindow *self)
 {
   gtk_widget_init_template (GTK_WIDGET (self));
 
+  /* Match the initial property values so unchanged properties can be skipped */
+  self->level = -1.0;
+  gtk_widget_set_visible (self->lbl, FALSE);
+  gtk_widget_set_visible (self->bar, FALSE);
+  adjust_icon (self);
+
   gtk_widget_add_events (GTK_WIDGET (self), GDK_BUTTON_RELEASE_MASK);
 }
 
@@ -12,12 +12,17 @@
 #include "osk-manager.h"
 #include "phosh-osk0-dbus.h"
 #include "shell-priv.h"
+#include "trace.h"
+#include "trace-buffer.h"
 
 #include <gio/gio.h>
 
 #define VIRTBOARD_DBUS_NAME      "sm.puri.OSK0"
 #define VIRTBOARD_DBUS_OBJECT    "/sm/puri/OSK0"
 
+/* Callers may prewarm on every frame of a gesture */
+#define PREWARM_INTERVAL_US      (5 * G_USEC_PER_SEC)
+
 /**
  * PhoshOskManager:
  *
@@ -28,6 +33,12 @@
  * there's no way to ensure keyboard state via this interface as it just
  * uses DBus to express preference. Any text input can make the keyboard
  * show again.
+ *
+ * Components that are about to show an entry (like the lock screen or
+ * system prompts) can use [method@OskManager.prewarm] so the OSK is
+ * woken up before it's needed. The time between requesting the OSK and
+ * it becoming visible is traced in the `osk` category of the
+ * [class@TraceBuffer].
  */
 enum {
   PROP_0,
@@ -49,6 +60,12 @@ struct _PhoshOskManager
   gboolean visible;
   gboolean has_name_owner;
   gboolean enabled;
+
+  GCancellable *cancel;
+  /* When the last prewarm got requested */
+  gint64        prewarm_start;
+  /* When showing got requested, 0 if not pending */
+  gint64        show_start;
 };
 G_DEFINE_TYPE (PhoshOskManager, phosh_osk_manager, G_TYPE_OBJECT)
 
@@ -75,39 +92,100 @@ phosh_osk_manager_get_property (GObject *object,
 }
 
 
+static void
+update_visible (PhoshOskManager *self, gboolean visible)
+{
+  if (visible == self->visible)
+    return;
+
+  self->visible = visible;
+
+  if (visible && self->show_start) {
+    gint64 now = g_get_monotonic_time ();
+
+    g_debug ("OSK visible after %" G_GINT64_FORMAT "ms", (now - self->show_start) / 1000);
+    phosh_trace_buffer_add (PHOSH_TRACE_CATEGORY_OSK, "osk show latency", self->show_start, now);
+  }
+  if (visible)
+    self->show_start = 0;
+
+  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_VISIBLE]);
+}
+
+
+typedef struct {
+  PhoshOskManager *self;
+  gint64           start;
+} PhoshOskSetVisibleData;
+
+
 static void
 on_osk0_set_visible_done (GObject *source_object, GAsyncResult *res, gpointer user_data)
 {
   PhoshDBusOSK0 *proxy = PHOSH_DBUS_OSK0 (source_object);
-  PhoshOskManager *self = PHOSH_OSK_MANAGER (user_data);
+  PhoshOskSetVisibleData *data = user_data;
+  PhoshOskManager *self = data->self;
   g_autoptr (GError) err = NULL;
-  gboolean visible;
 
-  if (!phosh_dbus_osk0_call_set_visible_finish (proxy, res, &err))
+  if (!phosh_dbus_osk0_call_set_visible_finish (proxy, res, &err)) {
     g_warning ("Unable to toggle OSK: %s", err->message);
-
-  visible = phosh_dbus_osk0_get_visible (proxy);
-  if (visible != self->visible) {
-    self->visible = visible;
-    g_object_notify_by_pspec (G_OBJECT (self), props[PROP_VISIBLE]);
+    self->show_start = 0;
   }
 
+  phosh_trace_buffer_add (PHOSH_TRACE_CATEGORY_OSK, "osk SetVisible", data->start,
+                          g_get_monotonic_time ());
+
+  update_visible (self, phosh_dbus_osk0_get_visible (proxy));
+
   g_object_unref (self);
+  g_free (data);
 }
 
 
 static void
 set_visible_real (PhoshOskManager *self, gboolean visible)
 {
+  PhoshOskSetVisibleData *data;
+
   g_return_if_fail (G_IS_DBUS_PROXY (self->proxy));
 
   g_debug ("Setting osk to %svisible", visible ? "" : "not ");
+
+  data = g_new0 (PhoshOskSetVisibleData, 1);
+  data->self = g_object_ref (self);
+  data->start = g_get_monotonic_time ();
+  /* Keep the earliest request when showing is requested repeatedly */
+  if (visible && !self->show_start)
+    self->show_start = data->start;
+  else if (!visible)
+    self->show_start = 0;
+
   phosh_dbus_osk0_call_set_visible (
     self->proxy,
     visible,
     NULL,
     on_osk0_set_visible_done,
-    g_object_ref (self));
+    data);
+}
+
+
+static void
+on_prewarm_done (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+  g_autoptr (GVariant) ret = NULL;
+  g_autoptr (GError) err = NULL;
+  PhoshOskManager *self;
+
+  ret = g_dbus_connection_call_finish (G_DBUS_CONNECTION (source_object), res, &err);
+  if (!ret) {
+    if (g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+      return;
+    g_debug ("Failed to prewarm OSK: %s", err->message);
+  }
+
+  self = PHOSH_OSK_MANAGER (user_data);
+  phosh_trace_buffer_add (PHOSH_TRACE_CATEGORY_OSK, "osk prewarm", self->prewarm_start,
+                          g_get_monotonic_time ());
 }
 
 
@@ -163,10 +241,7 @@ on_visible_changed (PhoshOskManager *self, GParamSpec *pspec, PhoshDBusOSK0 *pro
 
   visible = phosh_dbus_osk0_get_visible (proxy);
   /* Just need to sync the property, osk shows/hides itself */
-  if (visible != self->visible) {
-    self->visible = visible;
-    g_object_notify_by_pspec (G_OBJECT (self), props[PROP_VISIBLE]);
-  }
+  update_visible (self, visible);
 }
 
 
@@ -234,6 +309,8 @@ phosh_osk_manager_dispose (GObject *object)
 {
   PhoshOskManager *self = PHOSH_OSK_MANAGER (object);
 
+  g_cancellable_cancel (self->cancel);
+  g_clear_object (&self->cancel);
   g_clear_object (&self->a11y_settings);
   g_clear_object (&self->proxy);
 
@@ -276,6 +353,7 @@ phosh_osk_manager_class_init (PhoshOskManagerClass *klass)
 static void
 phosh_osk_manager_init (PhoshOskManager *self)
 {
+  self->cancel = g_cancellable_new ();
   self->a11y_settings = g_settings_new ("org.gnome.desktop.a11y.applications");
   g_signal_connect_swapped (self->a11y_settings,
                             "changed::screen-keyboard-enabled",
@@ -320,3 +398,52 @@ phosh_osk_manager_set_visible (PhoshOskManager *self, gboolean visible)
 
   set_visible_real (self, visible);
 }
+
+
+/**
+ * phosh_osk_manager_prewarm:
+ * @self: The OSK manager
+ *
+ * Let the OSK know it's likely needed soon, e.g. because an entry
+ * that wants text input is about to be shown. This wakes up the OSK
+ * process and its D-Bus connection so showing the keyboard afterwards
+ * doesn't need to wait for that. Does nothing if the OSK isn't
+ * available or already visible.
+ */
+void
+phosh_osk_manager_prewarm (PhoshOskManager *self)
+{
+  g_autofree char *name_owner = NULL;
+  GDBusConnection *connection;
+  gint64 now;
+
+  g_return_if_fail (PHOSH_IS_OSK_MANAGER (self));
+
+  if (!phosh_osk_manager_get_available (self) || self->visible)
+    return;
+
+  now = g_get_monotonic_time ();
+  if (self->prewarm_start && now - self->prewarm_start < PREWARM_INTERVAL_US)
+    return;
+
+  name_owner = g_dbus_proxy_get_name_owner (G_DBUS_PROXY (self->proxy));
+  if (name_owner == NULL)
+    return;
+
+  g_debug ("Prewarming OSK");
+  self->prewarm_start = now;
+  connection = g_dbus_proxy_get_connection (G_DBUS_PROXY (self->proxy));
+  /* The OSK0 interface has no method for that, a ping suffices to page the OSK in */
+  g_dbus_connection_call (connection,
+                          name_owner,
+                          VIRTBOARD_DBUS_OBJECT,
+                          "org.freedesktop.DBus.Peer",
+                          "Ping",
+                          NULL,
+                          NULL,
+                          G_DBUS_CALL_FLAGS_NO_AUTO_START,
+                          -1,
+                          self->cancel,
+                          on_prewarm_done,
+                          self);
+}
@@ -20,5 +20,6 @@ PhoshOskManager * phosh_osk_manager_new           (void);
 gboolean          phosh_osk_manager_get_available (PhoshOskManager *self);
 void              phosh_osk_manager_set_visible   (PhoshOskManager *self, gboolean visible);
 gboolean          phosh_osk_manager_get_visible   (PhoshOskManager *self);
+void              phosh_osk_manager_prewarm       (PhoshOskManager *self);
 
 G_END_DECLS
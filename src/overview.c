@@ -11,20 +11,32 @@
 
 #include "phosh-config.h"
 
+#include "animation.h"
 #include "activity.h"
 #include "app-grid.h"
 #include "overview.h"
 #include "phosh-wayland.h"
 #include "shell-priv.h"
+#include "thumbnail-cache.h"
 #include "toplevel-manager.h"
 #include "toplevel-thumbnail.h"
+#include "trace.h"
 #include "util.h"
+#include "wl-buffer.h"
 
 #include <gio/gdesktopappinfo.h>
 
 #include <handy.h>
 
+#include <math.h>
+
 #define OVERVIEW_ICON_SIZE 64
+/* Unused thumbnail buffers to keep around while the overview is open */
+#define THUMBNAIL_POOL_MAX_CACHED (32 * 1024 * 1024)
+/* Memory budget for the downscaled images of all activities */
+#define THUMBNAIL_CACHE_MAX_SIZE (64 * 1024 * 1024)
+/* Pages next to the current one that get their thumbnails right away */
+#define THUMBNAIL_NEIGHBORS 1
 
 /**
  * PhoshOverview:
@@ -34,6 +46,13 @@
  *
  * The #PhoshOverview shows running apps (#PhoshActivity) and
  * the app grid (#PhoshAppGrid) to launch new applications.
+ *
+ * Activities are indexed by toplevel and app so updates don't need
+ * to walk the carousel's children.
+ *
+ * Thumbnails are captured right away only for the current page and
+ * its neighbors. The other pages' captures are deferred to idle so
+ * opening the overview doesn't depend on the number of windows.
  */
 
 enum {
@@ -58,11 +77,25 @@ typedef struct {
   HdyCarousel        *carousel_running_activities;
   GtkWidget          *app_grid;
   PhoshActivity      *activity;
+  /* The activities in carousel order */
+  GPtrArray          *activities;
+  /* PhoshToplevel -> PhoshActivity */
+  GHashTable         *activity_by_toplevel;
+  /* Desktop id -> GPtrArray of PhoshActivity */
+  GHashTable         *activities_by_app;
+  /* PhoshActivity -> whether an incremental capture is sufficient */
+  GHashTable         *deferred_thumbnails;
+  guint               deferred_thumbnail_id;
 
   PhoshAppTracker    *app_tracker;     /* unowned */
   PhoshSplashManager *splash_manager;  /* unowned */
 
+  PhoshWlBufferPool  *thumbnail_pool;
+  PhoshThumbnailCache *thumbnail_cache;
+
   int has_activities;
+  /* The usable area last pushed to all activities */
+  int win_width, win_height;
 } PhoshOverviewPrivate;
 
 
@@ -78,29 +111,34 @@ static void           on_activity_clicked (PhoshOverview *self, PhoshActivity *a
 static int            get_last_app_id_pos (PhoshOverview *self, const char *app_id);
 
 
+static const char *
+get_activity_app_key (PhoshActivity *activity)
+{
+  GAppInfo *app_info = phosh_activity_get_app_info (activity);
+
+  return app_info ? g_app_info_get_id (app_info) : NULL;
+}
+
+
 static PhoshActivity *
 find_activity_by_app_info (PhoshOverview *self, GAppInfo *needle)
 {
-  g_autoptr (GList) children = NULL;
   PhoshOverviewPrivate *priv = phosh_overview_get_instance_private (self);
+  const char *key = g_app_info_get_id (needle);
+  GPtrArray *activities;
 
-  children = gtk_container_get_children (GTK_CONTAINER (priv->carousel_running_activities));
-  for (GList *l = children; l; l = l->next) {
-    PhoshActivity *activity = PHOSH_ACTIVITY (l->data);
-    GAppInfo *app_info = phosh_activity_get_app_info (activity);
-
-    if (app_info && g_app_info_equal (needle, app_info))
-      return activity;
-  }
+  if (!key)
+    return NULL;
 
-  return NULL;
+  /* Arrays get removed once empty */
+  activities = g_hash_table_lookup (priv->activities_by_app, key);
+  return activities ? g_ptr_array_index (activities, 0) : NULL;
 }
 
 
 static PhoshActivity *
 find_activity_by_app_id (PhoshOverview *self, const char *needle)
 {
-  g_autoptr (GList) children = NULL;
   g_autoptr (GAppInfo) needle_info = NULL;
 
   g_return_val_if_fail (needle, NULL);
@@ -112,6 +150,62 @@ find_activity_by_app_id (PhoshOverview *self, const char *needle)
 }
 
 
+static void
+on_activity_destroyed (PhoshOverview *self, PhoshActivity *activity)
+{
+  PhoshOverviewPrivate *priv = phosh_overview_get_instance_private (self);
+  PhoshToplevel *toplevel = g_object_get_data (G_OBJECT (activity), "toplevel");
+  const char *key = get_activity_app_key (activity);
+
+  g_ptr_array_remove (priv->activities, activity);
+  g_hash_table_remove (priv->deferred_thumbnails, activity);
+
+  if (key) {
+    GPtrArray *activities = g_hash_table_lookup (priv->activities_by_app, key);
+
+    if (activities) {
+      g_ptr_array_remove (activities, activity);
+      if (activities->len == 0)
+        g_hash_table_remove (priv->activities_by_app, key);
+    }
+  }
+
+  if (toplevel && g_hash_table_lookup (priv->activity_by_toplevel, toplevel) == activity)
+    g_hash_table_remove (priv->activity_by_toplevel, toplevel);
+
+  if (priv->activity == activity)
+    priv->activity = NULL;
+}
+
+
+static void
+add_activity (PhoshOverview *self, PhoshActivity *activity, int pos)
+{
+  PhoshOverviewPrivate *priv = phosh_overview_get_instance_private (self);
+  const char *key = get_activity_app_key (activity);
+
+  if (pos) {
+    hdy_carousel_insert (priv->carousel_running_activities, GTK_WIDGET (activity), pos);
+    g_ptr_array_insert (priv->activities, pos, activity);
+  } else {
+    gtk_container_add (GTK_CONTAINER (priv->carousel_running_activities), GTK_WIDGET (activity));
+    g_ptr_array_add (priv->activities, activity);
+  }
+
+  if (key) {
+    GPtrArray *activities = g_hash_table_lookup (priv->activities_by_app, key);
+
+    if (!activities) {
+      activities = g_ptr_array_new ();
+      g_hash_table_insert (priv->activities_by_app, g_strdup (key), activities);
+    }
+    g_ptr_array_add (activities, activity);
+  }
+
+  g_signal_connect_swapped (activity, "destroy", G_CALLBACK (on_activity_destroyed), self);
+}
+
+
 static PhoshActivity *
 create_new_activity (PhoshOverview *self,
                      GAppInfo      *info,
@@ -154,10 +248,7 @@ create_new_activity (PhoshOverview *self,
   if (parent_app_id)
     pos = get_last_app_id_pos (self, parent_app_id);
 
-  if (pos)
-    hdy_carousel_insert (priv->carousel_running_activities, GTK_WIDGET (activity), pos);
-  else
-    gtk_container_add (GTK_CONTAINER (priv->carousel_running_activities), GTK_WIDGET (activity));
+  add_activity (self, activity, pos);
 
   return activity;
 }
@@ -270,21 +361,13 @@ get_toplevel_from_activity (PhoshActivity *activity)
 static PhoshActivity *
 find_activity_by_toplevel (PhoshOverview *self, PhoshToplevel *needle)
 {
-  g_autoptr (GList) children = NULL;
   PhoshOverviewPrivate *priv = phosh_overview_get_instance_private (self);
+  PhoshActivity *activity;
 
-  children = gtk_container_get_children (GTK_CONTAINER (priv->carousel_running_activities));
-  for (GList *l = children; l; l = l->next) {
-    PhoshActivity *activity = PHOSH_ACTIVITY (l->data);
-    PhoshToplevel *toplevel;
-
-    toplevel = get_toplevel_from_activity (activity);
-    if (toplevel == needle)
-      return activity;
-  }
+  activity = g_hash_table_lookup (priv->activity_by_toplevel, needle);
+  g_return_val_if_fail (activity, NULL);
 
-  g_return_val_if_reached (NULL);
-  return NULL;
+  return activity;
 }
 
 
@@ -292,7 +375,7 @@ static void
 scroll_to_activity (PhoshOverview *self, PhoshActivity *activity)
 {
   PhoshOverviewPrivate *priv = phosh_overview_get_instance_private (self);
-  hdy_carousel_scroll_to (priv->carousel_running_activities, GTK_WIDGET (activity));
+  phosh_animation_carousel_scroll_to (priv->carousel_running_activities, GTK_WIDGET (activity));
   gtk_widget_grab_focus (GTK_WIDGET (activity));
 }
 
@@ -382,6 +465,8 @@ on_toplevel_closed (PhoshToplevel *toplevel, PhoshOverview *overview)
   g_return_if_fail (PHOSH_IS_OVERVIEW (overview));
   priv = phosh_overview_get_instance_private (overview);
 
+  phosh_thumbnail_cache_remove (priv->thumbnail_cache, toplevel);
+
   activity = find_activity_by_toplevel (overview, toplevel);
   g_return_if_fail (PHOSH_IS_ACTIVITY (activity));
   gtk_widget_destroy (GTK_WIDGET (activity));
@@ -410,32 +495,236 @@ on_toplevel_activated_changed (PhoshToplevel *toplevel, GParamSpec *pspec, Phosh
 
 
 static void
-on_thumbnail_ready_changed (PhoshThumbnail *thumbnail, GParamSpec *pspec, PhoshActivity *activity)
+on_thumbnail_ready_changed (PhoshOverview *self, GParamSpec *pspec, PhoshThumbnail *thumbnail)
 {
+  PhoshOverviewPrivate *priv = phosh_overview_get_instance_private (self);
+  PhoshActivity *activity;
+  PhoshToplevel *toplevel;
+  gint64 *trace_begin;
+
+  g_return_if_fail (PHOSH_IS_OVERVIEW (self));
   g_return_if_fail (PHOSH_IS_THUMBNAIL (thumbnail));
+  activity = g_object_get_data (G_OBJECT (thumbnail), "activity");
   g_return_if_fail (PHOSH_IS_ACTIVITY (activity));
 
+  trace_begin = g_object_get_data (G_OBJECT (thumbnail), "trace-begin");
+  if (trace_begin) {
+    PHOSH_TRACE_MARK (*trace_begin, "overview: thumbnail", "%s",
+                      phosh_activity_get_app_id (activity));
+  }
+
   phosh_activity_set_thumbnail (activity, thumbnail);
+
+  toplevel = get_toplevel_from_activity (activity);
+  if (toplevel) {
+    phosh_thumbnail_cache_insert (priv->thumbnail_cache,
+                                  toplevel,
+                                  phosh_activity_get_thumbnail_surface (activity));
+  }
+
+  /* The image got copied, release the buffer */
+  g_object_set_data (G_OBJECT (activity), "pending-thumbnail", NULL);
+}
+
+
+static void
+on_thumbnail_evicted (PhoshOverview *self, PhoshToplevel *toplevel)
+{
+  PhoshOverviewPrivate *priv = phosh_overview_get_instance_private (self);
+  PhoshActivity *activity;
+
+  g_return_if_fail (PHOSH_IS_OVERVIEW (self));
+
+  activity = g_hash_table_lookup (priv->activity_by_toplevel, toplevel);
+  if (!activity)
+    return;
+
+  /* Gets re-requested when the overview opens */
+  g_debug ("Dropping thumbnail of %s", phosh_activity_get_app_id (activity));
+  phosh_activity_clear_thumbnail (activity);
+}
+
+
+/**
+ * get_thumbnail_scale:
+ * @self: The overview
+ * @activity: The activity to get the thumbnail for
+ *
+ * GTK renders at the monitor's integer scale and the compositor
+ * downscales to the monitor's fractional scale. Capturing at the
+ * latter avoids copying pixels that never make it to the screen.
+ * The performance tier can lower the resolution further.
+ *
+ * Returns: The scale to capture the thumbnail at
+ */
+static float
+get_thumbnail_scale (PhoshOverview *self, PhoshActivity *activity)
+{
+  PhoshShell *shell = phosh_shell_get_default ();
+  PhoshMonitor *monitor = phosh_shell_get_primary_monitor (shell);
+  PhoshModeManager *mode_manager = phosh_shell_get_mode_manager (shell);
+  int scale_factor = gtk_widget_get_scale_factor (GTK_WIDGET (activity));
+  float scale = 0.0;
+
+  if (monitor)
+    scale = phosh_monitor_get_fractional_scale (monitor);
+
+  if (scale <= 0.0 || scale > scale_factor)
+    scale = scale_factor;
+
+  if (mode_manager)
+    scale *= phosh_mode_manager_get_perf_profile (mode_manager)->thumbnail_scale;
+
+  return scale;
 }
 
 
 static void
-request_thumbnail (PhoshActivity *activity, PhoshToplevel *toplevel)
+request_thumbnail (PhoshOverview *self, PhoshActivity *activity, PhoshToplevel *toplevel,
+                   gboolean incremental)
 {
+  PhoshOverviewPrivate *priv = phosh_overview_get_instance_private (self);
   PhoshToplevelThumbnail *thumbnail;
   GtkAllocation allocation;
-  int scale;
+  float scale;
+  gint64 trace_begin = PHOSH_TRACE_CURRENT_TIME;
   g_return_if_fail (PHOSH_IS_ACTIVITY (activity));
   g_return_if_fail (PHOSH_IS_TOPLEVEL (toplevel));
-  scale = gtk_widget_get_scale_factor (GTK_WIDGET (activity));
+  scale = get_thumbnail_scale (self, activity);
   phosh_activity_get_thumbnail_allocation (activity, &allocation);
-  thumbnail = phosh_toplevel_thumbnail_new_from_toplevel (toplevel, allocation.width * scale,
-                                                          allocation.height * scale);
+
+  /* Only the damaged region needs to be updated if we already have an image */
+  incremental = incremental && phosh_activity_get_has_thumbnail (activity);
+  thumbnail = phosh_toplevel_thumbnail_new_from_toplevel (toplevel,
+                                                          priv->thumbnail_pool,
+                                                          ceilf (allocation.width * scale),
+                                                          ceilf (allocation.height * scale),
+                                                          incremental);
+  if (!thumbnail)
+    return;
+
+  /* The thumbnail is owned by the activity so can't outlive it */
+  g_object_set_data (G_OBJECT (thumbnail), "activity", activity);
+  if (trace_begin) {
+    g_object_set_data_full (G_OBJECT (thumbnail), "trace-begin",
+                            g_memdup2 (&trace_begin, sizeof (trace_begin)), g_free);
+  }
   g_signal_connect_object (thumbnail,
                            "notify::ready",
                            G_CALLBACK (on_thumbnail_ready_changed),
-                           activity,
-                           0);
+                           self,
+                           G_CONNECT_SWAPPED);
+  /* Replaces (and thus cancels) any outstanding request */
+  g_object_set_data_full (G_OBJECT (activity), "pending-thumbnail", thumbnail, g_object_unref);
+}
+
+
+static int
+get_current_page (PhoshOverview *self)
+{
+  PhoshOverviewPrivate *priv = phosh_overview_get_instance_private (self);
+  guint index;
+
+  if (priv->activity && g_ptr_array_find (priv->activities, priv->activity, &index))
+    return index;
+
+  return (int) (hdy_carousel_get_position (priv->carousel_running_activities) + 0.5);
+}
+
+
+static gboolean
+on_deferred_thumbnail_idle (gpointer data)
+{
+  PhoshOverview *self = PHOSH_OVERVIEW (data);
+  PhoshOverviewPrivate *priv = phosh_overview_get_instance_private (self);
+  GHashTableIter iter;
+  gpointer activity, incremental;
+  PhoshToplevel *toplevel;
+
+  g_hash_table_iter_init (&iter, priv->deferred_thumbnails);
+  if (!g_hash_table_iter_next (&iter, &activity, &incremental)) {
+    priv->deferred_thumbnail_id = 0;
+    return G_SOURCE_REMOVE;
+  }
+  g_hash_table_iter_remove (&iter);
+
+  /* One capture per iteration to not starve the visible pages */
+  toplevel = get_toplevel_from_activity (activity);
+  if (toplevel)
+    request_thumbnail (self, activity, toplevel, GPOINTER_TO_INT (incremental));
+
+  return G_SOURCE_CONTINUE;
+}
+
+
+static void
+defer_thumbnail (PhoshOverview *self, PhoshActivity *activity, gboolean incremental)
+{
+  PhoshOverviewPrivate *priv = phosh_overview_get_instance_private (self);
+  gpointer pending;
+
+  /* A full capture supersedes an incremental one */
+  if (g_hash_table_lookup_extended (priv->deferred_thumbnails, activity, NULL, &pending))
+    incremental = incremental && GPOINTER_TO_INT (pending);
+  g_hash_table_insert (priv->deferred_thumbnails, activity, GINT_TO_POINTER (incremental));
+
+  if (priv->deferred_thumbnail_id)
+    return;
+
+  priv->deferred_thumbnail_id = g_idle_add_full (G_PRIORITY_LOW,
+                                                 on_deferred_thumbnail_idle,
+                                                 self,
+                                                 NULL);
+  g_source_set_name_by_id (priv->deferred_thumbnail_id, "[phosh] overview deferred thumbnail");
+}
+
+
+static void
+schedule_thumbnail (PhoshOverview *self, PhoshActivity *activity, PhoshToplevel *toplevel,
+                    gboolean incremental)
+{
+  PhoshOverviewPrivate *priv = phosh_overview_get_instance_private (self);
+  guint index;
+
+  if (g_ptr_array_find (priv->activities, activity, &index) &&
+      ABS ((int)index - get_current_page (self)) <= THUMBNAIL_NEIGHBORS) {
+    g_hash_table_remove (priv->deferred_thumbnails, activity);
+    request_thumbnail (self, activity, toplevel, incremental);
+    return;
+  }
+
+  defer_thumbnail (self, activity, incremental);
+}
+
+
+static void
+update_thumbnail_priorities (PhoshOverview *self, int page)
+{
+  PhoshOverviewPrivate *priv = phosh_overview_get_instance_private (self);
+
+  for (guint i = 0; i < priv->activities->len; i++) {
+    PhoshActivity *activity = g_ptr_array_index (priv->activities, i);
+    PhoshToplevel *toplevel = get_toplevel_from_activity (activity);
+    gboolean pending = !!g_object_get_data (G_OBJECT (activity), "pending-thumbnail");
+    gpointer incremental;
+
+    if (!toplevel)
+      continue;
+
+    if (ABS ((int)i - page) > THUMBNAIL_NEIGHBORS) {
+      /* Scrolled past, cancel the capture and pick it up later */
+      if (pending) {
+        g_object_set_data (G_OBJECT (activity), "pending-thumbnail", NULL);
+        defer_thumbnail (self, activity, FALSE);
+      }
+      continue;
+    }
+
+    if (g_hash_table_steal_extended (priv->deferred_thumbnails, activity, NULL, &incremental))
+      request_thumbnail (self, activity, toplevel, GPOINTER_TO_INT (incremental));
+    else if (!pending && !phosh_activity_get_has_thumbnail (activity))
+      request_thumbnail (self, activity, toplevel, FALSE);
+  }
 }
 
 
@@ -448,7 +737,7 @@ on_activity_resized (PhoshOverview *self, GtkAllocation *alloc, PhoshActivity *a
   toplevel = g_object_get_data (G_OBJECT (activity), "toplevel");
   g_return_if_fail (PHOSH_IS_TOPLEVEL (toplevel));
 
-  request_thumbnail (activity, toplevel);
+  schedule_thumbnail (self, activity, toplevel, FALSE);
 }
 
 
@@ -462,7 +751,7 @@ on_activity_has_focus_changed (PhoshOverview *self, GParamSpec *pspec, PhoshActi
   priv = phosh_overview_get_instance_private (self);
 
   if (gtk_widget_has_focus (GTK_WIDGET (activity)))
-    hdy_carousel_scroll_to (priv->carousel_running_activities, GTK_WIDGET (activity));
+    phosh_animation_carousel_scroll_to (priv->carousel_running_activities, GTK_WIDGET (activity));
 }
 
 
@@ -470,7 +759,6 @@ static int
 get_last_app_id_pos (PhoshOverview *self, const char *app_id)
 {
   PhoshOverviewPrivate *priv;
-  g_autoptr (GList) children = NULL;
   int pos;
 
   if (!app_id)
@@ -478,15 +766,12 @@ get_last_app_id_pos (PhoshOverview *self, const char *app_id)
 
   priv = phosh_overview_get_instance_private (self);
 
-  children = gtk_container_get_children (GTK_CONTAINER (priv->carousel_running_activities));
-  pos = g_list_length (children);
-  for (GList *l = g_list_last (children); l; l = l->prev) {
-    PhoshActivity *a = PHOSH_ACTIVITY (l->data);
+  /* Positions shift on every insert so there's no index for them */
+  for (pos = priv->activities->len; pos > 0; pos--) {
+    PhoshActivity *a = g_ptr_array_index (priv->activities, pos - 1);
 
     if (g_strcmp0 (phosh_activity_get_app_id (a), app_id) == 0)
       break;
-
-    pos--;
   }
 
   return pos;
@@ -532,13 +817,14 @@ toplevel_to_activity (PhoshOverview *self, PhoshToplevel *toplevel)
                   NULL);
 
     g_object_set_data (G_OBJECT (activity), "startup-id", NULL);
-    request_thumbnail (activity, toplevel);
+    schedule_thumbnail (self, activity, toplevel, FALSE);
   } else {
     g_debug ("Building activator for '%s' (%s)", app_id, title);
     activity = create_new_activity (self, NULL, toplevel, app_id, parent_app_id);
   }
 
   g_object_set_data (G_OBJECT (activity), "toplevel", toplevel);
+  g_hash_table_insert (priv->activity_by_toplevel, toplevel, activity);
   gtk_widget_set_visible (GTK_WIDGET (activity), TRUE);
 
   g_object_connect (activity,
@@ -619,7 +905,7 @@ on_toplevel_changed (PhoshOverview *self, PhoshToplevel *toplevel)
   activity = find_activity_by_toplevel (self, toplevel);
   g_return_if_fail (activity);
 
-  request_thumbnail (activity, toplevel);
+  schedule_thumbnail (self, activity, toplevel, TRUE);
 }
 
 
@@ -636,7 +922,7 @@ on_toplevel_missing (PhoshOverview *self, GAppInfo *info)
     return;
 
   /* Activity is not a splash screen, so keep it */
-  if (phosh_activity_get_has_thumbnail (activity))
+  if (g_object_get_data (G_OBJECT (activity), "toplevel"))
     return;
 
   g_warning ("App %s didn't present a toplevel, hiding splash", g_app_info_get_id (info));
@@ -659,19 +945,24 @@ phosh_overview_size_allocate (GtkWidget     *widget,
 {
   PhoshOverview *self = PHOSH_OVERVIEW (widget);
   PhoshOverviewPrivate *priv = phosh_overview_get_instance_private (self);
-  g_autoptr (GList) children = NULL;
   int width, height;
 
   phosh_shell_get_usable_area (phosh_shell_get_default (), NULL, NULL, &width, &height);
-  children = gtk_container_get_children (GTK_CONTAINER (priv->carousel_running_activities));
 
-  for (GList *l = children; l; l = l->next) {
-    g_object_set (l->data,
+  /* New activities pick up the current area themselves */
+  if (width == priv->win_width && height == priv->win_height)
+    goto out;
+  priv->win_width = width;
+  priv->win_height = height;
+
+  for (guint i = 0; i < priv->activities->len; i++) {
+    g_object_set (g_ptr_array_index (priv->activities, i),
                   "win-width", width,
                   "win-height", height,
                   NULL);
   }
 
+ out:
   GTK_WIDGET_CLASS (phosh_overview_parent_class)->size_allocate (widget, alloc);
 }
 
@@ -688,9 +979,9 @@ on_app_launched (PhoshOverview *self, GAppInfo *info, GtkWidget *widget)
 static void
 on_page_changed (PhoshOverview *self, guint index, HdyCarousel *carousel)
 {
+  PhoshOverviewPrivate *priv = phosh_overview_get_instance_private (self);
   PhoshActivity *activity;
   PhoshToplevel *toplevel;
-  g_autoptr (GList) list = NULL;
   g_return_if_fail (PHOSH_IS_OVERVIEW (self));
   g_return_if_fail (HDY_IS_CAROUSEL (carousel));
 
@@ -698,6 +989,8 @@ on_page_changed (PhoshOverview *self, guint index, HdyCarousel *carousel)
   if (((int)index < 0))
     return;
 
+  update_thumbnail_priorities (self, index);
+
   /* don't raise on scroll in docked mode */
   if (phosh_shell_get_docked (phosh_shell_get_default ()))
     return;
@@ -706,8 +999,8 @@ on_page_changed (PhoshOverview *self, guint index, HdyCarousel *carousel)
   if (!(phosh_shell_get_state (phosh_shell_get_default ()) & PHOSH_STATE_OVERVIEW))
     return;
 
-  list = gtk_container_get_children (GTK_CONTAINER (carousel));
-  activity = PHOSH_ACTIVITY (g_list_nth_data (list, index));
+  g_return_if_fail (index < priv->activities->len);
+  activity = g_ptr_array_index (priv->activities, index);
   toplevel = get_toplevel_from_activity (activity);
 
   /* TODO: Mark activation as pending and activate once the toplevel shows up */
@@ -740,6 +1033,24 @@ phosh_overview_constructed (GObject *object)
 }
 
 
+static void
+phosh_overview_finalize (GObject *object)
+{
+  PhoshOverview *self = PHOSH_OVERVIEW (object);
+  PhoshOverviewPrivate *priv = phosh_overview_get_instance_private (self);
+
+  g_clear_handle_id (&priv->deferred_thumbnail_id, g_source_remove);
+  g_clear_pointer (&priv->deferred_thumbnails, g_hash_table_unref);
+  g_clear_pointer (&priv->thumbnail_pool, phosh_wl_buffer_pool_unref);
+  g_clear_object (&priv->thumbnail_cache);
+  g_clear_pointer (&priv->activities, g_ptr_array_unref);
+  g_clear_pointer (&priv->activity_by_toplevel, g_hash_table_unref);
+  g_clear_pointer (&priv->activities_by_app, g_hash_table_unref);
+
+  G_OBJECT_CLASS (phosh_overview_parent_class)->finalize (object);
+}
+
+
 static void
 phosh_overview_class_init (PhoshOverviewClass *klass)
 {
@@ -747,6 +1058,7 @@ phosh_overview_class_init (PhoshOverviewClass *klass)
   GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
 
   object_class->constructed = phosh_overview_constructed;
+  object_class->finalize = phosh_overview_finalize;
   object_class->get_property = phosh_overview_get_property;
   widget_class->size_allocate = phosh_overview_size_allocate;
 
@@ -813,8 +1125,21 @@ phosh_overview_init (PhoshOverview *self)
   PhoshOverviewPrivate *priv = phosh_overview_get_instance_private (self);
 
   priv->has_activities = -1;
+  priv->activities = g_ptr_array_new ();
+  priv->activity_by_toplevel = g_hash_table_new (g_direct_hash, g_direct_equal);
+  priv->activities_by_app = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                                   (GDestroyNotify) g_ptr_array_unref);
+  priv->deferred_thumbnails = g_hash_table_new (g_direct_hash, g_direct_equal);
   gtk_widget_init_template (GTK_WIDGET (self));
 
+  priv->thumbnail_pool = phosh_wl_buffer_pool_new (THUMBNAIL_POOL_MAX_CACHED);
+  priv->thumbnail_cache = phosh_thumbnail_cache_new (THUMBNAIL_CACHE_MAX_SIZE);
+  g_signal_connect_object (priv->thumbnail_cache,
+                           "evicted",
+                           G_CALLBACK (on_thumbnail_evicted),
+                           self,
+                           G_CONNECT_SWAPPED);
+
   priv->app_tracker = phosh_shell_get_app_tracker (shell);
   /* Allow it to be empty for tests */
   if (priv->app_tracker) {
@@ -836,6 +1161,29 @@ phosh_overview_new (void)
 }
 
 
+static void
+update_memory (PhoshOverview *self)
+{
+  PhoshOverviewPrivate *priv = phosh_overview_get_instance_private (self);
+  PhoshAppScopes *scopes;
+
+  if (priv->app_tracker == NULL)
+    return;
+
+  scopes = phosh_app_tracker_get_scopes (priv->app_tracker);
+  if (scopes == NULL)
+    return;
+
+  for (guint i = 0; i < priv->activities->len; i++) {
+    PhoshActivity *activity = g_ptr_array_index (priv->activities, i);
+    guint64 memory;
+
+    memory = phosh_app_scopes_get_memory (scopes, phosh_activity_get_app_id (activity));
+    phosh_activity_set_memory (activity, memory);
+  }
+}
+
+
 void
 phosh_overview_refresh (PhoshOverview *self)
 {
@@ -845,8 +1193,19 @@ phosh_overview_refresh (PhoshOverview *self)
 
   if (priv->activity) {
     gtk_widget_grab_focus (GTK_WIDGET (priv->activity));
-    request_thumbnail (priv->activity, get_toplevel_from_activity (priv->activity));
+    request_thumbnail (self, priv->activity, get_toplevel_from_activity (priv->activity), TRUE);
   }
+
+  /* Activities that had their image evicted show their icon until the new one arrives */
+  for (guint i = 0; i < priv->activities->len; i++) {
+    PhoshActivity *activity = g_ptr_array_index (priv->activities, i);
+    PhoshToplevel *toplevel = get_toplevel_from_activity (activity);
+
+    if (toplevel && !phosh_activity_get_has_thumbnail (activity))
+      schedule_thumbnail (self, activity, toplevel, FALSE);
+  }
+
+  update_memory (self);
 }
 
 
@@ -859,6 +1218,8 @@ phosh_overview_reset (PhoshOverview *self)
   priv = phosh_overview_get_instance_private (self);
 
   phosh_app_grid_reset (PHOSH_APP_GRID (priv->app_grid));
+  /* Overview got closed, no need to keep unused buffers around */
+  phosh_wl_buffer_pool_trim (priv->thumbnail_pool);
 }
 
 
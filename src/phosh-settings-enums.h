@@ -68,3 +68,15 @@ typedef enum /*< enum,prefix=PHOSH >*/
   PHOSH_WWAN_BACKEND_MM,    /*< nick=modemmanager >*/
   PHOSH_WWAN_BACKEND_OFONO, /*< nick=ofono >*/
 } PhoshWWanBackend;
+
+/**
+ * PhoshAutoBrightnessTracker:
+ * @PHOSH_AUTO_BRIGHTNESS_TRACKER_BUCKET: Map ambient light levels to fixed buckets
+ * @PHOSH_AUTO_BRIGHTNESS_TRACKER_FILTER: Smooth ambient light levels and reject outliers
+ *
+ * How ambient light levels are turned into brightness values.
+ */
+typedef enum {
+  PHOSH_AUTO_BRIGHTNESS_TRACKER_BUCKET = 0,
+  PHOSH_AUTO_BRIGHTNESS_TRACKER_FILTER = 1,
+} PhoshAutoBrightnessTracker;
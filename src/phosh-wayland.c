@@ -14,6 +14,9 @@
 
 #include <gdk/gdkwayland.h>
 
+#include <errno.h>
+#include <unistd.h>
+
 /**
  * PhoshWayland:
  *
@@ -28,6 +31,8 @@ enum {
   PHOSH_WAYLAND_PROP_0,
   PHOSH_WAYLAND_PROP_WL_OUTPUTS,
   PHOSH_WAYLAND_PROP_SEAT_CAPABILITIES,
+  PHOSH_WAYLAND_PROP_KEY_REPEAT_RATE,
+  PHOSH_WAYLAND_PROP_KEY_REPEAT_DELAY,
   PHOSH_WAYLAND_PROP_LAST_PROP,
 };
 static GParamSpec *props[PHOSH_WAYLAND_PROP_LAST_PROP];
@@ -47,6 +52,7 @@ struct _PhoshWayland {
   struct wl_display                       *display;
   struct wl_registry                      *registry;
   struct wl_seat                          *wl_seat;
+  struct wl_keyboard                      *wl_keyboard;
   struct xdg_wm_base                      *xdg_wm_base;
   struct zwlr_foreign_toplevel_manager_v1 *zwlr_foreign_toplevel_manager_v1;
   struct zwlr_gamma_control_manager_v1    *zwlr_gamma_control_manager_v1;
@@ -58,8 +64,13 @@ struct _PhoshWayland {
   struct zphoc_layer_shell_effects_v1     *zphoc_layer_shell_effects_v1;
   struct zphoc_device_state_v1            *zphoc_device_state_v1;
   struct wl_shm                           *wl_shm;
+  struct wp_single_pixel_buffer_manager_v1 *wp_single_pixel_buffer_manager_v1;
+  struct wp_viewporter                    *wp_viewporter;
   GHashTable                              *wl_outputs;
   PhoshWaylandSeatCapabilities             seat_capabilities;
+  /* From wl_keyboard.repeat_info, -1 if not (yet) known */
+  int32_t                                  key_repeat_rate;
+  int32_t                                  key_repeat_delay;
 };
 
 G_DEFINE_TYPE (PhoshWayland, phosh_wayland, G_TYPE_OBJECT)
@@ -102,7 +113,8 @@ registry_handle_global (void               *data,
     g_hash_table_insert (self->wl_outputs, GINT_TO_POINTER (name), output);
     g_object_notify_by_pspec (G_OBJECT (self), props[PHOSH_WAYLAND_PROP_WL_OUTPUTS]);
   } else if (!strcmp (interface, "wl_seat")) {
-    self->wl_seat = wl_registry_bind (registry, name, &wl_seat_interface, 1);
+    /* wl_keyboard.repeat_info needs version 4 */
+    self->wl_seat = wl_registry_bind (registry, name, &wl_seat_interface, MIN (4, version));
   } else if (!strcmp (interface, "wl_shm")) {
     self->wl_shm = wl_registry_bind (registry, name, &wl_shm_interface, 1);
   } else if (!strcmp (interface, xdg_wm_base_interface.name)) {
@@ -137,13 +149,21 @@ registry_handle_global (void               *data,
     self->zwlr_screencopy_manager_v1 = wl_registry_bind (registry,
                                                          name,
                                                          &zwlr_screencopy_manager_v1_interface,
-                                                         2);
+                                                         MIN (3, version));
   } else if (!strcmp (interface, zwp_virtual_keyboard_manager_v1_interface.name)) {
     self->zwp_virtual_keyboard_manager_v1 =
       wl_registry_bind (registry,
                         name,
                         &zwp_virtual_keyboard_manager_v1_interface,
                         1);
+  } else if (!strcmp (interface, wp_single_pixel_buffer_manager_v1_interface.name)) {
+    self->wp_single_pixel_buffer_manager_v1 =
+      wl_registry_bind (registry,
+                        name,
+                        &wp_single_pixel_buffer_manager_v1_interface,
+                        1);
+  } else if (!strcmp (interface, wp_viewporter_interface.name)) {
+    self->wp_viewporter = wl_registry_bind (registry, name, &wp_viewporter_interface, 1);
   } else if (!strcmp (interface, ext_idle_notifier_v1_interface.name)) {
     self->ext_idle_notifier_v1 = wl_registry_bind (registry,
                                                    name,
@@ -193,6 +213,12 @@ phosh_wayland_get_property (GObject    *object,
   case PHOSH_WAYLAND_PROP_SEAT_CAPABILITIES:
     g_value_set_flags (value, self->seat_capabilities);
     break;
+  case PHOSH_WAYLAND_PROP_KEY_REPEAT_RATE:
+    g_value_set_int (value, self->key_repeat_rate);
+    break;
+  case PHOSH_WAYLAND_PROP_KEY_REPEAT_DELAY:
+    g_value_set_int (value, self->key_repeat_delay);
+    break;
   default:
     G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     break;
@@ -200,11 +226,137 @@ phosh_wayland_get_property (GObject    *object,
 }
 
 
+static void
+keyboard_handle_keymap (void               *data,
+                        struct wl_keyboard *wl_keyboard,
+                        uint32_t            format,
+                        int32_t             fd,
+                        uint32_t            size)
+{
+  /* We're only interested in the repeat info */
+  close (fd);
+}
+
+
+static void
+keyboard_handle_enter (void               *data,
+                       struct wl_keyboard *wl_keyboard,
+                       uint32_t            serial,
+                       struct wl_surface  *surface,
+                       struct wl_array    *keys)
+{
+  /* nothing to do */
+}
+
+
+static void
+keyboard_handle_leave (void               *data,
+                       struct wl_keyboard *wl_keyboard,
+                       uint32_t            serial,
+                       struct wl_surface  *surface)
+{
+  /* nothing to do */
+}
+
+
+static void
+keyboard_handle_key (void               *data,
+                     struct wl_keyboard *wl_keyboard,
+                     uint32_t            serial,
+                     uint32_t            time,
+                     uint32_t            key,
+                     uint32_t            state)
+{
+  /* nothing to do */
+}
+
+
+static void
+keyboard_handle_modifiers (void               *data,
+                           struct wl_keyboard *wl_keyboard,
+                           uint32_t            serial,
+                           uint32_t            mods_depressed,
+                           uint32_t            mods_latched,
+                           uint32_t            mods_locked,
+                           uint32_t            group)
+{
+  /* nothing to do */
+}
+
+
+static void
+keyboard_handle_repeat_info (void               *data,
+                             struct wl_keyboard *wl_keyboard,
+                             int32_t             rate,
+                             int32_t             delay)
+{
+  PhoshWayland *self = PHOSH_WAYLAND (data);
+
+  g_debug ("Key repeat rate: %d, delay: %d", rate, delay);
+
+  g_object_freeze_notify (G_OBJECT (self));
+  if (self->key_repeat_rate != rate) {
+    self->key_repeat_rate = rate;
+    g_object_notify_by_pspec (G_OBJECT (self), props[PHOSH_WAYLAND_PROP_KEY_REPEAT_RATE]);
+  }
+  if (self->key_repeat_delay != delay) {
+    self->key_repeat_delay = delay;
+    g_object_notify_by_pspec (G_OBJECT (self), props[PHOSH_WAYLAND_PROP_KEY_REPEAT_DELAY]);
+  }
+  g_object_thaw_notify (G_OBJECT (self));
+}
+
+
+static const struct wl_keyboard_listener keyboard_listener = {
+  .keymap = keyboard_handle_keymap,
+  .enter = keyboard_handle_enter,
+  .leave = keyboard_handle_leave,
+  .key = keyboard_handle_key,
+  .modifiers = keyboard_handle_modifiers,
+  .repeat_info = keyboard_handle_repeat_info,
+};
+
+
+static void
+release_keyboard (PhoshWayland *self)
+{
+  if (self->wl_keyboard == NULL)
+    return;
+
+  if (wl_keyboard_get_version (self->wl_keyboard) >= WL_KEYBOARD_RELEASE_SINCE_VERSION)
+    wl_keyboard_release (self->wl_keyboard);
+  else
+    wl_keyboard_destroy (self->wl_keyboard);
+  self->wl_keyboard = NULL;
+}
+
+
+static void
+update_keyboard (PhoshWayland *self, uint32_t capabilities)
+{
+  gboolean has_keyboard = !!(capabilities & WL_SEAT_CAPABILITY_KEYBOARD);
+
+  /* Without repeat info there's no point in tracking the keyboard */
+  if (wl_seat_get_version (self->wl_seat) < WL_KEYBOARD_REPEAT_INFO_SINCE_VERSION)
+    return;
+
+  if (has_keyboard && self->wl_keyboard == NULL) {
+    self->wl_keyboard = wl_seat_get_keyboard (self->wl_seat);
+    wl_keyboard_add_listener (self->wl_keyboard, &keyboard_listener, self);
+  } else if (!has_keyboard && self->wl_keyboard) {
+    release_keyboard (self);
+    keyboard_handle_repeat_info (self, NULL, -1, -1);
+  }
+}
+
+
 static void
 seat_handle_capabilities (void *data, struct wl_seat *wl_seat, uint32_t capabilities)
 {
   PhoshWayland *self = PHOSH_WAYLAND (data);
 
+  update_keyboard (self, capabilities);
+
   if (WL_SEAT_CAPS (self->seat_capabilities) != capabilities) {
     g_debug ("Seat capabilities: 0x%x", capabilities);
     self->seat_capabilities = DEVICE_STATE_CAPS (self->seat_capabilities) | capabilities;
@@ -314,8 +466,12 @@ phosh_wayland_dispose (GObject *object)
   g_clear_pointer (&self->layer_shell, &zwlr_layer_shell_v1_destroy);
   g_clear_pointer (&self->phosh_private, phosh_private_destroy);
   g_clear_pointer (&self->registry, wl_registry_destroy);
+  release_keyboard (self);
   g_clear_pointer (&self->wl_seat, wl_seat_destroy);
   g_clear_pointer (&self->wl_shm, wl_shm_destroy);
+  g_clear_pointer (&self->wp_single_pixel_buffer_manager_v1,
+                   wp_single_pixel_buffer_manager_v1_destroy);
+  g_clear_pointer (&self->wp_viewporter, wp_viewporter_destroy);
   g_clear_pointer (&self->xdg_wm_base, xdg_wm_base_destroy);
   g_clear_pointer (&self->zwlr_foreign_toplevel_manager_v1,
                    zwlr_foreign_toplevel_manager_v1_destroy);
@@ -359,6 +515,29 @@ phosh_wayland_class_init (PhoshWaylandClass *klass)
                         PHOSH_WAYLAND_SEAT_CAPABILITY_NONE,
                         G_PARAM_READABLE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
 
+  /**
+   * PhoshWayland:key-repeat-rate:
+   *
+   * The compositor's key repeat rate in characters per second. `0`
+   * disables key repeat, `-1` means the rate isn't known (e.g. as
+   * there's no keyboard).
+   */
+  props[PHOSH_WAYLAND_PROP_KEY_REPEAT_RATE] =
+    g_param_spec_int ("key-repeat-rate", "", "",
+                      -1, G_MAXINT, -1,
+                      G_PARAM_READABLE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+
+  /**
+   * PhoshWayland:key-repeat-delay:
+   *
+   * The compositor's delay in milliseconds before a held key starts
+   * to repeat, `-1` if not known.
+   */
+  props[PHOSH_WAYLAND_PROP_KEY_REPEAT_DELAY] =
+    g_param_spec_int ("key-repeat-delay", "", "",
+                      -1, G_MAXINT, -1,
+                      G_PARAM_READABLE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+
   g_object_class_install_properties (object_class, PHOSH_WAYLAND_PROP_LAST_PROP, props);
 }
 
@@ -376,6 +555,8 @@ static void
 phosh_wayland_init (PhoshWayland *self)
 {
   self->wl_outputs = g_hash_table_new_full (g_direct_hash,g_direct_equal, NULL, output_destroy);
+  self->key_repeat_rate = -1;
+  self->key_repeat_delay = -1;
 }
 
 /**
@@ -522,6 +703,24 @@ phosh_wayland_get_zwp_virtual_keyboard_manager_v1 (PhoshWayland *self)
 }
 
 
+struct wp_single_pixel_buffer_manager_v1 *
+phosh_wayland_get_wp_single_pixel_buffer_manager_v1 (PhoshWayland *self)
+{
+  g_return_val_if_fail (PHOSH_IS_WAYLAND (self), NULL);
+
+  return self->wp_single_pixel_buffer_manager_v1;
+}
+
+
+struct wp_viewporter *
+phosh_wayland_get_wp_viewporter (PhoshWayland *self)
+{
+  g_return_val_if_fail (PHOSH_IS_WAYLAND (self), NULL);
+
+  return self->wp_viewporter;
+}
+
+
 /**
  * phosh_wayland_get_wl_outputs:
  * @self: The #PhoshWayland singleton
@@ -559,7 +758,79 @@ phosh_wayland_roundtrip (PhoshWayland *self)
 {
   g_return_if_fail (PHOSH_IS_WAYLAND (self));
 
-  wl_display_roundtrip (self->display);
+  phosh_wayland_sync_wait (self, phosh_wayland_sync_begin (self));
+}
+
+
+struct _PhoshWaylandSync {
+  struct wl_callback *callback;
+  gboolean            done;
+};
+
+
+static void
+sync_handle_done (void *data, struct wl_callback *callback, uint32_t serial)
+{
+  PhoshWaylandSync *sync = data;
+
+  sync->done = TRUE;
+}
+
+
+static const struct wl_callback_listener sync_listener = {
+  .done = sync_handle_done,
+};
+
+/**
+ * phosh_wayland_sync_begin:
+ * @self: The wayland object
+ *
+ * Starts a roundtrip without waiting for it to finish. Once
+ * [method@Wayland.sync_wait] returns the compositor processed all
+ * requests made before this call and sent all resulting events. This
+ * allows to do other work while the compositor handles a batch of
+ * requests.
+ *
+ * Returns:(transfer full): The pending sync, pass it to [method@Wayland.sync_wait]
+ */
+PhoshWaylandSync *
+phosh_wayland_sync_begin (PhoshWayland *self)
+{
+  PhoshWaylandSync *sync;
+
+  g_return_val_if_fail (PHOSH_IS_WAYLAND (self), NULL);
+
+  sync = g_new0 (PhoshWaylandSync, 1);
+  sync->callback = wl_display_sync (self->display);
+  wl_callback_add_listener (sync->callback, &sync_listener, sync);
+  wl_display_flush (self->display);
+
+  return sync;
+}
+
+/**
+ * phosh_wayland_sync_wait:
+ * @self: The wayland object
+ * @sync:(transfer full): The sync started with [method@Wayland.sync_begin]
+ *
+ * Dispatches events until the compositor processed the sync.
+ */
+void
+phosh_wayland_sync_wait (PhoshWayland *self, PhoshWaylandSync *sync)
+{
+  int ret = 0;
+
+  g_return_if_fail (PHOSH_IS_WAYLAND (self));
+  g_return_if_fail (sync);
+
+  while (!sync->done && ret >= 0)
+    ret = wl_display_dispatch (self->display);
+
+  if (ret < 0)
+    g_warning ("Failed to dispatch Wayland events: %s", g_strerror (errno));
+
+  wl_callback_destroy (sync->callback);
+  g_free (sync);
 }
 
 
@@ -571,6 +842,30 @@ phosh_wayland_get_seat_capabilities (PhoshWayland *self)
   return self->seat_capabilities;
 }
 
+/**
+ * phosh_wayland_get_key_repeat_info:
+ * @self: The wayland singleton
+ * @rate:(out)(optional): The repeat rate in characters per second
+ * @delay:(out)(optional): The repeat delay in milliseconds
+ *
+ * Get the key repeat info the compositor sent for the seat's
+ * keyboard. A rate of `0` means key repeat is disabled.
+ *
+ * Returns: `TRUE` if the compositor sent repeat info, otherwise `FALSE`
+ */
+gboolean
+phosh_wayland_get_key_repeat_info (PhoshWayland *self, int *rate, int *delay)
+{
+  g_return_val_if_fail (PHOSH_IS_WAYLAND (self), FALSE);
+
+  if (rate)
+    *rate = self->key_repeat_rate;
+  if (delay)
+    *delay = self->key_repeat_delay;
+
+  return self->key_repeat_rate >= 0 && self->key_repeat_delay >= 0;
+}
+
 
 struct zphoc_layer_shell_effects_v1 *
 phosh_wayland_get_zphoc_layer_shell_effects_v1 (PhoshWayland *self)
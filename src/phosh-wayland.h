@@ -8,6 +8,8 @@
 #pragma once
 
 #include "ext-idle-notify-v1-client-protocol.h"
+#include "single-pixel-buffer-v1-client-protocol.h"
+#include "viewporter-client-protocol.h"
 #include "virtual-keyboard-unstable-v1-client-protocol.h"
 #include "phoc-device-state-unstable-v1-client-protocol.h"
 #include "phoc-layer-shell-effects-unstable-v1-client-protocol.h"
@@ -55,6 +57,8 @@ typedef enum {
 
 G_DECLARE_FINAL_TYPE (PhoshWayland, phosh_wayland, PHOSH, WAYLAND, GObject)
 
+typedef struct _PhoshWaylandSync PhoshWaylandSync;
+
 PhoshWayland                         *phosh_wayland_get_default (void);
 GHashTable                           *phosh_wayland_get_wl_outputs (PhoshWayland *self);
 gboolean                              phosh_wayland_has_wl_output  (PhoshWayland *self,
@@ -73,8 +77,16 @@ struct zwlr_output_power_manager_v1 *phosh_wayland_get_zwlr_output_power_manager
 struct zxdg_output_manager_v1        *phosh_wayland_get_zxdg_output_manager_v1 (PhoshWayland *self);
 struct zwlr_screencopy_manager_v1    *phosh_wayland_get_zwlr_screencopy_manager_v1 (PhoshWayland *self);
 struct zwp_virtual_keyboard_manager_v1 *phosh_wayland_get_zwp_virtual_keyboard_manager_v1 (PhoshWayland *self);
+struct wp_single_pixel_buffer_manager_v1 *phosh_wayland_get_wp_single_pixel_buffer_manager_v1 (PhoshWayland *self);
+struct wp_viewporter                 *phosh_wayland_get_wp_viewporter (PhoshWayland *self);
 void                                  phosh_wayland_roundtrip (PhoshWayland *self);
+PhoshWaylandSync                     *phosh_wayland_sync_begin (PhoshWayland *self);
+void                                  phosh_wayland_sync_wait (PhoshWayland     *self,
+                                                               PhoshWaylandSync *sync);
 PhoshWaylandSeatCapabilities          phosh_wayland_get_seat_capabilities (PhoshWayland *self);
+gboolean                              phosh_wayland_get_key_repeat_info (PhoshWayland *self,
+                                                                         int          *rate,
+                                                                         int          *delay);
 struct zphoc_layer_shell_effects_v1  *phosh_wayland_get_zphoc_layer_shell_effects_v1 (PhoshWayland *self);
 struct zphoc_device_state_v1         *phosh_wayland_get_zphoc_device_state_v1 (PhoshWayland *self);
 G_END_DECLS
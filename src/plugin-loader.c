@@ -15,6 +15,10 @@
 #include <gio/gio.h>
 #include <gtk/gtk.h>
 
+#ifdef PHOSH_HAVE_MALLINFO2
+# include <malloc.h>
+#endif
+
 enum {
   PROP_0,
   PROP_PLUGIN_DIRS,
@@ -23,23 +27,142 @@ enum {
 };
 static GParamSpec *props[PROP_LAST_PROP];
 
+enum {
+  PLUGIN_CHANGED,
+  N_SIGNALS
+};
+static guint signals[N_SIGNALS];
+
+#define PLUGIN_INFO_SUFFIX ".plugin"
+#define PLUGIN_INFO_GROUP  "Plugin"
+
 /**
  * PhoshPluginLoader:
  *
  * Loads plugins for a given extension point
  *
+ * The loader reads the `.plugin` files in the plugin directories to
+ * find out which module implements which plugin and only loads the
+ * module once the plugin is requested. Directories without `.plugin`
+ * files are scanned for modules right away.
+ *
+ * Directories with `.plugin` files are monitored. When a `.plugin`
+ * file is added, changed or removed only that file is read again and
+ * [signal@PluginLoader::plugin-changed] is emitted so users can
+ * replace that plugin's widgets without restarting the shell. As
+ * modules can't be unloaded, new widgets use the already loaded
+ * module.
+ *
+ * For each loaded plugin the loader keeps track of the time spent
+ * loading its module and constructing its widget, the approximate heap
+ * growth during that and (for GTK3 widgets) the time until the first
+ * draw as well as the time spent drawing. See
+ * [func@PluginLoader.get_stats].
+ *
  * Since: 0.21.0
  */
 
 struct _PhoshPluginLoader {
-  GObject parent;
+  GObject     parent;
+
+  GStrv       plugin_dirs;
+  char       *extension_point;
+  /* key: plugin name, value: module path */
+  GHashTable *plugin_modules;
+  /* key: plugin info path, value: plugin name */
+  GHashTable *plugin_infos;
+  GPtrArray  *monitors;
+};
 
-  GStrv   plugin_dirs;
+typedef struct {
   char   *extension_point;
-};
+  guint   n_instances;
+  /* All times are in µs */
+  gint64  load_time;
+  gint64  construct_time;
+  gint64  constructed;
+  gint64  first_draw;
+  gint64  draw_start;
+  gint64  draw_time;
+  guint   n_draws;
+  gint64  heap_growth;
+} PhoshPluginStats;
+
+/* Modules must never be unloaded, so keep them for the process' lifetime */
+static GHashTable *loaded_modules;
+/* key: plugin name, value: PhoshPluginStats */
+static GHashTable *plugin_stats;
 
 G_DEFINE_TYPE (PhoshPluginLoader, phosh_plugin_loader, G_TYPE_OBJECT)
 
+static void
+plugin_stats_free (PhoshPluginStats *stats)
+{
+  g_free (stats->extension_point);
+  g_free (stats);
+}
+
+
+static PhoshPluginStats *
+get_plugin_stats (PhoshPluginLoader *self, const char *name)
+{
+  PhoshPluginStats *stats;
+
+  if (G_UNLIKELY (plugin_stats == NULL)) {
+    plugin_stats = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                          g_free, (GDestroyNotify)plugin_stats_free);
+  }
+
+  stats = g_hash_table_lookup (plugin_stats, name);
+  if (stats == NULL) {
+    stats = g_new0 (PhoshPluginStats, 1);
+    stats->extension_point = g_strdup (self->extension_point);
+    stats->first_draw = -1;
+    g_hash_table_insert (plugin_stats, g_strdup (name), stats);
+  }
+
+  return stats;
+}
+
+
+static gint64
+get_heap_size (void)
+{
+#ifdef PHOSH_HAVE_MALLINFO2
+  struct mallinfo2 info = mallinfo2 ();
+
+  return info.uordblks + info.hblkhd;
+#else
+  return 0;
+#endif
+}
+
+#if !GTK_CHECK_VERSION (4, 0, 0)
+static gboolean
+on_plugin_draw (GtkWidget *widget, cairo_t *cr, PhoshPluginStats *stats)
+{
+  stats->draw_start = g_get_monotonic_time ();
+
+  return GDK_EVENT_PROPAGATE;
+}
+
+
+static gboolean
+on_plugin_draw_after (GtkWidget *widget, cairo_t *cr, PhoshPluginStats *stats)
+{
+  gint64 now = g_get_monotonic_time ();
+
+  if (stats->first_draw < 0)
+    stats->first_draw = now - stats->constructed;
+
+  stats->draw_time += now - stats->draw_start;
+  stats->n_draws++;
+
+  return GDK_EVENT_PROPAGATE;
+}
+#endif
+
+
 static void
 phosh_plugin_loader_set_property (GObject      *object,
                                   guint         property_id,
@@ -86,6 +209,179 @@ phosh_plugin_loader_get_property (GObject    *object,
 }
 
 
+static gboolean
+read_plugin_info (PhoshPluginLoader *self, const char *dirname, const char *filename)
+{
+  g_autoptr (GKeyFile) keyfile = g_key_file_new ();
+  g_autoptr (GError) err = NULL;
+  g_autofree char *path = NULL;
+  g_autofree char *id = NULL;
+  g_autofree char *plugin = NULL;
+  g_autofree char *basename = NULL;
+
+  path = g_build_filename (dirname, filename, NULL);
+  if (!g_key_file_load_from_file (keyfile, path, G_KEY_FILE_NONE, &err)) {
+    g_warning ("Failed to load plugin info '%s': %s", path, err->message);
+    return FALSE;
+  }
+
+  id = g_key_file_get_string (keyfile, PLUGIN_INFO_GROUP, "Id", NULL);
+  plugin = g_key_file_get_string (keyfile, PLUGIN_INFO_GROUP, "Plugin", NULL);
+  if (!id || !plugin) {
+    g_warning ("Plugin info '%s' lacks Id or Plugin", path);
+    return FALSE;
+  }
+
+  /* Modules are next to their info so this also works from the build dir */
+  basename = g_path_get_basename (plugin);
+  if (!g_hash_table_contains (self->plugin_modules, id) ||
+      g_strcmp0 (g_hash_table_lookup (self->plugin_infos, path), id) == 0) {
+    g_hash_table_insert (self->plugin_modules,
+                         g_strdup (id),
+                         g_build_filename (dirname, basename, NULL));
+  }
+  g_hash_table_insert (self->plugin_infos, g_steal_pointer (&path), g_steal_pointer (&id));
+
+  return TRUE;
+}
+
+
+static gboolean
+read_plugin_infos (PhoshPluginLoader *self, const char *dirname)
+{
+  g_autoptr (GDir) dir = NULL;
+  const char *filename;
+  gboolean found = FALSE;
+
+  dir = g_dir_open (dirname, 0, NULL);
+  if (!dir)
+    return FALSE;
+
+  while ((filename = g_dir_read_name (dir))) {
+    if (!g_str_has_suffix (filename, PLUGIN_INFO_SUFFIX))
+      continue;
+
+    if (read_plugin_info (self, dirname, filename))
+      found = TRUE;
+  }
+
+  return found;
+}
+
+
+static void
+plugin_info_changed (PhoshPluginLoader *self, GFile *file, gboolean removed)
+{
+  g_autofree char *path = g_file_get_path (file);
+  g_autofree char *dirname = NULL;
+  g_autofree char *basename = NULL;
+  g_autofree char *name = NULL;
+
+  if (path == NULL || !g_str_has_suffix (path, PLUGIN_INFO_SUFFIX))
+    return;
+
+  dirname = g_path_get_dirname (path);
+  if (removed) {
+    const char *module;
+
+    name = g_strdup (g_hash_table_lookup (self->plugin_infos, path));
+    if (name == NULL)
+      return;
+    g_hash_table_remove (self->plugin_infos, path);
+
+    /* Only drop the module if this info provided it */
+    module = g_hash_table_lookup (self->plugin_modules, name);
+    if (module && g_str_has_prefix (module, dirname))
+      g_hash_table_remove (self->plugin_modules, name);
+  } else {
+    basename = g_path_get_basename (path);
+    if (!read_plugin_info (self, dirname, basename))
+      return;
+    name = g_strdup (g_hash_table_lookup (self->plugin_infos, path));
+  }
+
+  g_debug ("Plugin info of '%s' %s", name, removed ? "removed" : "changed");
+  g_signal_emit (self, signals[PLUGIN_CHANGED], 0, name);
+}
+
+
+static void
+on_plugin_dir_changed (PhoshPluginLoader *self,
+                       GFile             *file,
+                       GFile             *other_file,
+                       GFileMonitorEvent  event,
+                       GFileMonitor      *monitor)
+{
+  switch (event) {
+  case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
+  case G_FILE_MONITOR_EVENT_MOVED_IN:
+    plugin_info_changed (self, file, FALSE);
+    break;
+  case G_FILE_MONITOR_EVENT_DELETED:
+  case G_FILE_MONITOR_EVENT_MOVED_OUT:
+    plugin_info_changed (self, file, TRUE);
+    break;
+  case G_FILE_MONITOR_EVENT_RENAMED:
+    /* Atomic updates write a temporary file and rename it */
+    plugin_info_changed (self, file, TRUE);
+    plugin_info_changed (self, other_file, FALSE);
+    break;
+  default:
+    break;
+  }
+}
+
+
+static void
+monitor_plugin_dir (PhoshPluginLoader *self, const char *dirname)
+{
+  g_autoptr (GFile) dir = g_file_new_for_path (dirname);
+  g_autoptr (GError) err = NULL;
+  GFileMonitor *monitor;
+
+  monitor = g_file_monitor_directory (dir, G_FILE_MONITOR_WATCH_MOVES, NULL, &err);
+  if (monitor == NULL) {
+    g_warning ("Failed to monitor '%s': %s", dirname, err->message);
+    return;
+  }
+
+  g_signal_connect_object (monitor, "changed",
+                           G_CALLBACK (on_plugin_dir_changed),
+                           self,
+                           G_CONNECT_SWAPPED);
+  g_ptr_array_add (self->monitors, monitor);
+}
+
+
+static gboolean
+load_module (const char *path)
+{
+  GIOModule *module;
+
+  if (G_UNLIKELY (loaded_modules == NULL))
+    loaded_modules = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+  if (g_hash_table_contains (loaded_modules, path))
+    return FALSE;
+
+  if (!g_file_test (path, G_FILE_TEST_EXISTS)) {
+    g_warning ("Plugin module '%s' does not exist", path);
+    return FALSE;
+  }
+
+  g_debug ("Loading module '%s'", path);
+  module = g_io_module_new (path);
+  g_hash_table_insert (loaded_modules, g_strdup (path), module);
+
+  /* The module implements its extension points when loaded */
+  if (!g_type_module_use (G_TYPE_MODULE (module)))
+    return FALSE;
+  g_type_module_unuse (G_TYPE_MODULE (module));
+
+  return TRUE;
+}
+
+
 static void
 phosh_plugin_loader_constructed (GObject *object)
 {
@@ -105,7 +401,10 @@ phosh_plugin_loader_constructed (GObject *object)
 
   for (int i = 0; i < g_strv_length (self->plugin_dirs); i++) {
     g_debug ("Will load plugins from '%s' for '%s'", self->plugin_dirs[i], self->extension_point);
-    g_io_modules_scan_all_in_directory (self->plugin_dirs[i]);
+    if (read_plugin_infos (self, self->plugin_dirs[i]))
+      monitor_plugin_dir (self, self->plugin_dirs[i]);
+    else
+      g_io_modules_scan_all_in_directory (self->plugin_dirs[i]);
   }
 }
 
@@ -115,8 +414,13 @@ phosh_plugin_loader_dispose (GObject *object)
 {
   PhoshPluginLoader *self = PHOSH_PLUGIN_LOADER (object);
 
+  if (self->monitors)
+    g_ptr_array_foreach (self->monitors, (GFunc) g_file_monitor_cancel, NULL);
+  g_clear_pointer (&self->monitors, g_ptr_array_unref);
+  g_clear_pointer (&self->plugin_infos, g_hash_table_unref);
   g_clear_pointer (&self->plugin_dirs, g_strfreev);
   g_clear_pointer (&self->extension_point, g_free);
+  g_clear_pointer (&self->plugin_modules, g_hash_table_unref);
 
   G_OBJECT_CLASS (phosh_plugin_loader_parent_class)->dispose (object);
 }
@@ -153,12 +457,32 @@ phosh_plugin_loader_class_init (PhoshPluginLoaderClass *klass)
                          G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
 
   g_object_class_install_properties (object_class, PROP_LAST_PROP, props);
+
+  /**
+   * PhoshPluginLoader::plugin-changed:
+   * @self: The plugin loader
+   * @name: The plugin's name
+   *
+   * Emitted when a plugin's `.plugin` file was added, changed or
+   * removed. Users should replace their widgets of that plugin by
+   * loading it again.
+   */
+  signals[PLUGIN_CHANGED] = g_signal_new ("plugin-changed",
+                                          G_TYPE_FROM_CLASS (klass),
+                                          G_SIGNAL_RUN_LAST,
+                                          0, NULL, NULL, NULL,
+                                          G_TYPE_NONE,
+                                          1,
+                                          G_TYPE_STRING);
 }
 
 
 static void
 phosh_plugin_loader_init (PhoshPluginLoader *self)
 {
+  self->plugin_modules = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+  self->plugin_infos = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+  self->monitors = g_ptr_array_new_with_free_func (g_object_unref);
 }
 
 
@@ -185,6 +509,10 @@ phosh_plugin_loader_load_plugin (PhoshPluginLoader *self, const char *name)
 {
   GIOExtensionPoint *ep;
   GIOExtension *extension;
+  PhoshPluginStats *stats;
+  const char *path;
+  GtkWidget *widget;
+  gint64 start, heap_start;
   GType type;
 
   g_return_val_if_fail (PHOSH_IS_PLUGIN_LOADER (self), NULL);
@@ -193,12 +521,44 @@ phosh_plugin_loader_load_plugin (PhoshPluginLoader *self, const char *name)
   ep = g_io_extension_point_lookup (self->extension_point);
 
   extension = g_io_extension_point_get_extension_by_name (ep, name);
-  if (extension == NULL)
-    return NULL;
+  if (extension == NULL) {
+    path = g_hash_table_lookup (self->plugin_modules, name);
+    if (!path)
+      return NULL;
+
+    heap_start = get_heap_size ();
+    start = g_get_monotonic_time ();
+    if (!load_module (path))
+      return NULL;
+
+    stats = get_plugin_stats (self, name);
+    stats->load_time += g_get_monotonic_time () - start;
+    stats->heap_growth += get_heap_size () - heap_start;
+
+    extension = g_io_extension_point_get_extension_by_name (ep, name);
+    if (extension == NULL)
+      return NULL;
+  }
 
   g_debug ("Loading plugin %s", name);
   type = g_io_extension_get_type (extension);
-  return g_object_new (type, NULL);
+
+  stats = get_plugin_stats (self, name);
+  heap_start = get_heap_size ();
+  start = g_get_monotonic_time ();
+  widget = g_object_new (type, NULL);
+  stats->constructed = g_get_monotonic_time ();
+  stats->construct_time += stats->constructed - start;
+  stats->heap_growth += get_heap_size () - heap_start;
+  stats->n_instances++;
+
+#if !GTK_CHECK_VERSION (4, 0, 0)
+  stats->first_draw = -1;
+  g_signal_connect (widget, "draw", G_CALLBACK (on_plugin_draw), stats);
+  g_signal_connect_after (widget, "draw", G_CALLBACK (on_plugin_draw_after), stats);
+#endif
+
+  return widget;
 }
 
 
@@ -218,3 +578,51 @@ phosh_plugin_loader_get_plugin_dirs (PhoshPluginLoader *self)
 
   return (const char *const *)self->plugin_dirs;
 }
+
+
+/**
+ * phosh_plugin_loader_get_stats:
+ *
+ * Get resource usage of all plugins loaded so far. Each plugin's
+ * entry is a dictionary with the extension point, the number of
+ * instances created, the module load time, construction time, time
+ * to first draw and accumulated draw time in µs, the number of draws
+ * and the approximate heap growth during load and construction in
+ * bytes. The time to first draw refers to the latest instance and is
+ * `-1` if it wasn't drawn yet.
+ *
+ * Returns:(transfer floating): The stats as `a{sa{sv}}`
+ */
+GVariant *
+phosh_plugin_loader_get_stats (void)
+{
+  GVariantBuilder builder;
+  GHashTableIter iter;
+  PhoshPluginStats *stats;
+  const char *name;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sa{sv}}"));
+  if (plugin_stats == NULL)
+    return g_variant_builder_end (&builder);
+
+  g_hash_table_iter_init (&iter, plugin_stats);
+  while (g_hash_table_iter_next (&iter, (gpointer *)&name, (gpointer *)&stats)) {
+    GVariantBuilder entry;
+
+    g_variant_builder_init (&entry, G_VARIANT_TYPE ("a{sv}"));
+    g_variant_builder_add (&entry, "{sv}", "extension-point",
+                           g_variant_new_string (stats->extension_point));
+    g_variant_builder_add (&entry, "{sv}", "instances", g_variant_new_uint32 (stats->n_instances));
+    g_variant_builder_add (&entry, "{sv}", "load-time", g_variant_new_int64 (stats->load_time));
+    g_variant_builder_add (&entry, "{sv}", "construct-time",
+                           g_variant_new_int64 (stats->construct_time));
+    g_variant_builder_add (&entry, "{sv}", "first-draw", g_variant_new_int64 (stats->first_draw));
+    g_variant_builder_add (&entry, "{sv}", "draw-time", g_variant_new_int64 (stats->draw_time));
+    g_variant_builder_add (&entry, "{sv}", "draws", g_variant_new_uint32 (stats->n_draws));
+    g_variant_builder_add (&entry, "{sv}", "heap-growth", g_variant_new_int64 (stats->heap_growth));
+
+    g_variant_builder_add (&builder, "{sa{sv}}", name, &entry);
+  }
+
+  return g_variant_builder_end (&builder);
+}
@@ -25,5 +25,6 @@ PhoshPluginLoader *phosh_plugin_loader_new (GStrv plugin_dirs, const char *exten
 GtkWidget         *phosh_plugin_loader_load_plugin (PhoshPluginLoader *self, const char *name);
 const char        *phosh_plugin_loader_get_extension_point (PhoshPluginLoader *self);
 const char *const *phosh_plugin_loader_get_plugin_dirs (PhoshPluginLoader *self);
+GVariant          *phosh_plugin_loader_get_stats (void);
 
 G_END_DECLS
@@ -11,6 +11,7 @@
 #include "launcher-entry-manager.h"
 #include "monitor-manager.h"
 #include "mpris-manager.h"
+#include "power-saver-manager.h"
 #include "session-manager.h"
 #include "shell.h"
 #include "wifi-manager.h"
@@ -24,6 +25,7 @@ PhoshMonitorManager       *phosh_shell_get_monitor_manager (PhoshShell *self);
 PhoshMprisManager         *phosh_shell_get_mpris_manager   (PhoshShell *self);
 PhoshSessionManager       *phosh_shell_get_session_manager (PhoshShell *self);
 /* Created on the fly */
+PhoshPowerSaverManager    *phosh_shell_get_power_saver_manager (PhoshShell *self);
 PhoshWifiManager          *phosh_shell_get_wifi_manager    (PhoshShell *self);
 PhoshWWan                 *phosh_shell_get_wwan            (PhoshShell *self);
 
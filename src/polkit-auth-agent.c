@@ -10,6 +10,7 @@
 
 #include "phosh-config.h"
 
+#include "osk-manager.h"
 #include "polkit-auth-agent.h"
 #include "polkit-auth-prompt.h"
 #include "shell-priv.h"
@@ -215,6 +216,8 @@ auth_request_initiate (AuthRequest *request)
   g_debug ("New prompt for %s", request->message);
   /* We must not issue a new prompt when there's one already */
   g_return_if_fail (!request->agent->current_prompt);
+  /* The prompt asks for a password */
+  phosh_osk_manager_prewarm (phosh_shell_get_osk_manager (phosh_shell_get_default ()));
   request->agent->current_prompt = PHOSH_POLKIT_AUTH_PROMPT (
     phosh_polkit_auth_prompt_new (
       request->action_id,
@@ -26,6 +26,10 @@
  * PhoshPortalAccessManager:
  *
  * Implements org.freedesktop.impl.portal
+ *
+ * The prompt is built once and reused for later requests. When the
+ * user asks to remember a decision it's reused for the same dialog
+ * of the same app until the session ends.
  */
 
 typedef struct _PhoshPortalAccessManager {
@@ -33,8 +37,11 @@ typedef struct _PhoshPortalAccessManager {
   PhoshPortalRequest               *request;
   int                               dbus_name_id;
   PhoshAppAuthPrompt               *app_auth_prompt;
+  GBinding                         *prompt_binding;
   GDBusMethodInvocation            *invocation;
-  GVariant                         *choices;
+  char                             *decision_key;
+  /* app id + dialog → (response, results) */
+  GHashTable                       *decisions;
 } PhoshPortalAccessManager;
 
 static void
@@ -47,30 +54,54 @@ G_DEFINE_TYPE_WITH_CODE (PhoshPortalAccessManager,
                            PHOSH_DBUS_TYPE_IMPL_PORTAL_ACCESS,
                            phosh_portal_access_manager_access_iface_init));
 
+static char *
+get_decision_key (const char *app_id,
+                  const char *title,
+                  const char *subtitle,
+                  const char *body,
+                  GVariant   *choices)
+{
+  g_autofree char *choices_str = choices ? g_variant_print (choices, FALSE) : NULL;
+
+  /* The dialog's texts identify what the app asks for */
+  return g_strjoin ("\x1f", app_id, title, subtitle, body, choices_str ?: "", NULL);
+}
+
+
 static void
 on_access_dialog_closed (PhoshPortalAccessManager *self)
 {
   g_autoptr (GVariantDict) results = g_variant_dict_new (NULL);
+  GtkWidget *prompt = GTK_WIDGET (self->app_auth_prompt);
   GVariant *choices = NULL;
-  gboolean granted = phosh_app_auth_prompt_get_grant_access (GTK_WIDGET (self->app_auth_prompt));
+  GVariant *response_results;
+  gboolean granted = phosh_app_auth_prompt_get_grant_access (prompt);
   guint response = PORTAL_ACCESS_DIALOG_DENIED;
 
   g_clear_object (&self->request);
+  g_clear_pointer (&self->prompt_binding, g_binding_unbind);
 
   if (granted)
     response = PORTAL_ACCESS_DIALOG_GRANTED;
 
-  choices = phosh_app_auth_prompt_get_selected_choices (GTK_WIDGET (self->app_auth_prompt));
+  choices = phosh_app_auth_prompt_get_selected_choices (prompt);
   g_variant_dict_insert_value (results, "choices", choices);
+  response_results = g_variant_ref_sink (g_variant_dict_end (results));
+
+  if (phosh_app_auth_prompt_get_remember (prompt) && self->decision_key) {
+    g_debug ("Remembering decision %u for this session", response);
+    g_hash_table_insert (self->decisions,
+                         g_steal_pointer (&self->decision_key),
+                         g_variant_ref_sink (g_variant_new ("(u@a{sv})", response, response_results)));
+  }
+  g_clear_pointer (&self->decision_key, g_free);
+
   phosh_dbus_impl_portal_access_complete_access_dialog (PHOSH_DBUS_IMPL_PORTAL_ACCESS (self),
                                                         self->invocation,
                                                         response,
-                                                        g_variant_dict_end (results));
+                                                        response_results);
+  g_variant_unref (response_results);
   self->invocation = NULL;
-
-  if (self->app_auth_prompt != NULL)
-    gtk_widget_set_visible (GTK_WIDGET (self->app_auth_prompt), FALSE);
-  g_clear_pointer (&self->app_auth_prompt, phosh_cp_widget_destroy);
 }
 
 
@@ -88,50 +119,82 @@ handle_access_dialog (PhoshDBusImplPortalAccess *object,
   const char *sender;
   const char *grant_label = NULL;
   const char *deny_label = NULL;
+  const char *icon_name = NULL;
   g_autoptr (GIcon) icon = NULL;
-  GVariant *choices = NULL;
-  GVariant *icon_variant = g_variant_lookup_value (arg_options, "icon", G_VARIANT_TYPE_STRING);
+  g_autoptr (GVariant) choices = NULL;
+  g_autofree char *key = NULL;
   PhoshPortalAccessManager *self = PHOSH_PORTAL_ACCESS_MANAGER (object);
-  g_autoptr (PhoshPortalRequest) request = NULL;
+  PhoshShell *shell = phosh_shell_get_default ();
+  GVariant *decision;
 
-  sender = g_dbus_method_invocation_get_sender (invocation);
-  request = phosh_portal_request_new (sender, arg_app_id, arg_handle);
-
-  if (self->app_auth_prompt != NULL) {
+  if (self->invocation != NULL)
     return FALSE;
-  }
-  if (icon_variant != NULL) {
-    const char *icon_name_str = g_variant_get_string (icon_variant, NULL);
-    icon = g_themed_icon_new (icon_name_str);
-  }
-  g_variant_lookup (arg_options, "grant_label", "&s", grant_label);
-  g_variant_lookup (arg_options, "deny_label",  "&s", deny_label);
+
   choices = g_variant_lookup_value (arg_options, "choices",
                                     G_VARIANT_TYPE (PHOSH_APP_AUTH_PROMPT_CHOICES_FORMAT));
 
+  key = get_decision_key (arg_app_id, arg_title, arg_subtitle, arg_body, choices);
+  decision = g_hash_table_lookup (self->decisions, key);
+  if (decision) {
+    guint response;
+    GVariant *results;
+
+    g_debug ("Using remembered decision for '%s'", arg_app_id);
+    g_variant_get (decision, "(u@a{sv})", &response, &results);
+    phosh_dbus_impl_portal_access_complete_access_dialog (object,
+                                                          invocation,
+                                                          response,
+                                                          results);
+    g_variant_unref (results);
+    return TRUE;
+  }
+
+  if (g_variant_lookup (arg_options, "icon", "&s", &icon_name))
+    icon = g_themed_icon_new (icon_name);
+  g_variant_lookup (arg_options, "grant_label", "&s", &grant_label);
+  g_variant_lookup (arg_options, "deny_label",  "&s", &deny_label);
+
+  sender = g_dbus_method_invocation_get_sender (invocation);
   self->invocation = invocation;
-  self->choices = choices;
-  self->request = g_steal_pointer (&request);
-  self->app_auth_prompt = PHOSH_APP_AUTH_PROMPT (
-    phosh_app_auth_prompt_new (icon,
-                               arg_title,
-                               arg_subtitle,
-                               arg_body,
-                               grant_label,
-                               deny_label,
-                               FALSE,
-                               choices));
-
-  g_signal_connect_object (self->app_auth_prompt,
-                           "closed",
-                           G_CALLBACK (on_access_dialog_closed),
-                           self,
-                           G_CONNECT_SWAPPED);
+  self->decision_key = g_steal_pointer (&key);
+  self->request = phosh_portal_request_new (sender, arg_app_id, arg_handle);
+
+  if (self->app_auth_prompt == NULL) {
+    GtkWidget *prompt = phosh_app_auth_prompt_new (icon,
+                                                   arg_title,
+                                                   arg_subtitle,
+                                                   arg_body,
+                                                   grant_label,
+                                                   deny_label,
+                                                   TRUE,
+                                                   choices);
+
+    self->app_auth_prompt = PHOSH_APP_AUTH_PROMPT (g_object_ref_sink (prompt));
+    phosh_system_modal_dialog_set_reusable (PHOSH_SYSTEM_MODAL_DIALOG (self->app_auth_prompt),
+                                            TRUE);
+    g_signal_connect_object (self->app_auth_prompt,
+                             "closed",
+                             G_CALLBACK (on_access_dialog_closed),
+                             self,
+                             G_CONNECT_SWAPPED);
+  } else {
+    phosh_app_auth_prompt_set_request (self->app_auth_prompt,
+                                       icon,
+                                       arg_title,
+                                       arg_subtitle,
+                                       arg_body,
+                                       grant_label,
+                                       deny_label,
+                                       TRUE,
+                                       choices);
+  }
 
   /* Show widget when not locked and keep that in sync */
-  g_object_bind_property (phosh_shell_get_default (), "locked",
-                          self->app_auth_prompt, "visible",
-                          G_BINDING_SYNC_CREATE | G_BINDING_INVERT_BOOLEAN);
+  self->prompt_binding = g_object_bind_property (shell, "locked",
+                                                 self->app_auth_prompt, "visible",
+                                                 G_BINDING_INVERT_BOOLEAN);
+  if (!phosh_shell_get_locked (shell))
+    phosh_system_modal_dialog_present (PHOSH_SYSTEM_MODAL_DIALOG (self->app_auth_prompt));
 
   phosh_portal_request_export (self->request, g_dbus_method_invocation_get_connection (invocation));
   return TRUE;
@@ -200,8 +263,13 @@ phosh_portal_access_manager_dispose (GObject *object)
 {
   PhoshPortalAccessManager *self = PHOSH_PORTAL_ACCESS_MANAGER (object);
 
-  g_clear_pointer (&self->app_auth_prompt, phosh_cp_widget_destroy);
+  g_clear_pointer (&self->prompt_binding, g_binding_unbind);
+  if (self->app_auth_prompt)
+    gtk_widget_destroy (GTK_WIDGET (self->app_auth_prompt));
+  g_clear_object (&self->app_auth_prompt);
   g_clear_object (&self->request);
+  g_clear_pointer (&self->decision_key, g_free);
+  g_clear_pointer (&self->decisions, g_hash_table_unref);
 
   if (g_dbus_interface_skeleton_get_object_path (G_DBUS_INTERFACE_SKELETON (self)))
     g_dbus_interface_skeleton_unexport (G_DBUS_INTERFACE_SKELETON (self));
@@ -223,6 +291,8 @@ phosh_portal_access_manager_class_init (PhoshPortalAccessManagerClass *klass)
 static void
 phosh_portal_access_manager_init (PhoshPortalAccessManager *self)
 {
+  self->decisions = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                           g_free, (GDestroyNotify)g_variant_unref);
 }
 
 PhoshPortalAccessManager *
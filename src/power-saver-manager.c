@@ -0,0 +1,203 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "phosh-power-saver-manager"
+
+#include "phosh-config.h"
+
+#include "power-saver-manager.h"
+
+#include <gio/gio.h>
+
+/**
+ * PhoshPowerSaverManager:
+ *
+ * Tracks whether the shell should save power. This is the case when
+ * power-profiles-daemon's `power-saver` profile is active or the
+ * battery is low.
+ *
+ * Subsystems doing periodic background work (sensor sampling,
+ * position updates, load sampling, …) watch
+ * [property@PowerSaverManager:active] to throttle themselves so
+ * there's a single switch for all of them.
+ */
+
+enum {
+  PROP_0,
+  PROP_BATTERY_MANAGER,
+  PROP_ACTIVE,
+  PROP_LAST_PROP
+};
+static GParamSpec *props[PROP_LAST_PROP];
+
+struct _PhoshPowerSaverManager {
+  PhoshManager          parent;
+
+  PhoshBatteryManager  *battery_manager;
+  GPowerProfileMonitor *power_monitor;
+
+  gboolean              active;
+};
+G_DEFINE_TYPE (PhoshPowerSaverManager, phosh_power_saver_manager, PHOSH_TYPE_MANAGER)
+
+
+static void
+update_active (PhoshPowerSaverManager *self)
+{
+  gboolean power_saver = FALSE, battery_low = FALSE, active;
+
+  if (self->power_monitor)
+    power_saver = g_power_profile_monitor_get_power_saver_enabled (self->power_monitor);
+
+  if (self->battery_manager)
+    g_object_get (self->battery_manager, "low", &battery_low, NULL);
+
+  active = power_saver || battery_low;
+  if (active == self->active)
+    return;
+
+  g_debug ("Power saving %s (power saver: %d, battery low: %d)",
+           active ? "enabled" : "disabled", power_saver, battery_low);
+  self->active = active;
+  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_ACTIVE]);
+}
+
+
+static void
+phosh_power_saver_manager_idle_init (PhoshManager *manager)
+{
+  PhoshPowerSaverManager *self = PHOSH_POWER_SAVER_MANAGER (manager);
+
+  self->power_monitor = g_power_profile_monitor_dup_default ();
+  g_signal_connect_object (self->power_monitor, "notify::power-saver-enabled",
+                           G_CALLBACK (update_active), self,
+                           G_CONNECT_SWAPPED);
+
+  if (self->battery_manager) {
+    g_signal_connect_object (self->battery_manager, "notify::low",
+                             G_CALLBACK (update_active), self,
+                             G_CONNECT_SWAPPED);
+  }
+
+  update_active (self);
+}
+
+
+static void
+phosh_power_saver_manager_set_property (GObject      *object,
+                                        guint         property_id,
+                                        const GValue *value,
+                                        GParamSpec   *pspec)
+{
+  PhoshPowerSaverManager *self = PHOSH_POWER_SAVER_MANAGER (object);
+
+  switch (property_id) {
+  case PROP_BATTERY_MANAGER:
+    self->battery_manager = g_value_dup_object (value);
+    break;
+  default:
+    G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    break;
+  }
+}
+
+
+static void
+phosh_power_saver_manager_get_property (GObject    *object,
+                                        guint       property_id,
+                                        GValue     *value,
+                                        GParamSpec *pspec)
+{
+  PhoshPowerSaverManager *self = PHOSH_POWER_SAVER_MANAGER (object);
+
+  switch (property_id) {
+  case PROP_BATTERY_MANAGER:
+    g_value_set_object (value, self->battery_manager);
+    break;
+  case PROP_ACTIVE:
+    g_value_set_boolean (value, self->active);
+    break;
+  default:
+    G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    break;
+  }
+}
+
+
+static void
+phosh_power_saver_manager_dispose (GObject *object)
+{
+  PhoshPowerSaverManager *self = PHOSH_POWER_SAVER_MANAGER (object);
+
+  g_clear_object (&self->power_monitor);
+  g_clear_object (&self->battery_manager);
+
+  G_OBJECT_CLASS (phosh_power_saver_manager_parent_class)->dispose (object);
+}
+
+
+static void
+phosh_power_saver_manager_class_init (PhoshPowerSaverManagerClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  PhoshManagerClass *manager_class = PHOSH_MANAGER_CLASS (klass);
+
+  object_class->get_property = phosh_power_saver_manager_get_property;
+  object_class->set_property = phosh_power_saver_manager_set_property;
+  object_class->dispose = phosh_power_saver_manager_dispose;
+
+  manager_class->idle_init = phosh_power_saver_manager_idle_init;
+
+  /**
+   * PhoshPowerSaverManager:battery-manager:
+   *
+   * The battery manager used to check for low battery
+   */
+  props[PROP_BATTERY_MANAGER] =
+    g_param_spec_object ("battery-manager", "", "",
+                         PHOSH_TYPE_BATTERY_MANAGER,
+                         G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+  /**
+   * PhoshPowerSaverManager:active:
+   *
+   * Whether the shell should throttle background work to save power
+   */
+  props[PROP_ACTIVE] =
+    g_param_spec_boolean ("active", "", "",
+                          FALSE,
+                          G_PARAM_READABLE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties (object_class, PROP_LAST_PROP, props);
+}
+
+
+static void
+phosh_power_saver_manager_init (PhoshPowerSaverManager *self)
+{
+}
+
+
+PhoshPowerSaverManager *
+phosh_power_saver_manager_new (PhoshBatteryManager *battery_manager)
+{
+  return g_object_new (PHOSH_TYPE_POWER_SAVER_MANAGER, "battery-manager", battery_manager, NULL);
+}
+
+/**
+ * phosh_power_saver_manager_get_active:
+ * @self: The power saver manager
+ *
+ * Gets whether the shell should currently save power.
+ *
+ * Returns: %TRUE if power saving is active
+ */
+gboolean
+phosh_power_saver_manager_get_active (PhoshPowerSaverManager *self)
+{
+  g_return_val_if_fail (PHOSH_IS_POWER_SAVER_MANAGER (self), FALSE);
+
+  return self->active;
+}
@@ -0,0 +1,22 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include "battery-manager.h"
+#include "manager.h"
+
+G_BEGIN_DECLS
+
+#define PHOSH_TYPE_POWER_SAVER_MANAGER (phosh_power_saver_manager_get_type ())
+
+G_DECLARE_FINAL_TYPE (PhoshPowerSaverManager, phosh_power_saver_manager, PHOSH, POWER_SAVER_MANAGER,
+                      PhoshManager)
+
+PhoshPowerSaverManager *phosh_power_saver_manager_new        (PhoshBatteryManager    *battery_manager);
+gboolean                phosh_power_saver_manager_get_active (PhoshPowerSaverManager *self);
+
+G_END_DECLS
@@ -0,0 +1,285 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "phosh-property-batch"
+
+#include "phosh-config.h"
+
+#include "property-batch.h"
+
+/**
+ * PhoshPropertyBatch:
+ *
+ * Collects property notifications of an object and emits them as a
+ * single [signal@PropertyBatch::changed].
+ *
+ * D-Bus proxies emit one `notify` per property even if all of them
+ * arrived in a single `PropertiesChanged` signal. Consumers that
+ * derive their state from several of these properties can use a
+ * `PhoshPropertyBatch` to update once per main loop iteration with
+ * the set of properties that changed instead of once per property.
+ */
+
+enum {
+  PROP_0,
+  PROP_OBJECT,
+  PROP_LAST_PROP
+};
+static GParamSpec *props[PROP_LAST_PROP];
+
+enum {
+  CHANGED,
+  N_SIGNALS
+};
+static guint signals[N_SIGNALS];
+
+struct _PhoshPropertyBatch {
+  GObject     parent;
+
+  GObject    *object;
+  /* The properties we're interested in */
+  GHashTable *properties;
+  /* Changed since the last emission */
+  GPtrArray  *dirty;
+  guint       idle_id;
+};
+G_DEFINE_TYPE (PhoshPropertyBatch, phosh_property_batch, G_TYPE_OBJECT)
+
+
+static gboolean
+on_idle (gpointer data)
+{
+  PhoshPropertyBatch *self = PHOSH_PROPERTY_BATCH (data);
+
+  self->idle_id = 0;
+  phosh_property_batch_flush (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static void
+on_notify (PhoshPropertyBatch *self, GParamSpec *pspec)
+{
+  if (g_hash_table_size (self->properties) &&
+      !g_hash_table_contains (self->properties, pspec->name))
+    return;
+
+  if (g_ptr_array_find_with_equal_func (self->dirty, pspec->name, g_str_equal, NULL))
+    return;
+
+  g_ptr_array_add (self->dirty, g_strdup (pspec->name));
+
+  /* Run before the next frame gets drawn */
+  if (self->idle_id == 0) {
+    self->idle_id = g_idle_add_full (G_PRIORITY_HIGH_IDLE, on_idle, self, NULL);
+    g_source_set_name_by_id (self->idle_id, "[phosh] property batch");
+  }
+}
+
+
+static void
+phosh_property_batch_set_property (GObject      *object,
+                                   guint         property_id,
+                                   const GValue *value,
+                                   GParamSpec   *pspec)
+{
+  PhoshPropertyBatch *self = PHOSH_PROPERTY_BATCH (object);
+
+  switch (property_id) {
+  case PROP_OBJECT:
+    self->object = g_value_dup_object (value);
+    break;
+  default:
+    G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    break;
+  }
+}
+
+
+static void
+phosh_property_batch_get_property (GObject    *object,
+                                   guint       property_id,
+                                   GValue     *value,
+                                   GParamSpec *pspec)
+{
+  PhoshPropertyBatch *self = PHOSH_PROPERTY_BATCH (object);
+
+  switch (property_id) {
+  case PROP_OBJECT:
+    g_value_set_object (value, self->object);
+    break;
+  default:
+    G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    break;
+  }
+}
+
+
+static void
+phosh_property_batch_constructed (GObject *object)
+{
+  PhoshPropertyBatch *self = PHOSH_PROPERTY_BATCH (object);
+
+  G_OBJECT_CLASS (phosh_property_batch_parent_class)->constructed (object);
+
+  g_signal_connect_object (self->object, "notify", G_CALLBACK (on_notify), self,
+                           G_CONNECT_SWAPPED);
+}
+
+
+static void
+phosh_property_batch_dispose (GObject *object)
+{
+  PhoshPropertyBatch *self = PHOSH_PROPERTY_BATCH (object);
+
+  g_clear_handle_id (&self->idle_id, g_source_remove);
+  if (self->object)
+    g_signal_handlers_disconnect_by_data (self->object, self);
+  g_clear_object (&self->object);
+
+  G_OBJECT_CLASS (phosh_property_batch_parent_class)->dispose (object);
+}
+
+
+static void
+phosh_property_batch_finalize (GObject *object)
+{
+  PhoshPropertyBatch *self = PHOSH_PROPERTY_BATCH (object);
+
+  g_clear_pointer (&self->properties, g_hash_table_unref);
+  g_clear_pointer (&self->dirty, g_ptr_array_unref);
+
+  G_OBJECT_CLASS (phosh_property_batch_parent_class)->finalize (object);
+}
+
+
+static void
+phosh_property_batch_class_init (PhoshPropertyBatchClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->get_property = phosh_property_batch_get_property;
+  object_class->set_property = phosh_property_batch_set_property;
+  object_class->constructed = phosh_property_batch_constructed;
+  object_class->dispose = phosh_property_batch_dispose;
+  object_class->finalize = phosh_property_batch_finalize;
+
+  /**
+   * PhoshPropertyBatch:object:
+   *
+   * The object whose property notifications are batched
+   */
+  props[PROP_OBJECT] =
+    g_param_spec_object ("object", "", "",
+                         G_TYPE_OBJECT,
+                         G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties (object_class, PROP_LAST_PROP, props);
+
+  /**
+   * PhoshPropertyBatch::changed:
+   * @self: The property batch
+   * @properties: The names of the properties that changed
+   *
+   * Emitted once per main loop iteration when any of the tracked
+   * properties changed.
+   */
+  signals[CHANGED] = g_signal_new ("changed",
+                                   G_TYPE_FROM_CLASS (klass),
+                                   G_SIGNAL_RUN_LAST,
+                                   0, NULL, NULL, NULL,
+                                   G_TYPE_NONE,
+                                   1,
+                                   G_TYPE_STRV);
+}
+
+
+static void
+phosh_property_batch_init (PhoshPropertyBatch *self)
+{
+  self->properties = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  self->dirty = g_ptr_array_new_null_terminated (4, g_free, TRUE);
+}
+
+/**
+ * phosh_property_batch_new:
+ * @object:(type GObject): The object to track
+ * @first_property:(nullable): The first property to track
+ * @...: More properties, terminated by `NULL`
+ *
+ * Creates a new property batch tracking the given properties of
+ * `object`. If no properties are given all properties are tracked.
+ *
+ * Returns:(transfer full): The property batch
+ */
+PhoshPropertyBatch *
+phosh_property_batch_new (gpointer object, const char *first_property, ...)
+{
+  PhoshPropertyBatch *self;
+  va_list args;
+
+  g_return_val_if_fail (G_IS_OBJECT (object), NULL);
+
+  self = g_object_new (PHOSH_TYPE_PROPERTY_BATCH, "object", object, NULL);
+
+  va_start (args, first_property);
+  for (const char *name = first_property; name; name = va_arg (args, const char *)) {
+    GParamSpec *pspec = g_object_class_find_property (G_OBJECT_GET_CLASS (object), name);
+
+    if (pspec == NULL) {
+      g_critical ("%s has no property '%s'", G_OBJECT_TYPE_NAME (object), name);
+      continue;
+    }
+    /* Use the canonical name as that's what notify hands us */
+    g_hash_table_add (self->properties, g_strdup (pspec->name));
+  }
+  va_end (args);
+
+  return self;
+}
+
+/**
+ * phosh_property_batch_get_object:
+ * @self: The property batch
+ *
+ * Get the tracked object
+ *
+ * Returns:(transfer none)(type GObject): The tracked object
+ */
+gpointer
+phosh_property_batch_get_object (PhoshPropertyBatch *self)
+{
+  g_return_val_if_fail (PHOSH_IS_PROPERTY_BATCH (self), NULL);
+
+  return self->object;
+}
+
+/**
+ * phosh_property_batch_flush:
+ * @self: The property batch
+ *
+ * Emit pending changes right away instead of waiting for the main
+ * loop.
+ */
+void
+phosh_property_batch_flush (PhoshPropertyBatch *self)
+{
+  g_autoptr (GPtrArray) dirty = NULL;
+
+  g_return_if_fail (PHOSH_IS_PROPERTY_BATCH (self));
+
+  g_clear_handle_id (&self->idle_id, g_source_remove);
+
+  if (self->dirty->len == 0)
+    return;
+
+  /* Handlers might cause further notifications */
+  dirty = g_steal_pointer (&self->dirty);
+  self->dirty = g_ptr_array_new_null_terminated (4, g_free, TRUE);
+
+  g_signal_emit (self, signals[CHANGED], 0, (GStrv) dirty->pdata);
+}
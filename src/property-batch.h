@@ -0,0 +1,23 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+#define PHOSH_TYPE_PROPERTY_BATCH (phosh_property_batch_get_type ())
+
+G_DECLARE_FINAL_TYPE (PhoshPropertyBatch, phosh_property_batch, PHOSH, PROPERTY_BATCH, GObject)
+
+PhoshPropertyBatch *phosh_property_batch_new        (gpointer            object,
+                                                     const char         *first_property,
+                                                     ...) G_GNUC_NULL_TERMINATED;
+gpointer            phosh_property_batch_get_object (PhoshPropertyBatch *self);
+void                phosh_property_batch_flush      (PhoshPropertyBatch *self);
+
+G_END_DECLS
@@ -15,6 +15,11 @@
 #include "sensor-proxy-manager.h"
 #include "util.h"
 
+/* Hide the fader only once the sensor reported far for that long */
+#define FAR_DELAY_MS     300
+/* Stop rendering covered surfaces once near for that long */
+#define SUSPEND_DELAY_MS 1000
+
 /**
  * PhoshProximity:
  *
@@ -22,6 +27,16 @@
  *
  * #PhoshProximity handles enabling and disabling the proximity detection
  * based on e.g. active calls.
+ *
+ * While the device is near e.g. the ear during a call a fader blocks
+ * input. As nobody can see them then, the other shell surfaces stop
+ * rendering until the fader goes away.
+ *
+ * Sensors can bounce around their threshold so the fader is shown
+ * right away when the device gets near but only hidden once it stayed
+ * far for a bit. Rendering is only suspended once the device stayed
+ * near for a while so short bounces don't freeze and thaw all
+ * surfaces.
  */
 
 
@@ -42,6 +57,10 @@ typedef struct _PhoshProximity {
   PhoshSensorProxyManager *sensor_proxy_manager;
   PhoshCallsManager *calls_manager;
   PhoshFader *fader;
+  /* Surfaces covered by the fader */
+  GPtrArray *frozen_windows;
+  guint far_id;
+  guint suspend_id;
 
   GCancellable *cancel;
 } PhoshProximity;
@@ -49,9 +68,52 @@ typedef struct _PhoshProximity {
 G_DEFINE_TYPE (PhoshProximity, phosh_proximity, G_TYPE_OBJECT);
 
 
+static void
+suspend_rendering (PhoshProximity *self)
+{
+  g_autoptr (GList) toplevels = gtk_window_list_toplevels ();
+
+  for (GList *l = toplevels; l; l = l->next) {
+    GtkWidget *toplevel = GTK_WIDGET (l->data);
+    GdkWindow *window = gtk_widget_get_window (toplevel);
+
+    if (window == NULL || !gtk_widget_get_mapped (toplevel) || toplevel == GTK_WIDGET (self->fader))
+      continue;
+
+    gdk_window_freeze_updates (window);
+    g_ptr_array_add (self->frozen_windows, g_object_ref (window));
+  }
+
+  g_debug ("Suspended rendering of %u surfaces", self->frozen_windows->len);
+}
+
+
+static void
+resume_rendering (PhoshProximity *self)
+{
+  for (guint i = 0; i < self->frozen_windows->len; i++)
+    gdk_window_thaw_updates (g_ptr_array_index (self->frozen_windows, i));
+  g_ptr_array_set_size (self->frozen_windows, 0);
+}
+
+
+static gboolean
+on_suspend_timeout (gpointer data)
+{
+  PhoshProximity *self = PHOSH_PROXIMITY (data);
+
+  self->suspend_id = 0;
+  suspend_rendering (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+
 static void
 show_fader (PhoshProximity *self, PhoshMonitor *monitor)
 {
+  g_clear_handle_id (&self->far_id, g_source_remove);
+
   if (self->fader)
     return;
 
@@ -61,6 +123,9 @@ show_fader (PhoshProximity *self, PhoshMonitor *monitor)
                               NULL);
   gtk_widget_set_visible (GTK_WIDGET (self->fader), TRUE);
 
+  self->suspend_id = g_timeout_add (SUSPEND_DELAY_MS, on_suspend_timeout, self);
+  g_source_set_name_by_id (self->suspend_id, "[phosh] proximity suspend rendering");
+
   g_object_notify_by_pspec (G_OBJECT (self), props[PROP_FADER]);
 }
 
@@ -68,14 +133,41 @@ show_fader (PhoshProximity *self, PhoshMonitor *monitor)
 static void
 hide_fader (PhoshProximity *self)
 {
+  g_clear_handle_id (&self->far_id, g_source_remove);
+  g_clear_handle_id (&self->suspend_id, g_source_remove);
+
   if (self->fader == NULL)
     return;
 
+  resume_rendering (self);
   g_clear_pointer (&self->fader, phosh_cp_widget_destroy);
   g_object_notify_by_pspec (G_OBJECT (self), props[PROP_FADER]);
 }
 
 
+static gboolean
+on_far_timeout (gpointer data)
+{
+  PhoshProximity *self = PHOSH_PROXIMITY (data);
+
+  self->far_id = 0;
+  hide_fader (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static void
+schedule_hide_fader (PhoshProximity *self)
+{
+  if (self->fader == NULL || self->far_id)
+    return;
+
+  self->far_id = g_timeout_add (FAR_DELAY_MS, on_far_timeout, self);
+  g_source_set_name_by_id (self->far_id, "[phosh] proximity far");
+}
+
+
 static void
 on_proximity_claimed (PhoshSensorProxyManager *sensor_proxy_manager,
                       GAsyncResult            *res,
@@ -208,6 +300,8 @@ on_proximity_near_changed (PhoshProximity          *self,
   g_debug ("Proximity near changed: %d", near);
   if (near && monitor)
     show_fader (self, monitor);
+  else if (monitor)
+    schedule_hide_fader (self);
   else
     hide_fader (self);
 }
@@ -308,11 +402,25 @@ phosh_proximity_dispose (GObject *object)
      g_clear_object (&self->calls_manager);
   }
 
+  g_clear_handle_id (&self->far_id, g_source_remove);
+  g_clear_handle_id (&self->suspend_id, g_source_remove);
+  resume_rendering (self);
   g_clear_pointer (&self->fader, phosh_cp_widget_destroy);
   G_OBJECT_CLASS (phosh_proximity_parent_class)->dispose (object);
 }
 
 
+static void
+phosh_proximity_finalize (GObject *object)
+{
+  PhoshProximity *self = PHOSH_PROXIMITY (object);
+
+  g_clear_pointer (&self->frozen_windows, g_ptr_array_unref);
+
+  G_OBJECT_CLASS (phosh_proximity_parent_class)->finalize (object);
+}
+
+
 static void
 phosh_proximity_class_init (PhoshProximityClass *klass)
 {
@@ -320,6 +428,7 @@ phosh_proximity_class_init (PhoshProximityClass *klass)
 
   object_class->constructed = phosh_proximity_constructed;
   object_class->dispose = phosh_proximity_dispose;
+  object_class->finalize = phosh_proximity_finalize;
 
   object_class->set_property = phosh_proximity_set_property;
   object_class->get_property = phosh_proximity_get_property;
@@ -360,6 +469,7 @@ static void
 phosh_proximity_init (PhoshProximity *self)
 {
   self->cancel = g_cancellable_new ();
+  self->frozen_windows = g_ptr_array_new_with_free_func (g_object_unref);
 }
 
 
@@ -35,6 +35,12 @@
  * this convention and set `showing-status` based on whether they are displaying the status-page
  * or not.
  *
+ * Instead of a status-page instance a quick-setting can be given the
+ * [property@Phosh.QuickSetting:status-page-type]. The status-page is then only
+ * created when it's first about to be shown and destroyed again when it
+ * wasn't shown for a while. This keeps status-pages that are expensive
+ * to build (like the Wi-Fi network list) out of the startup path.
+ *
  * A quick-setting might be temporarily prevented from showing its status-page using
  * [property@Phosh.QuickSetting:can-show-status]. Again, `PhoshQuickSettingsBox` can take care of
  * this property, such that once you tell the box if showing status-page is allowed, it will ensure
@@ -62,6 +68,7 @@ enum {
   PROP_CAN_SHOW_STATUS,
   PROP_STATUS_ICON,
   PROP_STATUS_PAGE,
+  PROP_STATUS_PAGE_TYPE,
   PROP_LONG_PRESS_ACTION_NAME,
   PROP_LONG_PRESS_ACTION_TARGET,
   PROP_LAST_PROP
@@ -77,6 +84,9 @@ enum {
 };
 static guint signals[N_SIGNALS];
 
+/* Destroy lazily created status-pages when unused for that long */
+#define STATUS_PAGE_UNUSED_TIMEOUT_S 120
+
 typedef struct {
   GtkBox          *box;
   GtkLabel        *label;
@@ -89,6 +99,8 @@ typedef struct {
   gboolean         showing_status;
   gboolean         can_show_status;
   PhoshStatusPage *status_page;
+  GType            status_page_type;
+  guint            status_page_unused_id;
   PhoshStatusIcon *status_icon;
   char            *long_press_action_name;
   char            *long_press_action_target;
@@ -124,6 +136,9 @@ phosh_quick_setting_set_property (GObject      *object,
   case PROP_STATUS_PAGE:
     phosh_quick_setting_set_status_page (self, g_value_get_object (value));
     break;
+  case PROP_STATUS_PAGE_TYPE:
+    phosh_quick_setting_set_status_page_type (self, g_value_get_gtype (value));
+    break;
   case PROP_LONG_PRESS_ACTION_NAME:
     phosh_quick_setting_set_long_press_action_name (self, g_value_get_string (value));
     break;
@@ -160,6 +175,9 @@ phosh_quick_setting_get_property (GObject    *object,
   case PROP_STATUS_PAGE:
     g_value_set_object (value, phosh_quick_setting_get_status_page (self));
     break;
+  case PROP_STATUS_PAGE_TYPE:
+    g_value_set_gtype (value, phosh_quick_setting_get_status_page_type (self));
+    break;
   case PROP_LONG_PRESS_ACTION_NAME:
     g_value_set_string (value, phosh_quick_setting_get_long_press_action_name (self));
     break;
@@ -172,6 +190,50 @@ phosh_quick_setting_get_property (GObject    *object,
 }
 
 
+static void
+update_arrow (PhoshQuickSetting *self)
+{
+  PhoshQuickSettingPrivate *priv = phosh_quick_setting_get_instance_private (self);
+  gboolean has_status;
+
+  has_status = priv->status_page != NULL || priv->status_page_type != G_TYPE_NONE;
+  gtk_widget_set_visible (GTK_WIDGET (priv->arrow_btn), has_status && priv->can_show_status);
+}
+
+
+static void
+on_status_page_unused (gpointer data)
+{
+  PhoshQuickSetting *self = PHOSH_QUICK_SETTING (data);
+  PhoshQuickSettingPrivate *priv = phosh_quick_setting_get_instance_private (self);
+
+  priv->status_page_unused_id = 0;
+
+  if (priv->showing_status)
+    return;
+
+  g_debug ("Destroying unused status-page %s", g_type_name (priv->status_page_type));
+  phosh_quick_setting_set_status_page (self, NULL);
+}
+
+
+static void
+on_show_status (PhoshQuickSetting *self)
+{
+  PhoshQuickSettingPrivate *priv = phosh_quick_setting_get_instance_private (self);
+  PhoshStatusPage *status_page;
+
+  g_clear_handle_id (&priv->status_page_unused_id, g_source_remove);
+
+  if (priv->status_page != NULL || priv->status_page_type == G_TYPE_NONE)
+    return;
+
+  g_debug ("Creating status-page %s", g_type_name (priv->status_page_type));
+  status_page = g_object_new (priv->status_page_type, "visible", TRUE, NULL);
+  phosh_quick_setting_set_status_page (self, status_page);
+}
+
+
 static void
 on_status_icon_destroy (PhoshQuickSetting *self)
 {
@@ -265,6 +327,7 @@ phosh_quick_setting_finalize (GObject *object)
   PhoshQuickSetting *self = PHOSH_QUICK_SETTING (object);
   PhoshQuickSettingPrivate *priv = phosh_quick_setting_get_instance_private (self);
 
+  g_clear_handle_id (&priv->status_page_unused_id, g_source_remove);
   g_clear_object (&priv->status_page);
   g_clear_pointer (&priv->long_press_action_name, g_free);
   g_clear_pointer (&priv->long_press_action_target, g_free);
@@ -341,6 +404,16 @@ phosh_quick_setting_class_init (PhoshQuickSettingClass *klass)
     g_param_spec_object ("status-page", "", "",
                          PHOSH_TYPE_STATUS_PAGE,
                          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+  /**
+   * PhoshQuickSetting:status-page-type:
+   *
+   * The type of the status-page to create when the status-page is
+   * about to be shown. See [method@Phosh.QuickSetting.set_status_page_type].
+   */
+  props[PROP_STATUS_PAGE_TYPE] =
+    g_param_spec_gtype ("status-page-type", "", "",
+                        PHOSH_TYPE_STATUS_PAGE,
+                        G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
   /**
    * PhoshQuickSetting:long-press-action-name:
    *
@@ -400,7 +473,14 @@ phosh_quick_setting_class_init (PhoshQuickSettingClass *klass)
 static void
 phosh_quick_setting_init (PhoshQuickSetting *self)
 {
+  PhoshQuickSettingPrivate *priv = phosh_quick_setting_get_instance_private (self);
+
+  priv->status_page_type = G_TYPE_NONE;
+
   gtk_widget_init_template (GTK_WIDGET (self));
+
+  /* Connected first so the status-page exists when others handle the signal */
+  g_signal_connect (self, "show-status", G_CALLBACK (on_show_status), NULL);
 }
 
 GtkWidget *
@@ -468,6 +548,14 @@ phosh_quick_setting_set_showing_status (PhoshQuickSetting *self, gboolean showin
 
   gtk_image_set_from_icon_name (priv->arrow, icon_name, -1);
 
+  g_clear_handle_id (&priv->status_page_unused_id, g_source_remove);
+  if (!priv->showing_status && priv->status_page && priv->status_page_type != G_TYPE_NONE) {
+    priv->status_page_unused_id = g_timeout_add_seconds_once (STATUS_PAGE_UNUSED_TIMEOUT_S,
+                                                              on_status_page_unused,
+                                                              self);
+    g_source_set_name_by_id (priv->status_page_unused_id, "[phosh] status-page-unused");
+  }
+
   g_object_notify_by_pspec (G_OBJECT (self), props[PROP_SHOWING_STATUS]);
 }
 
@@ -498,8 +586,7 @@ phosh_quick_setting_set_can_show_status (PhoshQuickSetting *self, gboolean can_s
     return;
 
   priv->can_show_status = can_show_status;
-  gtk_widget_set_visible (GTK_WIDGET (priv->arrow_btn),
-                          priv->status_page != NULL && priv->can_show_status);
+  update_arrow (self);
 
   g_object_notify_by_pspec (G_OBJECT (self), props[PROP_CAN_SHOW_STATUS]);
 }
@@ -627,8 +714,7 @@ phosh_quick_setting_set_status_page (PhoshQuickSetting *self, PhoshStatusPage *s
                              G_CONNECT_SWAPPED);
   }
 
-  gtk_widget_set_visible (GTK_WIDGET (priv->arrow_btn),
-                          priv->status_page != NULL && priv->can_show_status);
+  update_arrow (self);
 
   g_object_notify_by_pspec (G_OBJECT (self), props[PROP_STATUS_PAGE]);
 }
@@ -654,6 +740,54 @@ phosh_quick_setting_get_status_page (PhoshQuickSetting *self)
   return priv->status_page;
 }
 
+/**
+ * phosh_quick_setting_set_status_page_type:
+ * @self: A quick-setting
+ * @status_page_type: A type deriving from [class@Phosh.StatusPage] or `G_TYPE_NONE`
+ *
+ * Set the type of the status-page. The status-page is created when
+ * it's about to be shown and destroyed when it wasn't shown for a while.
+ */
+void
+phosh_quick_setting_set_status_page_type (PhoshQuickSetting *self, GType status_page_type)
+{
+  PhoshQuickSettingPrivate *priv;
+
+  g_return_if_fail (PHOSH_IS_QUICK_SETTING (self));
+  g_return_if_fail (status_page_type == G_TYPE_NONE ||
+                    g_type_is_a (status_page_type, PHOSH_TYPE_STATUS_PAGE));
+
+  priv = phosh_quick_setting_get_instance_private (self);
+
+  if (priv->status_page_type == status_page_type)
+    return;
+
+  priv->status_page_type = status_page_type;
+  update_arrow (self);
+
+  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_STATUS_PAGE_TYPE]);
+}
+
+/**
+ * phosh_quick_setting_get_status_page_type:
+ * @self: A quick-setting
+ *
+ * Get the type of status-page created on demand.
+ *
+ * Returns: The status-page type or `G_TYPE_NONE`
+ */
+GType
+phosh_quick_setting_get_status_page_type (PhoshQuickSetting *self)
+{
+  PhoshQuickSettingPrivate *priv;
+
+  g_return_val_if_fail (PHOSH_IS_QUICK_SETTING (self), G_TYPE_NONE);
+
+  priv = phosh_quick_setting_get_instance_private (self);
+
+  return priv->status_page_type;
+}
+
 
 void
 phosh_quick_setting_set_long_press_action_name (PhoshQuickSetting *self, const char *action_name)
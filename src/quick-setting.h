@@ -42,6 +42,8 @@ void             phosh_quick_setting_set_status_icon (PhoshQuickSetting *self, P
 PhoshStatusIcon *phosh_quick_setting_get_status_icon (PhoshQuickSetting *self);
 void             phosh_quick_setting_set_status_page (PhoshQuickSetting *self, PhoshStatusPage *status_page);
 PhoshStatusPage *phosh_quick_setting_get_status_page (PhoshQuickSetting *self);
+void             phosh_quick_setting_set_status_page_type (PhoshQuickSetting *self, GType status_page_type);
+GType            phosh_quick_setting_get_status_page_type (PhoshQuickSetting *self);
 void             phosh_quick_setting_set_long_press_action_name (PhoshQuickSetting *self, const char *action_name);
 const char      *phosh_quick_setting_get_long_press_action_name (PhoshQuickSetting *self);
 void             phosh_quick_setting_set_long_press_action_target (PhoshQuickSetting *self, const char *action_target);
@@ -22,6 +22,7 @@
 
 #define CUSTOM_QUICK_SETTINGS_SCHEMA "sm.puri.phosh.plugins"
 #define CUSTOM_QUICK_SETTINGS_KEY "quick-settings"
+#define CUSTOM_QUICK_SETTING_PLUGIN_KEY "phosh-custom-quick-setting-plugin"
 
 /**
  * PhoshQuickSettings:
@@ -33,6 +34,10 @@
  *
  * For example, tapping a Wi-Fi quick-setting would toggle its off/on state. Long pressing a
  * rotation quick-setting would change the rotation configuration.
+ *
+ * While the quick-settings aren't visible their status-icons' property
+ * notifications are coalesced and only emitted once they become visible
+ * again. See [method@Phosh.QuickSettings.set_ui_visible].
  */
 
 struct _PhoshQuickSettings {
@@ -43,6 +48,10 @@ struct _PhoshQuickSettings {
   GSettings *plugin_settings;
   PhoshPluginLoader *plugin_loader;
   GPtrArray *custom_quick_settings;
+
+  gboolean   ui_visible;
+  /* Status icons with frozen notifications */
+  GPtrArray *frozen_icons;
 };
 
 G_DEFINE_TYPE (PhoshQuickSettings, phosh_quick_settings, GTK_TYPE_BIN);
@@ -223,25 +232,41 @@ unload_custom_quick_setting (GtkWidget *quick_setting)
 }
 
 
+/*
+ * Keep the widgets up to the first one that differs from the configured
+ * plugins or belongs to the @changed plugin and load the rest anew. This
+ * keeps the order in the box intact without rebuilding everything when
+ * e.g. a plugin gets appended.
+ */
 static void
-load_custom_quick_settings (PhoshQuickSettings *self, GSettings *settings, char *key)
+reload_custom_quick_settings (PhoshQuickSettings *self, const char *changed)
 {
   g_auto (GStrv) plugins = NULL;
   GtkWidget *widget;
+  guint keep = 0;
 
-  g_ptr_array_remove_range (self->custom_quick_settings, 0, self->custom_quick_settings->len);
   plugins = g_settings_get_strv (self->plugin_settings, CUSTOM_QUICK_SETTINGS_KEY);
 
-  if (plugins == NULL)
-    return;
+  for (; plugins[keep] && keep < self->custom_quick_settings->len; keep++) {
+    const char *name;
 
-  for (int i = 0; plugins[i]; i++) {
+    widget = g_ptr_array_index (self->custom_quick_settings, keep);
+    name = g_object_get_data (G_OBJECT (widget), CUSTOM_QUICK_SETTING_PLUGIN_KEY);
+    if (g_strcmp0 (name, plugins[keep]) || g_strcmp0 (name, changed) == 0)
+      break;
+  }
+  g_ptr_array_remove_range (self->custom_quick_settings, keep,
+                            self->custom_quick_settings->len - keep);
+
+  for (int i = keep; plugins[i]; i++) {
     g_debug ("Loading custom quick setting: %s", plugins[i]);
     widget = phosh_plugin_loader_load_plugin (self->plugin_loader, plugins[i]);
 
     if (widget == NULL) {
       g_warning ("Custom quick setting '%s' not found", plugins[i]);
     } else {
+      g_object_set_data_full (G_OBJECT (widget), CUSTOM_QUICK_SETTING_PLUGIN_KEY,
+                              g_strdup (plugins[i]), g_free);
       phosh_quick_settings_box_add (self->box, PHOSH_QUICK_SETTING (widget));
       g_ptr_array_add (self->custom_quick_settings, widget);
     }
@@ -249,11 +274,41 @@ load_custom_quick_settings (PhoshQuickSettings *self, GSettings *settings, char
 }
 
 
+static void
+load_custom_quick_settings (PhoshQuickSettings *self, GSettings *settings, char *key)
+{
+  reload_custom_quick_settings (self, NULL);
+}
+
+
+static void
+on_custom_quick_setting_changed (PhoshQuickSettings *self, const char *name)
+{
+  g_auto (GStrv) plugins = g_settings_get_strv (self->plugin_settings, CUSTOM_QUICK_SETTINGS_KEY);
+
+  if (!g_strv_contains ((const char * const *) plugins, name))
+    return;
+
+  g_debug ("Reloading custom quick setting: %s", name);
+  reload_custom_quick_settings (self, name);
+}
+
+
+static void
+thaw_icon (GObject *icon)
+{
+  g_object_thaw_notify (icon);
+  g_object_unref (icon);
+}
+
+
 static void
 phosh_quick_settings_dispose (GObject *object)
 {
   PhoshQuickSettings *self = PHOSH_QUICK_SETTINGS (object);
 
+  g_clear_pointer (&self->frozen_icons, g_ptr_array_unref);
+
   g_clear_object (&self->plugin_settings);
   g_clear_object (&self->plugin_loader);
   if (self->custom_quick_settings) {
@@ -303,6 +358,9 @@ phosh_quick_settings_init (PhoshQuickSettings *self)
 {
   const char *plugin_dirs[] = { PHOSH_PLUGINS_DIR, NULL};
 
+  self->ui_visible = TRUE;
+  self->frozen_icons = g_ptr_array_new_with_free_func ((GDestroyNotify) thaw_icon);
+
   gtk_widget_init_template (GTK_WIDGET (self));
 
   g_object_bind_property (phosh_shell_get_default (), "locked",
@@ -316,6 +374,8 @@ phosh_quick_settings_init (PhoshQuickSettings *self)
 
   g_signal_connect_object (self->plugin_settings, "changed::" CUSTOM_QUICK_SETTINGS_KEY,
                            G_CALLBACK (load_custom_quick_settings), self, G_CONNECT_SWAPPED);
+  g_signal_connect_object (self->plugin_loader, "plugin-changed",
+                           G_CALLBACK (on_custom_quick_setting_changed), self, G_CONNECT_SWAPPED);
 
   load_custom_quick_settings (self, NULL, NULL);
 }
@@ -335,3 +395,48 @@ phosh_quick_settings_hide_status (PhoshQuickSettings *self)
 
   phosh_quick_settings_box_hide_status (self->box);
 }
+
+/**
+ * phosh_quick_settings_set_ui_visible:
+ * @self: The quick settings
+ * @visible: Whether the quick settings are visible to the user
+ *
+ * When not visible the property notifications of the quick-settings'
+ * status-icons are coalesced so changes in the underlying managers
+ * don't propagate into the quick-settings and their status-pages.
+ * The latest state is flushed once the quick settings become visible
+ * again.
+ */
+void
+phosh_quick_settings_set_ui_visible (PhoshQuickSettings *self, gboolean visible)
+{
+  g_autoptr (GList) children = NULL;
+
+  g_return_if_fail (PHOSH_IS_QUICK_SETTINGS (self));
+
+  if (self->ui_visible == visible)
+    return;
+
+  self->ui_visible = visible;
+  g_debug ("Quick settings visible: %d", visible);
+
+  if (visible) {
+    g_ptr_array_set_size (self->frozen_icons, 0);
+    return;
+  }
+
+  children = gtk_container_get_children (GTK_CONTAINER (self->box));
+  for (GList *l = children; l; l = l->next) {
+    PhoshStatusIcon *icon;
+
+    if (!PHOSH_IS_QUICK_SETTING (l->data))
+      continue;
+
+    icon = phosh_quick_setting_get_status_icon (PHOSH_QUICK_SETTING (l->data));
+    if (icon == NULL)
+      continue;
+
+    g_object_freeze_notify (G_OBJECT (icon));
+    g_ptr_array_add (self->frozen_icons, g_object_ref (icon));
+  }
+}
@@ -15,5 +15,6 @@ G_DECLARE_FINAL_TYPE (PhoshQuickSettings, phosh_quick_settings, PHOSH, QUICK_SET
 
 GtkWidget *phosh_quick_settings_new (void);
 void       phosh_quick_settings_hide_status (PhoshQuickSettings *self);
+void       phosh_quick_settings_set_ui_visible (PhoshQuickSettings *self, gboolean visible);
 
 G_END_DECLS
@@ -10,6 +10,7 @@
 
 #include "phosh-config.h"
 
+#include "animation.h"
 #include "revealer.h"
 
 /**
@@ -47,6 +48,22 @@ struct _PhoshRevealer {
 G_DEFINE_TYPE (PhoshRevealer, phosh_revealer, GTK_TYPE_BIN)
 
 
+static void
+apply_transition (PhoshRevealer *self)
+{
+  GtkRevealerTransitionType type = self->transition_type;
+
+  /* Sliding is motion, prefer a crossfade */
+  if (phosh_animation_get_profile () == PHOSH_ANIMATION_PROFILE_REDUCED &&
+      type != GTK_REVEALER_TRANSITION_TYPE_NONE)
+    type = GTK_REVEALER_TRANSITION_TYPE_CROSSFADE;
+
+  gtk_revealer_set_transition_type (self->revealer, type);
+  gtk_revealer_set_transition_duration (self->revealer,
+                                        phosh_animation_scale_duration (self->transition_duration));
+}
+
+
 static void
 on_child_revealed_changed (PhoshRevealer *self)
 {
@@ -288,6 +305,8 @@ phosh_revealer_set_show_child (PhoshRevealer *self, gboolean show_child)
     /* Child will be hidden at the end of the animation */
   }
 
+  /* The animation profile might have changed since the last transition */
+  apply_transition (self);
   gtk_revealer_set_reveal_child (self->revealer, show_child);
 }
 
@@ -323,7 +342,7 @@ phosh_revealer_set_transition_duration (PhoshRevealer *self, guint transition_du
     return;
 
   self->transition_duration = transition_duration;
-  gtk_revealer_set_transition_duration (self->revealer, self->transition_duration);
+  apply_transition (self);
 }
 
 /**
@@ -358,5 +377,5 @@ phosh_revealer_set_transition_type (PhoshRevealer *self, GtkRevealerTransitionTy
     return;
 
   self->transition_type = transition_type;
-  gtk_revealer_set_transition_type (self->revealer, self->transition_type);
+  apply_transition (self);
 }
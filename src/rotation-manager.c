@@ -80,7 +80,9 @@ static void
 apply_transform (PhoshRotationManager *self, PhoshMonitorTransform transform)
 {
   PhoshMonitorTransform current;
-  PhoshMonitorManager *monitor_manager = phosh_shell_get_monitor_manager (phosh_shell_get_default());
+  PhoshShell *shell = phosh_shell_get_default ();
+  PhoshMonitorManager *monitor_manager = phosh_shell_get_monitor_manager (shell);
+  PhoshBackgroundManager *background_manager;
 
   g_return_if_fail (PHOSH_IS_MONITOR_MANAGER (monitor_manager));
 
@@ -92,6 +94,13 @@ apply_transform (PhoshRotationManager *self, PhoshMonitorTransform transform)
     return;
 
   g_debug ("Rotating %s to %d", self->monitor->name, transform);
+
+  /* Get the background ready while the compositor reconfigures the output */
+  background_manager = phosh_shell_get_background_manager (shell);
+  if (background_manager &&
+      phosh_monitor_transform_is_tilted (current) != phosh_monitor_transform_is_tilted (transform))
+    phosh_background_manager_prepare_rotation (background_manager, self->monitor);
+
   phosh_monitor_manager_set_monitor_transform (monitor_manager,
                                                self->monitor,
                                                transform);
@@ -8,6 +8,8 @@
 
 #define G_LOG_DOMAIN "phosh-run-command-manager"
 
+#include "app-scopes.h"
+#include "app-tracker.h"
 #include "run-command-manager.h"
 #include "run-command-dialog.h"
 #include "shell-priv.h"
@@ -23,6 +25,11 @@
  *
  * The interface is responsible to handle the non-ui parts of a
  * #PhoshRunCommandDialog.
+ *
+ * Commands don't inherit the shell's debug settings and are moved into
+ * their own systemd scope like launched apps so they're subject to the
+ * same resource controls and don't take the shell's unit down with them
+ * (or vice versa).
  */
 
 typedef struct _PhoshRunCommandManager {
@@ -34,45 +41,64 @@ typedef struct _PhoshRunCommandManager {
 
 G_DEFINE_TYPE (PhoshRunCommandManager, phosh_run_command_manager, G_TYPE_OBJECT)
 
+/* Only meant for the shell itself */
+static const char * const private_env[] = {
+  "G_DEBUG",
+  "G_MESSAGES_DEBUG",
+  "GDK_DEBUG",
+  "GTK_DEBUG",
+  "PHOSH_DEBUG",
+};
+
+
 static void
-cleanup_child_process (GPid pid, gint status, void *user_data)
+on_child_exited (GObject *source_object, GAsyncResult *res, gpointer user_data)
 {
   g_autoptr (GError) error = NULL;
 
-  g_spawn_close_pid (pid);
-
-  if (!g_spawn_check_wait_status (status, &error))
-    g_warning ("Could not end child process: %s\n", error->message);
+  if (!g_subprocess_wait_check_finish (G_SUBPROCESS (source_object), res, &error))
+    g_warning ("Could not end child process: %s", error->message);
 }
 
 static gboolean
 run_command (char *command)
 {
-  GPid child_pid;
   g_auto (GStrv) argv = NULL;
   g_autoptr (GError) error = NULL;
+  g_autoptr (GSubprocessLauncher) launcher = NULL;
+  g_autoptr (GSubprocess) subprocess = NULL;
+  g_autofree char *app_id = NULL;
+  const char *identifier;
+  PhoshAppTracker *app_tracker;
 
   if (!g_shell_parse_argv (command, NULL, &argv, &error)) {
     g_warning ("Could not parse command: %s\n", error->message);
     return FALSE;
   }
-  if (g_spawn_async (NULL,
-                      argv,
-                      NULL,
-                      G_SPAWN_DO_NOT_REAP_CHILD |
-                      G_SPAWN_SEARCH_PATH |
-                      G_SPAWN_STDOUT_TO_DEV_NULL |
-                      G_SPAWN_STDERR_TO_DEV_NULL,
-                      NULL,
-                      NULL,
-                      &child_pid,
-                      &error)) {
-    g_child_watch_add (child_pid, cleanup_child_process, NULL);
-    return TRUE;
+
+  /* stdin is /dev/null and fds besides stdio aren't inherited */
+  launcher = g_subprocess_launcher_new (G_SUBPROCESS_FLAGS_STDOUT_SILENCE |
+                                        G_SUBPROCESS_FLAGS_STDERR_SILENCE);
+  for (guint i = 0; i < G_N_ELEMENTS (private_env); i++)
+    g_subprocess_launcher_unsetenv (launcher, private_env[i]);
+
+  subprocess = g_subprocess_launcher_spawnv (launcher, (const char * const *)argv, &error);
+  if (!subprocess) {
+    g_warning ("Could not run command: %s\n", error->message);
+    return FALSE;
+  }
+  g_subprocess_wait_check_async (subprocess, NULL, on_child_exited, NULL);
+
+  identifier = g_subprocess_get_identifier (subprocess);
+  app_tracker = phosh_shell_get_app_tracker (phosh_shell_get_default ());
+  if (identifier && app_tracker) {
+    app_id = g_path_get_basename (argv[0]);
+    phosh_app_scopes_add (phosh_app_tracker_get_scopes (app_tracker),
+                          app_id,
+                          (GPid) g_ascii_strtoll (identifier, NULL, 10));
   }
 
-  g_warning ("Could not run command: %s\n", error->message);
-  return FALSE;
+  return TRUE;
 }
 
 static void
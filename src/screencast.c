@@ -0,0 +1,536 @@
+/*
+ * Copyright (C) 2026 Phosh.mobi e.V.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Author: Guido Günther <agx@sigxcpu.org>
+ */
+
+#define G_LOG_DOMAIN "phosh-screencast"
+
+#include "phosh-config.h"
+
+#include "phosh-wayland.h"
+#include "screencast.h"
+#include "wl-buffer.h"
+
+/* Enough for one buffer being copied while the consumer holds another one */
+#define RING_SIZE 3
+
+/**
+ * PhoshScreencast:
+ *
+ * Continuous capture of a single output
+ *
+ * A `PhoshScreencast` captures a monitor's content over and over again
+ * using wlr-screencopy. The frames are copied into a small ring of
+ * shared memory buffers that are reused for subsequent frames so no
+ * buffers are allocated while capturing. Where supported the next
+ * frame is only copied once the compositor reports damage, so an idle
+ * output doesn't cause any copies.
+ *
+ * Each captured frame is handed to consumers via the
+ * [signal@Screencast::frame] signal together with the damaged region.
+ */
+
+enum {
+  PROP_0,
+  PROP_MONITOR,
+  PROP_INCLUDE_CURSOR,
+  PROP_RUNNING,
+  PROP_LAST_PROP
+};
+static GParamSpec *props[PROP_LAST_PROP];
+
+enum {
+  FRAME,
+  N_SIGNALS
+};
+static guint signals[N_SIGNALS];
+
+struct _PhoshScreencast {
+  GObject                          parent;
+
+  PhoshMonitor                    *monitor;
+  gboolean                         include_cursor;
+  gboolean                         running;
+
+  struct zwlr_screencopy_frame_v1 *frame;
+  uint32_t                         flags;
+  struct {
+    gboolean                       offered;
+    enum wl_shm_format             format;
+    uint32_t                       width, height, stride;
+  } shm;
+  cairo_region_t                  *damage;
+  gboolean                         with_damage;
+
+  PhoshWlBuffer                   *ring[RING_SIZE];
+  guint                            current;
+  guint64                          n_frames;
+};
+G_DEFINE_TYPE (PhoshScreencast, phosh_screencast, G_TYPE_OBJECT)
+
+
+static void capture_next (PhoshScreencast *self);
+
+
+static void
+set_running (PhoshScreencast *self, gboolean running)
+{
+  if (self->running == running)
+    return;
+
+  self->running = running;
+  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_RUNNING]);
+}
+
+
+static void
+clear_frame (PhoshScreencast *self)
+{
+  g_clear_pointer (&self->frame, zwlr_screencopy_frame_v1_destroy);
+  self->shm.offered = FALSE;
+  self->flags = 0;
+}
+
+
+static void
+copy_frame (PhoshScreencast *self)
+{
+  PhoshWlBuffer *buffer = self->ring[self->current];
+
+  /* Output mode changes invalidate the slot */
+  if (buffer && (buffer->format != self->shm.format ||
+                 buffer->width != self->shm.width ||
+                 buffer->height != self->shm.height ||
+                 buffer->stride != self->shm.stride)) {
+    g_clear_pointer (&self->ring[self->current], phosh_wl_buffer_destroy);
+  }
+
+  if (self->ring[self->current] == NULL) {
+    self->ring[self->current] = phosh_wl_buffer_new (self->shm.format,
+                                                     self->shm.width,
+                                                     self->shm.height,
+                                                     self->shm.stride);
+  }
+  buffer = self->ring[self->current];
+  g_return_if_fail (buffer);
+
+  self->with_damage = zwlr_screencopy_frame_v1_get_version (self->frame) >=
+    ZWLR_SCREENCOPY_FRAME_V1_COPY_WITH_DAMAGE_SINCE_VERSION;
+
+  /* Only copy the next frame once something changed */
+  if (self->with_damage && self->n_frames)
+    zwlr_screencopy_frame_v1_copy_with_damage (self->frame, buffer->wl_buffer);
+  else
+    zwlr_screencopy_frame_v1_copy (self->frame, buffer->wl_buffer);
+}
+
+
+static void
+screencopy_frame_handle_buffer (void                            *data,
+                                struct zwlr_screencopy_frame_v1 *frame,
+                                uint32_t                         format,
+                                uint32_t                         width,
+                                uint32_t                         height,
+                                uint32_t                         stride)
+{
+  PhoshScreencast *self = PHOSH_SCREENCAST (data);
+
+  self->shm.offered = TRUE;
+  self->shm.format = format;
+  self->shm.width = width;
+  self->shm.height = height;
+  self->shm.stride = stride;
+
+  /* Older versions don't enumerate buffer types */
+  if (zwlr_screencopy_frame_v1_get_version (frame) <
+      ZWLR_SCREENCOPY_FRAME_V1_BUFFER_DONE_SINCE_VERSION)
+    copy_frame (self);
+}
+
+
+static void
+screencopy_frame_handle_flags (void                            *data,
+                               struct zwlr_screencopy_frame_v1 *frame,
+                               uint32_t                         flags)
+{
+  PhoshScreencast *self = PHOSH_SCREENCAST (data);
+
+  self->flags = flags;
+}
+
+
+static void
+screencopy_frame_handle_ready (void                            *data,
+                               struct zwlr_screencopy_frame_v1 *frame,
+                               uint32_t                         tv_sec_hi,
+                               uint32_t                         tv_sec_lo,
+                               uint32_t                         tv_nsec)
+{
+  PhoshScreencast *self = PHOSH_SCREENCAST (data);
+  g_autoptr (cairo_region_t) damage = NULL;
+  PhoshWlBuffer *buffer = self->ring[self->current];
+  uint32_t flags = self->flags;
+
+  clear_frame (self);
+
+  if (!self->with_damage || self->n_frames == 0 || cairo_region_is_empty (self->damage)) {
+    cairo_rectangle_int_t rect = { 0, 0, buffer->width, buffer->height };
+
+    damage = cairo_region_create_rectangle (&rect);
+  } else {
+    damage = cairo_region_copy (self->damage);
+  }
+  cairo_region_subtract (self->damage, self->damage);
+  self->n_frames++;
+
+  /* Let the compositor fill the next slot while the consumer handles this one */
+  self->current = (self->current + 1) % RING_SIZE;
+  if (self->running)
+    capture_next (self);
+
+  g_signal_emit (self, signals[FRAME], 0, buffer, damage, flags);
+}
+
+
+static void
+screencopy_frame_handle_failed (void                            *data,
+                                struct zwlr_screencopy_frame_v1 *frame)
+{
+  PhoshScreencast *self = PHOSH_SCREENCAST (data);
+
+  g_warning ("Failed to capture output '%s'", self->monitor ? self->monitor->name : "<unknown>");
+  clear_frame (self);
+  set_running (self, FALSE);
+}
+
+
+static void
+screencopy_frame_handle_damage (void                            *data,
+                                struct zwlr_screencopy_frame_v1 *frame,
+                                uint32_t                         x,
+                                uint32_t                         y,
+                                uint32_t                         width,
+                                uint32_t                         height)
+{
+  PhoshScreencast *self = PHOSH_SCREENCAST (data);
+  cairo_rectangle_int_t rect = { x, y, width, height };
+
+  cairo_region_union_rectangle (self->damage, &rect);
+}
+
+
+static void
+screencopy_frame_handle_linux_dmabuf (void                            *data,
+                                      struct zwlr_screencopy_frame_v1 *frame,
+                                      uint32_t                         fourcc,
+                                      uint32_t                         width,
+                                      uint32_t                         height)
+{
+  /* We only use shm buffers */
+}
+
+
+static void
+screencopy_frame_handle_buffer_done (void                            *data,
+                                     struct zwlr_screencopy_frame_v1 *frame)
+{
+  PhoshScreencast *self = PHOSH_SCREENCAST (data);
+
+  if (!self->shm.offered) {
+    g_warning ("No supported buffer type offered for '%s'", self->monitor->name);
+    clear_frame (self);
+    set_running (self, FALSE);
+    return;
+  }
+
+  copy_frame (self);
+}
+
+
+static const struct zwlr_screencopy_frame_v1_listener screencopy_frame_listener = {
+  .buffer = screencopy_frame_handle_buffer,
+  .flags = screencopy_frame_handle_flags,
+  .ready = screencopy_frame_handle_ready,
+  .failed = screencopy_frame_handle_failed,
+  .damage = screencopy_frame_handle_damage,
+  .linux_dmabuf = screencopy_frame_handle_linux_dmabuf,
+  .buffer_done = screencopy_frame_handle_buffer_done,
+};
+
+
+static void
+capture_next (PhoshScreencast *self)
+{
+  struct zwlr_screencopy_manager_v1 *wl_scm;
+
+  g_return_if_fail (self->frame == NULL);
+
+  if (self->monitor == NULL) {
+    g_warning ("Output went away during screencast");
+    set_running (self, FALSE);
+    return;
+  }
+
+  wl_scm = phosh_wayland_get_zwlr_screencopy_manager_v1 (phosh_wayland_get_default ());
+  self->frame = zwlr_screencopy_manager_v1_capture_output (wl_scm,
+                                                           self->include_cursor,
+                                                           self->monitor->wl_output);
+  zwlr_screencopy_frame_v1_add_listener (self->frame, &screencopy_frame_listener, self);
+}
+
+
+static void
+phosh_screencast_set_property (GObject      *object,
+                               guint         property_id,
+                               const GValue *value,
+                               GParamSpec   *pspec)
+{
+  PhoshScreencast *self = PHOSH_SCREENCAST (object);
+
+  switch (property_id) {
+  case PROP_MONITOR:
+    self->monitor = g_value_get_object (value);
+    if (self->monitor)
+      g_object_add_weak_pointer (G_OBJECT (self->monitor), (gpointer)&self->monitor);
+    break;
+  case PROP_INCLUDE_CURSOR:
+    self->include_cursor = !!g_value_get_boolean (value);
+    break;
+  default:
+    G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    break;
+  }
+}
+
+
+static void
+phosh_screencast_get_property (GObject    *object,
+                               guint       property_id,
+                               GValue     *value,
+                               GParamSpec *pspec)
+{
+  PhoshScreencast *self = PHOSH_SCREENCAST (object);
+
+  switch (property_id) {
+  case PROP_MONITOR:
+    g_value_set_object (value, self->monitor);
+    break;
+  case PROP_INCLUDE_CURSOR:
+    g_value_set_boolean (value, self->include_cursor);
+    break;
+  case PROP_RUNNING:
+    g_value_set_boolean (value, self->running);
+    break;
+  default:
+    G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    break;
+  }
+}
+
+
+static void
+phosh_screencast_dispose (GObject *object)
+{
+  PhoshScreencast *self = PHOSH_SCREENCAST (object);
+
+  clear_frame (self);
+  self->running = FALSE;
+
+  for (int i = 0; i < RING_SIZE; i++)
+    g_clear_pointer (&self->ring[i], phosh_wl_buffer_destroy);
+
+  if (self->monitor) {
+    g_object_remove_weak_pointer (G_OBJECT (self->monitor), (gpointer)&self->monitor);
+    self->monitor = NULL;
+  }
+
+  G_OBJECT_CLASS (phosh_screencast_parent_class)->dispose (object);
+}
+
+
+static void
+phosh_screencast_finalize (GObject *object)
+{
+  PhoshScreencast *self = PHOSH_SCREENCAST (object);
+
+  cairo_region_destroy (self->damage);
+
+  G_OBJECT_CLASS (phosh_screencast_parent_class)->finalize (object);
+}
+
+
+static void
+phosh_screencast_class_init (PhoshScreencastClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->get_property = phosh_screencast_get_property;
+  object_class->set_property = phosh_screencast_set_property;
+  object_class->dispose = phosh_screencast_dispose;
+  object_class->finalize = phosh_screencast_finalize;
+
+  /**
+   * PhoshScreencast:monitor:
+   *
+   * The monitor to capture
+   */
+  props[PROP_MONITOR] =
+    g_param_spec_object ("monitor", "", "",
+                         PHOSH_TYPE_MONITOR,
+                         G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+  /**
+   * PhoshScreencast:include-cursor:
+   *
+   * Whether the cursor is part of the captured frames
+   */
+  props[PROP_INCLUDE_CURSOR] =
+    g_param_spec_boolean ("include-cursor", "", "",
+                          FALSE,
+                          G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+  /**
+   * PhoshScreencast:running:
+   *
+   * Whether frames are currently being captured
+   */
+  props[PROP_RUNNING] =
+    g_param_spec_boolean ("running", "", "",
+                          FALSE,
+                          G_PARAM_READABLE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties (object_class, PROP_LAST_PROP, props);
+
+  /**
+   * PhoshScreencast::frame:
+   * @self: The screencast
+   * @buffer: The buffer holding the frame's pixels
+   * @damage: The region that changed since the previous frame
+   * @flags: The frame's `zwlr_screencopy_frame_v1_flags`
+   *
+   * Emitted for each captured frame. The buffer is owned by the
+   * screencast and only valid during signal emission, consumers need
+   * to copy out what they need.
+   */
+  signals[FRAME] = g_signal_new ("frame",
+                                 G_TYPE_FROM_CLASS (klass),
+                                 G_SIGNAL_RUN_LAST,
+                                 0, NULL, NULL, NULL,
+                                 G_TYPE_NONE,
+                                 3,
+                                 G_TYPE_POINTER,
+                                 G_TYPE_POINTER,
+                                 G_TYPE_UINT);
+}
+
+
+static void
+phosh_screencast_init (PhoshScreencast *self)
+{
+  self->damage = cairo_region_create ();
+}
+
+
+PhoshScreencast *
+phosh_screencast_new (PhoshMonitor *monitor, gboolean include_cursor)
+{
+  return g_object_new (PHOSH_TYPE_SCREENCAST,
+                       "monitor", monitor,
+                       "include-cursor", include_cursor,
+                       NULL);
+}
+
+/**
+ * phosh_screencast_start:
+ * @self: The screencast
+ *
+ * Start capturing frames.
+ *
+ * Returns: %TRUE if capturing was started or is already running
+ */
+gboolean
+phosh_screencast_start (PhoshScreencast *self)
+{
+  g_return_val_if_fail (PHOSH_IS_SCREENCAST (self), FALSE);
+
+  if (self->running)
+    return TRUE;
+
+  if (phosh_wayland_get_zwlr_screencopy_manager_v1 (phosh_wayland_get_default ()) == NULL) {
+    g_debug ("No screencopy support");
+    return FALSE;
+  }
+
+  if (self->monitor == NULL)
+    return FALSE;
+
+  set_running (self, TRUE);
+  capture_next (self);
+
+  return self->running;
+}
+
+/**
+ * phosh_screencast_stop:
+ * @self: The screencast
+ *
+ * Stop capturing frames. The buffers are kept around so capturing can
+ * be resumed cheaply.
+ */
+void
+phosh_screencast_stop (PhoshScreencast *self)
+{
+  g_return_if_fail (PHOSH_IS_SCREENCAST (self));
+
+  clear_frame (self);
+  cairo_region_subtract (self->damage, self->damage);
+  self->n_frames = 0;
+  set_running (self, FALSE);
+}
+
+
+gboolean
+phosh_screencast_get_running (PhoshScreencast *self)
+{
+  g_return_val_if_fail (PHOSH_IS_SCREENCAST (self), FALSE);
+
+  return self->running;
+}
+
+/**
+ * phosh_screencast_get_monitor:
+ * @self: The screencast
+ *
+ * Returns: (transfer none)(nullable): The captured monitor
+ */
+PhoshMonitor *
+phosh_screencast_get_monitor (PhoshScreencast *self)
+{
+  g_return_val_if_fail (PHOSH_IS_SCREENCAST (self), NULL);
+
+  return self->monitor;
+}
+
+
+gboolean
+phosh_screencast_get_include_cursor (PhoshScreencast *self)
+{
+  g_return_val_if_fail (PHOSH_IS_SCREENCAST (self), FALSE);
+
+  return self->include_cursor;
+}
+
+/**
+ * phosh_screencast_get_n_frames:
+ * @self: The screencast
+ *
+ * Returns: The number of frames captured since the screencast was started
+ */
+guint64
+phosh_screencast_get_n_frames (PhoshScreencast *self)
+{
+  g_return_val_if_fail (PHOSH_IS_SCREENCAST (self), 0);
+
+  return self->n_frames;
+}
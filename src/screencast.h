@@ -0,0 +1,28 @@
+/*
+ * Copyright (C) 2026 Phosh.mobi e.V.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include "monitor/monitor.h"
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+#define PHOSH_TYPE_SCREENCAST (phosh_screencast_get_type ())
+
+G_DECLARE_FINAL_TYPE (PhoshScreencast, phosh_screencast, PHOSH, SCREENCAST, GObject)
+
+PhoshScreencast *phosh_screencast_new                (PhoshMonitor    *monitor,
+                                                      gboolean         include_cursor);
+gboolean         phosh_screencast_start              (PhoshScreencast *self);
+void             phosh_screencast_stop               (PhoshScreencast *self);
+gboolean         phosh_screencast_get_running        (PhoshScreencast *self);
+PhoshMonitor    *phosh_screencast_get_monitor        (PhoshScreencast *self);
+gboolean         phosh_screencast_get_include_cursor (PhoshScreencast *self);
+guint64          phosh_screencast_get_n_frames       (PhoshScreencast *self);
+
+G_END_DECLS
@@ -0,0 +1,20 @@
+/*
+ * Copyright (C) 2026 Phosh.mobi e.V.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include "monitor/monitor.h"
+#include "screencast.h"
+#include "screenshot-manager.h"
+
+G_BEGIN_DECLS
+
+PhoshScreencast *phosh_screenshot_manager_start_screencast (PhoshScreenshotManager *self,
+                                                            PhoshMonitor           *monitor,
+                                                            gboolean                include_cursor);
+void             phosh_screenshot_manager_stop_screencast  (PhoshScreenshotManager *self);
+
+G_END_DECLS
@@ -10,11 +10,14 @@
 #define G_LOG_DOMAIN "phosh-screenshot-manager"
 
 #include "phosh-config.h"
+#include "area-selector.h"
 #include "fader.h"
 #include "phosh-wayland.h"
 #include "notifications/notify-manager.h"
-#include "screenshot-manager.h"
+#include "screencast.h"
+#include "screenshot-manager-priv.h"
 #include "shell-priv.h"
+#include "trace.h"
 #include "util.h"
 #include "wl-buffer.h"
 
@@ -22,7 +25,6 @@
 
 #include <gmobile.h>
 
-#include <gio/gunixinputstream.h>
 
 #define BUS_NAME "org.gnome.Shell.Screenshot"
 #define OBJECT_PATH "/org/gnome/Shell/Screenshot"
@@ -30,6 +32,9 @@
 #define KEYBINDINGS_SCHEMA_ID "org.gnome.shell.keybindings"
 #define KEYBINDING_KEY_SCREENSHOT "screenshot"
 
+#define SCREENSHOT_SCHEMA_ID "mobi.phosh.shell.screenshot"
+#define SCREENSHOT_KEY_FAST_COMPRESSION "fast-compression"
+
 #define FLASH_FADER_TIMEOUT 500
 
 /**
@@ -53,9 +58,23 @@ typedef enum {
 typedef struct _ScreencopyFrame {
   struct zwlr_screencopy_frame_v1 *frame;
   uint32_t                         flags;
+  /* Buffer types offered by the compositor */
+  struct {
+    gboolean                       offered;
+    enum wl_shm_format             format;
+    uint32_t                       width, height, stride;
+  } shm;
+  struct {
+    gboolean                       offered;
+    uint32_t                       fourcc;
+    uint32_t                       width, height;
+  } dmabuf;
   PhoshWlBuffer                   *buffer;
-  GdkPixbuf                       *pixbuf;
+  /* Wraps the buffer's data */
+  cairo_surface_t                 *surface;
   PhoshMonitor                    *monitor;
+  /* The captured part of the monitor in the global logical space */
+  GdkRectangle                     region;
   ScreencopyFrameState             state;
   PhoshScreenshotManager          *manager;
 } ScreencopyFrame;
@@ -72,14 +91,10 @@ typedef struct {
 } ScreencopyFrames;
 
 typedef struct {
-  guint                   child_watch_id;
-  GPid                    pid;
   GDBusMethodInvocation  *invocation;
-  GInputStream           *stdout_;
-  GCancellable           *cancel;
-  char                    read_buf[64];
-  GString                *response;
-} SlurpArea;
+  /* One selector per output */
+  GPtrArray              *selectors;
+} SelectArea;
 
 
 typedef struct _PhoshScreenshotManager {
@@ -88,19 +103,22 @@ typedef struct _PhoshScreenshotManager {
   int                                dbus_name_id;
   struct zwlr_screencopy_manager_v1 *wl_scm;
   ScreencopyFrames                  *frames;
-  SlurpArea                         *slurp;
+  SelectArea                        *select_area;
 
   PhoshFader                        *fader;
   guint                              fader_id;
   PhoshFader                        *opaque;
   guint                              opaque_id;
 
-  GdkPixbuf                         *for_clipboard;
+  GBytes                            *for_clipboard;
 
   GStrv                              action_names;
   GSettings                         *settings;
+  GSettings                         *screenshot_settings;
 
   GCancellable                      *cancel;
+
+  PhoshScreencast                   *screencast;
 } PhoshScreenshotManager;
 
 
@@ -113,24 +131,19 @@ G_DEFINE_TYPE_WITH_CODE (PhoshScreenshotManager,
 
 
 static void
-slurp_area_dispose (SlurpArea *slurp)
+select_area_dispose (SelectArea *select_area)
 {
-  if (slurp->response) {
-    g_string_free (slurp->response, TRUE);
-    slurp->response = NULL;
-  }
-  g_cancellable_cancel (slurp->cancel);
-  g_clear_object (&slurp->cancel);
-  g_clear_object (&slurp->stdout_);
+  g_clear_pointer (&select_area->selectors, g_ptr_array_unref);
+  g_free (select_area);
 }
 
 
 static void
 screencopy_frame_dispose (ScreencopyFrame *frame)
 {
+  g_clear_pointer (&frame->surface, cairo_surface_destroy);
   g_clear_pointer (&frame->buffer, phosh_wl_buffer_destroy);
   g_clear_pointer (&frame->frame, zwlr_screencopy_frame_v1_destroy);
-  g_clear_object (&frame->pixbuf);
 
   if (frame->monitor) {
     g_object_remove_weak_pointer (G_OBJECT (frame->monitor), (gpointer)&frame->monitor);
@@ -153,6 +166,23 @@ screencopy_frames_dispose (ScreencopyFrames *frames)
 G_DEFINE_AUTOPTR_CLEANUP_FUNC (ScreencopyFrames, screencopy_frames_dispose);
 
 
+static void
+screencopy_frame_copy (ScreencopyFrame *screencopy_frame)
+{
+  g_return_if_fail (screencopy_frame->buffer == NULL);
+
+  /* TODO: Use the dmabuf path once we have consumers that can keep the
+   * frame on the GPU. For now we need CPU access to the pixels anyway. */
+  screencopy_frame->buffer = phosh_wl_buffer_new (screencopy_frame->shm.format,
+                                                  screencopy_frame->shm.width,
+                                                  screencopy_frame->shm.height,
+                                                  screencopy_frame->shm.stride);
+  g_return_if_fail (screencopy_frame->buffer);
+
+  zwlr_screencopy_frame_v1_copy (screencopy_frame->frame, screencopy_frame->buffer->wl_buffer);
+}
+
+
 static void
 screencopy_frame_handle_buffer (void                            *data,
                                 struct zwlr_screencopy_frame_v1 *frame,
@@ -164,10 +194,53 @@ screencopy_frame_handle_buffer (void                            *data,
   ScreencopyFrame *screencopy_frame = data;
 
   g_debug ("Handling buffer %dx%d for %s", width, height, screencopy_frame->monitor->name);
-  screencopy_frame->buffer = phosh_wl_buffer_new (format, width, height, stride);
-  g_return_if_fail (screencopy_frame->buffer);
+  screencopy_frame->shm.offered = TRUE;
+  screencopy_frame->shm.format = format;
+  screencopy_frame->shm.width = width;
+  screencopy_frame->shm.height = height;
+  screencopy_frame->shm.stride = stride;
+
+  /* Older versions don't enumerate buffer types */
+  if (zwlr_screencopy_frame_v1_get_version (frame) <
+      ZWLR_SCREENCOPY_FRAME_V1_BUFFER_DONE_SINCE_VERSION)
+    screencopy_frame_copy (screencopy_frame);
+}
+
+
+static void
+screencopy_frame_handle_linux_dmabuf (void                            *data,
+                                      struct zwlr_screencopy_frame_v1 *frame,
+                                      uint32_t                         fourcc,
+                                      uint32_t                         width,
+                                      uint32_t                         height)
+{
+  ScreencopyFrame *screencopy_frame = data;
+
+  g_debug ("Compositor offers dmabuf %dx%d, format 0x%x for %s",
+           width, height, fourcc, screencopy_frame->monitor->name);
+  screencopy_frame->dmabuf.offered = TRUE;
+  screencopy_frame->dmabuf.fourcc = fourcc;
+  screencopy_frame->dmabuf.width = width;
+  screencopy_frame->dmabuf.height = height;
+}
+
 
-  zwlr_screencopy_frame_v1_copy (frame, screencopy_frame->buffer->wl_buffer);
+static void maybe_screencopy_done (PhoshScreenshotManager *self);
+
+static void
+screencopy_frame_handle_buffer_done (void                            *data,
+                                     struct zwlr_screencopy_frame_v1 *frame)
+{
+  ScreencopyFrame *screencopy_frame = data;
+
+  if (!screencopy_frame->shm.offered) {
+    g_warning ("No supported buffer type offered for '%s'", screencopy_frame->monitor->name);
+    screencopy_frame->state = FRAME_STATE_FAILURE;
+    maybe_screencopy_done (screencopy_frame->manager);
+    return;
+  }
+
+  screencopy_frame_copy (screencopy_frame);
 }
 
 
@@ -256,25 +329,26 @@ screenshot_done (PhoshScreenshotManager *self, gboolean success)
 
 
 static void
-update_recent_files (PhoshScreenshotManager *self)
+update_recent_files (const char *filename)
 {
   g_autofree char *recent = g_build_filename (g_get_user_data_dir (), "recently-used.xbel", NULL);
   g_autofree char *uri = NULL;
   g_autoptr (GBookmarkFile) bookmarks = g_bookmark_file_new ();
   g_autoptr (GError) err = NULL;
 
-  g_return_if_fail (self->frames->filename);
+  g_return_if_fail (filename);
 
   if (!g_bookmark_file_load_from_file (bookmarks, recent, &err)) {
     if (!g_error_matches (err, G_IO_ERROR, G_IO_ERROR_NOT_FOUND)) {
       g_warning ("Failed to open bookarks %s: %s", recent, err->message);
       return;
     }
+    g_clear_error (&err);
   }
 
-  uri = g_filename_to_uri (self->frames->filename, NULL, &err);
+  uri = g_filename_to_uri (filename, NULL, &err);
   if (!uri) {
-    g_warning ("Failed to create bookmark uri for '%s': %s", uri, err->message);
+    g_warning ("Failed to create bookmark uri for '%s': %s", filename, err->message);
     return;
   }
   g_bookmark_file_add_application (bookmarks, uri, "Phosh", "gio open %u");
@@ -309,30 +383,15 @@ phosh_screenshot_manager_build_thumbnail_path (const char *uri)
 }
 
 
-static void
-on_save_thumbnail_ready (GObject      *source_object,
-                         GAsyncResult *res,
-                         gpointer      user_data)
-{
-  gboolean success;
-  g_autoptr (GError) err = NULL;
-
-  success = gdk_pixbuf_save_to_stream_finish (res, &err);
-  if (!success)
-    g_warning ("Failed to save thumbnail: %s", err->message);
-}
-
-
 #define THUMBNAIL_SIZE 128
 
+/* Runs in the screenshot worker thread */
 static void
-phosh_screenshot_manager_save_thumbnail (PhoshScreenshotManager *self,
-                                         const char             *filename,
-                                         GdkPixbuf              *pixbuf)
+phosh_screenshot_manager_save_thumbnail (const char *filename,
+                                         GdkPixbuf  *thumbnail,
+                                         int         width,
+                                         int         height)
 {
-  int width, height;
-  double scale;
-  g_autoptr (GdkPixbuf) scaled = NULL;
   g_autoptr (GFile) file = NULL;
   g_autoptr (GFileOutputStream) stream = NULL;
   g_autoptr (GError) err = NULL;
@@ -360,32 +419,50 @@ phosh_screenshot_manager_save_thumbnail (PhoshScreenshotManager *self,
     return;
   }
 
-  width = gdk_pixbuf_get_width (pixbuf);
-  height = gdk_pixbuf_get_height (pixbuf);
-
-  scale = (double)THUMBNAIL_SIZE / MAX (width, height);
-  scaled = gdk_pixbuf_scale_simple (pixbuf,
-                                    floor (width * scale + 0.5),
-                                    floor (height * scale + 0.5),
-                                    GDK_INTERP_BILINEAR);
-  gdk_pixbuf_copy_options (pixbuf, scaled);
-
   now = g_date_time_new_now_local();
   mtime_str = g_strdup_printf ("%" G_GINT64_FORMAT, (gint64) g_date_time_to_unix (now));
   width_str = g_strdup_printf ("%d", width);
   height_str = g_strdup_printf ("%d", height);
-  gdk_pixbuf_save_to_stream_async (scaled,
-                                   G_OUTPUT_STREAM (stream),
-                                   "png",
-                                   NULL,
-                                   on_save_thumbnail_ready,
-                                   NULL,
-                                   "tEXt::Thumb::Image::Width", width_str,
-                                   "tEXt::Thumb::Image::Height", height_str,
-                                   "tEXt::Thumb::URI", uri,
-                                   "tEXt::Thumb::MTime", mtime_str,
-                                   "tEXt::Software", "Phosh::Shell",
-                                   NULL);
+  if (!gdk_pixbuf_save_to_stream (thumbnail,
+                                  G_OUTPUT_STREAM (stream),
+                                  "png",
+                                  NULL,
+                                  &err,
+                                  "tEXt::Thumb::Image::Width", width_str,
+                                  "tEXt::Thumb::Image::Height", height_str,
+                                  "tEXt::Thumb::URI", uri,
+                                  "tEXt::Thumb::MTime", mtime_str,
+                                  "tEXt::Software", "Phosh::Shell",
+                                  NULL)) {
+    g_warning ("Failed to save thumbnail: %s", err->message);
+    return;
+  }
+
+  if (!g_output_stream_close (G_OUTPUT_STREAM (stream), NULL, &err))
+    g_warning ("Failed to close thumbnail %s: %s", thumbnail_name, err->message);
+}
+
+
+static void
+on_clipboard_get (GtkClipboard     *clipboard,
+                  GtkSelectionData *selection_data,
+                  guint             info,
+                  gpointer          user_data)
+{
+  GBytes *png = user_data;
+
+  gtk_selection_data_set (selection_data,
+                          gdk_atom_intern_static_string ("image/png"),
+                          8,
+                          g_bytes_get_data (png, NULL),
+                          g_bytes_get_size (png));
+}
+
+
+static void
+on_clipboard_clear (GtkClipboard *clipboard, gpointer user_data)
+{
+  g_bytes_unref (user_data);
 }
 
 
@@ -402,20 +479,26 @@ on_opaque_timeout (gpointer data)
   }
 
   clipboard = gtk_clipboard_get_for_display (display, GDK_SELECTION_CLIPBOARD);
-  gtk_clipboard_set_image (clipboard, self->for_clipboard);
+  /* Hand out the already encoded image instead of encoding on each paste */
+  gtk_clipboard_set_with_data (clipboard,
+                               (GtkTargetEntry []) { { (char *)"image/png", 0, 0 } },
+                               1,
+                               on_clipboard_get,
+                               on_clipboard_clear,
+                               g_bytes_ref (self->for_clipboard));
   g_debug ("Updated clipboard");
   self->frames->copy_to_clipboard = FALSE;
   screenshot_done (self, TRUE);
 
  out:
-  g_clear_object (&self->for_clipboard);
+  g_clear_pointer (&self->for_clipboard, g_bytes_unref);
   g_clear_pointer (&self->opaque, phosh_cp_widget_destroy);
   self->opaque_id = 0;
 }
 
 
 static void
-copy_to_clipboard (PhoshScreenshotManager *self, GdkPixbuf *pixbuf)
+copy_to_clipboard (PhoshScreenshotManager *self, GBytes *png)
 {
   PhoshMonitor *monitor = phosh_shell_get_primary_monitor (phosh_shell_get_default ());
 
@@ -425,7 +508,7 @@ copy_to_clipboard (PhoshScreenshotManager *self, GdkPixbuf *pixbuf)
                                "style-class", "phosh-fader-screenshot-opaque",
                                "kbd-interactivity", TRUE,
                                NULL);
-  self->for_clipboard = g_object_ref (pixbuf);
+  self->for_clipboard = g_bytes_ref (png);
   /* FIXME: Would be better to trigger when the opaque window is up and got
      input focus but all such attempts failed */
   self->opaque_id = g_timeout_add_seconds_once (1, on_opaque_timeout, self);
@@ -435,39 +518,6 @@ copy_to_clipboard (PhoshScreenshotManager *self, GdkPixbuf *pixbuf)
 }
 
 
-static void
-on_save_pixbuf_ready (GObject      *source_object,
-                      GAsyncResult *res,
-                      gpointer      user_data)
-{
-  gboolean success;
-  g_autoptr (GError) err = NULL;
-  g_autoptr (PhoshScreenshotManager) self = PHOSH_SCREENSHOT_MANAGER (user_data);
-
-  g_return_if_fail (PHOSH_IS_SCREENSHOT_MANAGER (self));
-  g_return_if_fail (self->frames->filename);
-
-  success = gdk_pixbuf_save_to_stream_finish (res, &err);
-  if (!success) {
-    g_warning ("Failed to save screenshot: %s", err->message);
-    screenshot_done (self, FALSE);
-    return;
-  }
-
-  if (!self->frames->invocation)
-    update_recent_files (self);
-
-  phosh_screenshot_manager_save_thumbnail (self,
-                                           self->frames->filename,
-                                           GDK_PIXBUF (source_object));
-
-  if (self->frames->copy_to_clipboard)
-    copy_to_clipboard (self, GDK_PIXBUF (source_object));
-  else
-    screenshot_done (self, success);
-}
-
-
 /* Taken from grim */
 static GdkRectangle
 get_output_layout (PhoshScreenshotManager *self)
@@ -524,17 +574,18 @@ get_angle (PhoshMonitorTransform transform)
 
 /**
  * create_internal_file:
- * @self: The screenshot manager
+ * @filename: (out): Return location for the created file's name
  * @err: An error location
  *
  * Create a file for saving the screenshot. This is used when the the
  * shell takes the screenshot e.g. via keybinding. See
- * `build_dbus_filename` for the DBus case.
+ * `build_dbus_filename` for the DBus case. Runs in the screenshot
+ * worker thread.
  *
  * Returns: An output stream that writes to the created file
  */
 static GFileOutputStream *
-create_internal_file (PhoshScreenshotManager *self, GError **err)
+create_internal_file (char **filename, GError **err)
 
 {
   g_autoptr (GFile) dir = NULL;
@@ -543,7 +594,7 @@ create_internal_file (PhoshScreenshotManager *self, GError **err)
   g_autofree char *timestamp = NULL;
   const char *base_dir;
 
-  g_assert (PHOSH_IS_SCREENSHOT_MANAGER (self));
+  g_assert (filename && *filename == NULL);
   g_assert (err && *err == NULL);
 
   base_dir = g_get_user_special_dir (G_USER_DIRECTORY_PICTURES);
@@ -556,6 +607,7 @@ create_internal_file (PhoshScreenshotManager *self, GError **err)
   if (!g_file_make_directory_with_parents (dir, NULL, err)) {
     if (!g_error_matches (*err, G_IO_ERROR, G_IO_ERROR_EXISTS))
       return NULL;
+    g_clear_error (err);
   }
 
   dt = g_date_time_new_now_local ();
@@ -563,7 +615,7 @@ create_internal_file (PhoshScreenshotManager *self, GError **err)
 
   for (int i = 0; i < 100; i++) {
     g_autofree char *suffix = i ? g_strdup_printf ("-%d", i) : g_strdup ("");
-    g_autofree char *filename = NULL;
+    g_autofree char *name = NULL;
     g_autofree char *path = NULL;
     g_autoptr (GFile) file = NULL;
     g_autoptr (GFileOutputStream) stream = NULL;
@@ -571,13 +623,14 @@ create_internal_file (PhoshScreenshotManager *self, GError **err)
     /* Translators: Name of a screenshot file. The first '%s' is a timestamp
      * like "2017-05-21 12-24-03" the 2nd '%s' is a possible suffix in case
      * the file already exists like '-3' */
-    filename = g_strdup_printf (_("Screenshot from %s%s.png"), timestamp, suffix);
-    path = g_build_filename (dirname, filename, NULL);
+    name = g_strdup_printf (_("Screenshot from %s%s.png"), timestamp, suffix);
+    path = g_build_filename (dirname, name, NULL);
     file = g_file_new_for_path (path);
+    g_clear_error (err);
     stream = g_file_create (file, G_FILE_CREATE_NONE, NULL, err);
     if (stream) {
       g_debug ("Saving screenshot to '%s'", path);
-      self->frames->filename = g_strdup (path);
+      *filename = g_steal_pointer (&path);
       return g_steal_pointer (&stream);
     }
   }
@@ -586,113 +639,393 @@ create_internal_file (PhoshScreenshotManager *self, GError **err)
   return NULL;
 }
 
-/* Got all pixbufs, prepare result */
+/* What the worker thread needs to know about a captured output */
+typedef struct {
+  cairo_surface_t *surface;
+  /* The captured region in the global logical space */
+  GdkRectangle     logical;
+  float            scale;
+  guint            angle;
+  uint32_t         flags;
+} ScreenshotOutput;
+
+/* A screenshot to composite and save off the main thread */
+typedef struct {
+  GArray          *outputs;
+  GdkRectangle     target;
+  float            scale;
+  char            *filename;
+  gboolean         internal;
+  gboolean         fast_compression;
+  /* Keep the encoded image, e.g. for the clipboard */
+  gboolean         want_png;
+  gint64           trace_begin;
+} ScreenshotJob;
+
+typedef struct {
+  GBytes          *png;
+  char            *filename;
+} ScreenshotResult;
+
+
 static void
-submit_screenshot (PhoshScreenshotManager *self)
+screenshot_output_clear (ScreenshotOutput *output)
 {
-  g_autoptr (GError) err = NULL;
-  g_autoptr (GFileOutputStream) stream = NULL;
-  g_autoptr (GFile) file = NULL;
-  g_autoptr (GdkPixbuf) pixbuf = NULL;
-  GdkRectangle box;
-  float screenshot_scale = self->frames->max_scale;
+  g_clear_pointer (&output->surface, cairo_surface_destroy);
+}
 
-  box = get_output_layout (self);
-  g_debug ("Screenshot of %d,%d %dx%d", box.x, box.y, box.width, box.height);
 
-  pixbuf = gdk_pixbuf_new (GDK_COLORSPACE_RGB,
-                           TRUE,
-                           8,
-                           box.width * screenshot_scale,
-                           box.height * screenshot_scale);
+static void
+screenshot_job_free (ScreenshotJob *job)
+{
+  g_clear_pointer (&job->outputs, g_array_unref);
+  g_free (job->filename);
+  g_free (job);
+}
+
 
-  /* TODO: Using cairo would avoid lots of copies */
-  for (GList *l = self->frames->frames; l; l = l->next) {
-    ScreencopyFrame *frame = l->data;
-    float scale;
-    /* how much this monitor gets enlarged based on its scale, >= 1.0 */
-    double zoom;
-    g_autoptr (GdkPixbuf) transformed = NULL;
+static void
+screenshot_result_free (ScreenshotResult *result)
+{
+  g_clear_pointer (&result->png, g_bytes_unref);
+  g_free (result->filename);
+  g_free (result);
+}
 
-    if (frame->monitor == NULL)
-      continue;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (ScreenshotResult, screenshot_result_free);
 
-    scale = phosh_monitor_get_fractional_scale (frame->monitor);
-    zoom = screenshot_scale / scale;
-    g_debug ("Screenshot of '%s' of %d,%d %dx%d, scale: %f",
-             frame->monitor->name,
-             frame->monitor->logical.x - box.x,
-             frame->monitor->logical.y - box.y,
-             frame->monitor->logical.width,
-             frame->monitor->logical.height,
-             scale);
-
-    /* TODO: handle flips */
-    transformed = gdk_pixbuf_rotate_simple (frame->pixbuf,
-                                            get_angle (frame->monitor->transform));
-    gdk_pixbuf_composite (transformed,
-                          pixbuf,
-                          (frame->monitor->logical.x - box.x) * screenshot_scale,
-                          (frame->monitor->logical.y - box.y) * screenshot_scale,
-                          frame->monitor->logical.width * screenshot_scale,
-                          frame->monitor->logical.height * screenshot_scale,
-                          (frame->monitor->logical.x - box.x) * screenshot_scale,
-                          (frame->monitor->logical.y - box.y) * screenshot_scale,
-                          zoom, zoom,
-                          GDK_INTERP_BILINEAR,
-                          255);
+/*
+ * Transform the coordinate system so the output's image (in buffer
+ * coordinates) ends up upright at the origin.
+ */
+static void
+apply_output_transform (cairo_t *cr, ScreenshotOutput *output)
+{
+  int width = cairo_image_surface_get_width (output->surface);
+  int height = cairo_image_surface_get_height (output->surface);
+
+  /* TODO: handle flips */
+  switch (output->angle) {
+  case 90:
+    cairo_translate (cr, 0, width);
+    cairo_rotate (cr, -G_PI_2);
+    break;
+  case 180:
+    cairo_translate (cr, width, height);
+    cairo_rotate (cr, G_PI);
+    break;
+  case 270:
+    cairo_translate (cr, height, 0);
+    cairo_rotate (cr, G_PI_2);
+    break;
+  case 0:
+  default:
+    break;
   }
 
-  if (self->frames->area) {
-    g_autoptr (GdkPixbuf) tmp = pixbuf;
-
-    pixbuf = gdk_pixbuf_new (GDK_COLORSPACE_RGB,
-                             TRUE,
-                             8,
-                             self->frames->area->width * screenshot_scale,
-                             self->frames->area->height * screenshot_scale);
-    gdk_pixbuf_copy_area (tmp,
-                          (self->frames->area->x - box.x) * screenshot_scale,
-                          (self->frames->area->y - box.y) * screenshot_scale,
-                          self->frames->area->width * screenshot_scale,
-                          self->frames->area->height * screenshot_scale,
-                          pixbuf,
-                          0,
-                          0);
+  if (output->flags & ZWLR_SCREENCOPY_FRAME_V1_FLAGS_Y_INVERT) {
+    cairo_translate (cr, 0, height);
+    cairo_scale (cr, 1, -1);
   }
+}
 
-  if (self->frames->filename) {
-    file = g_file_new_for_path (self->frames->filename);
-    stream = g_file_create (file, G_FILE_CREATE_NONE, NULL, &err);
+
+/* Paint all outputs onto a surface covering the job's target at `scale` */
+static cairo_surface_t *
+screenshot_job_paint (ScreenshotJob *job, double scale, cairo_filter_t filter)
+{
+  cairo_surface_t *surface;
+  cairo_t *cr;
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
+                                        MAX (1, job->target.width * scale),
+                                        MAX (1, job->target.height * scale));
+  cr = cairo_create (surface);
+
+  for (guint i = 0; i < job->outputs->len; i++) {
+    ScreenshotOutput *output = &g_array_index (job->outputs, ScreenshotOutput, i);
+    /* how much this monitor gets scaled based on its scale */
+    double zoom = scale / output->scale;
+
+    cairo_save (cr);
+    cairo_translate (cr,
+                     (output->logical.x - job->target.x) * scale,
+                     (output->logical.y - job->target.y) * scale);
+    cairo_rectangle (cr,
+                     0, 0,
+                     output->logical.width * scale,
+                     output->logical.height * scale);
+    cairo_clip (cr);
+    cairo_scale (cr, zoom, zoom);
+    apply_output_transform (cr, output);
+    cairo_set_source_surface (cr, output->surface, 0, 0);
+    cairo_pattern_set_filter (cairo_get_source (cr), filter);
+    cairo_paint (cr);
+    cairo_restore (cr);
+  }
+  cairo_destroy (cr);
+
+  return surface;
+}
+
+/*
+ * Turn the surface into a pixbuf by converting its pixels in place
+ * (premultiplied native endian ARGB to RGBA) so we don't need a
+ * second full size copy. Takes ownership of the surface.
+ */
+static GdkPixbuf *
+pixbuf_new_from_surface_in_place (cairo_surface_t *surface)
+{
+  int width = cairo_image_surface_get_width (surface);
+  int height = cairo_image_surface_get_height (surface);
+  int stride = cairo_image_surface_get_stride (surface);
+  guchar *data;
+
+  cairo_surface_flush (surface);
+  data = cairo_image_surface_get_data (surface);
+
+  for (int y = 0; y < height; y++) {
+    guchar *row = data + (gsize)y * stride;
+
+    for (int x = 0; x < width; x++) {
+      guint32 pixel = ((guint32 *)row)[x];
+      guint8 alpha = pixel >> 24;
+      guchar *dst = row + x * 4;
+
+      if (alpha == 0) {
+        dst[0] = dst[1] = dst[2] = dst[3] = 0;
+        continue;
+      }
+
+      dst[0] = (((pixel >> 16) & 0xff) * 255 + alpha / 2) / alpha;
+      dst[1] = (((pixel >> 8) & 0xff) * 255 + alpha / 2) / alpha;
+      dst[2] = ((pixel & 0xff) * 255 + alpha / 2) / alpha;
+      dst[3] = alpha;
+    }
+  }
+  cairo_surface_mark_dirty (surface);
+
+  return gdk_pixbuf_new_from_data (data, GDK_COLORSPACE_RGB, TRUE, 8,
+                                   width, height, stride,
+                                   (GdkPixbufDestroyNotify) cairo_surface_destroy,
+                                   surface);
+}
+
+
+static GdkPixbuf *
+screenshot_job_composite (ScreenshotJob *job, GdkPixbuf **thumbnail)
+{
+  cairo_surface_t *surface;
+
+  /* Render area screenshots directly instead of cropping afterwards */
+  surface = screenshot_job_paint (job, job->scale, CAIRO_FILTER_BILINEAR);
+
+  /* Render the thumbnail from the captured outputs too instead of scaling the result */
+  if (thumbnail) {
+    int width = cairo_image_surface_get_width (surface);
+    int height = cairo_image_surface_get_height (surface);
+    double scale = job->scale * MIN (1.0, (double)THUMBNAIL_SIZE / MAX (width, height));
+
+    *thumbnail = pixbuf_new_from_surface_in_place (screenshot_job_paint (job,
+                                                                         scale,
+                                                                         CAIRO_FILTER_GOOD));
+  }
+
+  /* GdkPixbuf is needed for saving and the clipboard */
+  return pixbuf_new_from_surface_in_place (surface);
+}
+
+
+static void
+screenshot_job_run (GTask        *task,
+                    gpointer      source_object,
+                    gpointer      task_data,
+                    GCancellable *cancel)
+{
+  ScreenshotJob *job = task_data;
+  g_autoptr (GdkPixbuf) pixbuf = NULL;
+  g_autoptr (GdkPixbuf) thumbnail = NULL;
+  g_autoptr (GFileOutputStream) stream = NULL;
+  g_autoptr (ScreenshotResult) result = g_new0 (ScreenshotResult, 1);
+  gboolean save = job->filename || job->internal;
+  const char *keys[] = { "compression", NULL };
+  const char *values[] = { "1", NULL };
+  int width, height;
+  GError *err = NULL;
+
+  pixbuf = screenshot_job_composite (job, save ? &thumbnail : NULL);
+  width = gdk_pixbuf_get_width (pixbuf);
+  height = gdk_pixbuf_get_height (pixbuf);
+
+  /* Encode only once and use the result for the file too */
+  if (job->want_png) {
+    char *buffer;
+    gsize size;
+
+    if (!gdk_pixbuf_save_to_bufferv (pixbuf,
+                                     &buffer,
+                                     &size,
+                                     "png",
+                                     job->fast_compression ? (char **)keys : NULL,
+                                     job->fast_compression ? (char **)values : NULL,
+                                     &err)) {
+      g_prefix_error (&err, "Failed to encode screenshot: ");
+      g_task_return_error (task, err);
+      return;
+    }
+    result->png = g_bytes_new_take (buffer, size);
+    g_clear_object (&pixbuf);
+  }
+
+  if (job->filename) {
+    g_autoptr (GFile) file = g_file_new_for_path (job->filename);
+
+    stream = g_file_create (file, G_FILE_CREATE_NONE, cancel, &err);
     if (!stream) {
-      g_warning ("Failed to create screenshot %s: %s", self->frames->filename, err->message);
-      screenshot_done (self, FALSE);
+      g_prefix_error (&err, "Failed to create screenshot %s: ", job->filename);
+      g_task_return_error (task, err);
       return;
     }
-  } else if (!self->frames->invocation) {
+    result->filename = g_strdup (job->filename);
+  } else if (job->internal) {
     /* Generate filename for internal screenshot */
-    stream = create_internal_file (self, &err);
+    stream = create_internal_file (&result->filename, &err);
     if (!stream) {
-      g_warning ("Failed to create screenshot: %s", err->message);
-      screenshot_done (self, FALSE);
+      g_prefix_error (&err, "Failed to create screenshot: ");
+      g_task_return_error (task, err);
       return;
     }
   }
 
   if (stream) {
-    /* on_save_to_pixbuf will trigger copy_to_clipboard if needed */
-    gdk_pixbuf_save_to_stream_async (pixbuf,
-                                     G_OUTPUT_STREAM (stream),
-                                     "png",
-                                     self->cancel,
-                                     on_save_pixbuf_ready,
-                                     g_object_ref (self),
-                                     NULL);
-  } else if (self->frames->copy_to_clipboard) {
-    /* Copy to clipboard only */
-    copy_to_clipboard (self, pixbuf);
+    gboolean success;
+
+    if (result->png) {
+      success = g_output_stream_write_all (G_OUTPUT_STREAM (stream),
+                                           g_bytes_get_data (result->png, NULL),
+                                           g_bytes_get_size (result->png),
+                                           NULL,
+                                           cancel,
+                                           &err);
+    } else {
+      success = gdk_pixbuf_save_to_streamv (pixbuf,
+                                            G_OUTPUT_STREAM (stream),
+                                            "png",
+                                            job->fast_compression ? (char **)keys : NULL,
+                                            job->fast_compression ? (char **)values : NULL,
+                                            cancel,
+                                            &err);
+    }
+
+    if (!success || !g_output_stream_close (G_OUTPUT_STREAM (stream), cancel, &err)) {
+      g_prefix_error (&err, "Failed to save screenshot: ");
+      g_task_return_error (task, err);
+      return;
+    }
+
+    /* Drop the full frame as early as possible */
+    g_clear_object (&pixbuf);
+
+    if (job->internal)
+      update_recent_files (result->filename);
+
+    phosh_screenshot_manager_save_thumbnail (result->filename, thumbnail, width, height);
+  }
+
+  g_task_return_pointer (task, g_steal_pointer (&result), (GDestroyNotify) screenshot_result_free);
+}
+
+
+static void
+on_screenshot_job_ready (GObject      *source_object,
+                         GAsyncResult *res,
+                         gpointer      user_data)
+{
+  PhoshScreenshotManager *self = PHOSH_SCREENSHOT_MANAGER (source_object);
+  ScreenshotJob *job = g_task_get_task_data (G_TASK (res));
+  g_autoptr (ScreenshotResult) result = NULL;
+  g_autoptr (GError) err = NULL;
+
+  result = g_task_propagate_pointer (G_TASK (res), &err);
+  PHOSH_TRACE_MARK (job->trace_begin, "screenshot-manager: submit", "%ux%u, %s",
+                    job->target.width, job->target.height,
+                    result ? "done" : "failed");
+  if (!result) {
+    if (g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+      return;
+
+    g_warning ("%s", err->message);
+    screenshot_done (self, FALSE);
+    return;
   }
 
+  /* Pixels are composited, release the screencopy buffers early */
+  g_clear_list (&self->frames->frames, (GDestroyNotify) screencopy_frame_dispose);
+
+  if (self->frames->filename == NULL)
+    self->frames->filename = g_steal_pointer (&result->filename);
+
+  if (self->frames->copy_to_clipboard)
+    copy_to_clipboard (self, result->png);
+  else
+    screenshot_done (self, TRUE);
+}
+
+/* Got all frames, composite and save them in a worker thread */
+static void
+submit_screenshot (PhoshScreenshotManager *self)
+{
+  g_autoptr (GTask) task = NULL;
+  ScreenshotJob *job;
+  GdkRectangle box;
+
+  box = get_output_layout (self);
+  g_debug ("Screenshot of %d,%d %dx%d", box.x, box.y, box.width, box.height);
+
+  job = g_new0 (ScreenshotJob, 1);
+  job->trace_begin = PHOSH_TRACE_CURRENT_TIME;
+  job->target = self->frames->area ? *self->frames->area : box;
+  job->scale = self->frames->max_scale;
+  job->filename = g_strdup (self->frames->filename);
+  job->internal = !self->frames->filename && !self->frames->invocation;
+  job->fast_compression = g_settings_get_boolean (self->screenshot_settings,
+                                                  SCREENSHOT_KEY_FAST_COMPRESSION);
+  job->want_png = self->frames->copy_to_clipboard;
+  job->outputs = g_array_new (FALSE, TRUE, sizeof (ScreenshotOutput));
+  g_array_set_clear_func (job->outputs, (GDestroyNotify) screenshot_output_clear);
+
+  /* Snapshot everything the worker needs, it must not touch monitors */
+  for (GList *l = self->frames->frames; l; l = l->next) {
+    ScreencopyFrame *frame = l->data;
+    ScreenshotOutput output;
+
+    if (frame->monitor == NULL)
+      continue;
+
+    output = (ScreenshotOutput) {
+      .surface = cairo_surface_reference (frame->surface),
+      .logical = frame->region,
+      .scale = phosh_monitor_get_fractional_scale (frame->monitor),
+      .angle = get_angle (frame->monitor->transform),
+      .flags = frame->flags,
+    };
+    g_debug ("Screenshot of '%s' region %d,%d %dx%d, scale: %f",
+             frame->monitor->name,
+             output.logical.x - box.x,
+             output.logical.y - box.y,
+             output.logical.width,
+             output.logical.height,
+             output.scale);
+    g_array_append_val (job->outputs, output);
+  }
+
+  /* The frames (and hence the buffers backing the surfaces) stay
+   * alive until on_screenshot_job_ready */
+  task = g_task_new (self, self->cancel, on_screenshot_job_ready, NULL);
+  g_task_set_source_tag (task, submit_screenshot);
+  g_task_set_task_data (task, job, (GDestroyNotify) screenshot_job_free);
+  g_task_run_in_thread (task, screenshot_job_run);
+
   if (self->frames->flash) {
     phosh_trigger_feedback ("screen-capture");
     show_fader (self);
@@ -748,8 +1081,7 @@ screencopy_frame_handle_ready (void                            *data,
                                uint32_t                         tv_nsec)
 {
   ScreencopyFrame *screencopy_frame = data;
-  g_autoptr (GdkPixbuf) pixbuf = NULL;
-  g_autoptr (GBytes) bytes = NULL;
+  cairo_format_t cairo_format;
 
   if (screencopy_frame->monitor == NULL) {
     g_warning ("Output went away during screenshot");
@@ -766,11 +1098,14 @@ screencopy_frame_handle_ready (void                            *data,
            screencopy_frame->monitor->name);
 
   switch ((uint32_t) screencopy_frame->buffer->format) {
-  case WL_SHM_FORMAT_ABGR8888:
-  case WL_SHM_FORMAT_XBGR8888:
-    break;
   case WL_SHM_FORMAT_ARGB8888:
-  case WL_SHM_FORMAT_XRGB8888: { /* ARGB -> ABGR */
+    cairo_format = CAIRO_FORMAT_ARGB32;
+    break;
+  case WL_SHM_FORMAT_XRGB8888:
+    cairo_format = CAIRO_FORMAT_RGB24;
+    break;
+  case WL_SHM_FORMAT_ABGR8888:
+  case WL_SHM_FORMAT_XBGR8888: { /* ABGR -> ARGB, in place */
     PhoshWlBuffer *buffer = screencopy_frame->buffer;
     uint8_t *d = buffer->data;
     for (int i = 0; i < buffer->height; ++i) {
@@ -783,10 +1118,13 @@ screencopy_frame_handle_ready (void                            *data,
         *px = (a << 24) | (r << 16) | (g << 8) | b;
       }
     }
-    if (buffer->format == WL_SHM_FORMAT_ARGB8888)
-      buffer->format = WL_SHM_FORMAT_ABGR8888;
-    else
-      buffer->format = WL_SHM_FORMAT_XBGR8888;
+    if (buffer->format == WL_SHM_FORMAT_ABGR8888) {
+      buffer->format = WL_SHM_FORMAT_ARGB8888;
+      cairo_format = CAIRO_FORMAT_ARGB32;
+    } else {
+      buffer->format = WL_SHM_FORMAT_XRGB8888;
+      cairo_format = CAIRO_FORMAT_RGB24;
+    }
   }
   break;
   default:
@@ -797,21 +1135,12 @@ screencopy_frame_handle_ready (void                            *data,
     goto out;
   }
 
-  bytes = phosh_wl_buffer_get_bytes (screencopy_frame->buffer);
-  pixbuf = gdk_pixbuf_new_from_bytes (bytes,
-                                      GDK_COLORSPACE_RGB,
-                                      TRUE,
-                                      8,
-                                      screencopy_frame->buffer->width,
-                                      screencopy_frame->buffer->height,
-                                      screencopy_frame->buffer->stride);
-  if (screencopy_frame->flags & ZWLR_SCREENCOPY_FRAME_V1_FLAGS_Y_INVERT) {
-    GdkPixbuf *tmp = gdk_pixbuf_flip (pixbuf, FALSE);
-    g_object_unref (pixbuf);
-    pixbuf = tmp;
-  }
-
-  screencopy_frame->pixbuf = g_steal_pointer (&pixbuf);
+  /* No copy, the buffer lives as long as the frame */
+  screencopy_frame->surface = cairo_image_surface_create_for_data (screencopy_frame->buffer->data,
+                                                                   cairo_format,
+                                                                   screencopy_frame->buffer->width,
+                                                                   screencopy_frame->buffer->height,
+                                                                   screencopy_frame->buffer->stride);
   screencopy_frame->state = FRAME_STATE_SUCCESS;
 
  out:
@@ -837,6 +1166,8 @@ static const struct zwlr_screencopy_frame_v1_listener screencopy_frame_listener
   .flags = screencopy_frame_handle_flags,
   .ready = screencopy_frame_handle_ready,
   .failed = screencopy_frame_handle_failed,
+  .linux_dmabuf = screencopy_frame_handle_linux_dmabuf,
+  .buffer_done = screencopy_frame_handle_buffer_done,
 };
 
 
@@ -925,29 +1256,39 @@ phosh_screenshot_manager_do_screenshot (PhoshScreenshotManager *self,
   for (int i = 0; i < phosh_monitor_manager_get_num_monitors (monitor_manager); i++) {
     PhoshMonitor *monitor = phosh_monitor_manager_get_monitor (monitor_manager, i);
     ScreencopyFrame *screencopy_frame;
-    GdkRectangle monitor_area;
+    GdkRectangle monitor_area, region;
     float monitor_scale;
 
     if (monitor == NULL)
       continue;
 
+    monitor_area = (GdkRectangle) {
+      .x = monitor->logical.x,
+      .y = monitor->logical.y,
+      .width = monitor->logical.width,
+      .height = monitor->logical.height,
+    };
+    region = monitor_area;
     if (area) {
-      monitor_area = (GdkRectangle) {
-        .x = monitor->logical.x,
-        .y = monitor->logical.y,
-        .width = monitor->logical.width,
-        .height = monitor->logical.height,
-      };
-      if (gdk_rectangle_intersect (area, &monitor_area, NULL) == FALSE)
+      if (gdk_rectangle_intersect (area, &monitor_area, &region) == FALSE)
         continue;
     }
 
     screencopy_frame = g_new0 (ScreencopyFrame, 1);
     screencopy_frame->manager = self;
     screencopy_frame->monitor = monitor;
+    screencopy_frame->region = region;
     g_object_add_weak_pointer (G_OBJECT (monitor), (gpointer)&screencopy_frame->monitor);
-    screencopy_frame->frame = zwlr_screencopy_manager_v1_capture_output (
-      self->wl_scm, include_cursor, monitor->wl_output);
+    if (gdk_rectangle_equal (&region, &monitor_area)) {
+      screencopy_frame->frame = zwlr_screencopy_manager_v1_capture_output (
+        self->wl_scm, include_cursor, monitor->wl_output);
+    } else {
+      /* Only read back the part of the output we need */
+      screencopy_frame->frame = zwlr_screencopy_manager_v1_capture_output_region (
+        self->wl_scm, include_cursor, monitor->wl_output,
+        region.x - monitor_area.x, region.y - monitor_area.y,
+        region.width, region.height);
+    }
     zwlr_screencopy_frame_v1_add_listener (screencopy_frame->frame, &screencopy_frame_listener,
                                            screencopy_frame);
     frames->frames = g_list_prepend (frames->frames, screencopy_frame);
@@ -1038,99 +1379,27 @@ handle_screenshot (PhoshDBusScreenshot   *object,
 
 
 /* Taken from grim */
-static gboolean
-parse_slurp (const char *str, GdkRectangle *box)
-{
-  char *end = NULL;
-  char *next;
-
-  box->x = strtol (str, &end, 10);
-  if (end[0] != ',')
-    return FALSE;
-
-  next = end + 1;
-  box->y = strtol (next, &end, 10);
-  if (end[0] != ' ')
-    return FALSE;
-
-  next = end + 1;
-  box->width = strtol (next, &end, 10);
-  if (end[0] != 'x')
-    return FALSE;
-
-  next = end + 1;
-  box->height = strtol (next, &end, 10);
-  if (end[0] != '\0' && end[0] != '\n')
-    return FALSE;
-
-  return TRUE;
-}
-
-
 static void
-on_slurp_exited (GPid pid, int wait_status, gpointer user_data)
+on_area_selected (PhoshScreenshotManager *self, GdkRectangle *area)
 {
-  PhoshScreenshotManager *self;
-  GdkRectangle box;
-
-  g_return_if_fail (PHOSH_IS_SCREENSHOT_MANAGER (user_data));
-  self = PHOSH_SCREENSHOT_MANAGER (user_data);
-
-  g_return_if_fail (pid == self->slurp->pid);
+  g_return_if_fail (self->select_area);
 
-  g_debug ("Selected area: %s", self->slurp->response->str);
-
-  if (parse_slurp (self->slurp->response->str, &box)) {
-    phosh_dbus_screenshot_complete_select_area (PHOSH_DBUS_SCREENSHOT (self),
-                                                self->slurp->invocation,
-                                                box.x, box.y, box.width, box.height);
-  } else {
-    g_dbus_method_invocation_return_error (self->slurp->invocation, G_DBUS_ERROR,
-                                           G_DBUS_ERROR_FAILED,
-                                           "Area selection failed");
-  }
-
-  g_clear_pointer (&self->slurp, slurp_area_dispose);
+  phosh_dbus_screenshot_complete_select_area (PHOSH_DBUS_SCREENSHOT (self),
+                                              self->select_area->invocation,
+                                              area->x, area->y, area->width, area->height);
+  g_clear_pointer (&self->select_area, select_area_dispose);
 }
 
 
 static void
-on_slurp_read_done (GObject *source_object, GAsyncResult *res, gpointer user_data)
+on_area_selection_cancelled (PhoshScreenshotManager *self)
 {
-  GInputStream *slurp_out = G_INPUT_STREAM (source_object);
-  PhoshScreenshotManager *self = PHOSH_SCREENSHOT_MANAGER (user_data);
-  gssize read_size;
-  g_autoptr (GError) error = NULL;
-
-  read_size = g_input_stream_read_finish (slurp_out, res, &error);
-  switch (read_size) {
-  case -1:
-    if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
-      g_warning ("Slurp cancelled");
-      g_dbus_method_invocation_return_error (self->slurp->invocation, G_DBUS_ERROR,
-                                             G_DBUS_ERROR_FAILED,
-                                             "Area selection cancelled");
-      g_clear_pointer (&self->slurp, slurp_area_dispose);
-      return;
-    }
-    break;
-  case 0:
-    /* Done reading. */
-    self->slurp->child_watch_id = g_child_watch_add (self->slurp->pid, on_slurp_exited, self);
-    break;
-  default:
-    g_string_append_len (self->slurp->response, self->slurp->read_buf, read_size);
-    g_input_stream_read_async (slurp_out,
-                               self->slurp->read_buf,
-                               sizeof(self->slurp->read_buf),
-                               G_PRIORITY_DEFAULT,
-                               NULL,
-                               on_slurp_read_done,
-                               self);
-    return;
-  }
+  g_return_if_fail (self->select_area);
 
-  g_input_stream_close (slurp_out, NULL, NULL);
+  g_dbus_method_invocation_return_error (self->select_area->invocation, G_DBUS_ERROR,
+                                         G_DBUS_ERROR_FAILED,
+                                         "Area selection cancelled");
+  g_clear_pointer (&self->select_area, select_area_dispose);
 }
 
 
@@ -1139,47 +1408,49 @@ handle_select_area (PhoshDBusScreenshot   *object,
                     GDBusMethodInvocation *invocation)
 {
   PhoshScreenshotManager *self = PHOSH_SCREENSHOT_MANAGER (object);
-  const char *cmd[] = { "slurp", NULL };
-  gboolean success;
-  int slurp_stdout_fd;
-  g_autofree SlurpArea *slurp = NULL;
-  g_autoptr (GError) err = NULL;
-  GPid slurp_pid;
+  PhoshMonitorManager *monitor_manager;
+  SelectArea *select_area;
 
   g_debug ("DBus call %s", __func__);
 
-  g_return_val_if_fail (slurp == NULL, FALSE);
-
-  success = g_spawn_async_with_pipes (NULL,
-                                      (char **) cmd,
-                                      NULL, /* envp */
-                                      G_SPAWN_SEARCH_PATH | G_SPAWN_DO_NOT_REAP_CHILD,
-                                      NULL, /* setup-func */
-                                      NULL, /* user_data */
-                                      &slurp_pid,
-                                      NULL,
-                                      &slurp_stdout_fd,
-                                      NULL,
-                                      &err);
-  if (!success) {
-    g_warning ("Failed to spawn slurp: %s", err->message);
-    return FALSE;
+  if (self->select_area) {
+    g_dbus_method_invocation_return_error (invocation, G_DBUS_ERROR,
+                                           G_DBUS_ERROR_FAILED,
+                                           "Area selection already in progress");
+    return TRUE;
   }
 
-  slurp = g_new0 (SlurpArea, 1);
-  slurp->stdout_ = g_unix_input_stream_new (slurp_stdout_fd, TRUE);
-  slurp->invocation = invocation;
-  slurp->pid = slurp_pid;
-  slurp->response = g_string_new (NULL);
-  g_input_stream_read_async (slurp->stdout_,
-                             slurp->read_buf,
-                             sizeof(slurp->read_buf),
-                             G_PRIORITY_DEFAULT,
-                             slurp->cancel,
-                             on_slurp_read_done,
-                             self);
-
-  self->slurp = g_steal_pointer (&slurp);
+  monitor_manager = phosh_shell_get_monitor_manager (phosh_shell_get_default ());
+  select_area = g_new0 (SelectArea, 1);
+  select_area->invocation = invocation;
+  select_area->selectors = g_ptr_array_new_with_free_func (phosh_cp_widget_destroy);
+
+  /* Select in process rather than spawning an external tool */
+  for (int i = 0; i < phosh_monitor_manager_get_num_monitors (monitor_manager); i++) {
+    PhoshMonitor *monitor = phosh_monitor_manager_get_monitor (monitor_manager, i);
+    PhoshAreaSelector *selector;
+
+    if (monitor == NULL)
+      continue;
+
+    selector = phosh_area_selector_new (monitor);
+    g_object_connect (selector,
+                      "swapped-object-signal::selected", on_area_selected, self,
+                      "swapped-object-signal::cancelled", on_area_selection_cancelled, self,
+                      NULL);
+    gtk_widget_show (GTK_WIDGET (selector));
+    g_ptr_array_add (select_area->selectors, selector);
+  }
+
+  if (select_area->selectors->len == 0) {
+    g_dbus_method_invocation_return_error (invocation, G_DBUS_ERROR,
+                                           G_DBUS_ERROR_FAILED,
+                                           "No output to select an area on");
+    select_area_dispose (select_area);
+    return TRUE;
+  }
+
+  self->select_area = select_area;
   return TRUE;
 }
 
@@ -1232,6 +1503,8 @@ on_keybindings_changed (PhoshScreenshotManager *self)
                                                      self->action_names);
   g_clear_pointer (&self->action_names, g_strfreev);
   add_keybindings (self);
+
+  self->screenshot_settings = g_settings_new (SCREENSHOT_SCHEMA_ID);
 }
 
 
@@ -1311,8 +1584,14 @@ phosh_screenshot_manager_dispose (GObject *object)
     g_dbus_interface_skeleton_unexport (G_DBUS_INTERFACE_SKELETON (self));
 
   g_clear_pointer (&self->frames, screencopy_frames_dispose);
-  g_clear_object (&self->for_clipboard);
-  g_clear_pointer (&self->slurp, slurp_area_dispose);
+  g_clear_pointer (&self->for_clipboard, g_bytes_unref);
+  if (self->select_area) {
+    g_dbus_method_invocation_return_error (self->select_area->invocation, G_DBUS_ERROR,
+                                           G_DBUS_ERROR_FAILED,
+                                           "Area selection cancelled");
+    g_clear_pointer (&self->select_area, select_area_dispose);
+  }
+  g_clear_object (&self->screencast);
 
   g_clear_handle_id (&self->fader_id, g_source_remove);
   g_clear_handle_id (&self->opaque_id, g_source_remove);
@@ -1320,6 +1599,7 @@ phosh_screenshot_manager_dispose (GObject *object)
 
   g_clear_pointer (&self->action_names, g_strfreev);
   g_clear_object (&self->settings);
+  g_clear_object (&self->screenshot_settings);
 
   G_OBJECT_CLASS (phosh_screenshot_manager_parent_class)->dispose (object);
 }
@@ -1345,6 +1625,8 @@ phosh_screenshot_manager_init (PhoshScreenshotManager *self)
                             G_CALLBACK (on_keybindings_changed),
                             self);
   add_keybindings (self);
+
+  self->screenshot_settings = g_settings_new (SCREENSHOT_SCHEMA_ID);
 }
 
 PhoshScreenshotManager *
@@ -1380,3 +1662,64 @@ phosh_screenshot_manager_take_screenshot (PhoshScreenshotManager *self,
 
   return ret;
 }
+
+/**
+ * phosh_screenshot_manager_start_screencast:
+ * @self: The screenshot manager
+ * @monitor: The monitor to capture
+ * @include_cursor: Whether to include the cursor
+ *
+ * Start continuously capturing the given monitor. Consumers connect to
+ * the returned screencast's [signal@Screencast::frame] signal to get
+ * the captured frames. Only a single screencast can run at a time.
+ *
+ * Returns: (transfer none)(nullable): The running screencast or %NULL on failure
+ */
+PhoshScreencast *
+phosh_screenshot_manager_start_screencast (PhoshScreenshotManager *self,
+                                           PhoshMonitor           *monitor,
+                                           gboolean                include_cursor)
+{
+  g_return_val_if_fail (PHOSH_IS_SCREENSHOT_MANAGER (self), NULL);
+  g_return_val_if_fail (PHOSH_IS_MONITOR (monitor), NULL);
+
+  if (self->wl_scm == NULL) {
+    g_debug ("No screencast support");
+    return NULL;
+  }
+
+  if (self->screencast && phosh_screencast_get_running (self->screencast)) {
+    g_debug ("Screencast already in progress");
+    return NULL;
+  }
+
+  /* Keep the buffer ring around when restarting with the same parameters */
+  if (self->screencast &&
+      (phosh_screencast_get_monitor (self->screencast) != monitor ||
+       phosh_screencast_get_include_cursor (self->screencast) != !!include_cursor))
+    g_clear_object (&self->screencast);
+
+  if (self->screencast == NULL)
+    self->screencast = phosh_screencast_new (monitor, include_cursor);
+
+  if (!phosh_screencast_start (self->screencast))
+    return NULL;
+
+  return self->screencast;
+}
+
+/**
+ * phosh_screenshot_manager_stop_screencast:
+ * @self: The screenshot manager
+ *
+ * Stop a screencast started via
+ * [method@ScreenshotManager.start_screencast].
+ */
+void
+phosh_screenshot_manager_stop_screencast (PhoshScreenshotManager *self)
+{
+  g_return_if_fail (PHOSH_IS_SCREENSHOT_MANAGER (self));
+
+  if (self->screencast)
+    phosh_screencast_stop (self->screencast);
+}
@@ -20,6 +20,12 @@
  * The #PhoshSearchClient class provides an interface to interact with the
  * Phosh search service over D-Bus. It allows client to query for results
  * from different search sources.
+ *
+ * Results of a source that didn't change since its last update are
+ * handed out as the very same [struct@SearchResultMeta] so consumers
+ * can keep the rows showing them. Highlighting plain (ASCII) queries
+ * is done via a simple substring search and the markup is cached per
+ * query so unchanged results aren't highlighted again.
  */
 
 enum State {
@@ -44,8 +50,17 @@ struct _PhoshSearchClientPrivate {
 
   GRegex          *highlight;
   GRegex          *splitter;
+  /* The query's terms if they can be highlighted without a regex */
+  GStrv            plain_terms;
+  /* Marked up strings for the current query */
+  GHashTable      *markup_cache;
+  /* The last results of each source */
+  GHashTable      *source_results;
 
   GCancellable    *cancellable;
+
+  /* Id of the last query, results for other queries are dropped */
+  guint            generation;
 };
 
 static void async_iface_init (GAsyncInitableIface *iface);
@@ -68,6 +83,9 @@ phosh_search_client_finalize (GObject *object)
 
   g_clear_pointer (&priv->highlight, g_regex_unref);
   g_clear_pointer (&priv->splitter, g_regex_unref);
+  g_clear_pointer (&priv->plain_terms, g_strfreev);
+  g_clear_pointer (&priv->markup_cache, g_hash_table_unref);
+  g_clear_pointer (&priv->source_results, g_hash_table_unref);
 
   G_OBJECT_CLASS (phosh_search_client_parent_class)->finalize (object);
 }
@@ -80,6 +98,15 @@ phosh_search_client_class_init (PhoshSearchClientClass *klass)
 
   object_class->finalize = phosh_search_client_finalize;
 
+  /**
+   * PhoshSearchClient::source-results-changed:
+   * @self: The search client
+   * @source_id: The source the results are from
+   * @results:(element-type PhoshSearchResultMeta): The results
+   *
+   * Emitted when a source has new results. Results that didn't change
+   * since the source's last update are the same instances as before.
+   */
   signals[SOURCE_RESULTS_CHANGED] = g_signal_new ("source-results-changed",
                                                   G_TYPE_FROM_CLASS (klass),
                                                   G_SIGNAL_RUN_LAST | G_SIGNAL_DETAILED,
@@ -104,25 +131,58 @@ static void
 on_source_results_changed (PhoshDBusSearch   *server,
                            const char        *source_id,
                            GVariant          *variant,
+                           guint              generation,
                            PhoshSearchClient *self)
 {
+  PhoshSearchClientPrivate *priv = phosh_search_client_get_instance_private (self);
   GVariantIter iter;
   GVariant *item;
-  GPtrArray *results = NULL;
+  g_autoptr (GPtrArray) results = NULL;
+  GPtrArray *last;
+  g_autoptr (GHashTable) last_by_id = NULL;
+
+  if (generation != priv->generation) {
+    g_debug ("Dropping results of %s for stale query %u", source_id, generation);
+    return;
+  }
 
   results = g_ptr_array_new_with_free_func ((GDestroyNotify) phosh_search_result_meta_unref);
+  last = g_hash_table_lookup (priv->source_results, source_id);
+  if (last) {
+    last_by_id = g_hash_table_new (g_str_hash, g_str_equal);
+    for (guint i = 0; i < last->len; i++) {
+      PhoshSearchResultMeta *meta = g_ptr_array_index (last, i);
+      const char *id = phosh_search_result_meta_get_id (meta);
+
+      if (id)
+        g_hash_table_insert (last_by_id, (gpointer)id, meta);
+    }
+  }
 
   g_variant_iter_init (&iter, variant);
   while ((item = g_variant_iter_next_value (&iter))) {
     g_autoptr (PhoshSearchResultMeta) result = NULL;
+    PhoshSearchResultMeta *prev = NULL;
+    const char *id;
 
     result = phosh_search_result_meta_deserialise (item);
+    id = phosh_search_result_meta_get_id (result);
+
+    /* Hand out the previous instance if nothing changed */
+    if (last_by_id && id)
+      prev = g_hash_table_lookup (last_by_id, id);
+    if (prev && phosh_search_result_meta_equal (prev, result)) {
+      g_clear_pointer (&result, phosh_search_result_meta_unref);
+      result = phosh_search_result_meta_ref (prev);
+    }
 
     g_ptr_array_add (results, phosh_search_result_meta_ref (result));
 
     g_clear_pointer (&item, g_variant_unref);
   }
 
+  g_hash_table_insert (priv->source_results, g_strdup (source_id), g_ptr_array_ref (results));
+
   g_signal_emit (self,
                  signals[SOURCE_RESULTS_CHANGED],
                  g_quark_from_string (source_id),
@@ -132,9 +192,13 @@ on_source_results_changed (PhoshDBusSearch   *server,
 
 
 static void
-on_query_finished (PhoshDBusSearch *server, gpointer user_data)
+on_query_finished (PhoshDBusSearch *server, guint generation, gpointer user_data)
 {
   PhoshSearchClient *self = PHOSH_SEARCH_CLIENT (user_data);
+  PhoshSearchClientPrivate *priv = phosh_search_client_get_instance_private (self);
+
+  if (generation != priv->generation)
+    return;
 
   g_signal_emit (self, signals[QUERY_FINISHED], 0);
 }
@@ -234,6 +298,9 @@ phosh_search_client_init (PhoshSearchClient *self)
   g_autoptr (GError) error = NULL;
 
   priv->highlight = NULL;
+  priv->markup_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+  priv->source_results = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                g_free, (GDestroyNotify) g_ptr_array_unref);
   priv->splitter = g_regex_new ("\\s+",
                                 G_REGEX_CASELESS | G_REGEX_MULTILINE,
                                 0,
@@ -281,13 +348,28 @@ phosh_search_client_query (PhoshSearchClient    *self,
   g_auto (GStrv) escaped = NULL;
   g_autoptr (GError) error = NULL;
   GTask *task = NULL;
+  gboolean plain = TRUE;
   int len = 0;
   int i = 0;
 
   task = g_task_new (self, priv->cancellable, callback, callback_data);
   g_task_set_source_tag (task, phosh_search_client_query);
 
-  phosh_dbus_search_call_query (priv->server, query, priv->cancellable, got_query, task);
+  priv->generation++;
+  /* 0 means "current generation" in GetLastResults */
+  if (priv->generation == 0)
+    priv->generation++;
+
+  phosh_dbus_search_call_query (priv->server,
+                                query,
+                                priv->generation,
+                                priv->cancellable,
+                                got_query,
+                                task);
+
+  g_hash_table_remove_all (priv->markup_cache);
+  g_clear_pointer (&priv->highlight, g_regex_unref);
+  g_clear_pointer (&priv->plain_terms, g_strfreev);
 
   striped = g_strstrip (g_strdup (query));
   parts = g_regex_split (priv->splitter, striped, 0);
@@ -297,12 +379,20 @@ phosh_search_client_query (PhoshSearchClient    *self,
   escaped = g_new0 (char *, len + 1);
 
   while (parts[i]) {
+    if (!g_str_is_ascii (parts[i]))
+      plain = FALSE;
     escaped[i] = g_regex_escape_string (parts[i], -1);
 
     i++;
   }
   escaped[len] = NULL;
 
+  /* Caseless matching of ASCII terms doesn't need a regex */
+  if (plain) {
+    priv->plain_terms = g_steal_pointer (&parts);
+    return;
+  }
+
   regex_terms = g_strjoinv ("|", escaped);
   regex = g_strconcat ("(", regex_terms, ")", NULL);
   priv->highlight = g_regex_new (regex, G_REGEX_CASELESS | G_REGEX_MULTILINE, 0, &error);
@@ -328,20 +418,118 @@ phosh_search_client_query_finish (PhoshSearchClient  *self,
 }
 
 
+static void
+on_cancel_query_finished (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+  g_autoptr (GError) error = NULL;
+
+  if (!phosh_dbus_search_call_cancel_query_finish (PHOSH_DBUS_SEARCH (source), res, &error)) {
+    if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+      g_warning ("Unable to cancel query: %s", error->message);
+  }
+}
+
+/**
+ * phosh_search_client_cancel_query:
+ * @self: The search client
+ *
+ * Cancels the current query. Results still arriving for it are
+ * dropped. Use this when a query got superseded but the next one
+ * isn't sent right away.
+ */
+void
+phosh_search_client_cancel_query (PhoshSearchClient *self)
+{
+  PhoshSearchClientPrivate *priv = phosh_search_client_get_instance_private (self);
+
+  phosh_dbus_search_call_cancel_query (priv->server,
+                                       priv->generation,
+                                       priv->cancellable,
+                                       on_cancel_query_finished,
+                                       NULL);
+  /* Make sure late results don't match anymore */
+  priv->generation++;
+  if (priv->generation == 0)
+    priv->generation++;
+}
+
+/**
+ * phosh_search_client_set_max_results:
+ * @self: The search client
+ * @max_results: The maximum number of results per source, 0 for the default
+ *
+ * Limits the number of results reported per source starting with the
+ * next query.
+ */
+void
+phosh_search_client_set_max_results (PhoshSearchClient *self, guint max_results)
+{
+  PhoshSearchClientPrivate *priv = phosh_search_client_get_instance_private (self);
+
+  phosh_dbus_search_set_max_results (priv->server, max_results);
+}
+
+
+static char *
+markup_plain (GStrv terms, const char *string)
+{
+  GString *marked = g_string_sized_new (strlen (string));
+  const char *p = string;
+
+  while (*p) {
+    gsize len = 0;
+
+    /* Like the regex alternation the first matching term wins */
+    for (int i = 0; terms[i]; i++) {
+      gsize term_len = strlen (terms[i]);
+
+      if (term_len && g_ascii_strncasecmp (p, terms[i], term_len) == 0) {
+        len = term_len;
+        break;
+      }
+    }
+
+    if (len) {
+      g_string_append (marked, "<b>");
+      g_string_append_len (marked, p, len);
+      g_string_append (marked, "</b>");
+      p += len;
+    } else {
+      g_string_append_c (marked, *p);
+      p++;
+    }
+  }
+
+  return g_string_free (marked, FALSE);
+}
+
+
 char *
 phosh_search_client_markup_string (PhoshSearchClient *self, const char *string)
 {
   PhoshSearchClientPrivate *priv = phosh_search_client_get_instance_private (self);
   g_autoptr (GError) error = NULL;
+  const char *cached;
   char *marked = NULL;
 
   if (string == NULL)
     return NULL;
 
-  marked = g_regex_replace (priv->highlight, string, -1, 0, "<b>\\1</b>", 0, &error);
-
-  if (error)
+  cached = g_hash_table_lookup (priv->markup_cache, string);
+  if (cached)
+    return g_strdup (cached);
+
+  if (priv->plain_terms) {
+    marked = markup_plain (priv->plain_terms, string);
+  } else if (priv->highlight) {
+    marked = g_regex_replace (priv->highlight, string, -1, 0, "<b>\\1</b>", 0, &error);
+    if (error)
+      return g_strdup (string);
+  } else {
     return g_strdup (string);
+  }
+
+  g_hash_table_insert (priv->markup_cache, g_strdup (string), g_strdup (marked));
 
   return marked;
 }
@@ -407,6 +595,7 @@ phosh_search_client_get_last_results (PhoshSearchClient *self,
   g_task_set_source_tag (task, phosh_search_client_get_last_results);
 
   phosh_dbus_search_call_get_last_results (priv->server,
+                                           priv->generation,
                                            priv->cancellable,
                                            got_last_results,
                                            task);
@@ -35,6 +35,9 @@ void               phosh_search_client_query                   (PhoshSearchClien
 gboolean           phosh_search_client_query_finish            (PhoshSearchClient  *self,
                                                                 GAsyncResult       *res,
                                                                 GError            **error);
+void               phosh_search_client_cancel_query            (PhoshSearchClient    *self);
+void               phosh_search_client_set_max_results         (PhoshSearchClient    *self,
+                                                                guint                 max_results);
 void               phosh_search_client_get_last_results        (PhoshSearchClient *self,
                                                                 GAsyncReadyCallback callback,
                                                                 gpointer callback_data);
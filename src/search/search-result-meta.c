@@ -172,6 +172,39 @@ phosh_search_result_meta_get_icon (PhoshSearchResultMeta *self)
   return self->icon;
 }
 
+/**
+ * phosh_search_result_meta_equal:
+ * @self: A #PhoshSearchResultMeta instance.
+ * @other: Another #PhoshSearchResultMeta instance.
+ *
+ * Check whether @self and @other describe the same result with the
+ * same content so a row showing @self can keep showing it instead of
+ * being rebuilt for @other.
+ *
+ * Returns: %TRUE if both are equal
+ */
+gboolean
+phosh_search_result_meta_equal (PhoshSearchResultMeta *self,
+                                PhoshSearchResultMeta *other)
+{
+  g_return_val_if_fail (self != NULL, FALSE);
+  g_return_val_if_fail (other != NULL, FALSE);
+
+  if (self == other)
+    return TRUE;
+
+  if (g_strcmp0 (self->id, other->id) != 0 ||
+      g_strcmp0 (self->title, other->title) != 0 ||
+      g_strcmp0 (self->desc, other->desc) != 0 ||
+      g_strcmp0 (self->clipboard_text, other->clipboard_text) != 0)
+    return FALSE;
+
+  if (self->icon == NULL || other->icon == NULL)
+    return self->icon == other->icon;
+
+  return g_icon_equal (self->icon, other->icon);
+}
+
 /**
  * phosh_search_result_meta_new:
  * @id: the result id
@@ -30,6 +30,8 @@ const char            *phosh_search_result_meta_get_title          (PhoshSearchR
 const char            *phosh_search_result_meta_get_description    (PhoshSearchResultMeta *self);
 GIcon                 *phosh_search_result_meta_get_icon           (PhoshSearchResultMeta *self);
 const char            *phosh_search_result_meta_get_clipboard_text (PhoshSearchResultMeta *self);
+gboolean               phosh_search_result_meta_equal              (PhoshSearchResultMeta *self,
+                                                                    PhoshSearchResultMeta *other);
 GVariant              *phosh_search_result_meta_serialise          (PhoshSearchResultMeta *self);
 PhoshSearchResultMeta *phosh_search_result_meta_deserialise        (GVariant              *variant);
 
@@ -62,3 +62,53 @@ phosh_sensor_proxy_manager_new (GError **err)
                          "g-interface-name", IIO_SENSOR_PROXY_DBUS_IFACE_NAME,
                          NULL);
 }
+
+
+/**
+ * phosh_sensor_proxy_manager_new_async:
+ * @cancellable: (nullable): A cancellable
+ * @callback: The callback to invoke once the proxy is ready
+ * @user_data: The user data passed to @callback
+ *
+ * Asynchronously creates the proxy so the bus round trips don't block
+ * the main loop. Use [ctor@SensorProxyManager.new_finish] to get the result.
+ */
+void
+phosh_sensor_proxy_manager_new_async (GCancellable        *cancellable,
+                                      GAsyncReadyCallback  callback,
+                                      gpointer             user_data)
+{
+  g_async_initable_new_async (PHOSH_TYPE_SENSOR_PROXY_MANAGER,
+                              G_PRIORITY_DEFAULT,
+                              cancellable,
+                              callback,
+                              user_data,
+                              "g-flags", G_DBUS_OBJECT_MANAGER_CLIENT_FLAGS_NONE,
+                              "g-name", IIO_SENSOR_PROXY_DBUS_NAME,
+                              "g-bus-type", G_BUS_TYPE_SYSTEM,
+                              "g-object-path", IIO_SENSOR_PROXY_DBUS_OBJECT,
+                              "g-interface-name", IIO_SENSOR_PROXY_DBUS_IFACE_NAME,
+                              NULL);
+}
+
+/**
+ * phosh_sensor_proxy_manager_new_finish:
+ * @res: The async result
+ * @err: The return location for an error
+ *
+ * Finishes an operation started with [func@SensorProxyManager.new_async].
+ *
+ * Returns: (transfer full)(nullable): The sensor proxy manager
+ */
+PhoshSensorProxyManager *
+phosh_sensor_proxy_manager_new_finish (GAsyncResult *res, GError **err)
+{
+  g_autoptr (GObject) source_object = g_async_result_get_source_object (res);
+  GObject *object;
+
+  object = g_async_initable_new_finish (G_ASYNC_INITABLE (source_object), res, err);
+  if (object == NULL)
+    return NULL;
+
+  return PHOSH_SENSOR_PROXY_MANAGER (object);
+}
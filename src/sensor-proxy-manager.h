@@ -14,3 +14,8 @@ G_DECLARE_FINAL_TYPE (PhoshSensorProxyManager, phosh_sensor_proxy_manager,
                       PHOSH, SENSOR_PROXY_MANAGER, PhoshDBusSensorProxyProxy)
 
 PhoshSensorProxyManager *phosh_sensor_proxy_manager_new (GError **err);
+void                     phosh_sensor_proxy_manager_new_async (GCancellable        *cancellable,
+                                                               GAsyncReadyCallback  callback,
+                                                               gpointer             user_data);
+PhoshSensorProxyManager *phosh_sensor_proxy_manager_new_finish (GAsyncResult *res,
+                                                                GError      **err);
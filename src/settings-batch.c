@@ -0,0 +1,286 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "phosh-settings-batch"
+
+#include "phosh-config.h"
+
+#include "settings-batch.h"
+
+/**
+ * PhoshSettingsBatch:
+ *
+ * Collects change notifications of a `GSettings` object and emits
+ * them as a single [signal@SettingsBatch::changed].
+ *
+ * `dconf load`, resetting a schema or a settings panel writing several
+ * keys at once results in one `changed::` emission per key.
+ * Components that rebuild expensive state (like a model or the app
+ * grid's filter) from several keys can use a `PhoshSettingsBatch` to
+ * update once per main loop iteration with the set of keys that
+ * changed instead of once per key.
+ *
+ * This is the `GSettings` counterpart to [class@PropertyBatch].
+ */
+
+enum {
+  PROP_0,
+  PROP_SETTINGS,
+  PROP_LAST_PROP
+};
+static GParamSpec *props[PROP_LAST_PROP];
+
+enum {
+  CHANGED,
+  N_SIGNALS
+};
+static guint signals[N_SIGNALS];
+
+struct _PhoshSettingsBatch {
+  GObject     parent;
+
+  GSettings  *settings;
+  /* The keys we're interested in */
+  GHashTable *keys;
+  /* Changed since the last emission */
+  GPtrArray  *dirty;
+  guint       idle_id;
+};
+G_DEFINE_TYPE (PhoshSettingsBatch, phosh_settings_batch, G_TYPE_OBJECT)
+
+
+static gboolean
+on_idle (gpointer data)
+{
+  PhoshSettingsBatch *self = PHOSH_SETTINGS_BATCH (data);
+
+  self->idle_id = 0;
+  phosh_settings_batch_flush (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static void
+on_settings_changed (PhoshSettingsBatch *self, const char *key)
+{
+  if (g_hash_table_size (self->keys) && !g_hash_table_contains (self->keys, key))
+    return;
+
+  if (g_ptr_array_find_with_equal_func (self->dirty, key, g_str_equal, NULL))
+    return;
+
+  g_ptr_array_add (self->dirty, g_strdup (key));
+
+  /* Run before the next frame gets drawn */
+  if (self->idle_id == 0) {
+    self->idle_id = g_idle_add_full (G_PRIORITY_HIGH_IDLE, on_idle, self, NULL);
+    g_source_set_name_by_id (self->idle_id, "[phosh] settings batch");
+  }
+}
+
+
+static void
+phosh_settings_batch_set_property (GObject      *object,
+                                   guint         property_id,
+                                   const GValue *value,
+                                   GParamSpec   *pspec)
+{
+  PhoshSettingsBatch *self = PHOSH_SETTINGS_BATCH (object);
+
+  switch (property_id) {
+  case PROP_SETTINGS:
+    self->settings = g_value_dup_object (value);
+    break;
+  default:
+    G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    break;
+  }
+}
+
+
+static void
+phosh_settings_batch_get_property (GObject    *object,
+                                   guint       property_id,
+                                   GValue     *value,
+                                   GParamSpec *pspec)
+{
+  PhoshSettingsBatch *self = PHOSH_SETTINGS_BATCH (object);
+
+  switch (property_id) {
+  case PROP_SETTINGS:
+    g_value_set_object (value, self->settings);
+    break;
+  default:
+    G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    break;
+  }
+}
+
+
+static void
+phosh_settings_batch_constructed (GObject *object)
+{
+  PhoshSettingsBatch *self = PHOSH_SETTINGS_BATCH (object);
+
+  G_OBJECT_CLASS (phosh_settings_batch_parent_class)->constructed (object);
+
+  g_signal_connect_object (self->settings, "changed", G_CALLBACK (on_settings_changed), self,
+                           G_CONNECT_SWAPPED);
+}
+
+
+static void
+phosh_settings_batch_dispose (GObject *object)
+{
+  PhoshSettingsBatch *self = PHOSH_SETTINGS_BATCH (object);
+
+  g_clear_handle_id (&self->idle_id, g_source_remove);
+  if (self->settings)
+    g_signal_handlers_disconnect_by_data (self->settings, self);
+  g_clear_object (&self->settings);
+
+  G_OBJECT_CLASS (phosh_settings_batch_parent_class)->dispose (object);
+}
+
+
+static void
+phosh_settings_batch_finalize (GObject *object)
+{
+  PhoshSettingsBatch *self = PHOSH_SETTINGS_BATCH (object);
+
+  g_clear_pointer (&self->keys, g_hash_table_unref);
+  g_clear_pointer (&self->dirty, g_ptr_array_unref);
+
+  G_OBJECT_CLASS (phosh_settings_batch_parent_class)->finalize (object);
+}
+
+
+static void
+phosh_settings_batch_class_init (PhoshSettingsBatchClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->get_property = phosh_settings_batch_get_property;
+  object_class->set_property = phosh_settings_batch_set_property;
+  object_class->constructed = phosh_settings_batch_constructed;
+  object_class->dispose = phosh_settings_batch_dispose;
+  object_class->finalize = phosh_settings_batch_finalize;
+
+  /**
+   * PhoshSettingsBatch:settings:
+   *
+   * The settings whose change notifications are batched
+   */
+  props[PROP_SETTINGS] =
+    g_param_spec_object ("settings", "", "",
+                         G_TYPE_SETTINGS,
+                         G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties (object_class, PROP_LAST_PROP, props);
+
+  /**
+   * PhoshSettingsBatch::changed:
+   * @self: The settings batch
+   * @keys: The keys that changed
+   *
+   * Emitted once per main loop iteration when any of the tracked
+   * keys changed.
+   */
+  signals[CHANGED] = g_signal_new ("changed",
+                                   G_TYPE_FROM_CLASS (klass),
+                                   G_SIGNAL_RUN_LAST,
+                                   0, NULL, NULL, NULL,
+                                   G_TYPE_NONE,
+                                   1,
+                                   G_TYPE_STRV);
+}
+
+
+static void
+phosh_settings_batch_init (PhoshSettingsBatch *self)
+{
+  self->keys = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  self->dirty = g_ptr_array_new_null_terminated (4, g_free, TRUE);
+}
+
+/**
+ * phosh_settings_batch_new:
+ * @settings: The settings to track
+ * @first_key:(nullable): The first key to track
+ * @...: More keys, terminated by `NULL`
+ *
+ * Creates a new settings batch tracking the given keys of
+ * `settings`. If no keys are given all keys are tracked.
+ *
+ * Returns:(transfer full): The settings batch
+ */
+PhoshSettingsBatch *
+phosh_settings_batch_new (GSettings *settings, const char *first_key, ...)
+{
+  g_autoptr (GSettingsSchema) schema = NULL;
+  PhoshSettingsBatch *self;
+  va_list args;
+
+  g_return_val_if_fail (G_IS_SETTINGS (settings), NULL);
+
+  self = g_object_new (PHOSH_TYPE_SETTINGS_BATCH, "settings", settings, NULL);
+  g_object_get (settings, "settings-schema", &schema, NULL);
+
+  va_start (args, first_key);
+  for (const char *key = first_key; key; key = va_arg (args, const char *)) {
+    if (!g_settings_schema_has_key (schema, key)) {
+      g_critical ("%s has no key '%s'", g_settings_schema_get_id (schema), key);
+      continue;
+    }
+    g_hash_table_add (self->keys, g_strdup (key));
+  }
+  va_end (args);
+
+  return self;
+}
+
+/**
+ * phosh_settings_batch_get_settings:
+ * @self: The settings batch
+ *
+ * Get the tracked settings
+ *
+ * Returns:(transfer none): The tracked settings
+ */
+GSettings *
+phosh_settings_batch_get_settings (PhoshSettingsBatch *self)
+{
+  g_return_val_if_fail (PHOSH_IS_SETTINGS_BATCH (self), NULL);
+
+  return self->settings;
+}
+
+/**
+ * phosh_settings_batch_flush:
+ * @self: The settings batch
+ *
+ * Emit pending changes right away instead of waiting for the main
+ * loop.
+ */
+void
+phosh_settings_batch_flush (PhoshSettingsBatch *self)
+{
+  g_autoptr (GPtrArray) dirty = NULL;
+
+  g_return_if_fail (PHOSH_IS_SETTINGS_BATCH (self));
+
+  g_clear_handle_id (&self->idle_id, g_source_remove);
+
+  if (self->dirty->len == 0)
+    return;
+
+  /* Handlers might cause further changes */
+  dirty = g_steal_pointer (&self->dirty);
+  self->dirty = g_ptr_array_new_null_terminated (4, g_free, TRUE);
+
+  g_signal_emit (self, signals[CHANGED], 0, (GStrv) dirty->pdata);
+}
@@ -0,0 +1,23 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+#define PHOSH_TYPE_SETTINGS_BATCH (phosh_settings_batch_get_type ())
+
+G_DECLARE_FINAL_TYPE (PhoshSettingsBatch, phosh_settings_batch, PHOSH, SETTINGS_BATCH, GObject)
+
+PhoshSettingsBatch *phosh_settings_batch_new          (GSettings          *settings,
+                                                       const char         *first_key,
+                                                       ...) G_GNUC_NULL_TERMINATED;
+GSettings          *phosh_settings_batch_get_settings (PhoshSettingsBatch *self);
+void                phosh_settings_batch_flush        (PhoshSettingsBatch *self);
+
+G_END_DECLS
@@ -243,6 +243,20 @@ on_notifications_clear_all_clicked (PhoshSettings *self)
 }
 
 
+static void
+on_scrolled_window_edge_reached (PhoshSettings *self, GtkPositionType pos)
+{
+  PhoshNotifyManager *manager;
+
+  if (pos != GTK_POS_BOTTOM)
+    return;
+
+  /* Older notifications are only loaded once the user scrolls down to them */
+  manager = phosh_notify_manager_get_default ();
+  phosh_notification_list_load_spilled (phosh_notify_manager_get_list (manager));
+}
+
+
 static GtkWidget *
 create_notification_row (gpointer item, gpointer data)
 {
@@ -470,6 +484,7 @@ phosh_settings_class_init (PhoshSettingsClass *klass)
   gtk_widget_class_bind_template_callback (widget_class, on_media_player_raised);
   gtk_widget_class_bind_template_callback (widget_class, on_is_headphone_changed);
   gtk_widget_class_bind_template_callback (widget_class, on_notifications_clear_all_clicked);
+  gtk_widget_class_bind_template_callback (widget_class, on_scrolled_window_edge_reached);
   gtk_widget_class_bind_template_callback (widget_class, on_torch_scale_value_changed);
   gtk_widget_class_bind_template_callback (widget_class, update_drag_handle_offset);
 }
@@ -518,3 +533,19 @@ phosh_settings_hide_details (PhoshSettings *self)
   phosh_brightness_settings_hide_details (self->brightness_settings);
   phosh_quick_settings_hide_status (PHOSH_QUICK_SETTINGS (self->quick_settings));
 }
+
+/**
+ * phosh_settings_set_ui_visible:
+ * @self: The settings
+ * @visible: Whether the settings are visible to the user
+ *
+ * Let the settings know whether they're visible so they can skip
+ * updates that aren't visible anyway.
+ */
+void
+phosh_settings_set_ui_visible (PhoshSettings *self, gboolean visible)
+{
+  g_return_if_fail (PHOSH_IS_SETTINGS (self));
+
+  phosh_quick_settings_set_ui_visible (PHOSH_QUICK_SETTINGS (self->quick_settings), visible);
+}
@@ -26,6 +26,7 @@
 
 #include "phosh-config.h"
 #include "ambient.h"
+#include "animation-manager.h"
 #include "background.h"
 #include "brightness-manager.h"
 #include "drag-surface.h"
@@ -57,12 +58,14 @@
 #include "location-info.h"
 #include "layout-manager.h"
 #include "location-manager.h"
+#include "memory-manager.h"
 #include "lockscreen-manager-priv.h"
 #include "default-media-player.h"
 #include "mode-manager.h"
 #include "monitor-manager.h"
 #include "monitor/monitor.h"
 #include "mount-manager.h"
+#include "nm-client.h"
 #include "osd-window.h"
 #include "power-menu-manager.h"
 #include "revealer.h"
@@ -89,9 +92,11 @@
 #include "screenshot-manager.h"
 #include "session-manager.h"
 #include "splash-manager.h"
+#include "startup-timeline.h"
 #include "style-manager.h"
 #include "suspend-manager.h"
 #include "system-prompter.h"
+#include "timer-service.h"
 #include "top-panel.h"
 #include "top-panel-bg.h"
 #include "torch-manager.h"
@@ -137,6 +142,7 @@ static GParamSpec *props[PROP_LAST_PROP];
 
 enum {
   READY,
+  USABLE_AREA_CHANGED,
   N_SIGNALS
 };
 static guint signals[N_SIGNALS] = { 0 };
@@ -153,6 +159,17 @@ typedef struct {
   PhoshOsdWindow             *osd;
   gint osd_timeoutid;
   gboolean                    osd_continue;
+  /* PhoshMonitor → its hidden or shown PhoshOsdWindow */
+  GHashTable                 *osds;
+  /* OSD content to apply on the next frame */
+  struct {
+    char                     *connector;
+    char                     *icon;
+    char                     *label;
+    double                    level;
+    double                    max_level;
+  } osd_pending;
+  guint                       osd_tick_id;
 
   GtkWidget                  *notification_banner;
 
@@ -162,6 +179,9 @@ typedef struct {
   PhoshBackgroundManager     *background_manager;
   PhoshCallsManager          *calls_manager;
   PhoshMonitor               *primary_monitor;
+  /* Cached as it's queried during layout */
+  GdkRectangle                usable_area;
+  gboolean                    usable_area_valid;
   PhoshMonitor               *builtin_monitor;
   PhoshMonitorManager        *monitor_manager;
   PhoshLockscreenManager     *lockscreen_manager;
@@ -201,8 +221,15 @@ typedef struct {
   PhoshConnectivityManager   *connectivity_manager;
   PhoshMprisManager          *mpris_manager;
   PhoshBrightnessManager     *brightness_manager;
+  PhoshMemoryManager         *memory_manager;
+  PhoshAnimationManager      *animation_manager;
+  PhoshPowerSaverManager     *power_saver_manager;
   PhoshDebugControl          *debug_control;
 
+  /* Shared by all NetworkManager consumers */
+  NMClient                   *nmclient;
+  GCancellable               *cancel;
+
   /* sensors */
   PhoshSensorProxyManager    *sensor_proxy_manager;
   PhoshProximity             *proximity;
@@ -211,6 +238,10 @@ typedef struct {
 
   gboolean                    startup_finished;
   guint startup_finished_id;
+  /* Idle setup and D-Bus proxies resolving in parallel before setup_shell () */
+  guint                       startup_pending;
+  guint                       deferred_stage;
+  guint                       deferred_stage_id;
 
   GSimpleActionGroup         *action_map;
 
@@ -291,10 +322,43 @@ update_top_level_layer (PhoshShell *self)
 }
 
 
+static void
+update_timer_service (PhoshShell *self)
+{
+  PhoshShellPrivate *priv = phosh_shell_get_instance_private (self);
+  gboolean suspend;
+
+  /* Nobody can see the results of periodic UI updates when the screen is off or covered */
+  suspend = !!(phosh_shell_get_state (self) & PHOSH_STATE_BLANKED);
+  suspend |= priv->proximity && phosh_proximity_has_fader (priv->proximity);
+
+  phosh_timer_service_set_suspended (phosh_timer_service_get_default (), suspend);
+}
+
+
+static void
+on_resumed (PhoshShell *self)
+{
+  /* Clocks and other wall clock aligned labels are stale after suspend */
+  phosh_timer_service_resync (phosh_timer_service_get_default ());
+}
+
+
+static void
+on_resumed_idle (PhoshShell *self)
+{
+  PhoshShellPrivate *priv = phosh_shell_get_instance_private (self);
+
+  if (priv->wifi_manager)
+    phosh_wifi_manager_restart_periodic_scan (priv->wifi_manager);
+}
+
+
 static void
 on_proximity_fader_changed (PhoshShell *self)
 {
   update_top_level_layer (self);
+  update_timer_service (self);
 }
 
 
@@ -361,6 +425,80 @@ on_primary_monitor_power_mode_changed (PhoshShell *self, GParamSpec *pspec, Phos
   g_object_get (monitor, "power-mode", &mode, NULL);
 
   phosh_shell_set_state (self, PHOSH_STATE_BLANKED, mode == PHOSH_MONITOR_POWER_SAVE_MODE_OFF);
+  update_timer_service (self);
+}
+
+
+static gboolean
+ensure_usable_area (PhoshShell *self)
+{
+  PhoshShellPrivate *priv = phosh_shell_get_instance_private (self);
+  PhoshMonitor *monitor;
+  PhoshMonitorMode *mode;
+  int w, h;
+  float scale;
+
+  if (priv->usable_area_valid)
+    return TRUE;
+
+  monitor = priv->primary_monitor;
+  if (monitor == NULL)
+    return FALSE;
+
+  mode = phosh_monitor_get_current_mode (monitor);
+  if (mode == NULL)
+    return FALSE;
+
+  scale = MAX (1.0, phosh_monitor_get_fractional_scale (monitor));
+
+  g_debug ("Primary monitor %p scale is %f, mode: %dx%d, transform is %d",
+           monitor,
+           scale,
+           mode->width,
+           mode->height,
+           monitor->transform);
+
+  switch (phosh_monitor_get_transform (monitor)) {
+  case PHOSH_MONITOR_TRANSFORM_NORMAL:
+  case PHOSH_MONITOR_TRANSFORM_180:
+  case PHOSH_MONITOR_TRANSFORM_FLIPPED:
+  case PHOSH_MONITOR_TRANSFORM_FLIPPED_180:
+    w = mode->width / scale;
+    h = mode->height / scale - PHOSH_TOP_BAR_HEIGHT - PHOSH_HOME_BAR_HEIGHT;
+    break;
+  default:
+    w = mode->height / scale;
+    h = mode->width / scale - PHOSH_TOP_BAR_HEIGHT - PHOSH_HOME_BAR_HEIGHT;
+    break;
+  }
+
+  priv->usable_area = (GdkRectangle) {
+    .x = 0,
+    .y = PHOSH_TOP_BAR_HEIGHT,
+    .width = w,
+    .height = h,
+  };
+  priv->usable_area_valid = TRUE;
+
+  return TRUE;
+}
+
+
+static void
+invalidate_usable_area (PhoshShell *self)
+{
+  PhoshShellPrivate *priv = phosh_shell_get_instance_private (self);
+  GdkRectangle old = priv->usable_area;
+  gboolean was_valid = priv->usable_area_valid;
+
+  priv->usable_area_valid = FALSE;
+  if (!ensure_usable_area (self))
+    return;
+
+  if (was_valid && gdk_rectangle_equal (&old, &priv->usable_area))
+    return;
+
+  g_signal_emit (self, signals[USABLE_AREA_CHANGED], 0);
 }
 
 
@@ -374,6 +512,9 @@ on_primary_monitor_configured (PhoshShell *self, PhoshMonitor *monitor)
   g_return_if_fail (PHOSH_IS_MONITOR (monitor));
   priv = phosh_shell_get_instance_private (self);
 
+  /* Mode, scale and transform changes end in a configure */
+  invalidate_usable_area (self);
+
   phosh_shell_get_area (self, NULL, &height);
   phosh_layer_surface_set_size (PHOSH_LAYER_SURFACE (priv->top_panel), -1, height);
 }
@@ -588,14 +729,29 @@ phosh_shell_dispose (GObject *object)
   PhoshShellPrivate *priv = phosh_shell_get_instance_private (self);
 
   g_clear_handle_id (&priv->startup_finished_id, g_source_remove);
+  g_clear_handle_id (&priv->deferred_stage_id, g_source_remove);
 
   panels_dispose (self);
   g_clear_pointer (&priv->faders, g_ptr_array_unref);
 
   g_clear_pointer (&priv->notification_banner, phosh_cp_widget_destroy);
+  if (priv->osds) {
+    g_autoptr (GList) osds = g_hash_table_get_values (priv->osds);
+
+    for (GList *l = osds; l; l = l->next)
+      gtk_widget_destroy (GTK_WIDGET (l->data));
+  }
+  g_clear_pointer (&priv->osds, g_hash_table_unref);
+  g_clear_pointer (&priv->osd_pending.connector, g_free);
+  g_clear_pointer (&priv->osd_pending.icon, g_free);
+  g_clear_pointer (&priv->osd_pending.label, g_free);
+  phosh_layer_surface_pool_clear ();
 
   /* dispose managers in opposite order of declaration */
   g_clear_object (&priv->debug_control);
+  g_clear_object (&priv->animation_manager);
+  g_clear_object (&priv->power_saver_manager);
+  g_clear_object (&priv->memory_manager);
   g_clear_object (&priv->brightness_manager);
   g_clear_object (&priv->mpris_manager);
   g_clear_object (&priv->connectivity_manager);
@@ -651,6 +807,9 @@ phosh_shell_dispose (GObject *object)
 
   g_clear_object (&priv->action_map);
   g_clear_object (&priv->settings);
+  g_cancellable_cancel (priv->cancel);
+  g_clear_object (&priv->cancel);
+  g_clear_object (&priv->nmclient);
 
   G_OBJECT_CLASS (phosh_shell_parent_class)->dispose (object);
 }
@@ -769,6 +928,79 @@ on_fade_out_timeout (PhoshShell *self)
 
 /* {{{ OSD */
 
+static gboolean
+is_osd (gpointer key, gpointer value, gpointer user_data)
+{
+  return value == user_data;
+}
+
+
+static void
+on_osd_destroyed (PhoshShell *self, PhoshOsdWindow *osd)
+{
+  PhoshShellPrivate *priv = phosh_shell_get_instance_private (self);
+
+  g_hash_table_foreach_remove (priv->osds, is_osd, osd);
+
+  if (priv->osd != osd)
+    return;
+
+  priv->osd = NULL;
+  priv->osd_tick_id = 0;
+  g_clear_handle_id (&priv->osd_timeoutid, g_source_remove);
+}
+
+
+static PhoshOsdWindow *
+ensure_osd (PhoshShell *self, PhoshMonitor *monitor)
+{
+  PhoshShellPrivate *priv = phosh_shell_get_instance_private (self);
+  PhoshOsdWindow *osd;
+
+  osd = g_hash_table_lookup (priv->osds, monitor);
+  if (osd)
+    return osd;
+
+  /* New OSDs go to the primary monitor */
+  g_return_val_if_fail (monitor == priv->primary_monitor, NULL);
+
+  osd = PHOSH_OSD_WINDOW (phosh_osd_window_new (NULL, NULL, NULL, 0.0, 1.0));
+  g_signal_connect_object (osd, "destroy", G_CALLBACK (on_osd_destroyed), self,
+                           G_CONNECT_SWAPPED);
+  g_hash_table_insert (priv->osds, monitor, osd);
+
+  return osd;
+}
+
+
+static void
+apply_osd_pending (PhoshShell *self)
+{
+  PhoshShellPrivate *priv = phosh_shell_get_instance_private (self);
+
+  g_object_set (priv->osd,
+                "connector", priv->osd_pending.connector,
+                "label", priv->osd_pending.label,
+                "icon-name", priv->osd_pending.icon,
+                "level", priv->osd_pending.level,
+                "max-level", priv->osd_pending.max_level,
+                NULL);
+}
+
+
+static gboolean
+on_osd_tick (GtkWidget *widget, GdkFrameClock *frame_clock, gpointer user_data)
+{
+  PhoshShell *self = PHOSH_SHELL (user_data);
+  PhoshShellPrivate *priv = phosh_shell_get_instance_private (self);
+
+  priv->osd_tick_id = 0;
+  apply_osd_pending (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+
 static gboolean
 on_osd_timeout (PhoshShell *self)
 {
@@ -779,23 +1011,18 @@ on_osd_timeout (PhoshShell *self)
   if (!priv->osd_continue) {
     g_debug ("Closing osd");
     priv->osd_timeoutid = 0;
-    if (priv->osd)
-      gtk_widget_destroy (GTK_WIDGET (priv->osd));
+    if (priv->osd) {
+      if (priv->osd_tick_id)
+        gtk_widget_remove_tick_callback (GTK_WIDGET (priv->osd), priv->osd_tick_id);
+      priv->osd_tick_id = 0;
+      /* Keep the OSD around so showing it again is cheap */
+      gtk_widget_set_visible (GTK_WIDGET (g_steal_pointer (&priv->osd)), FALSE);
+    }
   }
   priv->osd_continue = FALSE;
   return ret;
 }
 
-
-static void
-on_osd_destroyed (PhoshShell *self)
-{
-  PhoshShellPrivate *priv = phosh_shell_get_instance_private (self);
-
-  priv->osd = NULL;
-  g_clear_handle_id (&priv->osd_timeoutid, g_source_remove);
-}
-
 /* }}} */
 
 static void
@@ -822,37 +1049,159 @@ on_startup_finished (gpointer data)
   priv = phosh_shell_get_instance_private (self);
 
   notify_compositor_up_state (self, PHOSH_PRIVATE_SHELL_STATE_UP);
+  phosh_startup_timeline_mark ("shell-up");
 
   priv->startup_finished_id = 0;
 }
 
 
+static void
+setup_mount_managers (PhoshShell *self)
+{
+  PhoshShellPrivate *priv = phosh_shell_get_instance_private (self);
+
+  priv->mount_manager = phosh_mount_manager_new ();
+  priv->gtk_mount_manager = phosh_gtk_mount_manager_new ();
+}
+
+
+static void
+setup_location_manager (PhoshShell *self)
+{
+  phosh_shell_get_location_manager (self);
+}
+
+
+static void
+setup_run_command_manager (PhoshShell *self)
+{
+  PhoshShellPrivate *priv = phosh_shell_get_instance_private (self);
+
+  priv->run_command_manager = phosh_run_command_manager_new ();
+}
+
+
+static void
+setup_network_auth_manager (PhoshShell *self)
+{
+  PhoshShellPrivate *priv = phosh_shell_get_instance_private (self);
+
+  priv->network_auth_manager = phosh_network_auth_manager_new ();
+}
+
+
+static void
+setup_portal_access_manager (PhoshShell *self)
+{
+  PhoshShellPrivate *priv = phosh_shell_get_instance_private (self);
+
+  priv->portal_access_manager = phosh_portal_access_manager_new ();
+}
+
+
+static void
+setup_cell_broadcast_manager (PhoshShell *self)
+{
+  PhoshShellPrivate *priv = phosh_shell_get_instance_private (self);
+
+  priv->cell_broadcast_manager = phosh_cell_broadcast_manager_new ();
+}
+
+
+static void
+setup_memory_manager (PhoshShell *self)
+{
+  PhoshShellPrivate *priv = phosh_shell_get_instance_private (self);
+
+  priv->memory_manager = phosh_memory_manager_new ();
+}
+
+static void
+setup_osd (PhoshShell *self)
+{
+  PhoshShellPrivate *priv = phosh_shell_get_instance_private (self);
+
+  /* Have an OSD ready so the first volume or brightness change doesn't build one */
+  if (priv->primary_monitor)
+    ensure_osd (self, priv->primary_monitor);
+}
+
+/*
+ * Managers that aren't needed to show the lockscreen and to unlock.
+ * They're created one per idle slice after the shell is up.
+ */
+static const struct {
+  const char *name;
+  void      (*setup) (PhoshShell *self);
+} deferred_stages[] = {
+  { "location-manager", setup_location_manager },
+  { "mount-managers", setup_mount_managers },
+  { "run-command-manager", setup_run_command_manager },
+  { "network-auth-manager", setup_network_auth_manager },
+  { "portal-access-manager", setup_portal_access_manager },
+  { "cell-broadcast-manager", setup_cell_broadcast_manager },
+  { "memory-manager", setup_memory_manager },
+  { "osd", setup_osd },
+};
+
+
 static gboolean
-setup_idle_cb (PhoshShell *self)
+on_deferred_stage_idle (gpointer data)
 {
-  g_autoptr (GError) err = NULL;
+  PhoshShell *self = PHOSH_SHELL (data);
   PhoshShellPrivate *priv = phosh_shell_get_instance_private (self);
+  guint stage = priv->deferred_stage++;
+  gint64 start = g_get_monotonic_time ();
+
+  g_debug ("Running deferred startup stage %s", deferred_stages[stage].name);
+  deferred_stages[stage].setup (self);
+  phosh_startup_timeline_add_span (deferred_stages[stage].name, start);
+
+  if (priv->deferred_stage < G_N_ELEMENTS (deferred_stages))
+    return G_SOURCE_CONTINUE;
+
+  phosh_startup_timeline_finish ();
+  priv->deferred_stage_id = 0;
+  return G_SOURCE_REMOVE;
+}
+
+
+static void
+setup_shell (PhoshShell *self)
+{
+  PhoshShellPrivate *priv = phosh_shell_get_instance_private (self);
+
+  phosh_startup_timeline_mark ("setup-idle");
 
   priv->debug_control = phosh_debug_control_new ();
+  phosh_startup_timeline_step ("debug-control");
   priv->app_tracker = phosh_app_tracker_new ();
   phosh_toplevel_manager_set_app_tracker (priv->toplevel_manager, priv->app_tracker);
+  phosh_startup_timeline_step ("app-tracker");
   priv->splash_manager = phosh_splash_manager_new (priv->app_tracker);
+  phosh_startup_timeline_step ("splash-manager");
   priv->session_manager = phosh_session_manager_new ();
+  phosh_startup_timeline_step ("session-manager");
   priv->mode_manager = phosh_mode_manager_new ();
+  phosh_startup_timeline_step ("mode-manager");
   priv->wifi_manager = phosh_wifi_manager_new ();
+  phosh_startup_timeline_step ("wifi-manager");
   /* Connecivity manager needs Wi-Fi manager: */
   priv->connectivity_manager = phosh_connectivity_manager_new ();
+  phosh_startup_timeline_step ("connectivity-manager");
 
-  priv->sensor_proxy_manager = phosh_sensor_proxy_manager_new (&err);
+  /* The sensor proxy got resolved in parallel to the rest of startup */
   if (priv->sensor_proxy_manager)
     priv->ambient = phosh_ambient_new (priv->sensor_proxy_manager);
-  else
-    g_message ("Failed to connect to sensor-proxy: %s", err->message);
+  phosh_startup_timeline_step ("ambient");
 
   priv->layout_manager = phosh_layout_manager_new ();
+  phosh_startup_timeline_step ("layout-manager");
   /* PhoshHome needs the background manager */
   priv->background_manager = phosh_background_manager_new ();
+  phosh_startup_timeline_step ("background-manager");
   panels_create (self);
+  phosh_startup_timeline_step ("panels");
 
   g_signal_connect_object (priv->toplevel_manager,
                            "notify::num-toplevels",
@@ -873,6 +1222,7 @@ setup_idle_cb (PhoshShell *self)
                             "pb-long-press",
                             G_CALLBACK (on_pb_long_press),
                             self);
+  phosh_startup_timeline_step ("screen-saver-manager");
 
   priv->notify_manager = phosh_notify_manager_get_default ();
   g_signal_connect_object (priv->notify_manager,
@@ -885,8 +1235,7 @@ setup_idle_cb (PhoshShell *self)
                            G_CALLBACK (on_notification_activated),
                            self,
                            G_CONNECT_SWAPPED);
-
-  phosh_shell_get_location_manager (self);
+  phosh_startup_timeline_step ("notify-manager");
   if (priv->sensor_proxy_manager) {
     priv->proximity = phosh_proximity_new (priv->sensor_proxy_manager,
                                            priv->calls_manager);
@@ -895,24 +1244,31 @@ setup_idle_cb (PhoshShell *self)
     g_signal_connect_swapped (priv->proximity, "notify::fader",
                               G_CALLBACK (on_proximity_fader_changed), self);
   }
-
-  priv->mount_manager = phosh_mount_manager_new ();
-  priv->gtk_mount_manager = phosh_gtk_mount_manager_new ();
+  phosh_startup_timeline_step ("proximity");
 
   phosh_session_manager_register (priv->session_manager,
                                   PHOSH_APP_ID,
                                   g_getenv ("DESKTOP_AUTOSTART_ID"));
   g_unsetenv ("DESKTOP_AUTOSTART_ID");
+  phosh_startup_timeline_step ("session-register");
 
   priv->gnome_shell_manager = phosh_gnome_shell_manager_get_default ();
+  phosh_startup_timeline_step ("gnome-shell-manager");
   priv->screenshot_manager = phosh_screenshot_manager_new ();
-  priv->run_command_manager = phosh_run_command_manager_new ();
-  priv->network_auth_manager = phosh_network_auth_manager_new ();
-  priv->portal_access_manager = phosh_portal_access_manager_new ();
+  phosh_startup_timeline_step ("screenshot-manager");
   priv->suspend_manager = phosh_suspend_manager_new ();
+  g_object_connect (priv->suspend_manager,
+                    "swapped-object-signal::resumed", on_resumed, self,
+                    "swapped-object-signal::resumed-idle", on_resumed_idle, self,
+                    NULL);
+  phosh_startup_timeline_step ("suspend-manager");
   priv->emergency_calls_manager = phosh_emergency_calls_manager_new ();
+  phosh_startup_timeline_step ("emergency-calls-manager");
   priv->power_menu_manager = phosh_power_menu_manager_new ();
-  priv->cell_broadcast_manager = phosh_cell_broadcast_manager_new ();
+  phosh_startup_timeline_step ("power-menu-manager");
+  priv->animation_manager =
+    phosh_animation_manager_new (phosh_shell_get_power_saver_manager (self), priv->mode_manager);
+  phosh_startup_timeline_step ("animation-manager");
 
   setup_primary_monitor_signal_handlers (self);
   /* Setup event hooks late so state changes in UI files don't trigger feedback */
@@ -920,16 +1276,67 @@ setup_idle_cb (PhoshShell *self)
 
   /* Export the debug interface late so everything is up when the name appears */
   phosh_debug_control_set_exported (priv->debug_control, TRUE);
+  phosh_startup_timeline_step ("setup-idle-finish");
 
-  /* Delay signaling to the compositor a bit so that idle handlers get a chance to run and
-     the user can unlock right away. Ideally we'd not need this */
-  priv->startup_finished_id = g_timeout_add_seconds_once (1, on_startup_finished, self);
+  /* Signal the compositor once the idle handlers queued by the above ran so
+     the user can unlock right away */
+  priv->startup_finished_id = g_idle_add_once (on_startup_finished, self);
   g_source_set_name_by_id (priv->startup_finished_id, "[PhoshShell] startup finished");
 
+  /* Low priority so this only runs once the shell is up */
+  priv->deferred_stage_id = g_idle_add_full (G_PRIORITY_LOW, on_deferred_stage_idle, self, NULL);
+  g_source_set_name_by_id (priv->deferred_stage_id, "[PhoshShell] deferred startup");
+
   priv->startup_finished = TRUE;
   g_signal_emit (self, signals[READY], 0);
+}
 
-  return FALSE;
+
+static void
+startup_step_done (PhoshShell *self)
+{
+  PhoshShellPrivate *priv = phosh_shell_get_instance_private (self);
+
+  g_assert (priv->startup_pending > 0);
+  priv->startup_pending--;
+  if (priv->startup_pending)
+    return;
+
+  setup_shell (self);
+}
+
+
+static gboolean
+setup_idle_cb (PhoshShell *self)
+{
+  startup_step_done (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static void
+on_sensor_proxy_manager_ready (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+  g_autoptr (GError) err = NULL;
+  PhoshSensorProxyManager *sensor_proxy_manager;
+  PhoshShell *self;
+  PhoshShellPrivate *priv;
+
+  sensor_proxy_manager = phosh_sensor_proxy_manager_new_finish (res, &err);
+  if (g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    return;
+
+  self = PHOSH_SHELL (user_data);
+  priv = phosh_shell_get_instance_private (self);
+
+  if (sensor_proxy_manager)
+    priv->sensor_proxy_manager = sensor_proxy_manager;
+  else
+    g_message ("Failed to connect to sensor-proxy: %s", err->message);
+  phosh_startup_timeline_mark ("sensor-proxy-manager-ready");
+
+  startup_step_done (self);
 }
 
 
@@ -1052,6 +1459,11 @@ on_monitor_removed (PhoshShell *self, PhoshMonitor *monitor)
   g_return_if_fail (PHOSH_IS_MONITOR (monitor));
   priv = phosh_shell_get_instance_private (self);
 
+  /* Pooled surfaces might be on that monitor */
+  phosh_layer_surface_pool_clear ();
+  if (g_hash_table_contains (priv->osds, monitor))
+    gtk_widget_destroy (GTK_WIDGET (g_hash_table_lookup (priv->osds, monitor)));
+
   if (priv->builtin_monitor == monitor) {
     PhoshMonitor *new_builtin;
 
@@ -1104,16 +1516,46 @@ on_keyboard_events_pressed (PhoshShell *self, const char *combo)
 }
 
 
+static void
+on_nm_client_ready (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+  g_autoptr (GError) err = NULL;
+  PhoshShellPrivate *priv;
+  NMClient *nmclient;
+
+  nmclient = phosh_nm_client_get_finish (res, &err);
+  if (nmclient == NULL) {
+    phosh_async_error_warn (err, "Failed to init NM client");
+    return;
+  }
+
+  priv = phosh_shell_get_instance_private (PHOSH_SHELL (user_data));
+  priv->nmclient = nmclient;
+  phosh_startup_timeline_mark ("nm-client-ready");
+}
+
+
 static void
 phosh_shell_constructed (GObject *object)
 {
   PhoshShell *self = PHOSH_SHELL (object);
   PhoshShellPrivate *priv = phosh_shell_get_instance_private (self);
   g_autoptr (GError) err = NULL;
+  PhoshWaylandSync *outputs_sync;
   guint id;
 
   G_OBJECT_CLASS (phosh_shell_parent_class)->constructed (object);
 
+  phosh_startup_timeline_mark ("shell-constructed");
+
+  /* Let NM's object cache build in parallel, all network managers share it */
+  priv->cancel = g_cancellable_new ();
+  phosh_nm_client_get_async (priv->cancel, on_nm_client_ready, self);
+
+  /* Resolve the sensor proxy while we set up the rest, setup_shell () waits for it */
+  priv->startup_pending++;
+  phosh_sensor_proxy_manager_new_async (priv->cancel, on_sensor_proxy_manager_ready, self);
+
   priv->monitor_manager = phosh_monitor_manager_new (NULL);
   g_signal_connect_swapped (priv->monitor_manager,
                             "monitor-added",
@@ -1124,8 +1566,25 @@ phosh_shell_constructed (GObject *object)
                             G_CALLBACK (on_monitor_removed),
                             self);
 
+  phosh_startup_timeline_step ("monitor-manager");
+
+  /* Let the compositor send all output information (wl_output, xdg-output and
+   * output management) in one go while we set up things that don't need
+   * monitors */
+  outputs_sync = phosh_wayland_sync_begin (phosh_wayland_get_default ());
+
+  priv->calls_manager = phosh_calls_manager_new ();
+  phosh_startup_timeline_step ("calls-manager");
+  priv->launcher_entry_manager = phosh_launcher_entry_manager_new ();
+  phosh_startup_timeline_step ("launcher-entry-manager");
+
+  phosh_system_prompter_register ();
+  priv->polkit_auth_agent = phosh_polkit_auth_agent_new ();
+  phosh_startup_timeline_step ("polkit-auth-agent");
+
   /* Make sure all outputs are up to date */
-  phosh_wayland_roundtrip (phosh_wayland_get_default ());
+  phosh_wayland_sync_wait (phosh_wayland_get_default (), outputs_sync);
+  phosh_startup_timeline_step ("outputs");
 
   if (phosh_monitor_manager_get_num_monitors (priv->monitor_manager)) {
     PhoshMonitor *monitor = find_new_builtin_monitor (self, NULL);
@@ -1149,22 +1608,19 @@ phosh_shell_constructed (GObject *object)
     g_error ("Need at least one monitor");
   }
 
-  priv->calls_manager = phosh_calls_manager_new ();
-  priv->launcher_entry_manager = phosh_launcher_entry_manager_new ();
-
   priv->lockscreen_manager = phosh_lockscreen_manager_new (priv->calls_manager);
   g_object_bind_property (priv->lockscreen_manager, "locked",
                           self, "locked",
                           G_BINDING_BIDIRECTIONAL | G_BINDING_SYNC_CREATE);
+  phosh_startup_timeline_step ("lockscreen-manager");
 
   priv->idle_manager = phosh_idle_manager_get_default ();
 
   priv->faders = g_ptr_array_new_with_free_func ((GDestroyNotify) (gtk_widget_destroy));
-
-  phosh_system_prompter_register ();
-  priv->polkit_auth_agent = phosh_polkit_auth_agent_new ();
+  priv->osds = g_hash_table_new (g_direct_hash, g_direct_equal);
 
   priv->feedback_manager = phosh_feedback_manager_new ();
+  phosh_startup_timeline_step ("feedback-manager");
   priv->keyboard_events = phosh_keyboard_events_new (&err);
   if (priv->keyboard_events) {
     g_signal_connect_swapped (priv->keyboard_events,
@@ -1175,6 +1631,7 @@ phosh_shell_constructed (GObject *object)
     g_warning ("Failed to initialize keyboard events: %s", err->message);
   }
 
+  priv->startup_pending++;
   id = g_idle_add ((GSourceFunc) setup_idle_cb, self);
   g_source_set_name_by_id (id, "[PhoshShell] idle");
 }
@@ -1422,6 +1879,19 @@ phosh_shell_class_init (PhoshShellClass *klass)
                                  G_SIGNAL_RUN_LAST, 0,
                                  NULL, NULL, NULL,
                                  G_TYPE_NONE, 0);
+  /**
+   * PhoshShell::usable-area-changed:
+   * @self: The shell object
+   *
+   * Emitted when the area returned by [method@Shell.get_usable_area]
+   * changed, e.g. due to a mode, scale or transform change of the
+   * primary monitor or when the primary monitor changed.
+   */
+  signals[USABLE_AREA_CHANGED] = g_signal_new ("usable-area-changed",
+                                               G_TYPE_FROM_CLASS (klass),
+                                               G_SIGNAL_RUN_LAST, 0,
+                                               NULL, NULL, NULL,
+                                               G_TYPE_NONE, 0);
 }
 
 
@@ -1538,6 +2008,7 @@ phosh_shell_set_primary_monitor (PhoshShell *self, PhoshMonitor *monitor)
 
   needs_notify = priv->primary_monitor == NULL;
   g_set_object (&priv->primary_monitor, monitor);
+  invalidate_usable_area (self);
   g_debug ("New primary monitor is %s", monitor ? monitor->name : "(none)");
 
   /* Move panels to the new monitor by recreating the layer-shell surfaces */
@@ -2194,6 +2665,31 @@ phosh_shell_get_osk_manager (PhoshShell *self)
   return priv->osk_manager;
 }
 
+/**
+ * phosh_shell_get_power_saver_manager:
+ * @self: The shell singleton
+ *
+ * Get the power saver manager
+ *
+ * Returns: (transfer none): The power saver manager
+ */
+PhoshPowerSaverManager *
+phosh_shell_get_power_saver_manager (PhoshShell *self)
+{
+  PhoshShellPrivate *priv;
+
+  g_return_val_if_fail (PHOSH_IS_SHELL (self), NULL);
+  priv = phosh_shell_get_instance_private (self);
+
+  if (!priv->power_saver_manager) {
+    priv->power_saver_manager =
+      phosh_power_saver_manager_new (phosh_shell_get_battery_manager (self));
+  }
+
+  g_return_val_if_fail (PHOSH_IS_POWER_SAVER_MANAGER (priv->power_saver_manager), NULL);
+  return priv->power_saver_manager;
+}
+
 /**
  * phosh_shell_get_rotation_manager:
  * @self: The shell singleton
@@ -2315,54 +2811,28 @@ phosh_shell_get_wwan (PhoshShell *self)
  * @height:(out)(nullable): The height of the client usable area
  *
  * Gives the usable area in pixels usable by a client on the primary
- * display.
+ * display. The area is cached, connect to
+ * [signal@Shell::usable-area-changed] to get notified about changes.
  */
 void
 phosh_shell_get_usable_area (PhoshShell *self, int *x, int *y, int *width, int *height)
 {
-  PhoshMonitor *monitor;
-  PhoshMonitorMode *mode;
-  int w, h;
-  float scale;
+  PhoshShellPrivate *priv;
 
   g_return_if_fail (PHOSH_IS_SHELL (self));
+  priv = phosh_shell_get_instance_private (self);
 
-  monitor = phosh_shell_get_primary_monitor (self);
-  g_return_if_fail (monitor);
-  mode = phosh_monitor_get_current_mode (monitor);
-  g_return_if_fail (mode != NULL);
-
-  scale = MAX (1.0, phosh_monitor_get_fractional_scale (monitor));
-
-  g_debug ("Primary monitor %p scale is %f, mode: %dx%d, transform is %d",
-           monitor,
-           scale,
-           mode->width,
-           mode->height,
-           monitor->transform);
-
-  switch (phosh_monitor_get_transform (monitor)) {
-  case PHOSH_MONITOR_TRANSFORM_NORMAL:
-  case PHOSH_MONITOR_TRANSFORM_180:
-  case PHOSH_MONITOR_TRANSFORM_FLIPPED:
-  case PHOSH_MONITOR_TRANSFORM_FLIPPED_180:
-    w = mode->width / scale;
-    h = mode->height / scale - PHOSH_TOP_BAR_HEIGHT - PHOSH_HOME_BAR_HEIGHT;
-    break;
-  default:
-    w = mode->height / scale;
-    h = mode->width / scale - PHOSH_TOP_BAR_HEIGHT - PHOSH_HOME_BAR_HEIGHT;
-    break;
-  }
+  g_return_if_fail (priv->primary_monitor);
+  g_return_if_fail (ensure_usable_area (self));
 
   if (x)
-    *x = 0;
+    *x = priv->usable_area.x;
   if (y)
-    *y = PHOSH_TOP_BAR_HEIGHT;
+    *y = priv->usable_area.y;
   if (width)
-    *width = w;
+    *width = priv->usable_area.width;
   if (height)
-    *height = h;
+    *height = priv->usable_area.height;
 }
 
 /**
@@ -2815,18 +3285,30 @@ phosh_shell_show_osd (PhoshShell *self,
   g_debug ("DBus show osd: connector: %s icon: %s, label: %s, level %f/%f",
            connector, icon, label, level, max_level);
 
+  g_free (priv->osd_pending.connector);
+  priv->osd_pending.connector = g_strdup (connector);
+  g_free (priv->osd_pending.icon);
+  priv->osd_pending.icon = g_strdup (icon);
+  g_free (priv->osd_pending.label);
+  priv->osd_pending.label = g_strdup (label);
+  priv->osd_pending.level = level;
+  priv->osd_pending.max_level = max_level;
+
   if (priv->osd) {
     priv->osd_continue = TRUE;
-    g_object_set (priv->osd,
-                  "connector", connector,
-                  "label", label,
-                  "icon-name", icon,
-                  "level", level,
-                  "max-level", max_level,
-                  NULL);
+    /* Holding a key sends several requests per frame, only apply the last one */
+    if (!priv->osd_tick_id) {
+      priv->osd_tick_id = gtk_widget_add_tick_callback (GTK_WIDGET (priv->osd),
+                                                        on_osd_tick,
+                                                        self,
+                                                        NULL);
+    }
   } else {
-    priv->osd = PHOSH_OSD_WINDOW (phosh_osd_window_new (connector, label, icon, level, max_level));
-    g_signal_connect_swapped (priv->osd, "destroy", G_CALLBACK (on_osd_destroyed), self);
+    if (priv->primary_monitor == NULL)
+      return;
+
+    priv->osd = ensure_osd (self, priv->primary_monitor);
+    apply_osd_pending (self);
     gtk_widget_set_visible (GTK_WIDGET (priv->osd), TRUE);
   }
 
@@ -0,0 +1,263 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "phosh-source-stats"
+
+#include "phosh-config.h"
+
+#include "source-stats.h"
+
+/**
+ * PhoshSourceStats:
+ *
+ * Accounts main loop wakeups and dispatches per source name
+ *
+ * When enabled the default main context's poll function gets wrapped
+ * to count wakeups. Before each poll the sources attached since the
+ * last poll get their callback wrapped so dispatches and the time spent
+ * in them can be accounted by the source's name (see
+ * `g_source_set_name()`). Sources without a callback (e.g. GDK's event
+ * source) aren't accounted individually.
+ *
+ * This is meant for debugging and available via the `GetSourceStats`
+ * method of `mobi.phosh.Shell.DebugControl`.
+ */
+
+#define UNNAMED_SOURCE "(unnamed)"
+
+typedef struct {
+  guint64 dispatches;
+  gint64  time;
+  gint64  max_time;
+} PhoshSourceStat;
+
+/* A callback wrapped so its dispatches can be accounted */
+typedef struct {
+  gint                  ref_count;
+  GSourceCallbackFuncs *funcs;
+  gpointer              data;
+  /* Only valid while dispatching */
+  GSource              *source;
+  gint64                start;
+} PhoshWrappedCallback;
+
+static struct {
+  gboolean      enabled;
+  GPollFunc     poll_func;
+  guint         last_id;
+  guint64       wakeups;
+  /* key: source name, value: PhoshSourceStat */
+  GHashTable   *stats;
+} source_stats;
+
+
+static void
+wrapped_callback_ref (gpointer cb_data)
+{
+  PhoshWrappedCallback *wrapped = cb_data;
+
+  g_atomic_int_inc (&wrapped->ref_count);
+}
+
+
+static void
+wrapped_callback_unref (gpointer cb_data)
+{
+  PhoshWrappedCallback *wrapped = cb_data;
+
+  /* The dispatch is bracketed by get () and unref () */
+  if (wrapped->start) {
+    const char *name = g_source_get_name (wrapped->source) ?: UNNAMED_SOURCE;
+    gint64 elapsed = g_get_monotonic_time () - wrapped->start;
+    PhoshSourceStat *stat;
+
+    wrapped->start = 0;
+    wrapped->source = NULL;
+
+    stat = g_hash_table_lookup (source_stats.stats, name);
+    if (stat == NULL) {
+      stat = g_new0 (PhoshSourceStat, 1);
+      g_hash_table_insert (source_stats.stats, g_strdup (name), stat);
+    }
+    stat->dispatches++;
+    stat->time += elapsed;
+    stat->max_time = MAX (stat->max_time, elapsed);
+  }
+
+  if (g_atomic_int_dec_and_test (&wrapped->ref_count)) {
+    wrapped->funcs->unref (wrapped->data);
+    g_free (wrapped);
+  }
+}
+
+
+static void
+wrapped_callback_get (gpointer     cb_data,
+                      GSource     *source,
+                      GSourceFunc *func,
+                      gpointer    *data)
+{
+  PhoshWrappedCallback *wrapped = cb_data;
+
+  wrapped->funcs->get (wrapped->data, source, func, data);
+
+  if (source_stats.enabled && source_stats.stats) {
+    wrapped->source = source;
+    wrapped->start = g_get_monotonic_time ();
+  }
+}
+
+
+static GSourceCallbackFuncs wrapped_callback_funcs = {
+  .ref = wrapped_callback_ref,
+  .unref = wrapped_callback_unref,
+  .get = wrapped_callback_get,
+};
+
+
+static void
+wrap_source (GSource *source)
+{
+  PhoshWrappedCallback *wrapped;
+
+  if (source->callback_funcs == NULL || source->callback_funcs == &wrapped_callback_funcs)
+    return;
+
+  wrapped = g_new0 (PhoshWrappedCallback, 1);
+  wrapped->ref_count = 1;
+  wrapped->funcs = source->callback_funcs;
+  wrapped->data = source->callback_data;
+  /* Setting the new callback drops a ref on the old one, we keep it in the wrapper */
+  wrapped->funcs->ref (wrapped->data);
+
+  g_source_set_callback_indirect (source, wrapped, &wrapped_callback_funcs);
+}
+
+
+static void
+wrap_new_sources (void)
+{
+  g_autoptr (GSource) probe = g_idle_source_new ();
+  guint next_id;
+
+  /* Source ids are handed out in order, so this tells us what got added since the last poll */
+  next_id = g_source_attach (probe, NULL);
+  g_source_destroy (probe);
+
+  for (guint id = source_stats.last_id + 1; id < next_id; id++) {
+    GSource *source = g_main_context_find_source_by_id (NULL, id);
+
+    if (source)
+      wrap_source (source);
+  }
+  source_stats.last_id = next_id;
+}
+
+
+static int
+poll_func (GPollFD *ufds, guint nfds, int timeout)
+{
+  int ret;
+
+  wrap_new_sources ();
+
+  ret = source_stats.poll_func (ufds, nfds, timeout);
+  /* Polling with a zero timeout isn't a wakeup, we were busy anyway */
+  if (timeout != 0)
+    source_stats.wakeups++;
+
+  return ret;
+}
+
+/**
+ * phosh_source_stats_set_enabled:
+ * @enabled: Whether to account dispatches
+ *
+ * Enable or disable accounting. Stats collected so far are kept.
+ */
+void
+phosh_source_stats_set_enabled (gboolean enabled)
+{
+  enabled = !!enabled;
+  if (source_stats.enabled == enabled)
+    return;
+
+  source_stats.enabled = enabled;
+  g_debug ("%s source stats", enabled ? "Enabling" : "Disabling");
+
+  if (enabled) {
+    if (source_stats.stats == NULL)
+      source_stats.stats = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+
+    source_stats.poll_func = g_main_context_get_poll_func (NULL);
+    g_main_context_set_poll_func (NULL, poll_func);
+  } else {
+    /* Wrapped callbacks stay wrapped but only account while enabled */
+    g_main_context_set_poll_func (NULL, source_stats.poll_func);
+    source_stats.poll_func = NULL;
+  }
+}
+
+
+gboolean
+phosh_source_stats_get_enabled (void)
+{
+  return source_stats.enabled;
+}
+
+/**
+ * phosh_source_stats_reset:
+ *
+ * Clear the collected stats.
+ */
+void
+phosh_source_stats_reset (void)
+{
+  source_stats.wakeups = 0;
+  if (source_stats.stats)
+    g_hash_table_remove_all (source_stats.stats);
+}
+
+/**
+ * phosh_source_stats_get:
+ * @wakeups: (out): Return location for the number of main loop wakeups
+ *
+ * Get the collected stats. Keys are source names, values a dictionary
+ * with the number of dispatches ("dispatches"), the total time spent
+ * ("time") and the longest dispatch ("max-time"). Times are in
+ * microseconds.
+ *
+ * Returns:(transfer floating): The stats as `a{sa{sv}}`
+ */
+GVariant *
+phosh_source_stats_get (guint64 *wakeups)
+{
+  GVariantBuilder builder;
+  GHashTableIter iter;
+  gpointer key, value;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sa{sv}}"));
+
+  if (wakeups)
+    *wakeups = source_stats.wakeups;
+
+  if (source_stats.stats == NULL)
+    return g_variant_builder_end (&builder);
+
+  g_hash_table_iter_init (&iter, source_stats.stats);
+  while (g_hash_table_iter_next (&iter, &key, &value)) {
+    PhoshSourceStat *stat = value;
+    GVariantBuilder props;
+
+    g_variant_builder_init (&props, G_VARIANT_TYPE_VARDICT);
+    g_variant_builder_add (&props, "{sv}", "dispatches", g_variant_new_uint64 (stat->dispatches));
+    g_variant_builder_add (&props, "{sv}", "time", g_variant_new_int64 (stat->time));
+    g_variant_builder_add (&props, "{sv}", "max-time", g_variant_new_int64 (stat->max_time));
+    g_variant_builder_add (&builder, "{sa{sv}}", key, &props);
+  }
+
+  return g_variant_builder_end (&builder);
+}
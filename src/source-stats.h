@@ -0,0 +1,18 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+void      phosh_source_stats_set_enabled (gboolean enabled);
+gboolean  phosh_source_stats_get_enabled (void);
+void      phosh_source_stats_reset       (void);
+GVariant *phosh_source_stats_get         (guint64 *wakeups);
+
+G_END_DECLS
@@ -10,18 +10,31 @@
 
 #include "phosh-config.h"
 
+#include "favorite-list-model.h"
+#include "icon-cache.h"
+#include "monitor.h"
 #include "shell-priv.h"
 #include "splash.h"
 #include "splash-manager.h"
+#include "util.h"
 
 #include <gtk/gtk.h>
 
+#include <math.h>
+
+/* Must match the icon's pixel-size in splash.ui */
+#define SPLASH_ICON_SIZE 192
+#define N_RECENT_APPS 5
+
 /**
  * PhoshSplashManager:
  *
  * Handles splash screens
  *
  * Spawns, keeps track and closes splash screens.
+ *
+ * To have the splash up quickly the icons of favorite and recently
+ * launched apps are rendered ahead of time when the shell is idle.
  */
 
 enum {
@@ -39,6 +52,15 @@ struct _PhoshSplashManager {
 
   GSettings       *interface_settings;
   gboolean         prefer_dark;
+
+  /* app id → cairo_surface_t */
+  GHashTable      *icons;
+  int              icon_scale;
+  /* Most recently launched app ids first */
+  GQueue           recent;
+  /* GAppInfo to prerender the icons for */
+  GQueue           pending;
+  guint            prerender_id;
 };
 G_DEFINE_TYPE (PhoshSplashManager, phosh_splash_manager, G_TYPE_OBJECT)
 
@@ -81,6 +103,171 @@ phosh_splash_manager_get_property (GObject    *object,
 }
 
 
+static int
+get_icon_scale (void)
+{
+  PhoshMonitor *monitor = phosh_shell_get_primary_monitor (phosh_shell_get_default ());
+
+  if (monitor == NULL)
+    return 1;
+
+  return (int) ceilf (phosh_monitor_get_fractional_scale (monitor));
+}
+
+
+static cairo_surface_t *
+render_icon (GAppInfo *info, int scale)
+{
+  g_autoptr (GIcon) icon = NULL;
+  g_autoptr (GdkPixbuf) pixbuf = NULL;
+  g_autoptr (GError) err = NULL;
+  GtkIconInfo *icon_info;
+
+  icon = phosh_util_get_app_icon (info);
+  icon_info = phosh_icon_cache_lookup (phosh_icon_cache_get_default (),
+                                       icon,
+                                       SPLASH_ICON_SIZE,
+                                       scale);
+  if (icon_info == NULL)
+    return NULL;
+
+  pixbuf = gtk_icon_info_load_icon (icon_info, &err);
+  if (pixbuf == NULL) {
+    g_debug ("Failed to load icon for %s: %s", g_app_info_get_id (info), err->message);
+    return NULL;
+  }
+
+  return gdk_cairo_surface_create_from_pixbuf (pixbuf, scale, NULL);
+}
+
+
+static gboolean
+on_prerender_idle (gpointer data)
+{
+  PhoshSplashManager *self = PHOSH_SPLASH_MANAGER (data);
+  g_autoptr (GAppInfo) info = g_queue_pop_head (&self->pending);
+  cairo_surface_t *surface;
+  const char *app_id = g_app_info_get_id (info);
+
+  /* One icon per main loop iteration to not delay any input */
+  if (!g_hash_table_contains (self->icons, app_id)) {
+    surface = render_icon (info, self->icon_scale);
+    if (surface) {
+      g_debug ("Prerendered splash icon for %s", app_id);
+      g_hash_table_insert (self->icons, g_strdup (app_id), surface);
+    }
+  }
+
+  if (!g_queue_is_empty (&self->pending))
+    return G_SOURCE_CONTINUE;
+
+  self->prerender_id = 0;
+  return G_SOURCE_REMOVE;
+}
+
+
+static void
+queue_prerender (PhoshSplashManager *self, GAppInfo *info)
+{
+  const char *app_id = g_app_info_get_id (info);
+
+  if (app_id == NULL || g_hash_table_contains (self->icons, app_id))
+    return;
+
+  g_queue_push_tail (&self->pending, g_object_ref (info));
+
+  if (self->prerender_id)
+    return;
+
+  self->prerender_id = g_idle_add_full (G_PRIORITY_LOW, on_prerender_idle, self, NULL);
+  g_source_set_name_by_id (self->prerender_id, "[phosh] splash prerender");
+}
+
+
+static gboolean
+is_wanted (PhoshSplashManager *self, const char *app_id)
+{
+  GListModel *favorites = G_LIST_MODEL (phosh_favorite_list_model_get_default ());
+
+  if (g_queue_find_custom (&self->recent, app_id, (GCompareFunc) g_strcmp0))
+    return TRUE;
+
+  for (guint i = 0; i < g_list_model_get_n_items (favorites); i++) {
+    g_autoptr (GAppInfo) info = g_list_model_get_item (favorites, i);
+
+    if (g_strcmp0 (g_app_info_get_id (info), app_id) == 0)
+      return TRUE;
+  }
+
+  return FALSE;
+}
+
+
+static void
+prerender_all (PhoshSplashManager *self)
+{
+  GListModel *favorites = G_LIST_MODEL (phosh_favorite_list_model_get_default ());
+  GHashTableIter iter;
+  const char *app_id;
+
+  /* Drop icons of apps that are neither favorites nor recent anymore */
+  g_hash_table_iter_init (&iter, self->icons);
+  while (g_hash_table_iter_next (&iter, (gpointer *)&app_id, NULL)) {
+    if (!is_wanted (self, app_id))
+      g_hash_table_iter_remove (&iter);
+  }
+
+  for (guint i = 0; i < g_list_model_get_n_items (favorites); i++) {
+    g_autoptr (GAppInfo) info = g_list_model_get_item (favorites, i);
+
+    queue_prerender (self, info);
+  }
+
+  for (GList *l = self->recent.head; l; l = l->next) {
+    g_autoptr (GDesktopAppInfo) info = g_desktop_app_info_new (l->data);
+
+    if (info)
+      queue_prerender (self, G_APP_INFO (info));
+  }
+}
+
+
+static void
+flush_icons (PhoshSplashManager *self)
+{
+  g_debug ("Flushing prerendered splash icons");
+
+  g_hash_table_remove_all (self->icons);
+  self->icon_scale = get_icon_scale ();
+  prerender_all (self);
+}
+
+
+static void
+add_recent (PhoshSplashManager *self, GDesktopAppInfo *info)
+{
+  const char *app_id = g_app_info_get_id (G_APP_INFO (info));
+  GList *link;
+
+  link = g_queue_find_custom (&self->recent, app_id, (GCompareFunc) g_strcmp0);
+  if (link) {
+    g_queue_unlink (&self->recent, link);
+    g_queue_push_head_link (&self->recent, link);
+    return;
+  }
+
+  g_queue_push_head (&self->recent, g_strdup (app_id));
+  if (g_queue_get_length (&self->recent) > N_RECENT_APPS) {
+    g_autofree char *oldest = g_queue_pop_tail (&self->recent);
+
+    if (!is_wanted (self, oldest))
+      g_hash_table_remove (self->icons, oldest);
+  }
+
+  queue_prerender (self, G_APP_INFO (info));
+}
+
+
 static void
 on_splash_closed (PhoshSplashManager *self, GtkWidget *splash)
 {
@@ -159,6 +346,7 @@ on_app_launch_started (PhoshSplashManager *self,
 {
   GtkWidget *splash;
   char *key;
+  cairo_surface_t *icon;
   PhoshShell *shell = phosh_shell_get_default ();
 
   g_return_if_fail (PHOSH_IS_SPLASH_MANAGER (self));
@@ -171,7 +359,13 @@ on_app_launch_started (PhoshSplashManager *self,
 
   g_debug ("Adding splash for %s, startup_id %s", g_app_info_get_id (G_APP_INFO (info)),
            startup_id);
+  if (self->icon_scale != get_icon_scale ())
+    flush_icons (self);
+
   splash = phosh_splash_new (info, self->prefer_dark);
+  icon = g_hash_table_lookup (self->icons, g_app_info_get_id (G_APP_INFO (info)));
+  if (icon)
+    phosh_splash_set_icon (PHOSH_SPLASH (splash), icon);
   key = g_strdup (startup_id);
   g_hash_table_insert (self->splashes, key, splash);
   g_signal_connect_object (splash, "closed", G_CALLBACK (on_splash_closed),
@@ -179,6 +373,8 @@ on_app_launch_started (PhoshSplashManager *self,
   /* Keep startup-id for close triggered by splash itself */
   g_object_set_data (G_OBJECT (splash), "startup-id", key);
   gtk_window_present (GTK_WINDOW (splash));
+
+  add_recent (self, info);
 }
 
 
@@ -202,6 +398,18 @@ phosh_splash_manager_constructed (GObject *object)
                     "swapped-signal::app-failed", G_CALLBACK (on_app_failed), self,
                     "swapped-signal::app-ready", G_CALLBACK (on_app_ready), self,
                     NULL);
+
+  g_signal_connect_object (phosh_favorite_list_model_get_default (),
+                           "items-changed",
+                           G_CALLBACK (prerender_all),
+                           self,
+                           G_CONNECT_SWAPPED);
+  g_signal_connect_object (gtk_icon_theme_get_default (),
+                           "changed",
+                           G_CALLBACK (flush_icons),
+                           self,
+                           G_CONNECT_SWAPPED);
+  flush_icons (self);
 }
 
 
@@ -210,6 +418,9 @@ phosh_splash_manager_dispose (GObject *object)
 {
   PhoshSplashManager *self = PHOSH_SPLASH_MANAGER (object);
 
+  g_clear_handle_id (&self->prerender_id, g_source_remove);
+  g_queue_clear_full (&self->pending, g_object_unref);
+  g_queue_clear_full (&self->recent, g_free);
   g_clear_object (&self->interface_settings);
   g_clear_object (&self->app_tracker);
 
@@ -223,6 +434,7 @@ phosh_splash_manager_finalize (GObject *object)
   PhoshSplashManager *self = PHOSH_SPLASH_MANAGER (object);
 
   g_clear_pointer (&self->splashes, g_hash_table_destroy);
+  g_clear_pointer (&self->icons, g_hash_table_destroy);
 
   G_OBJECT_CLASS (phosh_splash_manager_parent_class)->finalize (object);
 }
@@ -255,6 +467,13 @@ phosh_splash_manager_init (PhoshSplashManager *self)
                                           g_str_equal,
                                           g_free,
                                           (GDestroyNotify) phosh_splash_hide);
+  self->icons = g_hash_table_new_full (g_str_hash,
+                                       g_str_equal,
+                                       g_free,
+                                       (GDestroyNotify) cairo_surface_destroy);
+  self->icon_scale = 1;
+  g_queue_init (&self->recent);
+  g_queue_init (&self->pending);
 
   self->interface_settings = g_settings_new ("org.gnome.desktop.interface");
   g_signal_connect_swapped (self->interface_settings,
@@ -51,6 +51,7 @@ typedef struct {
   GtkWidget                  *box;
   GIcon                      *icon;
   GtkWidget                  *img_app;
+  cairo_surface_t            *icon_surface;
   gboolean                    prefer_dark;
 
   PhoshAnimation             *fadeout;
@@ -132,6 +133,7 @@ phosh_splash_dispose (GObject *obj)
 
   g_clear_pointer (&priv->fadeout, phosh_animation_unref);
   g_clear_object (&priv->info);
+  g_clear_pointer (&priv->icon_surface, cairo_surface_destroy);
 
   G_OBJECT_CLASS (phosh_splash_parent_class)->dispose (obj);
 }
@@ -193,6 +195,12 @@ phosh_splash_show (GtkWidget *widget)
   PhoshSplashPrivate *priv = phosh_splash_get_instance_private (self);
   GIcon *icon;
 
+  if (priv->icon_surface) {
+    gtk_image_set_from_surface (GTK_IMAGE (priv->img_app), priv->icon_surface);
+    GTK_WIDGET_CLASS (phosh_splash_parent_class)->show (widget);
+    return;
+  }
+
   icon = g_app_info_get_icon (priv->info);
   if (G_UNLIKELY (icon == NULL)) {
     gtk_image_set_from_icon_name (GTK_IMAGE (priv->img_app),
@@ -279,6 +287,29 @@ phosh_splash_new (GDesktopAppInfo *info, gboolean prefer_dark)
 }
 
 
+/**
+ * phosh_splash_set_icon:
+ * @self: The splash
+ * @surface: The already rendered icon
+ *
+ * Use the given icon instead of looking up the app's icon when the
+ * splash is shown. The surface must match the icon size and the
+ * monitor's scale.
+ */
+void
+phosh_splash_set_icon (PhoshSplash *self, cairo_surface_t *surface)
+{
+  PhoshSplashPrivate *priv;
+
+  g_return_if_fail (PHOSH_IS_SPLASH (self));
+  priv = phosh_splash_get_instance_private (self);
+
+  g_clear_pointer (&priv->icon_surface, cairo_surface_destroy);
+  if (surface)
+    priv->icon_surface = cairo_surface_reference (surface);
+}
+
+
 static void
 fadeout_value_cb (double value, gpointer data)
 {
@@ -28,3 +28,4 @@ GtkWidget *phosh_splash_new (GDesktopAppInfo *info, gboolean prefer_dark);
 void phosh_splash_hide (PhoshSplash *self);
 void phosh_splash_lower (PhoshSplash *self);
 void phosh_splash_raise (PhoshSplash *self);
+void phosh_splash_set_icon (PhoshSplash *self, cairo_surface_t *surface);
@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "phosh-startup-timeline"
+
+#include "phosh-config.h"
+
+#include "startup-timeline.h"
+
+#include <unistd.h>
+
+#define STARTUP_TRACE_ENV "PHOSH_STARTUP_TRACE"
+
+/**
+ * PhoshStartupTimeline:
+ *
+ * Records what happens during shell startup
+ *
+ * Records monotonic timestamps of startup phases (manager creation,
+ * idle init, first frame of layer surfaces, …) until the shell's
+ * startup finished. The timeline can be exported in the Trace Event
+ * format understood by e.g. Perfetto's UI or `chrome://tracing`. It
+ * is available via the `GetStartupTimeline` method of
+ * `mobi.phosh.Shell.DebugControl` and written to the file given in
+ * `PHOSH_STARTUP_TRACE` (if set) when startup finished.
+ */
+
+typedef struct {
+  char   *name;
+  gint64  start;
+  gint64  end;                  /* -1 for instant events */
+} PhoshStartupEvent;
+
+
+static GArray *events;
+static gint64 last_step;
+static gboolean finished;
+
+
+static void
+clear_event (gpointer data)
+{
+  PhoshStartupEvent *event = data;
+
+  g_free (event->name);
+}
+
+
+static void
+add_event (const char *name, gint64 start, gint64 end)
+{
+  PhoshStartupEvent event;
+
+  if (finished)
+    return;
+
+  if (G_UNLIKELY (events == NULL)) {
+    events = g_array_sized_new (FALSE, FALSE, sizeof (PhoshStartupEvent), 64);
+    g_array_set_clear_func (events, clear_event);
+  }
+
+  event = (PhoshStartupEvent) {
+    .name = g_strdup (name),
+    .start = start,
+    .end = end,
+  };
+  g_array_append_val (events, event);
+}
+
+/**
+ * phosh_startup_timeline_mark:
+ * @name: The name of the event
+ *
+ * Records an instant event. This also starts a new step, see
+ * [func@startup_timeline_step].
+ */
+void
+phosh_startup_timeline_mark (const char *name)
+{
+  gint64 now = g_get_monotonic_time ();
+
+  add_event (name, now, -1);
+  last_step = now;
+}
+
+/**
+ * phosh_startup_timeline_step:
+ * @name: The name of the step
+ *
+ * Records a span from the last mark or step until now. Useful to
+ * time a sequence of operations.
+ */
+void
+phosh_startup_timeline_step (const char *name)
+{
+  gint64 now = g_get_monotonic_time ();
+
+  add_event (name, last_step ?: now, now);
+  last_step = now;
+}
+
+/**
+ * phosh_startup_timeline_add_span:
+ * @name: The name of the span
+ * @start: The monotonic start time of the span
+ *
+ * Records a span from @start until now.
+ */
+void
+phosh_startup_timeline_add_span (const char *name, gint64 start)
+{
+  add_event (name, start, g_get_monotonic_time ());
+}
+
+/**
+ * phosh_startup_timeline_is_active:
+ *
+ * Returns: %TRUE if the timeline still records events
+ */
+gboolean
+phosh_startup_timeline_is_active (void)
+{
+  return !finished;
+}
+
+/**
+ * phosh_startup_timeline_finish:
+ *
+ * Stops recording. If `PHOSH_STARTUP_TRACE` is set the timeline
+ * is written to the file it points to.
+ */
+void
+phosh_startup_timeline_finish (void)
+{
+  g_autoptr (GError) err = NULL;
+  g_autofree char *json = NULL;
+  const char *path;
+
+  if (finished)
+    return;
+
+  phosh_startup_timeline_mark ("startup-finished");
+  finished = TRUE;
+
+  path = g_getenv (STARTUP_TRACE_ENV);
+  if (!path || !path[0])
+    return;
+
+  json = phosh_startup_timeline_to_json ();
+  if (!g_file_set_contents (path, json, -1, &err))
+    g_warning ("Failed to write startup trace to '%s': %s", path, err->message);
+  else
+    g_debug ("Wrote startup trace to '%s'", path);
+}
+
+/**
+ * phosh_startup_timeline_to_json:
+ *
+ * Get the recorded events in the Trace Event JSON format.
+ *
+ * Returns:(transfer full): The timeline as JSON
+ */
+char *
+phosh_startup_timeline_to_json (void)
+{
+  GString *json = g_string_new ("{\"traceEvents\":[");
+  int pid = getpid ();
+
+  for (guint i = 0; events && i < events->len; i++) {
+    PhoshStartupEvent *event = &g_array_index (events, PhoshStartupEvent, i);
+    g_autofree char *name = g_strescape (event->name, NULL);
+
+    if (i)
+      g_string_append_c (json, ',');
+
+    g_string_append_printf (json, "{\"name\":\"%s\",\"cat\":\"startup\",\"pid\":%d,\"tid\":%d,"
+                            "\"ts\":%" G_GINT64_FORMAT,
+                            name, pid, pid, event->start);
+    if (event->end < 0) {
+      g_string_append (json, ",\"ph\":\"i\",\"s\":\"p\"}");
+    } else {
+      g_string_append_printf (json, ",\"ph\":\"X\",\"dur\":%" G_GINT64_FORMAT "}",
+                              event->end - event->start);
+    }
+  }
+
+  g_string_append (json, "]}");
+  return g_string_free (json, FALSE);
+}
@@ -0,0 +1,20 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+void      phosh_startup_timeline_mark      (const char *name);
+void      phosh_startup_timeline_step      (const char *name);
+void      phosh_startup_timeline_add_span  (const char *name, gint64 start);
+void      phosh_startup_timeline_finish    (void);
+gboolean  phosh_startup_timeline_is_active (void);
+char     *phosh_startup_timeline_to_json   (void);
+
+G_END_DECLS
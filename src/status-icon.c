@@ -44,12 +44,89 @@ typedef struct {
   guint        pixel_size;
   char        *info;
   int          priority;
+  char        *icon_name;
+  gboolean     icon_dirty;
+  guint        tick_id;
 
   guint       idle_id;
 } PhoshStatusIconPrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (PhoshStatusIcon, phosh_status_icon, GTK_TYPE_BIN);
 
+/* "icon-name:size:scale" → GtkIconInfo, keeps the theme's lookups hot */
+static GHashTable *icon_infos;
+
+
+static void
+icon_info_unref (gpointer data)
+{
+  if (data)
+    g_object_unref (data);
+}
+
+
+static void
+on_icon_theme_changed (GtkIconTheme *theme)
+{
+  g_hash_table_remove_all (icon_infos);
+}
+
+
+static void
+memoize_icon_info (PhoshStatusIcon *self)
+{
+  PhoshStatusIconPrivate *priv = phosh_status_icon_get_instance_private (self);
+  GtkWidget *widget = GTK_WIDGET (self);
+  GtkIconLookupFlags flags = GTK_ICON_LOOKUP_USE_BUILTIN | GTK_ICON_LOOKUP_FORCE_SIZE;
+  GtkIconTheme *theme;
+  GtkIconInfo *info;
+  g_autofree char *key = NULL;
+  int scale;
+
+  if (priv->icon_name == NULL || priv->pixel_size == 0)
+    return;
+
+  scale = gtk_widget_get_scale_factor (widget);
+  key = g_strdup_printf ("%s:%u:%d", priv->icon_name, priv->pixel_size, scale);
+  if (g_hash_table_contains (icon_infos, key))
+    return;
+
+  if (gtk_widget_get_direction (widget) == GTK_TEXT_DIR_RTL)
+    flags |= GTK_ICON_LOOKUP_DIR_RTL;
+  else
+    flags |= GTK_ICON_LOOKUP_DIR_LTR;
+
+  theme = gtk_icon_theme_get_for_screen (gtk_widget_get_screen (widget));
+  info = gtk_icon_theme_lookup_icon_for_scale (theme, priv->icon_name, priv->pixel_size,
+                                               scale, flags);
+  /* Remember misses too so we don't look them up over and over */
+  g_hash_table_insert (icon_infos, g_steal_pointer (&key), info);
+}
+
+
+static void
+update_image (PhoshStatusIcon *self)
+{
+  PhoshStatusIconPrivate *priv = phosh_status_icon_get_instance_private (self);
+
+  priv->icon_dirty = FALSE;
+  memoize_icon_info (self);
+  gtk_image_set_from_icon_name (GTK_IMAGE (priv->image), priv->icon_name, -1);
+}
+
+
+static gboolean
+on_tick (GtkWidget *widget, GdkFrameClock *frame_clock, gpointer user_data)
+{
+  PhoshStatusIcon *self = PHOSH_STATUS_ICON (widget);
+  PhoshStatusIconPrivate *priv = phosh_status_icon_get_instance_private (self);
+
+  priv->tick_id = 0;
+  update_image (self);
+
+  return G_SOURCE_REMOVE;
+}
+
 
 static void
 phosh_status_icon_set_property (GObject      *object,
@@ -170,6 +247,7 @@ phosh_status_icon_finalize (GObject *gobject)
     phosh_status_icon_get_instance_private (PHOSH_STATUS_ICON (gobject));
 
   g_clear_pointer (&priv->info, g_free);
+  g_clear_pointer (&priv->icon_name, g_free);
 
   G_OBJECT_CLASS (phosh_status_icon_parent_class)->finalize (gobject);
 }
@@ -185,6 +263,35 @@ phosh_status_icon_destroy (GtkWidget *widget)
   GTK_WIDGET_CLASS (phosh_status_icon_parent_class)->destroy (widget);
 }
 
+
+static void
+phosh_status_icon_map (GtkWidget *widget)
+{
+  PhoshStatusIcon *self = PHOSH_STATUS_ICON (widget);
+  PhoshStatusIconPrivate *priv = phosh_status_icon_get_instance_private (self);
+
+  /* Catch up on icon changes that happened while unmapped */
+  if (priv->icon_dirty)
+    update_image (self);
+
+  GTK_WIDGET_CLASS (phosh_status_icon_parent_class)->map (widget);
+}
+
+
+static void
+phosh_status_icon_unmap (GtkWidget *widget)
+{
+  PhoshStatusIcon *self = PHOSH_STATUS_ICON (widget);
+  PhoshStatusIconPrivate *priv = phosh_status_icon_get_instance_private (self);
+
+  if (priv->tick_id) {
+    gtk_widget_remove_tick_callback (widget, priv->tick_id);
+    priv->tick_id = 0;
+  }
+
+  GTK_WIDGET_CLASS (phosh_status_icon_parent_class)->unmap (widget);
+}
+
 static void
 phosh_status_icon_class_init (PhoshStatusIconClass *klass)
 {
@@ -198,6 +305,8 @@ phosh_status_icon_class_init (PhoshStatusIconClass *klass)
   object_class->finalize = phosh_status_icon_finalize;
 
   widget_class->destroy = phosh_status_icon_destroy;
+  widget_class->map = phosh_status_icon_map;
+  widget_class->unmap = phosh_status_icon_unmap;
 
   gtk_widget_class_set_css_name (widget_class, "phosh-status-icon");
 
@@ -268,6 +377,11 @@ phosh_status_icon_class_init (PhoshStatusIconClass *klass)
 
   gtk_widget_class_bind_template_child_private (widget_class, PhoshStatusIcon, box);
   gtk_widget_class_bind_template_child_private (widget_class, PhoshStatusIcon, image);
+
+  icon_infos = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                      icon_info_unref);
+  g_signal_connect (gtk_icon_theme_get_default (), "changed",
+                    G_CALLBACK (on_icon_theme_changed), NULL);
 }
 
 
@@ -291,21 +405,33 @@ phosh_status_icon_new (void)
 }
 
 
+/**
+ * phosh_status_icon_set_icon_name:
+ * @self: The status-icon
+ * @icon_name: (nullable): The icon name
+ *
+ * Set the icon name. Setting the same icon name again is cheap. The icon is
+ * updated at most once per frame and not at all while the status icon
+ * isn't mapped so it's fine to call this on every property change.
+ */
 void
 phosh_status_icon_set_icon_name (PhoshStatusIcon *self, const char *icon_name)
 {
   PhoshStatusIconPrivate *priv;
-  g_autofree char *old_icon_name = NULL;
 
   g_return_if_fail (PHOSH_IS_STATUS_ICON (self));
 
   priv = phosh_status_icon_get_instance_private (self);
 
-  old_icon_name = phosh_status_icon_get_icon_name (self);
-  if (!g_strcmp0 (old_icon_name, icon_name))
+  if (!g_strcmp0 (priv->icon_name, icon_name))
     return;
 
-  gtk_image_set_from_icon_name (GTK_IMAGE (priv->image), icon_name, -1);
+  g_free (priv->icon_name);
+  priv->icon_name = g_strdup (icon_name);
+  priv->icon_dirty = TRUE;
+
+  if (gtk_widget_get_mapped (GTK_WIDGET (self)) && priv->tick_id == 0)
+    priv->tick_id = gtk_widget_add_tick_callback (GTK_WIDGET (self), on_tick, NULL, NULL);
 
   g_object_notify_by_pspec (G_OBJECT (self), props[PHOSH_STATUS_ICON_PROP_ICON_NAME]);
 }
@@ -315,15 +441,12 @@ char *
 phosh_status_icon_get_icon_name (PhoshStatusIcon *self)
 {
   PhoshStatusIconPrivate *priv;
-  char *icon_name;
 
   g_return_val_if_fail (PHOSH_IS_STATUS_ICON (self), 0);
 
   priv = phosh_status_icon_get_instance_private (self);
 
-  g_object_get (priv->image, "icon-name", &icon_name, NULL);
-
-  return icon_name;
+  return g_strdup (priv->icon_name);
 }
 
 /**
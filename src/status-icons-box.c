@@ -330,8 +330,12 @@ on_priority_changed (PhoshStatusIconsBox *self, GParamSpec *spec, PhoshStatusIco
     else high = mid;
   }
 
-  g_debug ("%p: Reordering %p from %d to %d", self, revealer, i, low);
   g_ptr_array_insert (self->children, low, revealer);
+  /* Frequent priority updates mostly don't change the order */
+  if (low == i)
+    return;
+
+  g_debug ("%p: Reordering %p from %d to %d", self, revealer, i, low);
   gtk_widget_queue_resize (GTK_WIDGET (self));
 }
 
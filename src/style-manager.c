@@ -31,11 +31,21 @@
 #define ACCENT_COLOR_SLATE      "#6f8396"
 #define ACCENT_COLOR_FOREGROUND "#ffffff"
 
+#define COMMON_STYLESHEET       "/mobi/phosh/stylesheet/common.css"
+
 /**
  * PhoshStyleManager:
  *
  * The style manager is responsible for picking style sheets and
  * themes and notifying other parts of the shell about changes.
+ *
+ * The shell's rules are loaded once. Theme variants only define the
+ * named colors (and a few extra rules) used by them so switching
+ * themes doesn't need to parse all the rules again. Accent colors
+ * are named colors too and are updated in place.
+ *
+ * Parsed theme variants are kept around so switching back and forth
+ * (e.g. by automatic high contrast) only swaps providers.
  */
 
 enum {
@@ -50,71 +60,71 @@ struct _PhoshStyleManager {
   GObject         parent;
 
   char           *theme_name;
+  GtkCssProvider *common_css_provider;
+  /* The active variant, owned by css_providers */
   GtkCssProvider *css_provider;
+  GHashTable     *css_providers;
   GtkCssProvider *accent_css_provider;
+  const char     *accent_color;
 
   GSettings      *interface_settings;
 };
 G_DEFINE_TYPE (PhoshStyleManager, phosh_style_manager, G_TYPE_OBJECT)
 
 
-static void
-on_accent_color_changed (PhoshStyleManager *self)
+static const char *
+get_accent_color (PhoshStyleManager *self)
 {
-  const char *color;
-  g_autofree char *css  = NULL;
-  g_autoptr (GtkCssProvider) provider = gtk_css_provider_new ();
-
-  if (self->accent_css_provider) {
-    gtk_style_context_remove_provider_for_screen (gdk_screen_get_default (),
-                                                  GTK_STYLE_PROVIDER (self->accent_css_provider));
-  }
-
   /* Only enable accent colors on Adwaita */
   if (g_strcmp0 (self->theme_name, "Adwaita") != 0)
-    return;
+    return NULL;
 
   switch (g_settings_get_enum (self->interface_settings, IF_KEY_ACCENT_COLOR)) {
   case G_DESKTOP_ACCENT_COLOR_TEAL:
-    color = ACCENT_COLOR_TEAL;
-    break;
+    return ACCENT_COLOR_TEAL;
   case G_DESKTOP_ACCENT_COLOR_GREEN:
-    color = ACCENT_COLOR_GREEN;
-    break;
+    return ACCENT_COLOR_GREEN;
   case G_DESKTOP_ACCENT_COLOR_YELLOW:
-    color = ACCENT_COLOR_YELLOW;
-    break;
+    return ACCENT_COLOR_YELLOW;
   case G_DESKTOP_ACCENT_COLOR_ORANGE:
-    color = ACCENT_COLOR_ORANGE;
-    break;
+    return ACCENT_COLOR_ORANGE;
   case G_DESKTOP_ACCENT_COLOR_RED:
-    color = ACCENT_COLOR_RED;
-    break;
+    return ACCENT_COLOR_RED;
   case G_DESKTOP_ACCENT_COLOR_PINK:
-    color = ACCENT_COLOR_PINK;
-    break;
+    return ACCENT_COLOR_PINK;
   case G_DESKTOP_ACCENT_COLOR_PURPLE:
-    color = ACCENT_COLOR_PURPLE;
-    break;
+    return ACCENT_COLOR_PURPLE;
   case G_DESKTOP_ACCENT_COLOR_SLATE:
-    color = ACCENT_COLOR_SLATE;
-    break;
+    return ACCENT_COLOR_SLATE;
   case G_DESKTOP_ACCENT_COLOR_BLUE:
   default:
-    color = ACCENT_COLOR_BLUE;
+    return ACCENT_COLOR_BLUE;
   }
+}
 
-  g_debug ("Setting accent bg color to %s, accent fg color to %s",
-           color, ACCENT_COLOR_FOREGROUND);
 
-  css = g_strdup_printf ("@define-color theme_selected_bg_color %s;\n"
-                         "@define-color theme_selected_fg_color %s;",
-                         color, ACCENT_COLOR_FOREGROUND);
-  gtk_css_provider_load_from_data (provider, css, -1, NULL);
-  gtk_style_context_add_provider_for_screen (gdk_screen_get_default (),
-                                             GTK_STYLE_PROVIDER (provider),
-                                             GTK_STYLE_PROVIDER_PRIORITY_APPLICATION + 1);
-  g_set_object (&self->accent_css_provider, provider);
+static void
+on_accent_color_changed (PhoshStyleManager *self)
+{
+  const char *color = get_accent_color (self);
+  g_autofree char *css  = NULL;
+
+  /* Every reload restyles all widgets so avoid needless ones */
+  if (g_strcmp0 (self->accent_color, color) == 0)
+    return;
+  self->accent_color = color;
+
+  if (color) {
+    g_debug ("Setting accent bg color to %s, accent fg color to %s",
+             color, ACCENT_COLOR_FOREGROUND);
+
+    css = g_strdup_printf ("@define-color theme_selected_bg_color %s;\n"
+                           "@define-color theme_selected_fg_color %s;",
+                           color, ACCENT_COLOR_FOREGROUND);
+  }
+
+  /* Update in place so there's only a single style invalidation */
+  gtk_css_provider_load_from_data (self->accent_css_provider, css ?: "", -1, NULL);
 }
 
 
@@ -123,28 +133,36 @@ on_gtk_theme_name_changed (PhoshStyleManager *self, GParamSpec *pspec, GtkSettin
 {
   const char *style;
   g_autofree char *name = NULL;
-  g_autoptr (GtkCssProvider) provider = gtk_css_provider_new ();
+  GtkCssProvider *provider;
 
   g_object_get (settings, "gtk-theme-name", &name, NULL);
 
   if (g_strcmp0 (self->theme_name, name) == 0)
     return;
 
+  g_free (self->theme_name);
   self->theme_name = g_steal_pointer (&name);
   g_debug ("GTK theme: %s", self->theme_name);
 
-  if (self->css_provider) {
-    gtk_style_context_remove_provider_for_screen (gdk_screen_get_default (),
-                                                  GTK_STYLE_PROVIDER (self->css_provider));
-  }
-
   style = phosh_style_manager_get_stylesheet (self->theme_name);
+  provider = g_hash_table_lookup (self->css_providers, style);
+  if (provider == NULL) {
+    provider = gtk_css_provider_new ();
+    gtk_css_provider_load_from_resource (provider, style);
+    g_hash_table_insert (self->css_providers, (gpointer) style, provider);
+  }
 
-  gtk_css_provider_load_from_resource (provider, style);
-  gtk_style_context_add_provider_for_screen (gdk_screen_get_default (),
-                                             GTK_STYLE_PROVIDER (provider),
-                                             GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
-  g_set_object (&self->css_provider, provider);
+  /* Different theme names can use the same variant */
+  if (provider != self->css_provider) {
+    if (self->css_provider) {
+      gtk_style_context_remove_provider_for_screen (gdk_screen_get_default (),
+                                                    GTK_STYLE_PROVIDER (self->css_provider));
+    }
+    gtk_style_context_add_provider_for_screen (gdk_screen_get_default (),
+                                               GTK_STYLE_PROVIDER (provider),
+                                               GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+    self->css_provider = provider;
+  }
 
   /* Refresh accent color */
   on_accent_color_changed (self);
@@ -178,7 +196,9 @@ phosh_style_manager_dispose (GObject *object)
   PhoshStyleManager *self = PHOSH_STYLE_MANAGER (object);
 
   g_clear_pointer (&self->theme_name, g_free);
-  g_clear_object (&self->css_provider);
+  g_clear_object (&self->common_css_provider);
+  self->css_provider = NULL;
+  g_clear_pointer (&self->css_providers, g_hash_table_destroy);
   g_clear_object (&self->accent_css_provider);
 
   g_clear_object (&self->interface_settings);
@@ -212,6 +232,20 @@ phosh_style_manager_init (PhoshStyleManager *self)
   g_object_set (G_OBJECT (gtk_settings), "gtk-application-prefer-dark-theme", TRUE, NULL);
 
   self->interface_settings = g_settings_new (IF_SCHEMA_NAME);
+  /* Keys are the static stylesheet paths */
+  self->css_providers = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_object_unref);
+
+  /* The rules only reference named colors so they don't depend on the theme */
+  self->common_css_provider = gtk_css_provider_new ();
+  gtk_css_provider_load_from_resource (self->common_css_provider, COMMON_STYLESHEET);
+  gtk_style_context_add_provider_for_screen (gdk_screen_get_default (),
+                                             GTK_STYLE_PROVIDER (self->common_css_provider),
+                                             GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+
+  self->accent_css_provider = gtk_css_provider_new ();
+  gtk_style_context_add_provider_for_screen (gdk_screen_get_default (),
+                                             GTK_STYLE_PROVIDER (self->accent_css_provider),
+                                             GTK_STYLE_PROVIDER_PRIORITY_APPLICATION + 1);
 
   g_signal_connect_swapped (self->interface_settings,
                             "changed::" IF_KEY_ACCENT_COLOR,
@@ -235,7 +269,9 @@ phosh_style_manager_new (void)
  * phosh_style_manager_get_stylesheet:
  * @theme_name: A theme name
  *
- * Get the proper style sheet based on the given theme name
+ * Get the proper style sheet based on the given theme name. It only
+ * holds the theme's colors, the rules are in
+ * [func@StyleManager.get_common_stylesheet].
  */
 const char *
 phosh_style_manager_get_stylesheet (const char *theme_name)
@@ -243,9 +279,9 @@ phosh_style_manager_get_stylesheet (const char *theme_name)
   const char *style;
 
   if (g_strcmp0 (theme_name, "HighContrast") == 0)
-    style = "/mobi/phosh/stylesheet/adwaita-hc-light.css";
+    style = "/mobi/phosh/stylesheet/variants/adwaita-hc-light.css";
   else
-    style = "/mobi/phosh/stylesheet/adwaita-dark.css";
+    style = "/mobi/phosh/stylesheet/variants/adwaita-dark.css";
 
   return style;
 }
@@ -281,3 +317,16 @@ phosh_style_manager_is_high_contrast (PhoshStyleManager *self)
 
   return g_strcmp0 (self->theme_name, "HighContrast") == 0;
 }
+
+/**
+ * phosh_style_manager_get_common_stylesheet:
+ *
+ * Get the style sheet with the rules shared by all themes.
+ *
+ * Returns: The style sheet's resource path
+ */
+const char *
+phosh_style_manager_get_common_stylesheet (void)
+{
+  return COMMON_STYLESHEET;
+}
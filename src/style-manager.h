@@ -19,5 +19,6 @@ const char        *phosh_style_manager_get_theme_name (PhoshStyleManager *self);
 gboolean           phosh_style_manager_is_high_contrast (PhoshStyleManager *self);
 
 const char        *phosh_style_manager_get_stylesheet (const char *theme_name);
+const char        *phosh_style_manager_get_common_stylesheet (void);
 
 G_END_DECLS
@@ -25,12 +25,27 @@
  * PhoshSuspendManager:
  *
  * Manages suspend and inhibit's suspend when not useful.
+ *
+ * On resume it emits [signal@SuspendManager::resumed] right away for
+ * things the user sees first, like the lock screen and clocks. It
+ * then emits [signal@SuspendManager::resumed-idle] once the main loop
+ * is idle for more expensive refreshes, so these don't delay the first
+ * frames after resume.
  */
+
+enum {
+  RESUMED,
+  RESUMED_IDLE,
+  N_SIGNALS
+};
+static guint signals[N_SIGNALS];
+
 struct _PhoshSuspendManager {
   PhoshManager           parent;
 
   PhoshDBusLoginManager *logind_manager_proxy;
   GHashTable            *inhibitors; /* key: name, value: fd */
+  guint                  resumed_idle_id;
 
   GCancellable          *cancel;
 };
@@ -94,6 +109,43 @@ uninhibit (gpointer pointer)
 }
 
 
+static gboolean
+on_resumed_idle (gpointer data)
+{
+  PhoshSuspendManager *self = PHOSH_SUSPEND_MANAGER (data);
+
+  self->resumed_idle_id = 0;
+  g_debug ("Resumed, running idle handlers");
+  g_signal_emit (self, signals[RESUMED_IDLE], 0);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static void
+on_prepare_for_sleep (PhoshSuspendManager   *self,
+                      gboolean               suspending,
+                      PhoshDBusLoginManager *proxy)
+{
+  g_return_if_fail (PHOSH_IS_SUSPEND_MANAGER (self));
+
+  if (suspending) {
+    g_clear_handle_id (&self->resumed_idle_id, g_source_remove);
+    return;
+  }
+
+  g_debug ("Resumed");
+  g_signal_emit (self, signals[RESUMED], 0);
+
+  if (self->resumed_idle_id)
+    return;
+
+  /* Run after the first frames got drawn */
+  self->resumed_idle_id = g_idle_add_full (G_PRIORITY_LOW, on_resumed_idle, self, NULL);
+  g_source_set_name_by_id (self->resumed_idle_id, "[phosh] resumed idle");
+}
+
+
 static void
 on_logind_manager_proxy_new_for_bus_finish (GObject             *source_object,
                                             GAsyncResult        *res,
@@ -112,6 +164,11 @@ on_logind_manager_proxy_new_for_bus_finish (GObject             *source_object,
   g_return_if_fail (PHOSH_IS_SUSPEND_MANAGER (self));
   g_debug ("Connected to " LOGIN_OBJECT_PATH);
   self->logind_manager_proxy = proxy;
+  g_signal_connect_object (self->logind_manager_proxy,
+                           "prepare-for-sleep",
+                           G_CALLBACK (on_prepare_for_sleep),
+                           self,
+                           G_CONNECT_SWAPPED);
 
   wifi_manager = phosh_shell_get_wifi_manager (phosh_shell_get_default());
   g_signal_connect_swapped (wifi_manager,
@@ -145,6 +202,7 @@ phosh_suspend_manager_finalize (GObject *object)
 
   g_cancellable_cancel (self->cancel);
   g_clear_object (&self->cancel);
+  g_clear_handle_id (&self->resumed_idle_id, g_source_remove);
   g_clear_object (&self->logind_manager_proxy);
   g_clear_pointer (&self->inhibitors, g_hash_table_destroy);
 
@@ -160,6 +218,34 @@ phosh_suspend_manager_class_init (PhoshSuspendManagerClass *klass)
 
   object_class->finalize = phosh_suspend_manager_finalize;
   manager_class->idle_init = phosh_suspend_manager_idle_init;
+
+  /**
+   * PhoshSuspendManager::resumed:
+   * @self: The suspend manager
+   *
+   * Emitted right after the system resumed. Keep handlers cheap, use
+   * [signal@SuspendManager::resumed-idle] for anything else.
+   */
+  signals[RESUMED] = g_signal_new ("resumed",
+                                   G_TYPE_FROM_CLASS (klass),
+                                   G_SIGNAL_RUN_LAST,
+                                   0, NULL, NULL, NULL,
+                                   G_TYPE_NONE,
+                                   0);
+  /**
+   * PhoshSuspendManager::resumed-idle:
+   * @self: The suspend manager
+   *
+   * Emitted after [signal@SuspendManager::resumed] once the main loop
+   * is idle. Use this for refreshes that can wait until the shell is
+   * usable again.
+   */
+  signals[RESUMED_IDLE] = g_signal_new ("resumed-idle",
+                                        G_TYPE_FROM_CLASS (klass),
+                                        G_SIGNAL_RUN_LAST,
+                                        0, NULL, NULL, NULL,
+                                        G_TYPE_NONE,
+                                        0);
 }
 
 
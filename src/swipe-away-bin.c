@@ -60,7 +60,8 @@ set_progress (PhoshSwipeAwayBin *self,
   self->progress = progress;
 
   gtk_widget_set_opacity (GTK_WIDGET (self), hdy_ease_out_cubic (1 - ABS (self->progress)));
-  gtk_widget_queue_allocate (GTK_WIDGET (self));
+  /* The child is only drawn at an offset, see phosh_swipe_away_bin_draw () */
+  gtk_widget_queue_draw (GTK_WIDGET (self));
 }
 
 
@@ -271,12 +272,6 @@ phosh_swipe_away_bin_size_allocate (GtkWidget     *widget,
     } else {
       self->distance = alloc->width;
     }
-
-    if (gtk_widget_get_direction (GTK_WIDGET (self)) == GTK_TEXT_DIR_RTL)
-      child_alloc.x += (int) (self->progress * self->distance);
-    else
-      child_alloc.x -= (int) (self->progress * self->distance);
-
   } else {
     if (self->reserve_size) {
       self->distance = alloc->height / 3;
@@ -286,15 +281,44 @@ phosh_swipe_away_bin_size_allocate (GtkWidget     *widget,
     } else {
       self->distance = alloc->height;
     }
-
-    child_alloc.y -= (int) (self->progress * self->distance);
   }
 
-
   gtk_widget_size_allocate (child, &child_alloc);
 }
 
 
+static gboolean
+phosh_swipe_away_bin_draw (GtkWidget *widget, cairo_t *cr)
+{
+  PhoshSwipeAwayBin *self = PHOSH_SWIPE_AWAY_BIN (widget);
+  int offset = (int) (self->progress * self->distance);
+  gboolean ret;
+
+  if (offset == 0)
+    return GTK_WIDGET_CLASS (phosh_swipe_away_bin_parent_class)->draw (widget, cr);
+
+  /*
+   * Offset the drawing rather than the child's allocation so swiping
+   * doesn't relayout the child (and the list it's in) on every
+   * frame. Input doesn't matter during the swipe as the swipe tracker
+   * grabs it.
+   */
+  cairo_save (cr);
+  if (self->orientation == GTK_ORIENTATION_HORIZONTAL) {
+    if (gtk_widget_get_direction (widget) == GTK_TEXT_DIR_RTL)
+      cairo_translate (cr, offset, 0);
+    else
+      cairo_translate (cr, -offset, 0);
+  } else {
+    cairo_translate (cr, 0, -offset);
+  }
+  ret = GTK_WIDGET_CLASS (phosh_swipe_away_bin_parent_class)->draw (widget, cr);
+  cairo_restore (cr);
+
+  return ret;
+}
+
+
 static void
 phosh_swipe_away_bin_get_preferred_width (GtkWidget *widget,
                                           gint      *minimum,
@@ -355,6 +379,7 @@ phosh_swipe_away_bin_class_init (PhoshSwipeAwayBinClass *klass)
   object_class->get_property = phosh_swipe_away_bin_get_property;
   object_class->set_property = phosh_swipe_away_bin_set_property;
   widget_class->size_allocate = phosh_swipe_away_bin_size_allocate;
+  widget_class->draw = phosh_swipe_away_bin_draw;
   widget_class->get_preferred_width = phosh_swipe_away_bin_get_preferred_width;
   widget_class->get_preferred_height = phosh_swipe_away_bin_get_preferred_height;
   widget_class->direction_changed = phosh_swipe_away_bin_direction_changed;
@@ -68,6 +68,13 @@
  *   </child>
  * </object>
  * ]|
+ *
+ * # Reusing dialogs
+ *
+ * Dialogs marked via [method@SystemModalDialog.set_reusable] are only
+ * hidden by [method@SystemModalDialog.close] so they can be shown
+ * again via [method@SystemModalDialog.present] without building the
+ * widget tree again.
  */
 
 enum {
@@ -89,9 +96,14 @@ typedef struct {
   GtkWidget      *lbl_title;
   GtkWidget      *box_dialog;
   GtkWidget      *box_buttons;
+  GtkWidget      *swipe_bin;
 
   gboolean        fade_out;
   PhoshAnimation *animation;
+
+  gboolean        reusable;
+  /* When being shown was requested, for latency tracking */
+  gint64          show_time;
 } PhoshSystemModalDialogPrivate;
 
 static void phosh_system_modal_dialog_buildable_init (GtkBuildableIface *iface);
@@ -140,6 +152,45 @@ phosh_system_modal_dialog_get_property (GObject    *obj,
 }
 
 
+static void animation_value_cb (double value, PhoshSystemModalDialog *self);
+static void animation_done_cb (PhoshSystemModalDialog *self);
+
+static void
+start_animation (PhoshSystemModalDialog *self, double from, gboolean fade_out)
+{
+  PhoshSystemModalDialogPrivate *priv = phosh_system_modal_dialog_get_instance_private (self);
+
+  /* Stopping a running animation must neither hide nor destroy us */
+  priv->fade_out = FALSE;
+  g_clear_pointer (&priv->animation, phosh_animation_unref);
+
+  priv->fade_out = fade_out;
+  priv->animation = phosh_animation_new (GTK_WIDGET (self),
+                                         from,
+                                         1.0,
+                                         150 * PHOSH_ANIMATION_SLOWDOWN,
+                                         PHOSH_ANIMATION_TYPE_EASE_OUT_CUBIC,
+                                         (PhoshAnimationValueCallback) animation_value_cb,
+                                         (PhoshAnimationDoneCallback) animation_done_cb,
+                                         self);
+  phosh_animation_start (priv->animation);
+}
+
+
+static void
+phosh_system_modal_dialog_show (GtkWidget *widget)
+{
+  PhoshSystemModalDialog *self = PHOSH_SYSTEM_MODAL_DIALOG (widget);
+  PhoshSystemModalDialogPrivate *priv = phosh_system_modal_dialog_get_instance_private (self);
+
+  /* Freshly built dialogs track the time since construction */
+  if (priv->show_time == 0)
+    priv->show_time = g_get_monotonic_time ();
+
+  GTK_WIDGET_CLASS (phosh_system_modal_dialog_parent_class)->show (widget);
+}
+
+
 static void
 phosh_system_modal_dialog_map (GtkWidget *widget)
 {
@@ -148,7 +199,30 @@ phosh_system_modal_dialog_map (GtkWidget *widget)
 
   GTK_WIDGET_CLASS (phosh_system_modal_dialog_parent_class)->map (widget);
 
-  phosh_animation_start (priv->animation);
+  /* Might have been swiped away the last time */
+  if (priv->reusable)
+    phosh_swipe_away_bin_reveal (PHOSH_SWIPE_AWAY_BIN (priv->swipe_bin));
+
+  if (priv->animation == NULL)
+    start_animation (self, 0.0, FALSE);
+  else
+    phosh_animation_start (priv->animation);
+}
+
+
+static gboolean
+phosh_system_modal_dialog_draw (GtkWidget *widget, cairo_t *cr)
+{
+  PhoshSystemModalDialog *self = PHOSH_SYSTEM_MODAL_DIALOG (widget);
+  PhoshSystemModalDialogPrivate *priv = phosh_system_modal_dialog_get_instance_private (self);
+
+  if (priv->show_time) {
+    g_debug ("%s visible after %.2fms", G_OBJECT_TYPE_NAME (self),
+             (g_get_monotonic_time () - priv->show_time) / 1000.0);
+    priv->show_time = 0;
+  }
+
+  return GTK_WIDGET_CLASS (phosh_system_modal_dialog_parent_class)->draw (widget, cr);
 }
 
 
@@ -183,7 +257,9 @@ phosh_system_modal_dialog_class_init (PhoshSystemModalDialogClass *klass)
   object_class->set_property = phosh_system_modal_dialog_set_property;
   object_class->finalize = phosh_system_modal_dialog_finalize;
 
+  widget_class->show = phosh_system_modal_dialog_show;
   widget_class->map = phosh_system_modal_dialog_map;
+  widget_class->draw = phosh_system_modal_dialog_draw;
 
   /**
    * PhoshSystemModalDialog:title
@@ -216,6 +292,7 @@ phosh_system_modal_dialog_class_init (PhoshSystemModalDialogClass *klass)
   gtk_widget_class_bind_template_child_private (widget_class, PhoshSystemModalDialog, lbl_title);
   gtk_widget_class_bind_template_child_private (widget_class, PhoshSystemModalDialog, box_dialog);
   gtk_widget_class_bind_template_child_private (widget_class, PhoshSystemModalDialog, box_buttons);
+  gtk_widget_class_bind_template_child_private (widget_class, PhoshSystemModalDialog, swipe_bin);
   gtk_widget_class_bind_template_callback (widget_class, on_removed_by_swipe);
 
   binding_set = gtk_binding_set_by_class (klass);
@@ -276,7 +353,13 @@ animation_done_cb (PhoshSystemModalDialog *self)
 
   g_clear_pointer (&priv->animation, phosh_animation_unref);
 
-  if (priv->fade_out)
+  if (!priv->fade_out)
+    return;
+
+  priv->fade_out = FALSE;
+  if (priv->reusable)
+    gtk_widget_hide (GTK_WIDGET (self));
+  else
     gtk_widget_destroy (GTK_WIDGET (self));
 }
 
@@ -286,16 +369,9 @@ phosh_system_modal_dialog_init (PhoshSystemModalDialog *self)
 {
   PhoshSystemModalDialogPrivate *priv = phosh_system_modal_dialog_get_instance_private (self);
 
-  gtk_widget_init_template (GTK_WIDGET (self));
+  priv->show_time = g_get_monotonic_time ();
 
-  priv->animation = phosh_animation_new (GTK_WIDGET (self),
-                                         0.0,
-                                         1.0,
-                                         150 * PHOSH_ANIMATION_SLOWDOWN,
-                                         PHOSH_ANIMATION_TYPE_EASE_OUT_CUBIC,
-                                         (PhoshAnimationValueCallback) animation_value_cb,
-                                         (PhoshAnimationDoneCallback) animation_done_cb,
-                                         self);
+  gtk_widget_init_template (GTK_WIDGET (self));
 }
 
 /**
@@ -438,26 +514,56 @@ phosh_system_modal_dialog_set_title (PhoshSystemModalDialog *self, const char *t
  * phosh_system_modal_dialog_close:
  * @self: The dialog to close
  *
- * Hides the dialog and destroys it. When the compositor supports it
- * uses an animation. If you want to destroy the dialog directly use
- * `gtk_widget_destroy()`.
+ * Hides the dialog and destroys it unless it is reusable. When the
+ * compositor supports it uses an animation. If you want to destroy
+ * the dialog directly use `gtk_widget_destroy()`.
  */
 void
 phosh_system_modal_dialog_close (PhoshSystemModalDialog *self)
+{
+  g_return_if_fail (PHOSH_IS_SYSTEM_MODAL_DIALOG (self));
+
+  start_animation (self, 0.0, TRUE);
+}
+
+/**
+ * phosh_system_modal_dialog_set_reusable:
+ * @self: The dialog
+ * @reusable: Whether the dialog is reusable
+ *
+ * Reusable dialogs are only hidden when closed so they can be shown
+ * again via [method@SystemModalDialog.present] later on.
+ */
+void
+phosh_system_modal_dialog_set_reusable (PhoshSystemModalDialog *self, gboolean reusable)
 {
   PhoshSystemModalDialogPrivate *priv;
 
   g_return_if_fail (PHOSH_IS_SYSTEM_MODAL_DIALOG (self));
   priv = phosh_system_modal_dialog_get_instance_private (self);
 
-  priv->fade_out = TRUE;
-  priv->animation = phosh_animation_new (GTK_WIDGET (self),
-                                         0.0,
-                                         1.0,
-                                         150 * PHOSH_ANIMATION_SLOWDOWN,
-                                         PHOSH_ANIMATION_TYPE_EASE_OUT_CUBIC,
-                                         (PhoshAnimationValueCallback) animation_value_cb,
-                                         (PhoshAnimationDoneCallback) animation_done_cb,
-                                         self);
-  phosh_animation_start (priv->animation);
+  priv->reusable = !!reusable;
+}
+
+/**
+ * phosh_system_modal_dialog_present:
+ * @self: The dialog
+ *
+ * Shows the dialog. If a reusable dialog is still fading out after
+ * being closed it fades in again.
+ */
+void
+phosh_system_modal_dialog_present (PhoshSystemModalDialog *self)
+{
+  PhoshSystemModalDialogPrivate *priv;
+
+  g_return_if_fail (PHOSH_IS_SYSTEM_MODAL_DIALOG (self));
+  priv = phosh_system_modal_dialog_get_instance_private (self);
+
+  if (priv->fade_out && priv->animation) {
+    start_animation (self, 1.0 - phosh_animation_get_value (priv->animation), FALSE);
+    return;
+  }
+
+  gtk_widget_show (GTK_WIDGET (self));
 }
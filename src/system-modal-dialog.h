@@ -31,3 +31,5 @@ const char *phosh_system_modal_dialog_get_title (PhoshSystemModalDialog *self);
 void        phosh_system_modal_dialog_remove_button (PhoshSystemModalDialog *self, GtkWidget *button);
 GList      *phosh_system_modal_dialog_get_buttons (PhoshSystemModalDialog *self);
 void        phosh_system_modal_dialog_close (PhoshSystemModalDialog *self);
+void        phosh_system_modal_dialog_set_reusable (PhoshSystemModalDialog *self, gboolean reusable);
+void        phosh_system_modal_dialog_present (PhoshSystemModalDialog *self);
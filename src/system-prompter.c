@@ -10,6 +10,7 @@
 
 #include "phosh-config.h"
 
+#include "osk-manager.h"
 #include "system-prompt.h"
 #include "system-prompter.h"
 #include "shell-priv.h"
@@ -39,6 +40,8 @@ new_prompt_cb (GcrSystemPrompter *prompter,
   g_return_val_if_fail (GCR_IS_SYSTEM_PROMPTER (prompter), NULL);
 
   prompt = phosh_system_prompt_new ();
+  /* Most prompts ask for a password */
+  phosh_osk_manager_prewarm (phosh_shell_get_osk_manager (phosh_shell_get_default ()));
 
   return GCR_PROMPT (prompt);
 }
@@ -0,0 +1,363 @@
+/*
+ * Copyright (C) 2026 Phosh.mobi e.V.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Author: Guido Günther <agx@sigxcpu.org>
+ */
+
+#define G_LOG_DOMAIN "phosh-thumbnail-cache"
+
+#include "phosh-config.h"
+
+#include "memory-stats.h"
+#include "thumbnail-cache.h"
+
+/**
+ * PhoshThumbnailCache:
+ *
+ * A memory bounded cache of downscaled thumbnail images
+ *
+ * The cache keeps image surfaces (e.g. the downscaled image of a
+ * toplevel) around until the configured memory budget is exceeded. In
+ * that case the least recently used surfaces (but never the most
+ * recently used one) are evicted and the
+ * [signal@ThumbnailCache::evicted] signal is emitted so users can drop
+ * their references too.
+ */
+
+enum {
+  PROP_0,
+  PROP_MAX_SIZE,
+  PROP_SIZE,
+  PROP_LAST_PROP
+};
+static GParamSpec *props[PROP_LAST_PROP];
+
+enum {
+  EVICTED,
+  N_SIGNALS
+};
+static guint signals[N_SIGNALS];
+
+typedef struct {
+  GList            link;
+  gpointer         key;
+  cairo_surface_t *surface;
+  gsize            size;
+} PhoshThumbnailCacheEntry;
+
+struct _PhoshThumbnailCache {
+  GObject     parent;
+
+  gsize       max_size;
+  gsize       size;
+  GHashTable *entries;
+  /* Most recently used first */
+  GQueue      lru;
+};
+G_DEFINE_TYPE (PhoshThumbnailCache, phosh_thumbnail_cache, G_TYPE_OBJECT)
+
+
+static void
+entry_free (PhoshThumbnailCacheEntry *entry)
+{
+  cairo_surface_destroy (entry->surface);
+  g_free (entry);
+}
+
+
+static gsize
+get_surface_size (cairo_surface_t *surface)
+{
+  if (cairo_surface_get_type (surface) != CAIRO_SURFACE_TYPE_IMAGE)
+    return 0;
+
+  return (gsize)cairo_image_surface_get_stride (surface) * cairo_image_surface_get_height (surface);
+}
+
+
+static void
+drop_entry (PhoshThumbnailCache *self, PhoshThumbnailCacheEntry *entry)
+{
+  g_queue_unlink (&self->lru, &entry->link);
+  self->size -= entry->size;
+  /* Frees the entry */
+  g_hash_table_remove (self->entries, entry->key);
+}
+
+
+static void
+evict (PhoshThumbnailCache *self)
+{
+  gsize size = self->size;
+
+  /* Always keep the most recently used image */
+  while (self->size > self->max_size && self->lru.tail != self->lru.head) {
+    PhoshThumbnailCacheEntry *entry = self->lru.tail->data;
+    gpointer key = entry->key;
+
+    g_debug ("Evicting thumbnail for %p (%" G_GSIZE_FORMAT " bytes)", key, entry->size);
+    drop_entry (self, entry);
+    g_signal_emit (self, signals[EVICTED], 0, key);
+  }
+
+  if (size != self->size)
+    g_object_notify_by_pspec (G_OBJECT (self), props[PROP_SIZE]);
+}
+
+
+static void
+phosh_thumbnail_cache_set_property (GObject      *object,
+                                    guint         property_id,
+                                    const GValue *value,
+                                    GParamSpec   *pspec)
+{
+  PhoshThumbnailCache *self = PHOSH_THUMBNAIL_CACHE (object);
+
+  switch (property_id) {
+  case PROP_MAX_SIZE:
+    phosh_thumbnail_cache_set_max_size (self, g_value_get_uint64 (value));
+    break;
+  default:
+    G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    break;
+  }
+}
+
+
+static void
+phosh_thumbnail_cache_get_property (GObject    *object,
+                                    guint       property_id,
+                                    GValue     *value,
+                                    GParamSpec *pspec)
+{
+  PhoshThumbnailCache *self = PHOSH_THUMBNAIL_CACHE (object);
+
+  switch (property_id) {
+  case PROP_MAX_SIZE:
+    g_value_set_uint64 (value, self->max_size);
+    break;
+  case PROP_SIZE:
+    g_value_set_uint64 (value, self->size);
+    break;
+  default:
+    G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    break;
+  }
+}
+
+
+static void
+report_memory (gpointer data, guint64 *n_items, guint64 *bytes)
+{
+  PhoshThumbnailCache *self = PHOSH_THUMBNAIL_CACHE (data);
+
+  *n_items = g_hash_table_size (self->entries);
+  *bytes = self->size;
+}
+
+
+static void
+phosh_thumbnail_cache_finalize (GObject *object)
+{
+  PhoshThumbnailCache *self = PHOSH_THUMBNAIL_CACHE (object);
+
+  phosh_memory_stats_unregister (self);
+
+  /* The queue's links are embedded in the entries */
+  g_clear_pointer (&self->entries, g_hash_table_destroy);
+  g_queue_init (&self->lru);
+
+  G_OBJECT_CLASS (phosh_thumbnail_cache_parent_class)->finalize (object);
+}
+
+
+static void
+phosh_thumbnail_cache_class_init (PhoshThumbnailCacheClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->get_property = phosh_thumbnail_cache_get_property;
+  object_class->set_property = phosh_thumbnail_cache_set_property;
+  object_class->finalize = phosh_thumbnail_cache_finalize;
+
+  /**
+   * PhoshThumbnailCache:max-size:
+   *
+   * The memory budget of the cache in bytes
+   */
+  props[PROP_MAX_SIZE] =
+    g_param_spec_uint64 ("max-size", "", "",
+                         0, G_MAXUINT64, 0,
+                         G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+  /**
+   * PhoshThumbnailCache:size:
+   *
+   * The memory currently used by cached images in bytes
+   */
+  props[PROP_SIZE] =
+    g_param_spec_uint64 ("size", "", "",
+                         0, G_MAXUINT64, 0,
+                         G_PARAM_READABLE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties (object_class, PROP_LAST_PROP, props);
+
+  /**
+   * PhoshThumbnailCache::evicted:
+   * @self: The thumbnail cache
+   * @key: The key of the evicted image
+   *
+   * Emitted when an image got evicted from the cache to stay within
+   * the memory budget.
+   */
+  signals[EVICTED] = g_signal_new ("evicted",
+                                   G_TYPE_FROM_CLASS (klass),
+                                   G_SIGNAL_RUN_LAST,
+                                   0, NULL, NULL, NULL,
+                                   G_TYPE_NONE,
+                                   1,
+                                   G_TYPE_POINTER);
+}
+
+
+static void
+phosh_thumbnail_cache_init (PhoshThumbnailCache *self)
+{
+  self->entries = g_hash_table_new_full (g_direct_hash,
+                                         g_direct_equal,
+                                         NULL,
+                                         (GDestroyNotify) entry_free);
+  g_queue_init (&self->lru);
+
+  phosh_memory_stats_register ("thumbnail-cache", report_memory, self);
+}
+
+
+PhoshThumbnailCache *
+phosh_thumbnail_cache_new (gsize max_size)
+{
+  return g_object_new (PHOSH_TYPE_THUMBNAIL_CACHE, "max-size", (guint64)max_size, NULL);
+}
+
+/**
+ * phosh_thumbnail_cache_insert:
+ * @self: The thumbnail cache
+ * @key: The key to store the image under
+ * @surface: The image
+ *
+ * Stores the given image in the cache replacing any previous image
+ * stored under the same key. This marks the image as most recently
+ * used and might evict other images.
+ */
+void
+phosh_thumbnail_cache_insert (PhoshThumbnailCache *self, gpointer key, cairo_surface_t *surface)
+{
+  PhoshThumbnailCacheEntry *entry;
+
+  g_return_if_fail (PHOSH_IS_THUMBNAIL_CACHE (self));
+  g_return_if_fail (key);
+  g_return_if_fail (surface);
+
+  entry = g_hash_table_lookup (self->entries, key);
+  if (entry) {
+    g_queue_unlink (&self->lru, &entry->link);
+    self->size -= entry->size;
+    g_clear_pointer (&entry->surface, cairo_surface_destroy);
+  } else {
+    entry = g_new0 (PhoshThumbnailCacheEntry, 1);
+    entry->key = key;
+    entry->link.data = entry;
+    g_hash_table_insert (self->entries, key, entry);
+  }
+
+  entry->surface = cairo_surface_reference (surface);
+  entry->size = get_surface_size (surface);
+  self->size += entry->size;
+  g_queue_push_head_link (&self->lru, &entry->link);
+
+  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_SIZE]);
+  evict (self);
+}
+
+/**
+ * phosh_thumbnail_cache_lookup:
+ * @self: The thumbnail cache
+ * @key: The key to look up
+ *
+ * Looks up the image stored under the given key and marks it as most
+ * recently used.
+ *
+ * Returns:(transfer none)(nullable): The image
+ */
+cairo_surface_t *
+phosh_thumbnail_cache_lookup (PhoshThumbnailCache *self, gpointer key)
+{
+  PhoshThumbnailCacheEntry *entry;
+
+  g_return_val_if_fail (PHOSH_IS_THUMBNAIL_CACHE (self), NULL);
+
+  entry = g_hash_table_lookup (self->entries, key);
+  if (entry == NULL)
+    return NULL;
+
+  g_queue_unlink (&self->lru, &entry->link);
+  g_queue_push_head_link (&self->lru, &entry->link);
+
+  return entry->surface;
+}
+
+/**
+ * phosh_thumbnail_cache_remove:
+ * @self: The thumbnail cache
+ * @key: The key of the image to remove
+ *
+ * Drops the image stored under the given key (if any).
+ */
+void
+phosh_thumbnail_cache_remove (PhoshThumbnailCache *self, gpointer key)
+{
+  PhoshThumbnailCacheEntry *entry;
+
+  g_return_if_fail (PHOSH_IS_THUMBNAIL_CACHE (self));
+
+  entry = g_hash_table_lookup (self->entries, key);
+  if (entry == NULL)
+    return;
+
+  drop_entry (self, entry);
+  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_SIZE]);
+}
+
+
+gsize
+phosh_thumbnail_cache_get_size (PhoshThumbnailCache *self)
+{
+  g_return_val_if_fail (PHOSH_IS_THUMBNAIL_CACHE (self), 0);
+
+  return self->size;
+}
+
+
+gsize
+phosh_thumbnail_cache_get_max_size (PhoshThumbnailCache *self)
+{
+  g_return_val_if_fail (PHOSH_IS_THUMBNAIL_CACHE (self), 0);
+
+  return self->max_size;
+}
+
+
+void
+phosh_thumbnail_cache_set_max_size (PhoshThumbnailCache *self, gsize max_size)
+{
+  g_return_if_fail (PHOSH_IS_THUMBNAIL_CACHE (self));
+
+  if (self->max_size == max_size)
+    return;
+
+  self->max_size = max_size;
+  evict (self);
+
+  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_MAX_SIZE]);
+}
@@ -0,0 +1,30 @@
+/*
+ * Copyright (C) 2026 Phosh.mobi e.V.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <gtk/gtk.h>
+
+G_BEGIN_DECLS
+
+#define PHOSH_TYPE_THUMBNAIL_CACHE (phosh_thumbnail_cache_get_type ())
+
+G_DECLARE_FINAL_TYPE (PhoshThumbnailCache, phosh_thumbnail_cache, PHOSH, THUMBNAIL_CACHE, GObject)
+
+PhoshThumbnailCache *phosh_thumbnail_cache_new          (gsize                max_size);
+void                 phosh_thumbnail_cache_insert       (PhoshThumbnailCache *self,
+                                                         gpointer             key,
+                                                         cairo_surface_t     *surface);
+cairo_surface_t     *phosh_thumbnail_cache_lookup       (PhoshThumbnailCache *self,
+                                                         gpointer             key);
+void                 phosh_thumbnail_cache_remove       (PhoshThumbnailCache *self,
+                                                         gpointer             key);
+gsize                phosh_thumbnail_cache_get_size     (PhoshThumbnailCache *self);
+gsize                phosh_thumbnail_cache_get_max_size (PhoshThumbnailCache *self);
+void                 phosh_thumbnail_cache_set_max_size (PhoshThumbnailCache *self,
+                                                         gsize                max_size);
+
+G_END_DECLS
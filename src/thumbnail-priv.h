@@ -13,5 +13,6 @@
 G_BEGIN_DECLS
 
 void phosh_thumbnail_set_ready (PhoshThumbnail *self, gboolean ready);
+void phosh_thumbnail_add_damage (PhoshThumbnail *self, int x, int y, int width, int height);
 
 G_END_DECLS
@@ -24,7 +24,8 @@ enum {
 static GParamSpec *props[PROP_LAST_PROP];
 
 typedef struct _PhoshThumbnailPrivate {
-  gboolean ready;
+  gboolean        ready;
+  cairo_region_t *damage;
 } PhoshThumbnailPrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (PhoshThumbnail, phosh_thumbnail, G_TYPE_OBJECT);
@@ -49,12 +50,24 @@ phosh_thumbnail_get_property (GObject    *object,
 }
 
 
+static void
+phosh_thumbnail_finalize (GObject *object)
+{
+  PhoshThumbnailPrivate *priv = phosh_thumbnail_get_instance_private (PHOSH_THUMBNAIL (object));
+
+  g_clear_pointer (&priv->damage, cairo_region_destroy);
+
+  G_OBJECT_CLASS (phosh_thumbnail_parent_class)->finalize (object);
+}
+
+
 static void
 phosh_thumbnail_class_init (PhoshThumbnailClass *klass)
 {
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
 
   object_class->get_property = phosh_thumbnail_get_property;
+  object_class->finalize = phosh_thumbnail_finalize;
 
   /**
    * PhoshThumbnail:ready:
@@ -128,3 +141,50 @@ phosh_thumbnail_set_ready (PhoshThumbnail *self, gboolean ready)
   priv->ready = ready;
   g_object_notify_by_pspec (G_OBJECT (self), props[PROP_READY]);
 }
+
+
+/**
+ * phosh_thumbnail_add_damage:
+ * @self: The thumbnail
+ * @x: The x coordinate of the damaged area
+ * @y: The y coordinate of the damaged area
+ * @width: The width of the damaged area
+ * @height: The height of the damaged area
+ *
+ * Adds the given area to the region that changed since the previous
+ * thumbnail of the same source. Used by subclasses that can track
+ * damage.
+ */
+void
+phosh_thumbnail_add_damage (PhoshThumbnail *self, int x, int y, int width, int height)
+{
+  PhoshThumbnailPrivate *priv = phosh_thumbnail_get_instance_private (self);
+  cairo_rectangle_int_t rect = { x, y, width, height };
+
+  g_return_if_fail (PHOSH_IS_THUMBNAIL (self));
+
+  if (priv->damage == NULL)
+    priv->damage = cairo_region_create ();
+
+  cairo_region_union_rectangle (priv->damage, &rect);
+}
+
+/**
+ * phosh_thumbnail_get_damage:
+ * @self: The thumbnail
+ *
+ * Get the region that changed since the previous thumbnail of the
+ * same source. If there's no damage information the whole image needs
+ * to be considered damaged.
+ *
+ * Returns:(transfer none)(nullable): The damaged region
+ */
+const cairo_region_t *
+phosh_thumbnail_get_damage (PhoshThumbnail *self)
+{
+  PhoshThumbnailPrivate *priv = phosh_thumbnail_get_instance_private (self);
+
+  g_return_val_if_fail (PHOSH_IS_THUMBNAIL (self), NULL);
+
+  return priv->damage;
+}
@@ -28,3 +28,4 @@ gpointer phosh_thumbnail_get_image (PhoshThumbnail *self);
 void     phosh_thumbnail_get_size  (PhoshThumbnail *self, guint *width, guint *height,
                                     guint *stride);
 gboolean phosh_thumbnail_is_ready  (PhoshThumbnail *self);
+const cairo_region_t *phosh_thumbnail_get_damage (PhoshThumbnail *self);
@@ -0,0 +1,435 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "phosh-timer-service"
+
+#include "phosh-config.h"
+
+#include "timer-service.h"
+
+/**
+ * PhoshTimerService:
+ *
+ * Coalesces periodic timers into as few wakeups as possible
+ *
+ * Components register periodic work with an interval and a tolerance
+ * that tells how late the work may run. The service wakes up once
+ * when the first registration's tolerance runs out and then runs all
+ * registrations that are due at that time.
+ *
+ * Registrations added via [method@TimerService.add_aligned_timeout]
+ * run at multiples of their interval on the wall clock (e.g. at full
+ * minutes) so that updates of different components line up.
+ *
+ * While suspended (e.g. when the primary monitor is in power save
+ * mode) no registration runs. Overdue registrations run once when
+ * the service resumes.
+ */
+
+enum {
+  PROP_0,
+  PROP_SUSPENDED,
+  PROP_LAST_PROP
+};
+static GParamSpec *props[PROP_LAST_PROP];
+
+typedef struct {
+  guint       id;
+  guint       interval;
+  guint       tolerance;
+  /* Monotonic time (µs) the timeout is due */
+  gint64      deadline;
+  /* Whether deadlines are aligned to the wall clock */
+  gboolean    aligned;
+  GSourceFunc func;
+  gpointer    data;
+} PhoshTimerEntry;
+
+struct _PhoshTimerService {
+  GObject     parent;
+
+  /* key: id, value: PhoshTimerEntry */
+  GHashTable *entries;
+  guint       next_id;
+  guint       wakeup_id;
+  gboolean    suspended;
+};
+G_DEFINE_TYPE (PhoshTimerService, phosh_timer_service, G_TYPE_OBJECT)
+
+static void schedule_wakeup (PhoshTimerService *self);
+
+
+/* The next multiple of the interval on the wall clock, as monotonic time */
+static gint64
+get_aligned_deadline (PhoshTimerEntry *entry, gint64 now)
+{
+  gint64 interval = (gint64)entry->interval * G_TIME_SPAN_MILLISECOND;
+  gint64 real_now = g_get_real_time ();
+
+  return now + interval - (real_now % interval);
+}
+
+
+static gboolean
+on_wakeup (gpointer user_data)
+{
+  PhoshTimerService *self = PHOSH_TIMER_SERVICE (user_data);
+  g_autoptr (GArray) due = g_array_new (FALSE, FALSE, sizeof (guint));
+  GHashTableIter iter;
+  gpointer value;
+  gint64 now;
+
+  self->wakeup_id = 0;
+  now = g_get_monotonic_time ();
+
+  g_hash_table_iter_init (&iter, self->entries);
+  while (g_hash_table_iter_next (&iter, NULL, &value)) {
+    PhoshTimerEntry *entry = value;
+
+    if (entry->deadline <= now)
+      g_array_append_val (due, entry->id);
+  }
+
+  /* Callbacks can add and remove timeouts, so look up the entries again */
+  for (guint i = 0; i < due->len; i++) {
+    guint id = g_array_index (due, guint, i);
+    PhoshTimerEntry *entry = g_hash_table_lookup (self->entries, GUINT_TO_POINTER (id));
+
+    if (entry == NULL)
+      continue;
+
+    if (entry->func (entry->data) == G_SOURCE_REMOVE) {
+      g_hash_table_remove (self->entries, GUINT_TO_POINTER (id));
+      continue;
+    }
+
+    /* The callback might have removed itself */
+    entry = g_hash_table_lookup (self->entries, GUINT_TO_POINTER (id));
+    if (entry == NULL)
+      continue;
+
+    /* The wall clock might have been changed */
+    if (entry->aligned) {
+      entry->deadline = get_aligned_deadline (entry, g_get_monotonic_time ());
+      continue;
+    }
+
+    /* Keep the phase unless we're way behind (e.g. after being suspended) */
+    entry->deadline += entry->interval * G_TIME_SPAN_MILLISECOND;
+    if (entry->deadline <= now)
+      entry->deadline = now + entry->interval * G_TIME_SPAN_MILLISECOND;
+  }
+
+  schedule_wakeup (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static void
+schedule_wakeup (PhoshTimerService *self)
+{
+  GHashTableIter iter;
+  gpointer value;
+  gint64 wakeup = G_MAXINT64, now;
+  guint delay;
+
+  g_clear_handle_id (&self->wakeup_id, g_source_remove);
+
+  if (self->suspended)
+    return;
+
+  g_hash_table_iter_init (&iter, self->entries);
+  while (g_hash_table_iter_next (&iter, NULL, &value)) {
+    PhoshTimerEntry *entry = value;
+
+    wakeup = MIN (wakeup, entry->deadline + entry->tolerance * G_TIME_SPAN_MILLISECOND);
+  }
+
+  if (wakeup == G_MAXINT64)
+    return;
+
+  now = g_get_monotonic_time ();
+  delay = MAX (wakeup - now, 0) / G_TIME_SPAN_MILLISECOND;
+
+  self->wakeup_id = g_timeout_add (delay, on_wakeup, self);
+  g_source_set_name_by_id (self->wakeup_id, "[PhoshTimerService] wakeup");
+}
+
+
+static void
+phosh_timer_service_set_property (GObject      *object,
+                                  guint         property_id,
+                                  const GValue *value,
+                                  GParamSpec   *pspec)
+{
+  PhoshTimerService *self = PHOSH_TIMER_SERVICE (object);
+
+  switch (property_id) {
+  case PROP_SUSPENDED:
+    phosh_timer_service_set_suspended (self, g_value_get_boolean (value));
+    break;
+  default:
+    G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    break;
+  }
+}
+
+
+static void
+phosh_timer_service_get_property (GObject    *object,
+                                  guint       property_id,
+                                  GValue     *value,
+                                  GParamSpec *pspec)
+{
+  PhoshTimerService *self = PHOSH_TIMER_SERVICE (object);
+
+  switch (property_id) {
+  case PROP_SUSPENDED:
+    g_value_set_boolean (value, self->suspended);
+    break;
+  default:
+    G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    break;
+  }
+}
+
+
+static void
+phosh_timer_service_finalize (GObject *object)
+{
+  PhoshTimerService *self = PHOSH_TIMER_SERVICE (object);
+
+  g_clear_handle_id (&self->wakeup_id, g_source_remove);
+  g_clear_pointer (&self->entries, g_hash_table_destroy);
+
+  G_OBJECT_CLASS (phosh_timer_service_parent_class)->finalize (object);
+}
+
+
+static void
+phosh_timer_service_class_init (PhoshTimerServiceClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->get_property = phosh_timer_service_get_property;
+  object_class->set_property = phosh_timer_service_set_property;
+  object_class->finalize = phosh_timer_service_finalize;
+
+  /**
+   * PhoshTimerService:suspended:
+   *
+   * Whether timeouts are currently suspended
+   */
+  props[PROP_SUSPENDED] =
+    g_param_spec_boolean ("suspended", "", "",
+                          FALSE,
+                          G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties (object_class, PROP_LAST_PROP, props);
+}
+
+
+static void
+phosh_timer_service_init (PhoshTimerService *self)
+{
+  self->next_id = 1;
+  self->entries = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, g_free);
+}
+
+/**
+ * phosh_timer_service_get_default:
+ *
+ * Get the timer service singleton
+ *
+ * Returns:(transfer none): The timer service singleton
+ */
+PhoshTimerService *
+phosh_timer_service_get_default (void)
+{
+  static PhoshTimerService *instance;
+
+  if (instance == NULL) {
+    instance = g_object_new (PHOSH_TYPE_TIMER_SERVICE, NULL);
+    g_object_add_weak_pointer (G_OBJECT (instance), (gpointer *)&instance);
+  }
+
+  return instance;
+}
+
+static guint
+add_timeout (PhoshTimerService *self,
+             guint              interval,
+             guint              tolerance,
+             gboolean           aligned,
+             GSourceFunc        func,
+             gpointer           data)
+{
+  PhoshTimerEntry *entry;
+  gint64 now = g_get_monotonic_time ();
+
+  entry = g_new0 (PhoshTimerEntry, 1);
+  entry->id = self->next_id++;
+  if (self->next_id == 0)
+    self->next_id = 1;
+  entry->interval = interval;
+  entry->tolerance = tolerance;
+  entry->aligned = aligned;
+  if (aligned)
+    entry->deadline = get_aligned_deadline (entry, now);
+  else
+    entry->deadline = now + interval * G_TIME_SPAN_MILLISECOND;
+  entry->func = func;
+  entry->data = data;
+
+  g_hash_table_insert (self->entries, GUINT_TO_POINTER (entry->id), entry);
+  schedule_wakeup (self);
+
+  return entry->id;
+}
+
+/**
+ * phosh_timer_service_add_timeout:
+ * @self: The timer service
+ * @interval: The interval in milliseconds
+ * @tolerance: How many milliseconds later than @interval @func may run
+ * @func: The function to call
+ * @data: Data passed to @func
+ *
+ * Runs @func every @interval milliseconds until it returns
+ * `G_SOURCE_REMOVE` or the timeout is removed via
+ * [method@TimerService.remove_timeout]. Like `g_timeout_add()` but
+ * lets the service run @func together with other timeouts
+ * to save wakeups.
+ *
+ * Returns: The id of the timeout, never `0`
+ */
+guint
+phosh_timer_service_add_timeout (PhoshTimerService *self,
+                                 guint              interval,
+                                 guint              tolerance,
+                                 GSourceFunc        func,
+                                 gpointer           data)
+{
+  g_return_val_if_fail (PHOSH_IS_TIMER_SERVICE (self), 0);
+  g_return_val_if_fail (func, 0);
+
+  return add_timeout (self, interval, tolerance, FALSE, func, data);
+}
+
+/**
+ * phosh_timer_service_add_aligned_timeout:
+ * @self: The timer service
+ * @interval: The interval in milliseconds
+ * @tolerance: How many milliseconds later @func may run
+ * @func: The function to call
+ * @data: Data passed to @func
+ *
+ * Like [method@TimerService.add_timeout] but runs @func whenever the
+ * wall clock reaches a multiple of @interval, e.g. at every full
+ * second or minute. Use this for updates shown to the user so they
+ * tick in sync.
+ *
+ * Returns: The id of the timeout, never `0`
+ */
+guint
+phosh_timer_service_add_aligned_timeout (PhoshTimerService *self,
+                                         guint              interval,
+                                         guint              tolerance,
+                                         GSourceFunc        func,
+                                         gpointer           data)
+{
+  g_return_val_if_fail (PHOSH_IS_TIMER_SERVICE (self), 0);
+  g_return_val_if_fail (func, 0);
+  g_return_val_if_fail (interval > 0, 0);
+
+  return add_timeout (self, interval, tolerance, TRUE, func, data);
+}
+
+/**
+ * phosh_timer_service_remove_timeout:
+ * @self: The timer service
+ * @id: The id of the timeout
+ *
+ * Removes the timeout with the given id.
+ */
+void
+phosh_timer_service_remove_timeout (PhoshTimerService *self, guint id)
+{
+  g_return_if_fail (PHOSH_IS_TIMER_SERVICE (self));
+
+  if (!g_hash_table_remove (self->entries, GUINT_TO_POINTER (id)))
+    g_critical ("Can't remove unknown timeout %u", id);
+
+  /* No need to reschedule, an early wakeup is harmless */
+}
+
+/**
+ * phosh_timer_service_resync:
+ * @self: The timer service
+ *
+ * Run aligned timeouts right away and align them to the wall clock
+ * again. Deadlines use the monotonic clock which doesn't advance
+ * while the system is suspended so use this after resume to not
+ * show stale clocks until the next tick.
+ */
+void
+phosh_timer_service_resync (PhoshTimerService *self)
+{
+  GHashTableIter iter;
+  gpointer value;
+  gint64 now;
+  gboolean found = FALSE;
+
+  g_return_if_fail (PHOSH_IS_TIMER_SERVICE (self));
+
+  now = g_get_monotonic_time ();
+  g_hash_table_iter_init (&iter, self->entries);
+  while (g_hash_table_iter_next (&iter, NULL, &value)) {
+    PhoshTimerEntry *entry = value;
+
+    if (!entry->aligned)
+      continue;
+
+    entry->deadline = now;
+    found = TRUE;
+  }
+
+  if (found)
+    schedule_wakeup (self);
+}
+
+/**
+ * phosh_timer_service_set_suspended:
+ * @self: The timer service
+ * @suspended: Whether to suspend timeouts
+ *
+ * Suspend or resume all timeouts.
+ */
+void
+phosh_timer_service_set_suspended (PhoshTimerService *self, gboolean suspended)
+{
+  g_return_if_fail (PHOSH_IS_TIMER_SERVICE (self));
+
+  suspended = !!suspended;
+  if (self->suspended == suspended)
+    return;
+
+  self->suspended = suspended;
+  g_debug ("%s timeouts", suspended ? "Suspending" : "Resuming");
+  schedule_wakeup (self);
+
+  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_SUSPENDED]);
+}
+
+
+gboolean
+phosh_timer_service_get_suspended (PhoshTimerService *self)
+{
+  g_return_val_if_fail (PHOSH_IS_TIMER_SERVICE (self), FALSE);
+
+  return self->suspended;
+}
@@ -0,0 +1,35 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+#define PHOSH_TYPE_TIMER_SERVICE (phosh_timer_service_get_type ())
+
+G_DECLARE_FINAL_TYPE (PhoshTimerService, phosh_timer_service, PHOSH, TIMER_SERVICE, GObject)
+
+PhoshTimerService *phosh_timer_service_get_default        (void);
+guint              phosh_timer_service_add_timeout        (PhoshTimerService *self,
+                                                           guint              interval,
+                                                           guint              tolerance,
+                                                           GSourceFunc        func,
+                                                           gpointer           data);
+guint              phosh_timer_service_add_aligned_timeout (PhoshTimerService *self,
+                                                           guint              interval,
+                                                           guint              tolerance,
+                                                           GSourceFunc        func,
+                                                           gpointer           data);
+void               phosh_timer_service_remove_timeout     (PhoshTimerService *self,
+                                                           guint              id);
+void               phosh_timer_service_resync             (PhoshTimerService *self);
+void               phosh_timer_service_set_suspended      (PhoshTimerService *self,
+                                                           gboolean           suspended);
+gboolean           phosh_timer_service_get_suspended      (PhoshTimerService *self);
+
+G_END_DECLS
@@ -114,6 +114,8 @@ typedef struct _PhoshTopPanel {
 
   PhoshTopPanelBg *background;
   GtkCssProvider  *cutout_css_provider;
+  char            *cutout_css;
+  PhoshLayoutClockPosition clock_pos;
 
   GCancellable    *cancel;
 } PhoshTopPanel;
@@ -351,7 +353,6 @@ wall_clock_notify_cb (PhoshTopPanel  *self,
                       PhoshWallClock *wall_clock)
 {
   const char *str;
-  g_autofree char *date = NULL;
 
   g_return_if_fail (PHOSH_IS_TOP_PANEL (self));
   g_return_if_fail (PHOSH_IS_WALL_CLOCK (wall_clock));
@@ -359,8 +360,7 @@ wall_clock_notify_cb (PhoshTopPanel  *self,
   str = phosh_wall_clock_get_clock (wall_clock, TRUE);
   gtk_label_set_text (GTK_LABEL (self->lbl_clock2), str);
 
-  date = phosh_wall_clock_local_date (wall_clock);
-  gtk_label_set_label (GTK_LABEL (self->lbl_date), date);
+  gtk_label_set_label (GTK_LABEL (self->lbl_date), phosh_wall_clock_get_local_date (wall_clock));
 }
 
 
@@ -543,6 +543,21 @@ phosh_top_panel_dragged (PhoshDragSurface *drag_surface, int margin)
 }
 
 
+static void
+update_ui_visible (PhoshTopPanel *self)
+{
+  PhoshShell *shell = phosh_shell_get_default ();
+  gboolean visible;
+
+  /* Also visible while being dragged, not only when fully unfolded */
+  visible = phosh_drag_surface_get_drag_state (PHOSH_DRAG_SURFACE (self)) !=
+    PHOSH_DRAG_SURFACE_STATE_FOLDED;
+  visible &= !(phosh_shell_get_state (shell) & PHOSH_STATE_BLANKED);
+
+  phosh_settings_set_ui_visible (PHOSH_SETTINGS (self->settings), visible);
+}
+
+
 static void
 on_drag_state_changed (PhoshTopPanel *self)
 {
@@ -592,6 +607,8 @@ on_drag_state_changed (PhoshTopPanel *self)
   gtk_revealer_set_reveal_child (GTK_REVEALER (self->launch_settings_revealer),
                                  progress <= 0.0);
 
+  update_ui_visible (self);
+
   phosh_layer_surface_set_kbd_interactivity (PHOSH_LAYER_SURFACE (self), kbd_interactivity);
   phosh_layer_surface_wl_surface_commit (PHOSH_LAYER_SURFACE (self));
 }
@@ -758,6 +775,12 @@ phosh_top_panel_constructed (GObject *object)
   add_keybindings (self);
 
   g_signal_connect (self, "notify::drag-state", G_CALLBACK (on_drag_state_changed), NULL);
+  g_signal_connect_object (shell,
+                           "notify::shell-state",
+                           G_CALLBACK (update_ui_visible),
+                           self,
+                           G_CONNECT_SWAPPED);
+  update_ui_visible (self);
 
   phosh_top_panel_add_background (self);
   g_signal_connect_object (phosh_shell_get_style_manager (shell),
@@ -792,7 +815,12 @@ phosh_top_panel_dispose (GObject *object)
     self->seat = NULL;
   }
   g_clear_pointer (&self->background, phosh_cp_widget_destroy);
+  if (self->cutout_css_provider) {
+    gtk_style_context_remove_provider_for_screen (gdk_screen_get_default (),
+                                                  GTK_STYLE_PROVIDER (self->cutout_css_provider));
+  }
   g_clear_object (&self->cutout_css_provider);
+  g_clear_pointer (&self->cutout_css, g_free);
 
   G_OBJECT_CLASS (phosh_top_panel_parent_class)->dispose (object);
 }
@@ -971,8 +999,12 @@ set_clock_position (PhoshTopPanel *self, PhoshLayoutManager *layout_manager)
   PhoshLayoutClockPosition pos;
   guint top_margin = 0;
 
-  /* Top-bar clock */
+  /* Top-bar clock, moving it around causes a relayout so only do when needed */
   pos = phosh_layout_manager_get_clock_pos (layout_manager);
+  if (pos == self->clock_pos)
+    goto shift;
+  self->clock_pos = pos;
+
   gtk_container_remove (GTK_CONTAINER (self->box_top_bar), self->lbl_clock);
   phosh_util_toggle_style_class (self->lbl_clock, "left", FALSE);
   phosh_util_toggle_style_class (self->lbl_clock, "right", FALSE);
@@ -995,6 +1027,7 @@ set_clock_position (PhoshTopPanel *self, PhoshLayoutManager *layout_manager)
     g_assert_not_reached ();
   }
 
+ shift:
   /* Shift down settings menu clock */
   top_margin = phosh_layout_manager_get_clock_box_shift (layout_manager);
   gtk_widget_set_margin_top (self->box_clock, top_margin);
@@ -1006,7 +1039,8 @@ set_margin (PhoshTopPanel *self, PhoshLayoutManager *layout_manager)
 {
   guint network_box_shift = 0, indicators_box_shift = 0, launch_settings_revealer_shift = 0;
   g_autofree char *css = NULL;
-  g_autoptr (GtkCssProvider) provider = gtk_css_provider_new ();
+  GdkScreen *screen = gdk_screen_get_default ();
+  g_autoptr (GtkCssProvider) provider = NULL;
 
   phosh_layout_manager_get_box_shifts (layout_manager,
                                        &network_box_shift,
@@ -1027,11 +1061,23 @@ set_margin (PhoshTopPanel *self, PhoshLayoutManager *layout_manager)
                          "  padding-right: %dpx;"
                          "}",
                          network_box_shift, indicators_box_shift, launch_settings_revealer_shift);
+
+  /* Changing the CSS restyles all widgets so avoid that when possible */
+  if (g_strcmp0 (css, self->cutout_css) == 0)
+    return;
+
+  provider = gtk_css_provider_new ();
   gtk_css_provider_load_from_data (provider, css, -1, NULL);
-  gtk_style_context_add_provider_for_screen (gdk_screen_get_default (),
+  if (self->cutout_css_provider) {
+    gtk_style_context_remove_provider_for_screen (screen,
+                                                  GTK_STYLE_PROVIDER (self->cutout_css_provider));
+  }
+  gtk_style_context_add_provider_for_screen (screen,
                                              GTK_STYLE_PROVIDER (provider),
                                              GTK_STYLE_PROVIDER_PRIORITY_APPLICATION + 1);
   g_set_object (&self->cutout_css_provider, provider);
+  g_free (self->cutout_css);
+  self->cutout_css = g_steal_pointer (&css);
 }
 
 
@@ -1056,6 +1102,8 @@ phosh_top_panel_init (PhoshTopPanel *self)
 
   self->cancel = g_cancellable_new ();
   self->state = PHOSH_TOP_PANEL_STATE_UNFOLDED;
+  /* As set up in the template */
+  self->clock_pos = PHOSH_LAYOUT_CLOCK_POS_CENTER;
   self->kb_settings = g_settings_new (KEYBINDINGS_SCHEMA_ID);
   g_signal_connect (self, "configure-event", G_CALLBACK (on_configure_event), NULL);
 
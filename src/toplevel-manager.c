@@ -200,6 +200,19 @@ on_toplevel_closed (PhoshToplevelManager *self, PhoshToplevel *toplevel)
 }
 
 
+static void
+on_toplevel_activated_changed (PhoshToplevelManager *self,
+                               GParamSpec           *pspec,
+                               PhoshToplevel        *toplevel)
+{
+  if (self->app_tracker == NULL || !phosh_toplevel_is_activated (toplevel))
+    return;
+
+  phosh_app_scopes_set_foreground (phosh_app_tracker_get_scopes (self->app_tracker),
+                                   phosh_toplevel_get_app_id (toplevel));
+}
+
+
 static void
 on_toplevel_configured (PhoshToplevelManager *self, GParamSpec *pspec, PhoshToplevel *toplevel)
 {
@@ -217,9 +230,16 @@ on_toplevel_configured (PhoshToplevelManager *self, GParamSpec *pspec, PhoshTopl
   } else {
     g_assert_true (g_ptr_array_remove (self->toplevels_pending, toplevel));
     g_ptr_array_add (self->toplevels, toplevel);
+    if (self->app_tracker)
+      phosh_app_tracker_add_toplevel (self->app_tracker, toplevel);
     g_signal_emit (self, signals[TOPLEVEL_ADDED], 0, toplevel);
     g_object_notify_by_pspec (G_OBJECT (self), props[PROP_NUM_TOPLEVELS]);
 
+    g_signal_connect_object (toplevel, "notify::activated",
+                             G_CALLBACK (on_toplevel_activated_changed), self,
+                             G_CONNECT_SWAPPED);
+    on_toplevel_activated_changed (self, NULL, toplevel);
+
     remove_from_launching (self, toplevel);
   }
 }
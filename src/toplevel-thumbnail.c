@@ -27,6 +27,7 @@
 enum {
   PROP_0,
   PROP_HANDLE,
+  PROP_WITH_DAMAGE,
   PROP_LAST_PROP,
 };
 static GParamSpec *props[PROP_LAST_PROP];
@@ -36,6 +37,8 @@ struct _PhoshToplevelThumbnail {
 
   struct zwlr_screencopy_frame_v1 *handle;
   PhoshWlBuffer *buffer;
+  PhoshWlBufferPool *pool;
+  gboolean with_damage;
 };
 
 G_DEFINE_TYPE (PhoshToplevelThumbnail, phosh_toplevel_thumbnail, PHOSH_TYPE_THUMBNAIL);
@@ -58,8 +61,23 @@ screencopy_handle_buffer (void                            *data,
     return;
   }
 
-  self->buffer = phosh_wl_buffer_new (format, width, height, stride);
-  zwlr_screencopy_frame_v1_copy (zwlr_screencopy_frame_v1, self->buffer->wl_buffer);
+  if (self->pool)
+    self->buffer = phosh_wl_buffer_pool_acquire (self->pool, format, width, height, stride);
+  else
+    self->buffer = phosh_wl_buffer_new (format, width, height, stride);
+
+  if (!self->buffer) {
+    g_warning ("Failed to allocate thumbnail buffer");
+    return;
+  }
+
+  if (self->with_damage &&
+      zwlr_screencopy_frame_v1_get_version (zwlr_screencopy_frame_v1) >=
+      ZWLR_SCREENCOPY_FRAME_V1_COPY_WITH_DAMAGE_SINCE_VERSION) {
+    zwlr_screencopy_frame_v1_copy_with_damage (zwlr_screencopy_frame_v1, self->buffer->wl_buffer);
+  } else {
+    zwlr_screencopy_frame_v1_copy (zwlr_screencopy_frame_v1, self->buffer->wl_buffer);
+  }
 }
 
 
@@ -97,14 +115,42 @@ screencopy_handle_damage (void                            *data,
                           uint32_t                         width,
                           uint32_t                         height)
 {
+  PhoshThumbnail *self = PHOSH_THUMBNAIL (data);
+
+  g_debug ("%s: %ux%u+%u+%u", __func__, width, height, x, y);
+  phosh_thumbnail_add_damage (self, x, y, width, height);
+}
+
+static void
+screencopy_handle_linux_dmabuf (void                            *data,
+                                struct zwlr_screencopy_frame_v1 *zwlr_screencopy_frame_v1,
+                                uint32_t                         format,
+                                uint32_t                         width,
+                                uint32_t                         height)
+{
+  /* We need CPU access to the pixels, so stick to shm */
+  g_debug ("%s: %dx%d, format 0x%x", __func__, width, height, format);
+}
+
+static void
+screencopy_handle_buffer_done (void                            *data,
+                               struct zwlr_screencopy_frame_v1 *zwlr_screencopy_frame_v1)
+{
+  PhoshToplevelThumbnail *self = PHOSH_TOPLEVEL_THUMBNAIL (data);
+
+  /* The copy is already started when receiving the shm buffer event */
+  if (!self->buffer)
+    g_warning ("No usable buffer type for thumbnail %p", self);
 }
 
 static const struct zwlr_screencopy_frame_v1_listener zwlr_screencopy_frame_listener = {
-  screencopy_handle_buffer,
-  screencopy_handle_flags,
-  screencopy_handle_ready,
-  screencopy_handle_failed,
-  screencopy_handle_damage
+  .buffer = screencopy_handle_buffer,
+  .flags = screencopy_handle_flags,
+  .ready = screencopy_handle_ready,
+  .failed = screencopy_handle_failed,
+  .damage = screencopy_handle_damage,
+  .linux_dmabuf = screencopy_handle_linux_dmabuf,
+  .buffer_done = screencopy_handle_buffer_done,
 };
 
 
@@ -145,6 +191,9 @@ phosh_toplevel_thumbnail_set_property (GObject      *object,
   case PROP_HANDLE:
     self->handle = g_value_get_pointer (value);
     break;
+  case PROP_WITH_DAMAGE:
+    self->with_damage = g_value_get_boolean (value);
+    break;
   default:
     G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     break;
@@ -164,6 +213,9 @@ phosh_toplevel_thumbnail_get_property (GObject    *object,
   case PROP_HANDLE:
     g_value_set_pointer (value, self->handle);
     break;
+  case PROP_WITH_DAMAGE:
+    g_value_set_boolean (value, self->with_damage);
+    break;
   default:
     G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     break;
@@ -198,6 +250,7 @@ phosh_toplevel_thumbnail_finalize (GObject *object)
   PhoshToplevelThumbnail *self = PHOSH_TOPLEVEL_THUMBNAIL (object);
 
   g_clear_pointer (&self->buffer, phosh_wl_buffer_destroy);
+  g_clear_pointer (&self->pool, phosh_wl_buffer_pool_unref);
 
   G_OBJECT_CLASS (phosh_toplevel_thumbnail_parent_class)->finalize (object);
 }
@@ -227,6 +280,16 @@ phosh_toplevel_thumbnail_class_init (PhoshToplevelThumbnailClass *klass)
   props[PROP_HANDLE] =
     g_param_spec_pointer ("handle", "", "",
                           G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+  /**
+   * PhoshToplevelThumbnail:with-damage:
+   *
+   * Whether to only copy the frame once it got damaged. The damaged
+   * region is then available via [method@Thumbnail.get_damage].
+   */
+  props[PROP_WITH_DAMAGE] =
+    g_param_spec_boolean ("with-damage", "", "",
+                          FALSE,
+                          G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
 
   g_object_class_install_properties (object_class, PROP_LAST_PROP, props);
 }
@@ -239,19 +302,41 @@ phosh_toplevel_thumbnail_init (PhoshToplevelThumbnail *self)
 
 
 static PhoshToplevelThumbnail *
-phosh_toplevel_thumbnail_new_from_handle (struct zwlr_screencopy_frame_v1 *handle)
+phosh_toplevel_thumbnail_new_from_handle (struct zwlr_screencopy_frame_v1 *handle,
+                                          gboolean                         with_damage)
 {
-  return g_object_new (PHOSH_TYPE_TOPLEVEL_THUMBNAIL, "handle", handle, NULL);
+  return g_object_new (PHOSH_TYPE_TOPLEVEL_THUMBNAIL,
+                       "handle", handle,
+                       "with-damage", with_damage,
+                       NULL);
 }
 
+/**
+ * phosh_toplevel_thumbnail_new_from_toplevel:
+ * @toplevel: The toplevel to get the thumbnail for
+ * @pool:(nullable): A buffer pool to get the thumbnail's buffer from
+ * @max_width: The maximum thumbnail width
+ * @max_height: The maximum thumbnail height
+ * @with_damage: Whether to wait for damage and report the damaged region
+ *
+ * Requests a thumbnail of the given toplevel from the compositor.
+ * When @with_damage is set and the compositor supports it the image is
+ * only copied once the toplevel changed and the thumbnail carries the
+ * damaged region so consumers can update a previous copy incrementally.
+ *
+ * Returns: The thumbnail
+ */
 PhoshToplevelThumbnail *
-phosh_toplevel_thumbnail_new_from_toplevel (PhoshToplevel *toplevel,
-                                            guint32        max_width,
-                                            guint32        max_height)
+phosh_toplevel_thumbnail_new_from_toplevel (PhoshToplevel     *toplevel,
+                                            PhoshWlBufferPool *pool,
+                                            guint32            max_width,
+                                            guint32            max_height,
+                                            gboolean           with_damage)
 {
   struct zwlr_foreign_toplevel_handle_v1 *handle = phosh_toplevel_get_handle (toplevel);
   struct phosh_private *phosh = phosh_wayland_get_phosh_private (phosh_wayland_get_default ());
   struct zwlr_screencopy_frame_v1 *frame;
+  PhoshToplevelThumbnail *self;
 
   if (!phosh || phosh_private_get_version (phosh) < PHOSH_PRIVATE_GET_THUMBNAIL_SINCE_VERSION)
     return NULL;
@@ -261,5 +346,9 @@ phosh_toplevel_thumbnail_new_from_toplevel (PhoshToplevel *toplevel,
 
   frame = phosh_private_get_thumbnail (phosh, handle, max_width, max_height);
 
-  return phosh_toplevel_thumbnail_new_from_handle (frame);
+  self = phosh_toplevel_thumbnail_new_from_handle (frame, with_damage);
+  if (pool)
+    self->pool = phosh_wl_buffer_pool_ref (pool);
+
+  return self;
 }
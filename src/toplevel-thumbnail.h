@@ -10,6 +10,7 @@
 #include "wlr-screencopy-unstable-v1-client-protocol.h"
 #include "thumbnail.h"
 #include "toplevel.h"
+#include "wl-buffer.h"
 
 #define PHOSH_TYPE_TOPLEVEL_THUMBNAIL (phosh_toplevel_thumbnail_get_type())
 
@@ -20,5 +21,7 @@ G_DECLARE_FINAL_TYPE (PhoshToplevelThumbnail,
                       PhoshThumbnail)
 
 PhoshToplevelThumbnail *phosh_toplevel_thumbnail_new_from_toplevel (PhoshToplevel                   *toplevel,
+                                                                    PhoshWlBufferPool               *pool,
                                                                     guint32                          max_width,
-                                                                    guint32                          max_height);
+                                                                    guint32                          max_height,
+                                                                    gboolean                         with_damage);
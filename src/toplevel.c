@@ -47,6 +47,7 @@ struct _PhoshToplevel {
   gboolean configured, activated, maximized, fullscreen;
   char *title;
   char *app_id;
+  GPtrArray *outputs; /* (element-type struct wl_output) */
 };
 
 G_DEFINE_TYPE (PhoshToplevel, phosh_toplevel, G_TYPE_OBJECT);
@@ -88,6 +89,11 @@ handle_zwlr_foreign_toplevel_handle_output_enter(
   struct zwlr_foreign_toplevel_handle_v1 *zwlr_foreign_toplevel_handle_v1,
   struct wl_output *output)
 {
+  PhoshToplevel *self = data;
+  g_return_if_fail (PHOSH_IS_TOPLEVEL (self));
+
+  if (!g_ptr_array_find (self->outputs, output, NULL))
+    g_ptr_array_add (self->outputs, output);
 }
 
 
@@ -97,6 +103,10 @@ handle_zwlr_foreign_toplevel_handle_output_leave(
   struct zwlr_foreign_toplevel_handle_v1 *zwlr_foreign_toplevel_handle_v1,
   struct wl_output *output)
 {
+  PhoshToplevel *self = data;
+  g_return_if_fail (PHOSH_IS_TOPLEVEL (self));
+
+  g_ptr_array_remove (self->outputs, output);
 }
 
 
@@ -209,6 +219,7 @@ phosh_toplevel_finalize (GObject *object)
 
   g_clear_pointer (&self->app_id, g_free);
   g_clear_pointer (&self->title, g_free);
+  g_clear_pointer (&self->outputs, g_ptr_array_unref);
 
   G_OBJECT_CLASS (phosh_toplevel_parent_class)->finalize (object);
 }
@@ -367,6 +378,7 @@ phosh_toplevel_class_init (PhoshToplevelClass *klass)
 static void
 phosh_toplevel_init (PhoshToplevel *self)
 {
+  self->outputs = g_ptr_array_new ();
 }
 
 
@@ -441,6 +453,21 @@ phosh_toplevel_is_fullscreen (PhoshToplevel *self)
 }
 
 
+/**
+ * phosh_toplevel_is_on_output:
+ * @self: The toplevel
+ * @output: The output
+ *
+ * Returns: %TRUE if the toplevel is (at least partially) shown on @output
+ */
+gboolean
+phosh_toplevel_is_on_output (PhoshToplevel *self, struct wl_output *output)
+{
+  g_return_val_if_fail (PHOSH_IS_TOPLEVEL (self), FALSE);
+  return g_ptr_array_find (self->outputs, output, NULL);
+}
+
+
 void
 phosh_toplevel_activate (PhoshToplevel *self, struct wl_seat *seat)
 {
@@ -26,6 +26,7 @@ gboolean phosh_toplevel_is_configured (PhoshToplevel *self);
 gboolean phosh_toplevel_is_activated (PhoshToplevel *self);
 gboolean phosh_toplevel_is_maximized (PhoshToplevel *self);
 gboolean phosh_toplevel_is_fullscreen (PhoshToplevel *self);
+gboolean phosh_toplevel_is_on_output (PhoshToplevel *self, struct wl_output *output);
 void phosh_toplevel_activate (PhoshToplevel *self, struct wl_seat *seat);
 void phosh_toplevel_close (PhoshToplevel *self);
 void phosh_toplevel_fullscreen (PhoshToplevel *self, gboolean fullscreen);
@@ -17,7 +17,11 @@
 #include "udev-manager.h"
 #include "dbus/login1-session-dbus.h"
 
+#include <errno.h>
+#include <fcntl.h>
 #include <math.h>
+#include <string.h>
+#include <unistd.h>
 
 #define TORCH_SUBSYSTEM "leds"
 
@@ -31,6 +35,11 @@
  *
  * #PhoshTorchManager tracks the torch status and
  * allows to set the brightness.
+ *
+ * Brightness changes are reflected right away and rolled back to
+ * the device's actual brightness should setting it fail. If the
+ * device's sysfs attribute is writable (e.g. due to udev ACLs) it's
+ * written directly, otherwise logind is asked to change it.
  */
 
 enum {
@@ -57,6 +66,10 @@ struct _PhoshTorchManager {
   int                    last_brightness;
 
   GUdevDevice           *udev_device;
+  /* Whether we can write the brightness attribute ourselves */
+  gboolean               direct_write;
+  /* logind requests in flight */
+  guint                  n_pending;
 
   PhoshDBusLoginSession *session_proxy;
   GCancellable          *cancel;
@@ -65,19 +78,20 @@ G_DEFINE_TYPE (PhoshTorchManager, phosh_torch_manager, PHOSH_TYPE_MANAGER);
 
 
 static void
-apply_brightness (PhoshTorchManager *self)
+update_brightness (PhoshTorchManager *self, int brightness)
 {
   const char *icon_name;
 
-  g_return_if_fail (PHOSH_IS_TORCH_MANAGER (self));
-  g_return_if_fail (G_UDEV_IS_DEVICE (self->udev_device));
-
   g_object_freeze_notify (G_OBJECT (self));
 
-  self->brightness = g_udev_device_get_sysfs_attr_as_int_uncached (self->udev_device,
-                                                                   "brightness");
-  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_BRIGHTNESS]);
-  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_ENABLED]);
+  if (self->brightness != brightness) {
+    gboolean was_enabled = !!self->brightness;
+
+    self->brightness = brightness;
+    g_object_notify_by_pspec (G_OBJECT (self), props[PROP_BRIGHTNESS]);
+    if (was_enabled != !!brightness)
+      g_object_notify_by_pspec (G_OBJECT (self), props[PROP_ENABLED]);
+  }
 
   icon_name = self->brightness ? TORCH_ENABLED_ICON : TORCH_DISABLED_ICON;
   if (icon_name != self->icon_name) {
@@ -89,22 +103,76 @@ apply_brightness (PhoshTorchManager *self)
 }
 
 
+static void
+apply_brightness (PhoshTorchManager *self)
+{
+  int brightness;
+
+  g_return_if_fail (PHOSH_IS_TORCH_MANAGER (self));
+  g_return_if_fail (G_UDEV_IS_DEVICE (self->udev_device));
+
+  brightness = g_udev_device_get_sysfs_attr_as_int_uncached (self->udev_device, "brightness");
+  update_brightness (self, brightness);
+}
+
+
 static void
 on_brightness_set (GObject *source_object, GAsyncResult *res, gpointer user_data)
 {
   PhoshDBusLoginSession *proxy = PHOSH_DBUS_LOGIN_SESSION (source_object);
-  PhoshTorchManager *self = PHOSH_TORCH_MANAGER (user_data);
+  PhoshTorchManager *self;
   g_autoptr (GError) err = NULL;
+  gboolean success;
+
+  success = phosh_dbus_login_session_call_set_brightness_finish (proxy, res, &err);
+  if (!success && g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    return;
 
+  self = PHOSH_TORCH_MANAGER (user_data);
   g_return_if_fail (PHOSH_IS_TORCH_MANAGER (self));
-  g_return_if_fail (PHOSH_DBUS_IS_LOGIN_SESSION (proxy));
 
-  if (!phosh_dbus_login_session_call_set_brightness_finish (proxy, res, &err)) {
+  if (!success)
     g_warning ("Failed to set torch brightness: %s", err->message);
-    return;
+
+  /* Only sync with the device once the last request finished to not flicker */
+  self->n_pending--;
+  if (self->n_pending == 0)
+    apply_brightness (self);
+}
+
+
+static gboolean
+write_brightness (PhoshTorchManager *self, int brightness, GError **error)
+{
+  g_autofree char *path = NULL;
+  g_autofree char *value = NULL;
+  int fd;
+  gssize len, ret;
+
+  path = g_build_filename (g_udev_device_get_sysfs_path (self->udev_device), "brightness", NULL);
+  fd = open (path, O_WRONLY | O_CLOEXEC);
+  if (fd < 0) {
+    int saved_errno = errno;
+
+    g_set_error (error, G_IO_ERROR, g_io_error_from_errno (saved_errno),
+                 "Failed to open %s: %s", path, g_strerror (saved_errno));
+    return FALSE;
+  }
+
+  value = g_strdup_printf ("%d", brightness);
+  len = strlen (value);
+  ret = write (fd, value, len);
+  if (ret != len) {
+    int saved_errno = ret < 0 ? errno : EIO;
+
+    g_set_error (error, G_IO_ERROR, g_io_error_from_errno (saved_errno),
+                 "Failed to write %s: %s", path, g_strerror (saved_errno));
+    close (fd);
+    return FALSE;
   }
 
-  apply_brightness (self);
+  close (fd);
+  return TRUE;
 }
 
 
@@ -118,11 +186,31 @@ set_brightness (PhoshTorchManager *self, int brightness)
 
   g_debug ("Setting brightness to %d", brightness);
 
+  /* Reflect the change right away, we roll back on failure */
+  update_brightness (self, brightness);
+
+  if (self->direct_write && self->n_pending == 0) {
+    g_autoptr (GError) err = NULL;
+
+    if (write_brightness (self, brightness, &err))
+      return;
+
+    if (g_error_matches (err, G_IO_ERROR, G_IO_ERROR_PERMISSION_DENIED)) {
+      g_debug ("%s, using logind", err->message);
+      self->direct_write = FALSE;
+    } else {
+      g_warning ("Failed to set torch brightness: %s", err->message);
+      apply_brightness (self);
+      return;
+    }
+  }
+
+  self->n_pending++;
   phosh_dbus_login_session_call_set_brightness (self->session_proxy,
                                                 TORCH_SUBSYSTEM,
                                                 g_udev_device_get_name (self->udev_device),
                                                 (guint) brightness,
-                                                NULL,
+                                                self->cancel,
                                                 on_brightness_set,
                                                 self);
 }
@@ -217,6 +305,7 @@ phosh_torch_manager_idle_init (PhoshManager *manager)
 
   self->session_proxy = phosh_udev_manager_get_session_proxy (udev_manager);
   self->present = find_torch_device (self, udev_manager);
+  self->cancel = g_cancellable_new ();
 
   if (self->present) {
     g_object_freeze_notify (G_OBJECT (self));
@@ -319,6 +408,8 @@ phosh_torch_manager_init (PhoshTorchManager *self)
 {
   self->icon_name = TORCH_DISABLED_ICON;
   self->max_brightness = 1;
+  /* Until we know better */
+  self->direct_write = TRUE;
 }
 
 
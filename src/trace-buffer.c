@@ -0,0 +1,393 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "phosh-trace-buffer"
+
+#include "phosh-config.h"
+
+#include "trace-buffer.h"
+
+#include <gio/gio.h>
+
+#include <unistd.h>
+
+/**
+ * PhoshTraceBuffer:
+ *
+ * Records timed spans of runtime toggleable categories
+ *
+ * Spans of the enabled [enum@TraceCategory]s are kept in a ring buffer
+ * of the last `MAX_EVENTS` events so traces can be captured on
+ * devices without restarting the shell or running sysprof. When
+ * nothing is enabled recording is a single atomic read.
+ *
+ * The trace can be exported in the Trace Event format understood by
+ * e.g. Perfetto's UI. It's available via the `GetTrace` method of
+ * `mobi.phosh.Shell.DebugControl`, categories are toggled via its
+ * `TraceCategories` property.
+ *
+ * Spans can be added from any thread as D-Bus calls are timed in
+ * GDBus' worker thread.
+ */
+
+#define MAX_EVENTS 4096
+/* Calls whose reply we never see (e.g. on timeouts) shouldn't pile up */
+#define MAX_PENDING_CALLS 256
+
+typedef struct {
+  const char         *name;     /* interned */
+  PhoshTraceCategory  category;
+  gint64              start;
+  gint64              end;
+} PhoshTraceEvent;
+
+typedef struct {
+  const char *name;             /* interned */
+  gint64      start;
+} PhoshTraceCall;
+
+typedef struct {
+  GDBusConnection *connection;
+  guint            filter_id;
+  /* key: serial, value: PhoshTraceCall */
+  GHashTable      *pending;
+} PhoshTraceFilter;
+
+static const struct {
+  PhoshTraceCategory  category;
+  const char         *name;
+} category_names[] = {
+  { PHOSH_TRACE_CATEGORY_FRAME, "frame" },
+  { PHOSH_TRACE_CATEGORY_DBUS, "dbus" },
+  { PHOSH_TRACE_CATEGORY_LAYER_SURFACE, "layer-surface" },
+  { PHOSH_TRACE_CATEGORY_SEARCH, "search" },
+  { PHOSH_TRACE_CATEGORY_OSK, "osk" },
+};
+
+static struct {
+  gint             categories;
+  PhoshTraceEvent *events;
+  guint            n_events;
+  guint            next;
+  GPtrArray       *filters;
+} trace_buffer;
+
+G_LOCK_DEFINE_STATIC (trace_buffer);
+
+
+static const char *
+get_category_name (PhoshTraceCategory category)
+{
+  for (guint i = 0; i < G_N_ELEMENTS (category_names); i++) {
+    if (category_names[i].category == category)
+      return category_names[i].name;
+  }
+
+  return "unknown";
+}
+
+
+static GDBusMessage *
+on_dbus_message (GDBusConnection *connection,
+                 GDBusMessage    *message,
+                 gboolean         incoming,
+                 gpointer         user_data)
+{
+  PhoshTraceFilter *filter = user_data;
+  GDBusMessageType type = g_dbus_message_get_message_type (message);
+  PhoshTraceCall *call = NULL;
+
+  if (!incoming) {
+    g_autofree char *name = NULL;
+
+    if (type != G_DBUS_MESSAGE_TYPE_METHOD_CALL ||
+        g_dbus_message_get_flags (message) & G_DBUS_MESSAGE_FLAGS_NO_REPLY_EXPECTED)
+      return message;
+
+    name = g_strdup_printf ("%s.%s",
+                            g_dbus_message_get_interface (message) ?: "",
+                            g_dbus_message_get_member (message));
+    call = g_new (PhoshTraceCall, 1);
+    call->name = g_intern_string (name);
+    call->start = g_get_monotonic_time ();
+
+    G_LOCK (trace_buffer);
+    if (g_hash_table_size (filter->pending) >= MAX_PENDING_CALLS)
+      g_hash_table_remove_all (filter->pending);
+    g_hash_table_insert (filter->pending,
+                         GUINT_TO_POINTER (g_dbus_message_get_serial (message)),
+                         call);
+    G_UNLOCK (trace_buffer);
+
+    return message;
+  }
+
+  if (type != G_DBUS_MESSAGE_TYPE_METHOD_RETURN && type != G_DBUS_MESSAGE_TYPE_ERROR)
+    return message;
+
+  G_LOCK (trace_buffer);
+  g_hash_table_steal_extended (filter->pending,
+                               GUINT_TO_POINTER (g_dbus_message_get_reply_serial (message)),
+                               NULL,
+                               (gpointer *)&call);
+  G_UNLOCK (trace_buffer);
+
+  if (call) {
+    phosh_trace_buffer_add (PHOSH_TRACE_CATEGORY_DBUS, call->name, call->start,
+                            g_get_monotonic_time ());
+    g_free (call);
+  }
+
+  return message;
+}
+
+
+static void
+filter_free (gpointer data)
+{
+  PhoshTraceFilter *filter = data;
+
+  g_hash_table_destroy (filter->pending);
+  g_object_unref (filter->connection);
+  g_free (filter);
+}
+
+
+static void
+add_dbus_filter (GBusType bus_type)
+{
+  g_autoptr (GError) err = NULL;
+  PhoshTraceFilter *filter;
+  GDBusConnection *connection;
+
+  connection = g_bus_get_sync (bus_type, NULL, &err);
+  if (connection == NULL) {
+    g_warning ("Failed to trace D-Bus calls: %s", err->message);
+    return;
+  }
+
+  filter = g_new0 (PhoshTraceFilter, 1);
+  filter->connection = connection;
+  filter->pending = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+  filter->filter_id = g_dbus_connection_add_filter (connection,
+                                                    on_dbus_message,
+                                                    filter,
+                                                    filter_free);
+  g_ptr_array_add (trace_buffer.filters, filter);
+}
+
+
+static void
+set_dbus_tracing (gboolean enabled)
+{
+  if (enabled) {
+    if (trace_buffer.filters == NULL)
+      trace_buffer.filters = g_ptr_array_new ();
+
+    add_dbus_filter (G_BUS_TYPE_SESSION);
+    add_dbus_filter (G_BUS_TYPE_SYSTEM);
+    return;
+  }
+
+  for (guint i = 0; trace_buffer.filters && i < trace_buffer.filters->len; i++) {
+    PhoshTraceFilter *filter = g_ptr_array_index (trace_buffer.filters, i);
+    /* The filter's data might be gone once removed */
+    g_autoptr (GDBusConnection) connection = g_object_ref (filter->connection);
+
+    g_dbus_connection_remove_filter (connection, filter->filter_id);
+  }
+  g_clear_pointer (&trace_buffer.filters, g_ptr_array_unref);
+}
+
+/**
+ * phosh_trace_buffer_set_categories:
+ * @categories: The categories to record
+ *
+ * Set the categories to record spans for. Spans recorded so far are
+ * kept.
+ */
+void
+phosh_trace_buffer_set_categories (PhoshTraceCategory categories)
+{
+  PhoshTraceCategory old = phosh_trace_buffer_get_categories ();
+
+  if (old == categories)
+    return;
+
+  g_debug ("Tracing categories 0x%x", categories);
+
+  G_LOCK (trace_buffer);
+  if (categories && trace_buffer.events == NULL)
+    trace_buffer.events = g_new0 (PhoshTraceEvent, MAX_EVENTS);
+  G_UNLOCK (trace_buffer);
+
+  g_atomic_int_set (&trace_buffer.categories, categories);
+
+  if ((old ^ categories) & PHOSH_TRACE_CATEGORY_DBUS)
+    set_dbus_tracing (!!(categories & PHOSH_TRACE_CATEGORY_DBUS));
+}
+
+
+PhoshTraceCategory
+phosh_trace_buffer_get_categories (void)
+{
+  return g_atomic_int_get (&trace_buffer.categories);
+}
+
+/**
+ * phosh_trace_buffer_is_enabled:
+ * @category: The category
+ *
+ * Use this to avoid taking timestamps when a category isn't recorded.
+ *
+ * Returns: %TRUE if spans of @category are recorded
+ */
+gboolean
+phosh_trace_buffer_is_enabled (PhoshTraceCategory category)
+{
+  return !!(g_atomic_int_get (&trace_buffer.categories) & category);
+}
+
+/**
+ * phosh_trace_buffer_add:
+ * @category: The span's category
+ * @name: The span's name
+ * @start: The monotonic start time of the span
+ * @end: The monotonic end time of the span
+ *
+ * Records a span. Once the buffer is full the oldest span gets
+ * dropped. Does nothing if @category isn't enabled.
+ */
+void
+phosh_trace_buffer_add (PhoshTraceCategory  category,
+                        const char         *name,
+                        gint64              start,
+                        gint64              end)
+{
+  PhoshTraceEvent *event;
+
+  if (!phosh_trace_buffer_is_enabled (category))
+    return;
+
+  name = g_intern_string (name ?: "(unnamed)");
+
+  G_LOCK (trace_buffer);
+  event = &trace_buffer.events[trace_buffer.next];
+  *event = (PhoshTraceEvent) {
+    .name = name,
+    .category = category,
+    .start = start,
+    .end = MAX (start, end),
+  };
+  trace_buffer.next = (trace_buffer.next + 1) % MAX_EVENTS;
+  trace_buffer.n_events = MIN (trace_buffer.n_events + 1, MAX_EVENTS);
+  G_UNLOCK (trace_buffer);
+}
+
+/**
+ * phosh_trace_buffer_clear:
+ *
+ * Drop the spans recorded so far.
+ */
+void
+phosh_trace_buffer_clear (void)
+{
+  G_LOCK (trace_buffer);
+  trace_buffer.n_events = trace_buffer.next = 0;
+  G_UNLOCK (trace_buffer);
+}
+
+/**
+ * phosh_trace_buffer_to_json:
+ *
+ * Get the recorded spans, oldest first, in the Trace Event JSON format.
+ *
+ * Returns:(transfer full): The trace as JSON
+ */
+char *
+phosh_trace_buffer_to_json (void)
+{
+  g_autofree PhoshTraceEvent *events = NULL;
+  GString *json = g_string_new ("{\"traceEvents\":[");
+  int pid = getpid ();
+  guint n_events, first;
+
+  /* Copy so formatting doesn't block recording threads */
+  G_LOCK (trace_buffer);
+  n_events = trace_buffer.n_events;
+  first = (trace_buffer.next + MAX_EVENTS - n_events) % MAX_EVENTS;
+  events = g_new (PhoshTraceEvent, MAX (n_events, 1));
+  for (guint i = 0; i < n_events; i++)
+    events[i] = trace_buffer.events[(first + i) % MAX_EVENTS];
+  G_UNLOCK (trace_buffer);
+
+  for (guint i = 0; i < n_events; i++) {
+    PhoshTraceEvent *event = &events[i];
+    g_autofree char *name = g_strescape (event->name, NULL);
+
+    if (i)
+      g_string_append_c (json, ',');
+
+    g_string_append_printf (json, "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\","
+                            "\"pid\":%d,\"tid\":%d,"
+                            "\"ts\":%" G_GINT64_FORMAT ",\"dur\":%" G_GINT64_FORMAT "}",
+                            name, get_category_name (event->category), pid, pid,
+                            event->start, event->end - event->start);
+  }
+
+  g_string_append (json, "]}");
+  return g_string_free (json, FALSE);
+}
+
+/**
+ * phosh_trace_buffer_categories_to_strv:
+ * @categories: The categories
+ *
+ * Returns:(transfer full): The names of the given categories
+ */
+GStrv
+phosh_trace_buffer_categories_to_strv (PhoshTraceCategory categories)
+{
+  g_autoptr (GStrvBuilder) builder = g_strv_builder_new ();
+
+  for (guint i = 0; i < G_N_ELEMENTS (category_names); i++) {
+    if (categories & category_names[i].category)
+      g_strv_builder_add (builder, category_names[i].name);
+  }
+
+  return g_strv_builder_end (builder);
+}
+
+/**
+ * phosh_trace_buffer_categories_from_strv:
+ * @names:(nullable): The category names
+ *
+ * Unknown names are ignored.
+ *
+ * Returns: The categories matching the given names
+ */
+PhoshTraceCategory
+phosh_trace_buffer_categories_from_strv (const char *const *names)
+{
+  PhoshTraceCategory categories = PHOSH_TRACE_CATEGORY_NONE;
+
+  for (guint i = 0; names && names[i]; i++) {
+    gboolean found = FALSE;
+
+    for (guint j = 0; j < G_N_ELEMENTS (category_names); j++) {
+      if (g_str_equal (names[i], category_names[j].name)) {
+        categories |= category_names[j].category;
+        found = TRUE;
+        break;
+      }
+    }
+
+    if (!found)
+      g_warning ("Unknown trace category '%s'", names[i]);
+  }
+
+  return categories;
+}
@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/**
+ * PhoshTraceCategory:
+ * @PHOSH_TRACE_CATEGORY_NONE: No category
+ * @PHOSH_TRACE_CATEGORY_FRAME: Frame timings of layer surfaces
+ * @PHOSH_TRACE_CATEGORY_DBUS: Latency of outgoing D-Bus method calls
+ * @PHOSH_TRACE_CATEGORY_LAYER_SURFACE: Layer surface configures
+ * @PHOSH_TRACE_CATEGORY_SEARCH: Search query latency
+ * @PHOSH_TRACE_CATEGORY_OSK: On screen keyboard show latency
+ *
+ * The categories that can be traced at runtime.
+ */
+typedef enum {
+  PHOSH_TRACE_CATEGORY_NONE          = 0,
+  PHOSH_TRACE_CATEGORY_FRAME         = 1 << 0,
+  PHOSH_TRACE_CATEGORY_DBUS          = 1 << 1,
+  PHOSH_TRACE_CATEGORY_LAYER_SURFACE = 1 << 2,
+  PHOSH_TRACE_CATEGORY_SEARCH        = 1 << 3,
+  PHOSH_TRACE_CATEGORY_OSK           = 1 << 4,
+} PhoshTraceCategory;
+
+void                phosh_trace_buffer_set_categories  (PhoshTraceCategory categories);
+PhoshTraceCategory  phosh_trace_buffer_get_categories  (void);
+gboolean            phosh_trace_buffer_is_enabled      (PhoshTraceCategory category);
+void                phosh_trace_buffer_add             (PhoshTraceCategory category,
+                                                        const char        *name,
+                                                        gint64             start,
+                                                        gint64             end);
+void                phosh_trace_buffer_clear           (void);
+char               *phosh_trace_buffer_to_json         (void);
+GStrv               phosh_trace_buffer_categories_to_strv   (PhoshTraceCategory categories);
+PhoshTraceCategory  phosh_trace_buffer_categories_from_strv (const char *const *names);
+
+G_END_DECLS
@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+/* Not all users include it first */
+#include "phosh-config.h"
+
+#include <glib.h>
+
+/*
+ * Marks spanning hot code paths so shell work can be correlated with
+ * the compositor's frames in sysprof. Compiled out unless built with
+ * `-Dsysprof=enabled`.
+ *
+ * Use `PHOSH_TRACE_CURRENT_TIME` to record the start of a span and
+ * `PHOSH_TRACE_MARK (begin, name, format, ...)` to emit it. When tracing
+ * is compiled out the start time is `0`.
+ */
+
+#ifdef PHOSH_HAVE_SYSPROF
+
+#include <sysprof-capture.h>
+
+#define PHOSH_TRACE_CURRENT_TIME SYSPROF_CAPTURE_CURRENT_TIME
+
+#define PHOSH_TRACE_MARK(begin, name, ...)                               \
+  G_STMT_START {                                                        \
+    gint64 __phosh_trace_begin = (begin);                               \
+    sysprof_collector_mark_printf (__phosh_trace_begin,                 \
+                                   SYSPROF_CAPTURE_CURRENT_TIME - __phosh_trace_begin, \
+                                   "phosh", (name), __VA_ARGS__);       \
+  } G_STMT_END
+
+#else
+
+#define PHOSH_TRACE_CURRENT_TIME ((gint64) 0)
+
+#define PHOSH_TRACE_MARK(begin, name, ...) G_STMT_START { (void) (begin); } G_STMT_END
+
+#endif
@@ -14,6 +14,7 @@
 
 #include "phosh-config.h"
 
+#include "app-grid-button.h"
 #include "app-list-model.h"
 
 #include "util.h"
@@ -50,31 +51,29 @@ phosh_cp_widget_destroy (void *widget)
 }
 
 
-/**
- * phosh_get_desktop_app_info_for_app_id:
- * @app_id: the app_id
- *
- * Looks up an app info object for specified application ID.
- * Tries a bunch of transformations in order to maximize compatibility
- * with X11 and non-GTK applications that may not report the exact same
- * string as their app-id and in their desktop file.
- *
- * Returns: (transfer full)(nullable): GDesktopAppInfo for requested app_id
- */
-GDesktopAppInfo *
-phosh_get_desktop_app_info_for_app_id (const char *app_id)
+static GDesktopAppInfo *
+desktop_app_info_new (PhoshAppListModel *model, const char *desktop_id)
+{
+  GAppInfo *app_info = phosh_app_list_model_lookup_by_id (model, desktop_id);
+
+  if (G_IS_DESKTOP_APP_INFO (app_info))
+    return G_DESKTOP_APP_INFO (g_object_ref (app_info));
+
+  return g_desktop_app_info_new (desktop_id);
+}
+
+
+static GDesktopAppInfo *
+resolve_desktop_app_info (PhoshAppListModel *model, const char *app_id)
 {
   g_autofree char *desktop_id = NULL;
   g_autofree char *lowercase = NULL;
   GDesktopAppInfo *app_info = NULL;
   char *last_component;
-  PhoshAppListModel *model = phosh_app_list_model_get_default ();
-
-  g_assert (app_id);
 
   desktop_id = g_strdup_printf ("%s.desktop", app_id);
   g_return_val_if_fail (desktop_id, NULL);
-  app_info = g_desktop_app_info_new (desktop_id);
+  app_info = desktop_app_info_new (model, desktop_id);
 
   if (app_info)
     return app_info;
@@ -95,7 +94,7 @@ phosh_get_desktop_app_info_for_app_id (const char *app_id)
     g_free (desktop_id);
     desktop_id = g_strdup_printf ("%s.desktop", last_component);
     g_return_val_if_fail (desktop_id, NULL);
-    app_info = g_desktop_app_info_new (desktop_id);
+    app_info = desktop_app_info_new (model, desktop_id);
     if (app_info)
       return app_info;
   }
@@ -116,6 +115,37 @@ phosh_get_desktop_app_info_for_app_id (const char *app_id)
   return NULL;
 }
 
+/**
+ * phosh_get_desktop_app_info_for_app_id:
+ * @app_id: the app_id
+ *
+ * Looks up an app info object for specified application ID.
+ * Tries a bunch of transformations in order to maximize compatibility
+ * with X11 and non-GTK applications that may not report the exact same
+ * string as their app-id and in their desktop file.
+ *
+ * Results (including failed lookups) are cached until the installed
+ * applications change.
+ *
+ * Returns: (transfer full)(nullable): GDesktopAppInfo for requested app_id
+ */
+GDesktopAppInfo *
+phosh_get_desktop_app_info_for_app_id (const char *app_id)
+{
+  PhoshAppListModel *model = phosh_app_list_model_get_default ();
+  GDesktopAppInfo *app_info = NULL;
+
+  g_assert (app_id);
+
+  if (phosh_app_list_model_lookup_app_id_cache (model, app_id, &app_info))
+    return app_info;
+
+  app_info = resolve_desktop_app_info (model, app_id);
+  phosh_app_list_model_cache_app_id (model, app_id, app_info);
+
+  return app_info;
+}
+
 /**
  * phosh_munge_app_id:
  * @app_id: the app_id
@@ -534,6 +564,30 @@ phosh_clear_fd (int *fd, GError **err)
   return g_clear_fd (fd, err);
 }
 
+/**
+ * phosh_util_get_wifi_strength_bucket:
+ * @strength: An integer representing the strength of Wi-Fi
+ *
+ * Map the signal strength to one of the buckets displayed to the user so
+ * callers can ignore changes that aren't visible.
+ *
+ * Returns: The bucket from `0` (no signal) to `4` (excellent)
+ */
+guint
+phosh_util_get_wifi_strength_bucket (guint strength)
+{
+  if (strength > 80)
+    return 4;
+  else if (strength > 55)
+    return 3;
+  else if (strength > 30)
+    return 2;
+  else if (strength > 5)
+    return 1;
+
+  return 0;
+}
+
 /**
  * phosh_util_get_icon_by_wifi_strength:
  * @strength: An integer representing the strength of Wi-Fi
@@ -545,22 +599,18 @@ phosh_clear_fd (int *fd, GError **err)
 const char *
 phosh_util_get_icon_by_wifi_strength (guint strength, gboolean is_connecting)
 {
-  const char *icon_name;
+  const char *icon_names[] = {
+    "network-wireless-signal-none-symbolic",
+    "network-wireless-signal-weak-symbolic",
+    "network-wireless-signal-ok-symbolic",
+    "network-wireless-signal-good-symbolic",
+    "network-wireless-signal-excellent-symbolic",
+  };
 
   if (is_connecting)
-    icon_name = "network-wireless-acquiring-symbolic";
-  else if (strength > 80)
-    icon_name = "network-wireless-signal-excellent-symbolic";
-  else if (strength > 55)
-    icon_name = "network-wireless-signal-good-symbolic";
-  else if (strength > 30)
-    icon_name = "network-wireless-signal-ok-symbolic";
-  else if (strength > 5)
-    icon_name = "network-wireless-signal-weak-symbolic";
-  else
-    icon_name = "network-wireless-signal-none-symbolic";
+    return "network-wireless-acquiring-symbolic";
 
-  return icon_name;
+  return icon_names[phosh_util_get_wifi_strength_bucket (strength)];
 }
 
 /*
@@ -666,7 +716,6 @@ phosh_utils_pixbuf_scale_to_min (GdkPixbuf *src, int min_width, int min_height)
 
 
 static const char *(*app_attr[]) (GAppInfo *info) = {
-  g_app_info_get_display_name,
   g_app_info_get_name,
   g_app_info_get_description,
   g_app_info_get_executable,
@@ -677,63 +726,265 @@ static const char *(*desktop_attr[]) (GDesktopAppInfo *info) = {
   g_desktop_app_info_get_categories,
 };
 
+/* The casefolded and normalized strings we search in */
+typedef struct {
+  char  *name;
+  GStrv  fields;
+  GStrv  keywords;
+} PhoshAppSearchIndex;
+
+G_DEFINE_QUARK (phosh-app-search-index, app_search_index);
+
+
+static void
+app_search_index_free (PhoshAppSearchIndex *index)
+{
+  g_free (index->name);
+  g_strfreev (index->fields);
+  g_strfreev (index->keywords);
+  g_free (index);
+}
+
+
+static void
+add_folded (GPtrArray *array, const char *str)
+{
+  char *folded;
+
+  if (gm_str_is_null_or_empty (str))
+    return;
+
+  folded = phosh_util_fold_search_string (str);
+  if (folded)
+    g_ptr_array_add (array, folded);
+}
+
+
+static PhoshAppSearchIndex *
+app_search_index_new (GAppInfo *info)
+{
+  PhoshAppSearchIndex *index = g_new0 (PhoshAppSearchIndex, 1);
+  g_autoptr (GPtrArray) fields = g_ptr_array_new_null_terminated (0, g_free, TRUE);
+  g_autoptr (GPtrArray) keywords = g_ptr_array_new_null_terminated (0, g_free, TRUE);
+
+  index->name = phosh_util_fold_search_string (g_app_info_get_display_name (info));
+
+  for (int i = 0; i < G_N_ELEMENTS (app_attr); i++)
+    add_folded (fields, app_attr[i] (info));
+
+  if (G_IS_DESKTOP_APP_INFO (info)) {
+    const char * const *kwds;
+
+    for (int i = 0; i < G_N_ELEMENTS (desktop_attr); i++)
+      add_folded (fields, desktop_attr[i] (G_DESKTOP_APP_INFO (info)));
+
+    kwds = g_desktop_app_info_get_keywords (G_DESKTOP_APP_INFO (info));
+    for (int i = 0; kwds && kwds[i]; i++)
+      add_folded (keywords, kwds[i]);
+  }
+
+  index->fields = (GStrv) g_ptr_array_steal (fields, NULL);
+  index->keywords = (GStrv) g_ptr_array_steal (keywords, NULL);
+
+  return index;
+}
+
+
+static PhoshAppSearchIndex *
+get_app_search_index (GAppInfo *info)
+{
+  PhoshAppSearchIndex *index;
+
+  index = g_object_get_qdata (G_OBJECT (info), app_search_index_quark ());
+  if (G_LIKELY (index))
+    return index;
+
+  index = app_search_index_new (info);
+  g_object_set_qdata_full (G_OBJECT (info),
+                           app_search_index_quark (),
+                           index,
+                           (GDestroyNotify) app_search_index_free);
+  return index;
+}
+
 /**
- * phosh_util_matches_app_info:
- * @info: app-info to check
- * @search: Search string to use for matching
+ * phosh_util_fold_search_string:
+ * @str: The string to fold
  *
- * Returns: `TRUE` if the info matches search else `FALSE`
+ * Normalizes and casefolds the given string so it can be used for
+ * matching via [func@util_matches_app_info]. Use this on search terms
+ * entered by the user.
+ *
+ * Returns: (transfer full)(nullable): The folded string
  */
-gboolean
-phosh_util_matches_app_info (GAppInfo *info, const char *search)
+char *
+phosh_util_fold_search_string (const char *str)
 {
-  const char *str = NULL;
-  for (int i = 0; i < G_N_ELEMENTS (app_attr); i++) {
-    g_autofree char *folded = NULL;
+  g_autofree char *normalized = NULL;
 
-    str = app_attr[i] (info);
+  if (str == NULL)
+    return NULL;
 
-    if (gm_str_is_null_or_empty (str))
-      continue;
+  normalized = g_utf8_normalize (str, -1, G_NORMALIZE_ALL_COMPOSE);
+  if (normalized == NULL)
+    return NULL;
+
+  return g_utf8_casefold (normalized, -1);
+}
+
+/**
+ * phosh_util_index_app_info:
+ * @info: app-info to index
+ *
+ * Builds the search index for the given app info so later searches
+ * don't need to process the app info's attributes again. The index is
+ * otherwise built on first use. As app infos are immutable the index
+ * stays valid for the app info's lifetime.
+ */
+void
+phosh_util_index_app_info (GAppInfo *info)
+{
+  g_return_if_fail (G_IS_APP_INFO (info));
+
+  get_app_search_index (info);
+}
+
+/* Whether the match at `pos` in `str` starts a word */
+static gboolean
+is_word_start (const char *str, const char *pos)
+{
+  gunichar prev;
+
+  if (pos == str)
+    return TRUE;
+
+  prev = g_utf8_get_char (g_utf8_find_prev_char (str, pos));
+  return !g_unichar_isalnum (prev);
+}
 
-    folded = g_utf8_casefold (str, -1);
 
-    if (strstr (folded, search))
+static gboolean
+matches_word_prefix (const char *str, const char *search)
+{
+  for (const char *pos = strstr (str, search); pos; pos = strstr (pos + 1, search)) {
+    if (is_word_start (str, pos))
       return TRUE;
   }
 
-  if (G_IS_DESKTOP_APP_INFO (info)) {
-    const char * const *kwds;
+  return FALSE;
+}
 
-    for (int i = 0; i < G_N_ELEMENTS (desktop_attr); i++) {
-      g_autofree char *folded = NULL;
+/* Whether all characters of `search` appear in `str` in order */
+static gboolean
+matches_fuzzy (const char *str, const char *search)
+{
+  const char *pos = str;
 
-      str = desktop_attr[i] (G_DESKTOP_APP_INFO (info));
+  for (const char *s = search; *s; s = g_utf8_next_char (s)) {
+    pos = g_utf8_strchr (pos, -1, g_utf8_get_char (s));
+    if (pos == NULL)
+      return FALSE;
+    pos = g_utf8_next_char (pos);
+  }
 
-      if (gm_str_is_null_or_empty (str))
-        continue;
+  return TRUE;
+}
 
-      folded = g_utf8_casefold (str, -1);
+#define FUZZY_MATCH_MIN_LEN 3
 
-      if (strstr (folded, search))
-        return TRUE;
-    }
+/**
+ * phosh_util_score_app_info:
+ * @info: app-info to check
+ * @search: Search string to use for matching as returned by
+ *    [func@util_fold_search_string]
+ *
+ * Scores how well the app info matches the search string. Matches on
+ * the app's name are better than matches on other attributes like
+ * the description or keywords. A search that matches the start of the
+ * name is ranked highest, followed by matches at the start of a word
+ * in the name and matches anywhere in the name. Longer search strings are
+ * additionally matched fuzzily against the name.
+ *
+ * Returns: The score, higher is better. `PHOSH_UTIL_APP_MATCH_NONE` if
+ *   the app doesn't match at all.
+ */
+PhoshUtilAppMatch
+phosh_util_score_app_info (GAppInfo *info, const char *search)
+{
+  PhoshAppSearchIndex *index = get_app_search_index (info);
 
-    kwds = g_desktop_app_info_get_keywords (G_DESKTOP_APP_INFO (info));
+  if (index->name && strstr (index->name, search)) {
+    if (g_str_has_prefix (index->name, search))
+      return PHOSH_UTIL_APP_MATCH_PREFIX;
 
-    if (kwds) {
-      int i = 0;
+    if (matches_word_prefix (index->name, search))
+      return PHOSH_UTIL_APP_MATCH_WORD_PREFIX;
 
-      while ((str = kwds[i])) {
-        g_autofree char *folded = g_utf8_casefold (str, -1);
-        if (strstr (folded, search))
-          return TRUE;
-        i++;
-      }
-    }
+    return PHOSH_UTIL_APP_MATCH_SUBSTRING;
   }
 
-  return FALSE;
+  for (int i = 0; index->fields[i]; i++) {
+    if (strstr (index->fields[i], search))
+      return PHOSH_UTIL_APP_MATCH_KEYWORD;
+  }
+
+  for (int i = 0; index->keywords[i]; i++) {
+    if (strstr (index->keywords[i], search))
+      return PHOSH_UTIL_APP_MATCH_KEYWORD;
+  }
+
+  if (index->name && g_utf8_strlen (search, -1) >= FUZZY_MATCH_MIN_LEN &&
+      matches_fuzzy (index->name, search)) {
+    return PHOSH_UTIL_APP_MATCH_FUZZY;
+  }
+
+  return PHOSH_UTIL_APP_MATCH_NONE;
+}
+
+/**
+ * phosh_util_app_search_narrows:
+ * @search: The new search string
+ * @previous:(nullable): The previous search string
+ *
+ * Checks whether every app matching `search` also matched `previous`
+ * so only the previous matches need to be checked again. This is the
+ * case when the search got extended at the end unless that enabled
+ * fuzzy matching. Both strings are as returned by
+ * [func@util_fold_search_string].
+ *
+ * Returns: `TRUE` if `search` matches a subset of `previous`' matches
+ */
+gboolean
+phosh_util_app_search_narrows (const char *search, const char *previous)
+{
+  g_return_val_if_fail (search, FALSE);
+
+  if (gm_str_is_null_or_empty (previous))
+    return FALSE;
+
+  if (!g_str_has_prefix (search, previous))
+    return FALSE;
+
+  /* Fuzzy matches could add apps */
+  if (g_utf8_strlen (previous, -1) < FUZZY_MATCH_MIN_LEN &&
+      g_utf8_strlen (search, -1) >= FUZZY_MATCH_MIN_LEN)
+    return FALSE;
+
+  return TRUE;
+}
+
+/**
+ * phosh_util_matches_app_info:
+ * @info: app-info to check
+ * @search: Search string to use for matching as returned by
+ *    [func@util_fold_search_string]
+ *
+ * Returns: `TRUE` if the info matches search else `FALSE`
+ */
+gboolean
+phosh_util_matches_app_info (GAppInfo *info, const char *search)
+{
+  return phosh_util_score_app_info (info, search) != PHOSH_UTIL_APP_MATCH_NONE;
 }
 
 /**
@@ -1145,6 +1396,39 @@ phosh_util_get_platform_data (GAppInfo *info)
   return g_variant_builder_end (&builder);
 }
 
+/**
+ * phosh_util_get_app_icon:
+ * @info: An app info
+ *
+ * Get the icon to show for an app. Themed icons fall back to
+ * `PHOSH_APP_UNKNOWN_ICON` so an app is never shown without an
+ * icon. As the returned icon is the same for every call on the same
+ * app info, lookups of it are cached by the icon theme.
+ *
+ * Returns:(transfer full): The icon
+ */
+GIcon *
+phosh_util_get_app_icon (GAppInfo *info)
+{
+  GIcon *icon;
+  const char * const *names;
+
+  g_return_val_if_fail (G_IS_APP_INFO (info), NULL);
+
+  icon = g_app_info_get_icon (info);
+  if (G_UNLIKELY (icon == NULL))
+    return g_themed_icon_new (PHOSH_APP_UNKNOWN_ICON);
+
+  if (G_IS_THEMED_ICON (icon)) {
+    names = g_themed_icon_get_names (G_THEMED_ICON (icon));
+    /* The app info's icon is shared so only add the fallback once */
+    if (!g_strv_contains (names, PHOSH_APP_UNKNOWN_ICON))
+      g_themed_icon_append_name (G_THEMED_ICON (icon), PHOSH_APP_UNKNOWN_ICON);
+  }
+
+  return g_object_ref (icon);
+}
+
 /**
  * phosh_util_hide_app:
  * @info: The app-info of the app to hide
@@ -46,6 +46,26 @@ G_BEGIN_DECLS
     g_free (_bindings);                                                 \
   } G_STMT_END
 
+/**
+ * PhoshUtilAppMatch:
+ * @PHOSH_UTIL_APP_MATCH_NONE: The app doesn't match
+ * @PHOSH_UTIL_APP_MATCH_FUZZY: All characters appear in order in the app's name
+ * @PHOSH_UTIL_APP_MATCH_KEYWORD: Match in another attribute like description or keywords
+ * @PHOSH_UTIL_APP_MATCH_SUBSTRING: Match somewhere in the app's name
+ * @PHOSH_UTIL_APP_MATCH_WORD_PREFIX: Match at the start of a word in the app's name
+ * @PHOSH_UTIL_APP_MATCH_PREFIX: Match at the start of the app's name
+ *
+ * How well an app matches a search string, higher values are better matches.
+ */
+typedef enum {
+  PHOSH_UTIL_APP_MATCH_NONE = 0,
+  PHOSH_UTIL_APP_MATCH_FUZZY,
+  PHOSH_UTIL_APP_MATCH_KEYWORD,
+  PHOSH_UTIL_APP_MATCH_SUBSTRING,
+  PHOSH_UTIL_APP_MATCH_WORD_PREFIX,
+  PHOSH_UTIL_APP_MATCH_PREFIX,
+} PhoshUtilAppMatch;
+
 void             phosh_cp_widget_destroy (void *widget);
 GDesktopAppInfo *phosh_get_desktop_app_info_for_app_id (const char *app_id);
 char            *phosh_munge_app_id (const char *app_id);
@@ -70,11 +90,16 @@ gboolean         phosh_util_gesture_is_touch (GtkGestureSingle *gesture);
 gboolean         phosh_util_have_gnome_software (gboolean scan);
 void             phosh_util_toggle_style_class (GtkWidget *widget, const char *style_class, gboolean toggle);
 gboolean         phosh_clear_fd (int *fd, GError **err);
+guint            phosh_util_get_wifi_strength_bucket (guint strength);
 const char      *phosh_util_get_icon_by_wifi_strength (guint strength, gboolean is_connecting);
 gboolean         phosh_util_file_equal (GFile *file1, GFile *file2);
 GdkPixbuf       *phosh_util_data_uri_to_pixbuf (const char *uri, GError **error);
 GdkPixbuf *      phosh_utils_pixbuf_scale_to_min (GdkPixbuf *src, int min_width, int min_height);
+char            *phosh_util_fold_search_string (const char *str);
+void             phosh_util_index_app_info (GAppInfo *info);
+PhoshUtilAppMatch phosh_util_score_app_info (GAppInfo *info, const char *search);
 gboolean         phosh_util_matches_app_info (GAppInfo *info, const char *search);
+gboolean         phosh_util_app_search_narrows (const char *search, const char *previous);
 char *           phosh_util_hide_app (GAppInfo *app);
 gboolean         phosh_util_unhide_app (const char *filename);
 GStrv            phosh_util_append_to_strv (GStrv array, const char *element);
@@ -98,6 +123,7 @@ void             phosh_util_activate_action (GAppInfo           *info,
                                              gpointer            user_data);
 gboolean         phosh_util_activate_action_finish (GAsyncResult *res, GError **err);
 GVariant *       phosh_util_get_platform_data (GAppInfo *info);
+GIcon *          phosh_util_get_app_icon (GAppInfo *info);
 
 
 G_END_DECLS
@@ -10,6 +10,7 @@
 #include "phosh-config.h"
 
 #include "vpn-manager.h"
+#include "nm-client.h"
 #include "shell-priv.h"
 #include "util.h"
 
@@ -344,7 +345,7 @@ on_nm_client_ready (GObject *obj, GAsyncResult *res, gpointer data)
   PhoshVpnManager *self;
   NMClient *client;
 
-  client = nm_client_new_finish (res, &err);
+  client = phosh_nm_client_get_finish (res, &err);
   if (client == NULL) {
     g_message ("Failed to init NM: %s", err->message);
     return;
@@ -373,7 +374,7 @@ phosh_vpn_manager_constructed (GObject *object)
   G_OBJECT_CLASS (phosh_vpn_manager_parent_class)->constructed (object);
 
   self->cancel = g_cancellable_new ();
-  nm_client_new_async (self->cancel, on_nm_client_ready, self);
+  phosh_nm_client_get_async (self->cancel, on_nm_client_ready, self);
 }
 
 
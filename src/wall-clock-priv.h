@@ -10,6 +10,7 @@
 
 G_BEGIN_DECLS
 
-char *phosh_wall_clock_strip_am_pm (PhoshWallClock *self, const char *time);
+char       *phosh_wall_clock_strip_am_pm        (PhoshWallClock *self, const char *time);
+const char *phosh_wall_clock_get_time_stripped (PhoshWallClock *self);
 
 G_END_DECLS
@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: GPL-3.0-or-later
  */
 
+#include "timer-service.h"
 #include "wall-clock-priv.h"
 
 #define GNOME_DESKTOP_USE_UNSTABLE_API
@@ -24,6 +25,15 @@ static GParamSpec *props[LAST_PROP];
  * PhoshWallClock:
  *
  * Wall clock used for fetching date and time
+ *
+ * While the [class@TimerService] is suspended (e.g. because the
+ * screen is off) clock changes aren't emitted. Consumers get a single
+ * notification once it resumes.
+ *
+ * The formatted date and the time without AM/PM are computed at most
+ * once per clock tick and shared by all consumers. The underlying
+ * `GnomeWallClock` only wakes up on minute boundaries unless seconds
+ * are shown.
  */
 
 typedef struct _PhoshWallClockPrivate {
@@ -31,15 +41,43 @@ typedef struct _PhoshWallClockPrivate {
   GnomeWallClock *date_time;
 
   GRegex         *clock_re;
+
+  gboolean        suspended;
+  gboolean        date_time_pending;
+  gboolean        time_pending;
+
+  /* Formatted strings cached until the next tick */
+  char           *local_date;
+  char           *time_stripped;
 } PhoshWallClockPrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (PhoshWallClock, phosh_wall_clock, G_TYPE_OBJECT)
 
 
+static void
+clear_cache (PhoshWallClock *self)
+{
+  PhoshWallClockPrivate *priv = phosh_wall_clock_get_instance_private (self);
+
+  g_clear_pointer (&priv->local_date, g_free);
+  g_clear_pointer (&priv->time_stripped, g_free);
+}
+
+
 static void
 on_date_time_changed (PhoshWallClock *self, GParamSpec *pspec, GnomeWallClock *clock)
 {
+  PhoshWallClockPrivate *priv = phosh_wall_clock_get_instance_private (self);
+
   g_return_if_fail (PHOSH_IS_WALL_CLOCK (self));
+
+  clear_cache (self);
+
+  if (priv->suspended) {
+    priv->date_time_pending = TRUE;
+    return;
+  }
+
   g_object_notify_by_pspec (G_OBJECT (self), props[PROP_DATE_TIME]);
 }
 
@@ -47,11 +85,44 @@ on_date_time_changed (PhoshWallClock *self, GParamSpec *pspec, GnomeWallClock *c
 static void
 on_time_changed (PhoshWallClock *self, GParamSpec *pspec, GnomeWallClock *clock)
 {
+  PhoshWallClockPrivate *priv = phosh_wall_clock_get_instance_private (self);
+
   g_return_if_fail (PHOSH_IS_WALL_CLOCK (self));
+
+  clear_cache (self);
+
+  if (priv->suspended) {
+    priv->time_pending = TRUE;
+    return;
+  }
+
   g_object_notify_by_pspec (G_OBJECT (self), props[PROP_TIME]);
 }
 
 
+static void
+on_timer_service_suspended_changed (PhoshWallClock    *self,
+                                    GParamSpec        *pspec,
+                                    PhoshTimerService *timer_service)
+{
+  PhoshWallClockPrivate *priv = phosh_wall_clock_get_instance_private (self);
+
+  priv->suspended = phosh_timer_service_get_suspended (timer_service);
+  if (priv->suspended)
+    return;
+
+  /* Catch up on what happened while suspended in one go */
+  g_object_freeze_notify (G_OBJECT (self));
+  if (priv->date_time_pending)
+    g_object_notify_by_pspec (G_OBJECT (self), props[PROP_DATE_TIME]);
+  if (priv->time_pending)
+    g_object_notify_by_pspec (G_OBJECT (self), props[PROP_TIME]);
+  priv->date_time_pending = FALSE;
+  priv->time_pending = FALSE;
+  g_object_thaw_notify (G_OBJECT (self));
+}
+
+
 static void
 phosh_wall_clock_get_property (GObject    *object,
                                guint       property_id,
@@ -83,6 +154,7 @@ phosh_wall_clock_dispose (GObject *object)
   g_clear_object (&priv->date_time);
   g_clear_object (&priv->time);
   g_clear_pointer (&priv->clock_re, g_regex_unref);
+  clear_cache (self);
 
   G_OBJECT_CLASS (phosh_wall_clock_parent_class)->dispose (object);
 }
@@ -158,6 +230,13 @@ phosh_wall_clock_init (PhoshWallClock *self)
                            self, G_CONNECT_SWAPPED);
   g_signal_connect_object (priv->time, "notify::clock", G_CALLBACK (on_time_changed),
                            self, G_CONNECT_SWAPPED);
+
+  g_signal_connect_object (phosh_timer_service_get_default (),
+                           "notify::suspended",
+                           G_CALLBACK (on_timer_service_suspended_changed),
+                           self,
+                           G_CONNECT_SWAPPED);
+  on_timer_service_suspended_changed (self, NULL, phosh_timer_service_get_default ());
 }
 
 
@@ -250,19 +329,13 @@ phosh_wall_clock_date_fmt (void)
   return fmt;
 }
 
-/**
- * phosh_wall_clock_local_date:
- * @self: The wall clock
- *
- * Get the local date as string
+/*
  * We honor LC_MESSAGES so we e.g. don't get a translated date when
  * the user has LC_MESSAGES=en_US.UTF-8 but LC_TIME to their local
  * time zone.
- *
- * Returns: The local date as string
  */
-char *
-phosh_wall_clock_local_date (PhoshWallClock *self)
+static char *
+format_local_date (PhoshWallClock *self)
 {
   PhoshWallClockClass *klass;
   time_t current;
@@ -271,8 +344,6 @@ phosh_wall_clock_local_date (PhoshWallClock *self)
   const char *fmt;
   const char *locale;
 
-  g_return_val_if_fail (PHOSH_IS_WALL_CLOCK (self), NULL);
-
   klass = PHOSH_WALL_CLOCK_GET_CLASS (self);
   current = klass->get_time_t (self);
 
@@ -293,6 +364,45 @@ phosh_wall_clock_local_date (PhoshWallClock *self)
   return g_steal_pointer (&date);
 }
 
+/**
+ * phosh_wall_clock_get_local_date:
+ * @self: The wall clock
+ *
+ * Get the local date as string. The string is only formatted once per
+ * clock tick.
+ *
+ * Returns: The local date as string
+ */
+const char *
+phosh_wall_clock_get_local_date (PhoshWallClock *self)
+{
+  PhoshWallClockPrivate *priv;
+
+  g_return_val_if_fail (PHOSH_IS_WALL_CLOCK (self), NULL);
+  priv = phosh_wall_clock_get_instance_private (self);
+
+  if (priv->local_date == NULL)
+    priv->local_date = format_local_date (self);
+
+  return priv->local_date;
+}
+
+/**
+ * phosh_wall_clock_local_date:
+ * @self: The wall clock
+ *
+ * Get the local date as string. See [method@WallClock.get_local_date].
+ *
+ * Returns: The local date as string
+ */
+char *
+phosh_wall_clock_local_date (PhoshWallClock *self)
+{
+  g_return_val_if_fail (PHOSH_IS_WALL_CLOCK (self), NULL);
+
+  return g_strdup (phosh_wall_clock_get_local_date (self));
+}
+
 
 char *
 phosh_wall_clock_string_for_datetime (PhoshWallClock      *self,
@@ -345,3 +455,29 @@ phosh_wall_clock_strip_am_pm (PhoshWallClock *self, const char *time)
   g_warning ("Can't match time format: %s", time);
   return g_strdup (time);
 }
+
+/**
+ * phosh_wall_clock_get_time_stripped:
+ * @self: The wall clock
+ *
+ * Get the current time without AM/PM, see
+ * [method@WallClock.strip_am_pm]. The string is only computed once
+ * per clock tick.
+ *
+ * Returns: The current time
+ */
+const char *
+phosh_wall_clock_get_time_stripped (PhoshWallClock *self)
+{
+  PhoshWallClockPrivate *priv;
+
+  g_return_val_if_fail (PHOSH_IS_WALL_CLOCK (self), NULL);
+  priv = phosh_wall_clock_get_instance_private (self);
+
+  if (priv->time_stripped == NULL) {
+    priv->time_stripped = phosh_wall_clock_strip_am_pm (self,
+                                                        phosh_wall_clock_get_clock (self, TRUE));
+  }
+
+  return priv->time_stripped;
+}
@@ -40,6 +40,7 @@ void             phosh_wall_clock_set_default         (PhoshWallClock *self);
 PhoshWallClock  *phosh_wall_clock_get_default         (void);
 const char      *phosh_wall_clock_get_clock           (PhoshWallClock *self, gboolean time_only);
 char            *phosh_wall_clock_local_date          (PhoshWallClock *self);
+const char      *phosh_wall_clock_get_local_date      (PhoshWallClock *self);
 char            *phosh_wall_clock_string_for_datetime (PhoshWallClock      *self,
                                                        GDateTime           *datetime,
                                                        GDesktopClockFormat  clock_format,
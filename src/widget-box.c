@@ -16,6 +16,8 @@
 #include <handy.h>
 #include <glib/gi18n-lib.h>
 
+#include <math.h>
+
 /**
  * PhoshWidgetBox:
  *
@@ -23,8 +25,23 @@
  *
  * The widget box is displayed on the lock screen
  * and displays a list of loadable widgets.
+ *
+ * Widgets are instantiated lazily: each plugin gets an empty page in
+ * the carousel and the plugin's widget is only created once that page
+ * (or one of its neighbours) becomes the current page. Since the
+ * carousel allocates all pages the same size the placeholder doesn't
+ * affect the layout.
+ *
+ * When the list of plugins changes pages of plugins that are still
+ * configured are kept. When a plugin's info changes on disk only that
+ * plugin's page is rebuilt.
  */
 
+/* Set on placeholder pages until the plugin's widget is loaded */
+#define PHOSH_WIDGET_BOX_PLUGIN_KEY "phosh-widget-box-plugin"
+/* The plugin a page belongs to */
+#define PHOSH_WIDGET_BOX_PAGE_PLUGIN_KEY "phosh-widget-box-page-plugin"
+
 enum {
   PROP_0,
   PROP_PLUGIN_DIRS,
@@ -61,30 +78,149 @@ missing_plugin_widget_new (const char *plugin)
 }
 
 
+static GtkWidget *
+placeholder_page_new (const char *plugin)
+{
+  GtkWidget *page = gtk_box_new (GTK_ORIENTATION_VERTICAL, 0);
+
+  gtk_widget_set_visible (page, TRUE);
+  gtk_widget_set_hexpand (page, TRUE);
+  gtk_widget_set_vexpand (page, TRUE);
+  g_object_set_data_full (G_OBJECT (page), PHOSH_WIDGET_BOX_PLUGIN_KEY, g_strdup (plugin), g_free);
+  g_object_set_data_full (G_OBJECT (page), PHOSH_WIDGET_BOX_PAGE_PLUGIN_KEY, g_strdup (plugin),
+                          g_free);
+
+  return page;
+}
+
+
+static void
+load_page (PhoshWidgetBox *self, int index)
+{
+  g_autoptr (GList) children = NULL;
+  g_autofree char *plugin = NULL;
+  GtkWidget *page, *widget;
+
+  if (index < 0)
+    return;
+
+  children = gtk_container_get_children (GTK_CONTAINER (self->carousel));
+  page = g_list_nth_data (children, index);
+  if (page == NULL)
+    return;
+
+  plugin = g_object_steal_data (G_OBJECT (page), PHOSH_WIDGET_BOX_PLUGIN_KEY);
+  /* Already loaded */
+  if (plugin == NULL)
+    return;
+
+  g_debug ("Loading widget for plugin '%s'", plugin);
+  widget = phosh_plugin_loader_load_plugin (self->plugin_loader, plugin);
+  if (widget == NULL) {
+    g_warning ("Plugin '%s' not found", plugin);
+    widget = missing_plugin_widget_new (plugin);
+  }
+
+  gtk_widget_set_visible (widget, TRUE);
+  gtk_widget_set_hexpand (widget, TRUE);
+  gtk_widget_set_vexpand (widget, TRUE);
+  gtk_container_add (GTK_CONTAINER (page), widget);
+}
+
+
+static void
+load_pages_around (PhoshWidgetBox *self, int index)
+{
+  /* Load the neighbours too so a swipe reveals the real widget */
+  for (int i = index - 1; i <= index + 1; i++)
+    load_page (self, i);
+}
+
+
+static void
+on_page_changed (PhoshWidgetBox *self, guint index)
+{
+  load_pages_around (self, index);
+}
+
+
+static int
+get_current_page (PhoshWidgetBox *self)
+{
+  return (int) round (hdy_carousel_get_position (HDY_CAROUSEL (self->carousel)));
+}
+
+
+static void
+on_plugin_changed (PhoshWidgetBox *self, const char *name)
+{
+  g_autoptr (GList) children = NULL;
+  int current = get_current_page (self);
+  int index = 0;
+
+  children = gtk_container_get_children (GTK_CONTAINER (self->carousel));
+  for (GList *elem = children; elem; elem = elem->next, index++) {
+    GtkWidget *page = elem->data;
+    const char *plugin = g_object_get_data (G_OBJECT (page), PHOSH_WIDGET_BOX_PAGE_PLUGIN_KEY);
+
+    if (g_strcmp0 (plugin, name))
+      continue;
+
+    g_debug ("Plugin '%s' changed, rebuilding its page", name);
+    gtk_container_foreach (GTK_CONTAINER (page), (GtkCallback) gtk_widget_destroy, NULL);
+    g_object_set_data_full (G_OBJECT (page), PHOSH_WIDGET_BOX_PLUGIN_KEY, g_strdup (name), g_free);
+    if (ABS (index - current) <= 1)
+      load_page (self, index);
+  }
+}
+
+
+static GtkWidget *
+find_page (GList *pages, const char *plugin)
+{
+  for (GList *elem = pages; elem; elem = elem->next) {
+    const char *name = g_object_get_data (G_OBJECT (elem->data), PHOSH_WIDGET_BOX_PAGE_PLUGIN_KEY);
+
+    if (g_strcmp0 (name, plugin) == 0)
+      return elem->data;
+  }
+
+  return NULL;
+}
+
+
 static void
 phosh_widget_box_load_widgets (PhoshWidgetBox *self)
 {
   g_autoptr (GList) children = NULL;
+  int n_plugins;
 
   if (self->plugin_loader == NULL)
     return;
 
-  children = gtk_container_get_children (GTK_CONTAINER (self->carousel));
-  for (GList *elem = children; elem; elem = elem->next)
-    gtk_container_remove (GTK_CONTAINER (self->carousel), GTK_WIDGET (elem->data));
+  /* Move pages of plugins we still use into place, add the new ones */
+  n_plugins = self->plugins ? g_strv_length (self->plugins) : 0;
+  for (int i = 0; i < n_plugins; i++) {
+    GtkWidget *page;
 
-  for (int i = 0; i < g_strv_length (self->plugins); i++) {
-    GtkWidget *widget = phosh_plugin_loader_load_plugin (self->plugin_loader, self->plugins[i]);
+    children = gtk_container_get_children (GTK_CONTAINER (self->carousel));
+    page = find_page (g_list_nth (children, i), self->plugins[i]);
+    g_clear_pointer (&children, g_list_free);
 
-    if (widget == NULL) {
-      g_warning ("Plugin '%s' not found", self->plugins[i]);
-      widget = missing_plugin_widget_new (self->plugins[i]);
+    if (page) {
+      hdy_carousel_reorder (HDY_CAROUSEL (self->carousel), page, i);
+    } else {
+      page = placeholder_page_new (self->plugins[i]);
+      hdy_carousel_insert (HDY_CAROUSEL (self->carousel), page, i);
     }
-
-    gtk_widget_set_visible (widget, TRUE);
-    gtk_widget_set_hexpand (widget, TRUE);
-    hdy_carousel_insert (HDY_CAROUSEL (self->carousel), widget, -1);
   }
+
+  /* Drop what's left over */
+  children = gtk_container_get_children (GTK_CONTAINER (self->carousel));
+  for (GList *elem = g_list_nth (children, n_plugins); elem; elem = elem->next)
+    gtk_container_remove (GTK_CONTAINER (self->carousel), GTK_WIDGET (elem->data));
+
+  load_pages_around (self, get_current_page (self));
 }
 
 
@@ -146,6 +282,11 @@ phosh_widget_box_constructed (GObject *object)
 
   self->plugin_loader = phosh_plugin_loader_new (self->plugin_dirs,
                                                  PHOSH_EXTENSION_POINT_LOCKSCREEN_WIDGET);
+  g_signal_connect_object (self->plugin_loader,
+                           "plugin-changed",
+                           G_CALLBACK (on_plugin_changed),
+                           self,
+                           G_CONNECT_SWAPPED);
 
 }
 
@@ -198,6 +339,12 @@ static void
 phosh_widget_box_init (PhoshWidgetBox *self)
 {
   gtk_widget_init_template (GTK_WIDGET (self));
+
+  g_signal_connect_object (self->carousel,
+                           "page-changed",
+                           G_CALLBACK (on_page_changed),
+                           self,
+                           G_CONNECT_SWAPPED);
 }
 
 
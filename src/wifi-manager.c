@@ -10,10 +10,16 @@
 #include "phosh-config.h"
 
 #include "wifi-manager.h"
+#include "nm-client.h"
 #include "util.h"
 
 #include <NetworkManager.h>
 
+/* Give up waiting for a scan to finish after that long */
+#define SCAN_TIMEOUT_S       30
+#define PERIODIC_SCAN_MIN_S  10
+#define PERIODIC_SCAN_MAX_S  120
+
 /**
  * PhoshWifiManager:
  *
@@ -21,6 +27,11 @@
  *
  * Manages Wi-Fi information and state
  *
+ * Scan completion is detected via the device's `last-scan` property.
+ * While users look at the network list periodic scans can be requested
+ * via [method@WifiManager.hold_periodic_scan]. The interval doubles
+ * after each scan up to a maximum.
+ *
  * The code to create hotspot connection are based on GNOME Control Center's and NMCLI's code for
  * the same.
  */
@@ -55,6 +66,9 @@ struct _PhoshWifiManager {
   gboolean            scanning;
   guint               scanning_id;
   gint64              last_scan;
+  guint               periodic_scan_holds;
+  guint               periodic_scan_id;
+  guint               periodic_scan_interval;
 
   NMClient           *nmclient;
   GCancellable       *cancel;
@@ -71,6 +85,8 @@ struct _PhoshWifiManager {
   NMDeviceWifi       *dev;
   /* The list of available Wi-Fi networks */
   GListStore         *networks; /* (element-type: PhoshWifiNetwork) */
+  /* key: ssid, mode and security, value: (transfer none) PhoshWifiNetwork  */
+  GHashTable         *networks_by_key;
 };
 G_DEFINE_TYPE (PhoshWifiManager, phosh_wifi_manager, G_TYPE_OBJECT);
 
@@ -527,27 +543,81 @@ set_scanning (PhoshWifiManager *self, gboolean scanning)
 }
 
 
-static gboolean
-check_scanning (gpointer user_data)
+static int
+compare_networks (gconstpointer a, gconstpointer b, gpointer user_data)
 {
-  PhoshWifiManager *self = PHOSH_WIFI_MANAGER (user_data);
-  gint64 last_scan;
+  PhoshWifiNetwork *network_a = PHOSH_WIFI_NETWORK ((gpointer)a);
+  PhoshWifiNetwork *network_b = PHOSH_WIFI_NETWORK ((gpointer)b);
+  guint bucket_a, bucket_b;
+  gboolean active_a, active_b;
+
+  active_a = phosh_wifi_network_get_active (network_a);
+  active_b = phosh_wifi_network_get_active (network_b);
+  if (active_a != active_b)
+    return active_a ? -1 : 1;
+
+  /* Sort by bucket so the order only changes on visible differences */
+  bucket_a = phosh_util_get_wifi_strength_bucket (phosh_wifi_network_get_strength (network_a));
+  bucket_b = phosh_util_get_wifi_strength_bucket (phosh_wifi_network_get_strength (network_b));
+  if (bucket_a != bucket_b)
+    return bucket_a > bucket_b ? -1 : 1;
+
+  return g_strcmp0 (phosh_wifi_network_get_ssid (network_a),
+                    phosh_wifi_network_get_ssid (network_b));
+}
 
-  if (!self->dev) {
-    self->scanning_id = 0;
-    set_scanning (self, FALSE);
-    return G_SOURCE_REMOVE;
-  }
+/*
+ * Sort the networks once per scan rather than on every strength
+ * change. Skip sorting if the order is fine already as sorting
+ * rebuilds all the rows in the network list.
+ */
+static void
+sort_networks (PhoshWifiManager *self)
+{
+  GListModel *model = G_LIST_MODEL (self->networks);
+  guint n_items = g_list_model_get_n_items (model);
+  gboolean sorted = TRUE;
 
-  last_scan = nm_device_wifi_get_last_scan (self->dev);
-  if (self->last_scan != last_scan) {
-    self->scanning_id = 0;
-    self->last_scan = last_scan;
-    set_scanning (self, FALSE);
-    return G_SOURCE_REMOVE;
+  for (guint i = 1; i < n_items && sorted; i++) {
+    g_autoptr (PhoshWifiNetwork) prev = g_list_model_get_item (model, i - 1);
+    g_autoptr (PhoshWifiNetwork) network = g_list_model_get_item (model, i);
+
+    sorted = compare_networks (prev, network, NULL) <= 0;
   }
 
-  return G_SOURCE_CONTINUE;
+  if (sorted)
+    return;
+
+  g_debug ("Resorting %u networks", n_items);
+  g_list_store_sort (self->networks, compare_networks, NULL);
+}
+
+
+static void
+on_scan_timeout (gpointer user_data)
+{
+  PhoshWifiManager *self = PHOSH_WIFI_MANAGER (user_data);
+
+  g_debug ("Scan didn't finish in time");
+  self->scanning_id = 0;
+  set_scanning (self, FALSE);
+}
+
+
+static void
+on_last_scan_changed (PhoshWifiManager *self, GParamSpec *pspec, NMDeviceWifi *dev)
+{
+  gint64 last_scan = nm_device_wifi_get_last_scan (dev);
+
+  if (self->last_scan == last_scan)
+    return;
+
+  /* Also handles scans triggered by NetworkManager itself */
+  self->last_scan = last_scan;
+  sort_networks (self);
+
+  g_clear_handle_id (&self->scanning_id, g_source_remove);
+  set_scanning (self, FALSE);
 }
 
 
@@ -560,20 +630,51 @@ on_request_scan (GObject *object, GAsyncResult *result, gpointer data)
   gboolean success = nm_device_wifi_request_scan_finish (dev, result, &err);
 
   if (!success) {
-    g_warning ("Failed to scan for access points: %s", err->message);
+    if (!g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+      g_warning ("Failed to scan for access points: %s", err->message);
     return;
   }
 
   self = PHOSH_WIFI_MANAGER (data);
 
+  /* Already waiting for the scan to finish */
   if (self->scanning_id)
     return;
 
-  self->scanning_id = g_timeout_add (2000, check_scanning, self);
+  self->scanning_id = g_timeout_add_seconds_once (SCAN_TIMEOUT_S, on_scan_timeout, self);
+  g_source_set_name_by_id (self->scanning_id, "[phosh] wifi-scan-timeout");
   set_scanning (self, TRUE);
 }
 
 
+static void schedule_periodic_scan (PhoshWifiManager *self);
+
+static void
+on_periodic_scan (gpointer user_data)
+{
+  PhoshWifiManager *self = PHOSH_WIFI_MANAGER (user_data);
+
+  self->periodic_scan_id = 0;
+  phosh_wifi_manager_request_scan (self);
+
+  self->periodic_scan_interval = MIN (self->periodic_scan_interval * 2, PERIODIC_SCAN_MAX_S);
+  schedule_periodic_scan (self);
+}
+
+
+static void
+schedule_periodic_scan (PhoshWifiManager *self)
+{
+  g_clear_handle_id (&self->periodic_scan_id, g_source_remove);
+
+  g_debug ("Next Wi-Fi scan in %us", self->periodic_scan_interval);
+  self->periodic_scan_id = g_timeout_add_seconds_once (self->periodic_scan_interval,
+                                                       on_periodic_scan,
+                                                       self);
+  g_source_set_name_by_id (self->periodic_scan_id, "[phosh] wifi-periodic-scan");
+}
+
+
 static void
 phosh_wifi_manager_get_property (GObject    *object,
                                  guint       property_id,
@@ -626,12 +727,12 @@ get_access_point_ssid (NMAccessPoint *ap)
   return ssid;
 }
 
-static gboolean
-is_valid_access_point (NMAccessPoint *ap)
+static char *
+get_access_point_network_key (NMAccessPoint *ap, const char *ssid)
 {
-  g_autofree char *ssid = get_access_point_ssid (ap);
+  gboolean secured = !!(nm_access_point_get_flags (ap) & NM_802_11_AP_FLAGS_PRIVACY);
 
-  return ssid != NULL;
+  return g_strdup_printf ("%d:%d:%s", nm_access_point_get_mode (ap), secured, ssid);
 }
 
 
@@ -639,28 +740,28 @@ static void
 on_nm_access_point_added (PhoshWifiManager *self, NMAccessPoint *ap)
 {
   g_autoptr (PhoshWifiNetwork) n = NULL;
-  guint length = g_list_model_get_n_items (G_LIST_MODEL (self->networks));
   g_autofree char *ssid = get_access_point_ssid (ap);
+  g_autofree char *key = NULL;
+  PhoshWifiNetwork *network;
 
   g_assert (NM_IS_ACCESS_POINT (ap));
 
-  if (!is_valid_access_point (ap)) {
+  if (ssid == NULL) {
     g_debug ("Discarding access point due to no SSID");
     return;
   }
 
-  for (guint i = 0; i < length; i++) {
-    g_autoptr (PhoshWifiNetwork) network = NULL;
-    network = g_list_model_get_item (G_LIST_MODEL (self->networks), i);
-
-    if (phosh_wifi_network_matches_access_point (network, ap)) {
-      g_debug ("Adding access point to existing network: %s", ssid);
-      phosh_wifi_network_add_access_point (network, ap, self->ap == ap);
-      return;
-    }
+  key = get_access_point_network_key (ap, ssid);
+  network = g_hash_table_lookup (self->networks_by_key, key);
+  if (network) {
+    g_debug ("Adding access point to existing network: %s", ssid);
+    phosh_wifi_network_add_access_point (network, ap, self->ap == ap);
+    return;
   }
+
   g_debug ("Creating network: %s", ssid);
   n = phosh_wifi_network_new_from_access_point (ap, self->ap == ap);
+  g_hash_table_insert (self->networks_by_key, g_steal_pointer (&key), n);
   g_list_store_append (self->networks, n);
 }
 
@@ -668,26 +769,25 @@ on_nm_access_point_added (PhoshWifiManager *self, NMAccessPoint *ap)
 static void
 on_nm_access_point_removed (PhoshWifiManager *self, NMAccessPoint *ap)
 {
-  guint length = g_list_model_get_n_items (G_LIST_MODEL (self->networks));
   g_autofree char *ssid = get_access_point_ssid (ap);
+  g_autofree char *key = NULL;
+  PhoshWifiNetwork *network;
+  guint pos;
 
-  if (!is_valid_access_point (ap))
+  if (ssid == NULL)
     return;
 
   g_debug ("Removing AP: %s", ssid);
 
-  for (guint i = 0; i < length; i++) {
-    g_autoptr (PhoshWifiNetwork) network = NULL;
-    network = g_list_model_get_item (G_LIST_MODEL (self->networks), i);
+  key = get_access_point_network_key (ap, ssid);
+  network = g_hash_table_lookup (self->networks_by_key, key);
+  if (network == NULL || !phosh_wifi_network_remove_access_point (network, ap))
+    return;
 
-    if (phosh_wifi_network_matches_access_point (network, ap)) {
-      if (phosh_wifi_network_remove_access_point (network, ap)) {
-        g_debug ("Removing network: %s", ssid);
-        g_list_store_remove (self->networks, i);
-      }
-      return;
-    }
-  }
+  g_debug ("Removing network: %s", ssid);
+  if (g_list_store_find (self->networks, network, &pos))
+    g_list_store_remove (self->networks, pos);
+  g_hash_table_remove (self->networks_by_key, key);
 }
 
 
@@ -713,6 +813,7 @@ refresh_access_points (PhoshWifiManager *self)
   if (self->dev == NULL)
     return;
 
+  g_hash_table_remove_all (self->networks_by_key);
   g_list_store_remove_all (G_LIST_STORE (self->networks));
   aps = nm_device_wifi_get_access_points (self->dev);
 
@@ -723,6 +824,7 @@ refresh_access_points (PhoshWifiManager *self)
     ap = g_ptr_array_index (aps, i);
     on_nm_access_point_added (self, ap);
   }
+  sort_networks (self);
 }
 
 
@@ -958,6 +1060,9 @@ setup_wifi_device (PhoshWifiManager *self, NMDeviceWifi *dev)
                             G_CALLBACK (on_nm_access_point_added), self);
   g_signal_connect_swapped (self->dev, "access-point-removed",
                             G_CALLBACK (on_nm_access_point_removed), self);
+  g_signal_connect_swapped (self->dev, "notify::" NM_DEVICE_WIFI_LAST_SCAN,
+                            G_CALLBACK (on_last_scan_changed), self);
+  self->last_scan = nm_device_wifi_get_last_scan (self->dev);
 
   refresh_access_points (self);
 }
@@ -969,6 +1074,7 @@ cleanup_wifi_device (PhoshWifiManager *self)
   if (self->dev == NULL)
     return;
 
+  g_hash_table_remove_all (self->networks_by_key);
   g_list_store_remove_all (G_LIST_STORE (self->networks));
 
   g_signal_handlers_disconnect_by_data (self->dev, self);
@@ -1031,7 +1137,7 @@ on_nm_client_ready (GObject *obj, GAsyncResult *res, gpointer data)
   PhoshWifiManager *self;
   NMClient *client;
 
-  client = nm_client_new_finish (res, &err);
+  client = phosh_nm_client_get_finish (res, &err);
   if (client == NULL) {
     g_message ("Failed to init NM: %s", err->message);
     return;
@@ -1062,9 +1168,10 @@ phosh_wifi_manager_constructed (GObject *object)
   PhoshWifiManager *self = PHOSH_WIFI_MANAGER (object);
 
   self->networks = g_list_store_new (PHOSH_TYPE_WIFI_NETWORK);
+  self->networks_by_key = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 
   self->cancel = g_cancellable_new ();
-  nm_client_new_async (self->cancel, on_nm_client_ready, self);
+  phosh_nm_client_get_async (self->cancel, on_nm_client_ready, self);
 
   G_OBJECT_CLASS (phosh_wifi_manager_parent_class)->constructed (object);
 }
@@ -1089,6 +1196,7 @@ phosh_wifi_manager_dispose (GObject *object)
   }
 
   g_clear_handle_id (&self->scanning_id, g_source_remove);
+  g_clear_handle_id (&self->periodic_scan_id, g_source_remove);
   cleanup_connection_device (self);
   cleanup_wifi_device (self);
 
@@ -1099,6 +1207,7 @@ phosh_wifi_manager_dispose (GObject *object)
 
   g_clear_pointer (&self->ssid, g_free);
 
+  g_clear_pointer (&self->networks_by_key, g_hash_table_unref);
   g_clear_object (&self->networks);
 
   G_OBJECT_CLASS (phosh_wifi_manager_parent_class)->dispose (object);
@@ -1380,6 +1489,68 @@ phosh_wifi_manager_request_scan (PhoshWifiManager *self)
   nm_device_wifi_request_scan_async (self->dev, self->cancel, on_request_scan, self);
 }
 
+/**
+ * phosh_wifi_manager_hold_periodic_scan:
+ * @self: The Wi-Fi manager
+ *
+ * Scan for networks right away and then periodically with an
+ * increasing interval until [method@WifiManager.release_periodic_scan]
+ * is called. Use this while the network list is shown.
+ */
+void
+phosh_wifi_manager_hold_periodic_scan (PhoshWifiManager *self)
+{
+  g_return_if_fail (PHOSH_IS_WIFI_MANAGER (self));
+
+  self->periodic_scan_holds++;
+  if (self->periodic_scan_holds > 1)
+    return;
+
+  phosh_wifi_manager_request_scan (self);
+  self->periodic_scan_interval = PERIODIC_SCAN_MIN_S;
+  schedule_periodic_scan (self);
+}
+
+/**
+ * phosh_wifi_manager_release_periodic_scan:
+ * @self: The Wi-Fi manager
+ *
+ * Release a hold taken via [method@WifiManager.hold_periodic_scan].
+ */
+void
+phosh_wifi_manager_release_periodic_scan (PhoshWifiManager *self)
+{
+  g_return_if_fail (PHOSH_IS_WIFI_MANAGER (self));
+  g_return_if_fail (self->periodic_scan_holds > 0);
+
+  self->periodic_scan_holds--;
+  if (self->periodic_scan_holds)
+    return;
+
+  g_clear_handle_id (&self->periodic_scan_id, g_source_remove);
+}
+
+/**
+ * phosh_wifi_manager_restart_periodic_scan:
+ * @self: The Wi-Fi manager
+ *
+ * If periodic scans are held scan right away and start over with the
+ * shortest interval, e.g. because the network list is likely stale
+ * after resume. Does nothing otherwise.
+ */
+void
+phosh_wifi_manager_restart_periodic_scan (PhoshWifiManager *self)
+{
+  g_return_if_fail (PHOSH_IS_WIFI_MANAGER (self));
+
+  if (self->periodic_scan_holds == 0)
+    return;
+
+  phosh_wifi_manager_request_scan (self);
+  self->periodic_scan_interval = PERIODIC_SCAN_MIN_S;
+  schedule_periodic_scan (self);
+}
+
 /**
  * phosh_wifi_manager_get_scanning:
  * @self: The WiFi manager
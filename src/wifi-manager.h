@@ -30,6 +30,9 @@ void               phosh_wifi_manager_set_hotspot_master (PhoshWifiManager *self
 void               phosh_wifi_manager_connect_network (PhoshWifiManager *self,
                                                        PhoshWifiNetwork *network);
 void               phosh_wifi_manager_request_scan (PhoshWifiManager *self);
+void               phosh_wifi_manager_hold_periodic_scan (PhoshWifiManager *self);
+void               phosh_wifi_manager_release_periodic_scan (PhoshWifiManager *self);
+void               phosh_wifi_manager_restart_periodic_scan (PhoshWifiManager *self);
 gboolean           phosh_wifi_manager_get_scanning (PhoshWifiManager *self);
 NMActiveConnectionState phosh_wifi_manager_get_state (PhoshWifiManager *self);
 NMActiveConnection     *phosh_wifi_manager_get_active_connection (PhoshWifiManager *self);
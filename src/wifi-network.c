@@ -8,6 +8,7 @@
 
 #define G_LOG_DOMAIN "phosh-wifi-network"
 
+#include "util.h"
 #include "wifi-network.h"
 
 /**
@@ -138,6 +139,24 @@ get_access_point_ssid (NMAccessPoint *ap)
 }
 
 
+static void
+set_best_access_point (PhoshWifiNetwork *self, NMAccessPoint *best_ap, guint strength)
+{
+  guint old_bucket = phosh_util_get_wifi_strength_bucket (self->strength);
+
+  self->strength = strength;
+  if (self->best_ap != best_ap) {
+    self->best_ap = best_ap;
+    g_object_notify_by_pspec (G_OBJECT (self), props[PROP_BEST_ACCESS_POINT]);
+  }
+
+  /* Only notify visible changes, in dense environments APs report signal
+   * changes all the time */
+  if (phosh_util_get_wifi_strength_bucket (strength) != old_bucket)
+    g_object_notify_by_pspec (G_OBJECT (self), props[PROP_STRENGTH]);
+}
+
+
 static void
 find_set_best_access_point (PhoshWifiNetwork *self)
 {
@@ -147,19 +166,13 @@ find_set_best_access_point (PhoshWifiNetwork *self)
   for (int i = 0; i < self->access_points->len; i++) {
     ap = g_ptr_array_index (self->access_points, i);
     strength = nm_access_point_get_strength (ap);
-    if (strength > new_strength) {
+    if (best_ap == NULL || strength > new_strength) {
       new_strength = strength;
       best_ap = ap;
     }
   }
 
-  self->best_ap = best_ap;
-
-  if (new_strength == self->strength)
-    return;
-
-  self->strength = new_strength;
-  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_STRENGTH]);
+  set_best_access_point (self, best_ap, new_strength);
 }
 
 
@@ -168,13 +181,16 @@ update_best_access_point (PhoshWifiNetwork *self, GParamSpec *pspec, NMAccessPoi
 {
   guint strength = nm_access_point_get_strength (ap);
 
-  if (strength <= self->strength)
+  /* The best AP got weaker, another one might be better now */
+  if (ap == self->best_ap && strength < self->strength) {
+    find_set_best_access_point (self);
     return;
+  }
 
-  self->strength = strength;
-  self->best_ap = ap;
-  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_STRENGTH]);
-  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_BEST_ACCESS_POINT]);
+  if (ap != self->best_ap && strength <= self->strength)
+    return;
+
+  set_best_access_point (self, ap, strength);
 }
 
 
@@ -255,7 +271,9 @@ phosh_wifi_network_class_init (PhoshWifiNetworkClass *klass)
   /**
    * PhoshWifiNetwork:strength:
    *
-   * Strength of the best access point of the network
+   * Strength of the best access point of the network. To avoid
+   * excessive updates it is only notified when the strength moves
+   * to a different bucket (see `phosh_util_get_wifi_strength_bucket()`).
    */
   props[PROP_STRENGTH] =
     g_param_spec_uint ("strength", "", "",
@@ -32,6 +32,7 @@ struct _PhoshWifiStatusPage {
 
   PhoshWifiManager           *wifi;
   char                       *connecting_network;
+  gboolean                    scan_held;
 };
 
 G_DEFINE_TYPE (PhoshWifiStatusPage, phosh_wifi_status_page, PHOSH_TYPE_STATUS_PAGE);
@@ -176,6 +177,9 @@ phosh_wifi_status_page_dispose (GObject *object)
   PhoshWifiStatusPage *self = PHOSH_WIFI_STATUS_PAGE (object);
 
   if (self->wifi) {
+    if (self->scan_held)
+      phosh_wifi_manager_release_periodic_scan (self->wifi);
+    self->scan_held = FALSE;
     g_signal_handlers_disconnect_by_data (self->wifi, self);
     g_clear_object (&self->wifi);
   }
@@ -186,6 +190,35 @@ phosh_wifi_status_page_dispose (GObject *object)
 }
 
 
+static void
+phosh_wifi_status_page_map (GtkWidget *widget)
+{
+  PhoshWifiStatusPage *self = PHOSH_WIFI_STATUS_PAGE (widget);
+
+  GTK_WIDGET_CLASS (phosh_wifi_status_page_parent_class)->map (widget);
+
+  /* Keep the network list current while it's shown */
+  if (self->wifi && !self->scan_held) {
+    phosh_wifi_manager_hold_periodic_scan (self->wifi);
+    self->scan_held = TRUE;
+  }
+}
+
+
+static void
+phosh_wifi_status_page_unmap (GtkWidget *widget)
+{
+  PhoshWifiStatusPage *self = PHOSH_WIFI_STATUS_PAGE (widget);
+
+  if (self->scan_held) {
+    phosh_wifi_manager_release_periodic_scan (self->wifi);
+    self->scan_held = FALSE;
+  }
+
+  GTK_WIDGET_CLASS (phosh_wifi_status_page_parent_class)->unmap (widget);
+}
+
+
 static void
 phosh_wifi_status_page_class_init (PhoshWifiStatusPageClass *klass)
 {
@@ -194,6 +227,9 @@ phosh_wifi_status_page_class_init (PhoshWifiStatusPageClass *klass)
 
   object_class->dispose = phosh_wifi_status_page_dispose;
 
+  widget_class->map = phosh_wifi_status_page_map;
+  widget_class->unmap = phosh_wifi_status_page_unmap;
+
   gtk_widget_class_set_template_from_resource (widget_class,
                                                "/mobi/phosh/ui/wifi-status-page.ui");
 
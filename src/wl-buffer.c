@@ -19,37 +19,50 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+/* Smallest bucket is 64 KiB */
+#define POOL_MIN_BUCKET_SHIFT 16
+
 /**
- * phosh_wl_buffer_new: (skip)
- * @format: The buffer format
- * @width: The buffer's width in pixels
- * @height: The buffer's height in lines
- * @stride: The buffer's stride in bytes
+ * PhoshWlBufferPool:
  *
- * Creates a new memory buffer to be shared with the Wayland compositor.
+ * A pool of shared memory buffers that can be reused for screencopy
+ * frames of similar size (e.g. toplevel thumbnails in the overview).
  *
- * Returns: The new buffer
+ * Buffers are grouped into power of two sized buckets. Released
+ * buffers keep their mapping and `wl_shm_pool` so acquiring a buffer
+ * of a similar size doesn't need to create, map and unmap shared
+ * memory again. The total size of unused buffers kept around is
+ * capped, use [method@WlBufferPool.trim] to release them
+ * early.
  */
-PhoshWlBuffer *
-phosh_wl_buffer_new (enum wl_shm_format format, uint32_t width, uint32_t height, uint32_t stride)
+struct _PhoshWlBufferPool {
+  grefcount refcount;
+
+  gsize     max_cached;
+  gsize     cached;
+  /* Most recently released buffers first */
+  GQueue    free_buffers;
+};
+
+
+static PhoshWlBuffer *
+wl_buffer_alloc (gsize capacity)
 {
   PhoshWayland *wl = phosh_wayland_get_default ();
-  size_t size = stride * height;
-  struct wl_shm_pool *pool;
+  PhoshWlBuffer *buf;
   void *data;
   int fd;
-  PhoshWlBuffer *buf;
 
   g_return_val_if_fail (PHOSH_IS_WAYLAND (wl), NULL);
-  g_return_val_if_fail (size, NULL);
+  g_return_val_if_fail (capacity, NULL);
 
-  fd = phosh_create_shm_file (size);
+  fd = phosh_create_shm_file (capacity);
   if (fd < 0) {
     g_warning ("Failed to create shm file: %s", g_strerror (errno));
     return NULL;
   }
 
-  data = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  data = mmap (NULL, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
   if (data == MAP_FAILED) {
     g_warning ("Could not mmap buffer [fd: %d] %s", fd, g_strerror (errno));
     close (fd);
@@ -57,17 +70,56 @@ phosh_wl_buffer_new (enum wl_shm_format format, uint32_t width, uint32_t height,
   }
 
   buf = g_new0 (PhoshWlBuffer, 1);
+  buf->data = data;
+  buf->capacity = capacity;
+
+  buf->wl_shm_pool = wl_shm_create_pool (phosh_wayland_get_wl_shm (wl), fd, capacity);
+
+  close (fd);
+
+  return buf;
+}
+
+
+static void
+wl_buffer_free (PhoshWlBuffer *self)
+{
+  if (munmap (self->data, self->capacity) < 0)
+    g_warning ("Failed to unmap buffer %p: %s", self, g_strerror (errno));
+
+  g_clear_pointer (&self->wl_buffer, wl_buffer_destroy);
+  g_clear_pointer (&self->wl_shm_pool, wl_shm_pool_destroy);
+  g_free (self);
+}
+
+/**
+ * phosh_wl_buffer_new: (skip)
+ * @format: The buffer format
+ * @width: The buffer's width in pixels
+ * @height: The buffer's height in lines
+ * @stride: The buffer's stride in bytes
+ *
+ * Creates a new memory buffer to be shared with the Wayland compositor.
+ *
+ * Returns: The new buffer
+ */
+PhoshWlBuffer *
+phosh_wl_buffer_new (enum wl_shm_format format, uint32_t width, uint32_t height, uint32_t stride)
+{
+  PhoshWlBuffer *buf;
+
+  buf = wl_buffer_alloc (stride * height);
+  if (buf == NULL)
+    return NULL;
+
   buf->width = width;
   buf->height = height;
   buf->stride = stride;
   buf->format = format;
-  buf->data = data;
-
-  pool = wl_shm_create_pool (phosh_wayland_get_wl_shm (wl), fd, size);
-  buf->wl_buffer = wl_shm_pool_create_buffer (pool, 0, width, height, stride, format);
-  wl_shm_pool_destroy (pool);
 
-  close(fd);
+  buf->wl_buffer = wl_shm_pool_create_buffer (buf->wl_shm_pool, 0, width, height, stride, format);
+  /* Not reused so no need to keep it around */
+  g_clear_pointer (&buf->wl_shm_pool, wl_shm_pool_destroy);
 
   return buf;
 }
@@ -77,19 +129,38 @@ phosh_wl_buffer_new (enum wl_shm_format format, uint32_t width, uint32_t height,
  * @self: The #PhoshWlBuffer
  *
  * Invokes `munmap` on the data and frees associated memory and data
- * structures.
+ * structures. If the buffer was acquired from a #PhoshWlBufferPool
+ * it is handed back to the pool instead.
  */
 void
 phosh_wl_buffer_destroy (PhoshWlBuffer *self)
 {
+  PhoshWlBufferPool *pool;
+
   if (self == NULL)
     return;
 
-  if (munmap (self->data, self->stride * self->height) < 0)
-    g_warning ("Failed to unmap buffer %p: %s", self, g_strerror (errno));
+  pool = g_steal_pointer (&self->pool);
+  if (pool == NULL) {
+    wl_buffer_free (self);
+    return;
+  }
 
-  wl_buffer_destroy (self->wl_buffer);
-  g_free (self);
+  if (self->capacity > pool->max_cached) {
+    wl_buffer_free (self);
+  } else {
+    g_queue_push_head (&pool->free_buffers, self);
+    pool->cached += self->capacity;
+
+    while (pool->cached > pool->max_cached) {
+      PhoshWlBuffer *oldest = g_queue_pop_tail (&pool->free_buffers);
+
+      pool->cached -= oldest->capacity;
+      wl_buffer_free (oldest);
+    }
+  }
+
+  phosh_wl_buffer_pool_unref (pool);
 }
 
 /**
@@ -117,3 +188,167 @@ phosh_wl_buffer_get_bytes (PhoshWlBuffer *self)
 {
   return g_bytes_new (self->data, phosh_wl_buffer_get_size (self));
 }
+
+/**
+ * phosh_wl_buffer_pool_new: (skip)
+ * @max_cached: The maximum number of bytes of unused buffers to keep
+ *
+ * Creates a new buffer pool.
+ *
+ * Returns: The new buffer pool
+ */
+PhoshWlBufferPool *
+phosh_wl_buffer_pool_new (gsize max_cached)
+{
+  PhoshWlBufferPool *self = g_new0 (PhoshWlBufferPool, 1);
+
+  g_ref_count_init (&self->refcount);
+  self->max_cached = max_cached;
+  g_queue_init (&self->free_buffers);
+
+  return self;
+}
+
+/**
+ * phosh_wl_buffer_pool_ref: (skip)
+ * @self: The buffer pool
+ *
+ * Increases the reference count of the pool.
+ *
+ * Returns: The pool
+ */
+PhoshWlBufferPool *
+phosh_wl_buffer_pool_ref (PhoshWlBufferPool *self)
+{
+  g_return_val_if_fail (self, NULL);
+
+  g_ref_count_inc (&self->refcount);
+  return self;
+}
+
+/**
+ * phosh_wl_buffer_pool_unref: (skip)
+ * @self: The buffer pool
+ *
+ * Decreases the reference count of the pool. Buffers acquired from
+ * the pool keep a reference so the pool stays around until all of
+ * them got destroyed.
+ */
+void
+phosh_wl_buffer_pool_unref (PhoshWlBufferPool *self)
+{
+  g_return_if_fail (self);
+
+  if (!g_ref_count_dec (&self->refcount))
+    return;
+
+  phosh_wl_buffer_pool_trim (self);
+  g_free (self);
+}
+
+/**
+ * phosh_wl_buffer_pool_acquire: (skip)
+ * @self: The buffer pool
+ * @format: The buffer format
+ * @width: The buffer's width in pixels
+ * @height: The buffer's height in lines
+ * @stride: The buffer's stride in bytes
+ *
+ * Gets a memory buffer to be shared with the Wayland compositor,
+ * reusing a previously released one if there's one in the same size
+ * bucket. Use [func@wl_buffer_destroy] to hand it back to the pool.
+ *
+ * Returns: The buffer
+ */
+PhoshWlBuffer *
+phosh_wl_buffer_pool_acquire (PhoshWlBufferPool  *self,
+                              enum wl_shm_format  format,
+                              uint32_t            width,
+                              uint32_t            height,
+                              uint32_t            stride)
+{
+  gsize size = (gsize)stride * height;
+  gsize capacity;
+  guint shift;
+  PhoshWlBuffer *buf = NULL;
+
+  g_return_val_if_fail (self, NULL);
+  g_return_val_if_fail (size, NULL);
+
+  shift = MAX (g_bit_storage (size - 1), POOL_MIN_BUCKET_SHIFT);
+  capacity = (gsize)1 << shift;
+
+  for (GList *l = self->free_buffers.head; l; l = l->next) {
+    PhoshWlBuffer *candidate = l->data;
+
+    if (candidate->capacity != capacity)
+      continue;
+
+    buf = candidate;
+    g_queue_delete_link (&self->free_buffers, l);
+    self->cached -= capacity;
+    break;
+  }
+
+  if (buf) {
+    /* The wl_buffer can be reused as is if the geometry didn't change */
+    if (buf->wl_buffer && (buf->format != format || buf->width != width ||
+                           buf->height != height || buf->stride != stride)) {
+      g_clear_pointer (&buf->wl_buffer, wl_buffer_destroy);
+    }
+  } else {
+    buf = wl_buffer_alloc (capacity);
+    if (buf == NULL)
+      return NULL;
+  }
+
+  buf->width = width;
+  buf->height = height;
+  buf->stride = stride;
+  buf->format = format;
+  buf->pool = phosh_wl_buffer_pool_ref (self);
+
+  if (buf->wl_buffer == NULL)
+    buf->wl_buffer = wl_shm_pool_create_buffer (buf->wl_shm_pool, 0, width, height, stride, format);
+
+  return buf;
+}
+
+/**
+ * phosh_wl_buffer_pool_trim: (skip)
+ * @self: The buffer pool
+ *
+ * Frees all currently unused buffers. Buffers that are still in use
+ * are not affected.
+ */
+void
+phosh_wl_buffer_pool_trim (PhoshWlBufferPool *self)
+{
+  PhoshWlBuffer *buf;
+
+  g_return_if_fail (self);
+
+  if (self->cached)
+    g_debug ("Trimming %" G_GSIZE_FORMAT " bytes of cached buffers", self->cached);
+
+  while ((buf = g_queue_pop_head (&self->free_buffers)))
+    wl_buffer_free (buf);
+
+  self->cached = 0;
+}
+
+/**
+ * phosh_wl_buffer_pool_get_cached_size: (skip)
+ * @self: The buffer pool
+ *
+ * Get the amount of memory held by currently unused buffers.
+ *
+ * Returns: The size in bytes
+ */
+gsize
+phosh_wl_buffer_pool_get_cached_size (PhoshWlBufferPool *self)
+{
+  g_return_val_if_fail (self, 0);
+
+  return self->cached;
+}
@@ -12,6 +12,8 @@
 
 G_BEGIN_DECLS
 
+typedef struct _PhoshWlBufferPool PhoshWlBufferPool;
+
 /**
  * PhoshWlBuffer:
  * @data: The actual data
@@ -24,11 +26,14 @@ G_BEGIN_DECLS
  * data.
  */
 typedef struct {
-  void              *data;
-  uint32_t           width, height, stride;
-  enum wl_shm_format format;
+  void               *data;
+  uint32_t            width, height, stride;
+  enum wl_shm_format  format;
   /*< private >*/
-  struct wl_buffer  *wl_buffer;
+  struct wl_buffer   *wl_buffer;
+  struct wl_shm_pool *wl_shm_pool;
+  gsize               capacity;
+  PhoshWlBufferPool  *pool;
 } PhoshWlBuffer;
 
 PhoshWlBuffer *phosh_wl_buffer_new (enum wl_shm_format format, uint32_t width, uint32_t height, uint32_t stride);
@@ -36,4 +41,17 @@ void           phosh_wl_buffer_destroy (PhoshWlBuffer *self);
 gsize          phosh_wl_buffer_get_size (PhoshWlBuffer *self);
 GBytes        *phosh_wl_buffer_get_bytes (PhoshWlBuffer *self);
 
+PhoshWlBufferPool *phosh_wl_buffer_pool_new (gsize max_cached);
+PhoshWlBufferPool *phosh_wl_buffer_pool_ref (PhoshWlBufferPool *self);
+void               phosh_wl_buffer_pool_unref (PhoshWlBufferPool *self);
+PhoshWlBuffer     *phosh_wl_buffer_pool_acquire (PhoshWlBufferPool  *self,
+                                                 enum wl_shm_format  format,
+                                                 uint32_t            width,
+                                                 uint32_t            height,
+                                                 uint32_t            stride);
+void               phosh_wl_buffer_pool_trim (PhoshWlBufferPool *self);
+gsize              phosh_wl_buffer_pool_get_cached_size (PhoshWlBufferPool *self);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (PhoshWlBufferPool, phosh_wl_buffer_pool_unref)
+
 G_END_DECLS
@@ -91,14 +91,6 @@ phosh_wwan_info_get_property (GObject *object,
 }
 
 
-enum quality {
-  QUALITY_EXCELLENT = 0,
-  QUALITY_GOOD,
-  QUALITY_OK,
-  QUALITY_WEAK,
-  QUALITY_NONE,
-};
-
 static const char *quality_data[] = {
   "network-cellular-signal-excellent-symbolic",
   "network-cellular-signal-good-symbolic",
@@ -122,16 +114,7 @@ signal_quality_icon_name (guint quality, gboolean data_enabled)
 {
   const char **q = data_enabled ? quality_data : quality_no_data;
 
-  if (quality > 80)
-    return q[QUALITY_EXCELLENT];
-  else if (quality > 55)
-    return q[QUALITY_GOOD];
-  else if (quality > 30)
-    return q[QUALITY_OK];
-  else if (quality > 5)
-    return q[QUALITY_WEAK];
-  else
-    return q[QUALITY_NONE];
+  return q[phosh_wwan_signal_level_from_quality (quality)];
 }
 
 
@@ -53,7 +53,6 @@ typedef struct _PhoshWWanMM {
   GCancellable                   *cancel;
   GDBusConnection                *connection;
 
-  guint                           signal_quality;
   const char                     *access_tec;
   gboolean                        unlocked;
   gboolean                        sim;
@@ -76,8 +75,8 @@ phosh_wwan_mm_update_signal_quality (PhoshWWanMM *self)
   g_return_if_fail (self);
   g_return_if_fail (self->modem);
 
-  self->signal_quality = mm_modem_get_signal_quality (self->modem, NULL);
-  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_SIGNAL_QUALITY]);
+  phosh_wwan_manager_set_signal_quality (PHOSH_WWAN_MANAGER (self),
+                                         mm_modem_get_signal_quality (self->modem, NULL));
 }
 
 
@@ -112,13 +111,18 @@ phosh_wwan_mm_user_friendly_access_tec (guint access_tec)
 static void
 phosh_wwan_mm_update_access_tec (PhoshWWanMM *self)
 {
-  guint access_tec;
+  const char *access_tec;
+  guint mm_access_tec;
 
   g_return_if_fail (self);
   g_return_if_fail (self->modem);
 
-  access_tec = mm_modem_get_access_technologies (self->modem);
-  self->access_tec = phosh_wwan_mm_user_friendly_access_tec (access_tec);
+  mm_access_tec = mm_modem_get_access_technologies (self->modem);
+  access_tec = phosh_wwan_mm_user_friendly_access_tec (mm_access_tec);
+  if (g_strcmp0 (self->access_tec, access_tec) == 0)
+    return;
+
+  self->access_tec = access_tec;
   g_debug ("Access tec is %s", self->access_tec);
   g_object_notify_by_pspec (G_OBJECT (self), props[PROP_ACCESS_TEC]);
 }
@@ -265,7 +269,7 @@ phosh_wwan_mm_get_property (GObject    *object,
 
   switch (property_id) {
   case PROP_SIGNAL_QUALITY:
-    g_value_set_uint (value, self->signal_quality);
+    g_value_set_uint (value, phosh_wwan_manager_get_signal_quality (PHOSH_WWAN_MANAGER (self)));
     break;
   case PROP_ACCESS_TEC:
     g_value_set_string (value, self->access_tec);
@@ -318,8 +322,7 @@ phosh_wwan_mm_destroy_modem (PhoshWWanMM *self)
   self->enabled = FALSE;
   g_object_notify_by_pspec (G_OBJECT (self), props[PROP_ENABLED]);
 
-  self->signal_quality = 0;
-  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_SIGNAL_QUALITY]);
+  phosh_wwan_manager_set_signal_quality (PHOSH_WWAN_MANAGER (self), 0);
 
   self->access_tec = NULL;
   g_object_notify_by_pspec (G_OBJECT (self), props[PROP_ACCESS_TEC]);
@@ -371,7 +374,11 @@ modem_init_modem (PhoshWWanMM *self, MMObject *object)
 static void
 emit_new_cbm_received (PhoshWWanMM *self, MMCbm *cbm)
 {
-  g_signal_emit_by_name (self, "new-cbm", mm_cbm_get_text (cbm), mm_cbm_get_channel (cbm));
+  g_signal_emit_by_name (self, "new-cbm",
+                         mm_cbm_get_text (cbm),
+                         mm_cbm_get_channel (cbm),
+                         mm_cbm_get_message_code (cbm),
+                         mm_cbm_get_update (cbm));
 }
 
 
@@ -650,13 +657,9 @@ phosh_wwan_mm_class_init (PhoshWWanMMClass *klass)
 static guint
 phosh_wwan_mm_get_signal_quality (PhoshWWan *phosh_wwan)
 {
-  PhoshWWanMM *self;
-
   g_return_val_if_fail (PHOSH_IS_WWAN_MM (phosh_wwan), 0);
 
-  self = PHOSH_WWAN_MM (phosh_wwan);
-
-  return self->signal_quality;
+  return phosh_wwan_manager_get_signal_quality (PHOSH_WWAN_MANAGER (phosh_wwan));
 }
 
 
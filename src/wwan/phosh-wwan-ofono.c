@@ -52,7 +52,6 @@ typedef struct _PhoshWWanOfono {
   gulong                             proxy_sim_props_signal_id;
 
   char                              *object_path;
-  guint                              signal_quality;
   const char                        *access_tec;
   gboolean                           locked;
   gboolean                           sim;
@@ -72,8 +71,7 @@ phosh_wwan_ofono_update_signal_quality (PhoshWWanOfono *self, GVariant *v)
   g_return_if_fail (self);
   g_return_if_fail (v);
 
-  self->signal_quality = g_variant_get_byte (v);
-  g_object_notify (G_OBJECT (self), "signal-quality");
+  phosh_wwan_manager_set_signal_quality (PHOSH_WWAN_MANAGER (self), g_variant_get_byte (v));
 }
 
 
@@ -108,8 +106,11 @@ phosh_wwan_ofono_update_access_tec (PhoshWWanOfono *self, GVariant *v)
   g_return_if_fail (self);
   g_return_if_fail (v);
 
-  access_tec = g_variant_get_string (v, NULL);
-  self->access_tec = phosh_wwan_ofono_user_friendly_access_tec (access_tec);
+  access_tec = phosh_wwan_ofono_user_friendly_access_tec (g_variant_get_string (v, NULL));
+  if (g_strcmp0 (self->access_tec, access_tec) == 0)
+    return;
+
+  self->access_tec = access_tec;
 
   g_debug ("Access tec is %s", self->access_tec);
   g_object_notify (G_OBJECT (self), "access-tec");
@@ -256,7 +257,7 @@ phosh_wwan_ofono_get_property (GObject    *object,
 
   switch (property_id) {
   case PHOSH_WWAN_OFONO_PROP_SIGNAL_QUALITY:
-    g_value_set_uint (value, self->signal_quality);
+    g_value_set_uint (value, phosh_wwan_manager_get_signal_quality (PHOSH_WWAN_MANAGER (self)));
     break;
   case PHOSH_WWAN_OFONO_PROP_ACCESS_TEC:
     g_value_set_string (value, self->access_tec);
@@ -297,8 +298,7 @@ phosh_wwan_ofono_destroy_modem (PhoshWWanOfono *self)
 
   phosh_wwan_ofono_update_present (self, FALSE);
 
-  self->signal_quality = 0;
-  g_object_notify (G_OBJECT (self), "signal-quality");
+  phosh_wwan_manager_set_signal_quality (PHOSH_WWAN_MANAGER (self), 0);
 
   self->access_tec = NULL;
   g_object_notify (G_OBJECT (self), "access-tec");
@@ -623,13 +623,9 @@ phosh_wwan_ofono_class_init (PhoshWWanOfonoClass *klass)
 static guint
 phosh_wwan_ofono_get_signal_quality (PhoshWWan *phosh_wwan)
 {
-  PhoshWWanOfono *self;
-
   g_return_val_if_fail (PHOSH_IS_WWAN_OFONO (phosh_wwan), 0);
 
-  self = PHOSH_WWAN_OFONO (phosh_wwan);
-
-  return self->signal_quality;
+  return phosh_wwan_manager_get_signal_quality (PHOSH_WWAN_MANAGER (phosh_wwan));
 }
 
 
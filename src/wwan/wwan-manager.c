@@ -11,6 +11,7 @@
 
 #include "phosh-config.h"
 
+#include "nm-client.h"
 #include "phosh-wwan-iface.h"
 #include "wwan-manager.h"
 #include "util.h"
@@ -23,6 +24,9 @@ enum {
 };
 static guint signals[N_SIGNALS];
 
+/* Don't propagate signal level changes more often than this */
+#define SIGNAL_QUALITY_MIN_INTERVAL_MS 2000
+
 #define is_type_wwan_connection(s)                                      \
   (g_strcmp0 ((s), NM_SETTING_GSM_SETTING_NAME) == 0 ||                 \
    g_strcmp0 ((s), NM_SETTING_CDMA_SETTING_NAME) == 0)
@@ -43,6 +47,12 @@ static GParamSpec *props[PROP_LAST_PROP];
  *
  * Common code for implementations of the #PhoshWWan interface covering
  * NetworkManager related bits for the mobile data connection.
+ *
+ * It also tracks the signal quality on behalf of the implementations:
+ * changes are only propagated when they change the displayed
+ * [enum@WWanSignalLevel] and at most every
+ * `SIGNAL_QUALITY_MIN_INTERVAL_MS` so a fluctuating signal doesn't
+ * wake up and redraw the UI several times per second.
  */
 typedef struct _PhoshWWanManagerPrivate {
   NMClient           *nmclient;
@@ -51,6 +61,11 @@ typedef struct _PhoshWWanManagerPrivate {
 
   gboolean            has_data;
   char               *last_uuid;
+
+  guint               signal_quality;
+  guint               pending_quality;
+  guint               signal_quality_id;
+  gint64              last_quality_update;
 } PhoshWWanManagerPrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (PhoshWWanManager, phosh_wwan_manager, G_TYPE_OBJECT);
@@ -338,7 +353,7 @@ on_nm_client_ready (GObject *obj, GAsyncResult *res, gpointer data)
   PhoshWWanManagerPrivate *priv;
   NMClient *nmclient;
 
-  nmclient = nm_client_new_finish (res, &err);
+  nmclient = phosh_nm_client_get_finish (res, &err);
   if (nmclient == NULL) {
     phosh_async_error_warn (err, "Failed to init NM");
     return;
@@ -361,6 +376,36 @@ on_nm_client_ready (GObject *obj, GAsyncResult *res, gpointer data)
 }
 
 
+static void
+publish_signal_quality (PhoshWWanManager *self)
+{
+  PhoshWWanManagerPrivate *priv = phosh_wwan_manager_get_instance_private (self);
+
+  g_debug ("Signal quality changed to %u", priv->pending_quality);
+  priv->signal_quality = priv->pending_quality;
+  priv->last_quality_update = g_get_monotonic_time ();
+  g_object_notify (G_OBJECT (self), "signal-quality");
+}
+
+
+static gboolean
+on_signal_quality_timeout (gpointer data)
+{
+  PhoshWWanManager *self = PHOSH_WWAN_MANAGER (data);
+  PhoshWWanManagerPrivate *priv = phosh_wwan_manager_get_instance_private (self);
+
+  priv->signal_quality_id = 0;
+
+  if (phosh_wwan_signal_level_from_quality (priv->pending_quality) !=
+      phosh_wwan_signal_level_from_quality (priv->signal_quality))
+    publish_signal_quality (self);
+  else
+    priv->signal_quality = priv->pending_quality;
+
+  return G_SOURCE_REMOVE;
+}
+
+
 static void
 phosh_wwan_manager_constructed (GObject *object)
 {
@@ -370,7 +415,7 @@ phosh_wwan_manager_constructed (GObject *object)
   G_OBJECT_CLASS (phosh_wwan_manager_parent_class)->constructed (object);
 
   priv->cancel = g_cancellable_new ();
-  nm_client_new_async (priv->cancel, on_nm_client_ready, self);
+  phosh_nm_client_get_async (priv->cancel, on_nm_client_ready, self);
 }
 
 static void
@@ -390,6 +435,7 @@ phosh_wwan_manager_dispose (GObject *object)
   }
 
   g_clear_pointer (&priv->last_uuid, g_free);
+  g_clear_handle_id (&priv->signal_quality_id, g_source_remove);
 
   G_OBJECT_CLASS (phosh_wwan_manager_parent_class)->dispose (object);
 }
@@ -437,9 +483,12 @@ phosh_wwan_manager_class_init (PhoshWWanManagerClass *klass)
    * @self: The wwan manager
    * @message: The message text
    * @channel: The channel specifying the source of the CBM
+   * @message_code: The message code, part of the CBM's serial number
+   * @update: The update number, part of the CBM's serial number
    *
    * This signal is emitted when a new cell broadcast message is
-   * received.
+   * received. Networks repeat messages, repetitions have the same
+   * channel, message code and update number.
    *
    * Since: 0.44.0
    */
@@ -448,8 +497,10 @@ phosh_wwan_manager_class_init (PhoshWWanManagerClass *klass)
                                    G_SIGNAL_RUN_LAST,
                                    0, NULL, NULL, NULL,
                                    G_TYPE_NONE,
-                                   2,
+                                   4,
                                    G_TYPE_STRING,
+                                   G_TYPE_UINT,
+                                   G_TYPE_UINT,
                                    G_TYPE_UINT);
 }
 
@@ -538,3 +589,87 @@ phosh_wwan_manager_has_data (PhoshWWanManager *self)
 
   return priv->has_data;
 }
+
+/**
+ * phosh_wwan_manager_set_signal_quality:
+ * @self: The wwan manager
+ * @quality: The signal quality in percent
+ *
+ * Used by implementations to update the signal quality. The
+ * `signal-quality` property is only notified when the signal level
+ * changes and at most every `SIGNAL_QUALITY_MIN_INTERVAL_MS`.
+ */
+void
+phosh_wwan_manager_set_signal_quality (PhoshWWanManager *self, guint quality)
+{
+  PhoshWWanManagerPrivate *priv;
+  gint64 elapsed_ms;
+
+  g_return_if_fail (PHOSH_IS_WWAN_MANAGER (self));
+  priv = phosh_wwan_manager_get_instance_private (self);
+
+  priv->pending_quality = quality;
+
+  /* Throttled, the timeout picks up the latest value */
+  if (priv->signal_quality_id)
+    return;
+
+  if (phosh_wwan_signal_level_from_quality (quality) ==
+      phosh_wwan_signal_level_from_quality (priv->signal_quality)) {
+    priv->signal_quality = quality;
+    return;
+  }
+
+  elapsed_ms = (g_get_monotonic_time () - priv->last_quality_update) / 1000;
+  if (priv->last_quality_update == 0 || elapsed_ms >= SIGNAL_QUALITY_MIN_INTERVAL_MS) {
+    publish_signal_quality (self);
+    return;
+  }
+
+  priv->signal_quality_id = g_timeout_add (SIGNAL_QUALITY_MIN_INTERVAL_MS - elapsed_ms,
+                                           on_signal_quality_timeout,
+                                           self);
+  g_source_set_name_by_id (priv->signal_quality_id, "[phosh] wwan signal quality");
+}
+
+/**
+ * phosh_wwan_manager_get_signal_quality:
+ * @self: The wwan manager
+ *
+ * Get the signal quality as set by [method@WWanManager.set_signal_quality].
+ *
+ * Returns: The signal quality in percent
+ */
+guint
+phosh_wwan_manager_get_signal_quality (PhoshWWanManager *self)
+{
+  PhoshWWanManagerPrivate *priv;
+
+  g_return_val_if_fail (PHOSH_IS_WWAN_MANAGER (self), 0);
+  priv = phosh_wwan_manager_get_instance_private (self);
+
+  return priv->signal_quality;
+}
+
+/**
+ * phosh_wwan_signal_level_from_quality:
+ * @quality: The signal quality in percent
+ *
+ * Map the signal quality to the level displayed in the UI.
+ *
+ * Returns: The signal level
+ */
+PhoshWWanSignalLevel
+phosh_wwan_signal_level_from_quality (guint quality)
+{
+  if (quality > 80)
+    return PHOSH_WWAN_SIGNAL_LEVEL_EXCELLENT;
+  else if (quality > 55)
+    return PHOSH_WWAN_SIGNAL_LEVEL_GOOD;
+  else if (quality > 30)
+    return PHOSH_WWAN_SIGNAL_LEVEL_OK;
+  else if (quality > 5)
+    return PHOSH_WWAN_SIGNAL_LEVEL_WEAK;
+  else
+    return PHOSH_WWAN_SIGNAL_LEVEL_NONE;
+}
@@ -18,10 +18,32 @@ struct _PhoshWWanManagerClass {
   GObjectClass parent_class;
 };
 
+/**
+ * PhoshWWanSignalLevel:
+ * @PHOSH_WWAN_SIGNAL_LEVEL_EXCELLENT: Excellent signal
+ * @PHOSH_WWAN_SIGNAL_LEVEL_GOOD: Good signal
+ * @PHOSH_WWAN_SIGNAL_LEVEL_OK: Ok signal
+ * @PHOSH_WWAN_SIGNAL_LEVEL_WEAK: Weak signal
+ * @PHOSH_WWAN_SIGNAL_LEVEL_NONE: No usable signal
+ *
+ * The discrete signal levels as displayed in the UI
+ */
+typedef enum {
+  PHOSH_WWAN_SIGNAL_LEVEL_EXCELLENT = 0,
+  PHOSH_WWAN_SIGNAL_LEVEL_GOOD,
+  PHOSH_WWAN_SIGNAL_LEVEL_OK,
+  PHOSH_WWAN_SIGNAL_LEVEL_WEAK,
+  PHOSH_WWAN_SIGNAL_LEVEL_NONE,
+} PhoshWWanSignalLevel;
+
 PhoshWWanManager  *phosh_wwan_manager_new (void);
 void               phosh_wwan_manager_set_enabled (PhoshWWanManager *self, gboolean enabled);
 gboolean           phosh_wwan_manager_get_data_enabled (PhoshWWanManager *self);
 void               phosh_wwan_manager_set_data_enabled (PhoshWWanManager *self, gboolean enabled);
 gboolean           phosh_wwan_manager_has_data (PhoshWWanManager *self);
+void               phosh_wwan_manager_set_signal_quality (PhoshWWanManager *self, guint quality);
+guint              phosh_wwan_manager_get_signal_quality (PhoshWWanManager *self);
+
+PhoshWWanSignalLevel phosh_wwan_signal_level_from_quality (guint quality);
 
 G_END_DECLS
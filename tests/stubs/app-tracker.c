@@ -30,3 +30,15 @@ phosh_app_tracker_launch_app_info (PhoshAppTracker *self,
                                    GAppInfo        *info)
 {
 }
+
+PhoshAppScopes *
+phosh_app_tracker_get_scopes (PhoshAppTracker *self)
+{
+  return NULL;
+}
+
+void
+phosh_app_tracker_add_toplevel (PhoshAppTracker *self,
+                                PhoshToplevel   *toplevel)
+{
+}
@@ -96,6 +96,20 @@ phosh_shell_get_mpris_manager (PhoshShell *self)
 }
 
 
+PhoshPowerSaverManager *
+phosh_shell_get_power_saver_manager (PhoshShell *self)
+{
+  return NULL;
+}
+
+
+PhoshModeManager *
+phosh_shell_get_mode_manager (PhoshShell *self)
+{
+  return NULL;
+}
+
+
 PhoshWifiManager *
 phosh_shell_get_wifi_manager (PhoshShell *self)
 {
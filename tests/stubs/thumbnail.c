@@ -49,8 +49,18 @@ phosh_thumbnail_is_ready (PhoshThumbnail *self)
   return FALSE;
 }
 
+const cairo_region_t *
+phosh_thumbnail_get_damage (PhoshThumbnail *self)
+{
+  return NULL;
+}
+
 PhoshToplevelThumbnail *
-phosh_toplevel_thumbnail_new_from_toplevel (PhoshToplevel *toplevel, guint32 max_width, guint32 max_height)
+phosh_toplevel_thumbnail_new_from_toplevel (PhoshToplevel     *toplevel,
+                                            PhoshWlBufferPool *pool,
+                                            guint32            max_width,
+                                            guint32            max_height,
+                                            gboolean           with_damage)
 {
   return g_object_new (PHOSH_TYPE_THUMBNAIL, NULL);
 }
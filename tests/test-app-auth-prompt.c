@@ -28,6 +28,48 @@ test_app_auth_prompt_new (PhoshTestCompositorFixture *fixture, gconstpointer unu
   gtk_widget_destroy (prompt);
 }
 
+
+static void
+test_app_auth_prompt_set_request (PhoshTestCompositorFixture *fixture, gconstpointer unused)
+{
+  g_autofree char *subtitle = NULL;
+  g_autofree char *body = NULL;
+  g_autoptr (GVariant) choices = NULL;
+  g_autoptr (GVariant) selected = NULL;
+  GtkWidget *prompt = g_object_new (PHOSH_TYPE_APP_AUTH_PROMPT,
+                                    "monitor", phosh_test_get_monitor (fixture->state),
+                                    "title", "title",
+                                    "subtitle", "subtitle",
+                                    "body", "body",
+                                    NULL);
+
+  phosh_system_modal_dialog_set_reusable (PHOSH_SYSTEM_MODAL_DIALOG (prompt), TRUE);
+  gtk_widget_set_visible (prompt, TRUE);
+  gtk_widget_set_visible (prompt, FALSE);
+
+  phosh_app_auth_prompt_set_request (PHOSH_APP_AUTH_PROMPT (prompt),
+                                     NULL,
+                                     "title2",
+                                     "subtitle2",
+                                     "body2",
+                                     "ok",
+                                     "cancel",
+                                     TRUE,
+                                     g_variant_new_parsed ("[('id', 'label', @a(ss) [], 'true')]"));
+  g_object_get (prompt, "subtitle", &subtitle, "body", &body, "choices", &choices, NULL);
+  g_assert_cmpstr (subtitle, ==, "subtitle2");
+  g_assert_cmpstr (body, ==, "body2");
+  g_assert_nonnull (choices);
+  g_assert_false (phosh_app_auth_prompt_get_grant_access (prompt));
+  g_assert_false (phosh_app_auth_prompt_get_remember (prompt));
+  selected = g_variant_ref_sink (phosh_app_auth_prompt_get_selected_choices (prompt));
+  g_assert_cmpint (g_variant_n_children (selected), ==, 1);
+
+  gtk_widget_set_visible (prompt, TRUE);
+  gtk_widget_destroy (prompt);
+}
+
+
 int
 main (int   argc,
       char *argv[])
@@ -35,6 +77,8 @@ main (int   argc,
   g_test_init (&argc, &argv, NULL);
 
   PHOSH_COMPOSITOR_TEST_ADD ("/phosh/app_auth_prompt_new/new", test_app_auth_prompt_new);
+  PHOSH_COMPOSITOR_TEST_ADD ("/phosh/app_auth_prompt_new/set_request",
+                             test_app_auth_prompt_set_request);
 
   return g_test_run ();
 }
@@ -7,6 +7,8 @@
  * Author: Guido Günther <agx@sigxcpu.org>
  */
 
+#include "testlib.h"
+
 #include "app-list-model.h"
 
 static void
@@ -51,6 +53,8 @@ on_items_changed (GListModel *model,
   g_assert_cmpint (position, ==, 0);
 
   g_assert_nonnull (phosh_app_list_model_lookup_by_startup_wm_class (context->model, "first-app"));
+  g_assert_nonnull (phosh_app_list_model_lookup_by_id (context->model, "demo.app.First.desktop"));
+  g_assert_null (phosh_app_list_model_lookup_by_id (context->model, "does.not.exist.desktop"));
 
   context->changed = TRUE;
   g_main_loop_quit (context->loop);
@@ -88,13 +92,84 @@ test_phosh_app_list_model_api (void)
 }
 
 
+static void
+test_phosh_app_list_model_app_id_cache (void)
+{
+  PhoshAppListModel *model = phosh_app_list_model_get_default ();
+  g_autoptr (GDesktopAppInfo) info = g_desktop_app_info_new ("demo.app.First.desktop");
+  g_autoptr (GDesktopAppInfo) cached = NULL;
+
+  g_assert_nonnull (info);
+  g_assert_false (phosh_app_list_model_lookup_app_id_cache (model, "demo.app.First", &cached));
+
+  /* Negative caching */
+  phosh_app_list_model_cache_app_id (model, "does.not.exist", NULL);
+  g_assert_true (phosh_app_list_model_lookup_app_id_cache (model, "does.not.exist", &cached));
+  g_assert_null (cached);
+
+  phosh_app_list_model_cache_app_id (model, "demo.app.First", info);
+  g_assert_true (phosh_app_list_model_lookup_app_id_cache (model, "demo.app.First", &cached));
+  g_assert_true (cached == info);
+  g_clear_object (&cached);
+
+  /* New exec mappings invalidate the cache */
+  phosh_app_list_model_add_exec (model, "/usr/bin/first", G_APP_INFO (info));
+  g_assert_false (phosh_app_list_model_lookup_app_id_cache (model, "demo.app.First", &cached));
+  g_assert_false (phosh_app_list_model_lookup_app_id_cache (model, "does.not.exist", &cached));
+
+  g_assert_finalize_object (model);
+}
+
+
+static void
+test_phosh_app_list_model_snapshot (void)
+{
+  PhoshAppListModel *model = phosh_app_list_model_get_default ();
+  g_autoptr (GMainLoop) loop = g_main_loop_new (NULL, FALSE);
+  g_autofree char *path = g_build_filename (g_get_user_cache_dir (), "phosh",
+                                            "app-list.gvariant", NULL);
+
+  /* Listing the apps stores a snapshot */
+  if (g_list_model_get_n_items (G_LIST_MODEL (model)) == 0) {
+    g_signal_connect_swapped (model, "items-changed", G_CALLBACK (g_main_loop_quit), loop);
+    g_main_loop_run (loop);
+  }
+  g_assert_true (g_file_test (path, G_FILE_TEST_IS_REGULAR));
+  g_assert_finalize_object (model);
+
+  /* A new model is populated from the snapshot right away */
+  model = phosh_app_list_model_get_default ();
+  g_assert_cmpint (g_list_model_get_n_items (G_LIST_MODEL (model)), >, 0);
+  g_assert_nonnull (phosh_app_list_model_lookup_by_startup_wm_class (model, "first-app"));
+  g_assert_nonnull (phosh_app_list_model_lookup_by_id (model, "demo.app.First.desktop"));
+  g_assert_finalize_object (model);
+}
+
+
 int
 main (int argc, char *argv[])
 {
+  g_autoptr (GError) err = NULL;
+  g_autoptr (GFile) cache_dir = NULL;
+  g_autofree char *tmpdir = NULL;
+  int ret;
+
+  /* Don't pick up app list snapshots from previous runs */
+  tmpdir = g_dir_make_tmp ("phosh-test-app-list-model.XXXXXX", &err);
+  g_assert_no_error (err);
+  g_setenv ("XDG_CACHE_HOME", tmpdir, TRUE);
+
   g_test_init (&argc, &argv, NULL);
 
   g_test_add_func ("/phosh/app-list-model/new", test_phosh_app_list_model_get_default);
   g_test_add_func ("/phosh/app-list-model/api", test_phosh_app_list_model_api);
+  g_test_add_func ("/phosh/app-list-model/app-id-cache", test_phosh_app_list_model_app_id_cache);
+  g_test_add_func ("/phosh/app-list-model/snapshot", test_phosh_app_list_model_snapshot);
+
+  ret = g_test_run ();
+
+  cache_dir = g_file_new_for_path (tmpdir);
+  phosh_test_remove_tree (cache_dir);
 
-  return g_test_run ();
+  return ret;
 }
@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "auto-brightness-filter.h"
+
+#define SEC(s) ((gint64)(s) * G_USEC_PER_SEC)
+
+
+static void
+test_phosh_auto_brightness_filter_brightness (void)
+{
+  g_autoptr (PhoshAutoBrightnessFilter) filter = phosh_auto_brightness_filter_new ();
+  PhoshAutoBrightness *auto_brightness = PHOSH_AUTO_BRIGHTNESS (filter);
+  double brightness;
+
+  /* First sample is applied right away */
+  phosh_auto_brightness_filter_add_ambient_level_at (filter, 200.0, SEC (0));
+  brightness = phosh_auto_brightness_get_brightness (auto_brightness);
+  g_assert_cmpfloat_with_epsilon (brightness, 0.55, FLT_EPSILON);
+
+  /* Small changes don't change brightness */
+  phosh_auto_brightness_filter_add_ambient_level_at (filter, 220.0, SEC (10));
+  brightness = phosh_auto_brightness_get_brightness (auto_brightness);
+  g_assert_cmpfloat_with_epsilon (brightness, 0.55, FLT_EPSILON);
+
+  /* Converges towards a new level */
+  for (int i = 0; i < 10; i++)
+    phosh_auto_brightness_filter_add_ambient_level_at (filter, 300.0, SEC (20 + 10 * i));
+  brightness = phosh_auto_brightness_get_brightness (auto_brightness);
+  g_assert_cmpfloat_with_epsilon (brightness, 0.70, 0.01);
+
+  g_assert_null (phosh_auto_brightness_get_backlight (auto_brightness));
+}
+
+
+static void
+test_phosh_auto_brightness_filter_outlier (void)
+{
+  g_autoptr (PhoshAutoBrightnessFilter) filter = phosh_auto_brightness_filter_new ();
+  PhoshAutoBrightness *auto_brightness = PHOSH_AUTO_BRIGHTNESS (filter);
+  double brightness;
+
+  phosh_auto_brightness_filter_add_ambient_level_at (filter, 200.0, SEC (0));
+
+  /* A single spike is ignored */
+  phosh_auto_brightness_filter_add_ambient_level_at (filter, 8000.0, SEC (10));
+  phosh_auto_brightness_filter_add_ambient_level_at (filter, 200.0, SEC (11));
+  brightness = phosh_auto_brightness_get_brightness (auto_brightness);
+  g_assert_cmpfloat_with_epsilon (brightness, 0.55, FLT_EPSILON);
+
+  /* A persistent change is picked up */
+  phosh_auto_brightness_filter_add_ambient_level_at (filter, 8000.0, SEC (20));
+  phosh_auto_brightness_filter_add_ambient_level_at (filter, 8000.0, SEC (21));
+  brightness = phosh_auto_brightness_get_brightness (auto_brightness);
+  g_assert_cmpfloat_with_epsilon (brightness, 0.55, FLT_EPSILON);
+  phosh_auto_brightness_filter_add_ambient_level_at (filter, 8000.0, SEC (22));
+  brightness = phosh_auto_brightness_get_brightness (auto_brightness);
+  g_assert_cmpfloat_with_epsilon (brightness, 1.3, FLT_EPSILON);
+
+  phosh_auto_brightness_filter_add_ambient_level_at (filter, 0.0, SEC (30));
+  phosh_auto_brightness_filter_add_ambient_level_at (filter, 0.0, SEC (31));
+  phosh_auto_brightness_filter_add_ambient_level_at (filter, 0.0, SEC (32));
+  brightness = phosh_auto_brightness_get_brightness (auto_brightness);
+  g_assert_cmpfloat_with_epsilon (brightness, 0.1, FLT_EPSILON);
+}
+
+
+static void
+test_phosh_auto_brightness_filter_hold (void)
+{
+  g_autoptr (PhoshAutoBrightnessFilter) filter = phosh_auto_brightness_filter_new ();
+  PhoshAutoBrightness *auto_brightness = PHOSH_AUTO_BRIGHTNESS (filter);
+  double brightness;
+
+  phosh_auto_brightness_filter_add_ambient_level_at (filter, 200.0, SEC (0));
+
+  /* Brightness doesn't change again within the hold time */
+  for (int i = 0; i < 3; i++)
+    phosh_auto_brightness_filter_add_ambient_level_at (filter, 8000.0, SEC (1));
+  brightness = phosh_auto_brightness_get_brightness (auto_brightness);
+  g_assert_cmpfloat_with_epsilon (brightness, 0.55, FLT_EPSILON);
+
+  /* …but it does once hold time passed */
+  phosh_auto_brightness_filter_add_ambient_level_at (filter, 8000.0, SEC (4));
+  brightness = phosh_auto_brightness_get_brightness (auto_brightness);
+  g_assert_cmpfloat_with_epsilon (brightness, 1.3, FLT_EPSILON);
+}
+
+
+int
+main (int   argc,
+      char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/phosh/auto-brightness-filter/brightness",
+                   test_phosh_auto_brightness_filter_brightness);
+  g_test_add_func ("/phosh/auto-brightness-filter/outlier",
+                   test_phosh_auto_brightness_filter_outlier);
+  g_test_add_func ("/phosh/auto-brightness-filter/hold",
+                   test_phosh_auto_brightness_filter_hold);
+  return g_test_run ();
+}
@@ -10,19 +10,28 @@
 
 /* Load the stylesheets to catch CSS parser warnings */
 
+static void
+load_stylesheet (const char *style)
+{
+  g_autoptr (GtkCssProvider) provider = gtk_css_provider_new ();
+
+  gtk_css_provider_load_from_resource (provider, style);
+  gtk_style_context_add_provider_for_screen (gdk_screen_get_default (),
+                                             GTK_STYLE_PROVIDER (provider),
+                                             GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+}
+
+
 static const char *
 load_theme (const char *theme_name)
 {
   const char *style;
-  g_autoptr (GtkCssProvider) provider = gtk_css_provider_new ();
 
   g_debug ("GTK theme: %s", theme_name);
 
+  load_stylesheet (phosh_style_manager_get_common_stylesheet ());
   style = phosh_style_manager_get_stylesheet (theme_name);
-  gtk_css_provider_load_from_resource (provider, style);
-  gtk_style_context_add_provider_for_screen (gdk_screen_get_default (),
-                                             GTK_STYLE_PROVIDER (provider),
-                                             GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+  load_stylesheet (style);
 
   return style;
 }
@@ -31,14 +40,23 @@ load_theme (const char *theme_name)
 static void
 test_phosh_css_default(void)
 {
-  g_assert_cmpstr (load_theme ("Adwaita"), ==, "/mobi/phosh/stylesheet/adwaita-dark.css");
+  g_assert_cmpstr (load_theme ("Adwaita"), ==, "/mobi/phosh/stylesheet/variants/adwaita-dark.css");
 }
 
 
 static void
 test_phosh_css_highcontrast(void)
 {
-  g_assert_cmpstr (load_theme ("HighContrast"), ==, "/mobi/phosh/stylesheet/adwaita-hc-light.css");
+  g_assert_cmpstr (load_theme ("HighContrast"), ==, "/mobi/phosh/stylesheet/variants/adwaita-hc-light.css");
+}
+
+
+static void
+test_phosh_css_standalone (void)
+{
+  /* Used by the standalone tools */
+  load_stylesheet ("/mobi/phosh/stylesheet/adwaita-dark.css");
+  load_stylesheet ("/mobi/phosh/stylesheet/adwaita-hc-light.css");
 }
 
 
@@ -50,5 +68,6 @@ main (int   argc,
 
   g_test_add_func("/phosh/css/default", test_phosh_css_default);
   g_test_add_func("/phosh/css/highcontrast", test_phosh_css_highcontrast);
+  g_test_add_func("/phosh/css/standalone", test_phosh_css_standalone);
   return g_test_run();
 }
@@ -262,6 +262,40 @@ test_phosh_favorite_list_model_is_favorite (void)
 }
 
 
+static void
+test_phosh_favorite_list_model_apps_are_favorite (void)
+{
+  PhoshFavoriteListModel *model = phosh_favorite_list_model_get_default ();
+  g_autoptr (GSettings) settings = NULL;
+  g_autoptr (GAppInfo) info = NULL;
+  g_autoptr (GAppInfo) info_desktop = NULL;
+  GAppInfo *apps[2];
+  gboolean is_favorite[2];
+
+  info = g_app_info_create_from_commandline ("foo",
+                                             "com.example.foo",
+                                             G_APP_INFO_CREATE_NONE,
+                                             NULL);
+
+  settings = g_settings_new ("sm.puri.phosh");
+  g_settings_set_strv (settings, "favorites", NULL);
+
+  info_desktop = G_APP_INFO (g_desktop_app_info_new ("demo.app.First.desktop"));
+  phosh_favorite_list_model_add_app (model, info_desktop);
+
+  apps[0] = info;
+  apps[1] = info_desktop;
+  phosh_favorite_list_model_apps_are_favorite (model, apps, G_N_ELEMENTS (apps), is_favorite);
+  g_assert_false (is_favorite[0]);
+  g_assert_true (is_favorite[1]);
+
+  phosh_favorite_list_model_remove_app (model, info_desktop);
+  phosh_favorite_list_model_apps_are_favorite (model, apps, G_N_ELEMENTS (apps), is_favorite);
+  g_assert_false (is_favorite[0]);
+  g_assert_false (is_favorite[1]);
+}
+
+
 int
 main (int   argc,
       char *argv[])
@@ -284,6 +318,8 @@ main (int   argc,
                    test_phosh_favorite_list_model_remove_no_id_invalid);
   g_test_add_func ("/phosh/favorites-list-model/is_favorite",
                    test_phosh_favorite_list_model_is_favorite);
+  g_test_add_func ("/phosh/favorites-list-model/apps_are_favorite",
+                   test_phosh_favorite_list_model_apps_are_favorite);
 
   return g_test_run ();
 }
@@ -122,6 +122,8 @@ test_phosh_folder_info_contains (void)
 
   info_2 = G_APP_INFO (g_desktop_app_info_new ("demo.app.Second.desktop"));
   g_assert_false (phosh_folder_info_contains (folder_info, info_2));
+
+  g_assert_cmpstrv (phosh_folder_info_get_app_ids (folder_info), app_ids);
 }
 
 
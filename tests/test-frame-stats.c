@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "frame-stats.h"
+
+
+static void
+test_phosh_frame_stats_percentiles (void)
+{
+  g_autoptr (GVariant) stats = NULL;
+  g_autoptr (GVariant) surface = NULL;
+  gint64 p50, p90, p99, max;
+  guint64 frames, long_frames;
+
+  /* Nothing is accounted while disabled */
+  phosh_frame_stats_add ("test", PHOSH_FRAME_STATS_FRAME, 1000);
+  stats = g_variant_ref_sink (phosh_frame_stats_get ());
+  g_assert_cmpint (g_variant_n_children (stats), ==, 0);
+  g_clear_pointer (&stats, g_variant_unref);
+
+  phosh_frame_stats_set_enabled (TRUE);
+  for (int i = 1; i <= 100; i++)
+    phosh_frame_stats_add ("test", PHOSH_FRAME_STATS_FRAME, i * 1000);
+
+  stats = g_variant_ref_sink (phosh_frame_stats_get ());
+  surface = g_variant_lookup_value (stats, "test", G_VARIANT_TYPE_VARDICT);
+  g_assert_nonnull (surface);
+
+  g_assert_true (g_variant_lookup (surface, "frames", "t", &frames));
+  g_assert_cmpint (frames, ==, 100);
+  g_assert_true (g_variant_lookup (surface, "long-frames", "t", &long_frames));
+  g_assert_cmpint (long_frames, ==, 84);
+
+  g_assert_true (g_variant_lookup (surface, "frame", "(xxxx)", &p50, &p90, &p99, &max));
+  g_assert_cmpint (p50, ==, 50000);
+  g_assert_cmpint (p90, ==, 90000);
+  g_assert_cmpint (p99, ==, 99000);
+  g_assert_cmpint (max, ==, 100000);
+
+  g_assert_true (g_variant_lookup (surface, "paint", "(xxxx)", &p50, &p90, &p99, &max));
+  g_assert_cmpint (max, ==, 0);
+
+  g_clear_pointer (&stats, g_variant_unref);
+  phosh_frame_stats_reset ();
+  stats = g_variant_ref_sink (phosh_frame_stats_get ());
+  g_assert_cmpint (g_variant_n_children (stats), ==, 0);
+
+  phosh_frame_stats_set_enabled (FALSE);
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/phosh/frame-stats/percentiles", test_phosh_frame_stats_percentiles);
+
+  return g_test_run ();
+}
@@ -27,11 +27,43 @@ test_phosh_gamma_table_fill (void)
 }
 
 
+static void
+test_phosh_gamma_table_cached (void)
+{
+  const guint32 ramp_size = 256;
+  const guint32 temps[] = { 1000, 3450, 6500, 25000, 3450, 25000, 4000, 4100, 4200, 3450 };
+  g_autofree guint16 *table = g_new (guint16, 3 * ramp_size);
+  g_autofree guint16 *again = g_new (guint16, 3 * ramp_size);
+
+  for (int i = 0; i < G_N_ELEMENTS (temps); i++) {
+    phosh_gamma_table_fill (table, ramp_size, temps[i]);
+    /* Same result when cached */
+    phosh_gamma_table_fill (again, ramp_size, temps[i]);
+    g_assert_cmpmem (table, 3 * ramp_size * sizeof (guint16),
+                     again, 3 * ramp_size * sizeof (guint16));
+
+    /* Ramps are monotonic and red is never dimmed below 6500K */
+    for (int j = 1; j < ramp_size; j++) {
+      g_assert_cmpint (table[j], >=, table[j - 1]);
+      g_assert_cmpint (table[ramp_size + j], >=, table[ramp_size + j - 1]);
+      g_assert_cmpint (table[2 * ramp_size + j], >=, table[2 * ramp_size + j - 1]);
+      if (temps[i] <= 6500)
+        g_assert_cmpint (table[j], ==, j * 256);
+    }
+  }
+
+  /* Different ramp sizes don't mix */
+  phosh_gamma_table_fill (table, 2, 6500);
+  g_assert_cmpint (table[1], ==, 32768);
+}
+
+
 int
 main (int argc, char *argv[])
 {
   g_test_init (&argc, &argv, NULL);
 
   g_test_add_func("/phosh/gamma-table/fill", test_phosh_gamma_table_fill);
+  g_test_add_func("/phosh/gamma-table/cached", test_phosh_gamma_table_cached);
   return g_test_run();
 }
@@ -9,6 +9,8 @@
 
 #include "keypad.h"
 
+#include <string.h>
+
 gint notified;
 
 
@@ -98,15 +100,53 @@ test_keypad_end_action (void)
 }
 
 
+static guint
+get_digits (PhoshKeypad *keypad, GtkWidget *buttons[10])
+{
+  guint seen = 0;
+
+  /* The three rows of digits plus the zero in the middle of the last row */
+  for (int i = 0; i < 10; i++) {
+    int c = i < 9 ? i % 3 : 1;
+    int r = i < 9 ? i / 3 : 3;
+    GtkWidget *button = gtk_grid_get_child_at (GTK_GRID (keypad), c, r);
+    GtkWidget *label = gtk_bin_get_child (GTK_BIN (button));
+    const char *text = gtk_label_get_label (GTK_LABEL (label));
+
+    g_assert_cmpint (strlen (text), ==, 1);
+    seen |= 1 << (text[0] - '0');
+    buttons[i] = button;
+  }
+
+  return seen;
+}
+
+
 static void
 test_keypad_shuffle (void)
 {
   g_autoptr (PhoshKeypad) keypad = NULL;
+  GtkWidget *before[10], *after[10];
 
   keypad = g_object_ref_sink (g_object_new (PHOSH_TYPE_KEYPAD,
                                             "shuffle", TRUE,
                                             NULL));
   g_assert_true (phosh_keypad_get_shuffle (keypad));
+
+  g_assert_cmphex (get_digits (keypad, before), ==, 0x3ff);
+  phosh_keypad_distribute (keypad);
+  /* Digits got permuted but the buttons stayed in place */
+  g_assert_cmphex (get_digits (keypad, after), ==, 0x3ff);
+  for (int i = 0; i < 10; i++)
+    g_assert_true (before[i] == after[i]);
+
+  phosh_keypad_set_shuffle (keypad, FALSE);
+  get_digits (keypad, after);
+  for (int i = 0; i < 10; i++) {
+    const char *text = gtk_label_get_label (GTK_LABEL (gtk_bin_get_child (GTK_BIN (after[i]))));
+
+    g_assert_cmpint (text[0] - '0', ==, (i + 1) % 10);
+  }
 }
 
 
@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "launch-stats.h"
+
+
+static void
+test_phosh_launch_stats_percentiles (void)
+{
+  g_autoptr (GVariant) stats = NULL;
+  g_autoptr (GVariant) app = NULL;
+  gint64 p50, p90, p99, max;
+  guint64 launches, failures;
+
+  stats = g_variant_ref_sink (phosh_launch_stats_get ());
+  g_assert_cmpint (g_variant_n_children (stats), ==, 0);
+  g_clear_pointer (&stats, g_variant_unref);
+
+  for (int i = 1; i <= 100; i++) {
+    phosh_launch_stats_add_launch ("test.desktop");
+    phosh_launch_stats_add ("test.desktop", PHOSH_LAUNCH_STATS_READY, i * 1000);
+  }
+  phosh_launch_stats_add_failure ("test.desktop");
+
+  stats = g_variant_ref_sink (phosh_launch_stats_get ());
+  app = g_variant_lookup_value (stats, "test.desktop", G_VARIANT_TYPE_VARDICT);
+  g_assert_nonnull (app);
+
+  g_assert_true (g_variant_lookup (app, "launches", "t", &launches));
+  g_assert_cmpint (launches, ==, 100);
+  g_assert_true (g_variant_lookup (app, "failures", "t", &failures));
+  g_assert_cmpint (failures, ==, 1);
+
+  /* Only the last 64 samples are kept but the maximum is */
+  g_assert_true (g_variant_lookup (app, "ready", "(xxxx)", &p50, &p90, &p99, &max));
+  g_assert_cmpint (p50, ==, 68000);
+  g_assert_cmpint (p90, ==, 93000);
+  g_assert_cmpint (p99, ==, 99000);
+  g_assert_cmpint (max, ==, 100000);
+
+  g_assert_true (g_variant_lookup (app, "toplevel", "(xxxx)", &p50, &p90, &p99, &max));
+  g_assert_cmpint (max, ==, 0);
+
+  g_clear_pointer (&stats, g_variant_unref);
+  phosh_launch_stats_reset ();
+  stats = g_variant_ref_sink (phosh_launch_stats_get ());
+  g_assert_cmpint (g_variant_n_children (stats), ==, 0);
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/phosh/launch-stats/percentiles", test_phosh_launch_stats_percentiles);
+
+  return g_test_run ();
+}
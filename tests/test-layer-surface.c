@@ -163,6 +163,89 @@ test_layer_surface_set_kbd_interactivity (PhoshTestCompositorFixture *fixture, g
 }
 
 
+static void
+on_layer_surface_configured (PhoshLayerSurface *surface, guint *count)
+{
+  (*count)++;
+}
+
+
+static void
+test_layer_surface_configure_async (PhoshTestCompositorFixture *fixture, gconstpointer unused)
+{
+  guint count = 0;
+  g_autofree char *namespace = g_strdup_printf ("phosh test %s", __func__);
+  PhoshMonitor *monitor = phosh_test_get_monitor (fixture->state);
+  GtkWidget *surface = g_object_new (PHOSH_TYPE_LAYER_SURFACE,
+                                     "layer-shell", phosh_wayland_get_zwlr_layer_shell_v1(
+                                       fixture->state->wl),
+                                     "wl-output", monitor->wl_output,
+                                     "width", 10,
+                                     "height", 10,
+                                     "layer", ZWLR_LAYER_SHELL_V1_LAYER_OVERLAY,
+                                     "kbd-interactivity", FALSE,
+                                     "exclusive-zone", -1,
+                                     "namespace", namespace,
+                                     NULL);
+
+  g_signal_connect (surface, "configured", G_CALLBACK (on_layer_surface_configured), &count);
+
+  /* Alpha set before the initial configure gets applied later on */
+  phosh_layer_surface_set_alpha (PHOSH_LAYER_SURFACE (surface), 0.5);
+
+  /* Mapping doesn't wait for the compositor */
+  gtk_widget_set_visible (surface, TRUE);
+  g_assert_true (gtk_widget_get_mapped (surface));
+  g_assert_cmpint (count, ==, 0);
+
+  while (count == 0)
+    g_main_context_iteration (NULL, TRUE);
+  g_assert_cmpint (count, ==, 1);
+  g_assert_cmpint (phosh_layer_surface_get_configured_width (PHOSH_LAYER_SURFACE (surface)), ==, 10);
+
+  /* Remapping configures again even if the size didn't change */
+  gtk_widget_set_visible (surface, FALSE);
+  gtk_widget_set_visible (surface, TRUE);
+  while (count == 1)
+    g_main_context_iteration (NULL, TRUE);
+  g_assert_cmpint (count, ==, 2);
+
+  gtk_widget_destroy (surface);
+}
+
+
+static void
+test_layer_surface_pool (PhoshTestCompositorFixture *fixture, gconstpointer unused)
+{
+  PhoshMonitor *monitor = phosh_test_get_monitor (fixture->state);
+  gpointer layer_shell = phosh_wayland_get_zwlr_layer_shell_v1 (fixture->state->wl);
+  GtkWidget *surface = phosh_layer_surface_new (layer_shell, monitor->wl_output);
+  GtkWidget *other = phosh_layer_surface_new (layer_shell, monitor->wl_output);
+
+  g_assert_null (phosh_layer_surface_pool_take (PHOSH_TYPE_LAYER_SURFACE, monitor->wl_output));
+
+  gtk_widget_set_visible (surface, TRUE);
+  phosh_layer_surface_pool_add (PHOSH_LAYER_SURFACE (surface));
+  g_assert_false (gtk_widget_get_visible (surface));
+  g_object_add_weak_pointer (G_OBJECT (other), (gpointer *)&other);
+  /* Only one surface per type is kept */
+  phosh_layer_surface_pool_add (PHOSH_LAYER_SURFACE (other));
+  g_assert_null (other);
+
+  g_assert_true (phosh_layer_surface_pool_take (PHOSH_TYPE_LAYER_SURFACE,
+                                                monitor->wl_output) == PHOSH_LAYER_SURFACE (surface));
+  g_assert_null (phosh_layer_surface_pool_take (PHOSH_TYPE_LAYER_SURFACE, monitor->wl_output));
+
+  /* Surfaces for other outputs get dropped */
+  g_object_add_weak_pointer (G_OBJECT (surface), (gpointer *)&surface);
+  phosh_layer_surface_pool_add (PHOSH_LAYER_SURFACE (surface));
+  g_assert_null (phosh_layer_surface_pool_take (PHOSH_TYPE_LAYER_SURFACE, NULL));
+  g_assert_null (surface);
+
+  phosh_layer_surface_pool_clear ();
+}
+
+
 int
 main (int   argc,
       char *argv[])
@@ -174,6 +257,9 @@ main (int   argc,
   PHOSH_COMPOSITOR_TEST_ADD ("/phosh/layer-surface/set_size", test_layer_surface_set_size);
   PHOSH_COMPOSITOR_TEST_ADD ("/phosh/layer-surface/set_kbd_interactivity",
                              test_layer_surface_set_kbd_interactivity);
+  PHOSH_COMPOSITOR_TEST_ADD ("/phosh/layer-surface/configure_async",
+                             test_layer_surface_configure_async);
+  PHOSH_COMPOSITOR_TEST_ADD ("/phosh/layer-surface/pool", test_layer_surface_pool);
 
   return g_test_run ();
 }
@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "memory-stats.h"
+
+
+static void
+report_memory (gpointer data, guint64 *n_items, guint64 *bytes)
+{
+  *n_items = GPOINTER_TO_UINT (data);
+  *bytes = GPOINTER_TO_UINT (data) * 1024;
+}
+
+
+static void
+test_phosh_memory_stats_report (void)
+{
+  g_autoptr (GVariant) stats = NULL;
+  g_autoptr (GVariant) cache = NULL;
+  guint64 n_items, bytes;
+
+  phosh_memory_stats_register ("test-cache", report_memory, GUINT_TO_POINTER (2));
+  phosh_memory_stats_register ("test-cache", report_memory, GUINT_TO_POINTER (3));
+
+  /* Reporters with the same name are summed up */
+  stats = g_variant_ref_sink (phosh_memory_stats_get ());
+  cache = g_variant_lookup_value (stats, "test-cache", G_VARIANT_TYPE_VARDICT);
+  g_assert_nonnull (cache);
+  g_assert_true (g_variant_lookup (cache, "items", "t", &n_items));
+  g_assert_cmpint (n_items, ==, 5);
+  g_assert_true (g_variant_lookup (cache, "bytes", "t", &bytes));
+  g_assert_cmpint (bytes, ==, 5 * 1024);
+  g_clear_pointer (&cache, g_variant_unref);
+  g_clear_pointer (&stats, g_variant_unref);
+
+  phosh_memory_stats_unregister (GUINT_TO_POINTER (2));
+  stats = g_variant_ref_sink (phosh_memory_stats_get ());
+  cache = g_variant_lookup_value (stats, "test-cache", G_VARIANT_TYPE_VARDICT);
+  g_assert_true (g_variant_lookup (cache, "items", "t", &n_items));
+  g_assert_cmpint (n_items, ==, 3);
+  g_clear_pointer (&cache, g_variant_unref);
+  g_clear_pointer (&stats, g_variant_unref);
+
+  phosh_memory_stats_unregister (GUINT_TO_POINTER (3));
+  stats = g_variant_ref_sink (phosh_memory_stats_get ());
+  cache = g_variant_lookup_value (stats, "test-cache", G_VARIANT_TYPE_VARDICT);
+  g_assert_null (cache);
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/phosh/memory-stats/report", test_phosh_memory_stats_report);
+
+  return g_test_run ();
+}
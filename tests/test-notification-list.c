@@ -294,6 +294,59 @@ test_phosh_notification_list_seek (void)
 }
 
 
+static void
+test_phosh_notification_list_spill (void)
+{
+  g_autoptr (PhoshNotificationList) list = NULL;
+  g_autoptr (PhoshNotificationSource) source = NULL;
+  g_autoptr (GDateTime) now = g_date_time_new_now_local ();
+  g_autoptr (PhoshNotification) last = NULL;
+  PhoshNotification *noti;
+
+  list = phosh_notification_list_new ();
+  phosh_notification_list_set_max_per_source (list, 2);
+
+  for (int i = 1; i <= 3; i++) {
+    g_autofree char *summary = g_strdup_printf ("Message %d", i);
+    g_autoptr (PhoshNotification) new = NULL;
+
+    new = phosh_notification_new (i,
+                                  "Chat",
+                                  NULL,
+                                  summary,
+                                  "Testing",
+                                  NULL,
+                                  NULL,
+                                  PHOSH_NOTIFICATION_URGENCY_NORMAL,
+                                  NULL,
+                                  FALSE,
+                                  FALSE,
+                                  NULL,
+                                  NULL,
+                                  now);
+    phosh_notification_list_add (list, "org.gnome.zbrown.KingsCross", new);
+  }
+
+  source = g_list_model_get_item (G_LIST_MODEL (list), 0);
+  g_assert_cmpint (g_list_model_get_n_items (G_LIST_MODEL (source)), ==, 2);
+  g_assert_cmpint (phosh_notification_source_get_n_spilled (source), ==, 1);
+  g_assert_null (phosh_notification_list_get_by_id (list, 1));
+  g_assert_nonnull (phosh_notification_list_get_by_id (list, 2));
+
+  phosh_notification_list_load_spilled (list);
+  g_assert_cmpint (g_list_model_get_n_items (G_LIST_MODEL (source)), ==, 3);
+  g_assert_cmpint (phosh_notification_source_get_n_spilled (source), ==, 0);
+
+  noti = phosh_notification_list_get_by_id (list, 1);
+  g_assert_nonnull (noti);
+  g_assert_cmpstr (phosh_notification_get_summary (noti), ==, "Message 1");
+  g_assert_cmpstr (phosh_notification_get_app_name (noti), ==, "Chat");
+  g_assert_true (g_date_time_equal (phosh_notification_get_timestamp (noti), now));
+  /* Oldest goes last */
+  last = g_list_model_get_item (G_LIST_MODEL (source), 2);
+  g_assert_true (last == noti);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -304,6 +357,7 @@ main (int argc, char **argv)
   g_test_add_func ("/phosh/notification-list/latest-on-top", test_phosh_notification_list_latest_on_top);
   g_test_add_func ("/phosh/notification-list/source-empty", test_phosh_notification_list_source_empty);
   g_test_add_func ("/phosh/notification-list/seek", test_phosh_notification_list_seek);
+  g_test_add_func ("/phosh/notification-list/spill", test_phosh_notification_list_spill);
 
   return g_test_run ();
 }
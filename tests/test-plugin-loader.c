@@ -9,6 +9,8 @@
 #include "phosh-config.h"
 #include "plugin-loader.h"
 
+#include <glib/gstdio.h>
+
 static void
 test_plugin_loader_new (void)
 {
@@ -62,6 +64,58 @@ test_plugin_loader_load (void)
 }
 
 
+static void
+on_plugin_changed (GMainLoop *loop, const char *name)
+{
+  g_assert_cmpstr (name, ==, "test");
+  g_main_loop_quit (loop);
+}
+
+
+static void
+write_plugin_info (const char *dir, const char *module)
+{
+  g_autofree char *path = g_build_filename (dir, "test.plugin", NULL);
+  g_autofree char *contents = NULL;
+  g_autoptr (GError) err = NULL;
+
+  contents = g_strdup_printf ("[Plugin]\nId=test\nPlugin=%s\n", module);
+  g_file_set_contents (path, contents, -1, &err);
+  g_assert_no_error (err);
+}
+
+
+static void
+test_plugin_loader_changed (void)
+{
+  PhoshPluginLoader *plugin_loader;
+  g_autoptr (GMainLoop) loop = g_main_loop_new (NULL, FALSE);
+  g_autoptr (GError) err = NULL;
+  g_autofree char *dir = NULL;
+  g_autofree char *path = NULL;
+  const char *dirs[] = { NULL, NULL };
+
+  dir = g_dir_make_tmp ("phosh-test-plugin-loader-XXXXXX", &err);
+  g_assert_no_error (err);
+  write_plugin_info (dir, "libtest.so");
+  dirs[0] = dir;
+
+  plugin_loader = phosh_plugin_loader_new ((GStrv)dirs, PHOSH_EXTENSION_POINT_LOCKSCREEN_WIDGET);
+  g_signal_connect_swapped (plugin_loader, "plugin-changed", G_CALLBACK (on_plugin_changed), loop);
+
+  write_plugin_info (dir, "libtest2.so");
+  g_main_loop_run (loop);
+
+  /* Removal is signalled as well */
+  path = g_build_filename (dir, "test.plugin", NULL);
+  g_assert_cmpint (g_remove (path), ==, 0);
+  g_main_loop_run (loop);
+
+  g_assert_finalize_object (plugin_loader);
+  g_assert_cmpint (g_rmdir (dir), ==, 0);
+}
+
+
 int
 main (int   argc,
       char *argv[])
@@ -70,6 +124,7 @@ main (int   argc,
 
   g_test_add_func("/phosh/plugin-loader/new", test_plugin_loader_new);
   g_test_add_func("/phosh/plugin-loader/load", test_plugin_loader_load);
+  g_test_add_func("/phosh/plugin-loader/changed", test_plugin_loader_changed);
 
   return g_test_run();
 }
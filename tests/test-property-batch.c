@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "property-batch.h"
+
+#include <gio/gio.h>
+
+typedef struct {
+  guint count;
+  GStrv properties;
+} ChangedData;
+
+
+static void
+on_changed (PhoshPropertyBatch *batch, GStrv properties, ChangedData *data)
+{
+  data->count++;
+  g_strfreev (data->properties);
+  data->properties = g_strdupv (properties);
+}
+
+
+static void
+iterate_main_loop (void)
+{
+  while (g_main_context_iteration (NULL, FALSE))
+    ;
+}
+
+
+static void
+test_phosh_property_batch_coalesce (void)
+{
+  g_autoptr (GSimpleAction) action = NULL;
+  g_autoptr (PhoshPropertyBatch) batch = NULL;
+  ChangedData data = { 0 };
+
+  action = g_simple_action_new_stateful ("test", NULL, g_variant_new_boolean (FALSE));
+  batch = phosh_property_batch_new (action, "enabled", "state", NULL);
+  g_assert_true (phosh_property_batch_get_object (batch) == action);
+  g_signal_connect (batch, "changed", G_CALLBACK (on_changed), &data);
+
+  g_simple_action_set_enabled (action, FALSE);
+  g_simple_action_set_state (action, g_variant_new_boolean (TRUE));
+  g_simple_action_set_enabled (action, TRUE);
+  g_assert_cmpint (data.count, ==, 0);
+
+  iterate_main_loop ();
+  g_assert_cmpint (data.count, ==, 1);
+  g_assert_cmpint (g_strv_length (data.properties), ==, 2);
+  g_assert_true (g_strv_contains ((const char * const *)data.properties, "enabled"));
+  g_assert_true (g_strv_contains ((const char * const *)data.properties, "state"));
+
+  /* Nothing pending */
+  iterate_main_loop ();
+  g_assert_cmpint (data.count, ==, 1);
+
+  g_strfreev (data.properties);
+}
+
+
+static void
+test_phosh_property_batch_filter (void)
+{
+  g_autoptr (GSimpleAction) action = NULL;
+  g_autoptr (PhoshPropertyBatch) batch = NULL;
+  ChangedData data = { 0 };
+
+  action = g_simple_action_new_stateful ("test", NULL, g_variant_new_boolean (FALSE));
+  batch = phosh_property_batch_new (action, "state", NULL);
+  g_signal_connect (batch, "changed", G_CALLBACK (on_changed), &data);
+
+  /* Not tracked */
+  g_simple_action_set_enabled (action, FALSE);
+  iterate_main_loop ();
+  g_assert_cmpint (data.count, ==, 0);
+
+  g_simple_action_set_state (action, g_variant_new_boolean (TRUE));
+  phosh_property_batch_flush (batch);
+  g_assert_cmpint (data.count, ==, 1);
+  g_assert_cmpstrv (data.properties, ((const char * const []){ "state", NULL }));
+
+  /* Flushing emptied the batch */
+  iterate_main_loop ();
+  g_assert_cmpint (data.count, ==, 1);
+
+  g_strfreev (data.properties);
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/phosh/property-batch/coalesce", test_phosh_property_batch_coalesce);
+  g_test_add_func ("/phosh/property-batch/filter", test_phosh_property_batch_filter);
+
+  return g_test_run ();
+}
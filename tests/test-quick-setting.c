@@ -278,6 +278,41 @@ test_phosh_quick_setting_get_status_page (void)
 }
 
 
+static void
+test_phosh_quick_setting_status_page_type (void)
+{
+  PhoshQuickSetting *quick_setting;
+  PhoshStatusPage *status_page;
+  g_autoptr (GList) box_children = NULL;
+  GtkWidget *arrow_btn;
+
+  quick_setting = PHOSH_QUICK_SETTING (phosh_quick_setting_new (NULL));
+  phosh_quick_setting_set_can_show_status (quick_setting, TRUE);
+  g_assert_cmpint (phosh_quick_setting_get_status_page_type (quick_setting), ==, G_TYPE_NONE);
+
+  box_children = gtk_container_get_children (GTK_CONTAINER (quick_setting));
+  arrow_btn = g_list_nth_data (box_children, 2);
+
+  phosh_quick_setting_set_status_page_type (quick_setting, PHOSH_TYPE_STATUS_PAGE);
+  g_assert_cmpint (phosh_quick_setting_get_status_page_type (quick_setting),
+                   ==,
+                   PHOSH_TYPE_STATUS_PAGE);
+  /* Arrow is shown but the page isn't created yet */
+  g_assert_true (gtk_widget_get_visible (arrow_btn));
+  g_assert_null (phosh_quick_setting_get_status_page (quick_setting));
+
+  g_signal_emit_by_name (quick_setting, "show-status");
+  status_page = phosh_quick_setting_get_status_page (quick_setting);
+  g_assert_true (PHOSH_IS_STATUS_PAGE (status_page));
+
+  /* Showing again reuses the status-page */
+  g_signal_emit_by_name (quick_setting, "show-status");
+  g_assert_true (phosh_quick_setting_get_status_page (quick_setting) == status_page);
+
+  gtk_widget_destroy (GTK_WIDGET (quick_setting));
+}
+
+
 static void
 test_phosh_quick_setting_get_long_press_action_name (void)
 {
@@ -327,6 +362,8 @@ main (int argc, char *argv[])
                    test_phosh_quick_setting_remove_status_icon);
   g_test_add_func ("/phosh/quick-setting/set_active",
                    test_phosh_quick_setting_set_active);
+  g_test_add_func ("/phosh/quick-setting/status_page_type",
+                   test_phosh_quick_setting_status_page_type);
   g_test_add_func ("/phosh/quick-setting/get_active",
                    test_phosh_quick_setting_get_active);
   g_test_add_func ("/phosh/quick-setting/set_can_show_status",
@@ -184,6 +184,17 @@ test_phosh_search_provider_get_result_meta_async (TestFixture *fixture, gconstpo
 
   first_meta = g_ptr_array_index (result_metas, 0);
   g_assert_nonnull (first_meta);
+
+  /* Asking again is served from the cache */
+  g_clear_pointer (&result_metas, g_ptr_array_unref);
+  fixture->got_metas_finished = FALSE;
+  phosh_search_provider_get_result_meta (fixture->provider, final_results, got_result_metas, fixture);
+  g_main_loop_run (fixture->mainloop);
+
+  g_assert_true (fixture->got_metas_finished);
+  g_assert_cmpint (result_metas->len, ==, 2);
+  g_assert_true (g_ptr_array_index (result_metas, 0) ==
+                 meta_cache_lookup (fixture->provider, final_results[0]));
 }
 
 
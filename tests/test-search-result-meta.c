@@ -306,6 +306,37 @@ test_phosh_search_result_meta_deserialise_no_icon (void)
 }
 
 
+static void
+test_phosh_search_result_meta_equal (void)
+{
+  g_autoptr (PhoshSearchResultMeta) meta = NULL;
+  g_autoptr (PhoshSearchResultMeta) same = NULL;
+  g_autoptr (PhoshSearchResultMeta) other_title = NULL;
+  g_autoptr (PhoshSearchResultMeta) other_icon = NULL;
+  g_autoptr (PhoshSearchResultMeta) no_icon = NULL;
+  g_autoptr (GIcon) icon = NULL;
+  g_autoptr (GIcon) icon2 = NULL;
+  g_autoptr (GIcon) icon3 = NULL;
+
+  icon = g_themed_icon_new ("start-here");
+  icon2 = g_themed_icon_new ("start-here");
+  icon3 = g_themed_icon_new ("edit-copy");
+
+  meta = phosh_search_result_meta_new ("test", "Test", "Result", icon, "copy-me");
+  same = phosh_search_result_meta_new ("test", "Test", "Result", icon2, "copy-me");
+  other_title = phosh_search_result_meta_new ("test", "Other", "Result", icon, "copy-me");
+  other_icon = phosh_search_result_meta_new ("test", "Test", "Result", icon3, "copy-me");
+  no_icon = phosh_search_result_meta_new ("test", "Test", "Result", NULL, "copy-me");
+
+  g_assert_true (phosh_search_result_meta_equal (meta, meta));
+  g_assert_true (phosh_search_result_meta_equal (meta, same));
+  g_assert_false (phosh_search_result_meta_equal (meta, other_title));
+  g_assert_false (phosh_search_result_meta_equal (meta, other_icon));
+  g_assert_false (phosh_search_result_meta_equal (meta, no_icon));
+  g_assert_false (phosh_search_result_meta_equal (no_icon, meta));
+}
+
+
 int
 main (int argc, char **argv)
 {
@@ -333,6 +364,8 @@ main (int argc, char **argv)
                    test_phosh_search_result_meta_deserialise);
   g_test_add_func ("/phosh/search-result-meta/deserialise/no-icon",
                    test_phosh_search_result_meta_deserialise_no_icon);
+  g_test_add_func ("/phosh/search-result-meta/equal",
+                   test_phosh_search_result_meta_equal);
 
   return g_test_run ();
 }
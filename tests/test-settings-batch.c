@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "settings-batch.h"
+
+typedef struct {
+  guint count;
+  GStrv keys;
+} ChangedData;
+
+
+static void
+on_changed (PhoshSettingsBatch *batch, GStrv keys, ChangedData *data)
+{
+  data->count++;
+  g_strfreev (data->keys);
+  data->keys = g_strdupv (keys);
+}
+
+
+static void
+iterate_main_loop (void)
+{
+  while (g_main_context_iteration (NULL, FALSE))
+    ;
+}
+
+
+static void
+test_phosh_settings_batch_coalesce (void)
+{
+  g_autoptr (GSettings) settings = g_settings_new ("sm.puri.phosh");
+  g_autoptr (PhoshSettingsBatch) batch = NULL;
+  ChangedData data = { 0 };
+  const char *apps[] = { "org.example.Foo.desktop", NULL };
+
+  batch = phosh_settings_batch_new (settings, "force-adaptive", "app-filter-mode", NULL);
+  g_assert_true (phosh_settings_batch_get_settings (batch) == settings);
+  g_signal_connect (batch, "changed", G_CALLBACK (on_changed), &data);
+
+  g_settings_set_strv (settings, "force-adaptive", apps);
+  g_settings_set_flags (settings, "app-filter-mode", 0);
+  g_settings_reset (settings, "force-adaptive");
+  g_assert_cmpint (data.count, ==, 0);
+
+  iterate_main_loop ();
+  g_assert_cmpint (data.count, ==, 1);
+  g_assert_cmpint (g_strv_length (data.keys), ==, 2);
+  g_assert_true (g_strv_contains ((const char * const *)data.keys, "force-adaptive"));
+  g_assert_true (g_strv_contains ((const char * const *)data.keys, "app-filter-mode"));
+
+  /* Nothing pending */
+  iterate_main_loop ();
+  g_assert_cmpint (data.count, ==, 1);
+
+  g_settings_reset (settings, "app-filter-mode");
+  g_strfreev (data.keys);
+}
+
+
+static void
+test_phosh_settings_batch_filter (void)
+{
+  g_autoptr (GSettings) settings = g_settings_new ("sm.puri.phosh");
+  g_autoptr (PhoshSettingsBatch) batch = NULL;
+  ChangedData data = { 0 };
+  const char *apps[] = { "org.example.Foo.desktop", NULL };
+
+  batch = phosh_settings_batch_new (settings, "force-adaptive", NULL);
+  g_signal_connect (batch, "changed", G_CALLBACK (on_changed), &data);
+
+  /* Not tracked */
+  g_settings_set_boolean (settings, "quick-silent", TRUE);
+  iterate_main_loop ();
+  g_assert_cmpint (data.count, ==, 0);
+
+  g_settings_set_strv (settings, "force-adaptive", apps);
+  phosh_settings_batch_flush (batch);
+  g_assert_cmpint (data.count, ==, 1);
+  g_assert_cmpstrv (data.keys, ((const char * const []){ "force-adaptive", NULL }));
+
+  /* Flushing emptied the batch */
+  iterate_main_loop ();
+  g_assert_cmpint (data.count, ==, 1);
+
+  g_settings_reset (settings, "quick-silent");
+  g_settings_reset (settings, "force-adaptive");
+  g_strfreev (data.keys);
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/phosh/settings-batch/coalesce", test_phosh_settings_batch_coalesce);
+  g_test_add_func ("/phosh/settings-batch/filter", test_phosh_settings_batch_filter);
+
+  return g_test_run ();
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2026 Phosh.mobi e.V.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Author: Guido Günther <agx@sigxcpu.org>
+ */
+
+#include "thumbnail-cache.h"
+
+/* 100x100 ARGB32 images */
+#define IMAGE_SIZE (100 * 100 * 4)
+
+
+static void
+on_evicted (PhoshThumbnailCache *cache, gpointer key, GPtrArray *evicted)
+{
+  g_ptr_array_add (evicted, key);
+}
+
+
+static void
+test_phosh_thumbnail_cache_lru (void)
+{
+  g_autoptr (PhoshThumbnailCache) cache = phosh_thumbnail_cache_new (2 * IMAGE_SIZE);
+  g_autoptr (GPtrArray) evicted = g_ptr_array_new ();
+  cairo_surface_t *surfaces[3];
+  int keys[3];
+
+  g_signal_connect (cache, "evicted", G_CALLBACK (on_evicted), evicted);
+
+  for (int i = 0; i < G_N_ELEMENTS (surfaces); i++)
+    surfaces[i] = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 100, 100);
+
+  phosh_thumbnail_cache_insert (cache, &keys[0], surfaces[0]);
+  phosh_thumbnail_cache_insert (cache, &keys[1], surfaces[1]);
+  g_assert_cmpuint (phosh_thumbnail_cache_get_size (cache), ==, 2 * IMAGE_SIZE);
+  g_assert_cmpuint (evicted->len, ==, 0);
+
+  /* Mark first as recently used so the second one gets evicted */
+  g_assert_true (phosh_thumbnail_cache_lookup (cache, &keys[0]) == surfaces[0]);
+  phosh_thumbnail_cache_insert (cache, &keys[2], surfaces[2]);
+  g_assert_cmpuint (evicted->len, ==, 1);
+  g_assert_true (g_ptr_array_index (evicted, 0) == &keys[1]);
+  g_assert_null (phosh_thumbnail_cache_lookup (cache, &keys[1]));
+  g_assert_cmpuint (phosh_thumbnail_cache_get_size (cache), ==, 2 * IMAGE_SIZE);
+
+  /* Replacing doesn't change the size */
+  phosh_thumbnail_cache_insert (cache, &keys[0], surfaces[1]);
+  g_assert_true (phosh_thumbnail_cache_lookup (cache, &keys[0]) == surfaces[1]);
+  g_assert_cmpuint (phosh_thumbnail_cache_get_size (cache), ==, 2 * IMAGE_SIZE);
+
+  phosh_thumbnail_cache_remove (cache, &keys[0]);
+  g_assert_cmpuint (phosh_thumbnail_cache_get_size (cache), ==, IMAGE_SIZE);
+  g_assert_cmpuint (evicted->len, ==, 1);
+
+  /* Most recently used image is always kept */
+  phosh_thumbnail_cache_set_max_size (cache, 0);
+  g_assert_true (phosh_thumbnail_cache_lookup (cache, &keys[2]) == surfaces[2]);
+  g_assert_cmpuint (evicted->len, ==, 1);
+
+  for (int i = 0; i < G_N_ELEMENTS (surfaces); i++)
+    cairo_surface_destroy (surfaces[i]);
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  gtk_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/phosh/thumbnail-cache/lru", test_phosh_thumbnail_cache_lru);
+
+  return g_test_run ();
+}
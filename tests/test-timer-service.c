@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "timer-service.h"
+
+typedef struct {
+  GMainLoop *loop;
+  guint      count;
+  guint      max;
+} TimerData;
+
+
+static gboolean
+on_timeout (gpointer user_data)
+{
+  TimerData *data = user_data;
+
+  data->count++;
+  if (data->count < data->max)
+    return G_SOURCE_CONTINUE;
+
+  g_main_loop_quit (data->loop);
+  return G_SOURCE_REMOVE;
+}
+
+
+static gboolean
+on_fail (gpointer user_data)
+{
+  g_assert_not_reached ();
+  return G_SOURCE_REMOVE;
+}
+
+
+static void
+test_phosh_timer_service_coalesce (void)
+{
+  g_autoptr (PhoshTimerService) service = g_object_new (PHOSH_TYPE_TIMER_SERVICE, NULL);
+  g_autoptr (GMainLoop) loop = g_main_loop_new (NULL, FALSE);
+  TimerData data1 = { .loop = loop, .max = 1 };
+  TimerData data2 = { .loop = loop, .max = 1 };
+
+  /* The second timeout is late enough to be run together with the first one */
+  phosh_timer_service_add_timeout (service, 10, 100, on_timeout, &data1);
+  phosh_timer_service_add_timeout (service, 50, 0, on_timeout, &data2);
+  g_main_loop_run (loop);
+
+  g_assert_cmpint (data1.count, ==, 1);
+  g_assert_cmpint (data2.count, ==, 1);
+}
+
+
+static void
+test_phosh_timer_service_repeat (void)
+{
+  g_autoptr (PhoshTimerService) service = g_object_new (PHOSH_TYPE_TIMER_SERVICE, NULL);
+  g_autoptr (GMainLoop) loop = g_main_loop_new (NULL, FALSE);
+  TimerData data = { .loop = loop, .max = 3 };
+  guint id;
+
+  phosh_timer_service_add_timeout (service, 10, 10, on_timeout, &data);
+  id = phosh_timer_service_add_timeout (service, 10, 10, on_fail, NULL);
+  g_assert_cmpuint (id, >, 0);
+  phosh_timer_service_remove_timeout (service, id);
+  g_main_loop_run (loop);
+
+  g_assert_cmpint (data.count, ==, 3);
+}
+
+
+static gboolean
+on_aligned_timeout (gpointer user_data)
+{
+  TimerData *data = user_data;
+
+  /* Runs right after a multiple of the interval on the wall clock */
+  g_assert_cmpint (g_get_real_time () % (100 * G_TIME_SPAN_MILLISECOND), <, 50 * G_TIME_SPAN_MILLISECOND);
+
+  return on_timeout (user_data);
+}
+
+
+static void
+test_phosh_timer_service_aligned (void)
+{
+  g_autoptr (PhoshTimerService) service = g_object_new (PHOSH_TYPE_TIMER_SERVICE, NULL);
+  g_autoptr (GMainLoop) loop = g_main_loop_new (NULL, FALSE);
+  TimerData data = { .loop = loop, .max = 3 };
+
+  phosh_timer_service_add_aligned_timeout (service, 100, 0, on_aligned_timeout, &data);
+  g_main_loop_run (loop);
+
+  g_assert_cmpint (data.count, ==, 3);
+}
+
+
+static void
+test_phosh_timer_service_resync (void)
+{
+  g_autoptr (PhoshTimerService) service = g_object_new (PHOSH_TYPE_TIMER_SERVICE, NULL);
+  g_autoptr (GMainLoop) loop = g_main_loop_new (NULL, FALSE);
+  TimerData data = { .loop = loop, .max = 1 };
+  gint64 start;
+
+  /* Would only fire at the next full hour */
+  phosh_timer_service_add_aligned_timeout (service, 60 * 60 * 1000, 0, on_timeout, &data);
+  phosh_timer_service_resync (service);
+
+  start = g_get_monotonic_time ();
+  g_main_loop_run (loop);
+
+  g_assert_cmpint (data.count, ==, 1);
+  g_assert_cmpint (g_get_monotonic_time () - start, <, G_USEC_PER_SEC);
+}
+
+
+static gboolean
+on_resume (gpointer user_data)
+{
+  PhoshTimerService *service = PHOSH_TIMER_SERVICE (user_data);
+
+  phosh_timer_service_set_suspended (service, FALSE);
+  return G_SOURCE_REMOVE;
+}
+
+
+static void
+test_phosh_timer_service_suspend (void)
+{
+  g_autoptr (PhoshTimerService) service = g_object_new (PHOSH_TYPE_TIMER_SERVICE, NULL);
+  g_autoptr (GMainLoop) loop = g_main_loop_new (NULL, FALSE);
+  TimerData data = { .loop = loop, .max = 1 };
+
+  phosh_timer_service_set_suspended (service, TRUE);
+  g_assert_true (phosh_timer_service_get_suspended (service));
+  phosh_timer_service_add_timeout (service, 10, 0, on_timeout, &data);
+
+  g_timeout_add (50, on_resume, service);
+  g_main_loop_run (loop);
+
+  /* Overdue timeout ran once on resume */
+  g_assert_false (phosh_timer_service_get_suspended (service));
+  g_assert_cmpint (data.count, ==, 1);
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/phosh/timer-service/coalesce", test_phosh_timer_service_coalesce);
+  g_test_add_func ("/phosh/timer-service/repeat", test_phosh_timer_service_repeat);
+  g_test_add_func ("/phosh/timer-service/aligned", test_phosh_timer_service_aligned);
+  g_test_add_func ("/phosh/timer-service/resync", test_phosh_timer_service_resync);
+  g_test_add_func ("/phosh/timer-service/suspend", test_phosh_timer_service_suspend);
+
+  return g_test_run ();
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "trace-buffer.h"
+
+
+static void
+test_phosh_trace_buffer_record (void)
+{
+  g_autofree char *json = NULL;
+
+  /* Nothing is recorded while disabled */
+  phosh_trace_buffer_add (PHOSH_TRACE_CATEGORY_FRAME, "test", 1, 2);
+  json = phosh_trace_buffer_to_json ();
+  g_assert_cmpstr (json, ==, "{\"traceEvents\":[]}");
+  g_clear_pointer (&json, g_free);
+
+  phosh_trace_buffer_set_categories (PHOSH_TRACE_CATEGORY_FRAME);
+  g_assert_true (phosh_trace_buffer_is_enabled (PHOSH_TRACE_CATEGORY_FRAME));
+  g_assert_false (phosh_trace_buffer_is_enabled (PHOSH_TRACE_CATEGORY_SEARCH));
+
+  phosh_trace_buffer_add (PHOSH_TRACE_CATEGORY_FRAME, "test", 10, 25);
+  phosh_trace_buffer_add (PHOSH_TRACE_CATEGORY_SEARCH, "ignored", 10, 25);
+  json = phosh_trace_buffer_to_json ();
+  g_assert_nonnull (strstr (json, "\"name\":\"test\",\"cat\":\"frame\""));
+  g_assert_nonnull (strstr (json, "\"ts\":10,\"dur\":15"));
+  g_assert_null (strstr (json, "ignored"));
+  g_clear_pointer (&json, g_free);
+
+  phosh_trace_buffer_clear ();
+  json = phosh_trace_buffer_to_json ();
+  g_assert_cmpstr (json, ==, "{\"traceEvents\":[]}");
+
+  phosh_trace_buffer_set_categories (PHOSH_TRACE_CATEGORY_NONE);
+}
+
+
+static void
+test_phosh_trace_buffer_wrap (void)
+{
+  g_autofree char *json = NULL;
+
+  phosh_trace_buffer_set_categories (PHOSH_TRACE_CATEGORY_SEARCH);
+  for (int i = 0; i < 5000; i++)
+    phosh_trace_buffer_add (PHOSH_TRACE_CATEGORY_SEARCH, "search", i, i + 1);
+
+  /* Only the most recent spans are kept, oldest first */
+  json = phosh_trace_buffer_to_json ();
+  g_assert_null (strstr (json, "\"ts\":903,"));
+  g_assert_true (g_str_has_prefix (json, "{\"traceEvents\":[{\"name\":\"search\",\"cat\":\"search\""));
+  g_assert_nonnull (strstr (json, "\"ts\":904,"));
+  g_assert_true (g_str_has_suffix (json, "\"ts\":4999,\"dur\":1}]}"));
+
+  phosh_trace_buffer_clear ();
+  phosh_trace_buffer_set_categories (PHOSH_TRACE_CATEGORY_NONE);
+}
+
+
+static void
+test_phosh_trace_buffer_categories (void)
+{
+  const char *names[] = { "search", "frame", NULL };
+  g_auto (GStrv) strv = NULL;
+  PhoshTraceCategory categories;
+
+  categories = phosh_trace_buffer_categories_from_strv (names);
+  g_assert_cmpint (categories, ==, PHOSH_TRACE_CATEGORY_SEARCH | PHOSH_TRACE_CATEGORY_FRAME);
+
+  strv = phosh_trace_buffer_categories_to_strv (categories);
+  g_assert_cmpint (g_strv_length (strv), ==, 2);
+  g_assert_cmpstr (strv[0], ==, "frame");
+  g_assert_cmpstr (strv[1], ==, "search");
+
+  g_assert_cmpint (phosh_trace_buffer_categories_from_strv (NULL), ==, PHOSH_TRACE_CATEGORY_NONE);
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/phosh/trace-buffer/record", test_phosh_trace_buffer_record);
+  g_test_add_func ("/phosh/trace-buffer/wrap", test_phosh_trace_buffer_wrap);
+  g_test_add_func ("/phosh/trace-buffer/categories", test_phosh_trace_buffer_categories);
+
+  return g_test_run ();
+}
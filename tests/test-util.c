@@ -130,6 +130,97 @@ test_phosh_util_calculate_supported_mode_scales_fractional (void)
 }
 
 
+static GAppInfo *
+new_test_app_info (void)
+{
+  g_autoptr (GKeyFile) keyfile = g_key_file_new ();
+  const char *desktop =
+    "[Desktop Entry]\n"
+    "Type=Application\n"
+    "Name=Café Viewer\n"
+    "GenericName=Image Viewer\n"
+    "Comment=Look at pictures\n"
+    "Exec=cafe-viewer %U\n"
+    "Keywords=Photo;Gallery;\n";
+
+  g_assert_true (g_key_file_load_from_data (keyfile, desktop, -1, G_KEY_FILE_NONE, NULL));
+  return G_APP_INFO (g_desktop_app_info_new_from_keyfile (keyfile));
+}
+
+
+static void
+test_phosh_util_matches_app_info (void)
+{
+  g_autoptr (GAppInfo) info = new_test_app_info ();
+  g_autofree char *search = NULL;
+
+  g_assert_nonnull (info);
+  phosh_util_index_app_info (info);
+
+  /* Normalized and casefolded */
+  search = phosh_util_fold_search_string ("CAFE\xcc\x81");
+  g_assert_cmpstr (search, ==, "caf\xc3\xa9");
+  g_assert_true (phosh_util_matches_app_info (info, search));
+
+  g_assert_true (phosh_util_matches_app_info (info, "viewer"));
+  g_assert_true (phosh_util_matches_app_info (info, "image"));
+  g_assert_true (phosh_util_matches_app_info (info, "pictures"));
+  g_assert_true (phosh_util_matches_app_info (info, "cafe-viewer"));
+  g_assert_true (phosh_util_matches_app_info (info, "gallery"));
+  g_assert_false (phosh_util_matches_app_info (info, "music"));
+}
+
+
+static void
+test_phosh_util_score_app_info (void)
+{
+  g_autoptr (GAppInfo) info = new_test_app_info ();
+
+  g_assert_cmpint (phosh_util_score_app_info (info, "caf"), ==, PHOSH_UTIL_APP_MATCH_PREFIX);
+  g_assert_cmpint (phosh_util_score_app_info (info, "view"), ==, PHOSH_UTIL_APP_MATCH_WORD_PREFIX);
+  g_assert_cmpint (phosh_util_score_app_info (info, "iew"), ==, PHOSH_UTIL_APP_MATCH_SUBSTRING);
+  g_assert_cmpint (phosh_util_score_app_info (info, "gallery"), ==, PHOSH_UTIL_APP_MATCH_KEYWORD);
+  g_assert_cmpint (phosh_util_score_app_info (info, "image"), ==, PHOSH_UTIL_APP_MATCH_KEYWORD);
+  g_assert_cmpint (phosh_util_score_app_info (info, "cvwr"), ==, PHOSH_UTIL_APP_MATCH_FUZZY);
+  /* Too short for fuzzy matching */
+  g_assert_cmpint (phosh_util_score_app_info (info, "cv"), ==, PHOSH_UTIL_APP_MATCH_NONE);
+  g_assert_cmpint (phosh_util_score_app_info (info, "music"), ==, PHOSH_UTIL_APP_MATCH_NONE);
+}
+
+
+static void
+test_phosh_util_app_search_narrows (void)
+{
+  g_assert_true (phosh_util_app_search_narrows ("cafe", "caf"));
+  g_assert_true (phosh_util_app_search_narrows ("caf", "caf"));
+  /* Enables fuzzy matching */
+  g_assert_false (phosh_util_app_search_narrows ("caf", "ca"));
+  g_assert_false (phosh_util_app_search_narrows ("ca", "caf"));
+  g_assert_false (phosh_util_app_search_narrows ("cafe", "afe"));
+  g_assert_false (phosh_util_app_search_narrows ("caf", NULL));
+  g_assert_false (phosh_util_app_search_narrows ("caf", ""));
+}
+
+
+static void
+test_phosh_util_wifi_strength_bucket (void)
+{
+  g_assert_cmpint (phosh_util_get_wifi_strength_bucket (0), ==, 0);
+  g_assert_cmpint (phosh_util_get_wifi_strength_bucket (5), ==, 0);
+  g_assert_cmpint (phosh_util_get_wifi_strength_bucket (6), ==, 1);
+  g_assert_cmpint (phosh_util_get_wifi_strength_bucket (31), ==, 2);
+  g_assert_cmpint (phosh_util_get_wifi_strength_bucket (56), ==, 3);
+  g_assert_cmpint (phosh_util_get_wifi_strength_bucket (100), ==, 4);
+
+  g_assert_cmpstr (phosh_util_get_icon_by_wifi_strength (70, FALSE),
+                   ==,
+                   "network-wireless-signal-good-symbolic");
+  g_assert_cmpstr (phosh_util_get_icon_by_wifi_strength (70, TRUE),
+                   ==,
+                   "network-wireless-acquiring-symbolic");
+}
+
+
 int
 main (int argc, char *argv[])
 {
@@ -141,6 +232,10 @@ main (int argc, char *argv[])
                    test_phosh_util_calculate_supported_mode_scales_integer);
   g_test_add_func ("/phosh/util/scale/fractional",
                    test_phosh_util_calculate_supported_mode_scales_fractional);
+  g_test_add_func ("/phosh/util/matches-app-info", test_phosh_util_matches_app_info);
+  g_test_add_func ("/phosh/util/score-app-info", test_phosh_util_score_app_info);
+  g_test_add_func ("/phosh/util/app-search-narrows", test_phosh_util_app_search_narrows);
+  g_test_add_func ("/phosh/util/wifi-strength-bucket", test_phosh_util_wifi_strength_bucket);
 
   return g_test_run ();
 }
@@ -58,12 +58,34 @@ test_phosh_wall_clock_strip_am_pm (void)
 }
 
 
+static void
+test_phosh_wall_clock_cache (void)
+{
+  g_autoptr (PhoshWallClock) clock = phosh_wall_clock_new ();
+  g_autofree char *date = NULL;
+  const char *cached;
+
+  cached = phosh_wall_clock_get_local_date (clock);
+  g_assert_nonnull (cached);
+  /* Same tick, same string */
+  g_assert_true (cached == phosh_wall_clock_get_local_date (clock));
+
+  date = phosh_wall_clock_local_date (clock);
+  g_assert_cmpstr (date, ==, cached);
+
+  cached = phosh_wall_clock_get_time_stripped (clock);
+  g_assert_nonnull (cached);
+  g_assert_true (cached == phosh_wall_clock_get_time_stripped (clock));
+}
+
+
 int
 main (int argc, char *argv[])
 {
   g_test_init (&argc, &argv, NULL);
 
   g_test_add_func ("/phosh/wall-clock/strip_am_pm", test_phosh_wall_clock_strip_am_pm);
+  g_test_add_func ("/phosh/wall-clock/cache", test_phosh_wall_clock_cache);
 
   return g_test_run ();
 }
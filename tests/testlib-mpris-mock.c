@@ -49,6 +49,7 @@ on_bus_acquired (GDBusConnection *connection,
   phosh_dbus_media_player2_player_set_can_go_next (self->skel, TRUE);
   phosh_dbus_media_player2_player_set_can_play (self->skel, TRUE);
   phosh_dbus_media_player2_player_set_playback_status (self->skel, "Playing");
+  phosh_dbus_media_player2_player_set_rate (self->skel, 1.0);
   phosh_dbus_media_player2_player_set_metadata (self->skel, metadata);
   g_dbus_interface_skeleton_export (G_DBUS_INTERFACE_SKELETON (self->skel),
                                     connection,